@@ -102,6 +102,8 @@ public:
 
 	// Loads collision models from a map file.
 	virtual void			LoadMap( const idMapFile *mapFile ) = 0;
+	// Starts reading the binary collision model cache of the map in the background, LoadMap picks it up.
+	virtual void			PreloadMap( const char *mapName ) = 0;
 	// Frees all the collision models.
 	virtual void			FreeMap( void ) = 0;
 
@@ -129,6 +131,11 @@ public:
 	virtual void			Translation( trace_t *results, const idVec3 &start, const idVec3 &end,
 								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
 								cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis, int ignoreContentMask ) = 0;
+	// Translates a batch of points and reports the first collision of each. Start and end of a point may not be
+	// the same, such position tests are reported as not colliding. Does not touch any shared state, so several
+	// batches can be traced at once from different threads as long as no other collision queries run meanwhile.
+	virtual void			TranslationPoints( trace_t *results, const idVec3 *starts, const idVec3 *ends, const int numPoints, int contentMask,
+								cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis, int ignoreContentMask ) = 0;
 	// Rotates a trace model and reports the first collision if any.
 	virtual void			Rotation( trace_t *results, const idVec3 &start, const idRotation &rotation,
 								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
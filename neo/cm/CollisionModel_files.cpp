@@ -615,3 +615,627 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 
 	return true;
 }
+
+
+/*
+===============================================================================
+
+Binary collision model cache
+
+The collision models built for a map are also written to a flat binary file.
+All links are stored as indexes so the file can be read with a single read and
+turned back into a model with one allocation per array instead of one per node,
+polygon, brush and reference.
+
+===============================================================================
+*/
+
+#define CM_BINARY_CACHE_DIR			"generated/collision"
+#define CM_BINARY_CACHE_EXT			"bcm"
+#define CM_BINARY_CACHE_MAGIC		( ( 'B' << 24 ) | ( 'C' << 16 ) | ( 'M' << 8 ) | ' ' )
+#define CM_BINARY_CACHE_VERSION		1
+
+idCVar cm_binaryCache( "cm_binaryCache", "1", CVAR_SYSTEM | CVAR_INTEGER, "0 = always build the collision models from the map, 1 = use the binary collision model cache, 2 = rebuild the binary cache", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+
+typedef struct cm_binaryGather_s {
+	idList<cm_node_t *>			nodes;
+	idHashIndex					nodeHash;
+	idList<cm_polygon_t *>		polygons;
+	idHashIndex					polygonHash;
+	idList<cm_brush_t *>		brushes;
+	idHashIndex					brushHash;
+	idList<const idMaterial *>	materials;
+	idHashIndex					materialHash;
+	int							numPolygonRefs;
+	int							numBrushRefs;
+} cm_binaryGather_t;
+
+/*
+================
+CM_BinaryCacheFileName
+================
+*/
+static void CM_BinaryCacheFileName( const char *fileName, idStr &cacheName ) {
+	cacheName = CM_BINARY_CACHE_DIR "/";
+	cacheName += fileName;
+	cacheName.SetFileExtension( CM_BINARY_CACHE_EXT );
+}
+
+/*
+================
+CM_PointerIndex
+
+returns the index of the pointer in the list or -1, if add is set the pointer is appended when not found
+================
+*/
+template< class type >
+static int CM_PointerIndex( idHashIndex &hash, idList<type> &list, type ptr, bool add ) {
+	int key, i;
+
+	if ( ptr == NULL ) {
+		return -1;
+	}
+	key = (int)( ( (uintptr_t)ptr ) >> 4 );
+	for ( i = hash.First( key ); i != -1; i = hash.Next( i ) ) {
+		if ( list[i] == ptr ) {
+			return i;
+		}
+	}
+	if ( !add ) {
+		return -1;
+	}
+	i = list.Append( ptr );
+	hash.Add( key, i );
+	return i;
+}
+
+/*
+================
+CM_GatherBinaryData_r
+
+collects nodes depth first and polygons, brushes and materials in order of first reference
+================
+*/
+static void CM_GatherBinaryData_r( cm_binaryGather_t &gather, cm_node_t *node ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+
+	CM_PointerIndex( gather.nodeHash, gather.nodes, node, true );
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		gather.numPolygonRefs++;
+		if ( pref->p && CM_PointerIndex( gather.polygonHash, gather.polygons, pref->p, false ) == -1 ) {
+			CM_PointerIndex( gather.polygonHash, gather.polygons, pref->p, true );
+			CM_PointerIndex( gather.materialHash, gather.materials, pref->p->material, true );
+		}
+	}
+	for ( bref = node->brushes; bref; bref = bref->next ) {
+		gather.numBrushRefs++;
+		if ( bref->b && CM_PointerIndex( gather.brushHash, gather.brushes, bref->b, false ) == -1 ) {
+			CM_PointerIndex( gather.brushHash, gather.brushes, bref->b, true );
+			CM_PointerIndex( gather.materialHash, gather.materials, bref->b->material, true );
+		}
+	}
+	if ( node->planeType != -1 ) {
+		CM_GatherBinaryData_r( gather, node->children[0] );
+		CM_GatherBinaryData_r( gather, node->children[1] );
+	}
+}
+
+/*
+================
+CM_CheckBinaryCount
+
+makes sure an element count read from the cache cannot run past the end of the file
+================
+*/
+static bool CM_CheckBinaryCount( idFile *fp, int count, int elementSize ) {
+	return ( count >= 0 && (long long)count * elementSize <= fp->Length() - fp->Tell() );
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModel
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModel( idFile *fp, cm_model_t *model ) {
+	cm_binaryGather_t gather;
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+	cm_polygon_t *p;
+	cm_brush_t *b;
+	cm_node_t *node;
+	int i, j, polygonMemory, brushMemory;
+
+	gather.numPolygonRefs = 0;
+	gather.numBrushRefs = 0;
+	if ( model->node ) {
+		CM_GatherBinaryData_r( gather, model->node );
+	}
+
+	polygonMemory = 0;
+	for ( i = 0; i < gather.polygons.Num(); i++ ) {
+		polygonMemory += sizeof( cm_polygon_t ) + ( gather.polygons[i]->numEdges - 1 ) * sizeof( gather.polygons[i]->edges[0] );
+	}
+	brushMemory = 0;
+	for ( i = 0; i < gather.brushes.Num(); i++ ) {
+		brushMemory += sizeof( cm_brush_t ) + ( gather.brushes[i]->numPlanes - 1 ) * sizeof( gather.brushes[i]->planes[0] );
+	}
+
+	fp->WriteString( model->name );
+	fp->WriteBool( model->isConvex );
+	fp->WriteInt( model->numVertices );
+	fp->WriteInt( model->numEdges );
+	fp->WriteInt( gather.materials.Num() );
+	fp->WriteInt( gather.polygons.Num() );
+	fp->WriteInt( polygonMemory );
+	fp->WriteInt( gather.brushes.Num() );
+	fp->WriteInt( brushMemory );
+	fp->WriteInt( gather.nodes.Num() );
+	fp->WriteInt( gather.numPolygonRefs );
+	fp->WriteInt( gather.numBrushRefs );
+	fp->WriteInt( model->numInternalEdges );
+	fp->WriteInt( model->numSharpEdges );
+	fp->WriteInt( model->numRemovedPolys );
+	fp->WriteInt( model->numMergedPolys );
+
+	// materials
+	for ( i = 0; i < gather.materials.Num(); i++ ) {
+		fp->WriteString( gather.materials[i]->GetName() );
+	}
+	// vertices
+	for ( i = 0; i < model->numVertices; i++ ) {
+		fp->WriteVec3( model->vertices[i].p );
+	}
+	// edges, the normals are stored so they don't need to be recalculated
+	for ( i = 0; i < model->numEdges; i++ ) {
+		fp->WriteInt( model->edges[i].vertexNum[0] );
+		fp->WriteInt( model->edges[i].vertexNum[1] );
+		fp->WriteUnsignedShort( model->edges[i].internal );
+		fp->WriteUnsignedShort( model->edges[i].numUsers );
+		fp->WriteVec3( model->edges[i].normal );
+	}
+	// polygons
+	for ( i = 0; i < gather.polygons.Num(); i++ ) {
+		p = gather.polygons[i];
+		fp->WriteInt( p->numEdges );
+		for ( j = 0; j < p->numEdges; j++ ) {
+			fp->WriteInt( p->edges[j] );
+		}
+		fp->WriteVec4( p->plane.ToVec4() );
+		fp->WriteVec3( p->bounds[0] );
+		fp->WriteVec3( p->bounds[1] );
+		fp->WriteInt( CM_PointerIndex( gather.materialHash, gather.materials, p->material, false ) );
+	}
+	// brushes
+	for ( i = 0; i < gather.brushes.Num(); i++ ) {
+		b = gather.brushes[i];
+		fp->WriteInt( b->numPlanes );
+		for ( j = 0; j < b->numPlanes; j++ ) {
+			fp->WriteVec4( b->planes[j].ToVec4() );
+		}
+		fp->WriteVec3( b->bounds[0] );
+		fp->WriteVec3( b->bounds[1] );
+		fp->WriteInt( b->contents );
+		fp->WriteInt( b->primitiveNum );
+		fp->WriteInt( CM_PointerIndex( gather.materialHash, gather.materials, b->material, false ) );
+	}
+	// nodes with index links and the references in list order
+	for ( i = 0; i < gather.nodes.Num(); i++ ) {
+		node = gather.nodes[i];
+		fp->WriteInt( node->planeType );
+		fp->WriteFloat( node->planeDist );
+		fp->WriteInt( CM_PointerIndex( gather.nodeHash, gather.nodes, node->parent, false ) );
+		if ( node->planeType != -1 ) {
+			fp->WriteInt( CM_PointerIndex( gather.nodeHash, gather.nodes, node->children[0], false ) );
+			fp->WriteInt( CM_PointerIndex( gather.nodeHash, gather.nodes, node->children[1], false ) );
+		}
+		j = 0;
+		for ( pref = node->polygons; pref; pref = pref->next ) {
+			j++;
+		}
+		fp->WriteInt( j );
+		for ( pref = node->polygons; pref; pref = pref->next ) {
+			fp->WriteInt( CM_PointerIndex( gather.polygonHash, gather.polygons, pref->p, false ) );
+		}
+		j = 0;
+		for ( bref = node->brushes; bref; bref = bref->next ) {
+			j++;
+		}
+		fp->WriteInt( j );
+		for ( bref = node->brushes; bref; bref = bref->next ) {
+			fp->WriteInt( CM_PointerIndex( gather.brushHash, gather.brushes, bref->b, false ) );
+		}
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile( const char *filename, int firstModel, int lastModel, unsigned int mapFileCRC, ID_TIME_T mapFileTime ) {
+	idStr cacheName;
+	int i;
+
+	CM_BinaryCacheFileName( filename, cacheName );
+
+	idFile_Memory file( cacheName );
+	file.WriteInt( CM_BINARY_CACHE_MAGIC );
+	file.WriteInt( CM_BINARY_CACHE_VERSION );
+	file.WriteUnsignedInt( mapFileCRC );
+	file.WriteUnsignedInt( (unsigned int)mapFileTime );
+	file.WriteInt( lastModel - firstModel );
+	for ( i = firstModel; i < lastModel; i++ ) {
+		WriteBinaryCollisionModel( &file, models[i] );
+	}
+
+	if ( fileSystem->WriteFile( cacheName, file.GetDataPtr(), file.Length() ) < 0 ) {
+		common->Warning( "idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile: Error writing file %s\n", cacheName.c_str() );
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::LoadBinaryCollisionModel
+
+returns NULL if the data is damaged
+================
+*/
+cm_model_t *idCollisionModelManagerLocal::LoadBinaryCollisionModel( idFile *fp ) {
+	cm_model_t *model;
+	cm_nodeBlock_t *nodeBlock;
+	cm_polygonRefBlock_t *prefBlock;
+	cm_brushRefBlock_t *brefBlock;
+	cm_node_t *nodes, *node;
+	cm_polygonRef_t *prefs, *pref;
+	cm_brushRef_t *brefs, *bref;
+	cm_polygon_t *p;
+	cm_brush_t *b;
+	idList<const idMaterial *> materials;
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	int numMaterials, numPolygons, polygonMemory, numBrushes, brushMemory;
+	int numNodes, numPolygonRefs, numBrushRefs;
+	int i, j, index, count, size;
+	idStr name;
+
+	model = AllocModel();
+	fp->ReadString( model->name );
+	fp->ReadBool( model->isConvex );
+	fp->ReadInt( model->numVertices );
+	fp->ReadInt( model->numEdges );
+	fp->ReadInt( numMaterials );
+	fp->ReadInt( numPolygons );
+	fp->ReadInt( polygonMemory );
+	fp->ReadInt( numBrushes );
+	fp->ReadInt( brushMemory );
+	fp->ReadInt( numNodes );
+	fp->ReadInt( numPolygonRefs );
+	fp->ReadInt( numBrushRefs );
+	fp->ReadInt( model->numInternalEdges );
+	fp->ReadInt( model->numSharpEdges );
+	fp->ReadInt( model->numRemovedPolys );
+	fp->ReadInt( model->numMergedPolys );
+
+	if ( !CM_CheckBinaryCount( fp, model->numVertices, 12 ) || !CM_CheckBinaryCount( fp, model->numEdges, 24 ) ||
+			!CM_CheckBinaryCount( fp, numMaterials, 4 ) || !CM_CheckBinaryCount( fp, numPolygons, 52 ) ||
+			!CM_CheckBinaryCount( fp, numBrushes, 56 ) || !CM_CheckBinaryCount( fp, numNodes, 20 ) || numNodes < 1 ||
+			!CM_CheckBinaryCount( fp, numPolygonRefs, 4 ) || !CM_CheckBinaryCount( fp, numBrushRefs, 4 ) ||
+			polygonMemory < 0 || brushMemory < 0 ) {
+		model->numVertices = model->numEdges = 0;
+		FreeModel( model );
+		return NULL;
+	}
+
+	// materials
+	materials.SetNum( numMaterials );
+	for ( i = 0; i < numMaterials; i++ ) {
+		fp->ReadString( name );
+		materials[i] = declManager->FindMaterial( name );
+	}
+
+	// vertices
+	model->maxVertices = model->numVertices;
+	model->vertices = (cm_vertex_t *) Mem_Alloc( model->maxVertices * sizeof( cm_vertex_t ) );
+	for ( i = 0; i < model->numVertices; i++ ) {
+		fp->ReadVec3( model->vertices[i].p );
+		model->vertices[i].side = 0;
+		model->vertices[i].sideSet = 0;
+		model->vertices[i].checkcount = 0;
+	}
+
+	// edges
+	model->maxEdges = model->numEdges;
+	model->edges = (cm_edge_t *) Mem_Alloc( model->maxEdges * sizeof( cm_edge_t ) );
+	for ( i = 0; i < model->numEdges; i++ ) {
+		fp->ReadInt( model->edges[i].vertexNum[0] );
+		fp->ReadInt( model->edges[i].vertexNum[1] );
+		fp->ReadUnsignedShort( model->edges[i].internal );
+		fp->ReadUnsignedShort( model->edges[i].numUsers );
+		fp->ReadVec3( model->edges[i].normal );
+		model->edges[i].side = 0;
+		model->edges[i].sideSet = 0;
+		model->edges[i].checkcount = 0;
+		if ( model->edges[i].vertexNum[0] < 0 || model->edges[i].vertexNum[0] >= model->numVertices ||
+				model->edges[i].vertexNum[1] < 0 || model->edges[i].vertexNum[1] >= model->numVertices ) {
+			goto damaged;
+		}
+	}
+
+	// all polygons go into a single block
+	model->polygonBlock = (cm_polygonBlock_t *) Mem_Alloc( sizeof( cm_polygonBlock_t ) + polygonMemory );
+	model->polygonBlock->bytesRemaining = polygonMemory;
+	model->polygonBlock->next = ( (byte *) model->polygonBlock ) + sizeof( cm_polygonBlock_t );
+	polygons.SetNum( numPolygons );
+	for ( i = 0; i < numPolygons; i++ ) {
+		fp->ReadInt( count );
+		size = sizeof( cm_polygon_t ) + ( count - 1 ) * sizeof( p->edges[0] );
+		if ( count < 1 || size > model->polygonBlock->bytesRemaining ) {
+			goto damaged;
+		}
+		p = AllocPolygon( model, count );
+		p->numEdges = count;
+		for ( j = 0; j < count; j++ ) {
+			fp->ReadInt( p->edges[j] );
+			if ( abs( p->edges[j] ) >= model->numEdges ) {
+				goto damaged;
+			}
+		}
+		fp->ReadVec4( p->plane.ToVec4() );
+		fp->ReadVec3( p->bounds[0] );
+		fp->ReadVec3( p->bounds[1] );
+		fp->ReadInt( index );
+		if ( index < 0 || index >= numMaterials ) {
+			goto damaged;
+		}
+		// contents come from the material just like with the text .cm files
+		p->material = materials[index];
+		p->contents = p->material->GetContentFlags();
+		p->checkcount = 0;
+		polygons[i] = p;
+	}
+
+	// all brushes go into a single block
+	model->brushBlock = (cm_brushBlock_t *) Mem_Alloc( sizeof( cm_brushBlock_t ) + brushMemory );
+	model->brushBlock->bytesRemaining = brushMemory;
+	model->brushBlock->next = ( (byte *) model->brushBlock ) + sizeof( cm_brushBlock_t );
+	brushes.SetNum( numBrushes );
+	for ( i = 0; i < numBrushes; i++ ) {
+		fp->ReadInt( count );
+		size = sizeof( cm_brush_t ) + ( count - 1 ) * sizeof( b->planes[0] );
+		if ( count < 1 || size > model->brushBlock->bytesRemaining ) {
+			goto damaged;
+		}
+		b = AllocBrush( model, count );
+		b->numPlanes = count;
+		for ( j = 0; j < count; j++ ) {
+			fp->ReadVec4( b->planes[j].ToVec4() );
+		}
+		fp->ReadVec3( b->bounds[0] );
+		fp->ReadVec3( b->bounds[1] );
+		fp->ReadInt( b->contents );
+		fp->ReadInt( b->primitiveNum );
+		fp->ReadInt( index );
+		if ( index < -1 || index >= numMaterials ) {
+			goto damaged;
+		}
+		b->material = ( index >= 0 ) ? materials[index] : NULL;
+		b->checkcount = 0;
+		brushes[i] = b;
+	}
+
+	// nodes and references each go into a single block
+	nodeBlock = (cm_nodeBlock_t *) Mem_ClearedAlloc( sizeof( cm_nodeBlock_t ) + numNodes * sizeof( cm_node_t ) );
+	nodeBlock->nextNode = NULL;
+	nodeBlock->next = NULL;
+	model->nodeBlocks = nodeBlock;
+	nodes = (cm_node_t *) ( ( (byte *) nodeBlock ) + sizeof( cm_nodeBlock_t ) );
+
+	prefBlock = (cm_polygonRefBlock_t *) Mem_Alloc( sizeof( cm_polygonRefBlock_t ) + numPolygonRefs * sizeof( cm_polygonRef_t ) );
+	prefBlock->nextRef = NULL;
+	prefBlock->next = NULL;
+	model->polygonRefBlocks = prefBlock;
+	prefs = (cm_polygonRef_t *) ( ( (byte *) prefBlock ) + sizeof( cm_polygonRefBlock_t ) );
+
+	brefBlock = (cm_brushRefBlock_t *) Mem_Alloc( sizeof( cm_brushRefBlock_t ) + numBrushRefs * sizeof( cm_brushRef_t ) );
+	brefBlock->nextRef = NULL;
+	brefBlock->next = NULL;
+	model->brushRefBlocks = brefBlock;
+	brefs = (cm_brushRef_t *) ( ( (byte *) brefBlock ) + sizeof( cm_brushRefBlock_t ) );
+
+	for ( i = 0; i < numNodes; i++ ) {
+		node = &nodes[i];
+		fp->ReadInt( node->planeType );
+		fp->ReadFloat( node->planeDist );
+		// the nodes are stored depth first so parents always come before their children
+		fp->ReadInt( index );
+		if ( index >= i || ( index < 0 && i != 0 ) ) {
+			goto damaged;
+		}
+		node->parent = ( index >= 0 ) ? &nodes[index] : NULL;
+		if ( node->planeType != -1 ) {
+			if ( node->planeType < 0 || node->planeType > 2 ) {
+				goto damaged;
+			}
+			for ( j = 0; j < 2; j++ ) {
+				fp->ReadInt( index );
+				if ( index <= i || index >= numNodes ) {
+					goto damaged;
+				}
+				node->children[j] = &nodes[index];
+			}
+		}
+		fp->ReadInt( count );
+		if ( count < 0 || count > numPolygonRefs - model->numPolygonRefs ) {
+			goto damaged;
+		}
+		node->polygons = NULL;
+		for ( j = 0; j < count; j++ ) {
+			fp->ReadInt( index );
+			if ( index < -1 || index >= numPolygons ) {
+				goto damaged;
+			}
+			pref = &prefs[model->numPolygonRefs++];
+			pref->p = ( index >= 0 ) ? polygons[index] : NULL;
+			pref->next = NULL;
+			if ( j > 0 ) {
+				pref[-1].next = pref;
+			} else {
+				node->polygons = pref;
+			}
+		}
+		fp->ReadInt( count );
+		if ( count < 0 || count > numBrushRefs - model->numBrushRefs ) {
+			goto damaged;
+		}
+		node->brushes = NULL;
+		for ( j = 0; j < count; j++ ) {
+			fp->ReadInt( index );
+			if ( index < -1 || index >= numBrushes ) {
+				goto damaged;
+			}
+			bref = &brefs[model->numBrushRefs++];
+			bref->b = ( index >= 0 ) ? brushes[index] : NULL;
+			bref->next = NULL;
+			if ( j > 0 ) {
+				bref[-1].next = bref;
+			} else {
+				node->brushes = bref;
+			}
+		}
+	}
+	model->numNodes = numNodes;
+	model->node = &nodes[0];
+
+	// get model bounds from brush and polygon bounds
+	CM_GetNodeBounds( &model->bounds, model->node );
+	// get model contents
+	model->contents = CM_GetNodeContents( model->node );
+	// total memory used by this model
+	model->usedMemory = model->numVertices * sizeof(cm_vertex_t) +
+						model->numEdges * sizeof(cm_edge_t) +
+						model->polygonMemory +
+						model->brushMemory +
+						model->numNodes * sizeof(cm_node_t) +
+						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
+						model->numBrushRefs * sizeof(cm_brushRef_t);
+
+	return model;
+
+damaged:
+	// everything lives in blocks so the partially linked tree does not have to be walked
+	model->node = NULL;
+	FreeModel( model );
+	return NULL;
+}
+
+/*
+================
+idCollisionModelManagerLocal::PreloadMap
+
+the cache is read on the I/O threads while the render world and the map file are loaded
+================
+*/
+void idCollisionModelManagerLocal::PreloadMap( const char *mapName ) {
+	idStr name;
+
+	CancelPreload();
+
+	if ( cm_binaryCache.GetInteger() != 1 ) {
+		return;
+	}
+
+	name = mapName;
+	name.StripFileExtension();
+	CM_BinaryCacheFileName( name, preloadName );
+	preloadHandle = fileSystem->ReadFileAsync( preloadName, FS_READ_PRIORITY_NORMAL );
+	preloadPending = true;
+}
+
+/*
+================
+idCollisionModelManagerLocal::CancelPreload
+================
+*/
+void idCollisionModelManagerLocal::CancelPreload( void ) {
+	if ( preloadPending ) {
+		fileSystem->CancelRead( preloadHandle );
+		preloadPending = false;
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::LoadBinaryCollisionModelFile
+
+the cache is only used if it was built from a map with the same geometry CRC and timestamp
+================
+*/
+bool idCollisionModelManagerLocal::LoadBinaryCollisionModelFile( const char *name, unsigned int mapFileCRC, ID_TIME_T mapFileTime ) {
+	idStr cacheName;
+	void *buffer;
+	int length, value, count, i, firstModel;
+	unsigned int crc, time;
+	cm_model_t *model;
+
+	CM_BinaryCacheFileName( name, cacheName );
+
+	// the read was usually started before the map file was parsed
+	if ( preloadPending && preloadName.Icmp( cacheName ) == 0 ) {
+		preloadPending = false;
+		length = fileSystem->WaitRead( preloadHandle, &buffer );
+	} else {
+		CancelPreload();
+		length = fileSystem->ReadFile( cacheName, &buffer, NULL );
+	}
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory file( cacheName, (const char *)buffer, length );
+
+	file.ReadInt( value );
+	if ( value != CM_BINARY_CACHE_MAGIC ) {
+		common->Warning( "%s is not a binary collision model cache", cacheName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+	file.ReadInt( value );
+	file.ReadUnsignedInt( crc );
+	file.ReadUnsignedInt( time );
+	if ( value != CM_BINARY_CACHE_VERSION || crc != mapFileCRC || time != (unsigned int)mapFileTime ) {
+		common->DPrintf( "%s is out of date\n", cacheName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	file.ReadInt( count );
+	if ( count < 0 || numModels + count > MAX_SUBMODELS ) {
+		common->Warning( "%s has %d collision models", cacheName.c_str(), count );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	firstModel = numModels;
+	for ( i = 0; i < count; i++ ) {
+		model = LoadBinaryCollisionModel( &file );
+		if ( !model ) {
+			common->Warning( "%s is damaged", cacheName.c_str() );
+			while ( numModels > firstModel ) {
+				numModels--;
+				FreeModel( models[numModels] );
+				models[numModels] = NULL;
+			}
+			fileSystem->FreeFile( buffer );
+			return false;
+		}
+		models[numModels] = model;
+		numModels++;
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	common->DPrintf( "loaded %d collision models from %s\n", count, cacheName.c_str() );
+
+	return true;
+}
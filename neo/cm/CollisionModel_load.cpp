@@ -3294,6 +3294,8 @@ void idCollisionModelManagerLocal::BuildModels( const idMapFile *mapFile ) {
 
 	//BC force reloading the collision model. Changes were sometimes not being propagated.
 	//if ( !LoadCollisionModelFile( mapFile->GetName(), mapFile->GetGeometryCRC() ) )
+	// the binary cache is keyed on the map timestamp as well so any change to the map rebuilds it
+	if ( cm_binaryCache.GetInteger() != 1 || !LoadBinaryCollisionModelFile( mapFile->GetName(), mapFile->GetGeometryCRC(), mapFile->GetFileTime() ) )
 	{
 
 		if ( !mapFile->GetNumEntities() ) {
@@ -3323,6 +3325,11 @@ void idCollisionModelManagerLocal::BuildModels( const idMapFile *mapFile ) {
 
 		// write the collision models to a file
 		WriteCollisionModelsToFile( mapFile->GetName(), 0, numModels, mapFile->GetGeometryCRC() );
+
+		// write the flat binary version that is used on the next load
+		if ( cm_binaryCache.GetInteger() != 0 ) {
+			WriteBinaryCollisionModelsToFile( mapFile->GetName(), 0, numModels, mapFile->GetGeometryCRC(), mapFile->GetFileTime() );
+		}
 	}
 
 	timer.Stop();
@@ -3353,6 +3360,7 @@ void idCollisionModelManagerLocal::LoadMap( const idMapFile *mapFile ) {
 		if ( mapName.Icmp( mapFile->GetName() ) == 0 ) {
 			if ( mapFile->GetFileTime() == mapFileTime ) {
 				common->DPrintf( "Using loaded version\n" );
+				CancelPreload();
 				return;
 			}
 			common->DPrintf( "Reloading modified map\n" );
@@ -3376,6 +3384,8 @@ void idCollisionModelManagerLocal::LoadMap( const idMapFile *mapFile ) {
 
 	// build collision models
 	BuildModels( mapFile );
+	// the models were built without the binary cache
+	CancelPreload();
 
 	// save name and time stamp
 	mapName = mapFile->GetName();
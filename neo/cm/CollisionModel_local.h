@@ -279,6 +279,39 @@ typedef struct cm_traceWork_s {
 	idVec3 polygonRotationOriginCache[CM_MAX_POLYGON_EDGES];
 } cm_traceWork_t;
 
+#define CM_POINT_PACKET_SIZE				32		// number of points traced together by TranslationPoints
+
+typedef struct cm_pointTrace_s {
+	idVec3 start;									// start of trace in model space
+	idVec3 end;										// end of trace in model space
+	idVec3 endp;									// start + dir, end point used for the collision fraction
+	idVec3 dir;										// trace direction
+	idPluecker pl;									// pluecker coordinate for the point movement
+	idPlane heartPlane1;							// polygons should be near enough the trace heart planes
+	idPlane heartPlane2;
+	trace_t trace;									// collision detection result
+} cm_pointTrace_t;
+
+typedef struct cm_pointPacket_s {
+	cm_model_t *model;								// model colliding with
+	int contents;									// ignore polygons that do not have any of these contents flags
+	int ignoreContents;								// ignore polygons that have any of these contents flags
+	int numPoints;
+	cm_pointTrace_t points[CM_POINT_PACKET_SIZE];
+	// trace bounds and directions in SoA layout for testing four points against a polygon at once
+	ALIGN16( float boundsMin[3][CM_POINT_PACKET_SIZE] );
+	ALIGN16( float boundsMax[3][CM_POINT_PACKET_SIZE] );
+	ALIGN16( float dir[3][CM_POINT_PACKET_SIZE] );
+} cm_pointPacket_t;
+
+typedef struct cm_pointSegments_s {
+	unsigned int mask;								// one bit for each point of the packet that passes through the node
+	float p1f[CM_POINT_PACKET_SIZE];				// fraction of the trace where the point enters the node
+	float p2f[CM_POINT_PACKET_SIZE];				// fraction of the trace where the point leaves the node
+	idVec3 p1[CM_POINT_PACKET_SIZE];
+	idVec3 p2[CM_POINT_PACKET_SIZE];
+} cm_pointSegments_t;
+
 /*
 ===============================================================================
 
@@ -296,6 +329,8 @@ class idCollisionModelManagerLocal : public idCollisionModelManager {
 public:
 	// load collision models from a map file
 	void			LoadMap( const idMapFile *mapFile );
+	// start reading the binary cache of a map
+	void			PreloadMap( const char *mapName );
 	// frees all the collision models
 	void			FreeMap( void );
 
@@ -323,6 +358,9 @@ public:
 	void			Translation( trace_t *results, const idVec3 &start, const idVec3 &end,
 								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
 								cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis, int ignoreContentMask );
+	// translates a batch of points and reports the first collision of each
+	void			TranslationPoints( trace_t *results, const idVec3 *starts, const idVec3 *ends, const int numPoints, int contentMask,
+								cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis, int ignoreContentMask );
 	// rotates a trm and reports the first collision if any
 	void			Rotation( trace_t *results, const idVec3 &start, const idRotation &rotation,
 								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
@@ -400,6 +438,8 @@ private:			// CollisionMap_trace.cpp
 	void			TraceThroughAxialBSPTree_r( cm_traceWork_t *tw, cm_node_t *node, float p1f, float p2f, idVec3 &p1, idVec3 &p2);
 	void			TraceThroughModel( cm_traceWork_t *tw );
 	void			RecurseProcBSP_r( trace_t *results, int parentNodeNum, int nodeNum, float p1f, float p2f, const idVec3 &p1, const idVec3 &p2 );
+	void			TracePointPacketThroughNode( cm_pointPacket_t *packet, cm_node_t *node, unsigned int mask );
+	void			TracePointPacketThroughAxialBSPTree_r( cm_pointPacket_t *packet, cm_node_t *node, const cm_pointSegments_t &segments );
 
 private:			// CollisionMap_load.cpp
 	void			Clear( void );
@@ -491,6 +531,12 @@ private:			// CollisionMap_files.cpp
 	void			ParseBrushes( idLexer *src, cm_model_t *model );
 	bool			ParseCollisionModel( idLexer *src );
 	bool			LoadCollisionModelFile( const char *name, unsigned int mapFileCRC );
+					// binary cache
+	void			WriteBinaryCollisionModel( idFile *fp, cm_model_t *model );
+	void			WriteBinaryCollisionModelsToFile( const char *filename, int firstModel, int lastModel, unsigned int mapFileCRC, ID_TIME_T mapFileTime );
+	cm_model_t *	LoadBinaryCollisionModel( idFile *fp );
+	bool			LoadBinaryCollisionModelFile( const char *name, unsigned int mapFileCRC, ID_TIME_T mapFileTime );
+	void			CancelPreload( void );
 
 private:			// CollisionMap_debug
 	int				ContentsFromString( const char *string ) const;
@@ -505,6 +551,10 @@ private:			// collision map data
 	idStr			mapName;
 	ID_TIME_T			mapFileTime;
 	int				loaded;
+					// binary cache read started by PreloadMap
+	bool			preloadPending;
+	int				preloadHandle;
+	idStr			preloadName;
 					// for multi-check avoidance
 	int				checkCount;
 					// models
@@ -527,3 +577,5 @@ private:			// collision map data
 
 // for debugging
 extern idCVar cm_debugCollision;
+// binary collision model cache
+extern idCVar cm_binaryCache;
@@ -34,6 +34,14 @@ If you have questions concerning this license or the applicable additional terms
 ===============================================================================
 */
 
+#if defined(__BLENDO_SIMD__)
+	#include <immintrin.h>
+	#define CM_SIMD_POINT_PACKETS
+#elif defined(__GNUC__) && defined(__SSE2__)
+	#include <xmmintrin.h>
+	#define CM_SIMD_POINT_PACKETS
+#endif
+
 #include "sys/platform.h"
 
 #include "cm/CollisionModel_local.h"
@@ -253,3 +261,434 @@ void idCollisionModelManagerLocal::TraceThroughModel( cm_traceWork_t *tw ) {
 		idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r( tw, tw->model->node, 0, 1, start, tw->end );
 	}
 }
+
+/*
+===============================================================================
+
+Batched point traces
+
+  Points are traced through the spatial subdivision in packets. Every node is
+  visited once per packet instead of once per point, and the polygons of a node
+  are tested against all points of the packet that reach it. The polygon and
+  edge checkcounts are not used, a point may test a polygon more than once but
+  that never changes the result. Without them nothing shared is written, so
+  packets can be traced on several threads at once.
+
+===============================================================================
+*/
+
+float CM_TranslationPlaneFraction( idPlane &plane, idVec3 &start, idVec3 &end );
+
+/*
+================
+CM_PointPacketCandidates
+
+  returns a bit for each point of the mask whose trace bounds touch the polygon
+  bounds and which approaches the polygon from the front
+================
+*/
+static unsigned int CM_PointPacketCandidates( const cm_pointPacket_t *packet, const cm_polygon_t *p, unsigned int mask ) {
+	unsigned int candidates = 0;
+
+#if defined(CM_SIMD_POINT_PACKETS)
+	const __m128 polyMinX = _mm_set1_ps( p->bounds[0][0] );
+	const __m128 polyMinY = _mm_set1_ps( p->bounds[0][1] );
+	const __m128 polyMinZ = _mm_set1_ps( p->bounds[0][2] );
+	const __m128 polyMaxX = _mm_set1_ps( p->bounds[1][0] );
+	const __m128 polyMaxY = _mm_set1_ps( p->bounds[1][1] );
+	const __m128 polyMaxZ = _mm_set1_ps( p->bounds[1][2] );
+	const __m128 normalX = _mm_set1_ps( p->plane[0] );
+	const __m128 normalY = _mm_set1_ps( p->plane[1] );
+	const __m128 normalZ = _mm_set1_ps( p->plane[2] );
+	const __m128 zero = _mm_setzero_ps();
+
+	for ( int i = 0; i < packet->numPoints; i += 4 ) {
+		if ( !( ( mask >> i ) & 15 ) ) {
+			continue;
+		}
+		__m128 in;
+		in = _mm_and_ps( _mm_cmpge_ps( _mm_load_ps( packet->boundsMax[0] + i ), polyMinX ), _mm_cmple_ps( _mm_load_ps( packet->boundsMin[0] + i ), polyMaxX ) );
+		in = _mm_and_ps( in, _mm_cmpge_ps( _mm_load_ps( packet->boundsMax[1] + i ), polyMinY ) );
+		in = _mm_and_ps( in, _mm_cmple_ps( _mm_load_ps( packet->boundsMin[1] + i ), polyMaxY ) );
+		in = _mm_and_ps( in, _mm_cmpge_ps( _mm_load_ps( packet->boundsMax[2] + i ), polyMinZ ) );
+		in = _mm_and_ps( in, _mm_cmple_ps( _mm_load_ps( packet->boundsMin[2] + i ), polyMaxZ ) );
+
+		// only collide with the polygon if approaching at the front
+		__m128 d = _mm_mul_ps( normalX, _mm_load_ps( packet->dir[0] + i ) );
+		d = _mm_add_ps( d, _mm_mul_ps( normalY, _mm_load_ps( packet->dir[1] + i ) ) );
+		d = _mm_add_ps( d, _mm_mul_ps( normalZ, _mm_load_ps( packet->dir[2] + i ) ) );
+		in = _mm_and_ps( in, _mm_cmple_ps( d, zero ) );
+
+		candidates |= (unsigned int)_mm_movemask_ps( in ) << i;
+	}
+#else
+	for ( int i = 0; i < packet->numPoints; i++ ) {
+		if ( !( mask & ( 1u << i ) ) ) {
+			continue;
+		}
+		if ( packet->boundsMax[0][i] < p->bounds[0][0] || packet->boundsMin[0][i] > p->bounds[1][0] ||
+				packet->boundsMax[1][i] < p->bounds[0][1] || packet->boundsMin[1][i] > p->bounds[1][1] ||
+				packet->boundsMax[2][i] < p->bounds[0][2] || packet->boundsMin[2][i] > p->bounds[1][2] ) {
+			continue;
+		}
+		if ( p->plane[0] * packet->dir[0][i] + p->plane[1] * packet->dir[1][i] + p->plane[2] * packet->dir[2][i] > 0.0f ) {
+			continue;
+		}
+		candidates |= 1u << i;
+	}
+#endif
+
+	return candidates & mask;
+}
+
+/*
+================
+CM_TranslatePointThroughPolygon
+
+  same as idCollisionModelManagerLocal::TranslatePointThroughPolygon without the edge sidedness cache
+================
+*/
+static void CM_TranslatePointThroughPolygon( cm_pointTrace_t *pt, const cm_model_t *model, cm_polygon_t *poly ) {
+	int i, edgeNum;
+	float f, fl;
+	const cm_edge_t *edge;
+	idPluecker pl;
+
+	f = CM_TranslationPlaneFraction( poly->plane, pt->start, pt->endp );
+	if ( f >= pt->trace.fraction ) {
+		return;
+	}
+
+	for ( i = 0; i < poly->numEdges; i++ ) {
+		edgeNum = poly->edges[i];
+		edge = model->edges + abs(edgeNum);
+		pl.FromLine( model->vertices[edge->vertexNum[0]].p, model->vertices[edge->vertexNum[1]].p );
+		fl = pt->pl.PermutedInnerProduct( pl );
+		// if the point passes the edge at the wrong side
+		if ( INTSIGNBITSET(edgeNum) ^ FLOATSIGNBITSET(fl) ) {
+			return;
+		}
+	}
+	if ( f < 0.0f ) {
+		f = 0.0f;
+	}
+	pt->trace.fraction = f;
+	// collision plane is the polygon plane
+	pt->trace.c.normal = poly->plane.Normal();
+	pt->trace.c.dist = poly->plane.Dist();
+	pt->trace.c.contents = poly->contents;
+	pt->trace.c.material = poly->material;
+	pt->trace.c.type = CONTACT_TRMVERTEX;
+	pt->trace.c.modelFeature = *reinterpret_cast<int *>(&poly);
+	pt->trace.c.trmFeature = 0;
+	pt->trace.c.point = pt->start + pt->trace.fraction * ( pt->endp - pt->start );
+}
+
+/*
+================
+idCollisionModelManagerLocal::TracePointPacketThroughNode
+================
+*/
+void idCollisionModelManagerLocal::TracePointPacketThroughNode( cm_pointPacket_t *packet, cm_node_t *node, unsigned int mask ) {
+	cm_polygonRef_t *pref;
+	cm_polygon_t *p;
+	unsigned int candidates;
+	cm_pointTrace_t *pt;
+	float d;
+
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		p = pref->p;
+
+		// if this polygon does not have the right contents behind it
+		if ( !(p->contents & packet->contents) || (p->contents != -1 && (p->contents & packet->ignoreContents)) ) {
+			continue;
+		}
+
+		candidates = CM_PointPacketCandidates( packet, p, mask );
+
+		for ( int i = 0; candidates; i++, candidates >>= 1 ) {
+			if ( !( candidates & 1 ) ) {
+				continue;
+			}
+			pt = &packet->points[i];
+
+			// if the polygon is too far from the first heart plane
+			d = p->bounds.PlaneDistance( pt->heartPlane1 );
+			if ( idMath::Fabs( d ) > CM_BOX_EPSILON ) {
+				continue;
+			}
+			// if the polygon is too far from the second heart plane
+			d = p->bounds.PlaneDistance( pt->heartPlane2 );
+			if ( idMath::Fabs( d ) > CM_BOX_EPSILON ) {
+				continue;
+			}
+
+			CM_TranslatePointThroughPolygon( pt, packet->model, p );
+		}
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::TracePointPacketThroughAxialBSPTree_r
+
+  same subdivision as TraceThroughAxialBSPTree_r for a point trace, for all points of the packet at once
+================
+*/
+void idCollisionModelManagerLocal::TracePointPacketThroughAxialBSPTree_r( cm_pointPacket_t *packet, cm_node_t *node, const cm_pointSegments_t &segments ) {
+	float		t1, t2, offset;
+	float		frac, frac2;
+	float		idist;
+	int			side;
+	unsigned int mask, bit;
+	cm_pointSegments_t children[2];
+
+	if ( !node ) {
+		return;
+	}
+
+	// drop the points that already hit something nearer
+	mask = segments.mask;
+	for ( int i = 0; i < packet->numPoints; i++ ) {
+		bit = 1u << i;
+		if ( ( mask & bit ) && packet->points[i].trace.fraction <= segments.p1f[i] ) {
+			mask &= ~bit;
+		}
+	}
+	if ( !mask ) {
+		return;
+	}
+
+	// if we need to test this node for collisions
+	if ( node->polygons ) {
+		TracePointPacketThroughNode( packet, node, mask );
+	}
+	// if this is a leaf node
+	if ( node->planeType == -1 ) {
+		return;
+	}
+
+	children[0].mask = children[1].mask = 0;
+	offset = CM_BOX_EPSILON;
+
+	for ( int i = 0; i < packet->numPoints; i++ ) {
+		bit = 1u << i;
+		if ( !( mask & bit ) ) {
+			continue;
+		}
+
+		const float p1f = segments.p1f[i];
+		const float p2f = segments.p2f[i];
+		const idVec3 &p1 = segments.p1[i];
+		const idVec3 &p2 = segments.p2[i];
+
+		// distance from plane for trace start and end
+		t1 = p1[node->planeType] - node->planeDist;
+		t2 = p2[node->planeType] - node->planeDist;
+
+		// see which sides we need to consider
+		if ( t1 >= offset && t2 >= offset ) {
+			side = 0;
+		} else if ( t1 < -offset && t2 < -offset ) {
+			side = 1;
+		} else {
+			side = -1;
+		}
+
+		if ( side != -1 ) {
+			cm_pointSegments_t &child = children[side];
+			child.mask |= bit;
+			child.p1f[i] = p1f;
+			child.p2f[i] = p2f;
+			child.p1[i] = p1;
+			child.p2[i] = p2;
+			continue;
+		}
+
+		if ( t1 < t2 ) {
+			idist = 1.0f / (t1-t2);
+			side = 1;
+			frac2 = (t1 + offset) * idist;
+			frac = (t1 - offset) * idist;
+		} else if (t1 > t2) {
+			idist = 1.0f / (t1-t2);
+			side = 0;
+			frac2 = (t1 - offset) * idist;
+			frac = (t1 + offset) * idist;
+		} else {
+			side = 0;
+			frac = 1.0f;
+			frac2 = 0.0f;
+		}
+
+		// move up to the node
+		if ( frac < 0.0f ) {
+			frac = 0.0f;
+		}
+		else if ( frac > 1.0f ) {
+			frac = 1.0f;
+		}
+
+		cm_pointSegments_t &nearSide = children[side];
+		nearSide.mask |= bit;
+		nearSide.p1f[i] = p1f;
+		nearSide.p2f[i] = p1f + (p2f - p1f)*frac;
+		nearSide.p1[i] = p1;
+		nearSide.p2[i][0] = p1[0] + frac*(p2[0] - p1[0]);
+		nearSide.p2[i][1] = p1[1] + frac*(p2[1] - p1[1]);
+		nearSide.p2[i][2] = p1[2] + frac*(p2[2] - p1[2]);
+
+		// go past the node
+		if ( frac2 < 0.0f ) {
+			frac2 = 0.0f;
+		}
+		else if ( frac2 > 1.0f ) {
+			frac2 = 1.0f;
+		}
+
+		cm_pointSegments_t &farSide = children[side^1];
+		farSide.mask |= bit;
+		farSide.p1f[i] = p1f + (p2f - p1f)*frac2;
+		farSide.p2f[i] = p2f;
+		farSide.p1[i][0] = p1[0] + frac2*(p2[0] - p1[0]);
+		farSide.p1[i][1] = p1[1] + frac2*(p2[1] - p1[1]);
+		farSide.p1[i][2] = p1[2] + frac2*(p2[2] - p1[2]);
+		farSide.p2[i] = p2;
+	}
+
+	if ( children[0].mask ) {
+		TracePointPacketThroughAxialBSPTree_r( packet, node->children[0], children[0] );
+	}
+	if ( children[1].mask ) {
+		TracePointPacketThroughAxialBSPTree_r( packet, node->children[1], children[1] );
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::TranslationPoints
+================
+*/
+void idCollisionModelManagerLocal::TranslationPoints( trace_t *results, const idVec3 *starts, const idVec3 *ends, const int numPoints, int contentMask,
+										cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis, int ignoreContentMask ) {
+	bool model_rotated;
+	idMat3 invModelAxis;
+	idVec3 dir;
+	ALIGN16( cm_pointPacket_t packet );
+	cm_pointSegments_t segments;
+
+	for ( int i = 0; i < numPoints; i++ ) {
+		memset( &results[i], 0, sizeof( results[i] ) );
+		results[i].fraction = 1.0f;
+		results[i].endpos = ends[i];
+		results[i].endAxis = mat3_identity;
+	}
+
+	if ( model < 0 || model > MAX_SUBMODELS || model > idCollisionModelManagerLocal::maxModels ) {
+		common->Printf("idCollisionModelManagerLocal::TranslationPoints: invalid model handle\n");
+		return;
+	}
+	if ( !idCollisionModelManagerLocal::models[model] ) {
+		common->Printf("idCollisionModelManagerLocal::TranslationPoints: invalid model\n");
+		return;
+	}
+
+	model_rotated = modelAxis.IsRotated();
+	if ( model_rotated ) {
+		invModelAxis = modelAxis.Transpose();
+	}
+
+	memset( packet.boundsMin, 0, sizeof( packet.boundsMin ) );
+	memset( packet.boundsMax, 0, sizeof( packet.boundsMax ) );
+	memset( packet.dir, 0, sizeof( packet.dir ) );
+	packet.model = idCollisionModelManagerLocal::models[model];
+	packet.contents = contentMask;
+	packet.ignoreContents = ignoreContentMask;
+
+	for ( int first = 0; first < numPoints; first += CM_POINT_PACKET_SIZE ) {
+
+		packet.numPoints = Min( numPoints - first, CM_POINT_PACKET_SIZE );
+		segments.mask = 0;
+
+		for ( int i = 0; i < packet.numPoints; i++ ) {
+			const idVec3 &start = starts[first + i];
+			const idVec3 &end = ends[first + i];
+			cm_pointTrace_t &pt = packet.points[i];
+
+			pt.trace.fraction = 1.0f;
+			pt.trace.c.contents = 0;
+			pt.trace.c.type = CONTACT_NONE;
+
+			// position tests are not supported
+			if ( start[0] == end[0] && start[1] == end[1] && start[2] == end[2] ) {
+				continue;
+			}
+
+			pt.start = start - modelOrigin;
+			pt.end = end - modelOrigin;
+			pt.dir = end - start;
+			if ( model_rotated ) {
+				// rotate trace instead of model
+				pt.start *= invModelAxis;
+				pt.end *= invModelAxis;
+				pt.dir *= invModelAxis;
+			}
+			pt.endp = pt.start + pt.dir;
+			pt.pl.FromRay( pt.start, pt.dir );
+
+			// trace heart planes
+			idVec3 normal1, normal2;
+			dir = pt.dir;
+			dir.Normalize();
+			dir.NormalVectors( normal1, normal2 );
+			pt.heartPlane1.SetNormal( normal1 );
+			pt.heartPlane1.FitThroughPoint( pt.start );
+			pt.heartPlane2.SetNormal( normal2 );
+			pt.heartPlane2.FitThroughPoint( pt.start );
+
+			// trace bounds
+			for ( int j = 0; j < 3; j++ ) {
+				if ( pt.start[j] < pt.end[j] ) {
+					packet.boundsMin[j][i] = pt.start[j] - CM_BOX_EPSILON;
+					packet.boundsMax[j][i] = pt.end[j] + CM_BOX_EPSILON;
+				}
+				else {
+					packet.boundsMin[j][i] = pt.end[j] - CM_BOX_EPSILON;
+					packet.boundsMax[j][i] = pt.start[j] + CM_BOX_EPSILON;
+				}
+				packet.dir[j][i] = pt.dir[j];
+			}
+
+			segments.mask |= 1u << i;
+			segments.p1f[i] = 0.0f;
+			segments.p2f[i] = 1.0f;
+			segments.p1[i] = pt.start;
+			segments.p2[i] = pt.end;
+		}
+
+		// trace through the model
+		TracePointPacketThroughAxialBSPTree_r( &packet, packet.model->node, segments );
+
+		// store results
+		for ( int i = 0; i < packet.numPoints; i++ ) {
+			trace_t &result = results[first + i];
+			const idVec3 &start = starts[first + i];
+			const idVec3 &end = ends[first + i];
+
+			if ( packet.points[i].trace.fraction >= 1.0f ) {
+				continue;
+			}
+
+			result = packet.points[i].trace;
+			result.endpos = start + result.fraction * ( end - start );
+			result.endAxis = mat3_identity;
+			// rotate trace plane normal if there was a collision with a rotated model
+			if ( model_rotated ) {
+				result.c.normal *= modelAxis;
+				result.c.point *= modelAxis;
+			}
+			result.c.point += modelOrigin;
+			result.c.dist += modelOrigin * result.c.normal;
+		}
+	}
+}
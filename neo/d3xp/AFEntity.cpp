@@ -120,6 +120,10 @@ idMultiModelAF::Present
 void idMultiModelAF::Present( void ) {
 	int i;
 
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	// don't present to the renderer if the entity hasn't changed
 	if ( !( thinkFlags & TH_UPDATEVISUALS ) ) {
 		return;
@@ -1190,6 +1194,10 @@ idAFEntity_Gibbable::Present
 void idAFEntity_Gibbable::Present( void ) {
 	renderEntity_t skeleton;
 
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	if ( !gameLocal.isNewFrame ) {
 		return;
 	}
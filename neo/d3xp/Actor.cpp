@@ -2207,6 +2207,13 @@ bool idActor::CanSee( idEntity *ent, bool useFov ) {
 		}
 	}
 
+	//The perception manager may have traced this pair already.
+	int cachedSight = gameLocal.aiPerception.GetSight( this, ent );
+	if ( cachedSight != -1 )
+	{
+		return cachedSight != 0;
+	}
+
 	if ( ent->IsType( idActor::Type ) )
 	{
 		//Do a traceline check to the target's EYES.
@@ -280,6 +280,7 @@ public:
 
 protected:
 	friend class			idAnimState;
+	friend class			idAIPerception;
 
 	float					fovDot;				// cos( fovDegrees )
 	idVec3					eyeOffset;			// offset of eye relative to physics origin
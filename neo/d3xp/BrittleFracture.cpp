@@ -663,6 +663,9 @@ idBrittleFracture::Present
 ================
 */
 void idBrittleFracture::Present() {
+	if ( PresentDeferred() ) {
+		return;
+	}
 
 	// don't present to the renderer if the entity hasn't changed
 	if ( !( thinkFlags & TH_UPDATEVISUALS ) ) {
@@ -31,6 +31,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "idlib/LangDict.h"
 #include "framework/async/NetworkSystem.h"
 #include "framework/DeclEntityDef.h"
+#include "framework/Profiler.h"
 #include "renderer/ModelManager.h"
 #include "renderer/tr_local.h"
 
@@ -703,6 +704,7 @@ void idEntity::Spawn( void ) {
 	fl.solidForTeam = spawnArgs.GetBool( "solidForTeam", "0" );
 	fl.neverDormant = spawnArgs.GetBool( "neverDormant", "0" );
 	fl.drawGlobally = spawnArgs.GetBool( "drawGlobally", "0" );
+	fl.thinkParallel = spawnArgs.GetBool( "thinkParallel", "0" );
 	if (fl.drawGlobally)
 	{
 		// Force our globally drawn entity to render on top of everything
@@ -1487,6 +1489,19 @@ void idEntity::Think( void ) {
 	Present();
 }
 
+/*
+================
+idEntity::IsThinkParallelSafe
+
+entities opt in with the "thinkParallel" spawnarg, classes that only ever
+touch their own state while thinking can override this. Such entities must
+use idParallelThink::Random instead of gameLocal.random.
+================
+*/
+bool idEntity::IsThinkParallelSafe( void ) const {
+	return fl.thinkParallel;
+}
+
 /*
 ================
 idEntity::DoDormantTests
@@ -1586,6 +1601,11 @@ idEntity::BecomeActive
 ================
 */
 void idEntity::BecomeActive( int flags ) {
+	if ( idParallelThink::IsDeferring() ) {
+		idParallelThink::DeferActivate( this, flags, true );
+		return;
+	}
+
 	if (thinkFlags == TH_DISABLED) {
 		return;
 	}
@@ -1620,6 +1640,11 @@ idEntity::BecomeInactive
 ================
 */
 void idEntity::BecomeInactive( int flags ) {
+	if ( idParallelThink::IsDeferring() ) {
+		idParallelThink::DeferActivate( this, flags, false );
+		return;
+	}
+
 	if (thinkFlags == TH_DISABLED) {
 		return;
 	}
@@ -2090,6 +2115,23 @@ void idEntity::ProjectOverlay( const idVec3 &origin, const idVec3 &dir, float si
 	}
 }
 
+/*
+================
+idEntity::PresentDeferred
+
+The render world is updated after the parallel think phase. The whole virtual
+Present is queued and runs again from idParallelThink::Merge, so derived
+classes must call this before they touch anything.
+================
+*/
+bool idEntity::PresentDeferred( void ) {
+	if ( idParallelThink::IsDeferring() ) {
+		idParallelThink::DeferPresent( this );
+		return true;
+	}
+	return false;
+}
+
 /*
 ================
 idEntity::Present
@@ -2099,6 +2141,10 @@ Present is called to allow entities to generate refEntities, lights, etc for the
 */
 void idEntity::Present( void ) {
 
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	if ( !gameLocal.isNewFrame ) {
 		return;
 	}
@@ -2109,6 +2155,8 @@ void idEntity::Present( void ) {
 	}
 	BecomeInactive( TH_UPDATEVISUALS );
 
+	idThinkProfileScope thinkScope( THINKPROFILE_PRESENT, this );
+
 	// camera target for remote render views
 	// SM: Static entities won't ever set the render view if they aren't within
 	// the original player PVS on spawn.
@@ -3326,6 +3374,8 @@ bool idEntity::RunPhysics( void ) {
 	idEntity *	part, *blockedPart, *blockingEntity = nullptr;
 	bool		moved;
 
+	PROFILE_SCOPE( "idEntity::RunPhysics" );
+
 	if ( thinkFlags == TH_DISABLED ) {
 		return false;
 	}
@@ -170,6 +170,7 @@ public:
 		bool				networkSync			:1; // if true the entity is synchronized over the network
 		bool				grabbed				:1;	// if true object is currently being grabbed
 		bool				drawGlobally		:1; // always draw this, regardless of whether it would usually be culled
+		bool				thinkParallel		:1; // if true the entity may think on the job workers, see idParallelThink
 	} fl;
 
 #ifdef _D3XP
@@ -216,6 +217,7 @@ public:
 
 	// thinking
 	virtual void			Think( void );
+	virtual bool			IsThinkParallelSafe( void ) const;	// Think only changes this entity, see idParallelThink
 	bool					CheckDormant( void );	// dormant == on the active list, but out of PVS
 	virtual	void			DormantBegin( void );	// called when entity becomes dormant
 	virtual	void			DormantEnd( void );		// called when entity wakes from being dormant
@@ -226,6 +228,7 @@ public:
 
 	// visuals
 	virtual void			Present( void );
+	bool					PresentDeferred( void );	// every Present override has to start with this, see idParallelThink
 	virtual renderEntity_t *GetRenderEntity( void );
 	virtual int				GetModelDefHandle( void );
 	virtual void			SetModel( const char *modelname );
@@ -92,6 +92,10 @@ idCursor3D::Present
 ===============
 */
 void idCursor3D::Present( void ) {
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	// don't present to the renderer if the entity hasn't changed
 	if ( !( thinkFlags & TH_UPDATEVISUALS ) ) {
 		return;
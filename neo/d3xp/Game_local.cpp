@@ -33,6 +33,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "framework/BuildVersion.h"
 #include "framework/DeclEntityDef.h"
 #include "framework/FileSystem.h"
+#include "framework/Profiler.h"
 #include "renderer/ModelManager.h"
 #include "tools/compilers/aas/AASFileManager.h"
 #include "ui/FeedAlertWindow.h"
@@ -102,6 +103,8 @@ idUserInterfaceManager *	uiManager = NULL;
 idDeclManager *				declManager = NULL;
 idAASFileManager *			AASFileManager = NULL;
 idCollisionModelManager *	collisionModelManager = NULL;
+idJobSystem *				jobSystem = NULL;
+idProfiler *				profiler = NULL;
 idCVar *					idCVar::staticVars = NULL;
 
 idCVar com_forceGenericSIMD( "com_forceGenericSIMD", "0", CVAR_BOOL|CVAR_SYSTEM, "force generic platform independent SIMD" );
@@ -202,6 +205,8 @@ extern "C" ID_GAME_API gameExport_t *GetGameAPI( gameImport_t *import ) {
 		declManager					= import->declManager;
 		AASFileManager				= import->AASFileManager;
 		collisionModelManager		= import->collisionModelManager;
+		jobSystem					= import->jobSystem;
+		profiler					= import->profiler;
 	}
 
 	// set interface pointers used by idLib
@@ -296,6 +301,7 @@ void idGameLocal::Clear( void ) {
 	cinematicStopTime = 0;
 	cinematicMaxSkipTime = 0;
 	framenum = 0;
+	aiPathRequestFrame = -1;
 	previousTime = 0;
 	time = 0;
 	hudTime = 0;
@@ -473,31 +479,12 @@ void idGameLocal::Init( void ) {
 	}
 #endif
 
-	// load default scripts
-	program.Startup( SCRIPT_DEFAULT );
-
-#ifdef _D3XP
-	//BSM Nerve: Loads a game specific main script file
-	idStr gamedir;
-	int i;
-	for ( i = 0; i < 2; i++ ) {
-		if ( i == 0 ) {
-			gamedir = cvarSystem->GetCVarString( "fs_game_base" );
-		} else if ( i == 1 ) {
-			gamedir = cvarSystem->GetCVarString( "fs_game" );
-		}
-		if( gamedir.Length() > 0 ) {
-			idStr scriptFile = va( "script/%s_main.script", gamedir.c_str() );
-			if ( fileSystem->ReadFile( scriptFile.c_str(), NULL ) > 0 ) {
-				program.CompileFile( scriptFile.c_str() );
-				program.FinishCompilation();
-			}
-		}
-	}
-#endif
+	LoadScripts();
 
 	smokeParticles = new idSmokeParticles;
 
+	parallelThink.Init();
+
 	// set up the aas
 	dict = FindEntityDefDict( "aas_types" );
 	if ( !dict ) {
@@ -555,6 +542,38 @@ void idGameLocal::Init( void ) {
 	}
 }
 
+/*
+===========
+idGameLocal::LoadScripts
+
+  compiles the default scripts, or loads them from the compiled script cache
+============
+*/
+void idGameLocal::LoadScripts( void ) {
+	// load default scripts
+	program.Startup( SCRIPT_DEFAULT );
+
+#ifdef _D3XP
+	//BSM Nerve: Loads a game specific main script file
+	idStr gamedir;
+	int i;
+	for ( i = 0; i < 2; i++ ) {
+		if ( i == 0 ) {
+			gamedir = cvarSystem->GetCVarString( "fs_game_base" );
+		} else if ( i == 1 ) {
+			gamedir = cvarSystem->GetCVarString( "fs_game" );
+		}
+		if( gamedir.Length() > 0 ) {
+			idStr scriptFile = va( "script/%s_main.script", gamedir.c_str() );
+			if ( fileSystem->ReadFile( scriptFile.c_str(), NULL ) > 0 ) {
+				program.CompileFile( scriptFile.c_str() );
+				program.FinishCompilation();
+			}
+		}
+	}
+#endif
+}
+
 /*
 ===========
 idGameLocal::Shutdown
@@ -590,6 +609,8 @@ void idGameLocal::Shutdown( void ) {
 	delete smokeParticles;
 	smokeParticles = NULL;
 
+	parallelThink.Shutdown();
+
 	idClass::Shutdown();
 
 	// clear list with forces
@@ -1645,6 +1666,9 @@ void idGameLocal::MapPopulate( void ) {
 	// before the physics are run so entities can bind correctly
 	Printf( "==== Processing events ====\n" );
 	idEvent::ServiceEvents();
+
+	// the doors have set their area states by now
+	BuildAASRoutingTables();
 }
 
 /*
@@ -2090,6 +2114,8 @@ bool idGameLocal::InitFromSaveGame( const char *mapName, idRenderWorld *renderWo
 		return false;
 	}
 
+	idEvent::RestoreObjectLinks();
+
 	// blendo eric: added for post setup, similar to spawn
 	for (int idx = 0; idx < MAX_GENTITIES; idx++) {
 		if (entities[idx] != NULL) {
@@ -2104,6 +2130,8 @@ bool idGameLocal::InitFromSaveGame( const char *mapName, idRenderWorld *renderWo
 	// free up any unused animations
 	animationLib.FlushUnusedAnims();
 
+	BuildAASRoutingTables();
+
 	gamestate = GAMESTATE_ACTIVE;
 
 	return true;
@@ -2157,6 +2185,9 @@ void idGameLocal::MapClear( bool clearClients ) {
 
 	entityHash.Clear( 1024, MAX_GENTITIES );
 
+	aiPerception.Clear();
+	thinkProfiler.Clear();
+
 	if ( !clearClients ) {
 		// add back the hashes of the clients
 		for ( i = 0; i < MAX_CLIENTS; i++ ) {
@@ -3035,8 +3066,11 @@ void idGameLocal::RunTimeGroup2() {
 			continue;
 		}
 
-		if ( !ent->IsFrozen() )
+		if ( !ent->IsFrozen() ) {
+			PROFILE_SCOPE( ent->GetClassname() );
+			idThinkProfileScope thinkScope( THINKPROFILE_THINK, ent );
 			ent->Think();
+		}
 		num++;
 	}
 
@@ -3058,6 +3092,8 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 	idPlayer	*player;
 	const renderView_t *view;
 
+	PROFILE_SCOPE( "idGameLocal::RunFrame" );
+
 #ifdef _DEBUG
 	if ( isMultiplayer ) {
 		assert( !isClient );
@@ -3154,6 +3190,15 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 		// sort the active entity list
 		SortActiveEntityList();
 
+		// start the think profile of this frame
+		thinkProfiler.BeginFrame();
+
+		// batch the sight checks of the AI before they think
+		aiPerception.RunFrame();
+
+		// query the paths of the moving AI on the job workers
+		RunAIPathRequests();
+
 		timer_think.Clear();
 		timer_think.Start();
 
@@ -3167,8 +3212,11 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 				}
 				timer_singlethink.Clear();
 				timer_singlethink.Start();
-				if ( !ent->IsFrozen() )
+				if ( !ent->IsFrozen() ) {
+					PROFILE_SCOPE( ent->GetClassname() );
+					idThinkProfileScope thinkScope( THINKPROFILE_THINK, ent );
 					ent->Think();
+				}
 				timer_singlethink.Stop();
 				ms = timer_singlethink.Milliseconds();
 				if ( ms >= g_timeentities.GetFloat() ) {
@@ -3184,20 +3232,35 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 						ent->GetPhysics()->UpdateTime( time );
 						continue;
 					}
-					if ( !ent->IsFrozen() )
+					if ( !ent->IsFrozen() ) {
+						PROFILE_SCOPE( ent->GetClassname() );
+						idThinkProfileScope thinkScope( THINKPROFILE_THINK, ent );
 						ent->Think();
+					}
 					num++;
 				}
 			} else {
 				num = 0;
+				int numParallel = 0;
+				if ( g_thinkParallel.GetInteger() != 0 ) {
+					// entities that are safe to think in parallel go first
+					numParallel = parallelThink.Run( activeEntities.Next() );
+				}
 				for( ent = activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next() ) {
 #ifdef _D3XP
 					if ( ent->timeGroup != TIME_GROUP1 ) {
 						continue;
 					}
 #endif
-					if ( !ent->IsFrozen() )
+					if ( numParallel && parallelThink.HasThought( ent ) ) {
+						num++;
+						continue;
+					}
+					if ( !ent->IsFrozen() ) {
+						PROFILE_SCOPE( ent->GetClassname() );
+						idThinkProfileScope thinkScope( THINKPROFILE_THINK, ent );
 						ent->Think();
+					}
 					num++;
 				}
 			}
@@ -3238,6 +3301,8 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 
 		timer_events.Stop();
 
+		thinkProfiler.EndFrame();
+
 		// free the player pvs
 		FreePlayerPVS();
 
@@ -3396,6 +3461,8 @@ makes rendering and sound system calls
 ================
 */
 bool idGameLocal::Draw( int clientNum ) {
+	PROFILE_SCOPE( "idGameLocal::Draw" );
+
 	if ( isMultiplayer ) {
 		return mpGame.Draw( clientNum );
 	}
@@ -4111,6 +4178,7 @@ void idGameLocal::SetAASAreaState( const idBounds &bounds, const int areaContent
 	for( i = 0; i < aasList.Num(); i++ ) {
 		aasList[ i ]->SetAreaState( bounds, areaContents, closed );
 	}
+	aiPathRequestFrame = -1;
 }
 
 /*
@@ -4132,6 +4200,7 @@ aasHandle_t idGameLocal::AddAASObstacle( const idBounds &bounds ) {
 		check = aasList[ i ]->AddObstacle( bounds );
 		assert( check == obstacle );
 	}
+	aiPathRequestFrame = -1;
 
 	return obstacle;
 }
@@ -4147,6 +4216,7 @@ void idGameLocal::RemoveAASObstacle( const aasHandle_t handle ) {
 	for( i = 0; i < aasList.Num(); i++ ) {
 		aasList[ i ]->RemoveObstacle( handle );
 	}
+	aiPathRequestFrame = -1;
 }
 
 /*
@@ -4160,6 +4230,75 @@ void idGameLocal::RemoveAllAASObstacles( void ) {
 	for( i = 0; i < aasList.Num(); i++ ) {
 		aasList[ i ]->RemoveAllObstacles();
 	}
+	aiPathRequestFrame = -1;
+}
+
+/*
+==================
+idGameLocal::BuildAASRoutingTables
+==================
+*/
+void idGameLocal::BuildAASRoutingTables( void ) {
+	int i;
+
+	for( i = 0; i < aasList.Num(); i++ ) {
+		aasList[ i ]->BuildRoutingTable();
+	}
+}
+
+/*
+==================
+idGameLocal::RunAIPathRequests
+
+  Gathers the path every moving AI is going to ask for in idAI::GetMovePos and runs
+  them as one batch per AAS. The AI pick up the result in idAI::PathToGoal as long
+  as nothing changed the request in the meantime.
+==================
+*/
+void idGameLocal::RunAIPathRequests( void ) {
+	int i, j;
+	idEntity *ent;
+
+	PROFILE_SCOPE( "idGameLocal::RunAIPathRequests" );
+
+	aiPathRequestFrame = -1;
+
+	if ( !ai_pathRequests.GetBool() ) {
+		return;
+	}
+
+	for( i = 0; i < aasList.Num(); i++ ) {
+		aiPathRequests.SetNum( 0, false );
+		aiPathRequestOwners.SetNum( 0, false );
+
+		for( ent = activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next() ) {
+			if ( !ent->IsType( idAI::Type ) || ent->fl.isDormant || !( ent->thinkFlags & TH_THINK ) ) {
+				continue;
+			}
+			idAI *ai = static_cast<idAI *>( ent );
+			if ( ai->GetAAS() != aasList[ i ] ) {
+				continue;
+			}
+			if ( ai->SetupPathRequest( aiPathRequests.Alloc() ) ) {
+				aiPathRequestOwners.Append( ai );
+			} else {
+				aiPathRequests.RemoveIndex( aiPathRequests.Num() - 1 );
+			}
+		}
+
+		if ( !aiPathRequests.Num() ) {
+			continue;
+		}
+
+		aasList[ i ]->PathRequests( aiPathRequests.Ptr(), aiPathRequests.Num() );
+
+		for( j = 0; j < aiPathRequests.Num(); j++ ) {
+			aiPathRequestOwners[ j ]->SetPathRequestResult( aiPathRequests[ j ] );
+		}
+	}
+
+	// until an area or obstacle changes the routing
+	aiPathRequestFrame = framenum;
 }
 
 /*
@@ -4294,6 +4433,9 @@ returning false if not found
 ===================
 */
 bool idGameLocal::SpawnEntityDef( const idDict &args, idEntity **ent, bool setDefaults ) {
+	static const idDictKey key_name( "name" );
+	static const idDictKey key_classname( "classname" );
+	static const idDictKey key_spawnclass( "spawnclass" );
 	const char	*classname;
 	const char	*spawn;
 	idTypeInfo	*cls;
@@ -4307,11 +4449,11 @@ bool idGameLocal::SpawnEntityDef( const idDict &args, idEntity **ent, bool setDe
 
 	spawnArgs = args;
 
-	if ( spawnArgs.GetString( "name", "", &name ) ) {
+	if ( spawnArgs.GetString( key_name, "", &name ) ) {
 		sprintf( error, " on '%s'", name);
 	}
 
-	spawnArgs.GetString( "classname", NULL, &classname );
+	spawnArgs.GetString( key_classname, NULL, &classname );
 
 	const idDeclEntityDef *def = FindEntityDef( classname, false );
 
@@ -4340,7 +4482,7 @@ bool idGameLocal::SpawnEntityDef( const idDict &args, idEntity **ent, bool setDe
 #endif
 
 	// check if we should spawn a class object
-	spawnArgs.GetString( "spawnclass", NULL, &spawn );
+	spawnArgs.GetString( key_spawnclass, NULL, &spawn );
 	if ( spawn ) {
 
 		cls = idClass::GetClass( spawn );
@@ -41,8 +41,11 @@ If you have questions concerning this license or the applicable additional terms
 #include "physics/Push.h"
 #include "script/Script_Program.h"
 #include "ai/AAS.h"
+#include "ai/AI_Perception.h"
 #include "anim/Anim.h"
 #include "Pvs.h"
+#include "gamesys/ParallelThink.h"
+#include "gamesys/ThinkProfiler.h"
 #include "MultiplayerGame.h"
 
 #include "bc_vomanager.h" //BC
@@ -75,6 +78,7 @@ extern idSoundWorld *				gameSoundWorld;
 // classes used by idGameLocal
 class idEntity;
 class idActor;
+class idAI;
 class idPlayer;
 class idCamera;
 class idWorldspawn;
@@ -453,6 +457,10 @@ public:
 	idClip					clip;					// collision detection
 	idPush					push;					// geometric pushing
 	idPVS					pvs;					// potential visible set
+	idParallelThink			parallelThink;			// entities thinking on the job workers
+	idAIPerception			aiPerception;			// batched sight checks of the AI
+	idThinkProfiler			thinkProfiler;			// think, present and event costs per class
+	int						aiPathRequestFrame;		// frame the batched AI paths are valid for, reset when the AAS routing changes
 
 	idTestModel *			testmodel;				// for development testing of models
 	idEntityFx *			testFx;					// for development testing of fx
@@ -609,10 +617,12 @@ public:
 	aasHandle_t				AddAASObstacle( const idBounds &bounds );
 	void					RemoveAASObstacle( const aasHandle_t handle );
 	void					RemoveAllAASObstacles( void );
+	void					BuildAASRoutingTables( void );
 
 	bool					CheatsOk( bool requirePlayer = true );
 	void					SetSkill( int value );
 	gameState_t				GameState( void ) const;
+	void					LoadScripts( void );
 	idEntity *				SpawnEntityType( const idTypeInfo &classdef, const idDict *args = NULL, bool bIsClientReadSnapshot = false );
 	bool					SpawnEntityDef( const idDict &args, idEntity **ent = NULL, bool setDefaults = true );
 	int						GetSpawnId( const idEntity *ent ) const;
@@ -939,6 +949,9 @@ private:
 
 	byte					lagometer[ LAGO_IMG_HEIGHT ][ LAGO_IMG_WIDTH ][ 4 ];
 
+	idList<aasPathRequest_t> aiPathRequests;		// path requests of the moving AI, run before they think
+	idList<idAI *>			aiPathRequestOwners;
+
 	void					Clear( void );
 							// returns true if the entity shouldn't be spawned at all in this game type or difficulty level
 	bool					InhibitEntitySpawn( idDict &spawnArgs );
@@ -953,6 +966,7 @@ private:
 	void					FreePlayerPVS( void );
 	void					UpdateGravity( void );
 	void					SortActiveEntityList( void );
+	void					RunAIPathRequests( void );
 	void					ShowTargets( void );
 	void					RunDebugInfo( void );
 
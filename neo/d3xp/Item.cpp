@@ -319,6 +319,10 @@ idItem::Present
 ================
 */
 void idItem::Present( void ) {
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	idEntity::Present();
 
 	if ( !fl.hidden )
@@ -1649,6 +1653,10 @@ idItemTeam::Present
 ================
 */
 void idItemTeam::Present( void ) {
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	// hide the flag for localplayer if in first person
 	if ( carried && GetBindMaster() ) {
 		idPlayer * player = static_cast<idPlayer *>( GetBindMaster() );
@@ -3497,6 +3505,10 @@ bool idMoveableItem::Pickup( idPlayer *player ) {
 
 void idMoveableItem::Present()
 {
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	idItem::Present();
 	if (showItemLine && GetBindMaster() == NULL)
 	{
@@ -1087,6 +1087,10 @@ idLight::Present
 ================
 */
 void idLight::Present( void ) {
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	// don't present to the renderer if the entity hasn't changed
 	if ( !( thinkFlags & TH_UPDATEVISUALS ) ) {
 		return;
@@ -1181,6 +1181,10 @@ Present is called to allow entities to generate refEntities, lights, etc for the
 ================
 */
 void idSecurityCamera::Present( void ) {
+	if ( PresentDeferred() ) {
+		return;
+	}
+
 	// don't present to the renderer if the entity hasn't changed
 	if ( !( thinkFlags & TH_UPDATEVISUALS ) ) {
 		return;
@@ -56,6 +56,16 @@ idAASLocal::idAASLocal
 */
 idAASLocal::idAASLocal( void ) {
 	file = NULL;
+	memset( routingScratch, 0, sizeof( routingScratch ) );
+	routingBatch = 0;
+	routingJobList = NULL;
+	routingTableBuilt = false;
+	clusterAreas = NULL;
+	memset( &repairFrameStats, 0, sizeof( repairFrameStats ) );
+	memset( &repairPeakStats, 0, sizeof( repairPeakStats ) );
+	memset( &repairTotalStats, 0, sizeof( repairTotalStats ) );
+	repairFrameNum = -1;
+	repairFrames = 0;
 }
 
 /*
@@ -65,6 +75,10 @@ idAASLocal::~idAASLocal
 */
 idAASLocal::~idAASLocal( void ) {
 	Shutdown();
+	if ( routingJobList ) {
+		jobSystem->FreeJobList( routingJobList );
+		routingJobList = NULL;
+	}
 }
 
 /*
@@ -87,6 +101,8 @@ bool idAASLocal::Init( const idStr &mapName, unsigned int mapFileCRC ) {
 		}
 		SetupRouting();
 	}
+	// rebuilt once the map entities have set the area states
+	routingTableBuilt = false;
 	return true;
 }
 
@@ -61,6 +61,25 @@ typedef struct aasGoal_s {
 } aasGoal_t;
 
 
+enum {
+	AASPATHREQUEST_ROUTE,						// RouteToGoalArea
+	AASPATHREQUEST_WALK,						// WalkPathToGoal
+	AASPATHREQUEST_FLY							// FlyPathToGoal
+};
+
+typedef struct aasPathRequest_s {
+	int							type;			// AASPATHREQUEST_*
+	int							areaNum;
+	idVec3						origin;
+	int							goalAreaNum;
+	idVec3						goalOrigin;
+	int							travelFlags;
+	bool						result;			// set by idAAS::PathRequests
+	int							travelTime;		// only set for AASPATHREQUEST_ROUTE
+	aasPath_t					path;			// the route only sets path.reachability
+} aasPathRequest_t;
+
+
 typedef struct aasObstacle_s {
 	idBounds					absBounds;		// absolute bounds of obstacle
 	idBounds					expAbsBounds;	// expanded absolute bounds of obstacle
@@ -74,10 +93,16 @@ public:
 
 typedef int aasHandle_t;
 
+class idCmdArgs;
+
 class idAAS {
 public:
 	static idAAS *				Alloc( void );
 	virtual						~idAAS( void ) = 0;
+								// Replays random start and goal areas of the loaded map through the routing.
+	static void					RoutingBenchmark_f( const idCmdArgs &args );
+								// Toggles random cluster portals and checks the repaired routing against a rebuild.
+	static void					RoutingRepairTest_f( const idCmdArgs &args );
 								// Initialize for the given map.
 	virtual bool				Init( const idStr &mapName, unsigned int mapFileCRC ) = 0;
 								// Print AAS stats.
@@ -138,6 +163,10 @@ public:
 	virtual void				ShowFlyPath( const idVec3 &origin, int goalAreaNum, const idVec3 &goalOrigin ) const = 0;
 								// Find the nearest goal which satisfies the callback.
 	virtual bool				FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 origin, const idVec3 &target, int travelFlags, aasObstacle_t *obstacles, int numObstacles, idAASCallback &callback ) const = 0;
+								// Precompute the routing between all cluster portals for the default AI travel flags.
+	virtual void				BuildRoutingTable( void ) = 0;
+								// Run a batch of route and path queries, spread over the job workers.
+	virtual void				PathRequests( aasPathRequest_t *requests, int numRequests ) const = 0;
 
 	//Darkmod.
 	virtual idBounds			GetAreaBounds(int areaNum) const = 0;
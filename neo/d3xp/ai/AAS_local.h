@@ -29,9 +29,15 @@ If you have questions concerning this license or the applicable additional terms
 #ifndef __AAS_LOCAL_H__
 #define __AAS_LOCAL_H__
 
+#include <mutex>
+
+#include "framework/BuildDefines.h"
+#include "sys/sys_public.h"
 #include "ai/AAS.h"
 #include "Pvs.h"
 
+class idAASLocal;
+
 class idRoutingCache {
 	friend class idAASLocal;
 
@@ -52,6 +58,7 @@ private:
 	idRoutingCache *			time_next;				// next in time based list
 	idRoutingCache *			time_prev;				// previous in time based list
 	unsigned short				startTravelTime;		// travel time to start with
+	bool						pinned;					// part of the routing table, never linked in the time based list
 	unsigned char *				reachabilities;			// reachabilities used for routing
 	unsigned short *			travelTimes;			// travel time for every area
 };
@@ -72,6 +79,35 @@ private:
 };
 
 
+class idRoutingScratch {
+	friend class idAASLocal;
+
+private:
+	idRoutingUpdate *			areaUpdate;				// memory used to update the area routing cache
+	idRoutingUpdate *			portalUpdate;			// memory used to update the portal routing cache
+	idRoutingUpdate *			goalUpdate;				// memory used by FindNearestGoal
+	unsigned short *			goalAreaTravelTimes;	// travel times to goal areas
+};
+
+
+typedef struct routingRepairStats_s {
+	int							changes;				// areas and reachabilities enabled or disabled
+	int							areaCaches;				// area caches with recomputed travel times
+	int							entries;				// recomputed area cache travel times
+	int							portalCaches;			// portal caches flooded again
+	int							deletedCaches;			// caches thrown away with aas_routingRepair 0
+	double						ms;
+} routingRepairStats_t;
+
+
+typedef struct routingJob_s {
+	const idAASLocal *			aas;
+	aasPathRequest_t *			requests;				// NULL for the routing table jobs
+	int							first;					// first request, cluster or portal of the job
+	int							num;
+} routingJob_t;
+
+
 class idRoutingObstacle {
 	friend class idAASLocal;
 								idRoutingObstacle( void ) { }
@@ -117,6 +153,11 @@ public:
 	virtual void				ShowWalkPath( const idVec3 &origin, int goalAreaNum, const idVec3 &goalOrigin ) const;
 	virtual void				ShowFlyPath( const idVec3 &origin, int goalAreaNum, const idVec3 &goalOrigin ) const;
 	virtual bool				FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 origin, const idVec3 &target, int travelFlags, aasObstacle_t *obstacles, int numObstacles, idAASCallback &callback ) const;
+	virtual void				BuildRoutingTable( void );
+	virtual void				PathRequests( aasPathRequest_t *requests, int numRequests ) const;
+
+	void						RoutingBenchmark( int numPairs, int seed );
+	void						RoutingRepairTest( int numToggles, int seed );
 
 	//Darkmod.
 	virtual idBounds			GetAreaBounds(int areaNum) const;
@@ -130,15 +171,29 @@ private:	// routing data
 	int							areaCacheIndexSize;		// number of area cache entries
 	idRoutingCache **			portalCacheIndex;		// for each area in the world the travel times from each portal
 	int							portalCacheIndexSize;	// number of portal cache entries
-	idRoutingUpdate *			areaUpdate;				// memory used to update the area routing cache
-	idRoutingUpdate *			portalUpdate;			// memory used to update the portal routing cache
-	unsigned short *			goalAreaTravelTimes;	// travel times to goal areas
 	unsigned short *			areaTravelTimes;		// travel times through the areas
 	int							numAreaTravelTimes;		// number of area travel times
 	mutable idRoutingCache *	cacheListStart;			// start of list with cache sorted from oldest to newest
 	mutable idRoutingCache *	cacheListEnd;			// end of list with cache sorted from oldest to newest
 	mutable int					totalCacheMemory;		// total cache memory used
 	idList<idRoutingObstacle *>	obstacleList;			// list with obstacles
+	mutable idRoutingScratch	routingScratch[MAX_JOB_THREADS + 1];	// per thread update memory, the first one is used by the game thread
+	mutable std::mutex			routingCacheLock;		// held while a new cache is added to the index and time based list
+	mutable int					routingBatch;			// set while jobs use the routing, the time based list is left alone meanwhile
+	mutable idList<routingJob_t> routingJobs;
+	mutable idJobList *			routingJobList;
+	bool						routingTableBuilt;		// the routing table was built or loaded for the current file
+	int **						clusterAreas;			// area number of each reachable area in each cluster
+	idList<int>					changedAreas;			// areas enabled or disabled since the last repair
+	idList<idReachability *>	changedReach;			// reachabilities enabled or disabled by obstacles since the last repair
+	idList<int>					repairClusters;
+	idList<byte>				repairState;
+	idList<int>					repairPath;
+	routingRepairStats_t		repairFrameStats;		// repairs of the current frame
+	routingRepairStats_t		repairPeakStats;		// frame that spent the most time repairing
+	routingRepairStats_t		repairTotalStats;
+	int							repairFrameNum;
+	int							repairFrames;			// frames with at least one repair
 
 private:	// routing
 	bool						SetupRouting( void );
@@ -147,8 +202,8 @@ private:	// routing
 	void						CalculateAreaTravelTimes( void );
 	void						DeleteAreaTravelTimes( void );
 	void						SetupRoutingCache( void );
-	void						DeleteClusterCache( int clusterNum );
-	void						DeletePortalCache( void );
+	int							DeleteClusterCache( int clusterNum );
+	int							DeletePortalCache( void );
 	void						ShutdownRoutingCache( void );
 	void						RoutingStats( void ) const;
 	void						LinkCache( idRoutingCache *cache ) const;
@@ -160,7 +215,31 @@ private:	// routing
 	idRoutingCache *			GetAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const;
 	void						UpdatePortalRoutingCache( idRoutingCache *portalCache ) const;
 	idRoutingCache *			GetPortalRoutingCache( int clusterNum, int areaNum, int travelFlags ) const;
-	void						RemoveRoutingCacheUsingArea( int areaNum );
+	idRoutingScratch *			GetRoutingScratch( void ) const;
+	void						FreeRoutingScratch( void );
+	idRoutingCache *			FindRoutingCache( idRoutingCache **list, int travelFlags ) const;
+	idRoutingCache *			AddRoutingCache( idRoutingCache **list, idRoutingCache *cache ) const;
+	void						RemoveRoutingCacheIndex( idRoutingCache *cache ) const;
+	void						PinRoutingCache( idRoutingCache *cache ) const;
+	void						FlushRoutingCache( bool keepTable );
+	void						EvictRoutingCache( void ) const;
+	void						RunRoutingJobs( jobRun_t function ) const;
+	void						PathRequest( aasPathRequest_t &request ) const;
+	static void					PathRequestJob( void *data );
+	static void					RoutingTableClusterJob( void *data );
+	static void					RoutingTablePortalJob( void *data );
+	void						CreateRoutingTable( bool loadCache );
+	unsigned int				RoutingTableKey( int travelFlags ) const;
+	bool						LoadRoutingTable( const char *fileName, unsigned int key, int travelFlags );
+	void						WriteRoutingTable( const char *fileName, unsigned int key, int travelFlags ) const;
+	int							RemoveRoutingCacheUsingArea( int areaNum );
+	bool						AreaInCluster( int areaNum, int clusterNum ) const;
+	void						QueueRoutingUpdate( idRoutingUpdate *update, idRoutingUpdate *&updateListStart, idRoutingUpdate *&updateListEnd ) const;
+	int							FloodAreaRoutingCache( idRoutingCache *areaCache, idRoutingUpdate *areaUpdate, idRoutingUpdate *updateListStart, idRoutingUpdate *updateListEnd ) const;
+	void						SeedAreaRoutingCache( idRoutingCache *areaCache, int areaNum, unsigned short *startAreaTravelTimes, idRoutingUpdate *areaUpdate, idRoutingUpdate *&updateListStart, idRoutingUpdate *&updateListEnd ) const;
+	int							RepairAreaRoutingCache( idRoutingCache *areaCache );
+	void						RepairRoutingCache( void );
+	void						AddRoutingRepairStats( const routingRepairStats_t &stats );
 	void						DisableArea( int areaNum );
 	void						EnableArea( int areaNum );
 	bool						SetAreaState_r( int nodeNum, const idBounds &bounds, const int areaContents, bool disabled );
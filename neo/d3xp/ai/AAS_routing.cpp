@@ -26,7 +26,13 @@ If you have questions concerning this license or the applicable additional terms
 ===========================================================================
 */
 
+#include <atomic>
+
 #include "sys/platform.h"
+#include "idlib/Timer.h"
+#include "idlib/hashing/CRC32.h"
+#include "framework/FileSystem.h"
+#include "gamesys/SysCvar.h"
 #include "Game_local.h"
 
 #include "ai/AAS_local.h"
@@ -38,6 +44,20 @@ If you have questions concerning this license or the applicable additional terms
 
 #define LEDGE_TRAVELTIME_PANALTY	250
 
+#define ROUTING_TABLE_DIR			"generated/aasroute"
+#define ROUTING_TABLE_EXT			"route"
+#define ROUTING_TABLE_MAGIC			( ( 'A' << 24 ) | ( 'R' << 16 ) | ( 'T' << 8 ) | ' ' )
+#define ROUTING_TABLE_VERSION		1
+#define ROUTING_TABLE_TRAVELFLAGS	( TFL_WALK|TFL_AIR )	// default idAI travel flags
+#define ROUTING_TABLE_PORTALS_JOB	8						// portal caches built per job
+
+// RepairAreaRoutingCache area states
+#define ROUTING_REPAIR_UNKNOWN		0
+#define ROUTING_REPAIR_UNREACHED	1
+#define ROUTING_REPAIR_VALID		2
+#define ROUTING_REPAIR_INVALID		3
+#define ROUTING_REPAIR_ON_PATH		4
+
 /*
 ============
 idRoutingCache::idRoutingCache
@@ -51,6 +71,7 @@ idRoutingCache::idRoutingCache( int size ) {
 	travelFlags = 0;
 	startTravelTime = 0;
 	type = 0;
+	pinned = false;
 	this->size = size;
 	reachabilities = new byte[size];
 	memset( reachabilities, 0, size * sizeof( reachabilities[0] ) );
@@ -186,7 +207,7 @@ idAASLocal::SetupRoutingCache
 ============
 */
 void idAASLocal::SetupRoutingCache( void ) {
-	int i;
+	int i, j, side, clusterNum;
 	byte *bytePtr;
 
 	areaCacheIndexSize = 0;
@@ -201,14 +222,38 @@ void idAASLocal::SetupRoutingCache( void ) {
 		bytePtr += file->GetCluster( i ).numReachableAreas * sizeof( idRoutingCache * );
 	}
 
+	// area number of every reachable area in every cluster, the reverse of ClusterAreaNum
+	clusterAreas = (int **) Mem_ClearedAlloc( file->GetNumClusters() * sizeof( int * ) + areaCacheIndexSize * sizeof( int ) );
+	bytePtr = ((byte *)clusterAreas) + file->GetNumClusters() * sizeof( int * );
+	for ( i = 0; i < file->GetNumClusters(); i++ ) {
+		clusterAreas[i] = ( int * ) bytePtr;
+		bytePtr += file->GetCluster( i ).numReachableAreas * sizeof( int );
+	}
+	for ( i = 1; i < file->GetNumAreas(); i++ ) {
+		clusterNum = file->GetArea( i ).cluster;
+		if ( clusterNum > 0 ) {
+			j = file->GetArea( i ).clusterAreaNum;
+			if ( j < file->GetCluster( clusterNum ).numReachableAreas ) {
+				clusterAreas[clusterNum][j] = i;
+			}
+		}
+		else if ( clusterNum < 0 ) {
+			const aasPortal_t &portal = file->GetPortal( -clusterNum );
+			for ( side = 0; side < 2; side++ ) {
+				if ( portal.clusters[side] <= 0 ) {
+					continue;
+				}
+				j = portal.clusterAreaNum[side];
+				if ( j < file->GetCluster( portal.clusters[side] ).numReachableAreas ) {
+					clusterAreas[portal.clusters[side]][j] = i;
+				}
+			}
+		}
+	}
+
 	portalCacheIndexSize = file->GetNumAreas();
 	portalCacheIndex = (idRoutingCache **) Mem_ClearedAlloc( portalCacheIndexSize * sizeof( idRoutingCache * ) );
 
-	areaUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( idRoutingUpdate ) );
-	portalUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( (file->GetNumPortals()+1) * sizeof( idRoutingUpdate ) );
-
-	goalAreaTravelTimes = (unsigned short *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( unsigned short ) );
-
 	cacheListStart = cacheListEnd = NULL;
 	totalCacheMemory = 0;
 }
@@ -218,17 +263,22 @@ void idAASLocal::SetupRoutingCache( void ) {
 idAASLocal::DeleteClusterCache
 ============
 */
-void idAASLocal::DeleteClusterCache( int clusterNum ) {
-	int i;
+int idAASLocal::DeleteClusterCache( int clusterNum ) {
+	int i, numDeleted;
 	idRoutingCache *cache;
 
+	numDeleted = 0;
 	for ( i = 0; i < file->GetCluster( clusterNum ).numReachableAreas; i++ ) {
 		for ( cache = areaCacheIndex[clusterNum][i]; cache; cache = areaCacheIndex[clusterNum][i] ) {
 			areaCacheIndex[clusterNum][i] = cache->next;
-			UnlinkCache( cache );
+			if ( !cache->pinned ) {
+				UnlinkCache( cache );
+			}
 			delete cache;
+			numDeleted++;
 		}
 	}
+	return numDeleted;
 }
 
 /*
@@ -236,17 +286,22 @@ void idAASLocal::DeleteClusterCache( int clusterNum ) {
 idAASLocal::DeletePortalCache
 ============
 */
-void idAASLocal::DeletePortalCache( void ) {
-	int i;
+int idAASLocal::DeletePortalCache( void ) {
+	int i, numDeleted;
 	idRoutingCache *cache;
 
+	numDeleted = 0;
 	for ( i = 0; i < file->GetNumAreas(); i++ ) {
 		for ( cache = portalCacheIndex[i]; cache; cache = portalCacheIndex[i] ) {
 			portalCacheIndex[i] = cache->next;
-			UnlinkCache( cache );
+			if ( !cache->pinned ) {
+				UnlinkCache( cache );
+			}
 			delete cache;
+			numDeleted++;
 		}
 	}
+	return numDeleted;
 }
 
 /*
@@ -266,15 +321,14 @@ void idAASLocal::ShutdownRoutingCache( void ) {
 	Mem_Free( areaCacheIndex );
 	areaCacheIndex = NULL;
 	areaCacheIndexSize = 0;
+	Mem_Free( clusterAreas );
+	clusterAreas = NULL;
 	Mem_Free( portalCacheIndex );
 	portalCacheIndex = NULL;
 	portalCacheIndexSize = 0;
-	Mem_Free( areaUpdate );
-	areaUpdate = NULL;
-	Mem_Free( portalUpdate );
-	portalUpdate = NULL;
-	Mem_Free( goalAreaTravelTimes );
-	goalAreaTravelTimes = NULL;
+	FreeRoutingScratch();
+	changedAreas.Clear();
+	changedReach.Clear();
 
 	cacheListStart = cacheListEnd = NULL;
 	totalCacheMemory = 0;
@@ -308,8 +362,8 @@ idAASLocal::RoutingStats
 */
 void idAASLocal::RoutingStats( void ) const {
 	idRoutingCache *cache;
-	int numAreaCache, numPortalCache;
-	int totalAreaCacheMemory, totalPortalCacheMemory;
+	int i, j, numAreaCache, numPortalCache, numTableCache;
+	int totalAreaCacheMemory, totalPortalCacheMemory, totalTableCacheMemory;
 
 	numAreaCache = numPortalCache = 0;
 	totalAreaCacheMemory = totalPortalCacheMemory = 0;
@@ -323,12 +377,40 @@ void idAASLocal::RoutingStats( void ) const {
 		}
 	}
 
+	// the routing table is not in the time based list
+	numTableCache = totalTableCacheMemory = 0;
+	for ( i = 0; i < file->GetNumClusters(); i++ ) {
+		for ( j = 0; j < file->GetCluster( i ).numReachableAreas; j++ ) {
+			for ( cache = areaCacheIndex[i][j]; cache; cache = cache->next ) {
+				if ( cache->pinned ) {
+					numTableCache++;
+					totalTableCacheMemory += cache->Size();
+				}
+			}
+		}
+	}
+	for ( i = 0; i < file->GetNumAreas(); i++ ) {
+		for ( cache = portalCacheIndex[i]; cache; cache = cache->next ) {
+			if ( cache->pinned ) {
+				numTableCache++;
+				totalTableCacheMemory += cache->Size();
+			}
+		}
+	}
+
 	gameLocal.Printf( "%6d area cache (%d KB)\n", numAreaCache, totalAreaCacheMemory >> 10 );
 	gameLocal.Printf( "%6d portal cache (%d KB)\n", numPortalCache, totalPortalCacheMemory >> 10 );
 	gameLocal.Printf( "%6d total cache (%d KB)\n", numAreaCache + numPortalCache, totalCacheMemory >> 10 );
+	gameLocal.Printf( "%6d routing table cache (%d KB)\n", numTableCache, totalTableCacheMemory >> 10 );
 	gameLocal.Printf( "%6d area travel times (%zd KB)\n", numAreaTravelTimes, ( numAreaTravelTimes * sizeof( unsigned short ) ) >> 10 );
 	gameLocal.Printf( "%6d area cache entries (%zd KB)\n", areaCacheIndexSize, ( areaCacheIndexSize * sizeof( idRoutingCache * ) ) >> 10 );
 	gameLocal.Printf( "%6d portal cache entries (%zd KB)\n", portalCacheIndexSize, ( portalCacheIndexSize * sizeof( idRoutingCache * ) ) >> 10 );
+	if ( repairFrames ) {
+		gameLocal.Printf( "%6d frames with routing changes: %d changes, %d area caches repaired, %d travel times, %d portal caches, %d caches deleted, %.2f ms\n",
+							repairFrames, repairTotalStats.changes, repairTotalStats.areaCaches, repairTotalStats.entries, repairTotalStats.portalCaches, repairTotalStats.deletedCaches, repairTotalStats.ms );
+		gameLocal.Printf( "       per frame %.1f travel times, %.3f ms, worst frame %d travel times, %.3f ms\n",
+							(float) repairTotalStats.entries / repairFrames, repairTotalStats.ms / repairFrames, repairPeakStats.entries, repairPeakStats.ms );
+	}
 }
 
 /*
@@ -336,20 +418,21 @@ void idAASLocal::RoutingStats( void ) const {
 idAASLocal::RemoveRoutingCacheUsingArea
 ============
 */
-void idAASLocal::RemoveRoutingCacheUsingArea( int areaNum ) {
-	int clusterNum;
+int idAASLocal::RemoveRoutingCacheUsingArea( int areaNum ) {
+	int clusterNum, numDeleted;
 
 	clusterNum = file->GetArea( areaNum ).cluster;
 	if ( clusterNum > 0 ) {
 		// remove all the cache in the cluster the area is in
-		DeleteClusterCache( clusterNum );
+		numDeleted = DeleteClusterCache( clusterNum );
 	}
 	else {
 		// if this is a portal remove all cache in both the front and back cluster
-		DeleteClusterCache( file->GetPortal( -clusterNum ).clusters[0] );
-		DeleteClusterCache( file->GetPortal( -clusterNum ).clusters[1] );
+		numDeleted = DeleteClusterCache( file->GetPortal( -clusterNum ).clusters[0] );
+		numDeleted += DeleteClusterCache( file->GetPortal( -clusterNum ).clusters[1] );
 	}
-	DeletePortalCache();
+	numDeleted += DeletePortalCache();
+	return numDeleted;
 }
 
 /*
@@ -366,7 +449,8 @@ void idAASLocal::DisableArea( int areaNum ) {
 
 	file->SetAreaTravelFlag( areaNum, TFL_INVALID );
 
-	RemoveRoutingCacheUsingArea( areaNum );
+	// the caches are repaired once all areas have been toggled
+	changedAreas.Append( areaNum );
 }
 
 /*
@@ -383,7 +467,7 @@ void idAASLocal::EnableArea( int areaNum ) {
 
 	file->RemoveAreaTravelFlag( areaNum, TFL_INVALID );
 
-	RemoveRoutingCacheUsingArea( areaNum );
+	changedAreas.Append( areaNum );
 }
 
 /*
@@ -433,6 +517,7 @@ idAASLocal::SetAreaState
 */
 bool idAASLocal::SetAreaState( const idBounds &bounds, const int areaContents, bool disabled ) {
 	idBounds expBounds;
+	bool foundClusterPortal;
 
 	if ( !file ) {
 		return false;
@@ -442,7 +527,11 @@ bool idAASLocal::SetAreaState( const idBounds &bounds, const int areaContents, b
 	expBounds[1] = bounds[1] - file->GetSettings().boundingBoxes[0][0];
 
 	// find all areas within or touching the bounds with the given contents and disable/enable them for routing
-	return SetAreaState_r( 1, expBounds, areaContents, disabled );
+	foundClusterPortal = SetAreaState_r( 1, expBounds, areaContents, disabled );
+
+	RepairRoutingCache();
+
+	return foundClusterPortal;
 }
 
 /*
@@ -483,12 +572,11 @@ void idAASLocal::SetObstacleState( const idRoutingObstacle *obstacle, bool enabl
 	int i;
 	const aasArea_t *area;
 	idReachability *reach, *rev_reach;
+	int oldTravelType;
 	bool inside;
 
 	for ( i = 0; i < obstacle->areas.Num(); i++ ) {
 
-		RemoveRoutingCacheUsingArea( obstacle->areas[i] );
-
 		area = &file->GetArea( obstacle->areas[i] );
 
 		for ( rev_reach = area->rev_reach; rev_reach; rev_reach = rev_reach->rev_next ) {
@@ -512,6 +600,7 @@ void idAASLocal::SetObstacleState( const idRoutingObstacle *obstacle, bool enabl
 			}
 
 			if ( inside ) {
+				oldTravelType = rev_reach->travelType;
 				if ( enable ) {
 					rev_reach->disableCount--;
 					if ( rev_reach->disableCount <= 0 ) {
@@ -523,6 +612,9 @@ void idAASLocal::SetObstacleState( const idRoutingObstacle *obstacle, bool enabl
 					rev_reach->travelType |= TFL_INVALID;
 					rev_reach->disableCount++;
 				}
+				if ( ( oldTravelType ^ rev_reach->travelType ) & TFL_INVALID ) {
+					changedReach.Append( rev_reach );
+				}
 			}
 		}
 	}
@@ -545,6 +637,7 @@ aasHandle_t idAASLocal::AddObstacle( const idBounds &bounds ) {
 	obstacle->bounds[1] = bounds[1] - file->GetSettings().boundingBoxes[0][0];
 	GetBoundsAreas_r( 1, obstacle->bounds, obstacle->areas );
 	SetObstacleState( obstacle, true );
+	RepairRoutingCache();
 
 	obstacleList.Append( obstacle );
 	return obstacleList.Num() - 1;
@@ -561,6 +654,7 @@ void idAASLocal::RemoveObstacle( const aasHandle_t handle ) {
 	}
 	if ( ( handle >= 0 ) && ( handle < obstacleList.Num() ) ) {
 		SetObstacleState( obstacleList[handle], false );
+		RepairRoutingCache();
 
 		delete obstacleList[handle];
 		obstacleList.RemoveIndex( handle );
@@ -584,6 +678,7 @@ void idAASLocal::RemoveAllObstacles( void ) {
 		delete obstacleList[i];
 	}
 	obstacleList.Clear();
+	RepairRoutingCache();
 }
 
 /*
@@ -652,6 +747,19 @@ void idAASLocal::DeleteOldestCache( void ) const {
 	UnlinkCache( cache );
 
 	// unlink the oldest cache from the area or portal cache index
+	RemoveRoutingCacheIndex( cache );
+
+	delete cache;
+}
+
+/*
+============
+idAASLocal::RemoveRoutingCacheIndex
+
+  unlink the cache from the area or portal cache index
+============
+*/
+void idAASLocal::RemoveRoutingCacheIndex( idRoutingCache *cache ) const {
 	if ( cache->next ) {
 		cache->next->prev = cache->prev;
 	}
@@ -664,8 +772,7 @@ void idAASLocal::DeleteOldestCache( void ) const {
 	else if ( cache->type == CACHETYPE_PORTAL ) {
 		portalCacheIndex[cache->areaNum] = cache->next;
 	}
-
-	delete cache;
+	cache->next = cache->prev = NULL;
 }
 
 /*
@@ -708,11 +815,10 @@ idAASLocal::UpdateAreaRoutingCache
 ============
 */
 void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
-	int i, nextAreaNum, cluster, badTravelFlags, clusterAreaNum, numReachableAreas;
-	unsigned short t, startAreaTravelTimes[MAX_REACH_PER_AREA];
-	idRoutingUpdate *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
-	idReachability *reach;
-	const aasArea_t *nextArea;
+	int clusterAreaNum, numReachableAreas;
+	unsigned short startAreaTravelTimes[MAX_REACH_PER_AREA];
+	idRoutingUpdate *updateListStart, *updateListEnd, *curUpdate;
+	idRoutingUpdate *areaUpdate = GetRoutingScratch()->areaUpdate;
 
 	// number of reachability areas within this cluster
 	numReachableAreas = file->GetCluster( areaCache->cluster ).numReachableAreas;
@@ -724,7 +830,6 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 	}
 
 	areaCache->travelTimes[clusterAreaNum] = areaCache->startTravelTime;
-	badTravelFlags = ~areaCache->travelFlags;
 	memset( startAreaTravelTimes, 0, sizeof( startAreaTravelTimes ) );
 
 	// initialize first update
@@ -737,6 +842,29 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 	updateListStart = curUpdate;
 	updateListEnd = curUpdate;
 
+	FloodAreaRoutingCache( areaCache, areaUpdate, updateListStart, updateListEnd );
+}
+
+/*
+============
+idAASLocal::FloodAreaRoutingCache
+
+  floods the travel times from the updates in the list through the cluster,
+  returns the number of travel times that were set
+============
+*/
+int idAASLocal::FloodAreaRoutingCache( idRoutingCache *areaCache, idRoutingUpdate *areaUpdate, idRoutingUpdate *updateListStart, idRoutingUpdate *updateListEnd ) const {
+	int i, nextAreaNum, cluster, badTravelFlags, clusterAreaNum, numReachableAreas, numUpdates;
+	unsigned short t;
+	idRoutingUpdate *curUpdate, *nextUpdate;
+	idReachability *reach;
+	const aasArea_t *nextArea;
+
+	// number of reachability areas within this cluster
+	numReachableAreas = file->GetCluster( areaCache->cluster ).numReachableAreas;
+	badTravelFlags = ~areaCache->travelFlags;
+	numUpdates = 0;
+
 	// while there are updates in the list
 	while( updateListStart ) {
 
@@ -790,6 +918,7 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 
 				areaCache->travelTimes[clusterAreaNum] = t;
 				areaCache->reachabilities[clusterAreaNum] = reach->number; // reversed reachability used to get into this area
+				numUpdates++;
 				nextUpdate = &areaUpdate[clusterAreaNum];
 				nextUpdate->areaNum = nextAreaNum;
 				nextUpdate->tmpTravelTime = t;
@@ -818,6 +947,351 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 			}
 		}
 	}
+
+	return numUpdates;
+}
+
+/*
+============
+idAASLocal::AreaInCluster
+============
+*/
+bool idAASLocal::AreaInCluster( int areaNum, int clusterNum ) const {
+	int areaCluster;
+
+	areaCluster = file->GetArea( areaNum ).cluster;
+	if ( areaCluster > 0 ) {
+		return ( areaCluster == clusterNum );
+	}
+	if ( areaCluster < 0 ) {
+		return ( file->GetPortal( -areaCluster ).clusters[0] == clusterNum || file->GetPortal( -areaCluster ).clusters[1] == clusterNum );
+	}
+	return false;
+}
+
+/*
+============
+idAASLocal::QueueRoutingUpdate
+============
+*/
+void idAASLocal::QueueRoutingUpdate( idRoutingUpdate *update, idRoutingUpdate *&updateListStart, idRoutingUpdate *&updateListEnd ) const {
+	if ( update->isInList ) {
+		return;
+	}
+	update->next = NULL;
+	update->prev = updateListEnd;
+	if ( updateListEnd ) {
+		updateListEnd->next = update;
+	}
+	else {
+		updateListStart = update;
+	}
+	updateListEnd = update;
+	update->isInList = true;
+}
+
+/*
+============
+idAASLocal::SeedAreaRoutingCache
+
+  restarts the flood from an area that kept its travel time, the update is set up
+  as if the flood had just reached the area through its stored reachability
+============
+*/
+void idAASLocal::SeedAreaRoutingCache( idRoutingCache *areaCache, int areaNum, unsigned short *startAreaTravelTimes, idRoutingUpdate *areaUpdate, idRoutingUpdate *&updateListStart, idRoutingUpdate *&updateListEnd ) const {
+	int clusterAreaNum;
+	idReachability *reach;
+	idRoutingUpdate *update;
+
+	if ( !AreaInCluster( areaNum, areaCache->cluster ) ) {
+		return;
+	}
+	clusterAreaNum = ClusterAreaNum( areaCache->cluster, areaNum );
+	if ( clusterAreaNum >= file->GetCluster( areaCache->cluster ).numReachableAreas ) {
+		return;
+	}
+
+	update = &areaUpdate[clusterAreaNum];
+	if ( update->isInList ) {
+		return;
+	}
+
+	if ( areaNum == areaCache->areaNum ) {
+		update->tmpTravelTime = areaCache->startTravelTime;
+		update->areaTravelTimes = startAreaTravelTimes;
+	}
+	else {
+		// the area is not reached yet or lost its travel time
+		if ( !areaCache->travelTimes[clusterAreaNum] ) {
+			return;
+		}
+		reach = GetAreaReachability( areaNum, areaCache->reachabilities[clusterAreaNum] );
+		if ( !reach ) {
+			return;
+		}
+		update->tmpTravelTime = areaCache->travelTimes[clusterAreaNum];
+		update->areaTravelTimes = reach->areaTravelTimes;
+
+		// if we are not allowed to fly
+		if ( ~areaCache->travelFlags & TFL_FLY ) {
+			// avoid areas near ledges
+			if ( file->GetArea( areaNum ).flags & AREA_LEDGE ) {
+				update->tmpTravelTime += LEDGE_TRAVELTIME_PANALTY;
+			}
+		}
+	}
+	update->areaNum = areaNum;
+
+	QueueRoutingUpdate( update, updateListStart, updateListEnd );
+}
+
+/*
+============
+idAASLocal::RepairAreaRoutingCache
+
+  Invalidates the travel times of the areas that route through a disabled area or
+  reachability and floods the cache again from the areas around them and from the
+  areas next to enabled areas and reachabilities. Returns the number of travel times set.
+============
+*/
+int idAASLocal::RepairAreaRoutingCache( idRoutingCache *areaCache ) {
+	int i, j, areaNum, clusterAreaNum, numReachableAreas, badTravelFlags, numInvalid, state;
+	unsigned short startAreaTravelTimes[MAX_REACH_PER_AREA];
+	idRoutingUpdate *updateListStart, *updateListEnd;
+	idRoutingUpdate *areaUpdate = GetRoutingScratch()->areaUpdate;
+	idReachability *reach;
+
+	numReachableAreas = file->GetCluster( areaCache->cluster ).numReachableAreas;
+	clusterAreaNum = ClusterAreaNum( areaCache->cluster, areaCache->areaNum );
+	if ( clusterAreaNum >= numReachableAreas ) {
+		return 0;
+	}
+
+	badTravelFlags = ~areaCache->travelFlags;
+
+	repairState.SetNum( numReachableAreas, false );
+	for ( i = 0; i < numReachableAreas; i++ ) {
+		repairState[i] = areaCache->travelTimes[i] ? ROUTING_REPAIR_UNKNOWN : ROUTING_REPAIR_UNREACHED;
+	}
+	repairState[clusterAreaNum] = ROUTING_REPAIR_VALID;
+
+	// follow the reachabilities of every area towards the goal, the travel time is
+	// invalid if the way runs through a disabled area or reachability
+	numInvalid = 0;
+	for ( i = 0; i < numReachableAreas; i++ ) {
+		if ( repairState[i] != ROUTING_REPAIR_UNKNOWN ) {
+			continue;
+		}
+
+		repairPath.SetNum( 0, false );
+		clusterAreaNum = i;
+		while( 1 ) {
+			state = repairState[clusterAreaNum];
+			if ( state != ROUTING_REPAIR_UNKNOWN ) {
+				break;
+			}
+			repairState[clusterAreaNum] = ROUTING_REPAIR_ON_PATH;
+			repairPath.Append( clusterAreaNum );
+
+			areaNum = clusterAreas[areaCache->cluster][clusterAreaNum];
+			if ( file->GetArea( areaNum ).travelFlags & badTravelFlags ) {
+				state = ROUTING_REPAIR_INVALID;
+				break;
+			}
+			reach = GetAreaReachability( areaNum, areaCache->reachabilities[clusterAreaNum] );
+			if ( !reach || ( reach->travelType & badTravelFlags ) || !AreaInCluster( reach->toAreaNum, areaCache->cluster ) ) {
+				state = ROUTING_REPAIR_INVALID;
+				break;
+			}
+			clusterAreaNum = ClusterAreaNum( areaCache->cluster, reach->toAreaNum );
+			if ( clusterAreaNum >= numReachableAreas ) {
+				state = ROUTING_REPAIR_INVALID;
+				break;
+			}
+		}
+
+		// unreached areas and loops can't lead to the goal either
+		if ( state != ROUTING_REPAIR_VALID ) {
+			state = ROUTING_REPAIR_INVALID;
+		}
+		for ( j = 0; j < repairPath.Num(); j++ ) {
+			repairState[repairPath[j]] = state;
+			if ( state == ROUTING_REPAIR_INVALID ) {
+				areaCache->travelTimes[repairPath[j]] = 0;
+				areaCache->reachabilities[repairPath[j]] = 0;
+				numInvalid++;
+			}
+		}
+	}
+
+	memset( startAreaTravelTimes, 0, sizeof( startAreaTravelTimes ) );
+	updateListStart = updateListEnd = NULL;
+
+	// flood into the invalidated areas from the areas they lead to
+	if ( numInvalid ) {
+		for ( i = 0; i < numReachableAreas; i++ ) {
+			if ( repairState[i] != ROUTING_REPAIR_INVALID ) {
+				continue;
+			}
+			areaNum = clusterAreas[areaCache->cluster][i];
+			for ( reach = file->GetArea( areaNum ).reach; reach; reach = reach->next ) {
+				SeedAreaRoutingCache( areaCache, reach->toAreaNum, startAreaTravelTimes, areaUpdate, updateListStart, updateListEnd );
+			}
+		}
+	}
+
+	// enabled areas and reachabilities may give areas a shorter way to the goal
+	for ( i = 0; i < changedAreas.Num(); i++ ) {
+		areaNum = changedAreas[i];
+		if ( ( file->GetArea( areaNum ).travelFlags & TFL_INVALID ) || !AreaInCluster( areaNum, areaCache->cluster ) ) {
+			continue;
+		}
+		for ( reach = file->GetArea( areaNum ).reach; reach; reach = reach->next ) {
+			SeedAreaRoutingCache( areaCache, reach->toAreaNum, startAreaTravelTimes, areaUpdate, updateListStart, updateListEnd );
+		}
+	}
+	for ( i = 0; i < changedReach.Num(); i++ ) {
+		reach = changedReach[i];
+		if ( ( reach->travelType & TFL_INVALID ) || !AreaInCluster( reach->fromAreaNum, areaCache->cluster ) ) {
+			continue;
+		}
+		SeedAreaRoutingCache( areaCache, reach->toAreaNum, startAreaTravelTimes, areaUpdate, updateListStart, updateListEnd );
+	}
+
+	if ( !updateListStart ) {
+		return 0;
+	}
+	return FloodAreaRoutingCache( areaCache, areaUpdate, updateListStart, updateListEnd );
+}
+
+/*
+============
+idAASLocal::RepairRoutingCache
+
+  Called after areas or reachabilities were enabled or disabled. Instead of throwing
+  away all caches of the clusters involved only the travel times that depend on the
+  changes are computed again. The portal caches are flooded again from the repaired
+  area caches.
+============
+*/
+void idAASLocal::RepairRoutingCache( void ) {
+	int i, j, clusterNum, numEntries;
+	uint64 startTime;
+	idRoutingCache *cache;
+	routingRepairStats_t stats;
+	idList<int> areas;
+
+	if ( !changedAreas.Num() && !changedReach.Num() ) {
+		return;
+	}
+	if ( !areaCacheIndex ) {
+		changedAreas.SetNum( 0, false );
+		changedReach.SetNum( 0, false );
+		return;
+	}
+
+	assert( !routingBatch );
+
+	startTime = Sys_GetPerformanceCounter();
+	memset( &stats, 0, sizeof( stats ) );
+	stats.changes = changedAreas.Num() + changedReach.Num();
+
+	if ( !aas_routingRepair.GetBool() ) {
+		// remove all the cache in the clusters of the changes
+		for ( i = 0; i < changedAreas.Num(); i++ ) {
+			stats.deletedCaches += RemoveRoutingCacheUsingArea( changedAreas[i] );
+		}
+		for ( i = 0; i < changedReach.Num(); i++ ) {
+			stats.deletedCaches += RemoveRoutingCacheUsingArea( changedReach[i]->toAreaNum );
+		}
+	}
+	else {
+		// clusters with travel times that may have changed
+		areas = changedAreas;
+		for ( i = 0; i < changedReach.Num(); i++ ) {
+			areas.Append( changedReach[i]->fromAreaNum );
+			areas.Append( changedReach[i]->toAreaNum );
+		}
+		repairClusters.SetNum( 0, false );
+		for ( i = 0; i < areas.Num(); i++ ) {
+			clusterNum = file->GetArea( areas[i] ).cluster;
+			if ( clusterNum > 0 ) {
+				repairClusters.AddUnique( clusterNum );
+			}
+			else if ( clusterNum < 0 ) {
+				for ( j = 0; j < 2; j++ ) {
+					if ( file->GetPortal( -clusterNum ).clusters[j] > 0 ) {
+						repairClusters.AddUnique( file->GetPortal( -clusterNum ).clusters[j] );
+					}
+				}
+			}
+		}
+
+		for ( i = 0; i < repairClusters.Num(); i++ ) {
+			clusterNum = repairClusters[i];
+			for ( j = 0; j < file->GetCluster( clusterNum ).numReachableAreas; j++ ) {
+				for ( cache = areaCacheIndex[clusterNum][j]; cache; cache = cache->next ) {
+					numEntries = RepairAreaRoutingCache( cache );
+					if ( numEntries ) {
+						stats.areaCaches++;
+						stats.entries += numEntries;
+					}
+				}
+			}
+		}
+
+		// the portal caches are cheap compared to the area caches, flood them again
+		for ( i = 0; i < file->GetNumAreas(); i++ ) {
+			for ( cache = portalCacheIndex[i]; cache; cache = cache->next ) {
+				memset( cache->travelTimes, 0, cache->size * sizeof( unsigned short ) );
+				memset( cache->reachabilities, 0, cache->size * sizeof( unsigned char ) );
+				UpdatePortalRoutingCache( cache );
+				stats.portalCaches++;
+			}
+		}
+	}
+
+	changedAreas.SetNum( 0, false );
+	changedReach.SetNum( 0, false );
+
+	stats.ms = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+	AddRoutingRepairStats( stats );
+
+	if ( aas_showRoutingRepair.GetBool() ) {
+		gameLocal.Printf( "%s: %d routing changes, %d area caches repaired, %d travel times, %d portal caches, %d caches deleted, %.3f ms\n",
+							file->GetName(), stats.changes, stats.areaCaches, stats.entries, stats.portalCaches, stats.deletedCaches, stats.ms );
+	}
+}
+
+/*
+============
+idAASLocal::AddRoutingRepairStats
+============
+*/
+void idAASLocal::AddRoutingRepairStats( const routingRepairStats_t &stats ) {
+	if ( repairFrameNum != gameLocal.framenum ) {
+		repairFrameNum = gameLocal.framenum;
+		memset( &repairFrameStats, 0, sizeof( repairFrameStats ) );
+		repairFrames++;
+	}
+
+	repairFrameStats.changes += stats.changes;
+	repairFrameStats.areaCaches += stats.areaCaches;
+	repairFrameStats.entries += stats.entries;
+	repairFrameStats.portalCaches += stats.portalCaches;
+	repairFrameStats.deletedCaches += stats.deletedCaches;
+	repairFrameStats.ms += stats.ms;
+
+	repairTotalStats.changes += stats.changes;
+	repairTotalStats.areaCaches += stats.areaCaches;
+	repairTotalStats.entries += stats.entries;
+	repairTotalStats.portalCaches += stats.portalCaches;
+	repairTotalStats.deletedCaches += stats.deletedCaches;
+	repairTotalStats.ms += stats.ms;
+
+	if ( repairFrameStats.ms >= repairPeakStats.ms ) {
+		repairPeakStats = repairFrameStats;
+	}
 }
 
 /*
@@ -827,18 +1301,14 @@ idAASLocal::GetAreaRoutingCache
 */
 idRoutingCache *idAASLocal::GetAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const {
 	int clusterAreaNum;
-	idRoutingCache *cache, *clusterCache;
+	idRoutingCache *cache, **clusterCache;
 
 	// number of the area in the cluster
 	clusterAreaNum = ClusterAreaNum( clusterNum, areaNum );
 	// pointer to the cache for the area in the cluster
-	clusterCache = areaCacheIndex[clusterNum][clusterAreaNum];
+	clusterCache = &areaCacheIndex[clusterNum][clusterAreaNum];
 	// check if cache without undesired travel flags already exists
-	for ( cache = clusterCache; cache; cache = cache->next ) {
-		if ( cache->travelFlags == travelFlags ) {
-			break;
-		}
-	}
+	cache = FindRoutingCache( clusterCache, travelFlags );
 	// if no cache found
 	if ( !cache ) {
 		cache = new idRoutingCache( file->GetCluster( clusterNum ).numReachableAreas );
@@ -847,15 +1317,13 @@ idRoutingCache *idAASLocal::GetAreaRoutingCache( int clusterNum, int areaNum, in
 		cache->areaNum = areaNum;
 		cache->startTravelTime = 1;
 		cache->travelFlags = travelFlags;
-		cache->prev = NULL;
-		cache->next = clusterCache;
-		if ( clusterCache ) {
-			clusterCache->prev = cache;
-		}
-		areaCacheIndex[clusterNum][clusterAreaNum] = cache;
 		UpdateAreaRoutingCache( cache );
+		return AddRoutingCache( clusterCache, cache );
+	}
+	// the time based list is only touched by the game thread
+	if ( !cache->pinned && !routingBatch ) {
+		LinkCache( cache );
 	}
-	LinkCache( cache );
 	return cache;
 }
 
@@ -871,6 +1339,7 @@ void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
 	const aasCluster_t *cluster;
 	idRoutingCache *cache;
 	idRoutingUpdate *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
+	idRoutingUpdate *portalUpdate = GetRoutingScratch()->portalUpdate;
 
 	curUpdate = &portalUpdate[ file->GetNumPortals() ];
 	curUpdate->cluster = portalCache->cluster;
@@ -960,11 +1429,7 @@ idRoutingCache *idAASLocal::GetPortalRoutingCache( int clusterNum, int areaNum,
 	idRoutingCache *cache;
 
 	// check if cache without undesired travel flags already exists
-	for ( cache = portalCacheIndex[areaNum]; cache; cache = cache->next ) {
-		if ( cache->travelFlags == travelFlags ) {
-			break;
-		}
-	}
+	cache = FindRoutingCache( &portalCacheIndex[areaNum], travelFlags );
 	// if no cache found
 	if ( !cache ) {
 		cache = new idRoutingCache( file->GetNumPortals() );
@@ -973,15 +1438,13 @@ idRoutingCache *idAASLocal::GetPortalRoutingCache( int clusterNum, int areaNum,
 		cache->areaNum = areaNum;
 		cache->startTravelTime = 1;
 		cache->travelFlags = travelFlags;
-		cache->prev = NULL;
-		cache->next = portalCacheIndex[areaNum];
-		if ( portalCacheIndex[areaNum] ) {
-			portalCacheIndex[areaNum]->prev = cache;
-		}
-		portalCacheIndex[areaNum] = cache;
 		UpdatePortalRoutingCache( cache );
+		return AddRoutingCache( &portalCacheIndex[areaNum], cache );
+	}
+	// the time based list is only touched by the game thread
+	if ( !cache->pinned && !routingBatch ) {
+		LinkCache( cache );
 	}
-	LinkCache( cache );
 	return cache;
 }
 
@@ -1018,9 +1481,7 @@ bool idAASLocal::RouteToGoalArea( int areaNum, const idVec3 origin, int goalArea
 		return false;
 	}
 
-	while( totalCacheMemory > MAX_ROUTING_CACHE_MEMORY ) {
-		DeleteOldestCache();
-	}
+	EvictRoutingCache();
 
 	clusterNum = file->GetArea( areaNum ).cluster;
 	goalClusterNum = file->GetArea( goalAreaNum ).cluster;
@@ -1173,6 +1634,9 @@ bool idAASLocal::FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 ori
 	const aasArea_t *nextArea;
 	idVec3 v1, v2, p;
 	float targetDist, dist;
+	idRoutingScratch *scratch;
+	idRoutingUpdate *areaUpdate;
+	unsigned short *goalAreaTravelTimes;
 
 	if ( file == NULL || areaNum <= 0 ) {
 		goal.areaNum = areaNum;
@@ -1193,6 +1657,15 @@ bool idAASLocal::FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 ori
 		obstacles[k].expAbsBounds[1] = obstacles[k].absBounds[1] - file->GetSettings().boundingBoxes[0][0];
 	}
 
+	// the callback may route, so the updates are kept apart from the routing cache updates
+	scratch = GetRoutingScratch();
+	if ( !scratch->goalUpdate ) {
+		scratch->goalUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( idRoutingUpdate ) );
+		scratch->goalAreaTravelTimes = (unsigned short *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( unsigned short ) );
+	}
+	areaUpdate = scratch->goalUpdate;
+	goalAreaTravelTimes = scratch->goalAreaTravelTimes;
+
 	badTravelFlags = ~travelFlags;
 	SIMDProcessor->Memset( goalAreaTravelTimes, 0, file->GetNumAreas() * sizeof( unsigned short ) );
 
@@ -1374,3 +1847,850 @@ bool idAASLocal::FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 ori
 
 	return false;
 }
+
+/*
+============
+idAASLocal::GetRoutingScratch
+
+  every thread floods the routing caches with its own update memory
+============
+*/
+idRoutingScratch *idAASLocal::GetRoutingScratch( void ) const {
+	int thread;
+	idRoutingScratch *scratch;
+
+	thread = jobSystem->GetThreadIndex() + 1;
+	assert( thread >= 0 && thread <= MAX_JOB_THREADS );
+
+	scratch = &routingScratch[thread];
+	if ( !scratch->areaUpdate ) {
+		scratch->areaUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( idRoutingUpdate ) );
+		scratch->portalUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( (file->GetNumPortals()+1) * sizeof( idRoutingUpdate ) );
+	}
+	return scratch;
+}
+
+/*
+============
+idAASLocal::FreeRoutingScratch
+============
+*/
+void idAASLocal::FreeRoutingScratch( void ) {
+	int i;
+
+	for ( i = 0; i <= MAX_JOB_THREADS; i++ ) {
+		Mem_Free( routingScratch[i].areaUpdate );
+		Mem_Free( routingScratch[i].portalUpdate );
+		Mem_Free( routingScratch[i].goalUpdate );
+		Mem_Free( routingScratch[i].goalAreaTravelTimes );
+	}
+	memset( routingScratch, 0, sizeof( routingScratch ) );
+}
+
+/*
+============
+idAASLocal::FindRoutingCache
+
+  the cache lists are read without locking, new caches are only ever added in front
+  and caches are only deleted by the game thread while no jobs use the routing,
+  the acquire loads pair with the release store in AddRoutingCache
+============
+*/
+idRoutingCache *idAASLocal::FindRoutingCache( idRoutingCache **list, int travelFlags ) const {
+	idRoutingCache *cache;
+
+	for ( cache = std::atomic_ref<idRoutingCache *>( *list ).load( std::memory_order_acquire ); cache;
+			cache = std::atomic_ref<idRoutingCache *>( cache->next ).load( std::memory_order_acquire ) ) {
+		if ( cache->travelFlags == travelFlags ) {
+			break;
+		}
+	}
+	return cache;
+}
+
+/*
+============
+idAASLocal::AddRoutingCache
+
+  adds a new cache in front of the list, if another thread added the same cache
+  in the meantime the new one is thrown away and the existing one is returned
+============
+*/
+idRoutingCache *idAASLocal::AddRoutingCache( idRoutingCache **list, idRoutingCache *cache ) const {
+	idRoutingCache *existing;
+
+	std::lock_guard<std::mutex> guard( routingCacheLock );
+
+	existing = FindRoutingCache( list, cache->travelFlags );
+	if ( existing ) {
+		delete cache;
+		return existing;
+	}
+
+	cache->prev = NULL;
+	cache->next = *list;
+	if ( *list ) {
+		(*list)->prev = cache;
+	}
+	// the cache has to be complete before other threads can find it
+	std::atomic_ref<idRoutingCache *>( *list ).store( cache, std::memory_order_release );
+
+	if ( !cache->pinned ) {
+		LinkCache( cache );
+	}
+	return cache;
+}
+
+/*
+============
+idAASLocal::PinRoutingCache
+
+  moves the cache into the routing table, it is no longer deleted when the cache memory runs out
+============
+*/
+void idAASLocal::PinRoutingCache( idRoutingCache *cache ) const {
+	std::lock_guard<std::mutex> guard( routingCacheLock );
+
+	if ( cache->pinned ) {
+		return;
+	}
+	if ( cache->time_next || cache->time_prev || cacheListStart == cache ) {
+		UnlinkCache( cache );
+	}
+	cache->pinned = true;
+}
+
+/*
+============
+idAASLocal::FlushRoutingCache
+============
+*/
+void idAASLocal::FlushRoutingCache( bool keepTable ) {
+	int i, j;
+	idRoutingCache *cache, *next;
+
+	assert( !routingBatch );
+
+	for ( i = 0; i < file->GetNumClusters(); i++ ) {
+		for ( j = 0; j < file->GetCluster( i ).numReachableAreas; j++ ) {
+			for ( cache = areaCacheIndex[i][j]; cache; cache = next ) {
+				next = cache->next;
+				if ( keepTable && cache->pinned ) {
+					continue;
+				}
+				if ( !cache->pinned ) {
+					UnlinkCache( cache );
+				}
+				RemoveRoutingCacheIndex( cache );
+				delete cache;
+			}
+		}
+	}
+	for ( i = 0; i < file->GetNumAreas(); i++ ) {
+		for ( cache = portalCacheIndex[i]; cache; cache = next ) {
+			next = cache->next;
+			if ( keepTable && cache->pinned ) {
+				continue;
+			}
+			if ( !cache->pinned ) {
+				UnlinkCache( cache );
+			}
+			RemoveRoutingCacheIndex( cache );
+			delete cache;
+		}
+	}
+	if ( !keepTable ) {
+		routingTableBuilt = false;
+	}
+}
+
+/*
+============
+idAASLocal::EvictRoutingCache
+
+  deletes the oldest caches when over budget, jobs that use the routing may hold on
+  to any cache so nothing is deleted until they are done
+============
+*/
+void idAASLocal::EvictRoutingCache( void ) const {
+	if ( routingBatch ) {
+		return;
+	}
+	while( totalCacheMemory > MAX_ROUTING_CACHE_MEMORY ) {
+		DeleteOldestCache();
+	}
+}
+
+/*
+============
+idAASLocal::RunRoutingJobs
+============
+*/
+void idAASLocal::RunRoutingJobs( jobRun_t function ) const {
+	int i;
+
+	if ( !routingJobList ) {
+		routingJobList = jobSystem->AllocJobList( "aasRouting" );
+	}
+
+	routingJobList->Clear();
+	for ( i = 0; i < routingJobs.Num(); i++ ) {
+		routingJobList->AddJob( function, &routingJobs[i], "aasRouting" );
+	}
+
+	routingBatch++;
+	routingJobList->Submit();
+	routingJobList->Wait();
+	routingBatch--;
+}
+
+/*
+============
+idAASLocal::PathRequest
+============
+*/
+void idAASLocal::PathRequest( aasPathRequest_t &request ) const {
+	idReachability *reach;
+
+	request.travelTime = 0;
+	switch( request.type ) {
+		case AASPATHREQUEST_ROUTE:
+			request.result = RouteToGoalArea( request.areaNum, request.origin, request.goalAreaNum, request.travelFlags, request.travelTime, &reach );
+			request.path.reachability = reach;
+			break;
+		case AASPATHREQUEST_WALK:
+			request.result = WalkPathToGoal( request.path, request.areaNum, request.origin, request.goalAreaNum, request.goalOrigin, request.travelFlags );
+			break;
+		case AASPATHREQUEST_FLY:
+			request.result = FlyPathToGoal( request.path, request.areaNum, request.origin, request.goalAreaNum, request.goalOrigin, request.travelFlags );
+			break;
+		default:
+			request.result = false;
+			break;
+	}
+}
+
+/*
+============
+idAASLocal::PathRequestJob
+============
+*/
+void idAASLocal::PathRequestJob( void *data ) {
+	const routingJob_t *job = (const routingJob_t *) data;
+
+	for ( int i = 0; i < job->num; i++ ) {
+		job->aas->PathRequest( job->requests[job->first + i] );
+	}
+}
+
+/*
+============
+idAASLocal::PathRequests
+
+  the requests share the routing caches, caches missing for one request are built
+  by the first job that needs them
+============
+*/
+void idAASLocal::PathRequests( aasPathRequest_t *requests, int numRequests ) const {
+	int i, jobSize;
+
+	if ( !file ) {
+		for ( i = 0; i < numRequests; i++ ) {
+			requests[i].result = false;
+		}
+		return;
+	}
+
+	jobSize = aas_pathRequestJobSize.GetInteger();
+
+	// nested batches from inside a job are run right away
+	if ( jobSize <= 0 || numRequests < 2 * jobSize || jobSystem->GetNumWorkers() == 0 || jobSystem->GetThreadIndex() != -1 || routingBatch ) {
+		for ( i = 0; i < numRequests; i++ ) {
+			PathRequest( requests[i] );
+		}
+		return;
+	}
+
+	// make room up front, no cache is deleted while the jobs run
+	EvictRoutingCache();
+
+	routingJobs.SetNum( ( numRequests + jobSize - 1 ) / jobSize, false );
+	for ( i = 0; i < routingJobs.Num(); i++ ) {
+		routingJob_t &job = routingJobs[i];
+		job.aas = this;
+		job.requests = requests;
+		job.first = i * jobSize;
+		job.num = Min( jobSize, numRequests - job.first );
+	}
+	RunRoutingJobs( PathRequestJob );
+}
+
+/*
+============
+idAASLocal::RoutingTableClusterJob
+
+  area caches towards every portal of the clusters
+============
+*/
+void idAASLocal::RoutingTableClusterJob( void *data ) {
+	const routingJob_t *job = (const routingJob_t *) data;
+	const idAASLocal *aas = job->aas;
+
+	for ( int clusterNum = job->first; clusterNum < job->first + job->num; clusterNum++ ) {
+		const aasCluster_t &cluster = aas->file->GetCluster( clusterNum );
+
+		for ( int i = 0; i < cluster.numPortals; i++ ) {
+			const aasPortal_t &portal = aas->file->GetPortal( aas->file->GetPortalIndex( cluster.firstPortal + i ) );
+
+			if ( aas->ClusterAreaNum( clusterNum, portal.areaNum ) >= cluster.numReachableAreas ) {
+				continue;
+			}
+			aas->PinRoutingCache( aas->GetAreaRoutingCache( clusterNum, portal.areaNum, ROUTING_TABLE_TRAVELFLAGS ) );
+		}
+	}
+}
+
+/*
+============
+idAASLocal::RoutingTablePortalJob
+
+  portal caches towards every portal, the travel times between all portals
+============
+*/
+void idAASLocal::RoutingTablePortalJob( void *data ) {
+	const routingJob_t *job = (const routingJob_t *) data;
+	const idAASLocal *aas = job->aas;
+
+	for ( int portalNum = job->first; portalNum < job->first + job->num; portalNum++ ) {
+		const aasPortal_t &portal = aas->file->GetPortal( portalNum );
+
+		// RouteToGoalArea assumes a goal portal area is part of the front cluster
+		aas->PinRoutingCache( aas->GetPortalRoutingCache( portal.clusters[0], portal.areaNum, ROUTING_TABLE_TRAVELFLAGS ) );
+	}
+}
+
+/*
+============
+idAASLocal::BuildRoutingTable
+
+  called once the map entities have set the area states
+============
+*/
+void idAASLocal::BuildRoutingTable( void ) {
+	if ( !file || routingTableBuilt || aas_routingTable.GetInteger() == 0 ) {
+		return;
+	}
+	CreateRoutingTable( aas_routingTable.GetInteger() == 1 );
+}
+
+/*
+============
+idAASLocal::CreateRoutingTable
+
+  Precomputes the area caches of all portal areas and the portal caches of all portals.
+  Routing between two clusters then only floods the cluster of the goal area and the
+  portal graph, routing towards a portal area is a lookup. The table caches are pinned,
+  they are deleted only when an area or obstacle changes the routing.
+============
+*/
+void idAASLocal::CreateRoutingTable( bool loadCache ) {
+	int i;
+	idTimer timer;
+	idStr fileName;
+	unsigned int key;
+
+	timer.Start();
+
+	routingTableBuilt = true;
+
+	// the cache is keyed on the file and the current area and reachability states
+	key = RoutingTableKey( ROUTING_TABLE_TRAVELFLAGS );
+
+	fileName = file->GetName();
+	fileName.StripPath();
+	fileName = va( "%s/%s.%s", ROUTING_TABLE_DIR, fileName.c_str(), ROUTING_TABLE_EXT );
+
+	if ( loadCache && LoadRoutingTable( fileName, key, ROUTING_TABLE_TRAVELFLAGS ) ) {
+		timer.Stop();
+		gameLocal.Printf( "loaded routing table for %d portals from %s in %u ms\n", file->GetNumPortals(), fileName.c_str(), timer.Milliseconds() );
+		return;
+	}
+
+	// cluster 0 and portal 0 are not used
+	routingJobs.SetNum( Max( file->GetNumClusters() - 1, 0 ), false );
+	for ( i = 0; i < routingJobs.Num(); i++ ) {
+		routingJobs[i].aas = this;
+		routingJobs[i].requests = NULL;
+		routingJobs[i].first = i + 1;
+		routingJobs[i].num = 1;
+	}
+	RunRoutingJobs( RoutingTableClusterJob );
+
+	routingJobs.SetNum( ( file->GetNumPortals() - 1 + ROUTING_TABLE_PORTALS_JOB - 1 ) / ROUTING_TABLE_PORTALS_JOB, false );
+	for ( i = 0; i < routingJobs.Num(); i++ ) {
+		routingJobs[i].aas = this;
+		routingJobs[i].requests = NULL;
+		routingJobs[i].first = 1 + i * ROUTING_TABLE_PORTALS_JOB;
+		routingJobs[i].num = Min( ROUTING_TABLE_PORTALS_JOB, file->GetNumPortals() - routingJobs[i].first );
+	}
+	RunRoutingJobs( RoutingTablePortalJob );
+
+	timer.Stop();
+	gameLocal.Printf( "built routing table for %d portals in %u ms\n", file->GetNumPortals(), timer.Milliseconds() );
+
+	if ( aas_routingTable.GetInteger() != 0 ) {
+		WriteRoutingTable( fileName, key, ROUTING_TABLE_TRAVELFLAGS );
+	}
+}
+
+/*
+============
+idAASLocal::RoutingTableKey
+============
+*/
+unsigned int idAASLocal::RoutingTableKey( int travelFlags ) const {
+	int i, num;
+	unsigned int key, crc;
+	const idReachability *reach;
+
+	CRC32_InitChecksum( key );
+	crc = file->GetCRC();
+	CRC32_UpdateChecksum( key, &crc, sizeof( crc ) );
+	CRC32_UpdateChecksum( key, &travelFlags, sizeof( travelFlags ) );
+	num = file->GetNumAreas();
+	CRC32_UpdateChecksum( key, &num, sizeof( num ) );
+	num = file->GetNumPortals();
+	CRC32_UpdateChecksum( key, &num, sizeof( num ) );
+	for ( i = 0; i < file->GetNumAreas(); i++ ) {
+		const aasArea_t &area = file->GetArea( i );
+		CRC32_UpdateChecksum( key, &area.travelFlags, sizeof( area.travelFlags ) );
+		for ( reach = area.reach; reach; reach = reach->next ) {
+			CRC32_UpdateChecksum( key, &reach->travelType, sizeof( reach->travelType ) );
+		}
+	}
+	CRC32_FinishChecksum( key );
+	return key;
+}
+
+/*
+============
+idAASLocal::LoadRoutingTable
+============
+*/
+bool idAASLocal::LoadRoutingTable( const char *fileName, unsigned int key, int travelFlags ) {
+	void *buffer;
+	int i, j, length, magic, version, numAreas, numPortals, numCaches;
+	int type, clusterNum, areaNum, size;
+	unsigned int fileKey;
+	unsigned short travelTime;
+	idList<idRoutingCache *> caches;
+	idRoutingCache *cache;
+	bool ok;
+
+	length = fileSystem->ReadFile( fileName, &buffer, NULL );
+	if ( length <= 0 || buffer == NULL ) {
+		return false;
+	}
+
+	idFile_Memory f( fileName, (const char *)buffer, length );
+	f.ReadInt( magic );
+	f.ReadInt( version );
+	f.ReadUnsignedInt( fileKey );
+	f.ReadInt( numAreas );
+	f.ReadInt( numPortals );
+	f.ReadInt( numCaches );
+
+	ok = ( magic == ROUTING_TABLE_MAGIC && version == ROUTING_TABLE_VERSION && fileKey == key
+		&& numAreas == file->GetNumAreas() && numPortals == file->GetNumPortals() && numCaches >= 0 );
+
+	for ( i = 0; ok && i < numCaches; i++ ) {
+		f.ReadInt( type );
+		f.ReadInt( clusterNum );
+		f.ReadInt( areaNum );
+		f.ReadInt( size );
+
+		if ( clusterNum <= 0 || clusterNum >= file->GetNumClusters() || areaNum <= 0 || areaNum >= file->GetNumAreas() ) {
+			ok = false;
+		} else if ( type == CACHETYPE_AREA ) {
+			ok = ( size == file->GetCluster( clusterNum ).numReachableAreas && ClusterAreaNum( clusterNum, areaNum ) < size );
+		} else if ( type == CACHETYPE_PORTAL ) {
+			ok = ( size == file->GetNumPortals() );
+		} else {
+			ok = false;
+		}
+		if ( !ok || f.Length() - f.Tell() < size * 3 ) {
+			ok = false;
+			break;
+		}
+
+		cache = new idRoutingCache( size );
+		cache->type = type;
+		cache->cluster = clusterNum;
+		cache->areaNum = areaNum;
+		cache->startTravelTime = 1;
+		cache->travelFlags = travelFlags;
+		cache->pinned = true;
+		for ( j = 0; j < size; j++ ) {
+			f.ReadUnsignedShort( travelTime );
+			cache->travelTimes[j] = travelTime;
+		}
+		f.Read( cache->reachabilities, size );
+		caches.Append( cache );
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( !ok || f.Tell() != length ) {
+		caches.DeleteContents( true );
+		return false;
+	}
+
+	for ( i = 0; i < caches.Num(); i++ ) {
+		cache = caches[i];
+		if ( cache->type == CACHETYPE_AREA ) {
+			cache = AddRoutingCache( &areaCacheIndex[cache->cluster][ClusterAreaNum( cache->cluster, cache->areaNum )], cache );
+		} else {
+			cache = AddRoutingCache( &portalCacheIndex[cache->areaNum], cache );
+		}
+		// a cache that was already routed is taken over instead
+		PinRoutingCache( cache );
+	}
+	return true;
+}
+
+/*
+============
+idAASLocal::WriteRoutingTable
+============
+*/
+void idAASLocal::WriteRoutingTable( const char *fileName, unsigned int key, int travelFlags ) const {
+	int i, j, k;
+	idList<const idRoutingCache *> caches;
+	const idRoutingCache *cache;
+
+	for ( i = 0; i < file->GetNumClusters(); i++ ) {
+		for ( j = 0; j < file->GetCluster( i ).numReachableAreas; j++ ) {
+			for ( cache = areaCacheIndex[i][j]; cache; cache = cache->next ) {
+				if ( cache->pinned && cache->travelFlags == travelFlags ) {
+					caches.Append( cache );
+				}
+			}
+		}
+	}
+	for ( i = 0; i < file->GetNumAreas(); i++ ) {
+		for ( cache = portalCacheIndex[i]; cache; cache = cache->next ) {
+			if ( cache->pinned && cache->travelFlags == travelFlags ) {
+				caches.Append( cache );
+			}
+		}
+	}
+
+	idFile_Memory f( fileName );
+	f.WriteInt( ROUTING_TABLE_MAGIC );
+	f.WriteInt( ROUTING_TABLE_VERSION );
+	f.WriteUnsignedInt( key );
+	f.WriteInt( file->GetNumAreas() );
+	f.WriteInt( file->GetNumPortals() );
+	f.WriteInt( caches.Num() );
+	for ( i = 0; i < caches.Num(); i++ ) {
+		cache = caches[i];
+		f.WriteInt( cache->type );
+		f.WriteInt( cache->cluster );
+		f.WriteInt( cache->areaNum );
+		f.WriteInt( cache->size );
+		for ( k = 0; k < cache->size; k++ ) {
+			f.WriteUnsignedShort( cache->travelTimes[k] );
+		}
+		f.Write( cache->reachabilities, cache->size );
+	}
+
+	fileSystem->WriteFile( fileName, f.GetDataPtr(), f.Length() );
+}
+
+/*
+============
+idAASLocal::RoutingBenchmark
+
+  routes between random reachable areas without caches, with warm caches, with the
+  routing table and batched on the job workers, all runs have to agree
+============
+*/
+void idAASLocal::RoutingBenchmark( int numPairs, int seed ) {
+	int i, numMismatches[7];
+	uint64 startTime;
+	double ms[7], msTable;
+	idRandom random( seed );
+	idList<int> areas;
+	idList<aasPathRequest_t> pairs, results, routeReference, walkReference;
+	static const char *names[7] = {
+		"cold",
+		"warm",
+		"cold batched",
+		"warm batched",
+		"cold + table",
+		"walk paths",
+		"walk paths batched"
+	};
+
+	if ( !file ) {
+		return;
+	}
+
+	// start and goal areas the default AI can walk in
+	for ( i = 1; i < file->GetNumAreas(); i++ ) {
+		if ( ( file->GetArea( i ).flags & AREA_REACHABLE_WALK ) && !( file->GetArea( i ).travelFlags & TFL_INVALID ) ) {
+			areas.Append( i );
+		}
+	}
+	if ( areas.Num() < 2 ) {
+		gameLocal.Printf( "%s has no reachable areas\n", file->GetName() );
+		return;
+	}
+
+	pairs.SetNum( numPairs );
+	for ( i = 0; i < numPairs; i++ ) {
+		aasPathRequest_t &request = pairs[i];
+		memset( &request, 0, sizeof( request ) );
+		request.type = AASPATHREQUEST_ROUTE;
+		request.areaNum = areas[random.RandomInt( areas.Num() )];
+		request.origin = AreaCenter( request.areaNum );
+		request.goalAreaNum = areas[random.RandomInt( areas.Num() )];
+		request.goalOrigin = AreaCenter( request.goalAreaNum );
+		request.travelFlags = ROUTING_TABLE_TRAVELFLAGS;
+	}
+
+	gameLocal.Printf( "routing %d random area pairs on %s (%d areas, %d clusters, %d portals, %d workers)\n",
+						numPairs, file->GetName(), file->GetNumAreas(), file->GetNumClusters(), file->GetNumPortals(), jobSystem->GetNumWorkers() );
+
+	memset( numMismatches, 0, sizeof( numMismatches ) );
+	msTable = 0.0;
+
+	for ( int run = 0; run < 7; run++ ) {
+		if ( run == 0 || run == 2 ) {
+			FlushRoutingCache( false );
+		} else if ( run == 4 ) {
+			FlushRoutingCache( false );
+			startTime = Sys_GetPerformanceCounter();
+			CreateRoutingTable( false );
+			msTable = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+			FlushRoutingCache( true );
+		}
+
+		results = pairs;
+		if ( run >= 5 ) {
+			for ( i = 0; i < results.Num(); i++ ) {
+				results[i].type = AASPATHREQUEST_WALK;
+			}
+		}
+
+		startTime = Sys_GetPerformanceCounter();
+		if ( run == 2 || run == 3 || run == 6 ) {
+			PathRequests( results.Ptr(), results.Num() );
+		} else {
+			for ( i = 0; i < results.Num(); i++ ) {
+				PathRequest( results[i] );
+			}
+		}
+		ms[run] = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+
+		if ( run == 0 ) {
+			routeReference = results;
+			continue;
+		}
+		if ( run == 5 ) {
+			walkReference = results;
+			continue;
+		}
+
+		const idList<aasPathRequest_t> &expected = ( run == 6 ) ? walkReference : routeReference;
+		for ( i = 0; i < results.Num(); i++ ) {
+			const aasPathRequest_t &a = expected[i];
+			const aasPathRequest_t &b = results[i];
+			if ( a.result != b.result || a.travelTime != b.travelTime || a.path.reachability != b.path.reachability ) {
+				numMismatches[run]++;
+			} else if ( run == 6 && b.result && ( a.path.type != b.path.type || a.path.moveAreaNum != b.path.moveAreaNum || a.path.moveGoal != b.path.moveGoal ) ) {
+				numMismatches[run]++;
+			}
+		}
+	}
+
+	for ( i = 0; i < 7; i++ ) {
+		gameLocal.Printf( "  %-20s %8.2f ms, %7.2f us per query", names[i], ms[i], ms[i] * 1000.0 / numPairs );
+		if ( i > 0 && i < 5 ) {
+			gameLocal.Printf( " (%.2fx), %d mismatches\n", ms[0] / Max( ms[i], 0.001 ), numMismatches[i] );
+		} else if ( i == 6 ) {
+			gameLocal.Printf( " (%.2fx), %d mismatches\n", ms[5] / Max( ms[i], 0.001 ), numMismatches[i] );
+		} else {
+			gameLocal.Printf( "\n" );
+		}
+	}
+	gameLocal.Printf( "  routing table built in %.2f ms\n", msTable );
+
+	// leave the routing as the game would have set it up
+	if ( aas_routingTable.GetInteger() == 0 ) {
+		FlushRoutingCache( false );
+	}
+	RoutingStats();
+}
+
+/*
+============
+idAAS::RoutingBenchmark_f
+============
+*/
+void idAAS::RoutingBenchmark_f( const idCmdArgs &args ) {
+	int aasNum, numPairs, seed;
+	idAASLocal *aas;
+
+	if ( args.Argc() > 4 ) {
+		gameLocal.Printf( "usage: aasRoutingBenchmark [aas index, default 0] [number of area pairs, default 10000] [random seed, default 0]\n" );
+		return;
+	}
+
+	aasNum = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 0;
+	numPairs = ( args.Argc() > 2 ) ? Max( atoi( args.Argv( 2 ) ), 1 ) : 10000;
+	seed = ( args.Argc() > 3 ) ? atoi( args.Argv( 3 ) ) : 0;
+
+	aas = static_cast<idAASLocal *>( gameLocal.GetAAS( aasNum ) );
+	if ( !aas || !aas->GetSettings() ) {
+		gameLocal.Printf( "no AAS %d loaded\n", aasNum );
+		return;
+	}
+	aas->RoutingBenchmark( numPairs, seed );
+}
+
+/*
+============
+idAASLocal::RoutingRepairTest
+
+  disables and enables random cluster portals and compares the repaired caches
+  with caches built from scratch
+============
+*/
+void idAASLocal::RoutingRepairTest( int numToggles, int seed ) {
+	int i, j, k, toggle, portalAreaNum, numEntries, numDiffs, numUnreachable, maxDiff, diff;
+	uint64 startTime;
+	double repairMs, rebuildMs;
+	idRandom random( seed );
+	idList<int> areas, portalAreas;
+	idRoutingCache *cache, *fresh;
+	aasPathRequest_t request;
+
+	if ( !file ) {
+		return;
+	}
+	if ( !aas_routingRepair.GetBool() ) {
+		gameLocal.Printf( "aas_routingRepair is disabled\n" );
+		return;
+	}
+
+	for ( i = 1; i < file->GetNumAreas(); i++ ) {
+		if ( file->GetArea( i ).travelFlags & TFL_INVALID ) {
+			continue;
+		}
+		if ( file->GetArea( i ).flags & AREA_REACHABLE_WALK ) {
+			areas.Append( i );
+		}
+		if ( file->GetArea( i ).cluster < 0 ) {
+			portalAreas.Append( i );
+		}
+	}
+	if ( areas.Num() < 2 || !portalAreas.Num() ) {
+		gameLocal.Printf( "%s has no reachable areas or cluster portals\n", file->GetName() );
+		return;
+	}
+
+	gameLocal.Printf( "toggling %d random cluster portals on %s (%d areas, %d clusters, %d portals)\n",
+						numToggles, file->GetName(), file->GetNumAreas(), file->GetNumClusters(), file->GetNumPortals() );
+
+	// fill the caches the way the AI would
+	memset( &request, 0, sizeof( request ) );
+	request.type = AASPATHREQUEST_ROUTE;
+	request.travelFlags = ROUTING_TABLE_TRAVELFLAGS;
+	for ( i = 0; i < 1000; i++ ) {
+		request.areaNum = areas[random.RandomInt( areas.Num() )];
+		request.origin = AreaCenter( request.areaNum );
+		request.goalAreaNum = areas[random.RandomInt( areas.Num() )];
+		request.goalOrigin = AreaCenter( request.goalAreaNum );
+		PathRequest( request );
+	}
+
+	numEntries = repairTotalStats.entries;
+	numDiffs = numUnreachable = maxDiff = 0;
+	portalAreaNum = 0;
+	repairMs = rebuildMs = 0.0;
+
+	for ( toggle = 0; toggle < numToggles * 2; toggle++ ) {
+		// disable the portal and enable it again on the next toggle
+		if ( !( toggle & 1 ) ) {
+			portalAreaNum = portalAreas[random.RandomInt( portalAreas.Num() )];
+			DisableArea( portalAreaNum );
+		} else {
+			EnableArea( portalAreaNum );
+		}
+
+		startTime = Sys_GetPerformanceCounter();
+		RepairRoutingCache();
+		repairMs += Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+
+		// build the caches of the repaired clusters from scratch and compare
+		for ( i = 0; i < repairClusters.Num(); i++ ) {
+			for ( j = 0; j < file->GetCluster( repairClusters[i] ).numReachableAreas; j++ ) {
+				for ( cache = areaCacheIndex[repairClusters[i]][j]; cache; cache = cache->next ) {
+					fresh = new idRoutingCache( cache->size );
+					fresh->type = cache->type;
+					fresh->cluster = cache->cluster;
+					fresh->areaNum = cache->areaNum;
+					fresh->startTravelTime = cache->startTravelTime;
+					fresh->travelFlags = cache->travelFlags;
+
+					startTime = Sys_GetPerformanceCounter();
+					UpdateAreaRoutingCache( fresh );
+					rebuildMs += Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+
+					for ( k = 0; k < cache->size; k++ ) {
+						if ( ( fresh->travelTimes[k] == 0 ) != ( cache->travelTimes[k] == 0 ) ) {
+							numUnreachable++;
+						} else if ( fresh->travelTimes[k] != cache->travelTimes[k] ) {
+							numDiffs++;
+							diff = abs( fresh->travelTimes[k] - cache->travelTimes[k] );
+							maxDiff = Max( maxDiff, diff );
+						}
+					}
+					delete fresh;
+				}
+			}
+		}
+	}
+
+	gameLocal.Printf( "  %d toggles, %d travel times recomputed\n", numToggles * 2, repairTotalStats.entries - numEntries );
+	gameLocal.Printf( "  %d travel times differ from a rebuild (max %d), %d differ in reachability\n", numDiffs, maxDiff, numUnreachable );
+	gameLocal.Printf( "  repair %.2f ms, rebuilding the area caches of the same clusters %.2f ms (%.2fx)\n", repairMs, rebuildMs, rebuildMs / Max( repairMs, 0.001 ) );
+	RoutingStats();
+}
+
+/*
+============
+idAAS::RoutingRepairTest_f
+============
+*/
+void idAAS::RoutingRepairTest_f( const idCmdArgs &args ) {
+	int aasNum, numToggles, seed;
+	idAASLocal *aas;
+
+	if ( args.Argc() > 4 ) {
+		gameLocal.Printf( "usage: aasRoutingRepairTest [aas index, default 0] [number of portals to toggle, default 100] [random seed, default 0]\n" );
+		return;
+	}
+
+	aasNum = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 0;
+	numToggles = ( args.Argc() > 2 ) ? Max( atoi( args.Argv( 2 ) ), 1 ) : 100;
+	seed = ( args.Argc() > 3 ) ? atoi( args.Argv( 3 ) ) : 0;
+
+	aas = static_cast<idAASLocal *>( gameLocal.GetAAS( aasNum ) );
+	if ( !aas || !aas->GetSettings() ) {
+		gameLocal.Printf( "no AAS %d loaded\n", aasNum );
+		return;
+	}
+	aas->RoutingRepairTest( numToggles, seed );
+}
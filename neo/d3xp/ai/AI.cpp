@@ -605,6 +605,7 @@ idAI::idAI
 idAI::idAI() {
 	aas					= NULL;
 	travelFlags			= TFL_WALK|TFL_AIR;
+	pathRequestFrame	= -1;
 
 	kickForce			= 2048.0f;
 	ignore_obstacles	= false;
@@ -2423,6 +2424,14 @@ bool idAI::PathToGoal( aasPath_t &path, int areaNum, const idVec3 &origin, int g
 		return false;
 	}
 
+	// use the batched query from the start of the frame if it asked for the same path
+	if ( pathRequestFrame == gameLocal.framenum && gameLocal.aiPathRequestFrame == gameLocal.framenum && pathRequest.areaNum == areaNum && pathRequest.goalAreaNum == goalAreaNum &&
+			pathRequest.travelFlags == travelFlags && pathRequest.origin == org && pathRequest.goalOrigin == goal &&
+			pathRequest.type == ( move.moveType == MOVETYPE_FLY ? AASPATHREQUEST_FLY : AASPATHREQUEST_WALK ) ) {
+		path = pathRequest.path;
+		return pathRequest.result;
+	}
+
 	if ( move.moveType == MOVETYPE_FLY ) {
 		return aas->FlyPathToGoal( path, areaNum, org, goalAreaNum, goal, travelFlags );
 	} else {
@@ -2430,6 +2439,59 @@ bool idAI::PathToGoal( aasPath_t &path, int areaNum, const idVec3 &origin, int g
 	}
 }
 
+/*
+=====================
+idAI::SetupPathRequest
+
+  the same path GetMovePos is going to ask PathToGoal for
+=====================
+*/
+bool idAI::SetupPathRequest( aasPathRequest_t &request ) const {
+	idVec3 org;
+
+	if ( !aas || !move.toAreaNum || gameLocal.time <= move.blockTime ) {
+		return false;
+	}
+
+	switch( move.moveCommand ) {
+		case MOVE_NONE :
+		case MOVE_FACE_ENEMY :
+		case MOVE_FACE_ENTITY :
+		case MOVE_TO_POSITION_DIRECT :
+		case MOVE_SLIDE_TO_POSITION :
+		case MOVE_WANDER :
+			return false;
+		default :
+			break;
+	}
+
+	org = physicsObj.GetOrigin();
+	request.areaNum = PointReachableAreaNum( org );
+	request.origin = org;
+	aas->PushPointIntoAreaNum( request.areaNum, request.origin );
+	if ( !request.areaNum ) {
+		return false;
+	}
+
+	request.goalAreaNum = move.toAreaNum;
+	request.goalOrigin = move.moveDest;
+	aas->PushPointIntoAreaNum( request.goalAreaNum, request.goalOrigin );
+
+	request.type = ( move.moveType == MOVETYPE_FLY ) ? AASPATHREQUEST_FLY : AASPATHREQUEST_WALK;
+	request.travelFlags = travelFlags;
+	return true;
+}
+
+/*
+=====================
+idAI::SetPathRequestResult
+=====================
+*/
+void idAI::SetPathRequestResult( const aasPathRequest_t &request ) {
+	pathRequest = request;
+	pathRequestFrame = gameLocal.framenum;
+}
+
 /*
 =====================
 idAI::TravelDistance
@@ -7432,6 +7494,13 @@ int idAI::GetSightExposure(idActor *enemyEnt)
 	trace_t		tr;
 	int			limbsExposed;
 
+	//The perception manager traces the shoulders of the targets once I asked for them.
+	limbsExposed = gameLocal.aiPerception.GetExposure( this, enemyEnt );
+	if ( limbsExposed != -1 )
+	{
+		return limbsExposed;
+	}
+
 	limbsExposed = 0;
 	enemyPos = enemyEnt->GetPhysics()->GetOrigin();
 	enemyPos.z = enemyEnt->GetEyePosition().z;
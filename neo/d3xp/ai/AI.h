@@ -340,6 +340,11 @@ public:
 
 	bool					GetAimDir( const idVec3 &firePos, idEntity *aimAtEnt, const idEntity *ignore, idVec3 &aimDir ) const;
 
+							// batched path queries, see idGameLocal::RunAIPathRequests
+	idAAS *					GetAAS( void ) const { return aas; }
+	bool					SetupPathRequest( aasPathRequest_t &request ) const;
+	void					SetPathRequestResult( const aasPathRequest_t &request );
+
 	void					TouchedByFlashlight( idActor *flashlight_owner );
 
 							// Outputs a list of all monsters to the console.
@@ -429,6 +434,9 @@ protected:
 	idMoveState				move;
 	idMoveState				savedMove;
 
+	aasPathRequest_t		pathRequest;			// path queried before this frame's think, not saved
+	int						pathRequestFrame;
+
 	float					kickForce;
 	bool					ignore_obstacles;
 	float					blockedRadius;
@@ -0,0 +1,603 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "sys/platform.h"
+#include "framework/CmdSystem.h"
+#include "framework/Profiler.h"
+
+#include "gamesys/SysCvar.h"
+#include "Player.h"
+#include "BrittleFracture.h"
+#include "ai/AI.h"
+#include "Game_local.h"
+
+#include "ai/AI_Perception.h"
+
+#define PERCEPTION_IDLE_TIME		2000	// observers that didn't ask for this long are dropped
+#define PERCEPTION_STAGGER			4		// spread the first refresh of new observers over this many steps of the refresh time
+
+// same limits as idActor::IsTargetImmediatelyFrontOfMe
+#define PERCEPTION_FRONT_BELOW		32.0f
+#define PERCEPTION_FRONT_ABOVE		128.0f
+
+// same offsets as idActor::CanSee and idAI::GetSightExposure
+#define PERCEPTION_HEAD_OFFSET		1.5f
+#define PERCEPTION_SHOULDER_OFFSET	14.0f
+
+#define CULL_SKIP					BIT( 0 )	// never an enemy, the pair is not kept
+#define CULL_PVS					BIT( 1 )
+#define CULL_FOV					BIT( 2 )
+
+typedef enum {
+	PERCEPTIONTRACE_EYE,
+	PERCEPTIONTRACE_HEAD,
+	PERCEPTIONTRACE_SHOULDER
+} perceptionTraceType_t;
+
+/*
+================
+idAIPerception::idAIPerception
+================
+*/
+idAIPerception::idAIPerception( void ) {
+	memset( observerNum, -1, sizeof( observerNum ) );
+	memset( &frameStats, 0, sizeof( frameStats ) );
+	memset( &totalStats, 0, sizeof( totalStats ) );
+	totalFrames = 0;
+}
+
+/*
+================
+idAIPerception::Clear
+================
+*/
+void idAIPerception::Clear( void ) {
+	observers.Clear();
+	memset( observerNum, -1, sizeof( observerNum ) );
+	targetEnts.Clear();
+	targetX.Clear();
+	targetY.Clear();
+	targetZ.Clear();
+	targetCull.Clear();
+	traces.Clear();
+	traceStarts.Clear();
+	traceEnds.Clear();
+	tracePass.Clear();
+	traceResults.Clear();
+	memset( &frameStats, 0, sizeof( frameStats ) );
+}
+
+/*
+================
+idAIPerception::RemoveObserver
+================
+*/
+void idAIPerception::RemoveObserver( int index ) {
+	observerNum[observers[index].entityNum] = -1;
+	observers.RemoveIndex( index );
+	for ( int i = index; i < observers.Num(); i++ ) {
+		observerNum[observers[i].entityNum] = i;
+	}
+}
+
+/*
+================
+idAIPerception::FindObserver
+================
+*/
+perceptionObserver_t *idAIPerception::FindObserver( idActor *observer, bool create ) {
+	int index = observerNum[observer->entityNumber];
+
+	if ( index >= 0 ) {
+		perceptionObserver_t *obs = &observers[index];
+		if ( obs->spawnId == gameLocal.GetSpawnId( observer ) ) {
+			obs->lastQueryTime = gameLocal.time;
+			return obs;
+		}
+		// the entity number was reused
+		RemoveObserver( index );
+	}
+
+	if ( !create || !ai_perception.GetBool() || gameLocal.isClient ) {
+		return NULL;
+	}
+
+	perceptionObserver_t &obs = observers.Alloc();
+	obs.entityNum = observer->entityNumber;
+	obs.spawnId = gameLocal.GetSpawnId( observer );
+	if ( !observer->spawnArgs.GetInt( "perception_refresh", "-1", obs.refreshTime ) ) {
+		obs.refreshTime = -1;
+	}
+	obs.nextRefreshTime = gameLocal.time;
+	obs.lastQueryTime = gameLocal.time;
+	obs.valid = false;
+	obs.wantExposure = false;
+	obs.pairs.SetNum( 0, false );
+	observerNum[obs.entityNum] = observers.Num() - 1;
+
+	return &obs;
+}
+
+/*
+================
+idAIPerception::FindPair
+================
+*/
+const perceptionPair_t *idAIPerception::FindPair( const perceptionObserver_t *obs, const idEntity *target ) const {
+	if ( !obs->valid ) {
+		return NULL;
+	}
+	for ( int i = 0; i < obs->pairs.Num(); i++ ) {
+		const perceptionPair_t &pair = obs->pairs[i];
+		if ( pair.target == target->entityNumber ) {
+			return ( pair.targetSpawnId == gameLocal.GetSpawnId( target ) ) ? &pair : NULL;
+		}
+	}
+	return NULL;
+}
+
+/*
+================
+idAIPerception::GetView
+
+  returns PERCEPTION_PVS and PERCEPTION_FOV for the pair
+================
+*/
+int idAIPerception::GetView( idActor *observer, const idEntity *target ) {
+	const perceptionObserver_t *obs = FindObserver( observer, observer->IsType( idAI::Type ) );
+	if ( !obs ) {
+		return -1;
+	}
+	const perceptionPair_t *pair = FindPair( obs, target );
+	if ( !pair ) {
+		frameStats.misses++;
+		return -1;
+	}
+	frameStats.hits++;
+	return pair->flags & ( PERCEPTION_PVS | PERCEPTION_FOV );
+}
+
+/*
+================
+idAIPerception::GetSight
+
+  returns the result of the idActor::CanSee traces, only actors that already observe are looked up
+================
+*/
+int idAIPerception::GetSight( idActor *observer, const idEntity *target ) {
+	const perceptionObserver_t *obs = FindObserver( observer, false );
+	if ( !obs ) {
+		return -1;
+	}
+	const perceptionPair_t *pair = FindPair( obs, target );
+	if ( !pair || !( pair->flags & PERCEPTION_SIGHT_VALID ) ) {
+		frameStats.misses++;
+		return -1;
+	}
+	frameStats.hits++;
+	frameStats.tracesSaved += pair->sightTraces;
+	return ( pair->flags & PERCEPTION_SIGHT ) != 0;
+}
+
+/*
+================
+idAIPerception::GetExposure
+
+  returns the number of exposed shoulders, the shoulders are only traced for observers that asked before
+================
+*/
+int idAIPerception::GetExposure( idAI *observer, const idEntity *target ) {
+	perceptionObserver_t *obs = FindObserver( observer, true );
+	if ( !obs ) {
+		return -1;
+	}
+	obs->wantExposure = true;
+	const perceptionPair_t *pair = FindPair( obs, target );
+	if ( !pair || !( pair->flags & PERCEPTION_EXPOSURE_VALID ) ) {
+		frameStats.misses++;
+		return -1;
+	}
+	frameStats.hits++;
+	frameStats.tracesSaved += 2;
+	return pair->exposure;
+}
+
+/*
+================
+idAIPerception::GatherTargets
+
+  everything that idAI::Event_FindEnemyAI may pick as an enemy
+================
+*/
+void idAIPerception::GatherTargets( void ) {
+	idEntity *ent;
+	idVec3 lookPoint;
+
+	targetEnts.SetNum( 0, false );
+	targetX.SetNum( 0, false );
+	targetY.SetNum( 0, false );
+	targetZ.SetNum( 0, false );
+
+	for ( ent = gameLocal.aimAssistEntities.Next(); ent != NULL; ent = ent->aimAssistNode.Next() ) {
+		if ( ent->fl.hidden || ent->fl.isDormant || ent->health <= 0 ) {
+			continue;
+		}
+		if ( ent->IsType( idActor::Type ) ) {
+			lookPoint = static_cast<idActor *>( ent )->GetEyePosition();
+		} else {
+			lookPoint = ent->GetPhysics()->GetOrigin();
+		}
+		targetEnts.Append( ent );
+		targetX.Append( lookPoint.x );
+		targetY.Append( lookPoint.y );
+		targetZ.Append( lookPoint.z );
+	}
+}
+
+/*
+================
+idAIPerception::AddTrace
+================
+*/
+void idAIPerception::AddTrace( int observerIndex, int pairIndex, int type, const idVec3 &start, const idVec3 &end, const idEntity *pass ) {
+	perceptionTrace_t &trace = traces.Alloc();
+	trace.observer = observerIndex;
+	trace.pair = pairIndex;
+	trace.type = type;
+	traceStarts.Append( start );
+	traceEnds.Append( end );
+	tracePass.Append( pass );
+}
+
+/*
+================
+idAIPerception::GatherPairs
+
+  culls all targets against the PVS and the vision box of the observer and queues
+  the traces of the pairs that are left
+================
+*/
+void idAIPerception::GatherPairs( int observerIndex ) {
+	perceptionObserver_t &obs = observers[observerIndex];
+	idActor *actor = static_cast<idActor *>( gameLocal.entities[obs.entityNum] );
+	const int numTargets = targetEnts.Num();
+	const float *x = targetX.Ptr();
+	const float *y = targetY.Ptr();
+	const float *z = targetZ.Ptr();
+	byte *cull;
+	int i;
+
+	targetCull.SetNum( numTargets, false );
+	cull = targetCull.Ptr();
+
+	// PVS
+	pvsHandle_t pvs = gameLocal.pvs.SetupCurrentPVS( actor->GetPVSAreas(), actor->GetNumPVSAreas() );
+	for ( i = 0; i < numTargets; i++ ) {
+		idEntity *ent = targetEnts[i];
+		if ( ent == actor || ent->team == actor->team || ent->team == TEAM_NEUTRAL ) {
+			cull[i] = CULL_SKIP;
+		} else if ( !gameLocal.pvs.InCurrentPVS( pvs, ent->GetPVSAreas(), ent->GetNumPVSAreas() ) ) {
+			cull[i] = CULL_PVS;
+		} else {
+			cull[i] = 0;
+		}
+	}
+	gameLocal.pvs.FreeCurrentPVS( pvs );
+
+	// vision box and blindspot, the same tests as idActor::CheckFOV for all targets at once
+	if ( actor->fovDot == 1.0f ) {
+		// sees everything
+	} else if ( actor->visionBox == NULL ) {
+		for ( i = 0; i < numTargets; i++ ) {
+			cull[i] |= CULL_FOV;
+		}
+	} else {
+		const idVec3 &origin = actor->GetPhysics()->GetOrigin();
+		const idBounds &box = actor->visionBox->GetPhysics()->GetAbsBounds();
+		const idVec3 boxForward = idAngles( 0, actor->visionBox->GetPhysics()->GetAxis().ToAngles().yaw, 0 ).ToForward();
+		const idVec3 viewForward = idAngles( 0, actor->viewAxis.ToAngles().yaw, 0 ).ToForward();
+		const float fovDot = actor->fovDot;
+		const float frontRangeSqr = DARKNESS_VIEWRANGE * DARKNESS_VIEWRANGE;
+
+		for ( i = 0; i < numTargets; i++ ) {
+			float dx = x[i] - origin.x;
+			float dy = y[i] - origin.y;
+			float dz = z[i] - origin.z;
+			float lenSqr = dx * dx + dy * dy;
+			float nx = 1.0f, ny = 0.0f;			// ToAngles gives a yaw of zero for vertical directions
+			if ( lenSqr > 0.0f ) {
+				float invLen = 1.0f / idMath::Sqrt( lenSqr );
+				nx = dx * invLen;
+				ny = dy * invLen;
+			}
+
+			bool inBox = x[i] >= box[0].x && x[i] <= box[1].x && y[i] >= box[0].y && y[i] <= box[1].y && z[i] >= box[0].z && z[i] <= box[1].z;
+			bool inFront = dz >= -PERCEPTION_FRONT_BELOW && dz <= PERCEPTION_FRONT_ABOVE && viewForward.x * nx + viewForward.y * ny >= 0.0f &&
+							lenSqr + dz * dz <= frontRangeSqr;
+			bool outsideBlindspot = boxForward.x * nx + boxForward.y * ny >= fovDot;
+
+			if ( !( ( inBox || inFront ) && outsideBlindspot ) ) {
+				cull[i] |= CULL_FOV;
+			}
+		}
+	}
+
+	// keep the pairs and queue the traces of the targets that can be seen
+	obs.pairs.SetNum( 0, false );
+	obs.valid = true;
+
+	const idVec3 eye = actor->GetEyePosition();
+	const bool debug = ( ai_debugPerception.GetInteger() == 1 && gameLocal.GetLocalPlayer() != NULL );
+	idPlayer *player = gameLocal.GetLocalPlayer();
+
+	for ( i = 0; i < numTargets; i++ ) {
+		if ( cull[i] & CULL_SKIP ) {
+			continue;
+		}
+
+		idEntity *ent = targetEnts[i];
+		idVec3 lookPoint( x[i], y[i], z[i] );
+
+		perceptionPair_t &pair = obs.pairs.Alloc();
+		pair.target = ent->entityNumber;
+		pair.targetSpawnId = gameLocal.GetSpawnId( ent );
+		pair.flags = 0;
+		pair.sightTraces = 0;
+		pair.exposure = 0;
+		frameStats.pairs++;
+
+		if ( cull[i] & CULL_PVS ) {
+			frameStats.culledPVS++;
+			if ( debug ) {
+				gameRenderWorld->DebugArrow( colorOrange, eye, lookPoint, 2, 1000 );
+				gameRenderWorld->DrawText( "NOT IN PVS", ( eye + lookPoint ) * 0.5f, .2f, colorOrange, player->viewAngles.ToMat3(), 1, 100 );
+			}
+			continue;
+		}
+		pair.flags |= PERCEPTION_PVS;
+
+		if ( cull[i] & CULL_FOV ) {
+			frameStats.culledFOV++;
+			if ( debug && actor->visionBox != NULL ) {
+				gameRenderWorld->DebugArrow( colorRed, eye, lookPoint, 2, 100 );
+				gameRenderWorld->DrawText( "NOT IN VISIONBOX", ( eye + lookPoint ) * 0.5f, .4f, colorRed, player->viewAngles.ToMat3(), 1, 100 );
+			}
+			continue;
+		}
+		pair.flags |= PERCEPTION_FOV;
+		if ( debug ) {
+			gameRenderWorld->DebugArrow( colorGreen, eye, lookPoint, 2, 100 );
+			gameRenderWorld->DrawText( "IN VISIONBOX", ( eye + lookPoint ) * 0.5f, .4f, colorGreen, player->viewAngles.ToMat3(), 1, 100 );
+		}
+
+		AddTrace( observerIndex, obs.pairs.Num() - 1, PERCEPTIONTRACE_EYE, eye, lookPoint, actor );
+
+		if ( obs.wantExposure && player != NULL && ent->IsType( idActor::Type ) ) {
+			idVec3 enemyPos = ent->GetPhysics()->GetOrigin();
+			enemyPos.z = lookPoint.z;
+
+			idMat3 viewAxis = ( enemyPos - eye ).ToAngles().ToForward().ToMat3();
+			const idVec3 &gravityDir = player->GetPhysics()->GetGravityNormal();
+			idVec3 shoulderDir = ( viewAxis[0] - gravityDir * ( gravityDir * viewAxis[0] ) ).Cross( gravityDir );
+
+			AddTrace( observerIndex, obs.pairs.Num() - 1, PERCEPTIONTRACE_SHOULDER, eye, enemyPos + shoulderDir * PERCEPTION_SHOULDER_OFFSET, actor );
+			AddTrace( observerIndex, obs.pairs.Num() - 1, PERCEPTIONTRACE_SHOULDER, eye, enemyPos - shoulderDir * PERCEPTION_SHOULDER_OFFSET, actor );
+			pair.flags |= PERCEPTION_EXPOSURE_VALID;
+		}
+	}
+}
+
+/*
+================
+idAIPerception::ResolveTraces
+
+  stores the results of the traces in [first, last), eye traces that are blocked
+  queue the traces to the sides of the head like idActor::CanSee does
+================
+*/
+void idAIPerception::ResolveTraces( int first, int last ) {
+	idPlayer *player = gameLocal.GetLocalPlayer();
+
+	for ( int i = first; i < last; i++ ) {
+		// copies, the head traces are appended to the same lists
+		const perceptionTrace_t trace = traces[i];
+		const trace_t &tr = traceResults[i];
+		perceptionObserver_t &obs = observers[trace.observer];
+		perceptionPair_t &pair = obs.pairs[trace.pair];
+		idEntity *target = gameLocal.entities[pair.target];
+
+		switch ( trace.type ) {
+			case PERCEPTIONTRACE_EYE: {
+				if ( tr.fraction >= 1.0f || gameLocal.GetTraceEntity( tr ) == target ) {
+					pair.flags |= PERCEPTION_SIGHT | PERCEPTION_SIGHT_VALID;
+					pair.sightTraces = 1;
+					break;
+				}
+
+				// looking through glass is left to idActor::CanSee
+				int surfaceType = tr.c.material != NULL ? tr.c.material->GetSurfaceType() : SURFTYPE_NONE;
+				if ( surfaceType == SURFTYPE_GLASS ) {
+					break;
+				}
+				if ( tr.c.entityNum != ENTITYNUM_WORLD && tr.c.entityNum != ENTITYNUM_NONE && gameLocal.entities[tr.c.entityNum]->IsType( idBrittleFracture::Type ) ) {
+					break;
+				}
+
+				if ( player == NULL ) {
+					break;
+				}
+
+				const idVec3 myEye = traceStarts[i];
+				const idVec3 toPos = traceEnds[i];
+				const idEntity *pass = tracePass[i];
+				idMat3 enemyViewaxis = ( toPos - myEye ).ToAngles().ToForward().ToMat3();
+				const idVec3 &gravityDir = player->GetPhysics()->GetGravityNormal();
+				idVec3 enemyDir = ( enemyViewaxis[0] - gravityDir * ( gravityDir * enemyViewaxis[0] ) ).Cross( gravityDir );
+
+				const idVec2 offsets[] = { idVec2( PERCEPTION_HEAD_OFFSET, 0 ), idVec2( -PERCEPTION_HEAD_OFFSET, 0 ), idVec2( 0, PERCEPTION_HEAD_OFFSET ), idVec2( 0, -PERCEPTION_HEAD_OFFSET ) };
+				for ( int j = 0; j < 4; j++ ) {
+					idVec3 headPos = toPos + enemyDir * offsets[j].x + idVec3( 0, 0, offsets[j].y );
+					AddTrace( trace.observer, trace.pair, PERCEPTIONTRACE_HEAD, myEye, headPos, pass );
+				}
+				pair.flags |= PERCEPTION_SIGHT_VALID;
+				pair.sightTraces = 5;
+				break;
+			}
+			case PERCEPTIONTRACE_HEAD: {
+				if ( tr.fraction >= 1.0f || gameLocal.GetTraceEntity( tr ) == target ) {
+					pair.flags |= PERCEPTION_SIGHT;
+				}
+				break;
+			}
+			case PERCEPTIONTRACE_SHOULDER: {
+				if ( tr.fraction >= 1.0f || ( player != NULL && tr.c.entityNum == player->entityNumber ) ) {
+					pair.exposure++;
+				}
+				break;
+			}
+		}
+	}
+}
+
+/*
+================
+idAIPerception::FlushTraces
+
+  traces everything that was queued, resolving the eye traces may queue another batch
+================
+*/
+void idAIPerception::FlushTraces( void ) {
+	int first = 0;
+
+	while ( first < traces.Num() ) {
+		int last = traces.Num();
+		traceResults.SetNum( last, false );
+		gameLocal.clip.TracePoints( traceResults.Ptr() + first, traceStarts.Ptr() + first, traceEnds.Ptr() + first, tracePass.Ptr() + first,
+									last - first, MASK_SOLID );
+		frameStats.tracesIssued += last - first;
+		ResolveTraces( first, last );
+		first = last;
+	}
+}
+
+/*
+================
+idAIPerception::RunFrame
+================
+*/
+void idAIPerception::RunFrame( void ) {
+	int i;
+
+	PROFILE_SCOPE( "idAIPerception::RunFrame" );
+
+	// the counters cover everything from the last refresh up to this one
+	if ( ai_debugPerception.GetInteger() == 3 && ( frameStats.observers || frameStats.hits || frameStats.misses ) ) {
+		gameLocal.Printf( "perception %d: %d observers, %d pairs, %d pvs culled, %d fov culled, %d traces, %d saved, %d hits, %d misses\n",
+			gameLocal.time, frameStats.observers, frameStats.pairs, frameStats.culledPVS, frameStats.culledFOV,
+			frameStats.tracesIssued, frameStats.tracesSaved, frameStats.hits, frameStats.misses );
+	}
+	totalStats.observers += frameStats.observers;
+	totalStats.pairs += frameStats.pairs;
+	totalStats.culledPVS += frameStats.culledPVS;
+	totalStats.culledFOV += frameStats.culledFOV;
+	totalStats.tracesIssued += frameStats.tracesIssued;
+	totalStats.tracesSaved += frameStats.tracesSaved;
+	totalStats.hits += frameStats.hits;
+	totalStats.misses += frameStats.misses;
+	totalFrames++;
+	memset( &frameStats, 0, sizeof( frameStats ) );
+
+	if ( !ai_perception.GetBool() || gameLocal.isClient ) {
+		if ( observers.Num() ) {
+			Clear();
+		}
+		return;
+	}
+
+	// drop observers that were removed, died or stopped asking
+	for ( i = observers.Num() - 1; i >= 0; i-- ) {
+		const perceptionObserver_t &obs = observers[i];
+		idEntity *ent = gameLocal.entities[obs.entityNum];
+		if ( !ent || gameLocal.GetSpawnId( ent ) != obs.spawnId || ent->health <= 0 || gameLocal.time - obs.lastQueryTime > PERCEPTION_IDLE_TIME ) {
+			RemoveObserver( i );
+		}
+	}
+	frameStats.observers = observers.Num();
+
+	traces.SetNum( 0, false );
+	traceStarts.SetNum( 0, false );
+	traceEnds.SetNum( 0, false );
+	tracePass.SetNum( 0, false );
+
+	bool gathered = false;
+	for ( i = 0; i < observers.Num(); i++ ) {
+		perceptionObserver_t &obs = observers[i];
+		if ( gameLocal.time < obs.nextRefreshTime ) {
+			continue;
+		}
+		if ( !gathered ) {
+			GatherTargets();
+			gathered = true;
+		}
+
+		int refreshTime = obs.refreshTime >= 0 ? obs.refreshTime : ai_perceptionRefresh.GetInteger();
+		if ( !obs.valid ) {
+			// spread observers that showed up together over the refresh time
+			refreshTime = refreshTime * ( obs.entityNum % PERCEPTION_STAGGER + 1 ) / PERCEPTION_STAGGER;
+		}
+		obs.nextRefreshTime = gameLocal.time + refreshTime;
+
+		GatherPairs( i );
+	}
+
+	FlushTraces();
+}
+
+/*
+================
+idAIPerception::Stats_f
+================
+*/
+void idAIPerception::Stats_f( const idCmdArgs &args ) {
+	idAIPerception &perception = gameLocal.aiPerception;
+
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "reset" ) ) {
+		memset( &perception.totalStats, 0, sizeof( perception.totalStats ) );
+		perception.totalFrames = 0;
+		return;
+	}
+
+	const perceptionStats_t &s = perception.totalStats;
+	float frames = Max( perception.totalFrames, 1 );
+
+	gameLocal.Printf( "%d frames, %d observers now\n", perception.totalFrames, perception.observers.Num() );
+	gameLocal.Printf( "per frame: %.1f observers, %.1f pairs, %.1f pvs culled, %.1f fov culled\n",
+		s.observers / frames, s.pairs / frames, s.culledPVS / frames, s.culledFOV / frames );
+	gameLocal.Printf( "per frame: %.1f traces issued, %.1f traces saved, %.1f hits, %.1f misses\n",
+		s.tracesIssued / frames, s.tracesSaved / frames, s.hits / frames, s.misses / frames );
+}
@@ -0,0 +1,152 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __AI_PERCEPTION_H__
+#define __AI_PERCEPTION_H__
+
+#include "idlib/containers/List.h"
+#include "idlib/math/Vector.h"
+#include "idlib/geometry/TraceModel.h"
+#include "cm/CollisionModel.h"
+
+/*
+===============================================================================
+
+	AI perception.
+
+	Actors that ask for sight checks (idActor::CanSee, idAI::GetSightExposure
+	and idAI::Event_FindEnemyAI) become observers. Once per frame, before the
+	entities think, every observer that is due is tested against all possible
+	targets at once: the PVS and vision box culling runs over the targets in
+	structure of arrays form and the sight and shoulder traces of all observers
+	are issued through a single idClip::TracePoints call. The results are kept
+	until the observer is due again, which is ai_perceptionRefresh milliseconds
+	later or "perception_refresh" from the spawnArgs of the observer.
+
+	Pairs that could not be resolved from the batch (targets behind glass or
+	pairs that were culled) are left to the regular sight checks.
+
+===============================================================================
+*/
+
+class idEntity;
+class idActor;
+class idAI;
+class idCmdArgs;
+
+#define PERCEPTION_PVS				BIT( 0 )	// target is in the PVS of the observer
+#define PERCEPTION_FOV				BIT( 1 )	// target passed idActor::CheckFOV
+#define PERCEPTION_SIGHT			BIT( 2 )	// idActor::CanSee trace result
+#define PERCEPTION_SIGHT_VALID		BIT( 3 )
+#define PERCEPTION_EXPOSURE_VALID	BIT( 4 )
+
+typedef struct perceptionPair_s {
+	int						target;				// entity number
+	int						targetSpawnId;
+	int						flags;
+	int						sightTraces;		// number of traces CanSee would have issued
+	int						exposure;			// idAI::GetSightExposure result
+} perceptionPair_t;
+
+typedef struct perceptionObserver_s {
+	int						entityNum;
+	int						spawnId;
+	int						refreshTime;		// milliseconds between updates
+	int						nextRefreshTime;
+	int						lastQueryTime;		// observers that stop asking are dropped
+	bool					valid;				// pairs have been gathered at least once
+	bool					wantExposure;		// also trace the shoulders of the targets
+	idList<perceptionPair_t>	pairs;
+} perceptionObserver_t;
+
+typedef struct perceptionTrace_s {
+	int						observer;
+	int						pair;
+	int						type;
+} perceptionTrace_t;
+
+typedef struct perceptionStats_s {
+	int						observers;
+	int						pairs;
+	int						culledPVS;
+	int						culledFOV;
+	int						tracesIssued;
+	int						tracesSaved;
+	int						hits;
+	int						misses;
+} perceptionStats_t;
+
+class idAIPerception {
+public:
+							idAIPerception( void );
+
+	void					Clear( void );
+
+	// refreshes the observers that are due, called once per frame before the entities think
+	void					RunFrame( void );
+
+	// the cached results return -1 if the pair is not known, the caller then runs the regular check
+	int						GetView( idActor *observer, const idEntity *target );
+	int						GetSight( idActor *observer, const idEntity *target );
+	int						GetExposure( idAI *observer, const idEntity *target );
+
+	static void				Stats_f( const idCmdArgs &args );
+
+private:
+	idList<perceptionObserver_t>	observers;
+	int						observerNum[MAX_GENTITIES];	// observer index per entity number, -1 if not observing
+
+	// targets of the current frame in structure of arrays form
+	idList<idEntity *>		targetEnts;
+	idList<float>			targetX;
+	idList<float>			targetY;
+	idList<float>			targetZ;
+	idList<byte>			targetCull;
+
+	// traces of the current frame
+	idList<perceptionTrace_t>	traces;
+	idList<idVec3>			traceStarts;
+	idList<idVec3>			traceEnds;
+	idList<const idEntity *>	tracePass;
+	idList<trace_t>			traceResults;
+
+	perceptionStats_t		frameStats;
+	perceptionStats_t		totalStats;
+	int						totalFrames;
+
+	perceptionObserver_t *	FindObserver( idActor *observer, bool create );
+	const perceptionPair_t *FindPair( const perceptionObserver_t *obs, const idEntity *target ) const;
+	void					GatherTargets( void );
+	void					GatherPairs( int observerIndex );
+	void					AddTrace( int observerIndex, int pairIndex, int type, const idVec3 &start, const idVec3 &end, const idEntity *pass );
+	void					FlushTraces( void );
+	void					ResolveTraces( int first, int last );
+	void					RemoveObserver( int index );
+};
+
+#endif /* !__AI_PERCEPTION_H__ */
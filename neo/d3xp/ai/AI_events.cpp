@@ -485,8 +485,10 @@ idEntity* idAI::Event_FindEnemyAI( int useFOV )
 	float		dist;
 	idVec3		delta;
 	pvsHandle_t pvs;
+	bool		pvsValid;
+	int			view;
 
-	pvs = gameLocal.pvs.SetupCurrentPVS( GetPVSAreas(), GetNumPVSAreas() );
+	pvsValid = false;
 
 	bestDist = idMath::INFINITY;
 	bestEnemy = NULL;
@@ -522,27 +524,44 @@ idEntity* idAI::Event_FindEnemyAI( int useFOV )
 			lookPoint = ent->GetPhysics()->GetOrigin();
 		}
 
-		//If not in PVS, then skip.
-		if ( !gameLocal.pvs.InCurrentPVS( pvs, ent->GetPVSAreas(), ent->GetNumPVSAreas() ) )
+		//The perception manager culls the pairs once per frame, it draws its own debug.
+		view = gameLocal.aiPerception.GetView( this, ent );
+		if ( view != -1 )
 		{
-			if (ai_debugPerception.GetInteger() == 1)
+			if ( !( view & PERCEPTION_PVS ) || ( useFOV && !( view & PERCEPTION_FOV ) ) )
 			{
-				idVec3 midpoint = (GetEyePosition() + lookPoint) / 2.0f;
-
-				gameRenderWorld->DebugArrow(colorOrange, GetEyePosition(), lookPoint, 2, 1000);
-				gameRenderWorld->DrawText("NOT IN PVS", midpoint, .2f, colorOrange, gameLocal.GetLocalPlayer()->viewAngles.ToMat3(), 1, 100);
+				continue;
 			}
-
-			continue;
 		}
-
-		
-		if (useFOV)
+		else
 		{
-			if (!CheckFOV(lookPoint)) //Do visionbox check.
+			if ( !pvsValid )
+			{
+				pvs = gameLocal.pvs.SetupCurrentPVS( GetPVSAreas(), GetNumPVSAreas() );
+				pvsValid = true;
+			}
+
+			//If not in PVS, then skip.
+			if ( !gameLocal.pvs.InCurrentPVS( pvs, ent->GetPVSAreas(), ent->GetNumPVSAreas() ) )
 			{
+				if (ai_debugPerception.GetInteger() == 1)
+				{
+					idVec3 midpoint = (GetEyePosition() + lookPoint) / 2.0f;
+
+					gameRenderWorld->DebugArrow(colorOrange, GetEyePosition(), lookPoint, 2, 1000);
+					gameRenderWorld->DrawText("NOT IN PVS", midpoint, .2f, colorOrange, gameLocal.GetLocalPlayer()->viewAngles.ToMat3(), 1, 100);
+				}
+
 				continue;
 			}
+
+			if (useFOV)
+			{
+				if (!CheckFOV(lookPoint)) //Do visionbox check.
+				{
+					continue;
+				}
+			}
 		}
 
 		//Find closest enemy.
@@ -560,7 +579,10 @@ idEntity* idAI::Event_FindEnemyAI( int useFOV )
 		}
 	}
 
-	gameLocal.pvs.FreeCurrentPVS( pvs );
+	if ( pvsValid )
+	{
+		gameLocal.pvs.FreeCurrentPVS( pvs );
+	}
 	idThread::ReturnEntity( bestEnemy );
 
 	return bestEnemy;
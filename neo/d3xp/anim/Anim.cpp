@@ -36,6 +36,9 @@ If you have questions concerning this license or the applicable additional terms
 
 bool idAnimManager::forceExport = false;
 
+// bump when the layout written by idMD5Anim::WriteAnimCache changes
+static const int MD5_ANIM_CACHE_VERSION = 1;
+
 /***********************************************************************
 
 	idMD5Anim
@@ -164,6 +167,19 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	idToken	token;
 	int		i, j;
 	int		num;
+	int		sourceLength;
+	ID_TIME_T sourceTimeStamp;
+
+	// the binary caches share r_md5Cache with the md5 meshes
+	int useCache = cvarSystem->GetCVarInteger( "r_md5Cache" );
+	sourceLength = fileSystem->ReadFile( filename, NULL, &sourceTimeStamp );
+
+	if ( sourceLength >= 0 && useCache == 1 ) {
+		if ( LoadAnimFromCache( filename, sourceTimeStamp, sourceLength ) ) {
+			return true;
+		}
+		Free();
+	}
 
 	if ( !parser.LoadFile( filename ) ) {
 		return false;
@@ -326,10 +342,172 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	// we don't count last frame because it would cause a 1 frame pause at the end
 	animLength = ( ( numFrames - 1 ) * 1000 + frameRate - 1 ) / frameRate;
 
+	if ( useCache != 0 ) {
+		WriteAnimCache( sourceTimeStamp, sourceLength );
+	}
+
 	// done
 	return true;
 }
 
+/*
+====================
+idMD5Anim::WriteAnimCache
+
+writes the parsed anim so the next load is a single read without any lexing
+====================
+*/
+void idMD5Anim::WriteAnimCache( ID_TIME_T sourceTimeStamp, int sourceLength ) const {
+	idStr			cacheName;
+	idFile_Memory	file( name );
+	int				i;
+
+	file.WriteInt( MD5_CACHE_MAGIC );
+	file.WriteInt( MD5_ANIM_CACHE_VERSION );
+	file.WriteUnsignedInt( (unsigned int)sourceTimeStamp );
+	file.WriteInt( sourceLength );
+
+	file.WriteInt( numFrames );
+	file.WriteInt( frameRate );
+	file.WriteInt( animLength );
+	file.WriteInt( numJoints );
+	file.WriteInt( numAnimatedComponents );
+	file.WriteVec3( totaldelta );
+
+	// joint names are stored as strings, the name indexes depend on the load order
+	for( i = 0; i < numJoints; i++ ) {
+		file.WriteString( animationLib.JointName( jointInfo[ i ].nameIndex ) );
+		file.WriteInt( jointInfo[ i ].parentNum );
+		file.WriteInt( jointInfo[ i ].animBits );
+		file.WriteInt( jointInfo[ i ].firstComponent );
+	}
+	for( i = 0; i < numJoints; i++ ) {
+		const idQuat &q = baseFrame[ i ].q;
+		file.WriteVec4( idVec4( q.x, q.y, q.z, q.w ) );
+		file.WriteVec3( baseFrame[ i ].t );
+	}
+	for( i = 0; i < numFrames; i++ ) {
+		file.WriteVec3( bounds[ i ][ 0 ] );
+		file.WriteVec3( bounds[ i ][ 1 ] );
+	}
+	for( i = 0; i < componentFrames.Num(); i++ ) {
+		file.WriteFloat( componentFrames[ i ] );
+	}
+
+	file.WriteInt( MD5_CACHE_MAGIC );
+
+	MD5_CacheFileName( name, MD5_ANIM_CACHE_EXT, cacheName );
+	fileSystem->WriteFile( cacheName, file.GetDataPtr(), file.Length() );
+}
+
+/*
+====================
+idMD5Anim::LoadAnimFromCache
+
+the cache is only used if it was built from a source file with the same timestamp and size
+====================
+*/
+bool idMD5Anim::LoadAnimFromCache( const char *filename, ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	idStr			cacheName;
+	idStr			jointName;
+	void *			buffer;
+	int				length;
+	int				value;
+	unsigned int	cachedTimeStamp;
+	idVec4			q;
+	int				i;
+
+	MD5_CacheFileName( filename, MD5_ANIM_CACHE_EXT, cacheName );
+
+	length = fileSystem->ReadFile( cacheName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory file( cacheName, (const char *)buffer, length );
+	bool ok = false;
+
+	Free();
+	name = filename;
+
+	file.ReadInt( value );
+	if ( value != MD5_CACHE_MAGIC ) {
+		goto done;
+	}
+	file.ReadInt( value );
+	if ( value != MD5_ANIM_CACHE_VERSION ) {
+		goto done;
+	}
+	file.ReadUnsignedInt( cachedTimeStamp );
+	file.ReadInt( value );
+	if ( cachedTimeStamp != (unsigned int)sourceTimeStamp || value != sourceLength ) {
+		goto done;
+	}
+
+	file.ReadInt( numFrames );
+	file.ReadInt( frameRate );
+	file.ReadInt( animLength );
+	file.ReadInt( numJoints );
+	file.ReadInt( numAnimatedComponents );
+	file.ReadVec3( totaldelta );
+
+	// every joint takes at least 44 bytes, every frame 24 bytes plus the components
+	if ( numFrames <= 0 || numJoints <= 0 || frameRate < 0 || numAnimatedComponents < 0 || numAnimatedComponents > numJoints * 6 ) {
+		goto done;
+	}
+	if ( (int64)numJoints * 44 + (int64)numFrames * ( 24 + numAnimatedComponents * sizeof( float ) ) > length - file.Tell() ) {
+		goto done;
+	}
+
+	jointInfo.SetGranularity( 1 );
+	jointInfo.SetNum( numJoints );
+	for( i = 0; i < numJoints; i++ ) {
+		file.ReadString( jointName );
+		jointInfo[ i ].nameIndex = animationLib.JointIndex( jointName );
+		file.ReadInt( jointInfo[ i ].parentNum );
+		file.ReadInt( jointInfo[ i ].animBits );
+		file.ReadInt( jointInfo[ i ].firstComponent );
+		if ( jointInfo[ i ].parentNum >= i || ( jointInfo[ i ].animBits & ~63 ) ) {
+			goto done;
+		}
+		if ( numAnimatedComponents > 0 && ( jointInfo[ i ].firstComponent < 0 || jointInfo[ i ].firstComponent >= numAnimatedComponents ) ) {
+			goto done;
+		}
+	}
+
+	baseFrame.SetGranularity( 1 );
+	baseFrame.SetNum( numJoints );
+	for( i = 0; i < numJoints; i++ ) {
+		file.ReadVec4( q );
+		baseFrame[ i ].q.Set( q.x, q.y, q.z, q.w );
+		file.ReadVec3( baseFrame[ i ].t );
+	}
+
+	bounds.SetGranularity( 1 );
+	bounds.SetNum( numFrames );
+	file.Read( bounds.Ptr(), numFrames * sizeof( idBounds ) );
+	LittleRevBytes( bounds.Ptr(), sizeof( float ), numFrames * 6 );
+
+	componentFrames.SetGranularity( 1 );
+	componentFrames.SetNum( numAnimatedComponents * numFrames );
+	file.Read( componentFrames.Ptr(), componentFrames.Num() * sizeof( float ) );
+	LittleRevBytes( componentFrames.Ptr(), sizeof( float ), componentFrames.Num() );
+
+	file.ReadInt( value );
+	if ( value != MD5_CACHE_MAGIC ) {
+		goto done;
+	}
+
+	ok = true;
+
+done:
+	fileSystem->FreeFile( buffer );
+	if ( !ok ) {
+		gameLocal.DPrintf( "%s: out of date or damaged, parsing %s\n", cacheName.c_str(), filename );
+	}
+	return ok;
+}
+
 /*
 ====================
 idMD5Anim::IncreaseRefs
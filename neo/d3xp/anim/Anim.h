@@ -316,6 +316,8 @@ public:
 	size_t					Allocated( void ) const;
 	size_t					Size( void ) const { return sizeof( *this ) + Allocated(); };
 	bool					LoadAnim( const char *filename );
+	bool					LoadAnimFromCache( const char *filename, ID_TIME_T sourceTimeStamp, int sourceLength );
+	void					WriteAnimCache( ID_TIME_T sourceTimeStamp, int sourceLength ) const;
 
 	void					IncreaseRefs( void ) const;
 	void					DecreaseRefs( void ) const;
@@ -11,6 +11,8 @@
 
 #include "framework/DeclEntityDef.h"
 #include "framework/FileSystem.h"
+#include "idlib/Timer.h"
+#include "idlib/hashing/CRC32.h"
 #include "WorldSpawn.h"
 
 #include "idlib/LangDict.h"
@@ -240,6 +242,7 @@ idMeta::idMeta()
 		nodePositions[0] = vec3_zero;
 	}
 	lastNodeSearchPos = idVec3(-1, -1, -1);
+	searchNodeTableValid = false;
 
 	memset(pipeStatuses, 0, sizeof(bool)*MAX_PIPESTATUSES);
 	memset(mapguiBound, 0, sizeof(idVec2)*2);
@@ -842,6 +845,7 @@ void idMeta::Restore(idRestoreGame* savefile)
 
 	savefile->ReadInt( nodePosArraySize ); //  int nodePosArraySize
 	savefile->ReadVec3( lastNodeSearchPos ); //  idVec3 lastNodeSearchPos
+	InvalidateSearchNodeTable(); // rebuilt on the next query
 
 	savefile->ReadInt( combatMetastate ); //  int combatMetastate
 
@@ -2946,20 +2950,90 @@ void idMeta::OnEnemyDestroyed(idEntity *ent)
 }
 
 
+// Spots around a searchnode that are tried when the node itself has no LOS. total number of points: 24
+static const idVec3 searchNodeLOSOffsets[] = {
+	idVec3(0,32,0),
+	idVec3(0,-32,0),
+	idVec3(32,0,0),
+	idVec3(-32,0,0),
+
+	idVec3(32,32,0),
+	idVec3(32,-32,0),
+	idVec3(-32,-32,0),
+	idVec3(-32,32,0),
+
+	idVec3(0,64,0),
+	idVec3(0,-64,0),
+	idVec3(64,0,0),
+	idVec3(-64,0,0),
+
+	idVec3(64,64,0),
+	idVec3(64,-64,0),
+	idVec3(-64,-64,0),
+	idVec3(-64,64,0),
+
+	idVec3(0,96,0),
+	idVec3(0,-96,0),
+	idVec3(96,0,0),
+	idVec3(-96,0,0),
+
+	idVec3(96,96,0),
+	idVec3(96,-96,0),
+	idVec3(-96,-96,0),
+	idVec3(-96,96,0)
+};
+const int NUM_SEARCHNODE_LOS_OFFSETS = sizeof(searchNodeLOSOffsets) / sizeof(searchNodeLOSOffsets[0]);
+
+static const idBounds searchNodeBodyBounds(idVec3(-24, -24, 0), idVec3(24, 24, 74)); //bounding box for human actor.
+
+const int MAX_NODELOS_HISTORY = 256; //how many observed points are kept around for the testNodeLOS benchmark.
+
+#define SEARCHNODE_TABLE_DIR		"generated/searchnodes"
+#define SEARCHNODE_TABLE_EXT		"snt"
+#define SEARCHNODE_TABLE_MAGIC		( ( 'S' << 24 ) | ( 'N' << 16 ) | ( 'T' << 8 ) | ' ' )
+#define SEARCHNODE_TABLE_VERSION	1
+
 bool idMeta::GenerateNodeLOS(idVec3 pointToObserve)
 {
 	//BC create array of nodes that can see a specific point.
-	//The way this works is we iterate over all the searchnodes and
-	//does tracelines. This is a very brute force approach.
-
-	pvsHandle_t		pvs;
-	int				localPvsArea;	
 
 	if ((int)pointToObserve[0] == lastNodeSearchPos[0] && (int)pointToObserve[1] == lastNodeSearchPos[1] && (int)pointToObserve[2] == lastNodeSearchPos[2])
 		return true; //Already have this info. Don't re-generate the same data.
 
 	lastNodeSearchPos = idVec3((int)pointToObserve[0], (int)pointToObserve[1], (int)pointToObserve[2]); //Keep a record of the last point, so that we're not doing unnecessary data re-generation of the same spot. We're converting floats to int so that we can compare the number.
 
+	//Remember the observed points so testNodeLOS can replay them.
+	if (nodeLOSHistory.Num() >= MAX_NODELOS_HISTORY)
+	{
+		nodeLOSHistory.RemoveIndex(0);
+	}
+	nodeLOSHistory.Append(pointToObserve);
+
+	bool found;
+	if (ai_searchNodeTable.GetInteger() != 0)
+	{
+		found = GenerateNodeLOS_Table(pointToObserve);
+	}
+	else
+	{
+		found = GenerateNodeLOS_Traces(pointToObserve);
+	}
+
+	if (found)
+	{
+		return true; //Success. Found at least one valid spot.
+	}
+
+	gameLocal.Warning("GenerateNodeLOS() couldn't find a suitable LOS node to: %.0f %.0f %.0f", pointToObserve.x, pointToObserve.y, pointToObserve.z);
+	return false; //Fail. Couldn't find a spot that has LOS to pointToObserve.
+}
+
+//The original brute force approach: iterate over all the searchnodes and do tracelines.
+bool idMeta::GenerateNodeLOS_Traces(const idVec3 &pointToObserve)
+{
+	pvsHandle_t		pvs;
+	int				localPvsArea;	
+
 	localPvsArea = gameLocal.pvs.GetPVSArea(pointToObserve);
 	pvs = gameLocal.pvs.SetupCurrentPVS(localPvsArea);
 
@@ -3001,58 +3075,21 @@ bool idMeta::GenerateNodeLOS(idVec3 pointToObserve)
 			//Check the spots around the interestpoint.
 
 			trace_t bodyTr;			
-			idBounds bodyBounds;
-
-			//total number of points: 24
-			idVec3 offsets[] = {
-				idVec3(0,32,0),
-				idVec3(0,-32,0),
-				idVec3(32,0,0),
-				idVec3(-32,0,0),
-
-				idVec3(32,32,0),
-				idVec3(32,-32,0),
-				idVec3(-32,-32,0),
-				idVec3(-32,32,0),
-
-				idVec3(0,64,0),
-				idVec3(0,-64,0),
-				idVec3(64,0,0),
-				idVec3(-64,0,0),
-
-				idVec3(64,64,0),
-				idVec3(64,-64,0),
-				idVec3(-64,-64,0),
-				idVec3(-64,64,0),
-
-				idVec3(0,96,0),
-				idVec3(0,-96,0),
-				idVec3(96,0,0),
-				idVec3(-96,0,0),
-
-				idVec3(96,96,0),
-				idVec3(96,-96,0),
-				idVec3(-96,-96,0),
-				idVec3(-96,96,0)
-			};
-
-			bodyBounds = idBounds(idVec3(-24, -24, 0), idVec3(24, 24, 74)); //bounding box for human actor.
-			
 
-			for (int i = 0; i < 24; i++)
+			for (int i = 0; i < NUM_SEARCHNODE_LOS_OFFSETS; i++)
 			{
 				idVec3 candidatePos;
 				trace_t floorTr;
 
-				candidatePos = entity->GetPhysics()->GetOrigin() + offsets[i];
+				candidatePos = entity->GetPhysics()->GetOrigin() + searchNodeLOSOffsets[i];
 
 				gameLocal.clip.TracePoint(floorTr, entity->GetPhysics()->GetOrigin() + idVec3(0, 0, 1), entity->GetPhysics()->GetOrigin() + idVec3(0, 0, -2), MASK_MONSTERSOLID, NULL); //Check if there's a floor to stand on.
 				if (floorTr.fraction >= 1)
 					continue;
 
-				gameLocal.clip.TraceBounds(bodyTr, candidatePos + idVec3(0,0,0.1f), candidatePos + idVec3(0, 0, 0.1f), bodyBounds, MASK_SOLID, NULL); //Check if this space can fit the human bounding box.
+				gameLocal.clip.TraceBounds(bodyTr, candidatePos + idVec3(0,0,0.1f), candidatePos + idVec3(0, 0, 0.1f), searchNodeBodyBounds, MASK_SOLID, NULL); //Check if this space can fit the human bounding box.
 				
-				//gameRenderWorld->DebugBounds((bodyTr.fraction >= 1.0f) ? colorCyan : colorRed, bodyBounds, candidatePos, 10000);
+				//gameRenderWorld->DebugBounds((bodyTr.fraction >= 1.0f) ? colorCyan : colorRed, searchNodeBodyBounds, candidatePos, 10000);
 
 				if (bodyTr.fraction >= 1)
 				{
@@ -3077,14 +3114,360 @@ bool idMeta::GenerateNodeLOS(idVec3 pointToObserve)
 	}
 
 	gameLocal.pvs.FreeCurrentPVS(pvs);
-	
-	if (nodePosArraySize > 0)
+
+	return (nodePosArraySize > 0);
+}
+
+//Same result as GenerateNodeLOS_Traces, but uses the precomputed searchnode table:
+//the PVS test is a bit lookup of the node's cached eye area, the floor check is done once per node
+//instead of once per offset, and offsets where the body bounds don't fit into the world are never traced.
+//Only the entity part of the body check and the actual LOS traces are left to do at runtime.
+bool idMeta::GenerateNodeLOS_Table(const idVec3 &pointToObserve)
+{
+	pvsHandle_t		pvs;
+	idVec3			adjustedObservepoint;
+	int				nodeIndex;
+
+	if (!searchNodeTableValid)
 	{
-		return true; //Success. Found at least one valid spot.
+		BuildSearchNodeTable();
 	}
 
-	gameLocal.Warning("GenerateNodeLOS() couldn't find a suitable LOS node to: %.0f %.0f %.0f", pointToObserve.x, pointToObserve.y, pointToObserve.z);
-	return false; //Fail. Couldn't find a spot that has LOS to pointToObserve.
+	pvs = gameLocal.pvs.SetupCurrentPVS(gameLocal.pvs.GetPVSArea(pointToObserve));
+	adjustedObservepoint = pointToObserve + idVec3(0, 0, gameLocal.GetLocalPlayer()->EyeHeight());
+
+	nodePosArraySize = 0;
+	nodeIndex = 0;
+
+	for (idEntity* entity = gameLocal.searchnodeEntities.Next(); entity != NULL; entity = entity->aiSearchNodes.Next(), nodeIndex++)
+	{
+		trace_t tr;
+		float lengthToPoint;
+
+		if (nodePosArraySize >= MAX_LOS_NODES)
+			break;
+
+		if (nodeIndex >= searchNodeTable.Num() || searchNodeTable[nodeIndex].ent != entity || searchNodeTable[nodeIndex].origin != entity->GetPhysics()->GetOrigin())
+		{
+			//A searchnode was added, removed or moved since the table was made. Start over with a fresh one.
+			gameLocal.pvs.FreeCurrentPVS(pvs);
+			searchNodeTableValid = false;
+			return GenerateNodeLOS_Traces(pointToObserve);
+		}
+
+		const searchNodeInfo_t &node = searchNodeTable[nodeIndex];
+
+		if (!gameLocal.pvs.InCurrentPVS(pvs, node.eyeArea))
+		{
+			continue;
+		}
+
+		gameLocal.clip.TracePoint(tr, node.origin + idVec3(0, 0, MONSTER_EYEHEIGHT), adjustedObservepoint, MASK_SOLID, NULL);
+		lengthToPoint = (adjustedObservepoint - tr.endpos).LengthFast();
+
+		if (lengthToPoint < SEARCHNODE_LOS_DISTANCE_THRESHOLD || tr.fraction >= 1.0f)
+		{
+			//Searchnode is valid. Add to array.
+			nodePositions[nodePosArraySize] = node.origin;
+			nodePosArraySize++;
+			continue;
+		}
+
+		if (node.fitMask == 0)
+		{
+			continue;
+		}
+
+		//The floor check only depends on the node, so it is done once for all offsets.
+		trace_t floorTr;
+		gameLocal.clip.TracePoint(floorTr, node.origin + idVec3(0, 0, 1), node.origin + idVec3(0, 0, -2), MASK_MONSTERSOLID, NULL);
+		if (floorTr.fraction >= 1)
+		{
+			continue;
+		}
+
+		for (int i = 0; i < NUM_SEARCHNODE_LOS_OFFSETS; i++)
+		{
+			trace_t bodyTr;
+			idVec3 candidatePos;
+
+			if (!(node.fitMask & (1 << i)))
+			{
+				continue; //The world doesn't leave enough room here.
+			}
+
+			candidatePos = node.origin + searchNodeLOSOffsets[i];
+
+			//The world was checked when building the table, but entities may still be in the way.
+			gameLocal.clip.TraceBounds(bodyTr, candidatePos + idVec3(0, 0, 0.1f), candidatePos + idVec3(0, 0, 0.1f), searchNodeBodyBounds, MASK_SOLID, NULL);
+			if (bodyTr.fraction < 1)
+			{
+				continue;
+			}
+
+			gameLocal.clip.TracePoint(tr, candidatePos + idVec3(0, 0, MONSTER_EYEHEIGHT), adjustedObservepoint, MASK_SOLID, NULL);
+			lengthToPoint = (adjustedObservepoint - tr.endpos).LengthFast();
+
+			if (lengthToPoint < SEARCHNODE_LOS_DISTANCE_THRESHOLD || tr.fraction >= 1.0f)
+			{
+				//Valid point. Add to array.
+				nodePositions[nodePosArraySize] = candidatePos;
+				nodePosArraySize++;
+				break;
+			}
+		}
+	}
+
+	gameLocal.pvs.FreeCurrentPVS(pvs);
+
+	return (nodePosArraySize > 0);
+}
+
+void idMeta::InvalidateSearchNodeTable()
+{
+	searchNodeTableValid = false;
+	searchNodeTable.Clear();
+}
+
+//Gather the static per-node data: position, PVS area of the eye and which of the offsets
+//fit the body bounds against the world geometry. Entities are left out on purpose, they can move.
+void idMeta::BuildSearchNodeTable()
+{
+	idTimer			timer;
+	idStr			fileName;
+	unsigned int	key;
+	ID_TIME_T		mapTime = 0;
+
+	timer.Start();
+
+	searchNodeTable.Clear();
+	for (idEntity* entity = gameLocal.searchnodeEntities.Next(); entity != NULL; entity = entity->aiSearchNodes.Next())
+	{
+		searchNodeInfo_t &node = searchNodeTable.Alloc();
+		node.ent = entity;
+		node.origin = entity->GetPhysics()->GetOrigin();
+		node.eyeArea = -1;
+		node.fitMask = 0;
+	}
+	searchNodeTableValid = true;
+
+	//The cache is keyed on the map file and the node positions.
+	fileSystem->ReadFile(gameLocal.GetMapName(), NULL, &mapTime);
+	CRC32_InitChecksum(key);
+	CRC32_UpdateChecksum(key, &mapTime, sizeof(mapTime));
+	for (int i = 0; i < searchNodeTable.Num(); i++)
+	{
+		CRC32_UpdateChecksum(key, searchNodeTable[i].origin.ToFloatPtr(), sizeof(idVec3));
+	}
+	CRC32_FinishChecksum(key);
+
+	fileName = gameLocal.GetMapNameStripped();
+	fileName.StripPath();
+	fileName = va("%s/%s.%s", SEARCHNODE_TABLE_DIR, fileName.c_str(), SEARCHNODE_TABLE_EXT);
+
+	if (ai_searchNodeTable.GetInteger() == 1 && LoadSearchNodeTable(fileName, key))
+	{
+		timer.Stop();
+		gameLocal.Printf("loaded searchnode table for %d nodes from %s in %u ms\n", searchNodeTable.Num(), fileName.c_str(), timer.Milliseconds());
+		return;
+	}
+
+	idTraceModel bodyTrm(searchNodeBodyBounds);
+
+	for (int n = 0; n < searchNodeTable.Num(); n++)
+	{
+		searchNodeInfo_t &node = searchNodeTable[n];
+
+		node.eyeArea = gameLocal.pvs.GetPVSArea(node.origin + idVec3(0, 0, MONSTER_EYEHEIGHT));
+
+		for (int i = 0; i < NUM_SEARCHNODE_LOS_OFFSETS; i++)
+		{
+			trace_t bodyTr;
+			idVec3 start = node.origin + searchNodeLOSOffsets[i] + idVec3(0, 0, 0.1f);
+
+			collisionModelManager->Translation(&bodyTr, start, start, &bodyTrm, mat3_identity, MASK_SOLID, 0, vec3_origin, mat3_default, 0);
+			if (bodyTr.fraction >= 1)
+			{
+				node.fitMask |= (1 << i);
+			}
+		}
+	}
+
+	timer.Stop();
+	gameLocal.Printf("built searchnode table for %d nodes in %u ms\n", searchNodeTable.Num(), timer.Milliseconds());
+
+	WriteSearchNodeTable(fileName, key);
+}
+
+bool idMeta::LoadSearchNodeTable(const char *fileName, unsigned int key)
+{
+	void *buffer;
+	int length;
+	int magic, version, numAreas, num;
+	unsigned int fileKey;
+
+	length = fileSystem->ReadFile(fileName, &buffer, NULL);
+	if (length <= 0 || buffer == NULL)
+	{
+		return false;
+	}
+
+	idFile_Memory file(fileName, (const char *)buffer, length);
+	file.ReadInt(magic);
+	file.ReadInt(version);
+	file.ReadUnsignedInt(fileKey);
+	file.ReadInt(numAreas);
+	file.ReadInt(num);
+
+	bool ok = (magic == SEARCHNODE_TABLE_MAGIC && version == SEARCHNODE_TABLE_VERSION && fileKey == key
+		&& numAreas == gameRenderWorld->NumAreas() && num == searchNodeTable.Num()
+		&& length == file.Tell() + num * 2 * (int)sizeof(int));
+
+	if (ok)
+	{
+		for (int i = 0; i < num; i++)
+		{
+			file.ReadInt(searchNodeTable[i].eyeArea);
+			file.ReadInt(searchNodeTable[i].fitMask);
+		}
+	}
+
+	fileSystem->FreeFile(buffer);
+	return ok;
+}
+
+void idMeta::WriteSearchNodeTable(const char *fileName, unsigned int key)
+{
+	if (ai_searchNodeTable.GetInteger() == 0)
+	{
+		return;
+	}
+
+	idFile_Memory file(fileName);
+	file.WriteInt(SEARCHNODE_TABLE_MAGIC);
+	file.WriteInt(SEARCHNODE_TABLE_VERSION);
+	file.WriteUnsignedInt(key);
+	file.WriteInt(gameRenderWorld->NumAreas());
+	file.WriteInt(searchNodeTable.Num());
+	for (int i = 0; i < searchNodeTable.Num(); i++)
+	{
+		file.WriteInt(searchNodeTable[i].eyeArea);
+		file.WriteInt(searchNodeTable[i].fitMask);
+	}
+
+	fileSystem->WriteFile(fileName, file.GetDataPtr(), file.Length());
+}
+
+/*
+================
+idMeta::TestNodeLOS_f
+
+Replays the recently observed points (or the searchnode positions if there are none)
+through the brute force and the table version of GenerateNodeLOS and compares them.
+================
+*/
+void idMeta::TestNodeLOS_f(const idCmdArgs &args)
+{
+	idMeta *meta;
+	idList<idVec3> points;
+	idList<idVec3> results;
+	idTimer timerTraces, timerTable;
+	int count, numMismatches;
+
+	if (!gameLocal.GetLocalPlayer() || !gameLocal.metaEnt.IsValid())
+	{
+		gameLocal.Printf("testNodeLOS: no map with a meta entity loaded\n");
+		return;
+	}
+
+	meta = static_cast<idMeta *>(gameLocal.metaEnt.GetEntity());
+
+	count = (args.Argc() > 1) ? atoi(args.Argv(1)) : 10;
+	if (count < 1)
+	{
+		count = 1;
+	}
+
+	points = meta->nodeLOSHistory;
+	if (points.Num() == 0)
+	{
+		for (idEntity* entity = gameLocal.searchnodeEntities.Next(); entity != NULL && points.Num() < MAX_NODELOS_HISTORY; entity = entity->aiSearchNodes.Next())
+		{
+			points.Append(entity->GetPhysics()->GetOrigin());
+		}
+	}
+	if (points.Num() == 0)
+	{
+		gameLocal.Printf("testNodeLOS: no observed points and no searchnodes\n");
+		return;
+	}
+
+	//Don't let the first table query pay for building the table.
+	if (!meta->searchNodeTableValid)
+	{
+		meta->BuildSearchNodeTable();
+	}
+
+	idVec3 savedPositions[MAX_LOS_NODES];
+	int savedSize = meta->nodePosArraySize;
+	memcpy(savedPositions, meta->nodePositions, sizeof(savedPositions));
+
+	results.SetNum(points.Num() * MAX_LOS_NODES);
+	idList<int> resultSizes;
+	resultSizes.SetNum(points.Num());
+
+	timerTraces.Start();
+	for (int c = 0; c < count; c++)
+	{
+		for (int i = 0; i < points.Num(); i++)
+		{
+			meta->GenerateNodeLOS_Traces(points[i]);
+			if (c == 0)
+			{
+				resultSizes[i] = meta->nodePosArraySize;
+				for (int j = 0; j < meta->nodePosArraySize; j++)
+				{
+					results[i * MAX_LOS_NODES + j] = meta->nodePositions[j];
+				}
+			}
+		}
+	}
+	timerTraces.Stop();
+
+	numMismatches = 0;
+	timerTable.Start();
+	for (int c = 0; c < count; c++)
+	{
+		for (int i = 0; i < points.Num(); i++)
+		{
+			meta->GenerateNodeLOS_Table(points[i]);
+			if (c == 0)
+			{
+				bool same = (resultSizes[i] == meta->nodePosArraySize);
+				for (int j = 0; same && j < meta->nodePosArraySize; j++)
+				{
+					same = (results[i * MAX_LOS_NODES + j] == meta->nodePositions[j]);
+				}
+				if (!same)
+				{
+					numMismatches++;
+				}
+			}
+		}
+	}
+	timerTable.Stop();
+
+	meta->nodePosArraySize = savedSize;
+	memcpy(meta->nodePositions, savedPositions, sizeof(savedPositions));
+
+	int numQueries = count * points.Num();
+	double msTraces = (double)timerTraces.Milliseconds() / numQueries;
+	double msTable = (double)timerTable.Milliseconds() / numQueries;
+
+	gameLocal.Printf("testNodeLOS: %d points, %d searchnodes, %d queries each\n", points.Num(), meta->searchNodeTable.Num(), numQueries);
+	gameLocal.Printf("  traces: %8.4f ms per query\n", msTraces);
+	gameLocal.Printf("  table:  %8.4f ms per query (%.2fx)\n", msTable, (msTable > 0.0) ? msTraces / msTable : 0.0);
+	gameLocal.Printf("  %d mismatching results\n", numMismatches);
 }
 
 
@@ -120,6 +120,10 @@ public:
 	idVec3				nodePositions[MAX_LOS_NODES];
 	int					nodePosArraySize;
 	idVec3				lastNodeSearchPos;
+	bool				GenerateNodeLOS_Traces( const idVec3 &pointToObserve );
+	bool				GenerateNodeLOS_Table( const idVec3 &pointToObserve );
+	void				InvalidateSearchNodeTable();
+	static void			TestNodeLOS_f( const idCmdArgs &args );
 
 
 	int					combatMetastate;
@@ -522,5 +526,21 @@ private:
 	//BC 3-24-2025: locbox.
 	idEntity* lkpLocbox = nullptr;
 
+	//precomputed searchnode data for GenerateNodeLOS_Table. Built on the first query, cached to disk, not saved.
+	typedef struct searchNodeInfo_s {
+		const idEntity *	ent;
+		idVec3				origin;
+		int					eyeArea;		// pvs area of the node eye position
+		int					fitMask;		// one bit per LOS offset, set when the body bounds fit into the world there
+	} searchNodeInfo_t;
+
+	idList<searchNodeInfo_t> searchNodeTable;
+	bool				searchNodeTableValid;
+	idList<idVec3>		nodeLOSHistory;		// recently observed points, replayed by testNodeLOS
+
+	void				BuildSearchNodeTable();
+	bool				LoadSearchNodeTable( const char *fileName, unsigned int key );
+	void				WriteSearchNodeTable( const char *fileName, unsigned int key );
+
 	//BC PRIVATE END
 };
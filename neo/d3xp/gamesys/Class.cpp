@@ -639,6 +639,10 @@ idClass::CancelEvents
 ================
 */
 void idClass::CancelEvents( const idEventDef *ev ) {
+	if ( idParallelThink::IsDeferring() ) {
+		idParallelThink::DeferCancelEvents( this, ev );
+		return;
+	}
 	idEvent::CancelEvents( this, ev );
 }
 
@@ -676,6 +680,14 @@ bool idClass::PostEventArgs( const idEventDef *ev, int time, int numargs, ... )
 		return true;
 	}
 
+	// the event queue is shared, events posted in the parallel think phase are scheduled afterwards
+	if ( idParallelThink::IsDeferring() ) {
+		va_start( args, numargs );
+		idParallelThink::DeferEvent( this, ev, time, numargs, args );
+		va_end( args );
+		return true;
+	}
+
 	va_start( args, numargs );
 	event = idEvent::Alloc( ev, numargs, args );
 	va_end( args );
@@ -271,6 +271,11 @@ private:
 
 	// SM: Bool to track when removed to prevent adding events on deleted objects
 	bool						isRemoved = false;
+
+	// events scheduled for this object, so they can be canceled without searching the event queues
+	idLinkList<idEvent>			pendingEvents;
+
+	friend class idEvent;
 };
 
 /***********************************************************************
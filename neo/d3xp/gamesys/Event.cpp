@@ -27,6 +27,7 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "sys/platform.h"
+#include "framework/Profiler.h"
 #include "script/Script_Program.h"
 #include "Entity.h"
 #include "Game_local.h"
@@ -210,12 +211,193 @@ const idEventDef *idEventDef::FindEvent( const char *name ) {
 
 ***********************************************************************/
 
+/*
+===============================================================================
+
+	idEventHeap
+
+	Binary min heap of the scheduled events ordered by time. Events with the
+	same time keep the order they were posted in through their sequence number.
+	Every event knows its position in the heap so it can be removed in O(log n)
+	when it is canceled.
+
+===============================================================================
+*/
+
+class idEventHeap {
+public:
+						idEventHeap( void ) { num = 0; }
+
+	int					Num( void ) const { return num; }
+	idEvent *			First( void ) const { return num > 0 ? heap[0] : NULL; }
+	idEvent *			operator[]( int index ) const { return heap[index]; }
+
+	void				Add( idEvent *event );
+	void				Remove( idEvent *event );
+	void				Clear( void );
+
+	static bool			Before( const idEvent *a, const idEvent *b );
+
+private:
+	idEvent *			heap[ MAX_EVENTS ];
+	int					num;
+
+	void				Set( int index, idEvent *event );
+	void				SiftUp( int index );
+	void				SiftDown( int index );
+};
+
+/*
+================
+idEventHeap::Before
+================
+*/
+ID_INLINE bool idEventHeap::Before( const idEvent *a, const idEvent *b ) {
+	if ( a->time != b->time ) {
+		return a->time < b->time;
+	}
+	return (int)( a->sequence - b->sequence ) < 0;
+}
+
+/*
+================
+idEventHeap::Set
+================
+*/
+ID_INLINE void idEventHeap::Set( int index, idEvent *event ) {
+	heap[index] = event;
+	event->queueIndex = index;
+}
+
+/*
+================
+idEventHeap::SiftUp
+================
+*/
+void idEventHeap::SiftUp( int index ) {
+	idEvent *event = heap[index];
+	while ( index > 0 ) {
+		int parent = ( index - 1 ) >> 1;
+		if ( !Before( event, heap[parent] ) ) {
+			break;
+		}
+		Set( index, heap[parent] );
+		index = parent;
+	}
+	Set( index, event );
+}
+
+/*
+================
+idEventHeap::SiftDown
+================
+*/
+void idEventHeap::SiftDown( int index ) {
+	idEvent *event = heap[index];
+	while ( 1 ) {
+		int child = index * 2 + 1;
+		if ( child >= num ) {
+			break;
+		}
+		if ( child + 1 < num && Before( heap[child + 1], heap[child] ) ) {
+			child++;
+		}
+		if ( !Before( heap[child], event ) ) {
+			break;
+		}
+		Set( index, heap[child] );
+		index = child;
+	}
+	Set( index, event );
+}
+
+/*
+================
+idEventHeap::Add
+================
+*/
+void idEventHeap::Add( idEvent *event ) {
+	assert( event->queue == NULL );
+	assert( num < MAX_EVENTS );
+
+	event->queue = this;
+	Set( num++, event );
+	SiftUp( num - 1 );
+}
+
+/*
+================
+idEventHeap::Remove
+================
+*/
+void idEventHeap::Remove( idEvent *event ) {
+	assert( event->queue == this && heap[event->queueIndex] == event );
+
+	int index = event->queueIndex;
+	event->queue = NULL;
+	event->queueIndex = -1;
+
+	num--;
+	if ( index == num ) {
+		return;
+	}
+
+	// move the last event into the hole and restore the heap order
+	Set( index, heap[num] );
+	if ( index > 0 && Before( heap[index], heap[( index - 1 ) >> 1] ) ) {
+		SiftUp( index );
+	} else {
+		SiftDown( index );
+	}
+}
+
+/*
+================
+idEventHeap::Clear
+================
+*/
+void idEventHeap::Clear( void ) {
+	for ( int i = 0; i < num; i++ ) {
+		heap[i]->queue = NULL;
+		heap[i]->queueIndex = -1;
+	}
+	num = 0;
+}
+
 static idLinkList<idEvent> FreeEvents;
-static idLinkList<idEvent> EventQueue;
+static idEventHeap EventQueue;
 #ifdef _D3XP
-static idLinkList<idEvent> FastEventQueue;
+static idEventHeap FastEventQueue;
 #endif
 static idEvent EventPool[ MAX_EVENTS ];
+static unsigned int eventSequence;
+
+/*
+================
+SortEventsByTime
+================
+*/
+static int SortEventsByTime( idEvent * const *a, idEvent * const *b ) {
+	if ( idEventHeap::Before( *a, *b ) ) {
+		return -1;
+	}
+	return idEventHeap::Before( *b, *a ) ? 1 : 0;
+}
+
+/*
+================
+GetEventsByTime
+
+the events of a queue in the order they will be serviced
+================
+*/
+static void GetEventsByTime( const idEventHeap &queue, idList<idEvent *> &events ) {
+	events.SetNum( queue.Num() );
+	for ( int i = 0; i < queue.Num(); i++ ) {
+		events[i] = queue[i];
+	}
+	events.Sort( SortEventsByTime );
+}
 
 bool idEvent::initialized = false;
 
@@ -238,11 +420,6 @@ idEvent::Alloc
 idEvent *idEvent::Alloc( const idEventDef *evdef, int numargs, va_list args ) {
 	idEvent		*ev;
 	size_t		size;
-	const char	*format;
-	idEventArg	*arg;
-	byte		*dataPtr;
-	int			i;
-	const char	*materialName;
 
 	if ( FreeEvents.IsListEmpty() ) {
 		gameLocal.Error( "idEvent::Alloc : No more free events" );
@@ -261,10 +438,60 @@ idEvent *idEvent::Alloc( const idEventDef *evdef, int numargs, va_list args ) {
 	if ( size ) {
 		ev->data = eventDataAllocator.Alloc( size );
 		memset( ev->data, 0, size );
+		FormatArgs( evdef, numargs, args, ev->data );
+	} else {
+		ev->data = NULL;
+	}
+
+	return ev;
+}
+
+/*
+================
+idEvent::AllocFormatted
+
+allocates an event from arguments that were already packed by FormatArgs
+================
+*/
+idEvent *idEvent::AllocFormatted( const idEventDef *evdef, const byte *formattedArgs ) {
+	idEvent		*ev;
+	size_t		size;
+
+	if ( FreeEvents.IsListEmpty() ) {
+		gameLocal.Error( "idEvent::AllocFormatted : No more free events" );
+	}
+
+	ev = FreeEvents.Next();
+	ev->eventNode.Remove();
+
+	ev->eventdef = evdef;
+
+	size = evdef->GetArgSize();
+	if ( size ) {
+		ev->data = eventDataAllocator.Alloc( size );
+		memcpy( ev->data, formattedArgs, size );
 	} else {
 		ev->data = NULL;
 	}
 
+	return ev;
+}
+
+/*
+================
+idEvent::FormatArgs
+
+packs the arguments into the event data layout, data has to be GetArgSize() bytes and cleared.
+does not touch any shared state so it can be used from the parallel think phase.
+================
+*/
+void idEvent::FormatArgs( const idEventDef *evdef, int numargs, va_list args, byte *data ) {
+	const char	*format;
+	idEventArg	*arg;
+	byte		*dataPtr;
+	int			i;
+	const char	*materialName;
+
 	format = evdef->GetArgFormat();
 	for( i = 0; i < numargs; i++ ) {
 		arg = va_arg( args, idEventArg * );
@@ -275,7 +502,7 @@ idEvent *idEvent::Alloc( const idEventDef *evdef, int numargs, va_list args ) {
 			}
 		}
 
-		dataPtr = &ev->data[ evdef->GetArgOffset( i ) ];
+		dataPtr = &data[ evdef->GetArgOffset( i ) ];
 
 		switch( format[ i ] ) {
 		case D_EVENT_FLOAT :
@@ -322,8 +549,6 @@ idEvent *idEvent::Alloc( const idEventDef *evdef, int numargs, va_list args ) {
 			break;
 		}
 	}
-
-	return ev;
 }
 
 /*
@@ -360,6 +585,11 @@ idEvent::Free
 ================
 */
 void idEvent::Free( void ) {
+	if ( queue != NULL ) {
+		queue->Remove( this );
+	}
+	objectNode.Remove();
+
 	if ( data ) {
 		eventDataAllocator.Free( data );
 		data = NULL;
@@ -380,50 +610,36 @@ idEvent::Schedule
 ================
 */
 void idEvent::Schedule( idClass *obj, const idTypeInfo *type, int time ) {
-	idEvent *event;
-
 	assert( initialized );
 	if ( !initialized ) {
 		return;
 	}
 
+	if ( queue != NULL ) {
+		queue->Remove( this );
+	}
+
 	object = obj;
 	typeinfo = type;
 
 	// wraps after 24 days...like I care. ;)
 	this->time = gameLocal.time + time;
+	sequence = eventSequence++;
 
 	eventNode.Remove();
+	objectNode.SetOwner( this );
+	objectNode.AddToEnd( obj->pendingEvents );
 
 #ifdef _D3XP
 	if ( obj->IsType( idEntity::Type ) && ( ( (idEntity*)(obj) )->timeGroup == TIME_GROUP2 ) ) {
-		event = FastEventQueue.Next();
-		while( ( event != NULL ) && ( this->time >= event->time ) ) {
-			event = event->eventNode.Next();
-		}
-
-		if ( event ) {
-			eventNode.InsertBefore( event->eventNode );
-		} else {
-			eventNode.AddToEnd( FastEventQueue );
-		}
-
+		FastEventQueue.Add( this );
 		return;
 	} else {
 		this->time = gameLocal.slow.time + time;
 	}
 #endif
 
-	event = EventQueue.Next();
-	while( ( event != NULL ) && ( this->time >= event->time ) ) {
-		event = event->eventNode.Next();
-	}
-
-	if ( event ) {
-		eventNode.InsertBefore( event->eventNode );
-	} else {
-		eventNode.AddToEnd( EventQueue );
-	}
+	EventQueue.Add( this );
 }
 
 /*
@@ -439,25 +655,15 @@ void idEvent::CancelEvents( const idClass *obj, const idEventDef *evdef ) {
 		return;
 	}
 
-	for( event = EventQueue.Next(); event != NULL; event = next ) {
-		next = event->eventNode.Next();
-		if ( event->object == obj ) {
-			if ( !evdef || ( evdef == event->eventdef ) ) {
-				event->Free();
-			}
-		}
-	}
-
-#ifdef _D3XP
-	for( event = FastEventQueue.Next(); event != NULL; event = next ) {
-		next = event->eventNode.Next();
-		if ( event->object == obj ) {
-			if ( !evdef || ( evdef == event->eventdef ) ) {
-				event->Free();
-			}
+	// only the events of this object have to be looked at
+	idLinkList<idEvent> &pending = const_cast<idClass *>( obj )->pendingEvents;
+	for( event = pending.Next(); event != NULL; event = next ) {
+		next = event->objectNode.Next();
+		assert( event->object == obj );
+		if ( !evdef || ( evdef == event->eventdef ) ) {
+			event->Free();
 		}
 	}
-#endif
 }
 
 /*
@@ -473,13 +679,19 @@ void idEvent::ClearEventList( void ) {
 	//
 	FreeEvents.Clear();
 	EventQueue.Clear();
+#ifdef _D3XP
+	FastEventQueue.Clear();
+#endif
 
 	//
 	// add the events to the free list
 	//
 	for( i = 0; i < MAX_EVENTS; i++ ) {
+		EventPool[ i ].queue = NULL;
+		EventPool[ i ].queueIndex = -1;
 		EventPool[ i ].Free();
 	}
+	eventSequence = 0;
 }
 
 /*
@@ -500,9 +712,11 @@ void idEvent::ServiceEvents( void ) {
 	byte		*data;
 	const char  *materialName;
 
+	PROFILE_SCOPE( "idEvent::ServiceEvents" );
+
 	num = 0;
-	while( !EventQueue.IsListEmpty() ) {
-		event = EventQueue.Next();
+	while( EventQueue.Num() > 0 ) {
+		event = EventQueue.First();
 		assert( event );
 
 		if ( event->time > gameLocal.time ) {
@@ -555,11 +769,13 @@ void idEvent::ServiceEvents( void ) {
 			}
 		}
 
-		// the event is removed from its list so that if then object
+		// the event is removed from its queue and object so that if then object
 		// is deleted, the event won't be freed twice
-		event->eventNode.Remove();
+		event->queue->Remove( event );
+		event->objectNode.Remove();
 		assert( event->object );
 		if ( !event->object->IsRemoved() ) {
+			idThinkProfileScope thinkScope( THINKPROFILE_EVENT, event->object );
 			event->object->ProcessEventArgPtr( ev, args );
 		} else {
 			gameLocal.Warning( "idEvent::ServiceEvents: Skipping event on removed object." );
@@ -597,9 +813,11 @@ void idEvent::ServiceFastEvents() {
 	byte		*data;
 	const char  *materialName;
 
+	PROFILE_SCOPE( "idEvent::ServiceFastEvents" );
+
 	num = 0;
-	while( !FastEventQueue.IsListEmpty() ) {
-		event = FastEventQueue.Next();
+	while( FastEventQueue.Num() > 0 ) {
+		event = FastEventQueue.First();
 		assert( event );
 
 		if ( event->time > gameLocal.fast.time ) {
@@ -652,11 +870,15 @@ void idEvent::ServiceFastEvents() {
 			}
 		}
 
-		// the event is removed from its list so that if then object
+		// the event is removed from its queue and object so that if then object
 		// is deleted, the event won't be freed twice
-		event->eventNode.Remove();
+		event->queue->Remove( event );
+		event->objectNode.Remove();
 		assert( event->object );
-		event->object->ProcessEventArgPtr( ev, args );
+		{
+			idThinkProfileScope thinkScope( THINKPROFILE_EVENT, event->object );
+			event->object->ProcessEventArgPtr( ev, args );
+		}
 
 		// return the event to the free list
 		event->Free();
@@ -739,11 +961,15 @@ void idEvent::Save( idSaveGame *savefile ) {
 	bool validTrace;
 	const char	*format;
 	idStr s;
+	idList<idEvent *> events;
+
+	// the events are written in the order they will be serviced, just like the old sorted lists
+	GetEventsByTime( EventQueue, events );
 
-	savefile->WriteInt( EventQueue.Num() );
+	savefile->WriteInt( events.Num() );
 
-	event = EventQueue.Next();
-	while( event != NULL ) {
+	for ( int e = 0; e < events.Num(); e++ ) {
+		event = events[e];
 		assert(event->initialized);
 
 		savefile->WriteInt( event->time );
@@ -800,7 +1026,6 @@ void idEvent::Save( idSaveGame *savefile ) {
 			savefile->WriteCheckSizeMarker();
 		}
 		assert( size == event->eventdef->GetArgSize() );
-		event = event->eventNode.Next();
 
 		savefile->WriteCheckSizeMarker();
 	}
@@ -809,10 +1034,12 @@ void idEvent::Save( idSaveGame *savefile ) {
 
 #ifdef _D3XP
 	// Save the Fast EventQueue
-	savefile->WriteInt( FastEventQueue.Num() );
+	GetEventsByTime( FastEventQueue, events );
 
-	event = FastEventQueue.Next();
-	while( event != NULL ) {
+	savefile->WriteInt( events.Num() );
+
+	for ( int e = 0; e < events.Num(); e++ ) {
+		event = events[e];
 		savefile->WriteInt( event->time );
 		savefile->WriteString( event->eventdef->GetName() );
 		savefile->WriteString( event->typeinfo->classname );
@@ -820,8 +1047,6 @@ void idEvent::Save( idSaveGame *savefile ) {
 		savefile->WriteInt( event->eventdef->GetArgSize() );
 		savefile->Write( event->data, event->eventdef->GetArgSize() );
 
-		event = event->eventNode.Next();
-
 		savefile->WriteCheckSizeMarker();
 	}
 
@@ -852,7 +1077,6 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		event = FreeEvents.Next();
 		event->eventNode.Remove();
-		event->eventNode.AddToEnd( EventQueue );
 
 		savefile->ReadInt( event->time );
 
@@ -872,6 +1096,11 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		savefile->ReadObject( event->object );
 
+		// the saved events are in time order so new sequence numbers keep their order,
+		// the objects are linked in RestoreObjectLinks once all object pointers are fixed up
+		event->sequence = eventSequence++;
+		EventQueue.Add( event );
+
 		// read the args
 		savefile->ReadInt( argsize );
 		if ( argsize != event->eventdef->GetArgSize() ) {
@@ -954,7 +1183,6 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		event = FreeEvents.Next();
 		event->eventNode.Remove();
-		event->eventNode.AddToEnd( FastEventQueue );
 
 		savefile->ReadInt( event->time );
 
@@ -974,6 +1202,11 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		savefile->ReadObject( event->object );
 
+		// the saved events are in time order so new sequence numbers keep their order,
+		// the objects are linked in RestoreObjectLinks once all object pointers are fixed up
+		event->sequence = eventSequence++;
+		FastEventQueue.Add( event );
+
 		// read the args
 		savefile->ReadInt( argsize );
 		if ( argsize != event->eventdef->GetArgSize() ) {
@@ -993,6 +1226,125 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 #endif
 }
 
+/***********************************************************************
+
+  idEventStressTarget
+
+  object the events of testEventQueue are posted to, the event does nothing.
+  It's registered in every build so all builds agree on the type numbers.
+
+***********************************************************************/
+
+const idEventDef EV_StressTest( "<stressTest>", "d" );
+
+class idEventStressTarget : public idClass {
+public:
+	CLASS_PROTOTYPE( idEventStressTarget );
+
+private:
+	void					Event_StressTest( int value ) {}
+};
+
+CLASS_DECLARATION( idClass, idEventStressTarget )
+	EVENT( EV_StressTest,	idEventStressTarget::Event_StressTest )
+END_CLASS
+
+/*
+================
+idEvent::StressTest_f
+
+posts events with random delays to a set of objects in waves that fill the free events
+and cancels them again, half through CancelEvents and half by deleting the objects.
+The events already queued by the game stay where they are and no test event is left
+when it's done.
+================
+*/
+void idEvent::StressTest_f( const idCmdArgs &args ) {
+	const int numTargets = 256;
+
+	if ( !initialized || gameLocal.GameState() != GAMESTATE_ACTIVE || gameLocal.isClient ) {
+		gameLocal.Printf( "testEventQueue needs a running map on the server\n" );
+		return;
+	}
+
+	int numEvents = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 1 ) : 100000;
+
+	// leave some events for the game
+	int waveSize = FreeEvents.Num() - 64;
+	if ( waveSize <= 0 ) {
+		gameLocal.Printf( "no free events\n" );
+		return;
+	}
+
+	idList<idClass *> targets;
+	idRandom random( 0 );
+	uint64 postTicks = 0;
+	uint64 cancelTicks = 0;
+	int posted = 0;
+	int queued = EventQueue.Num();
+	int numFree = FreeEvents.Num();
+
+	while ( posted < numEvents ) {
+		int num = Min( waveSize, numEvents - posted );
+
+		for ( int i = 0; i < numTargets; i++ ) {
+			targets.Append( new idEventStressTarget );
+		}
+
+		uint64 start = Sys_GetPerformanceCounter();
+		for ( int i = 0; i < num; i++ ) {
+			targets[random.RandomInt( numTargets )]->PostEventMS( &EV_StressTest, 1 + random.RandomInt( 10000 ), posted + i );
+		}
+		postTicks += Sys_GetPerformanceCounter() - start;
+
+		start = Sys_GetPerformanceCounter();
+		for ( int i = 0; i < numTargets; i += 2 ) {
+			targets[i]->CancelEvents( &EV_StressTest );
+		}
+		targets.DeleteContents( true );
+		cancelTicks += Sys_GetPerformanceCounter() - start;
+
+		posted += num;
+	}
+
+	if ( EventQueue.Num() != queued || FreeEvents.Num() != numFree ) {
+		gameLocal.Warning( "testEventQueue left %d events queued and %d free, expected %d and %d", EventQueue.Num(), FreeEvents.Num(), queued, numFree );
+	}
+
+	double postMS = Sys_GetPerformanceTimeMS( postTicks );
+	double cancelMS = Sys_GetPerformanceTimeMS( cancelTicks );
+	gameLocal.Printf( "%d events in waves of %d on %d objects, %d events already queued\n", posted, waveSize, numTargets, queued );
+	gameLocal.Printf( "post:   %8.2f ms, %.3f us per event\n", postMS, 1000.0 * postMS / posted );
+	gameLocal.Printf( "cancel: %8.2f ms, %.3f us per event\n", cancelMS, 1000.0 * cancelMS / posted );
+}
+
+/*
+================
+idEvent::RestoreObjectLinks
+
+links the restored events to their objects, called after the object pointers were fixed up
+================
+*/
+void idEvent::RestoreObjectLinks( void ) {
+	for ( int i = 0; i < EventQueue.Num(); i++ ) {
+		idEvent *event = EventQueue[i];
+		if ( event->object != NULL && !event->objectNode.InList() ) {
+			event->objectNode.SetOwner( event );
+			event->objectNode.AddToEnd( event->object->pendingEvents );
+		}
+	}
+
+#ifdef _D3XP
+	for ( int i = 0; i < FastEventQueue.Num(); i++ ) {
+		idEvent *event = FastEventQueue[i];
+		if ( event->object != NULL && !event->objectNode.InList() ) {
+			event->objectNode.SetOwner( event );
+			event->objectNode.AddToEnd( event->object->pendingEvents );
+		}
+	}
+#endif
+}
+
 /*
  ================
  idEvent::ReadTrace
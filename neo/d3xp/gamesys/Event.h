@@ -88,6 +88,8 @@ public:
 
 class idSaveGame;
 class idRestoreGame;
+class idCmdArgs;
+class idEventHeap;
 
 class idEvent {
 private:
@@ -97,10 +99,17 @@ private:
 	idClass						*object;
 	const idTypeInfo			*typeinfo;
 
-	idLinkList<idEvent>			eventNode;
+	idLinkList<idEvent>			eventNode;		// free list
+	idLinkList<idEvent>			objectNode;		// pending events of the object
+
+	idEventHeap					*queue;			// queue the event is scheduled in, NULL if not scheduled
+	int							queueIndex;		// position in the heap of the queue
+	unsigned int				sequence;		// keeps events with the same time in the order they were posted
 
 	static idDynamicBlockAlloc<byte, 16 * 1024, 256> eventDataAllocator;
 
+	friend class idEventHeap;
+
 
 public:
 	static bool					initialized;
@@ -108,6 +117,8 @@ public:
 								~idEvent();
 
 	static idEvent				*Alloc( const idEventDef *evdef, int numargs, va_list args );
+	static idEvent				*AllocFormatted( const idEventDef *evdef, const byte *formattedArgs );
+	static void					FormatArgs( const idEventDef *evdef, int numargs, va_list args, byte *data );
 	static void					CopyArgs( const idEventDef *evdef, int numargs, va_list args, intptr_t data[ D_EVENT_MAXARGS ]  );
 
 	void						Free( void );
@@ -128,9 +139,12 @@ public:
 	// save games
 	static void					Save( idSaveGame *savefile );					// archives object for save game file
 	static void					Restore( idRestoreGame *savefile );				// unarchives object from save game file
+	static void					RestoreObjectLinks( void );						// links the restored events to their objects once the object pointers are fixed up
 	static void					SaveTrace( idSaveGame *savefile, const trace_t &trace );
 	static void					RestoreTrace( idRestoreGame *savefile, trace_t &trace );
 
+	static void					StressTest_f( const idCmdArgs &args );
+
 };
 
 /*
@@ -0,0 +1,745 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "sys/platform.h"
+#include "idlib/hashing/CRC32.h"
+#include "framework/FileSystem.h"
+#include "framework/Profiler.h"
+
+#include "gamesys/SysCvar.h"
+#include "Entity.h"
+#include "Game_local.h"
+
+#include "gamesys/ParallelThink.h"
+
+#define THINK_JOB_MIN_ENTITIES		4		// never split the batch into jobs smaller than this
+#define THINK_JOBS_PER_THREAD		4		// jobs per thread so a slow entity doesn't stall the others
+#define THINK_CHECK_DIR				"thinkcheck"
+
+typedef enum {
+	THINKCMD_EVENT,
+	THINKCMD_CANCELEVENTS,
+	THINKCMD_PRESENT,
+	THINKCMD_ACTIVATE,
+	THINKCMD_DEACTIVATE,
+	THINKCMD_DAMAGE,
+	THINKCMD_SPAWN
+} thinkCommandType_t;
+
+typedef struct thinkCommand_s {
+	thinkCommandType_t		type;
+	idClass *				object;				// event receiver, only used if it is not an entity
+	idEntityPtr<idEntity>	entity;				// entity the command is for, NULL if it was removed meanwhile
+	bool					isEntity;			// the receiver is an entity and must be looked up through entity
+	idEntityPtr<idEntity>	inflictor;
+	idEntityPtr<idEntity>	attacker;
+	const idEventDef *		eventDef;
+	int						value;				// event time, think flags or damage location
+	int						materialType;
+	float					scale;
+	idVec3					vec;				// damage direction or spawn origin
+	idMat3					axis;
+	int						dataOffset;			// formatted event args or a string in the data buffer
+	int						dataSize;
+} thinkCommand_t;
+
+/*
+===============================================================================
+
+	idThinkCommandBuffer
+
+	Side effects recorded by one thread during the parallel think phase.
+
+===============================================================================
+*/
+
+class idThinkCommandBuffer {
+public:
+							idThinkCommandBuffer( void );
+
+	void					Clear( void );
+	thinkCommand_t &		Alloc( thinkCommandType_t type );
+	byte *					AllocData( thinkCommand_t &cmd, int size );
+	void					AllocString( thinkCommand_t &cmd, const char *string );
+	const byte *			GetData( const thinkCommand_t &cmd ) const { return data.Ptr() + cmd.dataOffset; }
+
+	idList<thinkCommand_t>	commands;
+	idList<byte>			data;
+};
+
+/*
+================
+idThinkCommandBuffer::idThinkCommandBuffer
+================
+*/
+idThinkCommandBuffer::idThinkCommandBuffer( void ) {
+	commands.SetGranularity( 256 );
+	data.SetGranularity( 4096 );
+}
+
+/*
+================
+idThinkCommandBuffer::Clear
+
+keeps the memory around for the next frame
+================
+*/
+void idThinkCommandBuffer::Clear( void ) {
+	commands.SetNum( 0, false );
+	data.SetNum( 0, false );
+}
+
+/*
+================
+idThinkCommandBuffer::Alloc
+================
+*/
+thinkCommand_t &idThinkCommandBuffer::Alloc( thinkCommandType_t type ) {
+	thinkCommand_t &cmd = commands.Alloc();
+	cmd.type = type;
+	cmd.object = NULL;
+	cmd.entity = NULL;
+	cmd.isEntity = false;
+	cmd.inflictor = NULL;
+	cmd.attacker = NULL;
+	cmd.eventDef = NULL;
+	cmd.value = 0;
+	cmd.materialType = 0;
+	cmd.scale = 0.0f;
+	cmd.vec.Zero();
+	cmd.axis.Identity();
+	cmd.dataOffset = 0;
+	cmd.dataSize = 0;
+	return cmd;
+}
+
+/*
+================
+idThinkCommandBuffer::AllocData
+
+returns cleared memory, the pointer is only valid until the next allocation
+================
+*/
+byte *idThinkCommandBuffer::AllocData( thinkCommand_t &cmd, int size ) {
+	int offset;
+
+	// keep the event data aligned
+	offset = ( data.Num() + 15 ) & ~15;
+	if ( offset + size > data.NumAllocated() ) {
+		data.Resize( Max( data.NumAllocated() * 2, offset + size + data.GetGranularity() ) );
+	}
+	data.SetNum( offset + size, false );
+	memset( data.Ptr() + offset, 0, size );
+
+	cmd.dataOffset = offset;
+	cmd.dataSize = size;
+	return data.Ptr() + offset;
+}
+
+/*
+================
+idThinkCommandBuffer::AllocString
+================
+*/
+void idThinkCommandBuffer::AllocString( thinkCommand_t &cmd, const char *string ) {
+	int length = idStr::Length( string ) + 1;
+	memcpy( AllocData( cmd, length ), string, length );
+}
+
+
+/*
+===============================================================================
+
+	idParallelThink
+
+===============================================================================
+*/
+
+// buffer of the calling thread while it thinks an entity in the parallel phase
+static thread_local idThinkCommandBuffer *currentBuffer = NULL;
+
+// seeded for every entity so the numbers don't depend on the thread it thinks on
+static thread_local idRandom threadRandom;
+
+/*
+================
+idParallelThink::idParallelThink
+================
+*/
+idParallelThink::idParallelThink( void ) {
+	memset( buffers, 0, sizeof( buffers ) );
+	jobList = NULL;
+	checkFile = NULL;
+	checkFrames = 0;
+}
+
+/*
+================
+idParallelThink::Init
+================
+*/
+void idParallelThink::Init( void ) {
+	int i;
+
+	for ( i = 0; i < MAX_JOB_THREADS + 1; i++ ) {
+		buffers[i] = new idThinkCommandBuffer;
+	}
+	jobList = jobSystem->AllocJobList( "parallelThink" );
+	records.SetGranularity( 256 );
+	thought.SetNum( ( MAX_GENTITIES + 31 ) >> 5 );
+	memset( thought.Ptr(), 0, thought.MemoryUsed() );
+}
+
+/*
+================
+idParallelThink::Shutdown
+================
+*/
+void idParallelThink::Shutdown( void ) {
+	int i;
+
+	if ( checkFile ) {
+		fileSystem->CloseFile( checkFile );
+		checkFile = NULL;
+	}
+	if ( jobList ) {
+		jobSystem->FreeJobList( jobList );
+		jobList = NULL;
+	}
+	for ( i = 0; i < MAX_JOB_THREADS + 1; i++ ) {
+		delete buffers[i];
+		buffers[i] = NULL;
+	}
+	records.Clear();
+	jobs.Clear();
+	thought.Clear();
+}
+
+/*
+================
+idParallelThink::IsDeferring
+================
+*/
+bool idParallelThink::IsDeferring( void ) {
+	return ( currentBuffer != NULL );
+}
+
+/*
+================
+idParallelThink::Random
+================
+*/
+idRandom &idParallelThink::Random( void ) {
+	if ( currentBuffer != NULL ) {
+		return threadRandom;
+	}
+	return gameLocal.random;
+}
+
+/*
+================
+idParallelThink::HasThought
+================
+*/
+bool idParallelThink::HasThought( const idEntity *ent ) const {
+	return ( thought[ent->entityNumber >> 5] & ( 1u << ( ent->entityNumber & 31 ) ) ) != 0;
+}
+
+/*
+================
+idParallelThink::ThinkJob
+================
+*/
+void idParallelThink::ThinkJob( void *data ) {
+	thinkJob_t *job = (thinkJob_t *)data;
+	idParallelThink *owner = job->owner;
+	int bufferNum, i;
+
+	// the thread waiting on the list helps out and gets the first buffer
+	bufferNum = jobSystem->GetThreadIndex() + 1;
+	currentBuffer = owner->buffers[bufferNum];
+
+	for ( i = job->first; i < job->first + job->num; i++ ) {
+		thinkRecord_t &record = owner->records[i];
+		record.buffer = bufferNum;
+		record.firstCommand = currentBuffer->commands.Num();
+		threadRandom.SetSeed( gameLocal.framenum * MAX_GENTITIES + record.ent->entityNumber );
+		{
+			PROFILE_SCOPE( record.ent->GetClassname() );
+			if ( idThinkProfiler::IsActive() ) {
+				uint64 start = Sys_GetPerformanceCounter();
+				record.ent->Think();
+				record.thinkTicks = Sys_GetPerformanceCounter() - start;
+			} else {
+				record.ent->Think();
+			}
+		}
+		record.numCommands = currentBuffer->commands.Num() - record.firstCommand;
+	}
+
+	currentBuffer = NULL;
+}
+
+/*
+================
+idParallelThink::Run
+================
+*/
+int idParallelThink::Run( idEntity *firstActive ) {
+	idEntity *ent;
+	int i, numThreads, numPerJob;
+
+	records.SetNum( 0, false );
+	memset( thought.Ptr(), 0, thought.MemoryUsed() );
+
+	for ( ent = firstActive; ent != NULL; ent = ent->activeNode.Next() ) {
+#ifdef _D3XP
+		if ( ent->timeGroup != TIME_GROUP1 ) {
+			continue;
+		}
+#endif
+		if ( ent->IsFrozen() || !ent->IsThinkParallelSafe() ) {
+			continue;
+		}
+		thinkRecord_t &record = records.Alloc();
+		record.ent = ent;
+		record.buffer = 0;
+		record.firstCommand = 0;
+		record.numCommands = 0;
+		record.commandCRC = 0;
+		record.thinkTicks = 0;
+		thought[ent->entityNumber >> 5] |= 1u << ( ent->entityNumber & 31 );
+	}
+
+	if ( g_thinkParallelCheck.GetInteger() > 0 && checkFile == NULL ) {
+		StartCheck();
+	}
+
+	if ( records.Num() == 0 ) {
+		UpdateCheck();
+		return 0;
+	}
+
+	for ( i = 0; i < MAX_JOB_THREADS + 1; i++ ) {
+		buffers[i]->Clear();
+	}
+
+	// split the batch into a few jobs per thread
+	numThreads = jobSystem->GetNumWorkers() + 1;
+	numPerJob = Max( THINK_JOB_MIN_ENTITIES, records.Num() / ( numThreads * THINK_JOBS_PER_THREAD ) );
+	jobs.SetNum( 0, false );
+	for ( i = 0; i < records.Num(); i += numPerJob ) {
+		thinkJob_t &job = jobs.Alloc();
+		job.owner = this;
+		job.first = i;
+		job.num = Min( numPerJob, records.Num() - i );
+	}
+
+	if ( g_thinkParallel.GetInteger() == 2 ) {
+		// same deferred path executed in order on the game thread, reference for g_thinkParallelCheck
+		for ( i = 0; i < jobs.Num(); i++ ) {
+			ThinkJob( &jobs[i] );
+		}
+	} else {
+		jobList->Clear();
+		for ( i = 0; i < jobs.Num(); i++ ) {
+			jobList->AddJob( ThinkJob, &jobs[i], "think" );
+		}
+		jobList->Submit();
+		jobList->Wait();
+	}
+
+	if ( idThinkProfiler::IsActive() ) {
+		for ( i = 0; i < records.Num(); i++ ) {
+			gameLocal.thinkProfiler.Add( THINKPROFILE_THINK, records[i].ent, records[i].thinkTicks, 0 );
+		}
+	}
+
+	Merge();
+	UpdateCheck();
+
+	return records.Num();
+}
+
+/*
+================
+idParallelThink::Merge
+
+replays the recorded commands in the order of the active entity list
+================
+*/
+void idParallelThink::Merge( void ) {
+	int i, j;
+	idEvent *event;
+	idEntity *ent;
+	idClass *obj;
+	bool check = ( checkFile != NULL );
+
+	for ( i = 0; i < records.Num(); i++ ) {
+		thinkRecord_t &record = records[i];
+		const idThinkCommandBuffer *buffer = buffers[record.buffer];
+
+		if ( check ) {
+			CRC32_InitChecksum( record.commandCRC );
+		}
+
+		for ( j = record.firstCommand; j < record.firstCommand + record.numCommands; j++ ) {
+			const thinkCommand_t &cmd = buffer->commands[j];
+
+			if ( check ) {
+				CRC32_UpdateChecksum( record.commandCRC, &cmd.type, sizeof( cmd.type ) );
+				CRC32_UpdateChecksum( record.commandCRC, &cmd.value, sizeof( cmd.value ) );
+				if ( cmd.eventDef ) {
+					CRC32_UpdateChecksum( record.commandCRC, cmd.eventDef->GetName(), idStr::Length( cmd.eventDef->GetName() ) );
+				}
+				if ( cmd.dataSize ) {
+					CRC32_UpdateChecksum( record.commandCRC, buffer->GetData( cmd ), cmd.dataSize );
+				}
+			}
+
+			switch( cmd.type ) {
+				case THINKCMD_EVENT:
+					// the receiver may have been removed by a command replayed before this one
+					obj = cmd.isEntity ? cmd.entity.GetEntity() : cmd.object;
+					if ( obj ) {
+						event = idEvent::AllocFormatted( cmd.eventDef, cmd.dataSize ? buffer->GetData( cmd ) : NULL );
+						event->Schedule( obj, obj->GetType(), cmd.value );
+					}
+					break;
+				case THINKCMD_CANCELEVENTS:
+					obj = cmd.isEntity ? cmd.entity.GetEntity() : cmd.object;
+					if ( obj ) {
+						idEvent::CancelEvents( obj, cmd.eventDef );
+					}
+					break;
+				case THINKCMD_PRESENT:
+					ent = cmd.entity.GetEntity();
+					if ( ent ) {
+						// the whole virtual Present was deferred, see idEntity::PresentDeferred
+						ent->Present();
+					}
+					break;
+				case THINKCMD_ACTIVATE:
+					ent = cmd.entity.GetEntity();
+					if ( ent ) {
+						ent->BecomeActive( cmd.value );
+					}
+					break;
+				case THINKCMD_DEACTIVATE:
+					ent = cmd.entity.GetEntity();
+					if ( ent ) {
+						ent->BecomeInactive( cmd.value );
+					}
+					break;
+				case THINKCMD_DAMAGE:
+					ent = cmd.entity.GetEntity();
+					if ( ent ) {
+						ent->Damage( cmd.inflictor.GetEntity(), cmd.attacker.GetEntity(), cmd.vec, (const char *)buffer->GetData( cmd ), cmd.scale, cmd.value, cmd.materialType );
+					}
+					break;
+				case THINKCMD_SPAWN: {
+					idDict args;
+					args.Set( "classname", (const char *)buffer->GetData( cmd ) );
+					args.SetVector( "origin", cmd.vec );
+					args.SetMatrix( "rotation", cmd.axis );
+					gameLocal.SpawnEntityDef( args );
+					break;
+				}
+			}
+		}
+
+		if ( check ) {
+			CRC32_FinishChecksum( record.commandCRC );
+		}
+	}
+}
+
+/*
+================
+idParallelThink::DeferEvent
+================
+*/
+void idParallelThink::DeferEvent( idClass *obj, const idEventDef *ev, int time, int numargs, va_list args ) {
+	assert( currentBuffer );
+
+	if ( numargs != ev->GetNumArgs() ) {
+		gameLocal.Error( "idParallelThink::DeferEvent : Wrong number of args for '%s' event.", ev->GetName() );
+	}
+
+	thinkCommand_t &cmd = currentBuffer->Alloc( THINKCMD_EVENT );
+	cmd.object = obj;
+	if ( obj->IsType( idEntity::Type ) ) {
+		cmd.entity = static_cast<idEntity *>( obj );
+		cmd.isEntity = true;
+	}
+	cmd.eventDef = ev;
+	cmd.value = time;
+	if ( ev->GetArgSize() ) {
+		idEvent::FormatArgs( ev, numargs, args, currentBuffer->AllocData( cmd, ev->GetArgSize() ) );
+	}
+}
+
+/*
+================
+idParallelThink::DeferCancelEvents
+================
+*/
+void idParallelThink::DeferCancelEvents( const idClass *obj, const idEventDef *ev ) {
+	assert( currentBuffer );
+
+	thinkCommand_t &cmd = currentBuffer->Alloc( THINKCMD_CANCELEVENTS );
+	cmd.object = const_cast<idClass *>( obj );
+	if ( obj->IsType( idEntity::Type ) ) {
+		cmd.entity = static_cast<idEntity *>( cmd.object );
+		cmd.isEntity = true;
+	}
+	cmd.eventDef = ev;
+}
+
+/*
+================
+idParallelThink::DeferPresent
+================
+*/
+void idParallelThink::DeferPresent( idEntity *ent ) {
+	assert( currentBuffer );
+
+	thinkCommand_t &cmd = currentBuffer->Alloc( THINKCMD_PRESENT );
+	cmd.entity = ent;
+}
+
+/*
+================
+idParallelThink::DeferActivate
+================
+*/
+void idParallelThink::DeferActivate( idEntity *ent, int flags, bool active ) {
+	assert( currentBuffer );
+
+	thinkCommand_t &cmd = currentBuffer->Alloc( active ? THINKCMD_ACTIVATE : THINKCMD_DEACTIVATE );
+	cmd.entity = ent;
+	cmd.value = flags;
+}
+
+/*
+================
+idParallelThink::Damage
+================
+*/
+void idParallelThink::Damage( idEntity *target, idEntity *inflictor, idEntity *attacker, const idVec3 &dir, const char *damageDefName, const float damageScale, const int location, const int materialType ) {
+	if ( !currentBuffer ) {
+		target->Damage( inflictor, attacker, dir, damageDefName, damageScale, location, materialType );
+		return;
+	}
+
+	thinkCommand_t &cmd = currentBuffer->Alloc( THINKCMD_DAMAGE );
+	cmd.entity = target;
+	cmd.inflictor = inflictor;
+	cmd.attacker = attacker;
+	cmd.vec = dir;
+	cmd.scale = damageScale;
+	cmd.value = location;
+	cmd.materialType = materialType;
+	currentBuffer->AllocString( cmd, damageDefName );
+}
+
+/*
+================
+idParallelThink::Spawn
+================
+*/
+void idParallelThink::Spawn( const char *defName, const idVec3 &origin, const idMat3 &axis ) {
+	if ( !currentBuffer ) {
+		idDict args;
+		args.Set( "classname", defName );
+		args.SetVector( "origin", origin );
+		args.SetMatrix( "rotation", axis );
+		gameLocal.SpawnEntityDef( args );
+		return;
+	}
+
+	thinkCommand_t &cmd = currentBuffer->Alloc( THINKCMD_SPAWN );
+	cmd.vec = origin;
+	cmd.axis = axis;
+	currentBuffer->AllocString( cmd, defName );
+}
+
+
+/*
+===============================================================================
+
+	Determinism check
+
+	g_thinkParallelCheck <frames> writes a checksum of every parallel thinking
+	entity for the next frames to thinkcheck/<map>_serial.log when g_thinkParallel
+	is 2 or thinkcheck/<map>_parallel.log when it is 1. Running the same session
+	once in each mode and using thinkParallelCompare shows the first difference.
+
+===============================================================================
+*/
+
+/*
+================
+CheckFileName
+================
+*/
+static void CheckFileName( const char *mapName, bool parallel, idStr &fileName ) {
+	sprintf( fileName, "%s/%s_%s.log", THINK_CHECK_DIR, mapName, parallel ? "parallel" : "serial" );
+}
+
+/*
+================
+idParallelThink::StartCheck
+================
+*/
+void idParallelThink::StartCheck( void ) {
+	idStr fileName;
+
+	CheckFileName( gameLocal.GetMapNameStripped(), g_thinkParallel.GetInteger() == 1, fileName );
+	checkFile = fileSystem->OpenFileWrite( fileName );
+	if ( !checkFile ) {
+		gameLocal.Warning( "idParallelThink::StartCheck: couldn't open %s", fileName.c_str() );
+		g_thinkParallelCheck.SetInteger( 0 );
+		return;
+	}
+	checkFrames = 0;
+	gameLocal.Printf( "recording %d frames of think checksums to %s\n", g_thinkParallelCheck.GetInteger(), fileName.c_str() );
+}
+
+/*
+================
+idParallelThink::UpdateCheck
+================
+*/
+void idParallelThink::UpdateCheck( void ) {
+	unsigned int crc, frameCRC;
+	idEntity *ent;
+	int i;
+
+	if ( !checkFile ) {
+		return;
+	}
+
+	CRC32_InitChecksum( frameCRC );
+	for ( i = 0; i < records.Num(); i++ ) {
+		ent = records[i].ent;
+		CRC32_InitChecksum( crc );
+		CRC32_UpdateChecksum( crc, &ent->thinkFlags, sizeof( ent->thinkFlags ) );
+		CRC32_UpdateChecksum( crc, &ent->health, sizeof( ent->health ) );
+		CRC32_UpdateChecksum( crc, ent->GetPhysics()->GetOrigin().ToFloatPtr(), sizeof( idVec3 ) );
+		CRC32_UpdateChecksum( crc, ent->GetPhysics()->GetAxis().ToFloatPtr(), sizeof( idMat3 ) );
+		CRC32_UpdateChecksum( crc, ent->GetRenderEntity()->origin.ToFloatPtr(), sizeof( idVec3 ) );
+		CRC32_UpdateChecksum( crc, &records[i].commandCRC, sizeof( records[i].commandCRC ) );
+		CRC32_FinishChecksum( crc );
+		records[i].commandCRC = crc;
+		CRC32_UpdateChecksum( frameCRC, &crc, sizeof( crc ) );
+	}
+	CRC32_FinishChecksum( frameCRC );
+
+	checkFile->Printf( "frame %d time %d entities %d crc %08x\n", checkFrames, gameLocal.time, records.Num(), frameCRC );
+	for ( i = 0; i < records.Num(); i++ ) {
+		checkFile->Printf( "\t%d %s %08x %d\n", records[i].ent->entityNumber, records[i].ent->GetName(), records[i].commandCRC, records[i].numCommands );
+	}
+
+	checkFrames++;
+	if ( checkFrames >= g_thinkParallelCheck.GetInteger() ) {
+		gameLocal.Printf( "recorded %d frames of think checksums to %s\n", checkFrames, checkFile->GetName() );
+		fileSystem->CloseFile( checkFile );
+		checkFile = NULL;
+		g_thinkParallelCheck.SetInteger( 0 );
+	}
+}
+
+/*
+================
+ReadCheckLine
+================
+*/
+static const char *ReadCheckLine( const char *text, idStr &line ) {
+	const char *end;
+
+	end = strchr( text, '\n' );
+	if ( !end ) {
+		end = text + strlen( text );
+	}
+	line.Clear();
+	line.Append( text, end - text );
+	return ( *end == '\n' ) ? end + 1 : end;
+}
+
+/*
+================
+idParallelThink::Compare_f
+================
+*/
+void idParallelThink::Compare_f( const idCmdArgs &args ) {
+	idStr serialName, parallelName, mapName;
+	idStr serialLine, parallelLine, frameLine;
+	char *serialText, *parallelText;
+	const char *s, *p;
+	int lineNum;
+
+	if ( args.Argc() > 1 ) {
+		mapName = args.Argv( 1 );
+	} else {
+		mapName = gameLocal.GetMapNameStripped();
+	}
+	CheckFileName( mapName, false, serialName );
+	CheckFileName( mapName, true, parallelName );
+
+	if ( fileSystem->ReadFile( serialName, (void **)&serialText, NULL ) < 0 ) {
+		gameLocal.Printf( "couldn't read %s, record it with g_thinkParallel 2\n", serialName.c_str() );
+		return;
+	}
+	if ( fileSystem->ReadFile( parallelName, (void **)&parallelText, NULL ) < 0 ) {
+		gameLocal.Printf( "couldn't read %s, record it with g_thinkParallel 1\n", parallelName.c_str() );
+		fileSystem->FreeFile( serialText );
+		return;
+	}
+
+	s = serialText;
+	p = parallelText;
+	for ( lineNum = 1; *s != '\0' || *p != '\0'; lineNum++ ) {
+		s = ReadCheckLine( s, serialLine );
+		p = ReadCheckLine( p, parallelLine );
+		if ( serialLine.Cmpn( "frame", 5 ) == 0 ) {
+			frameLine = serialLine;
+		}
+		if ( serialLine != parallelLine ) {
+			gameLocal.Printf( "think results differ at line %d\n  in %s\n", lineNum, frameLine.c_str() );
+			gameLocal.Printf( "  serial:   %s\n  parallel: %s\n", serialLine.c_str(), parallelLine.c_str() );
+			fileSystem->FreeFile( serialText );
+			fileSystem->FreeFile( parallelText );
+			return;
+		}
+	}
+	gameLocal.Printf( "serial and parallel think results are identical (%d lines)\n", lineNum - 1 );
+
+	fileSystem->FreeFile( serialText );
+	fileSystem->FreeFile( parallelText );
+}
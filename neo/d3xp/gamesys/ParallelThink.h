@@ -0,0 +1,138 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __SYS_PARALLELTHINK_H__
+#define __SYS_PARALLELTHINK_H__
+
+#include "idlib/containers/List.h"
+#include "idlib/math/Vector.h"
+#include "idlib/math/Matrix.h"
+#include "idlib/math/Random.h"
+#include "framework/BuildDefines.h"
+
+/*
+===============================================================================
+
+	Parallel think phase.
+
+	Entities that return true from idEntity::IsThinkParallelSafe() think on the
+	job workers before all other entities. While such an entity thinks it may only
+	change its own state. Anything that touches shared game state is recorded
+	into a command buffer of the executing thread instead:
+
+		- events posted with PostEvent* and canceled with CancelEvents
+		- Present() and BecomeActive() / BecomeInactive()
+		- damage and spawns issued through idParallelThink::Damage / Spawn
+
+	Spawns only take an entityDef name because idDicts share global string pools
+	and must not be built on a worker.
+
+	The whole virtual Present is deferred, so every class that overrides it has
+	to start with idEntity::PresentDeferred. gameLocal.random is not guarded,
+	entities that think in parallel have to use idParallelThink::Random, which
+	is seeded per entity and frame. Events posted to objects that are not
+	entities are replayed to the raw pointer, so such objects must not be
+	deleted by the commands of another entity.
+
+	After all jobs are done the buffers are replayed on the game thread in the
+	order of the active entity list, so the result does not depend on the number
+	of workers or on how the jobs were scheduled.
+
+===============================================================================
+*/
+
+class idEntity;
+class idClass;
+class idEventDef;
+class idFile;
+class idCmdArgs;
+class idJobList;
+class idThinkCommandBuffer;
+
+class idParallelThink {
+public:
+							idParallelThink( void );
+
+	void					Init( void );
+	void					Shutdown( void );
+
+	// thinks all parallel safe entities of the active list, time group 2 entities are left to RunTimeGroup2
+	// returns the number of entities that thought, they have to be skipped by the serial think loop
+	int						Run( idEntity *firstActive );
+	// true if the entity already thought in the last Run()
+	bool					HasThought( const idEntity *ent ) const;
+
+	// true when called from an entity thinking in the parallel phase
+	static bool				IsDeferring( void );
+	// random numbers that are safe to use while thinking in the parallel phase, gameLocal.random outside of it
+	static idRandom &		Random( void );
+
+	// deferred versions of the calls that touch shared state, only valid while IsDeferring()
+	static void				DeferEvent( idClass *obj, const idEventDef *ev, int time, int numargs, va_list args );
+	static void				DeferCancelEvents( const idClass *obj, const idEventDef *ev );
+	static void				DeferPresent( idEntity *ent );
+	static void				DeferActivate( idEntity *ent, int flags, bool active );
+
+	// execute right away outside of the parallel phase, deferred inside of it
+	static void				Damage( idEntity *target, idEntity *inflictor, idEntity *attacker, const idVec3 &dir, const char *damageDefName, const float damageScale, const int location, const int materialType = 0 );
+	static void				Spawn( const char *defName, const idVec3 &origin, const idMat3 &axis );
+
+	static void				Compare_f( const idCmdArgs &args );
+
+private:
+	typedef struct thinkRecord_s {
+		idEntity *			ent;
+		int					buffer;				// buffer the commands were recorded into
+		int					firstCommand;
+		int					numCommands;
+		unsigned int		commandCRC;			// checksum of the recorded commands for g_thinkParallelCheck
+		uint64				thinkTicks;			// think time for g_thinkProfile
+	} thinkRecord_t;
+
+	typedef struct thinkJob_s {
+		idParallelThink *	owner;
+		int					first;
+		int					num;
+	} thinkJob_t;
+
+	idList<thinkRecord_t>	records;
+	idList<thinkJob_t>		jobs;
+	idThinkCommandBuffer *	buffers[MAX_JOB_THREADS + 1];
+	idJobList *				jobList;
+	idList<unsigned int>	thought;			// one bit per entity number
+
+	idFile *				checkFile;
+	int						checkFrames;
+
+	static void				ThinkJob( void *data );
+	void					Merge( void );
+	void					StartCheck( void );
+	void					UpdateCheck( void );
+};
+
+#endif /* !__SYS_PARALLELTHINK_H__ */
@@ -73,6 +73,7 @@ file be unloadable in some way (for example, due to script changes).
 
 idCVar sg_debugchecks("sg_debugchecks", "0", CVAR_BOOL | CVAR_SYSTEM | CVAR_CHEAT, "write savegame file checks, requires debug build");
 idCVar sg_debugdump("sg_debugdump", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_CHEAT, "savegame file info dump");
+idCVar sg_varint("sg_varint", "1", CVAR_BOOL | CVAR_SYSTEM, "write ints and shorts in savegames as variable length integers");
 
 #define SG_OBJ_MATCHINDEX
 
@@ -306,6 +307,7 @@ idSaveGame::idSaveGame( idFile *savefile, const int saveVer, int entityNum, int
 	file = savefile;
 	saveVersion = saveVer;
 	saveDebugging = sg_debugchecks.GetBool();
+	saveVarInts = sg_varint.GetBool();
 
 	objectsGamePtrCount_w = 0;
 	objectsStaticPtrCount_w = 0;
@@ -354,8 +356,15 @@ idSaveGame::WriteSaveInfo
 ======================
 */
 void idSaveGame::WriteSaveInfo() {
+	byte flags = 0;
+	if ( saveDebugging ) {
+		flags |= SG_INFO_DEBUGCHECKS;
+	}
+	if ( saveVarInts ) {
+		flags |= SG_INFO_VARINT;
+	}
 	file->WriteInt( saveVersion );
-	file->WriteBool( saveDebugging );
+	file->WriteUnsignedChar( flags );
 }
 
 /*
@@ -733,13 +742,38 @@ void idSaveGame::Write( const void *buffer, int len ) {
 	WriteCheckType(SG_CHECK_BUFFER);
 }
 
+/*
+================
+idSaveGame::WriteVarInt
+
+7 bits per byte, the high bit is set on every byte but the last
+================
+*/
+void idSaveGame::WriteVarInt( const unsigned int value ) {
+	byte buffer[5];
+	unsigned int v = value;
+	int len = 0;
+
+	while ( v >= 0x80 ) {
+		buffer[len++] = (byte)( v | 0x80 );
+		v >>= 7;
+	}
+	buffer[len++] = (byte)v;
+
+	file->Write( buffer, len );
+}
+
 /*
 ================
 idSaveGame::WriteInt
 ================
 */
 void idSaveGame::WriteInt( const int value ) {
-	file->WriteInt( value );
+	if ( saveVarInts ) {
+		WriteVarInt( ( (unsigned int)value << 1 ) ^ (unsigned int)( value >> 31 ) );
+	} else {
+		file->WriteInt( value );
+	}
 	WriteCheckType(SG_CHECK_INT);
 }
 
@@ -749,7 +783,11 @@ idSaveGame::WriteUInt
 ================
 */
 void idSaveGame::WriteUInt( const uint value ) {
-	file->WriteUnsignedInt( value );
+	if ( saveVarInts ) {
+		WriteVarInt( value );
+	} else {
+		file->WriteUnsignedInt( value );
+	}
 	WriteCheckType(SG_CHECK_UINT);
 }
 
@@ -759,7 +797,12 @@ idSaveGame::WriteJoint
 ================
 */
 void idSaveGame::WriteJoint( const jointHandle_t value ) {
-	file->WriteInt( (int&)value );
+	if ( saveVarInts ) {
+		// INVALID_JOINT is -1, so the sign needs zigzag encoding as well
+		WriteVarInt( ( (unsigned int)value << 1 ) ^ (unsigned int)( (int)value >> 31 ) );
+	} else {
+		file->WriteInt( (int&)value );
+	}
 	WriteCheckType(SG_CHECK_JOINT);
 }
 
@@ -769,7 +812,11 @@ idSaveGame::WriteShort
 ================
 */
 void idSaveGame::WriteShort( const short value ) {
-	file->WriteShort( value );
+	if ( saveVarInts ) {
+		WriteVarInt( ( (unsigned int)value << 1 ) ^ (unsigned int)( value >> 15 ) );
+	} else {
+		file->WriteShort( value );
+	}
 	WriteCheckType(SG_CHECK_SHORT);
 }
 
@@ -1756,8 +1803,11 @@ idRestoreGame::ReadSaveInfo
 =====================
 */
 void idRestoreGame::ReadSaveInfo( void ) {
+	byte flags;
 	file->ReadInt( saveVersion );
-	file->ReadBool( saveDebugging );
+	file->ReadUnsignedChar( flags );
+	saveDebugging = ( flags & SG_INFO_DEBUGCHECKS ) != 0;
+	saveVarInts = ( flags & SG_INFO_VARINT ) != 0;
 }
 
 /*
@@ -2199,13 +2249,39 @@ void idRestoreGame::Read( void *buffer, int len ) {
 	ReadCheckType(SG_CHECK_BUFFER);
 }
 
+/*
+================
+idRestoreGame::ReadVarInt
+================
+*/
+unsigned int idRestoreGame::ReadVarInt( void ) {
+	unsigned int value = 0;
+
+	for ( int shift = 0; shift < 35; shift += 7 ) {
+		byte b = 0;
+		file->Read( &b, 1 );
+		value |= (unsigned int)( b & 0x7f ) << shift;
+		if ( !( b & 0x80 ) ) {
+			return value;
+		}
+	}
+
+	Error( "idRestoreGame::ReadVarInt: invalid encoding" );
+	return 0;
+}
+
 /*
 ================
 idRestoreGame::ReadInt
 ================
 */
 void idRestoreGame::ReadInt( int &value ) {
-	file->ReadInt( value );
+	if ( saveVarInts ) {
+		unsigned int zigzag = ReadVarInt();
+		value = (int)( zigzag >> 1 ) ^ -(int)( zigzag & 1 );
+	} else {
+		file->ReadInt( value );
+	}
 	ReadCheckType(SG_CHECK_INT);
 }
 
@@ -2216,7 +2292,11 @@ idRestoreGame::ReadUInt
 */
 // blendo eric
 void idRestoreGame::ReadUInt( uint &value ) {
-	file->ReadUnsignedInt( value );
+	if ( saveVarInts ) {
+		value = ReadVarInt();
+	} else {
+		file->ReadUnsignedInt( value );
+	}
 	ReadCheckType(SG_CHECK_UINT);
 }
 
@@ -2226,7 +2306,12 @@ idRestoreGame::ReadJoint
 ================
 */
 void idRestoreGame::ReadJoint( jointHandle_t &value ) {
-	file->ReadInt( (int&)value );
+	if ( saveVarInts ) {
+		unsigned int zigzag = ReadVarInt();
+		value = (jointHandle_t)( (int)( zigzag >> 1 ) ^ -(int)( zigzag & 1 ) );
+	} else {
+		file->ReadInt( (int&)value );
+	}
 	ReadCheckType(SG_CHECK_JOINT);
 }
 
@@ -2236,7 +2321,12 @@ idRestoreGame::ReadShort
 ================
 */
 void idRestoreGame::ReadShort( short &value ) {
-	file->ReadShort( value );
+	if ( saveVarInts ) {
+		unsigned int zigzag = ReadVarInt();
+		value = (short)( (int)( zigzag >> 1 ) ^ -(int)( zigzag & 1 ) );
+	} else {
+		file->ReadShort( value );
+	}
 	ReadCheckType(SG_CHECK_SHORT);
 }
 
@@ -55,6 +55,7 @@ enum SAVEGAME_VERSIONS
 	SAVEGAME_VERSION_INVALID = SAVEGAME_VERSION_0001, // the newest version that can no longer be loaded
 	SAVEGAME_VERSION_0002 = 2, // wire nades crash
 	SAVEGAME_VERSION_0003 = 3, // wire nades fixed
+	SAVEGAME_VERSION_0004 = 4, // compressed saves, varint ints and the save info flags byte
 	SAVEGAME_VERSION = BUILD_NUMBER,
 	SAVEGAME_VERSION_MAX = BUILD_NUMBER
 };
@@ -158,6 +159,13 @@ enum SG_CHECK_TYPES
 	SG_CHECK_END
 };
 
+// stored in the save info byte that used to be a bool for the debug checks, so older saves read as flags
+enum SG_INFO_FLAGS
+{
+	SG_INFO_DEBUGCHECKS	= BIT( 0 ),	// type and size markers after each value
+	SG_INFO_VARINT		= BIT( 1 ),	// ints and shorts are zigzag varints instead of fixed width
+};
+
 class idSaveGamePtr; // helper class, inheriting from this will help track it in savegame
 
 // blendo eric: associates a index id with a ptr, so instanced members and misc ptrs can be hooked up
@@ -280,6 +288,9 @@ private:
 	idFile *				file;
 	int						saveVersion;
 	bool					saveDebugging;
+	bool					saveVarInts;
+
+	void					WriteVarInt( const unsigned int value );
 
 	int						objectsGameEntitiesNum_w;
 	int						objectsGameThreadsNum_w;
@@ -454,6 +465,9 @@ private:
 
 	int						saveVersion = 0;
 	bool					saveDebugging = false;
+	bool					saveVarInts = false;
+
+	unsigned int			ReadVarInt( void );
 
 	idList<idClass *>		objectsGame_r;
 	idList<int>				objectsGameOrder_r;
@@ -497,5 +511,6 @@ public:
 
 
 extern idCVar sg_debugchecks;
+extern idCVar sg_varint;
 
 #endif /* !__SAVEGAME_H__*/
@@ -30,6 +30,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "idlib/LangDict.h"
 #include "framework/async/NetworkSystem.h"
 #include "framework/FileSystem.h"
+#include "idlib/Timer.h"
+#include "renderer/ModelManager.h"
 
 #include "gamesys/TypeInfo.h"
 #include "gamesys/SysCvar.h"
@@ -241,6 +243,212 @@ void Cmd_Script_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+===================
+Cmd_TestScriptSpeed_f
+
+Runs a fixed set of script functions with and without superinstructions.  Times are
+per statement of the plain code, so both columns can be compared.  The benchmark is
+removed from the program again when it's done.
+===================
+*/
+static const char *scriptSpeedText =
+	"object scriptSpeedObject {\n"
+	"	float	value;\n"
+	"	float	fieldCompare();\n"
+	"	float	eventCall();\n"
+	"};\n"
+	"float scriptSpeed_floatMath() {\n"
+	"	float i;\n"
+	"	float x;\n"
+	"	for( i = 0; i < 100000; i++ ) {\n"
+	"		x = x * 0.5 + i;\n"
+	"	}\n"
+	"	return x;\n"
+	"}\n"
+	"vector scriptSpeed_vectorMath() {\n"
+	"	float i;\n"
+	"	vector v;\n"
+	"	for( i = 0; i < 100000; i++ ) {\n"
+	"		v = v * 0.5 + '1 2 3';\n"
+	"	}\n"
+	"	return v;\n"
+	"}\n"
+	"float scriptSpeed_sysCall() {\n"
+	"	float i;\n"
+	"	float x;\n"
+	"	for( i = 0; i < 50000; i++ ) {\n"
+	"		x = x + sys.sin( 30 );\n"
+	"	}\n"
+	"	return x;\n"
+	"}\n"
+	"float scriptSpeedObject::fieldCompare() {\n"
+	"	float i;\n"
+	"	float n;\n"
+	"	for( i = 0; i < 100000; i++ ) {\n"
+	"		value = value + 1;\n"
+	"		if ( value > 10 ) {\n"
+	"			value = 0;\n"
+	"			n++;\n"
+	"		}\n"
+	"	}\n"
+	"	return n;\n"
+	"}\n"
+	"float scriptSpeedObject::eventCall() {\n"
+	"	float i;\n"
+	"	float x;\n"
+	"	for( i = 0; i < 50000; i++ ) {\n"
+	"		x = x + getFloatKey( \"scriptSpeed\" );\n"
+	"	}\n"
+	"	return x;\n"
+	"}\n";
+
+void Cmd_TestScriptSpeed_f( const idCmdArgs &args ) {
+	const int		numRuns = 10;
+	const char *	names[] = { "scriptSpeed_floatMath", "scriptSpeed_vectorMath", "scriptSpeed_sysCall", "fieldCompare", "eventCall" };
+	const int		numTests = sizeof( names ) / sizeof( names[ 0 ] );
+	const function_t *funcs[ numTests ];
+	int				statements[ numTests ];
+	int				dispatches[ numTests ];
+	double			times[ 2 ][ numTests ];
+	idEntity *		ent;
+	idThread *		thread;
+	idDict			spawnArgs;
+	programState_t	programState;
+	int				i;
+	int				pass;
+	int				run;
+
+	if ( gameLocal.GameState() != GAMESTATE_ACTIVE ) {
+		gameLocal.Printf( "testScriptSpeed needs a running map\n" );
+		return;
+	}
+
+	gameLocal.program.SaveState( programState );
+	if ( !gameLocal.program.CompileText( "testScriptSpeed", scriptSpeedText, true ) ) {
+		gameLocal.program.RestoreState( programState );
+		return;
+	}
+
+	spawnArgs.Set( "scriptobject", "scriptSpeedObject" );
+	spawnArgs.SetFloat( "scriptSpeed", 1.0f );
+	ent = gameLocal.SpawnEntityType( idEntity::Type, &spawnArgs );
+
+	for( i = 0; i < numTests; i++ ) {
+		if ( i < 3 ) {
+			funcs[ i ] = gameLocal.program.FindFunction( names[ i ] );
+		} else {
+			funcs[ i ] = ent->scriptObject.GetFunction( names[ i ] );
+		}
+		if ( !funcs[ i ] ) {
+			gameLocal.Printf( "couldn't find '%s'\n", names[ i ] );
+			delete ent;
+			gameLocal.program.RestoreState( programState );
+			return;
+		}
+	}
+
+	thread = new idThread();
+	thread->ManualDelete();
+	thread->ManualControl();
+
+	for( pass = 0; pass < 2; pass++ ) {
+		gameLocal.program.BuildCode( pass == 1 );
+
+		for( i = 0; i < numTests; i++ ) {
+			uint64 ticks = 0;
+
+			// the first run is not timed
+			for( run = 0; run <= numRuns; run++ ) {
+				if ( i < 3 ) {
+					thread->CallFunction( funcs[ i ], true );
+				} else {
+					thread->CallFunction( ent, funcs[ i ], true );
+				}
+
+				uint64 start = Sys_GetPerformanceCounter();
+				thread->Execute();
+				if ( run > 0 ) {
+					ticks += Sys_GetPerformanceCounter() - start;
+				}
+			}
+
+			if ( pass == 0 ) {
+				statements[ i ] = thread->ExecutedInstructions();
+			} else {
+				dispatches[ i ] = thread->ExecutedInstructions();
+			}
+			times[ pass ][ i ] = Sys_GetPerformanceTimeMS( ticks ) * 1000000.0 / ( ( double )statements[ i ] * numRuns );
+		}
+	}
+
+	delete thread;
+	delete ent;
+
+	// drop the benchmark again, this also rebuilds the code with g_scriptSuperInstructions
+	gameLocal.program.RestoreState( programState );
+
+	gameLocal.Printf( "%-24s %10s %10s %10s %10s\n", "function", "statements", "dispatches", "plain", "fused" );
+	for( i = 0; i < numTests; i++ ) {
+		gameLocal.Printf( "%-24s %10d %10d %7.2f ns %7.2f ns\n", names[ i ], statements[ i ], dispatches[ i ], times[ 0 ][ i ], times[ 1 ][ i ] );
+	}
+}
+
+/*
+===================
+Cmd_TestScriptCache_f
+
+Compiles the default script, writes it to the compiled script cache and loads it back.
+===================
+*/
+void Cmd_TestScriptCache_f( const idCmdArgs &args ) {
+	idProgram &		program = gameLocal.program;
+	uint64			start;
+	double			compileTime;
+	double			loadTime;
+	int				compileChecksum;
+	int				numStatements;
+	int				cacheMode;
+	bool			loaded;
+
+	if ( gameLocal.GameState() != GAMESTATE_NOMAP ) {
+		gameLocal.Printf( "testScriptCache can't be used while a map is loaded\n" );
+		return;
+	}
+
+	cacheMode = g_scriptCache.GetInteger();
+	g_scriptCache.SetInteger( 0 );
+
+	start = Sys_GetPerformanceCounter();
+	program.Startup( SCRIPT_DEFAULT );
+	compileTime = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - start );
+
+	compileChecksum = program.CalculateChecksum();
+	numStatements = program.NumStatements();
+	program.WriteCache( SCRIPT_DEFAULT );
+
+	idThread::Restart();
+	start = Sys_GetPerformanceCounter();
+	loaded = program.LoadCache( SCRIPT_DEFAULT );
+	if ( loaded ) {
+		program.FinishCompilation();
+	}
+	loadTime = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - start );
+
+	if ( !loaded ) {
+		gameLocal.Printf( "couldn't load the compiled script cache\n" );
+	} else {
+		gameLocal.Printf( "%d statements: compile %.2f ms, cache load %.2f ms (%.1fx)\n", numStatements, compileTime, loadTime, compileTime / Max( loadTime, 0.001 ) );
+		if ( program.CalculateChecksum() != compileChecksum ) {
+			gameLocal.Printf( "cached program doesn't match the compiled program\n" );
+		}
+	}
+
+	// put back the scripts the way the game loads them
+	g_scriptCache.SetInteger( cacheMode );
+	gameLocal.LoadScripts();
+}
+
 /*
 ==================
 KillEntities
@@ -1843,6 +2051,85 @@ static void Cmd_ListAnims_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+==================
+Cmd_BuildModelCache_f
+
+rewrites the binary caches of every md5 mesh and anim used by a modelDef and
+compares loading them from the text files against loading the caches.
+with "map" only the modelDefs loaded by the current map are used.
+==================
+*/
+static void Cmd_BuildModelCache_f( const idCmdArgs &args ) {
+	idStrList	meshNames;
+	idStrList	animNames;
+	idTimer		meshTextTime, meshCacheTime;
+	idTimer		animTextTime, animCacheTime;
+	int			i, j, k;
+
+	bool mapOnly = ( idStr::Icmp( args.Argv( 1 ), "map" ) == 0 );
+
+	int numModelDefs = declManager->GetNumDecls( DECL_MODELDEF );
+	for ( i = 0; i < numModelDefs; i++ ) {
+		const idDecl *decl = declManager->DeclByIndex( DECL_MODELDEF, i, !mapOnly );
+		if ( decl == NULL || decl->GetState() != DS_PARSED ) {
+			continue;
+		}
+		const idDeclModelDef *modelDef = static_cast<const idDeclModelDef *>( decl );
+
+		idRenderModel *model = modelDef->ModelHandle();
+		if ( model != NULL && idStr::CheckExtension( model->Name(), "." MD5_MESH_EXT ) ) {
+			meshNames.AddUnique( model->Name() );
+		}
+
+		for ( j = 1; j <= modelDef->NumAnims(); j++ ) {
+			const idAnim *anim = modelDef->GetAnim( j );
+			if ( anim == NULL ) {
+				continue;
+			}
+			for ( k = 0; k < anim->NumAnims(); k++ ) {
+				const idMD5Anim *md5anim = anim->MD5Anim( k );
+				if ( md5anim != NULL ) {
+					animNames.AddUnique( md5anim->Name() );
+				}
+			}
+		}
+	}
+
+	int oldCache = cvarSystem->GetCVarInteger( "r_md5Cache" );
+
+	// 2 = parse the text and rewrite the caches, 0 = text only, 1 = caches only
+	static const int passes[3] = { 2, 0, 1 };
+	for ( int pass = 0; pass < 3; pass++ ) {
+		cvarSystem->SetCVarInteger( "r_md5Cache", passes[pass] );
+
+		idTimer &meshTime = ( passes[pass] == 1 ) ? meshCacheTime : meshTextTime;
+		idTimer &animTime = ( passes[pass] == 1 ) ? animCacheTime : animTextTime;
+		if ( pass != 0 ) {
+			meshTime.Start();
+		}
+		for ( i = 0; i < meshNames.Num(); i++ ) {
+			renderModelManager->FreeModel( renderModelManager->LoadUnregisteredModel( meshNames[i] ) );
+		}
+		if ( pass != 0 ) {
+			meshTime.Stop();
+			animTime.Start();
+		}
+		for ( i = 0; i < animNames.Num(); i++ ) {
+			idMD5Anim anim;
+			anim.LoadAnim( animNames[i] );
+		}
+		if ( pass != 0 ) {
+			animTime.Stop();
+		}
+	}
+
+	cvarSystem->SetCVarInteger( "r_md5Cache", oldCache );
+
+	gameLocal.Printf( "%d md5 meshes: %6u msec text, %6u msec binary\n", meshNames.Num(), meshTextTime.Milliseconds(), meshCacheTime.Milliseconds() );
+	gameLocal.Printf( "%d md5 anims:  %6u msec text, %6u msec binary\n", animNames.Num(), animTextTime.Milliseconds(), animCacheTime.Milliseconds() );
+}
+
 /*
 ==================
 Cmd_AASStats_f
@@ -4457,6 +4744,98 @@ void Cmd_DebugStressTest_f(const idCmdArgs& args)
 	}
 }
 
+/*
+==================
+Cmd_TestDictSpawn_f
+
+Builds the spawn args of every entity in the map like SpawnEntityDef and the entity
+constructors do, then times spawn arg lookups by name and through an idDictKey.
+==================
+*/
+void Cmd_TestDictSpawn_f( const idCmdArgs &args ) {
+	static const char *lookupNames[] = { "origin", "angle", "model", "name", "classname", "spawnclass", "health", "skin", "noclipmodel", "bind" };
+	const int		numLookupNames = sizeof( lookupNames ) / sizeof( lookupNames[0] );
+	idList<const idDictKey *> lookupKeys;
+	idList<idDict>	spawnArgs;
+	idList<idDict>	entityArgs;
+	idMapFile *		mapFile;
+	uint64			startTime;
+	double			msSpawn, msByName, msByKey;
+	int				numPasses, numShared, numFound, i, j, pass;
+
+	mapFile = gameLocal.GetLevelMap();
+	if ( mapFile == NULL ) {
+		gameLocal.Printf( "testDictSpawn: no map loaded\n" );
+		return;
+	}
+	numPasses = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 1 ) : 10;
+
+	spawnArgs.SetNum( mapFile->GetNumEntities() );
+	entityArgs.SetNum( mapFile->GetNumEntities() );
+
+	startTime = Sys_GetPerformanceCounter();
+	for ( pass = 0; pass < numPasses; pass++ ) {
+		for ( i = 0; i < mapFile->GetNumEntities(); i++ ) {
+			const idDict &epairs = mapFile->GetEntity( i )->epairs;
+			spawnArgs[i] = epairs;
+			const idDeclEntityDef *def = gameLocal.FindEntityDef( epairs.GetString( "classname" ), false );
+			if ( def ) {
+				spawnArgs[i].SetDefaults( &def->dict );
+			}
+			entityArgs[i] = spawnArgs[i];
+		}
+	}
+	msSpawn = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+
+	numShared = 0;
+	for ( i = 0; i < entityArgs.Num(); i++ ) {
+		if ( entityArgs[i].IsShared() ) {
+			numShared++;
+		}
+	}
+	spawnArgs.Clear();
+
+	for ( j = 0; j < numLookupNames; j++ ) {
+		lookupKeys.Append( new idDictKey( lookupNames[j] ) );
+	}
+
+	numFound = 0;
+	startTime = Sys_GetPerformanceCounter();
+	for ( pass = 0; pass < numPasses; pass++ ) {
+		for ( i = 0; i < entityArgs.Num(); i++ ) {
+			for ( j = 0; j < numLookupNames; j++ ) {
+				if ( entityArgs[i].FindKey( lookupNames[j] ) ) {
+					numFound++;
+				}
+			}
+		}
+	}
+	msByName = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+
+	startTime = Sys_GetPerformanceCounter();
+	for ( pass = 0; pass < numPasses; pass++ ) {
+		for ( i = 0; i < entityArgs.Num(); i++ ) {
+			for ( j = 0; j < numLookupNames; j++ ) {
+				if ( entityArgs[i].FindKey( *lookupKeys[j] ) ) {
+					numFound--;
+				}
+			}
+		}
+	}
+	msByKey = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+
+	lookupKeys.DeleteContents( true );
+
+	const double numLookups = (double)numPasses * entityArgs.Num() * numLookupNames;
+	gameLocal.Printf( "testDictSpawn: %d entities, %d passes\n", entityArgs.Num(), numPasses );
+	gameLocal.Printf( "  spawn args:     %8.2f ms, %7.3f us per entity, %d of %d entity copies shared\n", msSpawn, msSpawn * 1000.0 / Max( numPasses * entityArgs.Num(), 1 ), numShared, entityArgs.Num() );
+	gameLocal.Printf( "  lookup by name: %8.2f ms, %6.1f M lookups/s\n", msByName, numLookups / Max( msByName, 0.001 ) / 1000.0 );
+	gameLocal.Printf( "  lookup by key:  %8.2f ms, %6.1f M lookups/s\n", msByKey, numLookups / Max( msByKey, 0.001 ) / 1000.0 );
+	if ( numFound != 0 ) {
+		gameLocal.Printf( "  lookups by name and by key differ\n" );
+	}
+}
+
 void Cmd_DebugPersistentClear(const idCmdArgs& args)
 {
 	common->Printf("Persistent level info: cleared.");
@@ -4600,6 +4979,9 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "listClasses",			idClass::ListClasses_f,		CMD_FL_GAME,				"lists game classes" );
 	cmdSystem->AddCommand( "listThreads",			idThread::ListThreads_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"lists script threads" );
 	cmdSystem->AddCommand( "listEntities",			Cmd_EntityList_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"lists game entities" );
+	cmdSystem->AddCommand( "thinkParallelCompare",	idParallelThink::Compare_f,	CMD_FL_GAME,				"compares the think checksums recorded with g_thinkParallelCheck in serial and parallel mode" );
+	cmdSystem->AddCommand( "thinkProfile",			idThinkProfiler::ThinkProfile_f,	CMD_FL_GAME,			"prints the think costs recorded with g_thinkProfile sorted by class and entity, usage: thinkProfile [rows | reset | csv [file]]" );
+	cmdSystem->AddCommand( "testEventQueue",		idEvent::StressTest_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"times posting and canceling events, usage: testEventQueue [number of events, default 100000]" );
 	cmdSystem->AddCommand( "listActiveEntities",	Cmd_ActiveEntityList_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"lists active game entities" );
 	cmdSystem->AddCommand( "listMonsters",			idAI::List_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"lists monsters" );
 	cmdSystem->AddCommand( "listSpawnArgs",			Cmd_ListSpawnArgs_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"list the spawn args of an entity", idGameLocal::ArgCompletion_EntityName );
@@ -4650,11 +5032,14 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "testBlend",				idTestModel::TestBlend_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests animation blending" );
 	cmdSystem->AddCommand( "reloadScript",			Cmd_ReloadScript_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"reloads scripts" );
 	cmdSystem->AddCommand( "script",				Cmd_Script_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"executes a line of script" );
+	cmdSystem->AddCommand( "testScriptCache",		Cmd_TestScriptCache_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"compares the time to compile the default script with the time to load it from the compiled script cache" );
+	cmdSystem->AddCommand( "testScriptSpeed",		Cmd_TestScriptSpeed_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"times a fixed set of script functions with and without superinstructions" );
 	cmdSystem->AddCommand( "listCollisionModels",	Cmd_ListCollisionModels_f,	CMD_FL_GAME,				"lists collision models" );
 	cmdSystem->AddCommand( "collisionModelInfo",	Cmd_CollisionModelInfo_f,	CMD_FL_GAME,				"shows collision model info" );
 	cmdSystem->AddCommand( "reexportmodels",		Cmd_ReexportModels_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"reexports models", ArgCompletion_DefFile );
 	cmdSystem->AddCommand( "reloadanims",			Cmd_ReloadAnims_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"reloads animations" );
 	cmdSystem->AddCommand( "listAnims",				Cmd_ListAnims_f,			CMD_FL_GAME,				"lists all animations" );
+	cmdSystem->AddCommand( "buildModelCache",		Cmd_BuildModelCache_f,		CMD_FL_GAME,				"writes binary caches for all md5 meshes and anims and compares text and binary load times, 'buildModelCache map' only uses the current map" );
 	cmdSystem->AddCommand( "aasStats",				Cmd_AASStats_f,				CMD_FL_GAME,				"shows AAS stats" );
 	cmdSystem->AddCommand( "testDamage",			Cmd_TestDamage_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests a damage def", idCmdSystem::ArgCompletion_Decl<DECL_ENTITYDEF> );
 	cmdSystem->AddCommand( "weaponSplat",			Cmd_WeaponSplat_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"projects a blood splat on the player weapon" );
@@ -4706,6 +5091,13 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand("toggleshadow",			Cmd_ToggleShadow_f, CMD_FL_GAME | CMD_FL_CHEAT, "Toggle shadows of entity you're looking at.");
 	cmdSystem->AddCommand("g_entitynumber",			Cmd_EntityNumber_f, CMD_FL_GAME, "Print entity number of entity that you're looking at.");
 	cmdSystem->AddCommand("listEntitiesVisible",	Cmd_ListEntitiesVisible_f, CMD_FL_GAME, "List entities that are currently in your PVS.");
+	cmdSystem->AddCommand("testNodeLOS",			idMeta::TestNodeLOS_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"times GenerateNodeLOS with and without the searchnode table on the recently observed points, usage: testNodeLOS [repeat count, default 10]");
+	cmdSystem->AddCommand("recordTracePoints",		idClip::RecordTracePoints_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"records the next point traces for testTracePoints, usage: recordTracePoints [count, default 10000]");
+	cmdSystem->AddCommand("testTracePoints",		idClip::TestTracePoints_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"times TracePoint against the batched TracePoints on the recorded point traces, usage: testTracePoints [batch size, default 1024]");
+	cmdSystem->AddCommand("aiPerceptionStats",		idAIPerception::Stats_f,	CMD_FL_GAME,				"prints the average batched AI perception counters per frame, usage: aiPerceptionStats [reset]");
+	cmdSystem->AddCommand("aasRoutingBenchmark",	idAAS::RoutingBenchmark_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"routes between random areas of the loaded map cold, warm, with the routing table and on the job workers, usage: aasRoutingBenchmark [aas index] [number of area pairs, default 10000] [random seed]");
+	cmdSystem->AddCommand("aasRoutingRepairTest",	idAAS::RoutingRepairTest_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"disables and enables random cluster portals and compares the repaired routing caches with a rebuild, usage: aasRoutingRepairTest [aas index] [number of portals, default 100] [random seed]");
+	cmdSystem->AddCommand("testDictSpawn",			Cmd_TestDictSpawn_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"times building the spawn args of the map entities and looking up spawn args, usage: testDictSpawn [passes, default 10]");
 	cmdSystem->AddCommand("damageAll",				Cmd_DamageAll_f, CMD_FL_GAME | CMD_FL_CHEAT, "Apply generic damage to every entity in map.");
 	cmdSystem->AddCommand("testdecal",				Cmd_TestDecal_f, CMD_FL_GAME | CMD_FL_CHEAT, "Create decal at crosshair location.", idCmdSystem::ArgCompletion_Decl<DECL_MATERIAL>);
 	cmdSystem->AddCommand("clearDebug",				Cmd_ClearDebug_f, CMD_FL_GAME, "clears all debug lines.");
@@ -210,6 +210,8 @@ idCVar g_skipFX(					"g_skipFX",					"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_skipParticles(				"g_skipParticles",			"0",			CVAR_GAME | CVAR_BOOL, "" );
 
 idCVar g_disasm(					"g_disasm",					"0",			CVAR_GAME | CVAR_BOOL, "disassemble script into base/script/disasm.txt on the local drive when script is compiled" );
+idCVar g_scriptSuperInstructions(	"g_scriptSuperInstructions",	"1",			CVAR_GAME | CVAR_BOOL, "fuse common statement sequences of scripts into superinstructions when script is compiled" );
+idCVar g_scriptCache(				"g_scriptCache",				"1",			CVAR_GAME | CVAR_INTEGER, "0 = always compile the scripts, 1 = use the compiled script cache, 2 = rebuild the compiled script cache", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 idCVar g_debugBounds(				"g_debugBounds",			"0",			CVAR_GAME | CVAR_BOOL, "checks for models with bounds > 2048" );
 idCVar g_debugAnim(					"g_debugAnim",				"-1",			CVAR_GAME | CVAR_INTEGER, "displays information on which animations are playing on the specified entity number.  set to -1 to disable." );
 idCVar g_debugMove(					"g_debugMove",				"0",			CVAR_GAME | CVAR_BOOL, "Debug player movement." );
@@ -248,6 +250,11 @@ idCVar g_showEnemies(				"g_showEnemies",			"0",			CVAR_GAME | CVAR_BOOL, "draws
 
 idCVar g_frametime(					"g_frametime",				"0",			CVAR_GAME | CVAR_BOOL, "displays timing information for each game frame" );
 idCVar g_timeentities(				"g_timeEntities",			"0",			CVAR_GAME | CVAR_FLOAT, "when non-zero, shows entities whose think functions exceeded the # of milliseconds specified" );
+idCVar g_thinkParallel(				"g_thinkParallel",			"0",			CVAR_GAME | CVAR_INTEGER, "think entities with the thinkParallel spawnarg on the job workers. 1 = parallel, 2 = same deferred path executed in order on the game thread", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+idCVar g_thinkParallelCheck(		"g_thinkParallelCheck",		"0",			CVAR_GAME | CVAR_INTEGER, "record checksums of the parallel thinking entities for this many frames, compare g_thinkParallel 1 and 2 runs with thinkParallelCompare" );
+idCVar g_thinkProfile(				"g_thinkProfile",			"0",			CVAR_GAME | CVAR_BOOL, "accumulate the think, present and event handler costs per class and entity, print them with thinkProfile" );
+idCVar g_thinkProfileBudget(		"g_thinkProfileBudget",		"0",			CVAR_GAME | CVAR_FLOAT, "with g_thinkProfile set, warn about every class that uses more than this many milliseconds in a frame, 0 = off" );
+idCVar g_tracePointsJobSize(		"g_tracePointsJobSize",		"256",			CVAR_GAME | CVAR_INTEGER, "number of points per job when idClip::TracePoints spreads the world traces over the job workers, 0 traces on the calling thread" );
 
 #ifdef _D3XP
 idCVar g_testPistolFlashlight(		"g_testPistolFlashlight",	"1",			CVAR_GAME | CVAR_BOOL, "Test out having a flashlight out with the pistol" );
@@ -454,6 +461,10 @@ idCVar aas_showWallEdges(			"aas_showWallEdges",		"0",			CVAR_GAME | CVAR_INTEGE
 idCVar aas_showHideArea(			"aas_showHideArea",			"0",			CVAR_GAME | CVAR_INTEGER, "" );
 idCVar aas_pullPlayer(				"aas_pullPlayer",			"0",			CVAR_GAME | CVAR_INTEGER, "" );
 idCVar aas_randomPullPlayer(		"aas_randomPullPlayer",		"0",			CVAR_GAME | CVAR_BOOL, "" );
+idCVar aas_routingTable(			"aas_routingTable",			"1",			CVAR_GAME | CVAR_INTEGER, "precompute the routing between all cluster portals on map load: 0 = route on demand only, 1 = use the routing table and its disk cache, 2 = rebuild the table instead of loading the cache", 0, 2 );
+idCVar aas_pathRequestJobSize(		"aas_pathRequestJobSize",	"8",			CVAR_GAME | CVAR_INTEGER, "number of batched AAS path requests per job, batches smaller than twice this run on the game thread, 0 = never use the job workers", 0, 1024 );
+idCVar aas_routingRepair(			"aas_routingRepair",		"1",			CVAR_GAME | CVAR_BOOL, "repair the routing caches in place when areas or reachabilities are enabled or disabled, 0 = delete the caches of the clusters involved" );
+idCVar aas_showRoutingRepair(		"aas_showRoutingRepair",	"0",			CVAR_GAME | CVAR_BOOL, "print the routing cache repairs" );
 idCVar aas_goalArea(				"aas_goalArea",				"0",			CVAR_GAME | CVAR_INTEGER, "" );
 idCVar aas_showPushIntoArea(		"aas_showPushIntoArea",		"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar aas_showSingleArea(			"aas_showSingleArea",		"-1",			CVAR_GAME | CVAR_INTEGER, "Show a single aas cell, by its area number."); //bc
@@ -531,7 +542,11 @@ idCVar ai_showState(				"ai_showState",				"0",			CVAR_GAME | CVAR_BOOL, "Draws
 idCVar ai_showAnimState(			"ai_showAnimState",			"0",			CVAR_GAME | CVAR_INTEGER, "Draws AI anim states above their heads (head, torso, legs), 2 = show cur anim name");
 idCVar ai_showPlayerState(			"ai_showPlayerState",		"0",			CVAR_GAME | CVAR_INTEGER, "Draws the Player state changes in console, 2 = show anim name changes");
 idCVar ai_debugRepairbot(			"ai_debugRepairbot",		"0",			CVAR_GAME | CVAR_BOOL, "Draws repairbot debug.");
-idCVar ai_debugPerception(			"ai_debugPerception",		"0",			CVAR_GAME | CVAR_INTEGER, "Draws AI perception debug.");
+idCVar ai_searchNodeTable(			"ai_searchNodeTable",		"1",			CVAR_GAME | CVAR_INTEGER, "searchnode LOS queries: 0 = trace every node, 1 = use the precomputed searchnode table and its disk cache, 2 = rebuild the table instead of loading the cache", 0, 2);
+idCVar ai_debugPerception(			"ai_debugPerception",		"0",			CVAR_GAME | CVAR_INTEGER, "Draws AI perception debug. 3 = print the batched perception counters every frame.");
+idCVar ai_perception(				"ai_perception",			"1",			CVAR_GAME | CVAR_BOOL, "batch the AI PVS, vision box and sight checks once per frame and share the results");
+idCVar ai_perceptionRefresh(		"ai_perceptionRefresh",		"50",			CVAR_GAME | CVAR_INTEGER, "milliseconds the batched AI perception results are kept, overridden by the \"perception_refresh\" spawnArg", 0, 1000);
+idCVar ai_pathRequests(				"ai_pathRequests",			"1",			CVAR_GAME | CVAR_BOOL, "query the paths of all moving AI as one batch before they think");
 idCVar ai_showInterestPoints(		"ai_showInterestPoints",	"0",			CVAR_GAME | CVAR_INTEGER, "Draws interestpoint debug. 1 = show all in world. 2 = show live interest reactions.");
 idCVar ai_targetPredictTime(		"ai_targetPredictTime",		"0.016",		CVAR_GAME | CVAR_FLOAT, "How far ahead (in time) the enemies track the target. A higher number is easier to avoid.", 0.0f, 0.5f);
 
@@ -51,6 +51,8 @@ extern idCVar	g_doubleVision;
 extern idCVar	g_muzzleFlash;
 
 extern idCVar	g_disasm;
+extern idCVar	g_scriptSuperInstructions;
+extern idCVar	g_scriptCache;
 extern idCVar	g_debugBounds;
 extern idCVar	g_debugAnim;
 extern idCVar	g_debugMove;
@@ -88,6 +90,11 @@ extern idCVar	g_showEnemies;
 
 extern idCVar	g_frametime;
 extern idCVar	g_timeentities;
+extern idCVar	g_thinkParallel;
+extern idCVar	g_thinkParallelCheck;
+extern idCVar	g_thinkProfile;
+extern idCVar	g_thinkProfileBudget;
+extern idCVar	g_tracePointsJobSize;
 
 extern idCVar	ai_debugScript;
 extern idCVar	ai_debugMove;
@@ -279,6 +286,10 @@ extern idCVar	aas_showWallEdges;
 extern idCVar	aas_showHideArea;
 extern idCVar	aas_pullPlayer;
 extern idCVar	aas_randomPullPlayer;
+extern idCVar	aas_routingTable;
+extern idCVar	aas_pathRequestJobSize;
+extern idCVar	aas_routingRepair;
+extern idCVar	aas_showRoutingRepair;
 extern idCVar	aas_goalArea;
 extern idCVar	aas_showPushIntoArea;
 extern idCVar	aas_showSingleArea; //bc
@@ -322,6 +333,10 @@ extern const char *ui_skinArgs[];
 extern idCVar	g_showmaterial;
 extern idCVar	g_showmodel;
 extern idCVar	ai_debugPerception;
+extern idCVar	ai_perception;
+extern idCVar	ai_perceptionRefresh;
+extern idCVar	ai_pathRequests;
+extern idCVar	ai_searchNodeTable;
 extern idCVar	g_showPlayerBody;
 extern idCVar	g_showEntityHealth;
 extern idCVar	g_screenshake;
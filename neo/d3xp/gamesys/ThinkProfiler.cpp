@@ -0,0 +1,452 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#include "sys/platform.h"
+#include "framework/CmdSystem.h"
+#include "framework/FileSystem.h"
+
+#include "gamesys/SysCvar.h"
+#include "gamesys/ParallelThink.h"
+#include "Entity.h"
+#include "Game_local.h"
+
+#include "gamesys/ThinkProfiler.h"
+
+#define DEFAULT_THINKPROFILE_ROWS		20
+#define DEFAULT_THINKPROFILE_FILE		"thinkprofile.csv"
+
+static const char *thinkProfileCategoryNames[THINKPROFILE_NUM] = { "think", "present", "event" };
+
+typedef struct thinkProfileSort_s {
+	int						index;
+	uint64					ticks;
+} thinkProfileSort_t;
+
+bool idThinkProfiler::active = false;
+
+// innermost running scope on the game thread
+static idThinkProfileScope *currentThinkScope = NULL;
+
+/*
+================
+ThinkProfileSortCompare
+================
+*/
+static int ThinkProfileSortCompare( const thinkProfileSort_t *a, const thinkProfileSort_t *b ) {
+	if ( a->ticks > b->ticks ) {
+		return -1;
+	}
+	if ( a->ticks < b->ticks ) {
+		return 1;
+	}
+	return a->index - b->index;
+}
+
+/*
+================
+ThinkProfileTotal
+================
+*/
+static uint64 ThinkProfileTotal( const thinkProfileCounter_t *counters ) {
+	uint64 ticks = 0;
+	for ( int i = 0; i < THINKPROFILE_NUM; i++ ) {
+		ticks += counters[i].ticks;
+	}
+	return ticks;
+}
+
+/*
+================
+ThinkProfileTraces
+================
+*/
+static int ThinkProfileTraces( const thinkProfileCounter_t *counters ) {
+	int traces = 0;
+	for ( int i = 0; i < THINKPROFILE_NUM; i++ ) {
+		traces += counters[i].traces;
+	}
+	return traces;
+}
+
+/*
+================
+idThinkProfiler::idThinkProfiler
+================
+*/
+idThinkProfiler::idThinkProfiler( void ) {
+	frames = 0;
+}
+
+/*
+================
+idThinkProfiler::Clear
+================
+*/
+void idThinkProfiler::Clear( void ) {
+	for ( int i = 0; i < entities.Num(); i++ ) {
+		entities[i].spawnId = -1;
+	}
+}
+
+/*
+================
+idThinkProfiler::Reset
+================
+*/
+void idThinkProfiler::Reset( void ) {
+	classes.Clear();
+	entities.Clear();
+	frameClasses.Clear();
+	frames = 0;
+}
+
+/*
+================
+idThinkProfiler::BeginFrame
+================
+*/
+void idThinkProfiler::BeginFrame( void ) {
+	active = g_thinkProfile.GetBool();
+	if ( !active ) {
+		return;
+	}
+
+	if ( classes.Num() != idClass::GetNumTypes() ) {
+		int oldNum = classes.Num();
+		classes.SetNum( idClass::GetNumTypes() );
+		for ( int i = oldNum; i < classes.Num(); i++ ) {
+			memset( &classes[i], 0, sizeof( classes[i] ) );
+		}
+	}
+	if ( entities.Num() != MAX_GENTITIES ) {
+		entities.SetNum( MAX_GENTITIES );
+		Clear();
+	}
+}
+
+/*
+================
+idThinkProfiler::EndFrame
+
+Everything recorded after this, like the Present calls of the renderer, counts towards the next frame.
+================
+*/
+void idThinkProfiler::EndFrame( void ) {
+	if ( !active ) {
+		return;
+	}
+
+	float budget = g_thinkProfileBudget.GetFloat();
+
+	for ( int i = 0; i < frameClasses.Num(); i++ ) {
+		thinkProfileClass_t &c = classes[frameClasses[i]];
+		if ( c.frameTicks > c.peakTicks ) {
+			c.peakTicks = c.frameTicks;
+		}
+		if ( budget > 0.0f ) {
+			double ms = Sys_GetPerformanceTimeMS( c.frameTicks );
+			if ( ms > budget ) {
+				c.overBudget++;
+				gameLocal.Warning( "think profile: %s used %.2f ms in frame %d, budget is %.2f ms", idClass::GetType( frameClasses[i] )->classname, ms, gameLocal.framenum, budget );
+			}
+		}
+		c.frameTicks = 0;
+	}
+	frameClasses.SetNum( 0, false );
+	frames++;
+}
+
+/*
+================
+idThinkProfiler::Add
+================
+*/
+void idThinkProfiler::Add( thinkProfileCategory_t category, const idClass *obj, uint64 ticks, int traces ) {
+	int entityNum = -1;
+	int spawnId = -1;
+
+	if ( obj->IsType( idEntity::Type ) ) {
+		entityNum = static_cast<const idEntity *>( obj )->entityNumber;
+		spawnId = gameLocal.spawnIds[entityNum];
+	}
+	Add( category, obj->GetType(), entityNum, spawnId, ticks, traces );
+}
+
+/*
+================
+idThinkProfiler::Add
+================
+*/
+void idThinkProfiler::Add( thinkProfileCategory_t category, const idTypeInfo *type, int entityNum, int spawnId, uint64 ticks, int traces ) {
+	if ( type->typeNum >= classes.Num() ) {
+		return;
+	}
+
+	thinkProfileClass_t &c = classes[type->typeNum];
+	c.counters[category].ticks += ticks;
+	c.counters[category].calls++;
+	c.counters[category].traces += traces;
+	if ( !c.frameTicks ) {
+		frameClasses.Append( type->typeNum );
+	}
+	c.frameTicks += ticks;
+
+	if ( entityNum < 0 || entityNum >= entities.Num() ) {
+		return;
+	}
+
+	// a new entity in the slot starts over
+	thinkProfileEntity_t &e = entities[entityNum];
+	if ( e.spawnId != spawnId ) {
+		memset( &e, 0, sizeof( e ) );
+		e.spawnId = spawnId;
+		e.typeNum = type->typeNum;
+	}
+	e.counters[category].ticks += ticks;
+	e.counters[category].calls++;
+	e.counters[category].traces += traces;
+}
+
+/*
+================
+idThinkProfiler::Print
+================
+*/
+void idThinkProfiler::Print( int rows ) const {
+	idList<thinkProfileSort_t> sorted;
+	thinkProfileSort_t s;
+	int i, j;
+
+	float numFrames = Max( frames, 1 );
+
+	for ( i = 0; i < classes.Num(); i++ ) {
+		s.index = i;
+		s.ticks = ThinkProfileTotal( classes[i].counters );
+		if ( s.ticks ) {
+			sorted.Append( s );
+		}
+	}
+	sorted.Sort( ThinkProfileSortCompare );
+
+	gameLocal.Printf( "%d frames, %d classes\n", frames, sorted.Num() );
+	gameLocal.Printf( "%-32s %9s %8s %8s %5s", "class", "total ms", "ms/frame", "peak ms", "over" );
+	for ( j = 0; j < THINKPROFILE_NUM; j++ ) {
+		gameLocal.Printf( " %8s %9s", thinkProfileCategoryNames[j], "ms" );
+	}
+	gameLocal.Printf( " %8s\n", "traces" );
+
+	for ( i = 0; i < sorted.Num() && i < rows; i++ ) {
+		const thinkProfileClass_t &c = classes[sorted[i].index];
+		double ms = Sys_GetPerformanceTimeMS( sorted[i].ticks );
+		gameLocal.Printf( "%-32s %9.2f %8.3f %8.3f %5d", idClass::GetType( sorted[i].index )->classname,
+			ms, ms / numFrames, Sys_GetPerformanceTimeMS( c.peakTicks ), c.overBudget );
+		for ( j = 0; j < THINKPROFILE_NUM; j++ ) {
+			gameLocal.Printf( " %8d %9.2f", c.counters[j].calls, Sys_GetPerformanceTimeMS( c.counters[j].ticks ) );
+		}
+		gameLocal.Printf( " %8d\n", ThinkProfileTraces( c.counters ) );
+	}
+
+	sorted.SetNum( 0, false );
+	for ( i = 0; i < entities.Num(); i++ ) {
+		if ( entities[i].spawnId == -1 ) {
+			continue;
+		}
+		s.index = i;
+		s.ticks = ThinkProfileTotal( entities[i].counters );
+		if ( s.ticks ) {
+			sorted.Append( s );
+		}
+	}
+	sorted.Sort( ThinkProfileSortCompare );
+
+	gameLocal.Printf( "\n%5s %-32s %-24s %9s", "num", "entity", "class", "total ms" );
+	for ( j = 0; j < THINKPROFILE_NUM; j++ ) {
+		gameLocal.Printf( " %8s %9s", thinkProfileCategoryNames[j], "ms" );
+	}
+	gameLocal.Printf( " %8s\n", "traces" );
+
+	for ( i = 0; i < sorted.Num() && i < rows; i++ ) {
+		int num = sorted[i].index;
+		const thinkProfileEntity_t &e = entities[num];
+		const idEntity *ent = gameLocal.entities[num];
+		const char *name = ( ent && gameLocal.spawnIds[num] == e.spawnId ) ? ent->name.c_str() : "<removed>";
+		gameLocal.Printf( "%5d %-32s %-24s %9.2f", num, name, idClass::GetType( e.typeNum )->classname, Sys_GetPerformanceTimeMS( sorted[i].ticks ) );
+		for ( j = 0; j < THINKPROFILE_NUM; j++ ) {
+			gameLocal.Printf( " %8d %9.2f", e.counters[j].calls, Sys_GetPerformanceTimeMS( e.counters[j].ticks ) );
+		}
+		gameLocal.Printf( " %8d\n", ThinkProfileTraces( e.counters ) );
+	}
+}
+
+/*
+================
+idThinkProfiler::WriteCSV
+================
+*/
+bool idThinkProfiler::WriteCSV( const char *fileName ) const {
+	idFile *f;
+	int i, j;
+
+	f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		gameLocal.Warning( "couldn't open %s", fileName );
+		return false;
+	}
+
+	f->Printf( "kind,num,name,class,total_ms,ms_per_frame,peak_ms,over_budget" );
+	for ( j = 0; j < THINKPROFILE_NUM; j++ ) {
+		f->Printf( ",%s_calls,%s_ms,%s_traces", thinkProfileCategoryNames[j], thinkProfileCategoryNames[j], thinkProfileCategoryNames[j] );
+	}
+	f->Printf( "\n" );
+
+	float numFrames = Max( frames, 1 );
+
+	for ( i = 0; i < classes.Num(); i++ ) {
+		const thinkProfileClass_t &c = classes[i];
+		uint64 ticks = ThinkProfileTotal( c.counters );
+		if ( !ticks ) {
+			continue;
+		}
+		const char *classname = idClass::GetType( i )->classname;
+		double ms = Sys_GetPerformanceTimeMS( ticks );
+		f->Printf( "class,%d,%s,%s,%.4f,%.4f,%.4f,%d", i, classname, classname, ms, ms / numFrames, Sys_GetPerformanceTimeMS( c.peakTicks ), c.overBudget );
+		for ( j = 0; j < THINKPROFILE_NUM; j++ ) {
+			f->Printf( ",%d,%.4f,%d", c.counters[j].calls, Sys_GetPerformanceTimeMS( c.counters[j].ticks ), c.counters[j].traces );
+		}
+		f->Printf( "\n" );
+	}
+
+	for ( i = 0; i < entities.Num(); i++ ) {
+		const thinkProfileEntity_t &e = entities[i];
+		if ( e.spawnId == -1 ) {
+			continue;
+		}
+		uint64 ticks = ThinkProfileTotal( e.counters );
+		if ( !ticks ) {
+			continue;
+		}
+		const idEntity *ent = gameLocal.entities[i];
+		const char *name = ( ent && gameLocal.spawnIds[i] == e.spawnId ) ? ent->name.c_str() : "<removed>";
+		double ms = Sys_GetPerformanceTimeMS( ticks );
+		f->Printf( "entity,%d,%s,%s,%.4f,%.4f,,", i, name, idClass::GetType( e.typeNum )->classname, ms, ms / numFrames );
+		for ( j = 0; j < THINKPROFILE_NUM; j++ ) {
+			f->Printf( ",%d,%.4f,%d", e.counters[j].calls, Sys_GetPerformanceTimeMS( e.counters[j].ticks ), e.counters[j].traces );
+		}
+		f->Printf( "\n" );
+	}
+
+	fileSystem->CloseFile( f );
+
+	gameLocal.Printf( "wrote think profile of %d frames to %s\n", frames, fileName );
+	return true;
+}
+
+/*
+================
+idThinkProfiler::ThinkProfile_f
+================
+*/
+void idThinkProfiler::ThinkProfile_f( const idCmdArgs &args ) {
+	idThinkProfiler &profile = gameLocal.thinkProfiler;
+
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "reset" ) ) {
+		profile.Reset();
+		return;
+	}
+
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "csv" ) ) {
+		profile.WriteCSV( args.Argc() > 2 ? args.Argv( 2 ) : DEFAULT_THINKPROFILE_FILE );
+		return;
+	}
+
+	if ( !profile.frames ) {
+		gameLocal.Printf( "no frames recorded, set g_thinkProfile 1\n" );
+		return;
+	}
+
+	int rows = DEFAULT_THINKPROFILE_ROWS;
+	if ( args.Argc() > 1 ) {
+		rows = atoi( args.Argv( 1 ) );
+		if ( rows <= 0 ) {
+			gameLocal.Printf( "usage: thinkProfile [rows, default %d | reset | csv [file]]\n", DEFAULT_THINKPROFILE_ROWS );
+			return;
+		}
+	}
+	profile.Print( rows );
+}
+
+/*
+================
+idThinkProfileScope::Start
+================
+*/
+void idThinkProfileScope::Start( thinkProfileCategory_t category, const idClass *obj ) {
+	// workers must not touch the shared counters, the parallel phase times its entities itself
+	if ( idParallelThink::IsDeferring() ) {
+		return;
+	}
+
+	this->category = category;
+	type = obj->GetType();
+	if ( obj->IsType( idEntity::Type ) ) {
+		entityNum = static_cast<const idEntity *>( obj )->entityNumber;
+		spawnId = gameLocal.spawnIds[entityNum];
+	} else {
+		entityNum = -1;
+		spawnId = -1;
+	}
+	parent = currentThinkScope;
+	childTicks = 0;
+	childTraces = 0;
+	currentThinkScope = this;
+	traces = gameLocal.clip.GetNumTraces();
+	start = Sys_GetPerformanceCounter();
+}
+
+/*
+================
+idThinkProfileScope::Stop
+================
+*/
+void idThinkProfileScope::Stop( void ) {
+	uint64 ticks = Sys_GetPerformanceCounter() - start;
+	// the clip statistics are reset when they are printed
+	int numTraces = Max( gameLocal.clip.GetNumTraces() - traces, 0 );
+
+	currentThinkScope = parent;
+	if ( parent ) {
+		parent->childTicks += ticks;
+		parent->childTraces += numTraces;
+	}
+
+	// nested scopes already counted their part
+	ticks = ( ticks > childTicks ) ? ticks - childTicks : 0;
+	numTraces = Max( numTraces - childTraces, 0 );
+	gameLocal.thinkProfiler.Add( category, type, entityNum, spawnId, ticks, numTraces );
+}
@@ -0,0 +1,160 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#ifndef __SYS_THINKPROFILER_H__
+#define __SYS_THINKPROFILER_H__
+
+#include "idlib/containers/List.h"
+
+/*
+===============================================================================
+
+	Think profiler.
+
+	With g_thinkProfile set the game accumulates the wall time, the number of
+	calls and the number of collision traces of Think, Present and the event
+	handlers per idTypeInfo and per entity. Classes are looked up through their
+	typeNum, so no class needs any code of its own to show up.
+
+	Present is timed in idEntity::Present after the early outs. Scopes nest, the
+	time and traces of a Present or event handler that runs inside of a Think are
+	only counted for the inner scope, so every category holds exclusive time and
+	the totals don't count anything twice. Entities that think in the parallel
+	phase are timed per entity on the worker, their traces are not counted
+	because the clip statistics are shared.
+
+	"thinkProfile" prints the classes and entities sorted by their total time
+	and writes them as CSV. g_thinkProfileBudget warns about every class that
+	uses more than the given number of milliseconds in a single frame.
+
+===============================================================================
+*/
+
+class idClass;
+class idTypeInfo;
+class idCmdArgs;
+
+typedef enum {
+	THINKPROFILE_THINK,
+	THINKPROFILE_PRESENT,
+	THINKPROFILE_EVENT,
+	THINKPROFILE_NUM
+} thinkProfileCategory_t;
+
+typedef struct thinkProfileCounter_s {
+	uint64					ticks;
+	int						calls;
+	int						traces;
+} thinkProfileCounter_t;
+
+typedef struct thinkProfileClass_s {
+	thinkProfileCounter_t	counters[THINKPROFILE_NUM];
+	uint64					frameTicks;			// all categories of the current frame
+	uint64					peakTicks;			// most expensive frame
+	int						overBudget;			// frames over g_thinkProfileBudget
+} thinkProfileClass_t;
+
+typedef struct thinkProfileEntity_s {
+	int						spawnId;			// -1 if the slot was not used since the last clear
+	int						typeNum;
+	thinkProfileCounter_t	counters[THINKPROFILE_NUM];
+} thinkProfileEntity_t;
+
+class idThinkProfiler {
+public:
+							idThinkProfiler( void );
+
+	// forgets the per entity counters, the class counters are kept over map changes
+	void					Clear( void );
+	// forgets everything
+	void					Reset( void );
+
+	// called by RunFrame around the think and event phase
+	void					BeginFrame( void );
+	void					EndFrame( void );
+
+	static bool				IsActive( void ) { return active; }
+
+	// only valid on the game thread
+	void					Add( thinkProfileCategory_t category, const idClass *obj, uint64 ticks, int traces );
+	void					Add( thinkProfileCategory_t category, const idTypeInfo *type, int entityNum, int spawnId, uint64 ticks, int traces );
+
+	static void				ThinkProfile_f( const idCmdArgs &args );
+
+private:
+	static bool				active;
+
+	idList<thinkProfileClass_t>		classes;		// indexed by idTypeInfo::typeNum
+	idList<thinkProfileEntity_t>	entities;		// indexed by entity number
+	idList<int>				frameClasses;			// classes with time in the current frame
+	int						frames;
+
+	void					Print( int rows ) const;
+	bool					WriteCSV( const char *fileName ) const;
+};
+
+/*
+===============================================================================
+
+	Times the enclosing block for the think profiler, the object may be
+	deleted before the scope ends. Only used on the game thread.
+
+===============================================================================
+*/
+
+class idThinkProfileScope {
+public:
+							idThinkProfileScope( thinkProfileCategory_t category, const idClass *obj ) {
+								type = NULL;
+								if ( idThinkProfiler::IsActive() ) {
+									Start( category, obj );
+								}
+							}
+							~idThinkProfileScope( void ) {
+								if ( type ) {
+									Stop();
+								}
+							}
+
+private:
+	thinkProfileCategory_t	category;
+	const idTypeInfo *		type;
+	int						entityNum;
+	int						spawnId;
+	int						traces;
+	uint64					start;
+	idThinkProfileScope *	parent;				// enclosing scope, its time excludes ours
+	uint64					childTicks;
+	int						childTraces;
+
+	void					Start( thinkProfileCategory_t category, const idClass *obj );
+	void					Stop( void );
+};
+
+#endif /* !__SYS_THINKPROFILER_H__ */
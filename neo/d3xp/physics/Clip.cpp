@@ -30,24 +30,41 @@ If you have questions concerning this license or the applicable additional terms
 #include "gamesys/SaveGame.h"
 #include "Entity.h"
 #include "Game_local.h"
+#include "Player.h"
+#include "gamesys/SysCvar.h"
+#include "framework/FileSystem.h"
 
 #include "physics/Clip.h"
 
-#define	MAX_SECTOR_DEPTH				12
-#define MAX_SECTORS						((1<<(MAX_SECTOR_DEPTH+1))-1)
+#if defined(__BLENDO_SIMD__)
+	#include <immintrin.h>
+	#define CLIP_SIMD_CELLS
+#elif defined(__GNUC__) && defined(__SSE2__)
+	#include <xmmintrin.h>
+	#define CLIP_SIMD_CELLS
+#endif
 
-typedef struct clipSector_s {
-	int						axis;		// -1 = leaf node
-	float					dist;
-	struct clipSector_s *	children[2];
-	struct clipLink_s *		clipLinks;
-} clipSector_t;
+#define	CLIP_GRID_DEPTH					12		// the world is split in half this many times along its longest cell axis
+#define CLIP_MAX_CELLS_PER_MODEL		32		// larger clip models go into the extra cell that every query tests
+
+/*
+  A clip cell keeps the clip models touching it in flat arrays. The bounds are
+  stored as six separate arrays so four models can be tested at once. The
+  capacity is a multiple of four so every array is 16 byte aligned and a query
+  may read up to the next multiple of four.
+*/
+typedef struct clipCell_s {
+	int						num;
+	int						max;
+	float *					bounds[6];	// mins x, y, z and maxs x, y, z of the absolute bounds
+	int *					contents;	// contents of the clip model, 0 when it is disabled
+	struct clipLink_s **	links;
+} clipCell_t;
 
 typedef struct clipLink_s {
 	idClipModel *			clipModel;
-	struct clipSector_s *	sector;
-	struct clipLink_s *		prevInSector;
-	struct clipLink_s *		nextInSector;
+	struct clipCell_s *		cell;
+	int						slot;		// index into the cell arrays
 	struct clipLink_s *		nextLink;
 } clipLink_t;
 
@@ -61,6 +78,11 @@ typedef struct trmCache_s {
 
 idVec3 vec3_boxEpsilon( CM_BOX_EPSILON, CM_BOX_EPSILON, CM_BOX_EPSILON );
 
+#define CLIP_TRACELOG_DIR				"tracelog"
+#define CLIP_TRACELOG_EXT				"trl"
+#define CLIP_TRACELOG_MAGIC				( ( 'T' << 24 ) | ( 'R' << 16 ) | ( 'L' << 8 ) | ' ' )
+#define CLIP_TRACELOG_VERSION			1
+
 idBlockAlloc<clipLink_t, 1024>	clipLinkAllocator;
 
 
@@ -226,6 +248,9 @@ bool idClipModel::LoadModel( const char *name ) {
 	if ( collisionModelHandle ) {
 		collisionModelManager->GetModelBounds( collisionModelHandle, bounds );
 		collisionModelManager->GetModelContents( collisionModelHandle, contents );
+		if ( clipLinks ) {
+			UpdateLinkedContents();
+		}
 		return true;
 	} else {
 		bounds.Zero();
@@ -528,16 +553,22 @@ idClipModel::Unlink
 */
 void idClipModel::Unlink( void ) {
 	clipLink_t *link;
+	clipCell_t *cell;
+	int last;
 
 	for ( link = clipLinks; link; link = clipLinks ) {
 		clipLinks = link->nextLink;
-		if ( link->prevInSector ) {
-			link->prevInSector->nextInSector = link->nextInSector;
-		} else {
-			link->sector->clipLinks = link->nextInSector;
-		}
-		if ( link->nextInSector ) {
-			link->nextInSector->prevInSector = link->prevInSector;
+
+		// move the last model of the cell into the free slot
+		cell = link->cell;
+		last = --cell->num;
+		if ( link->slot != last ) {
+			for ( int i = 0; i < 6; i++ ) {
+				cell->bounds[i][link->slot] = cell->bounds[i][last];
+			}
+			cell->contents[link->slot] = cell->contents[last];
+			cell->links[link->slot] = cell->links[last];
+			cell->links[link->slot]->slot = link->slot;
 		}
 		clipLinkAllocator.Free( link );
 	}
@@ -545,34 +576,58 @@ void idClipModel::Unlink( void ) {
 
 /*
 ===============
-idClipModel::Link_r
+idClipModel::LinkCell
 ===============
 */
-void idClipModel::Link_r( struct clipSector_s *node ) {
+void idClipModel::LinkCell( clipCell_t *cell ) {
 	clipLink_t *link;
 
-	while( node->axis != -1 ) {
-		if ( absBounds[0][node->axis] > node->dist ) {
-			node = node->children[0];
-		} else if ( absBounds[1][node->axis] < node->dist ) {
-			node = node->children[1];
-		} else {
-			Link_r( node->children[0] );
-			node = node->children[1];
+	if ( cell->num >= cell->max ) {
+		int newMax = cell->max ? cell->max * 2 : 8;
+		byte *block = (byte *)Mem_Alloc16( newMax * ( 7 * sizeof( float ) + sizeof( clipLink_t * ) ) );
+		float *newBounds = (float *)block;
+		int *newContents = (int *)( newBounds + 6 * newMax );
+		clipLink_t **newLinks = (clipLink_t **)( newContents + newMax );
+
+		for ( int i = 0; i < 6; i++ ) {
+			memcpy( newBounds + i * newMax, cell->bounds[i], cell->num * sizeof( float ) );
+		}
+		memcpy( newContents, cell->contents, cell->num * sizeof( int ) );
+		memcpy( newLinks, cell->links, cell->num * sizeof( clipLink_t * ) );
+		Mem_Free16( cell->bounds[0] );
+
+		for ( int i = 0; i < 6; i++ ) {
+			cell->bounds[i] = newBounds + i * newMax;
 		}
+		cell->contents = newContents;
+		cell->links = newLinks;
+		cell->max = newMax;
 	}
 
 	link = clipLinkAllocator.Alloc();
 	link->clipModel = this;
-	link->sector = node;
-	link->nextInSector = node->clipLinks;
-	link->prevInSector = NULL;
-	if ( node->clipLinks ) {
-		node->clipLinks->prevInSector = link;
-	}
-	node->clipLinks = link;
+	link->cell = cell;
+	link->slot = cell->num++;
 	link->nextLink = clipLinks;
 	clipLinks = link;
+
+	for ( int i = 0; i < 3; i++ ) {
+		cell->bounds[i][link->slot] = absBounds[0][i];
+		cell->bounds[3+i][link->slot] = absBounds[1][i];
+	}
+	cell->contents[link->slot] = enabled ? contents : 0;
+	cell->links[link->slot] = link;
+}
+
+/*
+===============
+idClipModel::UpdateLinkedContents
+===============
+*/
+void idClipModel::UpdateLinkedContents( void ) {
+	for ( clipLink_t *link = clipLinks; link; link = link->nextLink ) {
+		link->cell->contents[link->slot] = enabled ? contents : 0;
+	}
 }
 
 /*
@@ -610,7 +665,21 @@ void idClipModel::Link( idClip &clp ) {
 	absBounds[0] -= vec3_boxEpsilon;
 	absBounds[1] += vec3_boxEpsilon;
 
-	Link_r( clp.clipSectors );
+	int cellMins[3], cellMaxs[3];
+	clp.GetCellRange( absBounds, cellMins, cellMaxs );
+
+	if ( ( cellMaxs[0] - cellMins[0] + 1 ) * ( cellMaxs[1] - cellMins[1] + 1 ) * ( cellMaxs[2] - cellMins[2] + 1 ) > CLIP_MAX_CELLS_PER_MODEL ) {
+		LinkCell( &clp.clipCells[clp.numClipCells] );
+		return;
+	}
+
+	for ( int z = cellMins[2]; z <= cellMaxs[2]; z++ ) {
+		for ( int y = cellMins[1]; y <= cellMaxs[1]; y++ ) {
+			for ( int x = cellMins[0]; x <= cellMaxs[0]; x++ ) {
+				LinkCell( &clp.clipCells[ ( z * clp.clipCellDims[1] + y ) * clp.clipCellDims[0] + x ] );
+			}
+		}
+	}
 }
 
 /*
@@ -658,60 +727,44 @@ idClip::idClip
 ===============
 */
 idClip::idClip( void ) {
-	numClipSectors = 0;
-	clipSectors = NULL;
+	clipCells = NULL;
+	numClipCells = 0;
+	clipCellDims[0] = clipCellDims[1] = clipCellDims[2] = 0;
+	clipCellOrigin.Zero();
+	clipCellInvSize.Zero();
 	worldBounds.Zero();
 	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
+	tracePointsJobList = NULL;
+	traceLogMax = 0;
 }
 
 /*
 ===============
-idClip::CreateClipSectors_r
+ClipCellIndex
 
-Builds a uniformly subdivided tree for the given world size
+Clamps in float before the cast, out of range values don't fit in an int and NaN
+fails every compare, so it's put in cell 0
 ===============
 */
-clipSector_t *idClip::CreateClipSectors_r( const int depth, const idBounds &bounds, idVec3 &maxSector ) {
-	int				i;
-	clipSector_t	*anode;
-	idVec3			size;
-	idBounds		front, back;
-
-	anode = &clipSectors[idClip::numClipSectors];
-	idClip::numClipSectors++;
-
-	if ( depth == MAX_SECTOR_DEPTH ) {
-		anode->axis = -1;
-		anode->children[0] = anode->children[1] = NULL;
-
-		for ( i = 0; i < 3; i++ ) {
-			if ( bounds[1][i] - bounds[0][i] > maxSector[i] ) {
-				maxSector[i] = bounds[1][i] - bounds[0][i];
-			}
-		}
-		return anode;
-	}
-
-	size = bounds[1] - bounds[0];
-	if ( size[0] >= size[1] && size[0] >= size[2] ) {
-		anode->axis = 0;
-	} else if ( size[1] >= size[0] && size[1] >= size[2] ) {
-		anode->axis = 1;
-	} else {
-		anode->axis = 2;
+static ID_INLINE int ClipCellIndex( float cell, int dims ) {
+	if ( FLOAT_IS_NAN( cell ) && !FLOAT_IS_INF( cell ) ) {
+		return 0;
 	}
+	return (int)idMath::ClampFloat( 0.0f, (float)( dims - 1 ), cell );
+}
 
-	anode->dist = 0.5f * ( bounds[1][anode->axis] + bounds[0][anode->axis] );
-
-	front = bounds;
-	back = bounds;
-
-	front[0][anode->axis] = back[1][anode->axis] = anode->dist;
-
-	anode->children[0] = CreateClipSectors_r( depth+1, front, maxSector );
-	anode->children[1] = CreateClipSectors_r( depth+1, back, maxSector );
+/*
+===============
+idClip::GetCellRange
 
-	return anode;
+Returns the range of grid cells touched by the bounds, clamped to the grid
+===============
+*/
+void idClip::GetCellRange( const idBounds &bounds, int cellMins[3], int cellMaxs[3] ) const {
+	for ( int i = 0; i < 3; i++ ) {
+		cellMins[i] = ClipCellIndex( ( bounds[0][i] - clipCellOrigin[i] ) * clipCellInvSize[i], clipCellDims[i] );
+		cellMaxs[i] = ClipCellIndex( ( bounds[1][i] - clipCellOrigin[i] ) * clipCellInvSize[i], clipCellDims[i] );
+	}
 }
 
 /*
@@ -723,20 +776,39 @@ void idClip::Init( void ) {
 	cmHandle_t h;
 	idVec3 size, maxSector = vec3_origin;
 
-	// clear clip sectors
-	clipSectors = new clipSector_t[MAX_SECTORS];
-	memset( clipSectors, 0, MAX_SECTORS * sizeof( clipSector_t ) );
-	numClipSectors = 0;
 	touchCount = -1;
 	// get world map bounds
 	h = collisionModelManager->LoadModel( "worldMap", false );
 	collisionModelManager->GetModelBounds( h, worldBounds );
-	// create world sectors
-	CreateClipSectors_r( 0, worldBounds, maxSector );
 
+	// split the longest cell axis until the grid has 2^CLIP_GRID_DEPTH cells
 	size = worldBounds[1] - worldBounds[0];
+	clipCellDims[0] = clipCellDims[1] = clipCellDims[2] = 1;
+	for ( int i = 0; i < CLIP_GRID_DEPTH; i++ ) {
+		maxSector[0] = size[0] / clipCellDims[0];
+		maxSector[1] = size[1] / clipCellDims[1];
+		maxSector[2] = size[2] / clipCellDims[2];
+		if ( maxSector[0] >= maxSector[1] && maxSector[0] >= maxSector[2] ) {
+			clipCellDims[0] *= 2;
+		} else if ( maxSector[1] >= maxSector[0] && maxSector[1] >= maxSector[2] ) {
+			clipCellDims[1] *= 2;
+		} else {
+			clipCellDims[2] *= 2;
+		}
+	}
+	for ( int i = 0; i < 3; i++ ) {
+		maxSector[i] = size[i] / clipCellDims[i];
+		clipCellInvSize[i] = ( maxSector[i] > 0.0f ) ? 1.0f / maxSector[i] : 0.0f;
+	}
+	clipCellOrigin = worldBounds[0];
+
+	// clear clip cells
+	numClipCells = clipCellDims[0] * clipCellDims[1] * clipCellDims[2];
+	clipCells = new clipCell_t[numClipCells + 1];
+	memset( clipCells, 0, ( numClipCells + 1 ) * sizeof( clipCell_t ) );
+
 	gameLocal.DPrintf( "map bounds are (%1.1f, %1.1f, %1.1f)\n", size[0], size[1], size[2] );
-	gameLocal.DPrintf( "max clip sector is (%1.1f, %1.1f, %1.1f)\n", maxSector[0], maxSector[1], maxSector[2] );
+	gameLocal.DPrintf( "clip grid is %d x %d x %d, cell size (%1.1f, %1.1f, %1.1f)\n", clipCellDims[0], clipCellDims[1], clipCellDims[2], maxSector[0], maxSector[1], maxSector[2] );
 
 	// initialize a default clip model
 	defaultClipModel.LoadModel( idTraceModel( idBounds( idVec3( 0, 0, 0 ) ).Expand( 8 ) ) );
@@ -751,8 +823,14 @@ idClip::Shutdown
 ===============
 */
 void idClip::Shutdown( void ) {
-	delete[] clipSectors;
-	clipSectors = NULL;
+	if ( clipCells != NULL ) {
+		for ( int i = 0; i <= numClipCells; i++ ) {
+			Mem_Free16( clipCells[i].bounds[0] );
+		}
+		delete[] clipCells;
+		clipCells = NULL;
+	}
+	numClipCells = 0;
 
 	// free the trace model used for the temporaryClipModel
 	if ( temporaryClipModel.traceModelIndex != -1 ) {
@@ -767,13 +845,21 @@ void idClip::Shutdown( void ) {
 	}
 
 	clipLinkAllocator.Shutdown();
+
+	if ( tracePointsJobList != NULL ) {
+		jobSystem->FreeJobList( tracePointsJobList );
+		tracePointsJobList = NULL;
+	}
+	tracePointsJobs.Clear();
+	tracePointsSort.Clear();
+	tracePointsBatch.Clear();
+	tracePointsStarts.Clear();
+	tracePointsEnds.Clear();
+	tracePointsResults.Clear();
+	traceLog.Clear();
+	traceLogMax = 0;
 }
 
-/*
-====================
-idClip::ClipModelsTouchingBounds_r
-====================
-*/
 typedef struct listParms_s {
 	idBounds		bounds;
 	int				contentMask;
@@ -783,59 +869,67 @@ typedef struct listParms_s {
 	int				maxCount;
 } listParms_t;
 
-void idClip::ClipModelsTouchingBounds_r( const struct clipSector_s *node, listParms_t &parms ) const {
-
-	while( node->axis != -1 ) {
-		if ( parms.bounds[0][node->axis] > node->dist ) {
-			node = node->children[0];
-		} else if ( parms.bounds[1][node->axis] < node->dist ) {
-			node = node->children[1];
-		} else {
-			ClipModelsTouchingBounds_r( node->children[0], parms );
-			node = node->children[1];
+/*
+================
+idClip::ClipModelsTouchingCell
+================
+*/
+void idClip::ClipModelsTouchingCell( const clipCell_t *cell, listParms_t &parms ) const {
+	unsigned int touching;
+
+	for ( int first = 0; first < cell->num && parms.count < parms.maxCount; first += 4 ) {
+
+		// test the bounds of four clip models at once
+#if defined(CLIP_SIMD_CELLS)
+		__m128 in;
+		in = _mm_cmple_ps( _mm_load_ps( cell->bounds[0] + first ), _mm_set1_ps( parms.bounds[1][0] ) );
+		in = _mm_and_ps( in, _mm_cmple_ps( _mm_load_ps( cell->bounds[1] + first ), _mm_set1_ps( parms.bounds[1][1] ) ) );
+		in = _mm_and_ps( in, _mm_cmple_ps( _mm_load_ps( cell->bounds[2] + first ), _mm_set1_ps( parms.bounds[1][2] ) ) );
+		in = _mm_and_ps( in, _mm_cmpge_ps( _mm_load_ps( cell->bounds[3] + first ), _mm_set1_ps( parms.bounds[0][0] ) ) );
+		in = _mm_and_ps( in, _mm_cmpge_ps( _mm_load_ps( cell->bounds[4] + first ), _mm_set1_ps( parms.bounds[0][1] ) ) );
+		in = _mm_and_ps( in, _mm_cmpge_ps( _mm_load_ps( cell->bounds[5] + first ), _mm_set1_ps( parms.bounds[0][2] ) ) );
+		touching = _mm_movemask_ps( in );
+#else
+		touching = 0;
+		for ( int i = 0; i < 4; i++ ) {
+			const int n = first + i;
+			if (	cell->bounds[0][n] <= parms.bounds[1][0] &&
+					cell->bounds[1][n] <= parms.bounds[1][1] &&
+					cell->bounds[2][n] <= parms.bounds[1][2] &&
+					cell->bounds[3][n] >= parms.bounds[0][0] &&
+					cell->bounds[4][n] >= parms.bounds[0][1] &&
+					cell->bounds[5][n] >= parms.bounds[0][2] ) {
+				touching |= 1 << i;
+			}
 		}
-	}
-
-	// blendo eric: just check the parms.maxcount every iter before doing calc
-	// TODO this is an optimization target, quitting out early should be handled by callee more appropriately
-	for ( clipLink_t *link = node->clipLinks; link && parms.count < parms.maxCount; link = link->nextInSector ) {
-		idClipModel	*check = link->clipModel;
-
-		// if the clip model is enabled
-		if ( !check->enabled ) {
-			continue;
+#endif
+		// the tail beyond num holds stale data
+		if ( first + 4 > cell->num ) {
+			touching &= ( 1 << ( cell->num - first ) ) - 1;
 		}
 
-		// avoid duplicates in the list
-		if ( check->touchCount == touchCount ) {
-			continue;
-		}
+		for ( int i = 0; touching && parms.count < parms.maxCount; i++, touching >>= 1 ) {
+			if ( !( touching & 1 ) ) {
+				continue;
+			}
 
-		// if the clip model does not have any contents we are looking for
-		if ( !( check->contents & parms.contentMask ) || check->contents & parms.ignoreContentMask ) {
-			continue;
-		}
+			// if the clip model is disabled or does not have any contents we are looking for
+			const int contents = cell->contents[first + i];
+			if ( !( contents & parms.contentMask ) || contents & parms.ignoreContentMask ) {
+				continue;
+			}
 
-		// if the bounds really do overlap
-		if (	check->absBounds[0][0] > parms.bounds[1][0] ||
-				check->absBounds[1][0] < parms.bounds[0][0] ||
-				check->absBounds[0][1] > parms.bounds[1][1] ||
-				check->absBounds[1][1] < parms.bounds[0][1] ||
-				check->absBounds[0][2] > parms.bounds[1][2] ||
-				check->absBounds[1][2] < parms.bounds[0][2] ) {
-			continue;
-		}
+			idClipModel *check = cell->links[first + i]->clipModel;
 
-		//// blendo eric: the warning seems unnecessary, should also change calls to quit out early
-		//if ( parms.count >= parms.maxCount ) {
-		//
-		//	 gameLocal.Warning( "idClip::ClipModelsTouchingBounds_r: max count" ); 
-		//	return;
-		//}
+			// avoid duplicates in the list
+			if ( check->touchCount == touchCount ) {
+				continue;
+			}
 
-		check->touchCount = touchCount;
-		parms.list[parms.count] = check;
-		parms.count++;
+			check->touchCount = touchCount;
+			parms.list[parms.count] = check;
+			parms.count++;
+		}
 	}
 }
 
@@ -864,7 +958,21 @@ int idClip::ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, i
 	parms.maxCount = maxCount;
 
 	touchCount++;
-	ClipModelsTouchingBounds_r( clipSectors, parms );
+
+	// large clip models are not in the grid
+	ClipModelsTouchingCell( &clipCells[numClipCells], parms );
+
+	int cellMins[3], cellMaxs[3];
+	GetCellRange( parms.bounds, cellMins, cellMaxs );
+
+	for ( int z = cellMins[2]; z <= cellMaxs[2]; z++ ) {
+		for ( int y = cellMins[1]; y <= cellMaxs[1]; y++ ) {
+			const clipCell_t *cell = &clipCells[ ( z * clipCellDims[1] + y ) * clipCellDims[0] ];
+			for ( int x = cellMins[0]; x <= cellMaxs[0]; x++ ) {
+				ClipModelsTouchingCell( cell + x, parms );
+			}
+		}
+	}
 
 	return parms.count;
 }
@@ -900,6 +1008,38 @@ int idClip::EntitiesTouchingBounds( const idBounds &bounds, int contentMask, idE
 	return entCount;
 }
 
+/*
+====================
+GetPassOwner
+====================
+*/
+static const idEntity *GetPassOwner( const idEntity *passEntity ) {
+	if ( passEntity && passEntity->GetPhysics()->GetNumClipModels() > 0 ) {
+		return passEntity->GetPhysics()->GetClipModel()->GetOwner();
+	}
+	return NULL;
+}
+
+/*
+====================
+IsPassClipModel
+====================
+*/
+static bool IsPassClipModel( const idClipModel *cm, const idEntity *passEntity, const idEntity *passOwner ) {
+	if ( cm->GetEntity() == passEntity ) {
+		return true;			// don't clip against the pass entity
+	} else if ( cm->GetEntity() == passOwner ) {
+		return true;			// missiles don't clip with their owner
+	} else if ( cm->GetOwner() ) {
+		if ( cm->GetOwner() == passEntity ) {
+			return true;		// don't clip against own missiles
+		} else if ( cm->GetOwner() == passOwner ) {
+			return true;		// don't clip against other missiles from same owner
+		}
+	}
+	return false;
+}
+
 /*
 ====================
 idClip::GetTraceClipModels
@@ -913,8 +1053,7 @@ idClip::GetTraceClipModels
 */
 int idClip::GetTraceClipModels( const idBounds &bounds, int contentMask, const idEntity *passEntity, idClipModel **clipModelList, int ignoreContentMask ) const {
 	int i, num;
-	idClipModel	*cm;
-	idEntity *passOwner;
+	const idEntity *passOwner;
 
 	num = ClipModelsTouchingBounds( bounds, contentMask, clipModelList, MAX_GENTITIES, ignoreContentMask );
 
@@ -922,27 +1061,12 @@ int idClip::GetTraceClipModels( const idBounds &bounds, int contentMask, const i
 		return num;
 	}
 
-	if ( passEntity->GetPhysics()->GetNumClipModels() > 0 ) {
-		passOwner = passEntity->GetPhysics()->GetClipModel()->GetOwner();
-	} else {
-		passOwner = NULL;
-	}
+	passOwner = GetPassOwner( passEntity );
 
 	for ( i = 0; i < num; i++ ) {
-
-		cm = clipModelList[i];
-
 		// check if we should ignore this entity
-		if ( cm->GetEntity() == passEntity ) {
-			clipModelList[i] = NULL;			// don't clip against the pass entity
-		} else if ( cm->GetEntity() == passOwner ) {
-			clipModelList[i] = NULL;			// missiles don't clip with their owner
-		} else if ( cm->GetOwner() ) {
-			if ( cm->GetOwner() == passEntity ) {
-				clipModelList[i] = NULL;		// don't clip against own missiles
-			} else if ( cm->GetOwner() == passOwner ) {
-				clipModelList[i] = NULL;		// don't clip against other missiles from same owner
-			}
+		if ( IsPassClipModel( clipModelList[i], passEntity, passOwner ) ) {
+			clipModelList[i] = NULL;
 		}
 	}
 
@@ -1112,6 +1236,10 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 		return true;
 	}
 
+	if ( traceLogMax > 0 && mdl == NULL ) {
+		LogTracePoint( start, end, contentMask, passEntity, ignoreContentMask );
+	}
+
 	trm = TraceModelForClipModel( mdl );
 
 	if ( !passEntity || passEntity->entityNumber != ENTITYNUM_WORLD ) {
@@ -1168,6 +1296,427 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 	return ( results.fraction < 1.0f );
 }
 
+/*
+============
+TracePointsWorldJob
+============
+*/
+static void TracePointsWorldJob( void *data ) {
+	const tracePointsJob_t *job = ( const tracePointsJob_t * )data;
+
+	collisionModelManager->TranslationPoints( job->results, job->starts, job->ends, job->numPoints, job->contentMask,
+												0, vec3_origin, mat3_default, job->ignoreContentMask );
+}
+
+/*
+============
+idClip::TracePointsWorld
+
+  traces the points against the world, large batches are split over the job workers
+============
+*/
+void idClip::TracePointsWorld( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numPoints, int contentMask, int ignoreContentMask ) {
+	int jobSize = g_tracePointsJobSize.GetInteger();
+
+	idClip::numTranslations += numPoints;
+
+	// nested batches from inside a job are traced right away
+	if ( jobSize <= 0 || numPoints < 2 * jobSize || jobSystem->GetNumWorkers() == 0 || jobSystem->GetThreadIndex() != -1 ) {
+		collisionModelManager->TranslationPoints( results, starts, ends, numPoints, contentMask, 0, vec3_origin, mat3_default, ignoreContentMask );
+		return;
+	}
+
+	if ( tracePointsJobList == NULL ) {
+		tracePointsJobList = jobSystem->AllocJobList( "tracePoints" );
+	}
+
+	tracePointsJobs.SetNum( ( numPoints + jobSize - 1 ) / jobSize, false );
+	tracePointsJobList->Clear();
+	for ( int i = 0; i < tracePointsJobs.Num(); i++ ) {
+		tracePointsJob_t &job = tracePointsJobs[i];
+		job.results = results + i * jobSize;
+		job.starts = starts + i * jobSize;
+		job.ends = ends + i * jobSize;
+		job.numPoints = Min( jobSize, numPoints - i * jobSize );
+		job.contentMask = contentMask;
+		job.ignoreContentMask = ignoreContentMask;
+		tracePointsJobList->AddJob( TracePointsWorldJob, &job, "tracePoints" );
+	}
+	tracePointsJobList->Submit();
+	tracePointsJobList->Wait();
+}
+
+/*
+============
+TracePointsSortCompare
+============
+*/
+static int TracePointsSortCompare( const tracePointsSort_t *a, const tracePointsSort_t *b ) {
+	if ( a->cells[0] != b->cells[0] ) {
+		return a->cells[0] - b->cells[0];
+	}
+	if ( a->cells[1] != b->cells[1] ) {
+		return a->cells[1] - b->cells[1];
+	}
+	return a->index - b->index;
+}
+
+/*
+============
+idClip::TracePoints
+============
+*/
+int idClip::TracePoints( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numPoints,
+						int contentMask, const idEntity *passEntity, int ignoreContentMask ) {
+	return TracePointsInternal( results, starts, ends, numPoints, contentMask, passEntity, NULL, ignoreContentMask );
+}
+
+/*
+============
+idClip::TracePoints
+============
+*/
+int idClip::TracePoints( trace_t *results, const idVec3 *starts, const idVec3 *ends, const idEntity * const *passEntities, int numPoints,
+						int contentMask, int ignoreContentMask ) {
+	return TracePointsInternal( results, starts, ends, numPoints, contentMask, NULL, passEntities, ignoreContentMask );
+}
+
+/*
+============
+idClip::TracePointsInternal
+
+  The world is traced with the batched collision model point traces. The points
+  are then grouped by the range of clip cells their trace bounds touch,
+  the clip models are gathered once for each group and every clip model traces
+  all points of the group that touch it in one batch.
+  With a pass entity per point the clip models of the pass entities are removed
+  per point instead of per group.
+============
+*/
+int idClip::TracePointsInternal( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numPoints, int contentMask,
+						const idEntity *passEntity, const idEntity * const *passEntities, int ignoreContentMask ) {
+	int i, j, k, num, numHits;
+	idClipModel *touch, *clipModelList[MAX_GENTITIES];
+	idBounds groupBounds;
+	trace_t trace;
+
+	if ( numPoints <= 0 ) {
+		return 0;
+	}
+
+	if ( !passEntity || passEntity->entityNumber != ENTITYNUM_WORLD ) {
+		// test world
+		TracePointsWorld( results, starts, ends, numPoints, contentMask, ignoreContentMask );
+
+		for ( i = 0; i < numPoints; i++ ) {
+			// position tests are not batched
+			if ( starts[i] == ends[i] ) {
+				collisionModelManager->Translation( &results[i], starts[i], ends[i], NULL, mat3_identity, contentMask, 0, vec3_origin, mat3_default, ignoreContentMask );
+			}
+			results[i].c.entityNum = results[i].fraction != 1.0f ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+		}
+	} else {
+		for ( i = 0; i < numPoints; i++ ) {
+			memset( &results[i], 0, sizeof( results[i] ) );
+			results[i].fraction = 1.0f;
+			results[i].endpos = ends[i];
+			results[i].endAxis = mat3_identity;
+		}
+	}
+
+	// find the clip sector of every point that is not blocked immediately by the world
+	tracePointsSort.SetNum( 0, false );
+	for ( i = 0; i < numPoints; i++ ) {
+		if ( results[i].fraction == 0.0f ) {
+			continue;
+		}
+		tracePointsSort_t &sort = tracePointsSort.Alloc();
+		sort.index = i;
+		sort.bounds.FromPointTranslation( starts[i], results[i].endpos - starts[i] );
+		if ( passEntities ) {
+			sort.passEntity = passEntities[i];
+			sort.passOwner = GetPassOwner( passEntities[i] );
+		} else {
+			sort.passEntity = NULL;
+			sort.passOwner = NULL;
+		}
+
+		int cellMins[3], cellMaxs[3];
+		GetCellRange( idBounds( sort.bounds[0] - vec3_boxEpsilon, sort.bounds[1] + vec3_boxEpsilon ), cellMins, cellMaxs );
+		sort.cells[0] = ( cellMins[2] * clipCellDims[1] + cellMins[1] ) * clipCellDims[0] + cellMins[0];
+		sort.cells[1] = ( cellMaxs[2] * clipCellDims[1] + cellMaxs[1] ) * clipCellDims[0] + cellMaxs[0];
+	}
+	tracePointsSort.Sort( TracePointsSortCompare );
+
+	for ( i = 0; i < tracePointsSort.Num(); i = j ) {
+
+		groupBounds = tracePointsSort[i].bounds;
+		for ( j = i + 1; j < tracePointsSort.Num() && tracePointsSort[j].cells[0] == tracePointsSort[i].cells[0] && tracePointsSort[j].cells[1] == tracePointsSort[i].cells[1]; j++ ) {
+			groupBounds.AddBounds( tracePointsSort[j].bounds );
+		}
+
+		num = GetTraceClipModels( groupBounds, contentMask, passEntity, clipModelList, ignoreContentMask );
+
+		for ( k = 0; k < num; k++ ) {
+			touch = clipModelList[k];
+
+			if ( !touch ) {
+				continue;
+			}
+
+			// gather the points of the group that touch this clip model
+			tracePointsBatch.SetNum( 0, false );
+			for ( int n = i; n < j; n++ ) {
+				const tracePointsSort_t &sort = tracePointsSort[n];
+				if ( results[sort.index].fraction == 0.0f ) {
+					continue;
+				}
+				if (	touch->absBounds[0][0] > sort.bounds[1][0] + CM_BOX_EPSILON ||
+						touch->absBounds[1][0] < sort.bounds[0][0] - CM_BOX_EPSILON ||
+						touch->absBounds[0][1] > sort.bounds[1][1] + CM_BOX_EPSILON ||
+						touch->absBounds[1][1] < sort.bounds[0][1] - CM_BOX_EPSILON ||
+						touch->absBounds[0][2] > sort.bounds[1][2] + CM_BOX_EPSILON ||
+						touch->absBounds[1][2] < sort.bounds[0][2] - CM_BOX_EPSILON ) {
+					continue;
+				}
+				if ( sort.passEntity && IsPassClipModel( touch, sort.passEntity, sort.passOwner ) ) {
+					continue;
+				}
+				tracePointsBatch.Append( sort.index );
+			}
+			if ( tracePointsBatch.Num() == 0 ) {
+				continue;
+			}
+
+			if ( touch->renderModelHandle != -1 ) {
+				for ( int n = 0; n < tracePointsBatch.Num(); n++ ) {
+					int index = tracePointsBatch[n];
+					idClip::numRenderModelTraces++;
+					TraceRenderModel( trace, starts[index], ends[index], 0.0f, mat3_identity, touch );
+					if ( trace.fraction < results[index].fraction ) {
+						results[index] = trace;
+						results[index].c.entityNum = touch->GetEntity()->entityNumber;
+						results[index].c.id = touch->id;
+					}
+				}
+				continue;
+			}
+
+			tracePointsStarts.SetNum( tracePointsBatch.Num(), false );
+			tracePointsEnds.SetNum( tracePointsBatch.Num(), false );
+			tracePointsResults.SetNum( tracePointsBatch.Num(), false );
+			for ( int n = 0; n < tracePointsBatch.Num(); n++ ) {
+				tracePointsStarts[n] = starts[tracePointsBatch[n]];
+				tracePointsEnds[n] = ends[tracePointsBatch[n]];
+			}
+
+			idClip::numTranslations += tracePointsBatch.Num();
+			collisionModelManager->TranslationPoints( tracePointsResults.Ptr(), tracePointsStarts.Ptr(), tracePointsEnds.Ptr(), tracePointsBatch.Num(),
+														contentMask, touch->Handle(), touch->origin, touch->axis, ignoreContentMask );
+
+			for ( int n = 0; n < tracePointsBatch.Num(); n++ ) {
+				int index = tracePointsBatch[n];
+				if ( starts[index] == ends[index] ) {
+					collisionModelManager->Translation( &tracePointsResults[n], starts[index], ends[index], NULL, mat3_identity, contentMask,
+														touch->Handle(), touch->origin, touch->axis, ignoreContentMask );
+				}
+				if ( tracePointsResults[n].fraction < results[index].fraction ) {
+					results[index] = tracePointsResults[n];
+					results[index].c.entityNum = touch->GetEntity()->entityNumber;
+					results[index].c.id = touch->id;
+				}
+			}
+		}
+	}
+
+	numHits = 0;
+	for ( i = 0; i < numPoints; i++ ) {
+		if ( results[i].fraction < 1.0f ) {
+			numHits++;
+		}
+	}
+	return numHits;
+}
+
+/*
+============
+idClip::LogTracePoint
+============
+*/
+void idClip::LogTracePoint( const idVec3 &start, const idVec3 &end, int contentMask, const idEntity *passEntity, int ignoreContentMask ) {
+	clipTraceLog_t &entry = traceLog.Alloc();
+	entry.start = start;
+	entry.end = end;
+	entry.contentMask = contentMask;
+	entry.ignoreContentMask = ignoreContentMask;
+	entry.passEntityNum = passEntity ? passEntity->entityNumber : -1;
+
+	if ( traceLog.Num() < traceLogMax ) {
+		return;
+	}
+
+	// done recording
+	traceLogMax = 0;
+
+	idStr fileName = gameLocal.GetMapNameStripped();
+	fileName.StripPath();
+	fileName = va( "%s/%s.%s", CLIP_TRACELOG_DIR, fileName.c_str(), CLIP_TRACELOG_EXT );
+
+	idFile_Memory file( fileName );
+	file.WriteInt( CLIP_TRACELOG_MAGIC );
+	file.WriteInt( CLIP_TRACELOG_VERSION );
+	file.WriteInt( traceLog.Num() );
+	for ( int i = 0; i < traceLog.Num(); i++ ) {
+		file.WriteVec3( traceLog[i].start );
+		file.WriteVec3( traceLog[i].end );
+		file.WriteInt( traceLog[i].contentMask );
+		file.WriteInt( traceLog[i].ignoreContentMask );
+		file.WriteInt( traceLog[i].passEntityNum );
+	}
+	fileSystem->WriteFile( fileName, file.GetDataPtr(), file.Length() );
+
+	gameLocal.Printf( "wrote %d point traces to %s\n", traceLog.Num(), fileName.c_str() );
+	traceLog.Clear();
+}
+
+/*
+============
+idClip::RecordTracePoints_f
+============
+*/
+void idClip::RecordTracePoints_f( const idCmdArgs &args ) {
+	int count = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 10000;
+
+	if ( !gameLocal.GetLocalPlayer() ) {
+		gameLocal.Printf( "recordTracePoints: no map loaded\n" );
+		return;
+	}
+
+	gameLocal.clip.traceLog.Clear();
+	gameLocal.clip.traceLog.Resize( Max( count, 1 ) );
+	gameLocal.clip.traceLogMax = Max( count, 1 );
+	gameLocal.Printf( "recording the next %d point traces\n", gameLocal.clip.traceLogMax );
+}
+
+/*
+============
+idClip::TestTracePoints_f
+
+  replays the point traces recorded with recordTracePoints, or rays around the player
+  if there are none, with TracePoint and with TracePoints and compares the results
+============
+*/
+void idClip::TestTracePoints_f( const idCmdArgs &args ) {
+	idList<clipTraceLog_t> log;
+	idList<idVec3> starts, ends;
+	idList<trace_t> single, batched;
+	idStr fileName;
+	void *buffer;
+	int length, batchSize, jobSize, numMismatches;
+	uint64 startTime;
+	double msSingle, msBatched, msJobs;
+	idPlayer *player = gameLocal.GetLocalPlayer();
+
+	if ( !player ) {
+		gameLocal.Printf( "testTracePoints: no map loaded\n" );
+		return;
+	}
+
+	batchSize = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 1 ) : 1024;
+
+	fileName = gameLocal.GetMapNameStripped();
+	fileName.StripPath();
+	fileName = va( "%s/%s.%s", CLIP_TRACELOG_DIR, fileName.c_str(), CLIP_TRACELOG_EXT );
+
+	length = fileSystem->ReadFile( fileName, &buffer, NULL );
+	if ( length > 0 && buffer != NULL ) {
+		idFile_Memory file( fileName, ( const char * )buffer, length );
+		int magic, version, num;
+		file.ReadInt( magic );
+		file.ReadInt( version );
+		file.ReadInt( num );
+		if ( magic == CLIP_TRACELOG_MAGIC && version == CLIP_TRACELOG_VERSION && num > 0 && length == file.Tell() + num * 36 ) {
+			log.SetNum( num );
+			for ( int i = 0; i < num; i++ ) {
+				file.ReadVec3( log[i].start );
+				file.ReadVec3( log[i].end );
+				file.ReadInt( log[i].contentMask );
+				file.ReadInt( log[i].ignoreContentMask );
+				file.ReadInt( log[i].passEntityNum );
+			}
+		}
+		fileSystem->FreeFile( buffer );
+	}
+
+	if ( log.Num() ) {
+		gameLocal.Printf( "testTracePoints: replaying %d point traces from %s\n", log.Num(), fileName.c_str() );
+	} else {
+		idRandom random( 0 );
+		const idVec3 eye = player->GetEyePosition();
+		log.SetNum( 8192 );
+		for ( int i = 0; i < log.Num(); i++ ) {
+			idVec3 dir( random.CRandomFloat(), random.CRandomFloat(), random.CRandomFloat() * 0.25f );
+			dir.Normalize();
+			log[i].start = eye;
+			log[i].end = eye + dir * 2048.0f;
+			log[i].contentMask = MASK_SOLID;
+			log[i].ignoreContentMask = 0;
+			log[i].passEntityNum = player->entityNumber;
+		}
+		gameLocal.Printf( "testTracePoints: no %s, tracing %d rays around the player\n", fileName.c_str(), log.Num() );
+	}
+
+	starts.SetNum( log.Num() );
+	ends.SetNum( log.Num() );
+	single.SetNum( log.Num() );
+	batched.SetNum( log.Num() );
+	for ( int i = 0; i < log.Num(); i++ ) {
+		starts[i] = log[i].start;
+		ends[i] = log[i].end;
+	}
+
+	// one by one
+	startTime = Sys_GetPerformanceCounter();
+	for ( int i = 0; i < log.Num(); i++ ) {
+		const idEntity *pass = ( log[i].passEntityNum >= 0 && log[i].passEntityNum < MAX_GENTITIES ) ? gameLocal.entities[log[i].passEntityNum] : NULL;
+		gameLocal.clip.Translation( single[i], starts[i], ends[i], NULL, mat3_identity, log[i].contentMask, pass, log[i].ignoreContentMask );
+	}
+	msSingle = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+
+	// batches of consecutive traces with the same parameters
+	jobSize = g_tracePointsJobSize.GetInteger();
+	for ( int pass = 0; pass < 2; pass++ ) {
+		g_tracePointsJobSize.SetInteger( pass == 0 ? 0 : Max( jobSize, 1 ) );
+
+		startTime = Sys_GetPerformanceCounter();
+		for ( int i = 0, j; i < log.Num(); i = j ) {
+			for ( j = i + 1; j < log.Num() && j - i < batchSize && log[j].contentMask == log[i].contentMask &&
+					log[j].ignoreContentMask == log[i].ignoreContentMask && log[j].passEntityNum == log[i].passEntityNum; j++ ) {
+			}
+			const idEntity *passEnt = ( log[i].passEntityNum >= 0 && log[i].passEntityNum < MAX_GENTITIES ) ? gameLocal.entities[log[i].passEntityNum] : NULL;
+			gameLocal.clip.TracePoints( &batched[i], &starts[i], &ends[i], j - i, log[i].contentMask, passEnt, log[i].ignoreContentMask );
+		}
+		if ( pass == 0 ) {
+			msBatched = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+		} else {
+			msJobs = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+		}
+	}
+	g_tracePointsJobSize.SetInteger( jobSize );
+
+	numMismatches = 0;
+	for ( int i = 0; i < log.Num(); i++ ) {
+		if ( single[i].fraction != batched[i].fraction || single[i].c.entityNum != batched[i].c.entityNum ) {
+			numMismatches++;
+		}
+	}
+
+	gameLocal.Printf( "  TracePoint:             %8.2f ms, %7.4f us per trace\n", msSingle, msSingle * 1000.0 / log.Num() );
+	gameLocal.Printf( "  TracePoints (%4d):     %8.2f ms, %7.4f us per trace (%.2fx)\n", batchSize, msBatched, msBatched * 1000.0 / log.Num(), msSingle / Max( msBatched, 0.001 ) );
+	gameLocal.Printf( "  TracePoints + %2d jobs:  %8.2f ms, %7.4f us per trace (%.2fx)\n", jobSystem->GetNumWorkers(), msJobs, msJobs * 1000.0 / log.Num(), msSingle / Max( msJobs, 0.001 ) );
+	gameLocal.Printf( "  %d mismatching results\n", numMismatches );
+}
+
 /*
 ============
 idClip::Rotation
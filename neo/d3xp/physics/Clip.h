@@ -34,6 +34,8 @@ If you have questions concerning this license or the applicable additional terms
 
 class idSaveGame;
 class idRestoreGame;
+class idCmdArgs;
+class idJobList;
 
 /*
 ===============================================================================
@@ -129,11 +131,12 @@ private:
 	int						traceModelIndex;		// trace model used for collision detection
 	int						renderModelHandle;		// render model def handle
 
-	struct clipLink_s *		clipLinks;				// links into sectors
+	struct clipLink_s *		clipLinks;				// links into clip cells
 	int						touchCount;
 
 	void					Init( void );			// initialize
-	void					Link_r( struct clipSector_s *node );
+	void					LinkCell( struct clipCell_s *cell );
+	void					UpdateLinkedContents( void );	// copy enabled and contents into the clip cells
 
 	static int				AllocTraceModel( const idTraceModel &trm );
 	static void				FreeTraceModel( int traceModelIndex );
@@ -155,10 +158,16 @@ ID_INLINE void idClipModel::Rotate( const idRotation &rotation ) {
 
 ID_INLINE void idClipModel::Enable( void ) {
 	enabled = true;
+	if ( clipLinks ) {
+		UpdateLinkedContents();
+	}
 }
 
 ID_INLINE void idClipModel::Disable( void ) {
 	enabled = false;
+	if ( clipLinks ) {
+		UpdateLinkedContents();
+	}
 }
 
 ID_INLINE void idClipModel::SetMaterial( const idMaterial *m ) {
@@ -171,6 +180,9 @@ ID_INLINE const idMaterial * idClipModel::GetMaterial( void ) const {
 
 ID_INLINE void idClipModel::SetContents( int newContents ) {
 	contents = newContents;
+	if ( clipLinks ) {
+		UpdateLinkedContents();
+	}
 }
 
 ID_INLINE int idClipModel::GetContents( void ) const {
@@ -230,6 +242,31 @@ ID_INLINE const idTraceModel *idClipModel::GetTraceModel( void ) const {
 }
 
 
+typedef struct tracePointsJob_s {
+	trace_t *				results;
+	const idVec3 *			starts;
+	const idVec3 *			ends;
+	int						numPoints;
+	int						contentMask;
+	int						ignoreContentMask;
+} tracePointsJob_t;
+
+typedef struct tracePointsSort_s {
+	int						cells[2];		// first and last clip cell touched by the trace bounds
+	int						index;
+	idBounds				bounds;
+	const idEntity *		passEntity;		// only set for traces with a pass entity per point
+	const idEntity *		passOwner;
+} tracePointsSort_t;
+
+typedef struct clipTraceLog_s {
+	idVec3					start;
+	idVec3					end;
+	int						contentMask;
+	int						ignoreContentMask;
+	int						passEntityNum;
+} clipTraceLog_t;
+
 //===============================================================
 //
 //	idClip
@@ -265,6 +302,13 @@ public:
 	bool					TraceBounds( trace_t &results, const idVec3 &start, const idVec3 &end, const idBounds &bounds,
 								int contentMask, const idEntity *passEntity, int ignoreContentMask = 0, const idMat3 &trmAxis = mat3_identity );
 
+	// batched point traces, same results as calling TracePoint for each point, returns the number of points that hit something
+	int						TracePoints( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numPoints,
+								int contentMask, const idEntity *passEntity, int ignoreContentMask = 0 );
+							// same as above but every point has its own pass entity
+	int						TracePoints( trace_t *results, const idVec3 *starts, const idVec3 *ends, const idEntity * const *passEntities, int numPoints,
+								int contentMask, int ignoreContentMask = 0 );
+
 	// clip versus a specific model
 	void					TranslationModel( trace_t &results, const idVec3 &start, const idVec3 &end,
 								const idClipModel *mdl, const idMat3 &trmAxis, int contentMask,
@@ -295,12 +339,18 @@ public:
 
 							// stats and debug drawing
 	void					PrintStatistics( void );
+	int						GetNumTraces( void ) const;		// translations, rotations and render model traces since the last PrintStatistics
+	static void				RecordTracePoints_f( const idCmdArgs &args );
+	static void				TestTracePoints_f( const idCmdArgs &args );
 	void					DrawClipModels( const idVec3 &eye, const float radius, const idEntity *passEntity );
 	bool					DrawModelContactFeature( const contactInfo_t &contact, const idClipModel *clipModel, int lifetime ) const;
 
 private:
-	int						numClipSectors;
-	struct clipSector_s *	clipSectors;
+	struct clipCell_s *		clipCells;				// uniform grid over the world, plus one cell for large clip models
+	int						numClipCells;
+	int						clipCellDims[3];
+	idVec3					clipCellOrigin;
+	idVec3					clipCellInvSize;
 	idBounds				worldBounds;
 	idClipModel				temporaryClipModel;
 	idClipModel				defaultClipModel;
@@ -312,13 +362,28 @@ private:
 	int						numRenderModelTraces;
 	int						numContents;
 	int						numContacts;
+							// batched point traces
+	idJobList *				tracePointsJobList;
+	idList<tracePointsJob_t>	tracePointsJobs;
+	idList<tracePointsSort_t>	tracePointsSort;
+	idList<int>				tracePointsBatch;
+	idList<idVec3>			tracePointsStarts;
+	idList<idVec3>			tracePointsEnds;
+	idList<trace_t>			tracePointsResults;
+							// point traces recorded for testTracePoints
+	idList<clipTraceLog_t>	traceLog;
+	int						traceLogMax;
 
 private:
-	struct clipSector_s *	CreateClipSectors_r( const int depth, const idBounds &bounds, idVec3 &maxSector );
-	void					ClipModelsTouchingBounds_r( const struct clipSector_s *node, struct listParms_s &parms ) const;
+	void					GetCellRange( const idBounds &bounds, int cellMins[3], int cellMaxs[3] ) const;
+	void					ClipModelsTouchingCell( const struct clipCell_s *cell, struct listParms_s &parms ) const;
 	const idTraceModel *	TraceModelForClipModel( const idClipModel *mdl ) const;
 	int						GetTraceClipModels( const idBounds &bounds, int contentMask, const idEntity *passEntity, idClipModel **clipModelList, int ignoreContentMask ) const;
 	void					TraceRenderModel( trace_t &trace, const idVec3 &start, const idVec3 &end, const float radius, const idMat3 &axis, idClipModel *touch ) const;
+	void					TracePointsWorld( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numPoints, int contentMask, int ignoreContentMask );
+	int						TracePointsInternal( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numPoints, int contentMask,
+								const idEntity *passEntity, const idEntity * const *passEntities, int ignoreContentMask );
+	void					LogTracePoint( const idVec3 &start, const idVec3 &end, int contentMask, const idEntity *passEntity, int ignoreContentMask );
 };
 
 
@@ -341,4 +406,8 @@ ID_INLINE idClipModel *idClip::DefaultClipModel( void ) {
 	return &defaultClipModel;
 }
 
+ID_INLINE int idClip::GetNumTraces( void ) const {
+	return numTranslations + numRotations + numRenderModelTraces;
+}
+
 #endif /* !__CLIP_H__ */
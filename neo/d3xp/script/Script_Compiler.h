@@ -198,6 +198,32 @@ enum {
 	NUM_OPCODES
 };
 
+// superinstructions replace the first statement of a common sequence in the code built by
+// idProgram::BuildCode, the statements they cover stay in place so jumps into them still work
+enum {
+	// compare followed by OP_IFNOT on its result
+	OP_LT_IFNOT = NUM_OPCODES,
+	OP_LE_IFNOT,
+	OP_GT_IFNOT,
+	OP_GE_IFNOT,
+	OP_EQ_F_IFNOT,
+	OP_NE_F_IFNOT,
+
+	// OP_INDIRECT_F followed by a compare of the field and OP_IFNOT on its result
+	OP_INDIRECT_F_LT_IFNOT,
+	OP_INDIRECT_F_LE_IFNOT,
+	OP_INDIRECT_F_GT_IFNOT,
+	OP_INDIRECT_F_GE_IFNOT,
+	OP_INDIRECT_F_EQ_F_IFNOT,
+	OP_INDIRECT_F_NE_F_IFNOT,
+
+	// pushes of constants followed by the call of an event
+	OP_EVENTCALL_CONST,
+	OP_SYSCALL_CONST,
+
+	NUM_SCRIPT_OPS
+};
+
 class idCompiler {
 private:
 	static bool		punctuationValid[ 256 ];
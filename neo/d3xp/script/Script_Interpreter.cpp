@@ -168,6 +168,7 @@ void idInterpreter::Reset( void ) {
 	popParms = 0;
 	multiFrameEvent = NULL;
 	eventEntity = NULL;
+	executedInstructions = 0;
 
 	currentFunction = 0;
 	NextInstruction( 0 );
@@ -930,9 +931,87 @@ void idInterpreter::CallSysEvent( const function_t *func, int argsize ) {
 	popParms = 0;
 }
 
+/*
+====================
+CodeOperand
+
+frame[ 0 ] is zero for global variables and constants, frame[ 1 ] is the local stack of the current function
+====================
+*/
+static ID_INLINE varEval_t CodeOperand( const intptr_t *frame, int frameNum, intptr_t value ) {
+	varEval_t var;
+
+	var.bytePtr = ( byte * )( frame[ frameNum ] + value );
+	return var;
+}
+
+// gcc and clang jump from the end of every instruction straight to the next one through a
+// table of label addresses, other compilers go through the switch
+#if defined( __GNUC__ ) && !defined( ID_SCRIPT_SWITCH_DISPATCH )
+#define ID_SCRIPT_COMPUTED_GOTO
+#endif
+
+#define SCRIPT_FETCH()												\
+	instructionPointer++;											\
+	if ( !--runaway ) {												\
+		Error( "runaway loop error" );								\
+	}																\
+	in = &code[ instructionPointer ];
+
+// calls may change the local stack, compile new code, or end the thread
+#define SCRIPT_RELOAD()												\
+	code = gameLocal.program.GetCode();								\
+	frame[ 1 ] = ( intptr_t )&localstack[ localstackBase ];			\
+	if ( doneProcessing || threadDying ) {							\
+		goto done;													\
+	}
+
+#ifdef ID_SCRIPT_COMPUTED_GOTO
+#define SCRIPT_OP( x )			op_##x:
+#define SCRIPT_NEXT()			SCRIPT_FETCH(); goto *dispatchTable[ in->op ]
+#else
+#define SCRIPT_OP( x )			case x:
+#define SCRIPT_NEXT()			continue
+#endif
+
+#define SCRIPT_NEXT_CHECKED()	SCRIPT_RELOAD(); SCRIPT_NEXT()
+
+// compare followed by OP_IFNOT on its result in in[ 1 ]
+#define SCRIPT_COMPARE_IFNOT( x, compare )							\
+	SCRIPT_OP( x )													\
+	fused_##x:														\
+		var_a = CodeOperand( frame, in->frameA, in->a );			\
+		var_b = CodeOperand( frame, in->frameB, in->b );			\
+		var_c = CodeOperand( frame, in->frameC, in->c );			\
+		*var_c.floatPtr = ( *var_a.floatPtr compare *var_b.floatPtr );	\
+		instructionPointer++;										\
+		if ( *var_c.floatPtr == 0.0f ) {							\
+			NextInstruction( instructionPointer + in[ 1 ].imm );	\
+		}															\
+		SCRIPT_NEXT();
+
+// OP_INDIRECT_F of the field the compare in in[ 1 ] reads
+#define SCRIPT_INDIRECT_COMPARE_IFNOT( x, compare )					\
+	SCRIPT_OP( x )													\
+		var_a = CodeOperand( frame, in->frameA, in->a );			\
+		var_c = CodeOperand( frame, in->frameC, in->c );			\
+		obj = GetScriptObject( *var_a.entityNumberPtr );			\
+		if ( obj ) {												\
+			var.bytePtr = &obj->data[ in->imm ];					\
+			*var_c.floatPtr = *var.floatPtr;						\
+		} else {													\
+			*var_c.floatPtr = 0.0f;									\
+		}															\
+		instructionPointer++;										\
+		in++;														\
+		goto fused_##compare;
+
 /*
 ====================
 idInterpreter::Execute
+
+Runs the code built by idProgram::BuildCode.  The statements are only looked at
+by instructions that need more than the resolved operands.
 ====================
 */
 bool idInterpreter::Execute( void ) {
@@ -940,13 +1019,159 @@ bool idInterpreter::Execute( void ) {
 	varEval_t	var_b;
 	varEval_t	var_c;
 	varEval_t	var;
-	statement_t	*st;
+	const statement_t *st;
+	const scriptCode_t *code;
+	const scriptCode_t *in;
+	intptr_t	frame[ 2 ];
 	int			runaway;
 	idThread	*newThread;
 	float		floatVal;
 	idScriptObject *obj;
 	const function_t *func;
 
+#ifdef ID_SCRIPT_COMPUTED_GOTO
+	// in the order of the opcodes
+	static const void * const dispatchTable[ NUM_SCRIPT_OPS ] = {
+		&&op_OP_RETURN,
+		&&op_OP_UINC_F,
+		&&op_OP_UINCP_F,
+		&&op_OP_UDEC_F,
+		&&op_OP_UDECP_F,
+		&&op_OP_COMP_F,
+		&&op_OP_MUL_F,
+		&&op_OP_MUL_V,
+		&&op_OP_MUL_FV,
+		&&op_OP_MUL_VF,
+		&&op_OP_DIV_F,
+		&&op_OP_MOD_F,
+		&&op_OP_ADD_F,
+		&&op_OP_ADD_V,
+		&&op_OP_ADD_S,
+		&&op_OP_ADD_FS,
+		&&op_OP_ADD_SF,
+		&&op_OP_ADD_VS,
+		&&op_OP_ADD_SV,
+		&&op_OP_SUB_F,
+		&&op_OP_SUB_V,
+		&&op_OP_EQ_F,
+		&&op_OP_EQ_V,
+		&&op_OP_EQ_S,
+		&&op_OP_EQ_E,
+		&&op_OP_EQ_EO,
+		&&op_OP_EQ_OE,
+		&&op_OP_EQ_OO,
+		&&op_OP_NE_F,
+		&&op_OP_NE_V,
+		&&op_OP_NE_S,
+		&&op_OP_NE_E,
+		&&op_OP_NE_EO,
+		&&op_OP_NE_OE,
+		&&op_OP_NE_OO,
+		&&op_OP_LE,
+		&&op_OP_GE,
+		&&op_OP_LT,
+		&&op_OP_GT,
+		&&op_OP_INDIRECT_F,
+		&&op_OP_INDIRECT_V,
+		&&op_OP_INDIRECT_S,
+		&&op_OP_INDIRECT_ENT,
+		&&op_OP_INDIRECT_BOOL,
+		&&op_OP_INDIRECT_OBJ,
+		&&op_OP_ADDRESS,
+		&&op_OP_EVENTCALL,
+		&&op_OP_OBJECTCALL,
+		&&op_OP_SYSCALL,
+		&&op_OP_STORE_F,
+		&&op_OP_STORE_V,
+		&&op_OP_STORE_S,
+		&&op_OP_STORE_ENT,
+		&&op_OP_STORE_BOOL,
+		&&op_OP_STORE_OBJENT,
+		&&op_OP_STORE_OBJ,
+		&&op_OP_STORE_ENTOBJ,
+		&&op_OP_STORE_FTOS,
+		&&op_OP_STORE_BTOS,
+		&&op_OP_STORE_VTOS,
+		&&op_OP_STORE_FTOBOOL,
+		&&op_OP_STORE_BOOLTOF,
+		&&op_OP_STOREP_F,
+		&&op_OP_STOREP_V,
+		&&op_OP_STOREP_S,
+		&&op_OP_STOREP_ENT,
+		&&op_OP_STOREP_FLD,
+		&&op_OP_STOREP_BOOL,
+		&&op_OP_STOREP_OBJ,
+		&&op_OP_STOREP_OBJENT,
+		&&op_OP_STOREP_FTOS,
+		&&op_OP_STOREP_BTOS,
+		&&op_OP_STOREP_VTOS,
+		&&op_OP_STOREP_FTOBOOL,
+		&&op_OP_STOREP_BOOLTOF,
+		&&op_OP_UMUL_F,
+		&&op_OP_UMUL_V,
+		&&op_OP_UDIV_F,
+		&&op_OP_UDIV_V,
+		&&op_OP_UMOD_F,
+		&&op_OP_UADD_F,
+		&&op_OP_UADD_V,
+		&&op_OP_USUB_F,
+		&&op_OP_USUB_V,
+		&&op_OP_UAND_F,
+		&&op_OP_UOR_F,
+		&&op_OP_NOT_BOOL,
+		&&op_OP_NOT_F,
+		&&op_OP_NOT_V,
+		&&op_OP_NOT_S,
+		&&op_OP_NOT_ENT,
+		&&op_OP_NEG_F,
+		&&op_OP_NEG_V,
+		&&op_OP_INT_F,
+		&&op_OP_IF,
+		&&op_OP_IFNOT,
+		&&op_OP_CALL,
+		&&op_OP_THREAD,
+		&&op_OP_OBJTHREAD,
+		&&op_OP_PUSH_F,
+		&&op_OP_PUSH_V,
+		&&op_OP_PUSH_S,
+		&&op_OP_PUSH_ENT,
+		&&op_OP_PUSH_OBJ,
+		&&op_OP_PUSH_OBJENT,
+		&&op_OP_PUSH_FTOS,
+		&&op_OP_PUSH_BTOF,
+		&&op_OP_PUSH_FTOB,
+		&&op_OP_PUSH_VTOS,
+		&&op_OP_PUSH_BTOS,
+		&&op_OP_GOTO,
+		&&op_OP_AND,
+		&&op_OP_AND_BOOLF,
+		&&op_OP_AND_FBOOL,
+		&&op_OP_AND_BOOLBOOL,
+		&&op_OP_OR,
+		&&op_OP_OR_BOOLF,
+		&&op_OP_OR_FBOOL,
+		&&op_OP_OR_BOOLBOOL,
+		&&op_OP_BITAND,
+		&&op_OP_BITOR,
+		&&op_bad,
+		&&op_bad,
+		&&op_OP_LT_IFNOT,
+		&&op_OP_LE_IFNOT,
+		&&op_OP_GT_IFNOT,
+		&&op_OP_GE_IFNOT,
+		&&op_OP_EQ_F_IFNOT,
+		&&op_OP_NE_F_IFNOT,
+		&&op_OP_INDIRECT_F_LT_IFNOT,
+		&&op_OP_INDIRECT_F_LE_IFNOT,
+		&&op_OP_INDIRECT_F_GT_IFNOT,
+		&&op_OP_INDIRECT_F_GE_IFNOT,
+		&&op_OP_INDIRECT_F_EQ_F_IFNOT,
+		&&op_OP_INDIRECT_F_NE_F_IFNOT,
+		&&op_OP_EVENTCALL_CONST,
+		&&op_OP_SYSCALL_CONST
+	};
+#endif
+
 	if ( threadDying || !currentFunction ) {
 		return true;
 	}
@@ -959,877 +1184,942 @@ bool idInterpreter::Execute( void ) {
 	runaway = 5000000;
 
 	doneProcessing = false;
-	while( !doneProcessing && !threadDying ) {
-		instructionPointer++;
 
-		if ( !--runaway ) {
-			Error( "runaway loop error" );
-		}
+	code = gameLocal.program.GetCode();
+	frame[ 0 ] = 0;
+	frame[ 1 ] = ( intptr_t )&localstack[ localstackBase ];
+
+#ifdef ID_SCRIPT_COMPUTED_GOTO
+	SCRIPT_NEXT();
+	{
+#else
+	while( 1 ) {
+		SCRIPT_FETCH();
 
-		// next statement
+		switch( in->op ) {
+#endif
+	SCRIPT_OP( OP_RETURN )
 		st = &gameLocal.program.GetStatement( instructionPointer );
+		LeaveFunction( st->a );
+		SCRIPT_NEXT_CHECKED();
 
-		switch( st->op ) {
-		case OP_RETURN:
-			LeaveFunction( st->a );
-			break;
+	SCRIPT_OP( OP_THREAD )
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		newThread = new idThread( this, st->a->value.functionPtr, st->b->value.argSize );
+		newThread->Start();
+
+		// return the thread number to the script
+		gameLocal.program.ReturnFloat( newThread->GetThreadNum() );
+		PopParms( st->b->value.argSize );
+		SCRIPT_NEXT_CHECKED();
 
-		case OP_THREAD:
-			newThread = new idThread( this, st->a->value.functionPtr, st->b->value.argSize );
+	SCRIPT_OP( OP_OBJTHREAD )
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			func = obj->GetTypeDef()->GetFunction( st->b->value.virtualFunction );
+			assert( st->c->value.argSize == func->parmTotal );
+			newThread = new idThread( this, GetEntity( *var_a.entityNumberPtr ), func, func->parmTotal );
 			newThread->Start();
 
 			// return the thread number to the script
 			gameLocal.program.ReturnFloat( newThread->GetThreadNum() );
-			PopParms( st->b->value.argSize );
-			break;
-
-		case OP_OBJTHREAD:
-			var_a = GetVariable( st->a );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				func = obj->GetTypeDef()->GetFunction( st->b->value.virtualFunction );
-				assert( st->c->value.argSize == func->parmTotal );
-				newThread = new idThread( this, GetEntity( *var_a.entityNumberPtr ), func, func->parmTotal );
-				newThread->Start();
-
-				// return the thread number to the script
-				gameLocal.program.ReturnFloat( newThread->GetThreadNum() );
-			} else {
-				// return a null thread to the script
-				gameLocal.program.ReturnFloat( 0.0f );
-			}
-			PopParms( st->c->value.argSize );
-			break;
-
-		case OP_CALL:
-			EnterFunction( st->a->value.functionPtr, false );
-			break;
-
-		case OP_EVENTCALL:
-			CallEvent( st->a->value.functionPtr, st->b->value.argSize );
-			break;
-
-		case OP_OBJECTCALL:
-			var_a = GetVariable( st->a );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				func = obj->GetTypeDef()->GetFunction( st->b->value.virtualFunction );
-				EnterFunction( func, false );
-			} else {
-				// return a 'safe' value
-				gameLocal.program.ReturnVector( vec3_zero );
-				gameLocal.program.ReturnString( "" );
-				PopParms( st->c->value.argSize );
-			}
-			break;
-
-		case OP_SYSCALL:
-			CallSysEvent( st->a->value.functionPtr, st->b->value.argSize );
-			break;
-
-		case OP_IFNOT:
-			var_a = GetVariable( st->a );
-			if ( *var_a.intPtr == 0 ) {
-				NextInstruction( instructionPointer + st->b->value.jumpOffset );
-			}
-			break;
-
-		case OP_IF:
-			var_a = GetVariable( st->a );
-			if ( *var_a.intPtr != 0 ) {
-				NextInstruction( instructionPointer + st->b->value.jumpOffset );
-			}
-			break;
-
-		case OP_GOTO:
-			NextInstruction( instructionPointer + st->a->value.jumpOffset );
-			break;
-
-		case OP_ADD_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = *var_a.floatPtr + *var_b.floatPtr;
-			break;
-
-		case OP_ADD_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.vectorPtr = *var_a.vectorPtr + *var_b.vectorPtr;
-			break;
-
-		case OP_ADD_S:
-			SetString( st->c, GetString( st->a ) );
-			AppendString( st->c, GetString( st->b ) );
-			break;
-
-		case OP_ADD_FS:
-			var_a = GetVariable( st->a );
-			SetString( st->c, FloatToString( *var_a.floatPtr ) );
-			AppendString( st->c, GetString( st->b ) );
-			break;
-
-		case OP_ADD_SF:
-			var_b = GetVariable( st->b );
-			SetString( st->c, GetString( st->a ) );
-			AppendString( st->c, FloatToString( *var_b.floatPtr ) );
-			break;
-
-		case OP_ADD_VS:
-			var_a = GetVariable( st->a );
-			SetString( st->c, var_a.vectorPtr->ToString() );
-			AppendString( st->c, GetString( st->b ) );
-			break;
-
-		case OP_ADD_SV:
-			var_b = GetVariable( st->b );
-			SetString( st->c, GetString( st->a ) );
-			AppendString( st->c, var_b.vectorPtr->ToString() );
-			break;
-
-		case OP_SUB_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = *var_a.floatPtr - *var_b.floatPtr;
-			break;
-
-		case OP_SUB_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.vectorPtr = *var_a.vectorPtr - *var_b.vectorPtr;
-			break;
-
-		case OP_MUL_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = *var_a.floatPtr * *var_b.floatPtr;
-			break;
-
-		case OP_MUL_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = *var_a.vectorPtr * *var_b.vectorPtr;
-			break;
-
-		case OP_MUL_FV:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.vectorPtr = *var_a.floatPtr * *var_b.vectorPtr;
-			break;
-
-		case OP_MUL_VF:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.vectorPtr = *var_a.vectorPtr * *var_b.floatPtr;
-			break;
-
-		case OP_DIV_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-
-			if ( *var_b.floatPtr == 0.0f ) {
-				Warning( "Divide by zero" );
-				*var_c.floatPtr = idMath::INFINITY;
-			} else {
-				*var_c.floatPtr = *var_a.floatPtr / *var_b.floatPtr;
-			}
-			break;
-
-		case OP_MOD_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable ( st->c );
-
-			if ( *var_b.floatPtr == 0.0f ) {
-				Warning( "Divide by zero" );
-				*var_c.floatPtr = *var_a.floatPtr;
-			} else {
-				*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) % static_cast<int>( *var_b.floatPtr );
-			}
-			break;
-
-		case OP_BITAND:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) & static_cast<int>( *var_b.floatPtr );
-			break;
-
-		case OP_BITOR:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) | static_cast<int>( *var_b.floatPtr );
-			break;
-
-		case OP_GE:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr >= *var_b.floatPtr );
-			break;
-
-		case OP_LE:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr <= *var_b.floatPtr );
-			break;
-
-		case OP_GT:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr > *var_b.floatPtr );
-			break;
-
-		case OP_LT:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr < *var_b.floatPtr );
-			break;
-
-		case OP_AND:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) && ( *var_b.floatPtr != 0.0f );
-			break;
-
-		case OP_AND_BOOLF:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.intPtr != 0 ) && ( *var_b.floatPtr != 0.0f );
-			break;
-
-		case OP_AND_FBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) && ( *var_b.intPtr != 0 );
-			break;
-
-		case OP_AND_BOOLBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.intPtr != 0 ) && ( *var_b.intPtr != 0 );
-			break;
-
-		case OP_OR:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) || ( *var_b.floatPtr != 0.0f );
-			break;
-
-		case OP_OR_BOOLF:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.intPtr != 0 ) || ( *var_b.floatPtr != 0.0f );
-			break;
-
-		case OP_OR_FBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) || ( *var_b.intPtr != 0 );
-			break;
-
-		case OP_OR_BOOLBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.intPtr != 0 ) || ( *var_b.intPtr != 0 );
-			break;
-
-		case OP_NOT_BOOL:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.intPtr == 0 );
-			break;
-
-		case OP_NOT_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr == 0.0f );
-			break;
-
-		case OP_NOT_V:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.vectorPtr == vec3_zero );
-			break;
-
-		case OP_NOT_S:
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( strlen( GetString( st->a ) ) == 0 );
-			break;
-
-		case OP_NOT_ENT:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( GetEntity( *var_a.entityNumberPtr ) == NULL );
-			break;
-
-		case OP_NEG_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = -*var_a.floatPtr;
-			break;
-
-		case OP_NEG_V:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			*var_c.vectorPtr = -*var_a.vectorPtr;
-			break;
-
-		case OP_INT_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr );
-			break;
-
-		case OP_EQ_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr == *var_b.floatPtr );
-			break;
-
-		case OP_EQ_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.vectorPtr == *var_b.vectorPtr );
-			break;
-
-		case OP_EQ_S:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( idStr::Cmp( GetString( st->a ), GetString( st->b ) ) == 0 );
-			break;
-
-		case OP_EQ_E:
-		case OP_EQ_EO:
-		case OP_EQ_OE:
-		case OP_EQ_OO:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.entityNumberPtr == *var_b.entityNumberPtr );
-			break;
-
-		case OP_NE_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.floatPtr != *var_b.floatPtr );
-			break;
-
-		case OP_NE_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.vectorPtr != *var_b.vectorPtr );
-			break;
-
-		case OP_NE_S:
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( idStr::Cmp( GetString( st->a ), GetString( st->b ) ) != 0 );
-			break;
-
-		case OP_NE_E:
-		case OP_NE_EO:
-		case OP_NE_OE:
-		case OP_NE_OO:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( *var_a.entityNumberPtr != *var_b.entityNumberPtr );
-			break;
-
-		case OP_UADD_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.floatPtr += *var_a.floatPtr;
-			break;
-
-		case OP_UADD_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.vectorPtr += *var_a.vectorPtr;
-			break;
-
-		case OP_USUB_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.floatPtr -= *var_a.floatPtr;
-			break;
-
-		case OP_USUB_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.vectorPtr -= *var_a.vectorPtr;
-			break;
-
-		case OP_UMUL_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.floatPtr *= *var_a.floatPtr;
-			break;
-
-		case OP_UMUL_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.vectorPtr *= *var_a.floatPtr;
-			break;
-
-		case OP_UDIV_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-
-			if ( *var_a.floatPtr == 0.0f ) {
-				Warning( "Divide by zero" );
-				*var_b.floatPtr = idMath::INFINITY;
-			} else {
-				*var_b.floatPtr = *var_b.floatPtr / *var_a.floatPtr;
-			}
-			break;
+		} else {
+			// return a null thread to the script
+			gameLocal.program.ReturnFloat( 0.0f );
+		}
+		PopParms( st->c->value.argSize );
+		SCRIPT_NEXT_CHECKED();
 
-		case OP_UDIV_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+	SCRIPT_OP( OP_CALL )
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		EnterFunction( st->a->value.functionPtr, false );
+		SCRIPT_NEXT_CHECKED();
 
-			if ( *var_a.floatPtr == 0.0f ) {
-				Warning( "Divide by zero" );
-				var_b.vectorPtr->Set( idMath::INFINITY, idMath::INFINITY, idMath::INFINITY );
-			} else {
-				*var_b.vectorPtr = *var_b.vectorPtr / *var_a.floatPtr;
-			}
-			break;
+	SCRIPT_OP( OP_EVENTCALL )
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		CallEvent( st->a->value.functionPtr, st->b->value.argSize );
+		SCRIPT_NEXT_CHECKED();
 
-		case OP_UMOD_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+	SCRIPT_OP( OP_OBJECTCALL )
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			func = obj->GetTypeDef()->GetFunction( st->b->value.virtualFunction );
+			EnterFunction( func, false );
+		} else {
+			// return a 'safe' value
+			gameLocal.program.ReturnVector( vec3_zero );
+			gameLocal.program.ReturnString( "" );
+			PopParms( st->c->value.argSize );
+		}
+		SCRIPT_NEXT_CHECKED();
 
-			if ( *var_a.floatPtr == 0.0f ) {
-				Warning( "Divide by zero" );
-				*var_b.floatPtr = *var_a.floatPtr;
-			} else {
-				*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) % static_cast<int>( *var_a.floatPtr );
-			}
-			break;
+	SCRIPT_OP( OP_SYSCALL )
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		CallSysEvent( st->a->value.functionPtr, st->b->value.argSize );
+		SCRIPT_NEXT_CHECKED();
 
-		case OP_UOR_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) | static_cast<int>( *var_a.floatPtr );
-			break;
+	SCRIPT_OP( OP_IFNOT )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		if ( *var_a.intPtr == 0 ) {
+			NextInstruction( instructionPointer + in->imm );
+		}
+		SCRIPT_NEXT();
 
-		case OP_UAND_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) & static_cast<int>( *var_a.floatPtr );
-			break;
+	SCRIPT_OP( OP_IF )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		if ( *var_a.intPtr != 0 ) {
+			NextInstruction( instructionPointer + in->imm );
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_GOTO )
+		NextInstruction( instructionPointer + in->imm );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_ADD_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = *var_a.floatPtr + *var_b.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_ADD_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.vectorPtr = *var_a.vectorPtr + *var_b.vectorPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_ADD_S )
+		idStr::Copynz( CodeOperand( frame, in->frameC, in->c ).stringPtr, CodeOperand( frame, in->frameA, in->a ).stringPtr, MAX_STRING_LEN );
+		idStr::Append( CodeOperand( frame, in->frameC, in->c ).stringPtr, MAX_STRING_LEN, CodeOperand( frame, in->frameB, in->b ).stringPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_ADD_FS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		idStr::Copynz( CodeOperand( frame, in->frameC, in->c ).stringPtr, FloatToString( *var_a.floatPtr ), MAX_STRING_LEN );
+		idStr::Append( CodeOperand( frame, in->frameC, in->c ).stringPtr, MAX_STRING_LEN, CodeOperand( frame, in->frameB, in->b ).stringPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_ADD_SF )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		idStr::Copynz( CodeOperand( frame, in->frameC, in->c ).stringPtr, CodeOperand( frame, in->frameA, in->a ).stringPtr, MAX_STRING_LEN );
+		idStr::Append( CodeOperand( frame, in->frameC, in->c ).stringPtr, MAX_STRING_LEN, FloatToString( *var_b.floatPtr ) );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_ADD_VS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		idStr::Copynz( CodeOperand( frame, in->frameC, in->c ).stringPtr, var_a.vectorPtr->ToString(), MAX_STRING_LEN );
+		idStr::Append( CodeOperand( frame, in->frameC, in->c ).stringPtr, MAX_STRING_LEN, CodeOperand( frame, in->frameB, in->b ).stringPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_ADD_SV )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		idStr::Copynz( CodeOperand( frame, in->frameC, in->c ).stringPtr, CodeOperand( frame, in->frameA, in->a ).stringPtr, MAX_STRING_LEN );
+		idStr::Append( CodeOperand( frame, in->frameC, in->c ).stringPtr, MAX_STRING_LEN, var_b.vectorPtr->ToString() );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_SUB_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = *var_a.floatPtr - *var_b.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_SUB_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.vectorPtr = *var_a.vectorPtr - *var_b.vectorPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_MUL_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = *var_a.floatPtr * *var_b.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_MUL_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = *var_a.vectorPtr * *var_b.vectorPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_MUL_FV )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.vectorPtr = *var_a.floatPtr * *var_b.vectorPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_MUL_VF )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.vectorPtr = *var_a.vectorPtr * *var_b.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_DIV_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+
+		if ( *var_b.floatPtr == 0.0f ) {
+			Warning( "Divide by zero" );
+			*var_c.floatPtr = idMath::INFINITY;
+		} else {
+			*var_c.floatPtr = *var_a.floatPtr / *var_b.floatPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_UINC_F:
-			var_a = GetVariable( st->a );
-			( *var_a.floatPtr )++;
-			break;
+	SCRIPT_OP( OP_MOD_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
 
-		case OP_UINCP_F:
-			var_a = GetVariable( st->a );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				( *var.floatPtr )++;
-			}
-			break;
+		if ( *var_b.floatPtr == 0.0f ) {
+			Warning( "Divide by zero" );
+			*var_c.floatPtr = *var_a.floatPtr;
+		} else {
+			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) % static_cast<int>( *var_b.floatPtr );
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_BITAND )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) & static_cast<int>( *var_b.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_BITOR )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) | static_cast<int>( *var_b.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_GE )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr >= *var_b.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_LE )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr <= *var_b.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_GT )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr > *var_b.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_LT )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr < *var_b.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_AND )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) && ( *var_b.floatPtr != 0.0f );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_AND_BOOLF )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.intPtr != 0 ) && ( *var_b.floatPtr != 0.0f );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_AND_FBOOL )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) && ( *var_b.intPtr != 0 );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_AND_BOOLBOOL )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.intPtr != 0 ) && ( *var_b.intPtr != 0 );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_OR )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) || ( *var_b.floatPtr != 0.0f );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_OR_BOOLF )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.intPtr != 0 ) || ( *var_b.floatPtr != 0.0f );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_OR_FBOOL )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) || ( *var_b.intPtr != 0 );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_OR_BOOLBOOL )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.intPtr != 0 ) || ( *var_b.intPtr != 0 );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NOT_BOOL )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.intPtr == 0 );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NOT_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr == 0.0f );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NOT_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.vectorPtr == vec3_zero );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NOT_S )
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( strlen( CodeOperand( frame, in->frameA, in->a ).stringPtr ) == 0 );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NOT_ENT )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( GetEntity( *var_a.entityNumberPtr ) == NULL );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NEG_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = -*var_a.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NEG_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.vectorPtr = -*var_a.vectorPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_INT_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = static_cast<int>( *var_a.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_EQ_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr == *var_b.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_EQ_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.vectorPtr == *var_b.vectorPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_EQ_S )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( idStr::Cmp( CodeOperand( frame, in->frameA, in->a ).stringPtr, CodeOperand( frame, in->frameB, in->b ).stringPtr ) == 0 );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_EQ_E )
+	SCRIPT_OP( OP_EQ_EO )
+	SCRIPT_OP( OP_EQ_OE )
+	SCRIPT_OP( OP_EQ_OO )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.entityNumberPtr == *var_b.entityNumberPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NE_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.floatPtr != *var_b.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NE_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.vectorPtr != *var_b.vectorPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NE_S )
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( idStr::Cmp( CodeOperand( frame, in->frameA, in->a ).stringPtr, CodeOperand( frame, in->frameB, in->b ).stringPtr ) != 0 );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_NE_E )
+	SCRIPT_OP( OP_NE_EO )
+	SCRIPT_OP( OP_NE_OE )
+	SCRIPT_OP( OP_NE_OO )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ( *var_a.entityNumberPtr != *var_b.entityNumberPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UADD_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.floatPtr += *var_a.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UADD_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.vectorPtr += *var_a.vectorPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_USUB_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.floatPtr -= *var_a.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_USUB_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.vectorPtr -= *var_a.vectorPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UMUL_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.floatPtr *= *var_a.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UMUL_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.vectorPtr *= *var_a.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UDIV_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+
+		if ( *var_a.floatPtr == 0.0f ) {
+			Warning( "Divide by zero" );
+			*var_b.floatPtr = idMath::INFINITY;
+		} else {
+			*var_b.floatPtr = *var_b.floatPtr / *var_a.floatPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_UDEC_F:
-			var_a = GetVariable( st->a );
-			( *var_a.floatPtr )--;
-			break;
+	SCRIPT_OP( OP_UDIV_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
 
-		case OP_UDECP_F:
-			var_a = GetVariable( st->a );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				( *var.floatPtr )--;
-			}
-			break;
+		if ( *var_a.floatPtr == 0.0f ) {
+			Warning( "Divide by zero" );
+			var_b.vectorPtr->Set( idMath::INFINITY, idMath::INFINITY, idMath::INFINITY );
+		} else {
+			*var_b.vectorPtr = *var_b.vectorPtr / *var_a.floatPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_COMP_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ~static_cast<int>( *var_a.floatPtr );
-			break;
+	SCRIPT_OP( OP_UMOD_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
 
-		case OP_STORE_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		if ( *var_a.floatPtr == 0.0f ) {
+			Warning( "Divide by zero" );
 			*var_b.floatPtr = *var_a.floatPtr;
-			break;
-
-		case OP_STORE_ENT:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		} else {
+			*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) % static_cast<int>( *var_a.floatPtr );
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UOR_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) | static_cast<int>( *var_a.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UAND_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) & static_cast<int>( *var_a.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UINC_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		( *var_a.floatPtr )++;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UINCP_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			var.bytePtr = &obj->data[ in->imm ];
+			( *var.floatPtr )++;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UDEC_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		( *var_a.floatPtr )--;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_UDECP_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			var.bytePtr = &obj->data[ in->imm ];
+			( *var.floatPtr )--;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_COMP_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		*var_c.floatPtr = ~static_cast<int>( *var_a.floatPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.floatPtr = *var_a.floatPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_ENT )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.entityNumberPtr = *var_a.entityNumberPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_BOOL )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.intPtr = *var_a.intPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_OBJENT )
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( !obj ) {
+			*var_b.entityNumberPtr = 0;
+		} else if ( !obj->GetTypeDef()->Inherits( st->b->TypeDef() ) ) {
+			//Warning( "object '%s' cannot be converted to '%s'", obj->GetTypeName(), st->b->TypeDef()->Name() );
+			*var_b.entityNumberPtr = 0;
+		} else {
 			*var_b.entityNumberPtr = *var_a.entityNumberPtr;
-			break;
-
-		case OP_STORE_BOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.intPtr = *var_a.intPtr;
-			break;
-
-		case OP_STORE_OBJENT:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( !obj ) {
-				*var_b.entityNumberPtr = 0;
-			} else if ( !obj->GetTypeDef()->Inherits( st->b->TypeDef() ) ) {
-				//Warning( "object '%s' cannot be converted to '%s'", obj->GetTypeName(), st->b->TypeDef()->Name() );
-				*var_b.entityNumberPtr = 0;
-			} else {
-				*var_b.entityNumberPtr = *var_a.entityNumberPtr;
-			}
-			break;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_OBJ )
+	SCRIPT_OP( OP_STORE_ENTOBJ )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.entityNumberPtr = *var_a.entityNumberPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_S )
+		idStr::Copynz( CodeOperand( frame, in->frameB, in->b ).stringPtr, CodeOperand( frame, in->frameA, in->a ).stringPtr, MAX_STRING_LEN );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.vectorPtr = *var_a.vectorPtr;
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_FTOS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		idStr::Copynz( CodeOperand( frame, in->frameB, in->b ).stringPtr, FloatToString( *var_a.floatPtr ), MAX_STRING_LEN );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_BTOS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		idStr::Copynz( CodeOperand( frame, in->frameB, in->b ).stringPtr, *var_a.intPtr ? "true" : "false", MAX_STRING_LEN );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_VTOS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		idStr::Copynz( CodeOperand( frame, in->frameB, in->b ).stringPtr, var_a.vectorPtr->ToString(), MAX_STRING_LEN );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_FTOBOOL )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( *var_a.floatPtr != 0.0f ) {
+			*var_b.intPtr = 1;
+		} else {
+			*var_b.intPtr = 0;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STORE_BOOLTOF )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		*var_b.floatPtr = static_cast<float>( *var_a.intPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_STOREP_F )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->floatPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			*var_b.evalPtr->floatPtr = *var_a.floatPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_STORE_OBJ:
-		case OP_STORE_ENTOBJ:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.entityNumberPtr = *var_a.entityNumberPtr;
-			break;
+	SCRIPT_OP( OP_STOREP_ENT )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_STORE_S:
-			SetString( st->b, GetString( st->a ) );
-			break;
+	SCRIPT_OP( OP_STOREP_FLD )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			*var_b.evalPtr->intPtr = *var_a.intPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_STORE_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.vectorPtr = *var_a.vectorPtr;
-			break;
+	SCRIPT_OP( OP_STOREP_BOOL )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			*var_b.evalPtr->intPtr = *var_a.intPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_STORE_FTOS:
-			var_a = GetVariable( st->a );
-			SetString( st->b, FloatToString( *var_a.floatPtr ) );
-			break;
+	SCRIPT_OP( OP_STOREP_S )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
+			idStr::Copynz( var_b.evalPtr->stringPtr, CodeOperand( frame, in->frameA, in->a ).stringPtr, MAX_STRING_LEN );
+		}
+		SCRIPT_NEXT();
 
-		case OP_STORE_BTOS:
-			var_a = GetVariable( st->a );
-			SetString( st->b, *var_a.intPtr ? "true" : "false" );
-			break;
+	SCRIPT_OP( OP_STOREP_V )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->vectorPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			*var_b.evalPtr->vectorPtr = *var_a.vectorPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_STORE_VTOS:
-			var_a = GetVariable( st->a );
-			SetString( st->b, var_a.vectorPtr->ToString() );
-			break;
+	SCRIPT_OP( OP_STOREP_FTOS )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			idStr::Copynz( var_b.evalPtr->stringPtr, FloatToString( *var_a.floatPtr ), MAX_STRING_LEN );
+		}
+		SCRIPT_NEXT();
 
-		case OP_STORE_FTOBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+	SCRIPT_OP( OP_STOREP_BTOS )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
 			if ( *var_a.floatPtr != 0.0f ) {
-				*var_b.intPtr = 1;
+				idStr::Copynz( var_b.evalPtr->stringPtr, "true", MAX_STRING_LEN );
 			} else {
-				*var_b.intPtr = 0;
-			}
-			break;
-
-		case OP_STORE_BOOLTOF:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			*var_b.floatPtr = static_cast<float>( *var_a.intPtr );
-			break;
-
-		case OP_STOREP_F:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->floatPtr ) {
-				var_a = GetVariable( st->a );
-				*var_b.evalPtr->floatPtr = *var_a.floatPtr;
-			}
-			break;
-
-		case OP_STOREP_ENT:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
-				var_a = GetVariable( st->a );
-				*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
-			}
-			break;
-
-		case OP_STOREP_FLD:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
-				var_a = GetVariable( st->a );
-				*var_b.evalPtr->intPtr = *var_a.intPtr;
-			}
-			break;
-
-		case OP_STOREP_BOOL:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
-				var_a = GetVariable( st->a );
-				*var_b.evalPtr->intPtr = *var_a.intPtr;
+				idStr::Copynz( var_b.evalPtr->stringPtr, "false", MAX_STRING_LEN );
 			}
-			break;
-
-		case OP_STOREP_S:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
-				idStr::Copynz( var_b.evalPtr->stringPtr, GetString( st->a ), MAX_STRING_LEN );
-			}
-			break;
-
-		case OP_STOREP_V:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->vectorPtr ) {
-				var_a = GetVariable( st->a );
-				*var_b.evalPtr->vectorPtr = *var_a.vectorPtr;
-			}
-			break;
-
-		case OP_STOREP_FTOS:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
-				var_a = GetVariable( st->a );
-				idStr::Copynz( var_b.evalPtr->stringPtr, FloatToString( *var_a.floatPtr ), MAX_STRING_LEN );
-			}
-			break;
-
-		case OP_STOREP_BTOS:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
-				var_a = GetVariable( st->a );
-				if ( *var_a.floatPtr != 0.0f ) {
-					idStr::Copynz( var_b.evalPtr->stringPtr, "true", MAX_STRING_LEN );
-				} else {
-					idStr::Copynz( var_b.evalPtr->stringPtr, "false", MAX_STRING_LEN );
-				}
-			}
-			break;
-
-		case OP_STOREP_VTOS:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
-				var_a = GetVariable( st->a );
-				idStr::Copynz( var_b.evalPtr->stringPtr, var_a.vectorPtr->ToString(), MAX_STRING_LEN );
-			}
-			break;
-
-		case OP_STOREP_FTOBOOL:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
-				var_a = GetVariable( st->a );
-				if ( *var_a.floatPtr != 0.0f ) {
-					*var_b.evalPtr->intPtr = 1;
-				} else {
-					*var_b.evalPtr->intPtr = 0;
-				}
-			}
-			break;
-
-		case OP_STOREP_BOOLTOF:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->floatPtr ) {
-				var_a = GetVariable( st->a );
-				*var_b.evalPtr->floatPtr = static_cast<float>( *var_a.intPtr );
-			}
-			break;
-
-		case OP_STOREP_OBJ:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
-				var_a = GetVariable( st->a );
-				*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
-			}
-			break;
-
-		case OP_STOREP_OBJENT:
-			var_b = GetVariable( st->b );
-			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
-				var_a = GetVariable( st->a );
-				obj = GetScriptObject( *var_a.entityNumberPtr );
-				if ( !obj ) {
-					*var_b.evalPtr->entityNumberPtr = 0;
-
-				// st->b points to type_pointer, which is just a temporary that gets its type reassigned, so we store the real type in st->c
-				// so that we can do a type check during run time since we don't know what type the script object is at compile time because it
-				// comes from an entity
-				} else if ( !obj->GetTypeDef()->Inherits( st->c->TypeDef() ) ) {
-					//Warning( "object '%s' cannot be converted to '%s'", obj->GetTypeName(), st->c->TypeDef()->Name() );
-					*var_b.evalPtr->entityNumberPtr = 0;
-				} else {
-					*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
-				}
-			}
-			break;
-
-		case OP_ADDRESS:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				var_c.evalPtr->bytePtr = &obj->data[ st->b->value.ptrOffset ];
-			} else {
-				var_c.evalPtr->bytePtr = NULL;
-			}
-			break;
-
-		case OP_INDIRECT_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				*var_c.floatPtr = *var.floatPtr;
-			} else {
-				*var_c.floatPtr = 0.0f;
-			}
-			break;
+		}
+		SCRIPT_NEXT();
 
-		case OP_INDIRECT_ENT:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				*var_c.entityNumberPtr = *var.entityNumberPtr;
-			} else {
-				*var_c.entityNumberPtr = 0;
-			}
-			break;
+	SCRIPT_OP( OP_STOREP_VTOS )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			idStr::Copynz( var_b.evalPtr->stringPtr, var_a.vectorPtr->ToString(), MAX_STRING_LEN );
+		}
+		SCRIPT_NEXT();
 
-		case OP_INDIRECT_BOOL:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				*var_c.intPtr = *var.intPtr;
+	SCRIPT_OP( OP_STOREP_FTOBOOL )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			if ( *var_a.floatPtr != 0.0f ) {
+				*var_b.evalPtr->intPtr = 1;
 			} else {
-				*var_c.intPtr = 0;
+				*var_b.evalPtr->intPtr = 0;
 			}
-			break;
+		}
+		SCRIPT_NEXT();
 
-		case OP_INDIRECT_S:
-			var_a = GetVariable( st->a );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				SetString( st->c, var.stringPtr );
-			} else {
-				SetString( st->c, "" );
-			}
-			break;
+	SCRIPT_OP( OP_STOREP_BOOLTOF )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->floatPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			*var_b.evalPtr->floatPtr = static_cast<float>( *var_a.intPtr );
+		}
+		SCRIPT_NEXT();
 
-		case OP_INDIRECT_V:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
-			obj = GetScriptObject( *var_a.entityNumberPtr );
-			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				*var_c.vectorPtr = *var.vectorPtr;
-			} else {
-				var_c.vectorPtr->Zero();
-			}
-			break;
+	SCRIPT_OP( OP_STOREP_OBJ )
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
+			*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
+		}
+		SCRIPT_NEXT();
 
-		case OP_INDIRECT_OBJ:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+	SCRIPT_OP( OP_STOREP_OBJENT )
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		var_b = CodeOperand( frame, in->frameB, in->b );
+		if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
+			var_a = CodeOperand( frame, in->frameA, in->a );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( !obj ) {
-				*var_c.entityNumberPtr = 0;
-			} else {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				*var_c.entityNumberPtr = *var.entityNumberPtr;
-			}
-			break;
-
-		case OP_PUSH_F:
-			var_a = GetVariable( st->a );
-			Push( *var_a.intPtr );
-			break;
-
-		case OP_PUSH_FTOS:
-			var_a = GetVariable( st->a );
-			PushString( FloatToString( *var_a.floatPtr ) );
-			break;
-
-		case OP_PUSH_BTOF:
-			var_a = GetVariable( st->a );
-			floatVal = *var_a.intPtr;
-			Push( *reinterpret_cast<int *>( &floatVal ) );
-			break;
-
-		case OP_PUSH_FTOB:
-			var_a = GetVariable( st->a );
-			if ( *var_a.floatPtr != 0.0f ) {
-				Push( 1 );
+				*var_b.evalPtr->entityNumberPtr = 0;
+
+			// st->b points to type_pointer, which is just a temporary that gets its type reassigned, so we store the real type in st->c
+			// so that we can do a type check during run time since we don't know what type the script object is at compile time because it
+			// comes from an entity
+			} else if ( !obj->GetTypeDef()->Inherits( st->c->TypeDef() ) ) {
+				//Warning( "object '%s' cannot be converted to '%s'", obj->GetTypeName(), st->c->TypeDef()->Name() );
+				*var_b.evalPtr->entityNumberPtr = 0;
 			} else {
-				Push( 0 );
+				*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
 			}
-			break;
-
-		case OP_PUSH_VTOS:
-			var_a = GetVariable( st->a );
-			PushString( var_a.vectorPtr->ToString() );
-			break;
-
-		case OP_PUSH_BTOS:
-			var_a = GetVariable( st->a );
-			PushString( *var_a.intPtr ? "true" : "false" );
-			break;
-
-		case OP_PUSH_ENT:
-			var_a = GetVariable( st->a );
-			Push( *var_a.entityNumberPtr );
-			break;
-
-		case OP_PUSH_S:
-			PushString( GetString( st->a ) );
-			break;
-
-		case OP_PUSH_V:
-			var_a = GetVariable( st->a );
-			PushVector(*var_a.vectorPtr);
-			break;
-
-		case OP_PUSH_OBJ:
-			var_a = GetVariable( st->a );
-			Push( *var_a.entityNumberPtr );
-			break;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_ADDRESS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			var_c.evalPtr->bytePtr = &obj->data[ in->imm ];
+		} else {
+			var_c.evalPtr->bytePtr = NULL;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_INDIRECT_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			var.bytePtr = &obj->data[ in->imm ];
+			*var_c.floatPtr = *var.floatPtr;
+		} else {
+			*var_c.floatPtr = 0.0f;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_INDIRECT_ENT )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			var.bytePtr = &obj->data[ in->imm ];
+			*var_c.entityNumberPtr = *var.entityNumberPtr;
+		} else {
+			*var_c.entityNumberPtr = 0;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_INDIRECT_BOOL )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			var.bytePtr = &obj->data[ in->imm ];
+			*var_c.intPtr = *var.intPtr;
+		} else {
+			*var_c.intPtr = 0;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_INDIRECT_S )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			var.bytePtr = &obj->data[ in->imm ];
+			idStr::Copynz( CodeOperand( frame, in->frameC, in->c ).stringPtr, var.stringPtr, MAX_STRING_LEN );
+		} else {
+			idStr::Copynz( CodeOperand( frame, in->frameC, in->c ).stringPtr, "", MAX_STRING_LEN );
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_INDIRECT_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( obj ) {
+			var.bytePtr = &obj->data[ in->imm ];
+			*var_c.vectorPtr = *var.vectorPtr;
+		} else {
+			var_c.vectorPtr->Zero();
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_INDIRECT_OBJ )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		var_c = CodeOperand( frame, in->frameC, in->c );
+		obj = GetScriptObject( *var_a.entityNumberPtr );
+		if ( !obj ) {
+			*var_c.entityNumberPtr = 0;
+		} else {
+			var.bytePtr = &obj->data[ in->imm ];
+			*var_c.entityNumberPtr = *var.entityNumberPtr;
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_F )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		Push( *var_a.intPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_FTOS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		PushString( FloatToString( *var_a.floatPtr ) );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_BTOF )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		floatVal = *var_a.intPtr;
+		Push( *reinterpret_cast<int *>( &floatVal ) );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_FTOB )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		if ( *var_a.floatPtr != 0.0f ) {
+			Push( 1 );
+		} else {
+			Push( 0 );
+		}
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_VTOS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		PushString( var_a.vectorPtr->ToString() );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_BTOS )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		PushString( *var_a.intPtr ? "true" : "false" );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_ENT )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		Push( *var_a.entityNumberPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_S )
+		PushString( CodeOperand( frame, in->frameA, in->a ).stringPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_V )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		PushVector(*var_a.vectorPtr);
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_OBJ )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		Push( *var_a.entityNumberPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_OP( OP_PUSH_OBJENT )
+		var_a = CodeOperand( frame, in->frameA, in->a );
+		Push( *var_a.entityNumberPtr );
+		SCRIPT_NEXT();
+
+	SCRIPT_COMPARE_IFNOT( OP_LT_IFNOT, < )
+	SCRIPT_COMPARE_IFNOT( OP_LE_IFNOT, <= )
+	SCRIPT_COMPARE_IFNOT( OP_GT_IFNOT, > )
+	SCRIPT_COMPARE_IFNOT( OP_GE_IFNOT, >= )
+	SCRIPT_COMPARE_IFNOT( OP_EQ_F_IFNOT, == )
+	SCRIPT_COMPARE_IFNOT( OP_NE_F_IFNOT, != )
+
+	SCRIPT_INDIRECT_COMPARE_IFNOT( OP_INDIRECT_F_LT_IFNOT, OP_LT_IFNOT )
+	SCRIPT_INDIRECT_COMPARE_IFNOT( OP_INDIRECT_F_LE_IFNOT, OP_LE_IFNOT )
+	SCRIPT_INDIRECT_COMPARE_IFNOT( OP_INDIRECT_F_GT_IFNOT, OP_GT_IFNOT )
+	SCRIPT_INDIRECT_COMPARE_IFNOT( OP_INDIRECT_F_GE_IFNOT, OP_GE_IFNOT )
+	SCRIPT_INDIRECT_COMPARE_IFNOT( OP_INDIRECT_F_EQ_F_IFNOT, OP_EQ_F_IFNOT )
+	SCRIPT_INDIRECT_COMPARE_IFNOT( OP_INDIRECT_F_NE_F_IFNOT, OP_NE_F_IFNOT )
+
+	SCRIPT_OP( OP_EVENTCALL_CONST )
+		// copy the constant arguments and continue at the OP_EVENTCALL
+		if ( localstackUsed + in->a > LOCALSTACK_SIZE ) {
+			Error( "Push: locals stack overflow\n" );
+		}
+		memcpy( &localstack[ localstackUsed ], gameLocal.program.GetCodeConstants() + in->imm, in->a );
+		localstackUsed += in->a;
+		instructionPointer += in->b;
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		CallEvent( st->a->value.functionPtr, st->b->value.argSize );
+		SCRIPT_NEXT_CHECKED();
 
-		case OP_PUSH_OBJENT:
-			var_a = GetVariable( st->a );
-			Push( *var_a.entityNumberPtr );
-			break;
+	SCRIPT_OP( OP_SYSCALL_CONST )
+		// copy the constant arguments and continue at the OP_SYSCALL
+		if ( localstackUsed + in->a > LOCALSTACK_SIZE ) {
+			Error( "Push: locals stack overflow\n" );
+		}
+		memcpy( &localstack[ localstackUsed ], gameLocal.program.GetCodeConstants() + in->imm, in->a );
+		localstackUsed += in->a;
+		instructionPointer += in->b;
+		st = &gameLocal.program.GetStatement( instructionPointer );
+		CallSysEvent( st->a->value.functionPtr, st->b->value.argSize );
+		SCRIPT_NEXT_CHECKED();
 
-		case OP_BREAK:
-		case OP_CONTINUE:
+#ifdef ID_SCRIPT_COMPUTED_GOTO
+	op_bad:
+#else
 		default:
-			Error( "Bad opcode %i", st->op );
-			break;
+#endif
+		Error( "Bad opcode %i", in->op );
+		SCRIPT_NEXT();
+#ifndef ID_SCRIPT_COMPUTED_GOTO
 		}
+#endif
 	}
 
+done:
+	executedInstructions += 5000000 - runaway;
+
 	return threadDying;
 }
+
+#undef SCRIPT_FETCH
+#undef SCRIPT_RELOAD
+#undef SCRIPT_OP
+#undef SCRIPT_NEXT
+#undef SCRIPT_NEXT_CHECKED
+#undef SCRIPT_COMPARE_IFNOT
+#undef SCRIPT_INDIRECT_COMPARE_IFNOT
@@ -88,6 +88,7 @@ public:
 	bool				threadDying;
 	bool				terminateOnExit;
 	bool				debug;
+	int					executedInstructions;	// since the last Reset, for testScriptSpeed
 
 						idInterpreter();
 
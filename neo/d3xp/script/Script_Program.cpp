@@ -28,6 +28,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "sys/platform.h"
 #include "idlib/hashing/MD4.h"
+#include "idlib/hashing/CRC32.h"
 #include "framework/FileSystem.h"
 
 #include "gamesys/Event.h"
@@ -1764,6 +1765,194 @@ void idProgram::FinishCompilation( void ) {
 	}
 }
 
+/*
+==============
+SetCodeOperand
+==============
+*/
+static void SetCodeOperand( const idVarDef *def, byte &frame, intptr_t &value ) {
+	if ( !def ) {
+		frame = 0;
+		value = 0;
+	} else if ( def->initialized == idVarDef::stackVariable ) {
+		frame = 1;
+		value = def->value.stackOffset;
+	} else {
+		frame = 0;
+		value = ( intptr_t )def->value.bytePtr;
+	}
+}
+
+/*
+==============
+idProgram::BuildCode
+
+Resolves the operands of all statements so the interpreter doesn't have to look at
+the var defs for every instruction.  Has to be called whenever statements change.
+==============
+*/
+void idProgram::BuildCode( bool superInstructions ) {
+	int i;
+
+	code.SetGranularity( 4096 );
+	code.SetNum( statements.Num(), false );
+	codeConstants.SetGranularity( 4096 );
+	codeConstants.SetNum( 0, false );
+
+	for( i = 0; i < statements.Num(); i++ ) {
+		const statement_t &st = statements[ i ];
+		scriptCode_t &in = code[ i ];
+
+		in.op = st.op;
+		in.imm = 0;
+		SetCodeOperand( st.a, in.frameA, in.a );
+		SetCodeOperand( st.b, in.frameB, in.b );
+		SetCodeOperand( st.c, in.frameC, in.c );
+
+		switch( st.op ) {
+		case OP_GOTO:
+			in.imm = st.a->value.jumpOffset;
+			break;
+
+		case OP_IF:
+		case OP_IFNOT:
+			in.imm = st.b->value.jumpOffset;
+			break;
+
+		case OP_UINCP_F:
+		case OP_UDECP_F:
+		case OP_ADDRESS:
+		case OP_INDIRECT_F:
+		case OP_INDIRECT_V:
+		case OP_INDIRECT_S:
+		case OP_INDIRECT_ENT:
+		case OP_INDIRECT_BOOL:
+		case OP_INDIRECT_OBJ:
+			in.imm = st.b->value.ptrOffset;
+			break;
+		}
+	}
+
+	if ( superInstructions ) {
+		FuseStatements();
+	}
+}
+
+/*
+==============
+CompareIfNotOp
+==============
+*/
+static int CompareIfNotOp( int op ) {
+	switch( op ) {
+	case OP_LT:		return OP_LT_IFNOT;
+	case OP_LE:		return OP_LE_IFNOT;
+	case OP_GT:		return OP_GT_IFNOT;
+	case OP_GE:		return OP_GE_IFNOT;
+	case OP_EQ_F:	return OP_EQ_F_IFNOT;
+	case OP_NE_F:	return OP_NE_F_IFNOT;
+	}
+	return -1;
+}
+
+/*
+==============
+IsConstantPush
+==============
+*/
+static bool IsConstantPush( const statement_t &st ) {
+	if ( ( st.op != OP_PUSH_F ) && ( st.op != OP_PUSH_V ) && ( st.op != OP_PUSH_S ) ) {
+		return false;
+	}
+	return ( st.a->initialized == idVarDef::initializedConstant );
+}
+
+/*
+==============
+AllocCodeConstant
+==============
+*/
+static byte *AllocCodeConstant( idList<byte> &constants, int size ) {
+	int start = constants.Num();
+
+	constants.AssureSize( start + size );
+	memset( &constants[ start ], 0, size );
+	return &constants[ start ];
+}
+
+/*
+==============
+idProgram::FuseStatements
+
+Replaces the first statement of common sequences with a superinstruction.  Superinstructions
+still write all temporaries of the statements they cover, so the result is the same whether
+the sequence is executed as a whole or entered by a jump into the middle.
+==============
+*/
+void idProgram::FuseStatements( void ) {
+	int i;
+	int j;
+	int op;
+	int num;
+
+	num = statements.Num();
+	for( i = 0; i < num; i++ ) {
+		const statement_t &st = statements[ i ];
+
+		// compare that is only used by the next conditional jump
+		op = CompareIfNotOp( st.op );
+		if ( ( op >= 0 ) && ( i + 1 < num ) && ( statements[ i + 1 ].op == OP_IFNOT ) && ( statements[ i + 1 ].a == st.c ) ) {
+			code[ i ].op = op;
+			continue;
+		}
+
+		// field of an object loaded for a compare and a conditional jump
+		if ( ( st.op == OP_INDIRECT_F ) && ( i + 2 < num ) ) {
+			op = CompareIfNotOp( statements[ i + 1 ].op );
+			if ( ( op >= 0 ) && ( statements[ i + 1 ].a == st.c ) && ( statements[ i + 2 ].op == OP_IFNOT ) && ( statements[ i + 2 ].a == statements[ i + 1 ].c ) ) {
+				code[ i ].op = op - OP_LT_IFNOT + OP_INDIRECT_F_LT_IFNOT;
+				continue;
+			}
+		}
+
+		// constant arguments of an event call are copied to the stack in one go
+		if ( IsConstantPush( st ) ) {
+			for( j = i + 1; ( j < num ) && IsConstantPush( statements[ j ] ); j++ ) {
+			}
+			if ( ( j < num ) && ( ( statements[ j ].op == OP_EVENTCALL ) || ( statements[ j ].op == OP_SYSCALL ) ) ) {
+				scriptCode_t &in = code[ i ];
+				int start = codeConstants.Num();
+
+				for( int k = i; k < j; k++ ) {
+					const idVarDef *def = statements[ k ].a;
+					intptr_t value;
+
+					switch( statements[ k ].op ) {
+					case OP_PUSH_F:
+						value = *def->value.intPtr;
+						memcpy( AllocCodeConstant( codeConstants, sizeof( intptr_t ) ), &value, sizeof( intptr_t ) );
+						break;
+					case OP_PUSH_V:
+						*reinterpret_cast<idVec3 *>( AllocCodeConstant( codeConstants, E_EVENT_SIZEOF_VEC ) ) = *def->value.vectorPtr;
+						break;
+					case OP_PUSH_S:
+						idStr::Copynz( reinterpret_cast<char *>( AllocCodeConstant( codeConstants, MAX_STRING_LEN ) ), def->value.stringPtr, MAX_STRING_LEN );
+						break;
+					}
+				}
+
+				in.op = ( statements[ j ].op == OP_EVENTCALL ) ? OP_EVENTCALL_CONST : OP_SYSCALL_CONST;
+				in.imm = start;
+				in.frameA = in.frameB = in.frameC = 0;
+				in.a = codeConstants.Num() - start;		// size of the arguments
+				in.b = j - i;							// distance to the call
+				in.c = 0;
+				i = j;
+			}
+		}
+	}
+}
+
 /*
 ==============
 idProgram::CompileStats
@@ -1804,12 +1993,14 @@ void idProgram::CompileStats( void ) {
 	memallocated = funcMem + memused + sizeof( idProgram );
 
 	memused += statements.MemoryUsed();
+	memused += code.MemoryUsed() + codeConstants.MemoryUsed();
 	memused += functions.MemoryUsed();	// name and filename of functions are shared, so no need to include them
 	memused += sizeof( variables );
 
 	gameLocal.DPrintf( "Memory usage:\n" );
 	gameLocal.DPrintf( "     Strings: %d, %d bytes\n", fileList.Num(), stringspace );
 	gameLocal.DPrintf( "  Statements: %d, %zd bytes\n", statements.Num(), statements.MemoryUsed() );
+	gameLocal.DPrintf( "        Code: %d, %zd bytes\n", code.Num(), code.MemoryUsed() + codeConstants.MemoryUsed() );
 	gameLocal.DPrintf( "   Functions: %d, %d bytes\n", functions.Num(), funcMem );
 	gameLocal.DPrintf( "   Variables: %d bytes\n", numVariables );
 	gameLocal.DPrintf( "    Mem used: %d bytes\n", memused );
@@ -1850,12 +2041,15 @@ bool idProgram::CompileText( const char *source, const char *text, bool console
 	catch( idCompileError &err ) {
 		if ( console ) {
 			gameLocal.Printf( "%s\n", err.error );
+			BuildCode( g_scriptSuperInstructions.GetBool() );
 			return false;
 		} else {
 			gameLocal.Error( "%s\n", err.error );
 		}
 	};
 
+	BuildCode( g_scriptSuperInstructions.GetBool() );
+
 	if ( !console ) {
 		CompileStats();
 	}
@@ -1943,6 +2137,8 @@ void idProgram::FreeData( void ) {
 	filename.Clear();
 	fileList.Clear();
 	statements.Clear();
+	code.Clear();
+	codeConstants.Clear();
 	functions.Clear();
 
 	top_functions	= 0;
@@ -1954,6 +2150,647 @@ void idProgram::FreeData( void ) {
 	filename = "";
 }
 
+/***********************************************************************
+
+  Compiled script cache
+
+  The program built from the default script is written to a binary file so
+  later starts can skip the compiler.  Types, defs, functions and statements
+  are stored with indexes in place of pointers.  The cache is only used when
+  the checksum of the script sources and the script events of the game match.
+
+***********************************************************************/
+
+#define SCRIPT_CACHE_DIR			"generated/script"
+#define SCRIPT_CACHE_EXT			"bsc"
+#define SCRIPT_CACHE_MAGIC			( ( 'B' << 24 ) | ( 'S' << 16 ) | ( 'C' << 8 ) | ' ' )
+#define SCRIPT_CACHE_VERSION		1
+
+// def values that are not plain numbers
+#define SCRIPT_CACHE_VALUE_INT		0
+#define SCRIPT_CACHE_VALUE_GLOBAL	1
+#define SCRIPT_CACHE_VALUE_FUNCTION	2
+
+static idTypeDef * const cacheBuiltinTypes[] = {
+	&type_void, &type_scriptevent, &type_namespace, &type_string, &type_float, &type_vector, &type_entity, &type_field,
+	&type_function, &type_virtualfunction, &type_pointer, &type_object, &type_jumpoffset, &type_argsize, &type_boolean
+};
+
+static idVarDef * const cacheBuiltinDefs[] = {
+	&def_void, &def_scriptevent, &def_namespace, &def_string, &def_float, &def_vector, &def_entity, &def_field,
+	&def_function, &def_virtualfunction, &def_pointer, &def_object, &def_jumpoffset, &def_argsize, &def_boolean
+};
+
+static const int numCacheBuiltinTypes = sizeof( cacheBuiltinTypes ) / sizeof( cacheBuiltinTypes[ 0 ] );
+static const int numCacheBuiltinDefs = sizeof( cacheBuiltinDefs ) / sizeof( cacheBuiltinDefs[ 0 ] );
+
+/*
+================
+ScriptCacheFileName
+================
+*/
+static void ScriptCacheFileName( const char *fileName, idStr &cacheName ) {
+	cacheName = SCRIPT_CACHE_DIR "/";
+	cacheName += fileName;
+	cacheName.StripPath();
+	cacheName = SCRIPT_CACHE_DIR "/" + cacheName;
+	cacheName.SetFileExtension( SCRIPT_CACHE_EXT );
+}
+
+/*
+================
+ScriptCacheTypeIndex
+
+-1 for NULL, negative for the built in types
+================
+*/
+static int ScriptCacheTypeIndex( const idHashIndex &hash, const idList<idTypeDef *> &types, const idTypeDef *type ) {
+	int i;
+
+	if ( !type ) {
+		return -1;
+	}
+	for( i = hash.First( ( int )( ( uintptr_t )type >> 4 ) ); i != -1; i = hash.Next( i ) ) {
+		if ( types[ i ] == type ) {
+			return i;
+		}
+	}
+	for( i = 0; i < numCacheBuiltinTypes; i++ ) {
+		if ( cacheBuiltinTypes[ i ] == type ) {
+			return -2 - i;
+		}
+	}
+	throw idCompileError( va( "type '%s' is not part of the program", type->Name() ) );
+	return -1;
+}
+
+/*
+================
+ScriptCacheDefIndex
+
+-1 for NULL, negative for the built in defs
+================
+*/
+static int ScriptCacheDefIndex( const idList<idVarDef *> &varDefs, const idVarDef *def ) {
+	int i;
+
+	if ( !def ) {
+		return -1;
+	}
+	if ( ( def->num >= 0 ) && ( def->num < varDefs.Num() ) && ( varDefs[ def->num ] == def ) ) {
+		return def->num;
+	}
+	for( i = 0; i < numCacheBuiltinDefs; i++ ) {
+		if ( cacheBuiltinDefs[ i ] == def ) {
+			return -2 - i;
+		}
+	}
+	throw idCompileError( "def is not part of the program" );
+	return -1;
+}
+
+/*
+================
+idProgram::SourceChecksum
+
+checksum of all scripts in the script folder and the other files the program was compiled from,
+returns false if one of the files can't be read
+================
+*/
+bool idProgram::SourceChecksum( const idStrList &files, unsigned int &crc ) const {
+	idFileList *	fileList;
+	void *			buffer;
+	int				length;
+	int				i;
+	bool			ok;
+
+	ok = true;
+	CRC32_InitChecksum( crc );
+
+	fileList = fileSystem->ListFilesTree( "script", ".script", true );
+	for( i = 0; i < fileList->GetNumFiles(); i++ ) {
+		length = fileSystem->ReadFile( fileList->GetFile( i ), &buffer, NULL );
+		if ( length < 0 ) {
+			ok = false;
+			break;
+		}
+		CRC32_UpdateChecksum( crc, fileList->GetFile( i ), strlen( fileList->GetFile( i ) ) );
+		CRC32_UpdateChecksum( crc, buffer, length );
+		fileSystem->FreeFile( buffer );
+	}
+	fileSystem->FreeFileList( fileList );
+
+	for( i = 0; ok && ( i < files.Num() ); i++ ) {
+		if ( !idStr::Icmpn( files[ i ], "script/", 7 ) ) {
+			continue;
+		}
+		length = fileSystem->ReadFile( files[ i ], &buffer, NULL );
+		if ( length < 0 ) {
+			ok = false;
+			break;
+		}
+		CRC32_UpdateChecksum( crc, files[ i ].c_str(), files[ i ].Length() );
+		CRC32_UpdateChecksum( crc, buffer, length );
+		fileSystem->FreeFile( buffer );
+	}
+
+	CRC32_FinishChecksum( crc );
+
+	return ok;
+}
+
+/*
+================
+idProgram::WriteCache
+
+writes the program compiled from the given file to the cache
+================
+*/
+void idProgram::WriteCache( const char *sourceFile ) {
+	idStr			cacheName;
+	idHashIndex		typeHash;
+	unsigned int	crc;
+	int				i;
+	int				j;
+
+	if ( !SourceChecksum( fileList, crc ) ) {
+		gameLocal.DPrintf( "scripts of '%s' can't be cached\n", sourceFile );
+		return;
+	}
+
+	ScriptCacheFileName( sourceFile, cacheName );
+	idFile_Memory file( cacheName );
+
+	typeHash.Clear( 4096, types.Num() );
+	for( i = 0; i < types.Num(); i++ ) {
+		typeHash.Add( ( int )( ( uintptr_t )types[ i ] >> 4 ), i );
+	}
+
+	try {
+		file.WriteInt( SCRIPT_CACHE_MAGIC );
+		file.WriteInt( SCRIPT_CACHE_VERSION );
+		file.WriteInt( sizeof( intptr_t ) );
+		file.WriteInt( MAX_STRING_LEN );
+		file.WriteInt( E_EVENT_SIZEOF_VEC );
+
+		file.WriteInt( fileList.Num() );
+		for( i = 0; i < fileList.Num(); i++ ) {
+			file.WriteString( fileList[ i ] );
+		}
+		file.WriteUnsignedInt( crc );
+
+		file.WriteInt( types.Num() );
+		file.WriteInt( varDefs.Num() );
+		file.WriteInt( functions.Num() );
+		file.WriteInt( statements.Num() );
+
+		file.WriteInt( numVariables );
+		file.Write( variables, numVariables );
+
+		for( i = 0; i < types.Num(); i++ ) {
+			const idTypeDef *type = types[ i ];
+
+			file.WriteInt( type->type );
+			file.WriteString( type->name );
+			file.WriteInt( type->size );
+			file.WriteInt( ScriptCacheTypeIndex( typeHash, types, type->auxType ) );
+			file.WriteInt( ScriptCacheDefIndex( varDefs, type->def ) );
+			file.WriteInt( type->parmTypes.Num() );
+			for( j = 0; j < type->parmTypes.Num(); j++ ) {
+				file.WriteInt( ScriptCacheTypeIndex( typeHash, types, type->parmTypes[ j ] ) );
+				file.WriteString( type->parmNames[ j ] );
+			}
+			file.WriteInt( type->functions.Num() );
+			for( j = 0; j < type->functions.Num(); j++ ) {
+				file.WriteInt( type->functions[ j ] - &functions[ 0 ] );
+			}
+		}
+
+		for( i = 0; i < varDefs.Num(); i++ ) {
+			const idVarDef *def = varDefs[ i ];
+			varEval_t value;
+
+			file.WriteInt( ScriptCacheTypeIndex( typeHash, types, def->TypeDef() ) );
+			file.WriteString( def->Name() );
+			file.WriteInt( ScriptCacheDefIndex( varDefs, def->scope ) );
+			file.WriteInt( def->numUsers );
+			file.WriteInt( def->initialized );
+
+			memset( &value, 0, sizeof( value ) );
+			if ( def->Type() == ev_function ) {
+				j = def->value.functionPtr ? def->value.functionPtr - &functions[ 0 ] : -1;
+				if ( ( j < -1 ) || ( j >= functions.Num() ) ) {
+					throw idCompileError( va( "unknown function of def '%s'", def->Name() ) );
+				}
+				file.WriteInt( SCRIPT_CACHE_VALUE_FUNCTION );
+				file.WriteInt( j );
+			} else if ( ( def->value.bytePtr >= variables ) && ( def->value.bytePtr < variables + sizeof( variables ) ) ) {
+				file.WriteInt( SCRIPT_CACHE_VALUE_GLOBAL );
+				file.WriteInt( def->value.bytePtr - variables );
+			} else {
+				// stack offsets, field offsets, jump offsets and so on
+				value.jumpOffset = def->value.jumpOffset;
+				if ( memcmp( &value, &def->value, sizeof( value ) ) != 0 ) {
+					throw idCompileError( va( "unknown value of def '%s'", def->Name() ) );
+				}
+				file.WriteInt( SCRIPT_CACHE_VALUE_INT );
+				file.WriteInt( def->value.jumpOffset );
+			}
+		}
+
+		for( i = 0; i < functions.Num(); i++ ) {
+			const function_t &func = functions[ i ];
+
+			file.WriteString( func.Name() );
+			if ( func.eventdef ) {
+				file.WriteString( func.eventdef->GetName() );
+				file.WriteString( func.eventdef->GetArgFormat() );
+				file.WriteChar( func.eventdef->GetReturnType() );
+			} else {
+				file.WriteString( "" );
+			}
+			file.WriteInt( ScriptCacheDefIndex( varDefs, func.def ) );
+			file.WriteInt( ScriptCacheTypeIndex( typeHash, types, func.type ) );
+			file.WriteInt( func.firstStatement );
+			file.WriteInt( func.numStatements );
+			file.WriteInt( func.parmTotal );
+			file.WriteInt( func.locals );
+			file.WriteInt( func.filenum );
+			file.WriteInt( func.parmSize.Num() );
+			for( j = 0; j < func.parmSize.Num(); j++ ) {
+				file.WriteInt( func.parmSize[ j ] );
+			}
+		}
+
+		for( i = 0; i < statements.Num(); i++ ) {
+			const statement_t &st = statements[ i ];
+
+			file.WriteUnsignedShort( st.op );
+			file.WriteInt( ScriptCacheDefIndex( varDefs, st.a ) );
+			file.WriteInt( ScriptCacheDefIndex( varDefs, st.b ) );
+			file.WriteInt( ScriptCacheDefIndex( varDefs, st.c ) );
+			file.WriteUnsignedShort( st.linenumber );
+			file.WriteUnsignedShort( st.file );
+		}
+
+		file.WriteInt( ScriptCacheDefIndex( varDefs, returnDef ) );
+		file.WriteInt( ScriptCacheDefIndex( varDefs, returnStringDef ) );
+		file.WriteInt( ScriptCacheDefIndex( varDefs, sysDef ) );
+		file.WriteInt( SCRIPT_CACHE_MAGIC );
+	}
+
+	catch( idCompileError &err ) {
+		gameLocal.Warning( "couldn't write '%s': %s", cacheName.c_str(), err.error );
+		return;
+	}
+
+	if ( fileSystem->WriteFile( cacheName, file.GetDataPtr(), file.Length() ) < 0 ) {
+		gameLocal.Warning( "couldn't write '%s'", cacheName.c_str() );
+	}
+}
+
+/*
+================
+idScriptCacheReader
+
+reads the cache and checks all indexes, any error marks the data as damaged
+================
+*/
+class idScriptCacheReader {
+public:
+					idScriptCacheReader( idFile *file, idList<idTypeDef *> &types, idList<idVarDef *> &varDefs ) :
+						file( file ), types( types ), varDefs( varDefs ), numFunctions( 0 ), ok( true ) {}
+
+	int				Int( void );
+	int				Index( int num );
+	void			String( idStr &str );
+	idTypeDef *		Type( void );
+	idVarDef *		Def( void );
+
+	idFile *		file;
+	idList<idTypeDef *> &types;
+	idList<idVarDef *> &varDefs;
+	int				numFunctions;
+	bool			ok;
+};
+
+/*
+================
+idScriptCacheReader::Int
+================
+*/
+int idScriptCacheReader::Int( void ) {
+	int value = 0;
+
+	if ( file->ReadInt( value ) != sizeof( value ) ) {
+		ok = false;
+	}
+	return value;
+}
+
+/*
+================
+idScriptCacheReader::Index
+
+index in the range [-1, num)
+================
+*/
+int idScriptCacheReader::Index( int num ) {
+	int value = Int();
+
+	if ( ( value < -1 ) || ( value >= num ) ) {
+		ok = false;
+		return -1;
+	}
+	return value;
+}
+
+/*
+================
+idScriptCacheReader::String
+================
+*/
+void idScriptCacheReader::String( idStr &str ) {
+	int len = Int();
+
+	str.Clear();
+	if ( ( len < 0 ) || ( len > file->Length() - file->Tell() ) ) {
+		ok = false;
+		return;
+	}
+	if ( len > 0 ) {
+		str.Fill( ' ', len );
+		file->Read( &str[ 0 ], len );
+	}
+}
+
+/*
+================
+idScriptCacheReader::Type
+================
+*/
+idTypeDef *idScriptCacheReader::Type( void ) {
+	int index = Int();
+
+	if ( index >= 0 && index < types.Num() ) {
+		return types[ index ];
+	} else if ( index <= -2 && -2 - index < numCacheBuiltinTypes ) {
+		return cacheBuiltinTypes[ -2 - index ];
+	} else if ( index != -1 ) {
+		ok = false;
+	}
+	return NULL;
+}
+
+/*
+================
+idScriptCacheReader::Def
+================
+*/
+idVarDef *idScriptCacheReader::Def( void ) {
+	int index = Int();
+
+	if ( index >= 0 && index < varDefs.Num() ) {
+		return varDefs[ index ];
+	} else if ( index <= -2 && -2 - index < numCacheBuiltinDefs ) {
+		return cacheBuiltinDefs[ -2 - index ];
+	} else if ( index != -1 ) {
+		ok = false;
+	}
+	return NULL;
+}
+
+/*
+================
+idProgram::LoadCache
+
+replaces the program with the cached program compiled from the given file, returns false
+if the cache is missing, out of date or damaged
+================
+*/
+bool idProgram::LoadCache( const char *sourceFile ) {
+	idStr			cacheName;
+	idStr			str;
+	idStrList		files;
+	void *			buffer;
+	unsigned int	crc;
+	unsigned int	sourceCRC;
+	int				length;
+	int				numTypes;
+	int				numDefs;
+	int				numFunctions;
+	int				numStatements;
+	int				value;
+	int				i;
+	int				j;
+	int				n;
+
+	ScriptCacheFileName( sourceFile, cacheName );
+
+	length = fileSystem->ReadFile( cacheName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory file( cacheName, ( const char * )buffer, length );
+
+	file.ReadInt( value );
+	if ( value != SCRIPT_CACHE_MAGIC ) {
+		gameLocal.Warning( "%s is not a compiled script cache", cacheName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+	file.ReadInt( value );
+	if ( value != SCRIPT_CACHE_VERSION ) {
+		gameLocal.DPrintf( "%s is out of date\n", cacheName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+	file.ReadInt( value );
+	file.ReadInt( i );
+	file.ReadInt( j );
+	if ( ( value != sizeof( intptr_t ) ) || ( i != MAX_STRING_LEN ) || ( j != E_EVENT_SIZEOF_VEC ) ) {
+		gameLocal.DPrintf( "%s is from a different build\n", cacheName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	idScriptCacheReader reader( &file, types, varDefs );
+
+	n = reader.Int();
+	for( i = 0; reader.ok && ( i < n ); i++ ) {
+		reader.String( str );
+		files.Append( str );
+	}
+	crc = ( unsigned int )reader.Int();
+	if ( !reader.ok || !SourceChecksum( files, sourceCRC ) || ( crc != sourceCRC ) ) {
+		gameLocal.DPrintf( "%s is out of date\n", cacheName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	FreeData();
+
+	numTypes = reader.Int();
+	numDefs = reader.Int();
+	numFunctions = reader.Int();
+	numStatements = reader.Int();
+	numVariables = reader.Int();
+	if ( !reader.ok || ( numTypes < 0 ) || ( numDefs < 0 ) || ( numFunctions < 0 ) || ( numFunctions > functions.Max() ) ||
+		( numStatements < 1 ) || ( numStatements > statements.Max() ) || ( numVariables < 0 ) || ( numVariables > ( int )sizeof( variables ) ) ||
+		( file.Read( variables, numVariables ) != numVariables ) ) {
+		goto damaged;
+	}
+
+	fileList = files;
+
+	// allocate everything first so the links can be resolved while reading
+	types.SetNum( numTypes );
+	for( i = 0; i < numTypes; i++ ) {
+		types[ i ] = new idTypeDef( ev_void, NULL, "", 0, NULL );
+	}
+	varDefs.SetNum( numDefs );
+	for( i = 0; i < numDefs; i++ ) {
+		varDefs[ i ] = new idVarDef();
+		varDefs[ i ]->num = i;
+	}
+	functions.SetNum( numFunctions );
+	statements.SetNum( numStatements );
+
+	reader.numFunctions = numFunctions;
+
+	for( i = 0; reader.ok && ( i < numTypes ); i++ ) {
+		idTypeDef *type = types[ i ];
+
+		type->type = ( etype_t )reader.Int();
+		if ( ( type->type < ev_void ) || ( type->type > ev_boolean ) ) {
+			reader.ok = false;
+		}
+		reader.String( type->name );
+		type->size = reader.Int();
+		type->auxType = reader.Type();
+		type->def = reader.Def();
+		n = reader.Int();
+		for( j = 0; reader.ok && ( j < n ); j++ ) {
+			type->parmTypes.Append( reader.Type() );
+			reader.String( str );
+			type->parmNames.Append( str );
+		}
+		n = reader.Int();
+		for( j = 0; reader.ok && ( j < n ); j++ ) {
+			value = reader.Index( numFunctions );
+			type->functions.Append( ( value >= 0 ) ? &functions[ value ] : NULL );
+		}
+	}
+
+	for( i = 0; reader.ok && ( i < numDefs ); i++ ) {
+		idVarDef *def = varDefs[ i ];
+
+		def->SetTypeDef( reader.Type() );
+		reader.String( str );
+		AddDefToNameList( def, str );
+		def->scope = reader.Def();
+		if ( !def->TypeDef() || !def->scope ) {
+			reader.ok = false;
+		}
+		def->numUsers = reader.Int();
+		def->initialized = ( idVarDef::initialized_t )reader.Int();
+
+		switch( reader.Int() ) {
+		case SCRIPT_CACHE_VALUE_INT:
+			def->value.jumpOffset = reader.Int();
+			break;
+		case SCRIPT_CACHE_VALUE_GLOBAL:
+			value = reader.Int();
+			if ( ( value < 0 ) || ( value >= numVariables ) ) {
+				reader.ok = false;
+			} else {
+				def->value.bytePtr = &variables[ value ];
+			}
+			break;
+		case SCRIPT_CACHE_VALUE_FUNCTION:
+			value = reader.Index( numFunctions );
+			def->value.functionPtr = ( value >= 0 ) ? &functions[ value ] : NULL;
+			break;
+		default:
+			reader.ok = false;
+			break;
+		}
+	}
+
+	for( i = 0; reader.ok && ( i < numFunctions ); i++ ) {
+		function_t &func = functions[ i ];
+
+		func.Clear();
+		reader.String( str );
+		func.SetName( str );
+		reader.String( str );
+		if ( str.Length() ) {
+			idStr format;
+			char returnType = 0;
+
+			func.eventdef = idEventDef::FindEvent( str );
+			reader.String( format );
+			file.ReadChar( returnType );
+			if ( !func.eventdef || idStr::Cmp( func.eventdef->GetArgFormat(), format ) || ( func.eventdef->GetReturnType() != returnType ) ) {
+				gameLocal.DPrintf( "%s was built for a different version of script event '%s'\n", cacheName.c_str(), str.c_str() );
+				reader.ok = false;
+				break;
+			}
+		}
+		func.def = reader.Def();
+		func.type = reader.Type();
+		func.firstStatement = reader.Int();
+		func.numStatements = reader.Int();
+		func.parmTotal = reader.Int();
+		func.locals = reader.Int();
+		func.filenum = reader.Int();
+		if ( ( func.firstStatement < 0 ) || ( func.numStatements < 0 ) || ( func.firstStatement + func.numStatements > numStatements ) ) {
+			reader.ok = false;
+		}
+		n = reader.Int();
+		for( j = 0; reader.ok && ( j < n ); j++ ) {
+			func.parmSize.Append( reader.Int() );
+		}
+	}
+
+	for( i = 0; reader.ok && ( i < numStatements ); i++ ) {
+		statement_t &st = statements[ i ];
+
+		file.ReadUnsignedShort( st.op );
+		st.a = reader.Def();
+		st.b = reader.Def();
+		st.c = reader.Def();
+		file.ReadUnsignedShort( st.linenumber );
+		file.ReadUnsignedShort( st.file );
+		if ( ( st.op >= NUM_OPCODES ) || ( st.file >= fileList.Num() ) ) {
+			reader.ok = false;
+		}
+	}
+
+	returnDef = reader.Def();
+	returnStringDef = reader.Def();
+	sysDef = reader.Def();
+
+	if ( !reader.ok || ( reader.Int() != SCRIPT_CACHE_MAGIC ) || !returnDef || !returnStringDef || !sysDef ) {
+		goto damaged;
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	BuildCode( g_scriptSuperInstructions.GetBool() );
+
+	gameLocal.DPrintf( "loaded %d functions from %s\n", functions.Num(), cacheName.c_str() );
+
+	return true;
+
+damaged:
+	gameLocal.Warning( "%s is damaged", cacheName.c_str() );
+	fileSystem->FreeFile( buffer );
+	FreeData();
+	return false;
+}
+
 /*
 ================
 idProgram::Startup
@@ -1965,12 +2802,18 @@ void idProgram::Startup( const char *defaultScript ) {
 	// make sure all data is freed up
 	idThread::Restart();
 
-	// get ready for loading scripts
-	BeginCompilation();
+	// use the compiled default script if it's up to date
+	if ( !defaultScript || !*defaultScript || ( g_scriptCache.GetInteger() != 1 ) || !LoadCache( defaultScript ) ) {
+		// get ready for loading scripts
+		BeginCompilation();
 
-	// load the default script
-	if ( defaultScript && *defaultScript ) {
-		CompileFile( defaultScript );
+		// load the default script
+		if ( defaultScript && *defaultScript ) {
+			CompileFile( defaultScript );
+			if ( g_scriptCache.GetInteger() != 0 ) {
+				WriteCache( defaultScript );
+			}
+		}
 	}
 
 	FinishCompilation();
@@ -2108,7 +2951,8 @@ Restores all variables to their initial value
 ==============
 */
 void idProgram::Restart( void ) {
-	int i;
+	programState_t	state;
+	int				i;
 
 	idThread::Restart();
 
@@ -2117,30 +2961,66 @@ void idProgram::Restart( void ) {
 	// have typed "script" from the console, free up any types and vardefs that
 	// have been allocated after the initial startup
 	//
-	for( i = top_types; i < types.Num(); i++ ) {
+	state.numFunctions	= top_functions;
+	state.numStatements	= top_statements;
+	state.numTypes		= top_types;
+	state.numDefs		= top_defs;
+	state.numFiles		= top_files;
+	state.numVariables	= variableDefaults.Num();
+	RestoreState( state );
+
+	// reset the variables to their default values
+	for( i = 0; i < numVariables; i++ ) {
+		variables[ i ] = variableDefaults[ i ];
+	}
+}
+
+/*
+==============
+idProgram::SaveState
+==============
+*/
+void idProgram::SaveState( programState_t &state ) const {
+	state.numFunctions	= functions.Num();
+	state.numStatements	= statements.Num();
+	state.numTypes		= types.Num();
+	state.numDefs		= varDefs.Num();
+	state.numFiles		= fileList.Num();
+	state.numVariables	= numVariables;
+}
+
+/*
+==============
+idProgram::RestoreState
+
+Frees everything compiled since the state was saved.  No thread or script object may
+still use any of it.  The variables that were there already keep their values.
+==============
+*/
+void idProgram::RestoreState( const programState_t &state ) {
+	int i;
+
+	for( i = state.numTypes; i < types.Num(); i++ ) {
 		delete types[ i ];
 	}
-	types.SetNum( top_types, false );
+	types.SetNum( state.numTypes, false );
 
-	for( i = top_defs; i < varDefs.Num(); i++ ) {
+	for( i = state.numDefs; i < varDefs.Num(); i++ ) {
 		delete varDefs[ i ];
 	}
-	varDefs.SetNum( top_defs, false );
+	varDefs.SetNum( state.numDefs, false );
 
-	for( i = top_functions; i < functions.Num(); i++ ) {
+	for( i = state.numFunctions; i < functions.Num(); i++ ) {
 		functions[ i ].Clear();
 	}
-	functions.SetNum( top_functions	);
+	functions.SetNum( state.numFunctions );
 
-	statements.SetNum( top_statements );
-	fileList.SetNum( top_files, false );
+	statements.SetNum( state.numStatements );
+	BuildCode( g_scriptSuperInstructions.GetBool() );
+	fileList.SetNum( state.numFiles, false );
 	filename.Clear();
 
-	// reset the variables to their default values
-	numVariables = variableDefaults.Num();
-	for( i = 0; i < numVariables; i++ ) {
-		variables[ i ] = variableDefaults[ i ];
-	}
+	numVariables = state.numVariables;
 }
 
 /*
@@ -133,6 +133,8 @@ private:
 	idStrList					parmNames;
 	idList<const function_t *>	functions;
 
+	friend class idProgram;
+
 public:
 	idVarDef					*def;						// a def that points to this type
 
@@ -453,6 +455,28 @@ typedef struct statement_s {
 	unsigned short	file;
 } statement_t;
 
+// statement with its operands resolved, built from the statements after every compile
+typedef struct scriptCode_s {
+	unsigned short	op;				// opcode or superinstruction
+	byte			frameA;			// 1 when the operand is a local stack variable
+	byte			frameB;
+	byte			frameC;
+	int				imm;			// jump offset, field offset, or offset of the constant arguments
+	intptr_t		a;				// address of global variables and constants, offset of stack variables
+	intptr_t		b;
+	intptr_t		c;
+} scriptCode_t;
+
+// size of the program at some point, used to drop whatever was compiled after it
+typedef struct programState_s {
+	int				numFunctions;
+	int				numStatements;
+	int				numTypes;
+	int				numDefs;
+	int				numFiles;
+	int				numVariables;
+} programState_t;
+
 /***********************************************************************
 
 idProgram
@@ -475,6 +499,8 @@ private:
 	idStaticList<byte,MAX_GLOBALS>				variableDefaults;
 	idStaticList<function_t,MAX_FUNCS>			functions;
 	idStaticList<statement_t,MAX_STATEMENTS>	statements;
+	idList<scriptCode_t>						code;
+	idList<byte>								codeConstants;		// arguments pushed by OP_EVENTCALL_CONST and OP_SYSCALL_CONST
 	idList<idTypeDef *>							types;
 	idList<idVarDefName *>						varDefNames;
 	idHashIndex									varDefNameHash;
@@ -489,6 +515,8 @@ private:
 	int											top_files;
 
 	void										CompileStats( void );
+	void										FuseStatements( void );
+	bool										SourceChecksum( const idStrList &files, unsigned int &crc ) const;
 	byte										*ReserveMem(int size);
 	idVarDef									*AllocVarDef(idTypeDef *type, const char *name, idVarDef *scope);
 
@@ -506,7 +534,11 @@ public:
 																						//    changed between savegames
 
 	void										Startup( const char *defaultScript );
+	bool										LoadCache( const char *sourceFile );
+	void										WriteCache( const char *sourceFile );
 	void										Restart( void );
+	void										SaveState( programState_t &state ) const;
+	void										RestoreState( const programState_t &state );
 	bool										CompileText( const char *source, const char *text, bool console );
 	const function_t							*CompileFunction( const char *functionName, const char *text );
 	void										CompileFile( const char *filename );
@@ -545,6 +577,10 @@ public:
 	statement_t									&GetStatement( int index );
 	int											NumStatements( void ) { return statements.Num(); }
 
+	void										BuildCode( bool superInstructions );
+	const scriptCode_t							*GetCode( void ) const { return code.Ptr(); }
+	const byte									*GetCodeConstants( void ) const { return codeConstants.Ptr(); }
+
 	int											GetReturnedInteger( void );
 
 	void										ReturnFloat( float value );
@@ -33,6 +33,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "framework/FileSystem.h"
 #include "framework/DeclEntityDef.h"
+#include "framework/Profiler.h"
 #include "Fx.h" //BC
 
 #include "WorldSpawn.h"
@@ -756,6 +757,8 @@ bool idThread::Execute( void ) {
 	idThread	*oldThread;
 	bool		done;
 
+	PROFILE_SCOPE( "idThread::Execute" );
+
 	if ( manualControl && ( waitingUntil > gameLocal.time ) ) {
 		return false;
 	}
@@ -300,6 +300,7 @@ public:
 	void						DoneProcessing( void ) { interpreter.doneProcessing = true; };
 	void						ContinueProcessing( void ) { interpreter.doneProcessing = false; };
 	bool						ThreadDying( void ) { return interpreter.threadDying; };
+	int							ExecutedInstructions( void ) const { return interpreter.executedInstructions; };
 	void						EndThread( void ) { interpreter.threadDying = true; };
 	bool						IsWaiting( void );
 	void						ClearWaitFor( void );
@@ -129,7 +129,8 @@ dhewm WIP		42
 
 // threads
 
-#define MAX_THREADS				(10)
+#define MAX_JOB_THREADS			(32)
+#define MAX_THREADS				(10 + MAX_JOB_THREADS)
 
 // SM: Add optionality support for different version builds
 #if !defined(NOSTEAM) && !defined(WINDOWSSTORE) && !defined(EPICSTORE)
@@ -29,6 +29,6 @@ If you have questions concerning this license or the applicable additional terms
 #ifndef __BUILD_VERSION_H__
 #define __BUILD_VERSION_H__
 
-const int BUILD_NUMBER = 3;
+const int BUILD_NUMBER = 4;
 
 #endif
\ No newline at end of file
@@ -42,6 +42,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "framework/Game.h"
 #include "framework/KeyInput.h"
 #include "framework/EventLoop.h"
+#include "framework/Profiler.h"
 #include "renderer/Image.h"
 #include "renderer/Model.h"
 #include "renderer/ModelManager.h"
@@ -2776,6 +2777,10 @@ void idCommonLocal::Frame( void ) {
 			g_SteamUtilities->RunCallbacks();
 		}
 
+		// mark the frame start for the profiler
+		profiler->BeginFrame( com_frameNumber );
+		PROFILE_SCOPE( "idCommon::Frame" );
+
 		//blendo eric: frame only time
 		uint64 frameStartTime = Sys_GetPerformanceCounter();
 
@@ -2792,6 +2797,9 @@ void idCommonLocal::Frame( void ) {
 
 		eventLoop->RunEventLoop();
 
+		// hand finished asynchronous reads to their callbacks
+		fileSystem->ServiceReads();
+
 		com_frameTime = com_ticNumber * USERCMD_MSEC;
 
 		idAsyncNetwork::RunFrame();
@@ -2802,13 +2810,18 @@ void idCommonLocal::Frame( void ) {
 
 		if ( idAsyncNetwork::IsActive() ) {
 			if ( idAsyncNetwork::serverDedicated.GetInteger() != 1 ) {
+				PROFILE_SCOPE( "idSession::UpdateScreen" );
 				session->GuiFrameEvents();
 				session->UpdateScreen( false );
 			}
 		} else {
-			session->Frame();
+			{
+				PROFILE_SCOPE( "idSession::Frame" );
+				session->Frame();
+			}
 
 			// normal, in-sequence screen update
+			PROFILE_SCOPE( "idSession::UpdateScreen" );
 			session->UpdateScreen( false );
 		}
 
@@ -3145,6 +3158,8 @@ void idCommonLocal::LoadGameDLL( void ) {
 	gameImport.declManager				= ::declManager;
 	gameImport.AASFileManager			= ::AASFileManager;
 	gameImport.collisionModelManager	= ::collisionModelManager;
+	gameImport.jobSystem				= ::jobSystem;
+	gameImport.profiler					= ::profiler;
 
 	gameExport							= *GetGameAPI( &gameImport );
 
@@ -3435,6 +3450,12 @@ void idCommonLocal::Shutdown( void ) {
 	// game specific shut down
 	ShutdownGame( false );
 
+	// stop the job workers
+	jobSystem->Shutdown();
+
+	// free the profiler buffers once no thread records anymore
+	profiler->Shutdown();
+
 	// shut down non-portable system services
 	Sys_Shutdown();
 
@@ -3499,6 +3520,12 @@ void idCommonLocal::InitGame( void ) {
 	}
 #endif
 
+	// the profiler commands are available before anything else starts
+	profiler->Init();
+
+	// start the job workers, the file system and decl manager may already use them
+	jobSystem->Init();
+
 	// initialize the file system
 	fileSystem->Init();
 
@@ -29,6 +29,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "sys/platform.h"
 #include "framework/Common.h"
 #include "framework/Game.h"
+#include "framework/File.h"
 
 #include "framework/DeclEntityDef.h"
 
@@ -38,7 +39,7 @@ idDeclEntityDef::Size
 =================
 */
 size_t idDeclEntityDef::Size( void ) const {
-	return sizeof( idDeclEntityDef ) + dict.Allocated();
+	return sizeof( idDeclEntityDef ) + dict.Allocated() + inherited.Allocated();
 }
 
 /*
@@ -48,6 +49,7 @@ idDeclEntityDef::FreeData
 */
 void idDeclEntityDef::FreeData( void ) {
 	dict.Clear();
+	inherited.Clear();
 }
 
 /*
@@ -117,7 +119,6 @@ bool idDeclEntityDef::Parse( const char *text, const int textLength ) {
 	// never be parsed mroe than once
 
 	// find all of the dicts first, because copying inherited values will modify the dict
-	idList<const idDeclEntityDef *> defList;
 
 	while ( 1 ) {
 		const idKeyValue *kv;
@@ -129,17 +130,18 @@ bool idDeclEntityDef::Parse( const char *text, const int textLength ) {
 		const idDeclEntityDef *copy = static_cast<const idDeclEntityDef *>( declManager->FindType( DECL_ENTITYDEF, kv->GetValue(), false ) );
 		if ( !copy ) {
 			src.Warning( "Unknown entityDef '%s' inherited by '%s'", kv->GetValue().c_str(), GetName() );
-		} else {
-			defList.Append( copy );
 		}
+		inherited.Append( copy );
 
 		// delete this key/value pair
 		dict.Delete( kv->GetKey() );
 	}
 
 	// now copy over the inherited key / value pairs
-	for ( int i = 0 ; i < defList.Num() ; i++ ) {
-		dict.SetDefaults( &defList[ i ]->dict );
+	for ( int i = 0 ; i < inherited.Num() ; i++ ) {
+		if ( inherited[ i ] ) {
+			dict.SetDefaults( &inherited[ i ]->dict );
+		}
 	}
 
 	// precache all referenced media
@@ -151,6 +153,60 @@ bool idDeclEntityDef::Parse( const char *text, const int textLength ) {
 	return true;
 }
 
+/*
+================
+idDeclEntityDef::WriteBinary
+
+The dict is written with the inherited key / value pairs already copied over.
+================
+*/
+bool idDeclEntityDef::WriteBinary( idFile *f, idList<const idDecl *> &dependencies ) const {
+	int i;
+
+	for ( i = 0; i < inherited.Num(); i++ ) {
+		// parse it again to get the warning
+		if ( !inherited[i] ) {
+			return false;
+		}
+		dependencies.Append( inherited[i] );
+	}
+
+	f->WriteInt( dict.GetNumKeyVals() );
+	for ( i = 0; i < dict.GetNumKeyVals(); i++ ) {
+		const idKeyValue *kv = dict.GetKeyVal( i );
+		f->WriteString( kv->GetKey() );
+		f->WriteString( kv->GetValue() );
+	}
+	return true;
+}
+
+/*
+================
+idDeclEntityDef::ReadBinary
+================
+*/
+bool idDeclEntityDef::ReadBinary( idFile *f ) {
+	int		i, num;
+	idStr	key, value;
+
+	f->ReadInt( num );
+	if ( num < 0 ) {
+		return false;
+	}
+	for ( i = 0; i < num; i++ ) {
+		f->ReadString( key );
+		f->ReadString( value );
+		dict.Set( key, value );
+	}
+
+	// precache all referenced media like Parse() does
+	if ( !( com_editors & (EDITOR_RADIANT|EDITOR_AAS) ) ) {
+		game->CacheDictionaryMedia( &dict );
+	}
+
+	return true;
+}
+
 /*
 ================
 idDeclEntityDef::DefaultDefinition
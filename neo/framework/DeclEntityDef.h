@@ -49,6 +49,12 @@ public:
 	virtual bool			Parse( const char *text, const int textLength );
 	virtual void			FreeData( void );
 	virtual void			Print( void ) const;
+	virtual bool			WriteBinary( idFile *f, idList<const idDecl *> &dependencies ) const;
+	virtual bool			ReadBinary( idFile *f );
+
+private:
+							// entityDefs the dict inherited values from, NULL for unknown ones
+	idList<const idDeclEntityDef *>	inherited;
 };
 
 #endif /* !__DECLENTITYDEF_H__ */
@@ -81,11 +81,22 @@ missing reload over a previously explicit definition
 #define USE_COMPRESSED_DECLS
 //#define GET_HUFFMAN_FREQUENCIES
 
+// the binary decl cache holds the scanned decls of a decl file and the binary parse results,
+// the version has to change with the huffman frequencies and the WriteBinary() formats
+#define DECL_CACHE_DIR			"generated/decls"
+#define DECL_CACHE_EXTENSION	".bdc"
+#define DECL_CACHE_MAGIC		( ( 'B' << 24 ) | ( 'D' << 16 ) | ( 'C' << 8 ) | 'L' )
+#define DECL_CACHE_VERSION		2
+
 class idDeclType {
 public:
 	idStr						typeName;
 	declType_t					type;
 	idDecl *					(*allocator)( void );
+
+	int							numParses;			// for listDeclTimes
+	int							numBinaryParses;	// parses that used the binary decl cache
+	double						parseTimeMS;		// includes decls parsed from inside Parse()
 };
 
 class idDeclFolder {
@@ -93,10 +104,45 @@ public:
 	idStr						folder;
 	idStr						extension;
 	declType_t					defaultType;
+
+	int							numFiles;			// for listDeclTimes
+	int							numCachedFiles;		// files that didn't have to be scanned
+	int							numDecls;
+	double						loadTimeMS;
+	bool						loadedParallel;
 };
 
 class idDeclFile;
 
+// a decl found while scanning a decl file
+typedef struct {
+	declType_t					type;
+	idStr						name;
+	int							textOffset;
+	int							textLength;
+	int							sourceLine;
+	int							checksum;
+	char *						textSource;			// text in the form SetTextLocal stores it
+	int							compressedLength;
+	byte *						binary;				// binary parse result from the decl cache
+	int							binaryLength;
+} declScanEntry_t;
+
+// decl files are scanned on the job workers, the decls found are added in file order on the main thread
+typedef struct {
+	idDeclFile *				file;
+	const char *				buffer;
+	int							length;
+	const byte *				cache;				// contents of the decl cache file if there is one
+	int							cacheLength;
+	bool						quiet;				// stop at the first problem instead of printing it
+	bool						clean;				// no problems, otherwise the file is scanned again on the main thread
+	bool						cached;				// decls came from the decl cache file
+	int							checksum;
+	int							numLines;
+	idList<declScanEntry_t>		decls;
+} declFileScan_t;
+
 class idDeclLocal : public idDeclBase {
 	friend class idDeclFile;
 	friend class idDeclManagerLocal;
@@ -131,13 +177,15 @@ protected:
 	virtual void				FreeData( void );
 	virtual void				List( void ) const;
 	virtual void				Print( void ) const;
+	virtual bool				WriteBinary( idFile *f, idList<const idDecl *> &dependencies ) const;
+	virtual bool				ReadBinary( idFile *f );
 
 protected:
 	void						AllocateSelf( void );
 
 								// Parses the decl definition.
 								// After calling parse, a decl will be guaranteed usable.
-	void						ParseLocal( void );
+	void						ParseLocal( const char *text = NULL );
 
 								// Does a MakeDefualt, but flags the decl so that it
 								// will Parse() the next time the decl is found.
@@ -145,6 +193,16 @@ protected:
 
 								// Set textSource possible with compression.
 	void						SetTextLocal( const char *text, const int length );
+								// Takes over text that was already prepared by CompressDeclText.
+	void						SetCompressedTextLocal( char *compressed, int compressedLength, int length, int checksum );
+
+								// Stores the binary parse result of the decl together with
+								// the decls it depends on.
+	void						WriteBinaryLocal( void );
+								// Restores the binary parse result if none of the decls
+								// it depends on changed.
+	bool						ReadBinaryLocal( void );
+	void						FreeBinaryLocal( void );
 
 private:
 	idDecl *					self;
@@ -158,6 +216,8 @@ private:
 	int							sourceTextLength;		// length of decl text in source file
 	int							sourceLine;				// this is where the actual declaration token starts
 	int							checksum;				// checksum of the decl text
+	byte *						binaryData;				// binary parse result for the decl cache
+	int							binaryLength;
 	declType_t					type;					// decl type
 	declState_t					declState;				// decl state
 	int							index;					// index in the per-type list
@@ -177,6 +237,14 @@ public:
 
 	void						Reload( bool force );
 	int							LoadAndParse();
+								// finds the decls in a file, only touches the scan so it can run on any thread
+	void						Scan( declFileScan_t &scan ) const;
+								// adds the scanned decls to the decl manager
+	void						Commit( declFileScan_t &scan );
+								// takes the scan from the decl cache file if the file didn't change
+	bool						ReadCache( declFileScan_t &scan ) const;
+	void						WriteCache( void );
+	idStr						CacheName( void ) const;
 
 public:
 	idStr						fileName;
@@ -186,12 +254,15 @@ public:
 	int							checksum;
 	int							fileSize;
 	int							numLines;
+	bool						cacheDirty;		// the decl cache file has to be written
+	bool						textEdited;		// decl text was set in memory, so the decl cache doesn't match the file
 
 	idDeclLocal *				decls;
 };
 
 class idDeclManagerLocal : public idDeclManager {
 	friend class idDeclLocal;
+	friend class idDeclFile;
 
 public:
 	virtual void				Init( void );
@@ -232,6 +303,10 @@ public:
 	virtual const idSoundShader *	SoundByIndex( int index, bool forceParse = true );
 
 public:
+	void						LoadDeclFiles( const idList<idDeclFile *> &files, idDeclFolder *folder );
+	void						ParseDecls( declType_t type );
+	void						WriteDeclCaches( void );
+
 	static void					MakeNameCanonical( const char *name, char *result, int maxLength );
 	idDeclLocal *				FindTypeWithoutParsing( declType_t type, const char *name, bool makeDefault = true );
 
@@ -252,15 +327,23 @@ private:
 	int							indent;			// for MediaPrint
 	bool						insideLevelLoad;
 
+	idJobList *					declJobs;
+
 	static idCVar				decl_show;
+	static idCVar				decl_parallelLoad;
+	static idCVar				decl_binaryCache;
 
 private:
 	static void					ListDecls_f( const idCmdArgs &args );
 	static void					ReloadDecls_f( const idCmdArgs &args );
 	static void					TouchDecl_f( const idCmdArgs &args );
+	static void					ListDeclTimes_f( const idCmdArgs &args );
+	static void					ParseDecls_f( const idCmdArgs &args );
 };
 
 idCVar idDeclManagerLocal::decl_show( "decl_show", "0", CVAR_SYSTEM, "set to 1 to print parses, 2 to also print references", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+idCVar idDeclManagerLocal::decl_parallelLoad( "decl_parallelLoad", "1", CVAR_SYSTEM | CVAR_BOOL, "scan decl files and prepare decl text on the job workers" );
+idCVar idDeclManagerLocal::decl_binaryCache( "decl_binaryCache", "1", CVAR_SYSTEM | CVAR_INTEGER, "0 = always scan and parse the decl text, 1 = use the binary decl cache, 2 = rebuild the binary decl cache", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 
 idDeclManagerLocal	declManagerLocal;
 idDeclManager *		declManager = &declManagerLocal;
@@ -482,8 +565,6 @@ int HuffmanCompressText( const char *text, int textLength, byte *compressed, int
 	int i, j;
 	idBitMsg msg;
 
-	totalUncompressedLength += textLength;
-
 	msg.Init( compressed, maxCompressedSize );
 	msg.BeginWriting();
 	for ( i = 0; i < textLength; i++ ) {
@@ -496,11 +577,35 @@ int HuffmanCompressText( const char *text, int textLength, byte *compressed, int
 		}
 	}
 
-	totalCompressedLength += msg.GetSize();
-
 	return msg.GetSize();
 }
 
+/*
+================
+CompressDeclText
+
+returns the text as idDeclLocal stores it, doesn't touch any shared state so it can run on any thread
+================
+*/
+char *CompressDeclText( const char *text, int length, int &compressedLength ) {
+	char *textSource;
+
+#ifdef USE_COMPRESSED_DECLS
+	int maxBytesPerCode = ( maxHuffmanBits + 7 ) >> 3;
+	byte *compressed = (byte *)Mem_Alloc( length * maxBytesPerCode );
+	compressedLength = HuffmanCompressText( text, length, compressed, length * maxBytesPerCode );
+	textSource = (char *)Mem_Alloc( compressedLength );
+	memcpy( textSource, compressed, compressedLength );
+	Mem_Free( compressed );
+#else
+	compressedLength = length;
+	textSource = (char *) Mem_Alloc( length + 1 );
+	memcpy( textSource, text, length );
+	textSource[length] = '\0';
+#endif
+	return textSource;
+}
+
 /*
 ================
 HuffmanDecompressText
@@ -567,6 +672,8 @@ idDeclFile::idDeclFile( const char *fileName, declType_t defaultType ) {
 	this->checksum = 0;
 	this->fileSize = 0;
 	this->numLines = 0;
+	this->cacheDirty = false;
+	this->textEdited = false;
 	this->decls = NULL;
 }
 
@@ -582,6 +689,8 @@ idDeclFile::idDeclFile() {
 	this->checksum = 0;
 	this->fileSize = 0;
 	this->numLines = 0;
+	this->cacheDirty = false;
+	this->textEdited = false;
 	this->decls = NULL;
 }
 
@@ -617,16 +726,9 @@ This is used during both the initial load, and any reloads
 int c_savedMemory = 0;
 
 int idDeclFile::LoadAndParse() {
-	int			i, numTypes;
-	idLexer		src;
-	idToken		token;
-	int			startMarker;
-	char *		buffer;
-	int			length, size;
-	int			sourceLine;
-	idStr		name;
-	idDeclLocal *newDecl;
-	bool		reparse;
+	declFileScan_t	scan;
+	char *			buffer;
+	int				length;
 
 	// load the text
 	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
@@ -636,22 +738,241 @@ int idDeclFile::LoadAndParse() {
 		return 0;
 	}
 
-	if ( !src.LoadMemory( buffer, length, fileName ) ) {
-		common->Error( "Couldn't parse %s", fileName.c_str() );
-		Mem_Free( buffer );
-		return 0;
+	scan.file = this;
+	scan.buffer = buffer;
+	scan.length = length;
+	scan.cache = NULL;
+	scan.cacheLength = 0;
+	scan.quiet = false;
+
+	if ( declManagerLocal.decl_binaryCache.GetInteger() == 1 ) {
+		scan.cacheLength = fileSystem->ReadFile( CacheName(), (void **)&scan.cache );
+	}
+	if ( !ReadCache( scan ) ) {
+		Scan( scan );
 	}
+	Commit( scan );
 
-	// mark all the defs that were from the last reload of this file
-	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
-		decl->redefinedInReload = false;
+	if ( scan.cache ) {
+		fileSystem->FreeFile( (void *)scan.cache );
 	}
+	Mem_Free( buffer );
 
-	src.SetFlags( DECL_LEXER_FLAGS );
+	return checksum;
+}
+
+/*
+================
+idDeclFile::CacheName
+================
+*/
+idStr idDeclFile::CacheName( void ) const {
+	return idStr( DECL_CACHE_DIR "/" ) + fileName + DECL_CACHE_EXTENSION;
+}
+
+/*
+================
+idDeclFile::ReadCache
+
+The cache is used if the file has the length and checksum it had when the cache
+was written, which is still far cheaper than lexing the file. Only touches the
+scan so it can run on any thread.
+================
+*/
+bool idDeclFile::ReadCache( declFileScan_t &scan ) const {
+	int			i, value, numDecls;
+	idStr		typeName;
+
+	scan.cached = false;
+	if ( scan.cache == NULL || scan.cacheLength <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory file( fileName, (const char *)scan.cache, scan.cacheLength );
+
+	file.ReadInt( value );
+	if ( value != DECL_CACHE_MAGIC ) {
+		return false;
+	}
+	file.ReadInt( value );
+	if ( value != DECL_CACHE_VERSION ) {
+		return false;
+	}
+	file.ReadInt( value );
+	if ( value != scan.length ) {
+		return false;
+	}
+	file.ReadInt( value );
+	if ( value != MD5_BlockChecksum( scan.buffer, scan.length ) ) {
+		return false;
+	}
+
+	scan.checksum = value;
+	scan.clean = true;
+	scan.decls.Clear();
+	file.ReadInt( scan.numLines );
+	file.ReadInt( numDecls );
+	if ( numDecls < 0 ) {
+		return false;
+	}
+	scan.decls.SetNum( numDecls );
+
+	for ( i = 0; i < numDecls; i++ ) {
+		declScanEntry_t &decl = scan.decls[i];
+		decl.textSource = NULL;
+		decl.binary = NULL;
+	}
+
+	for ( i = 0; i < numDecls; i++ ) {
+		declScanEntry_t &decl = scan.decls[i];
+
+		file.ReadString( typeName );
+		decl.type = declManagerLocal.GetDeclTypeFromName( typeName );
+		file.ReadString( decl.name );
+		file.ReadInt( decl.textOffset );
+		file.ReadInt( decl.textLength );
+		file.ReadInt( decl.sourceLine );
+		file.ReadInt( decl.checksum );
+		file.ReadInt( decl.compressedLength );
+		file.ReadInt( decl.binaryLength );
+		if ( decl.type == DECL_MAX_TYPES || decl.textOffset < 0 || decl.textLength <= 0 || decl.textOffset + decl.textLength > scan.length ||
+				decl.compressedLength <= 0 || decl.binaryLength < 0 || decl.compressedLength + decl.binaryLength > file.Length() - file.Tell() ) {
+			break;
+		}
+
+		decl.textSource = (char *)Mem_Alloc( decl.compressedLength );
+		file.Read( decl.textSource, decl.compressedLength );
+		if ( decl.binaryLength > 0 ) {
+			decl.binary = (byte *)Mem_Alloc( decl.binaryLength );
+			file.Read( decl.binary, decl.binaryLength );
+		}
+	}
+
+	if ( i < numDecls ) {
+		for ( i = 0; i < numDecls; i++ ) {
+			Mem_Free( scan.decls[i].textSource );
+			Mem_Free( scan.decls[i].binary );
+		}
+		scan.decls.Clear();
+		return false;
+	}
 
-	checksum = MD5_BlockChecksum( buffer, length );
+	scan.cached = true;
+	return true;
+}
 
-	fileSize = length;
+/*
+================
+idDeclFile::WriteCache
+
+The decls are written in file order, so the cache commits like a fresh scan.
+================
+*/
+void idDeclFile::WriteCache( void ) {
+	idList<idDeclLocal *>	fileDecls;
+	idDeclLocal *			decl;
+	idFile *				file;
+	int						i, j;
+
+	cacheDirty = false;
+	if ( textEdited || this == declManagerLocal.GetImplicitDeclFile() ) {
+		return;
+	}
+
+	for ( decl = decls; decl; decl = decl->nextInFile ) {
+		// decls removed from the file stay around as defaults
+		if ( decl->sourceTextLength > 0 && decl->textSource != NULL ) {
+			for ( i = 0; i < fileDecls.Num(); i++ ) {
+				if ( fileDecls[i]->sourceTextOffset > decl->sourceTextOffset ) {
+					break;
+				}
+			}
+			fileDecls.Insert( decl, i );
+		}
+	}
+
+	file = fileSystem->OpenFileWrite( CacheName(), "fs_savepath" );
+	if ( file == NULL ) {
+		common->Warning( "couldn't write decl cache %s", CacheName().c_str() );
+		return;
+	}
+
+	file->WriteInt( DECL_CACHE_MAGIC );
+	file->WriteInt( DECL_CACHE_VERSION );
+	file->WriteInt( fileSize );
+	file->WriteInt( checksum );
+	file->WriteInt( numLines );
+	file->WriteInt( fileDecls.Num() );
+	for ( j = 0; j < fileDecls.Num(); j++ ) {
+		decl = fileDecls[j];
+		file->WriteString( declManagerLocal.GetDeclNameFromType( decl->type ) );
+		file->WriteString( decl->name );
+		file->WriteInt( decl->sourceTextOffset );
+		file->WriteInt( decl->sourceTextLength );
+		file->WriteInt( decl->sourceLine );
+		file->WriteInt( decl->checksum );
+		file->WriteInt( decl->compressedLength );
+		file->WriteInt( decl->binaryLength );
+		file->Write( decl->textSource, decl->compressedLength );
+		if ( decl->binaryLength > 0 ) {
+			file->Write( decl->binaryData, decl->binaryLength );
+		}
+	}
+
+	fileSystem->CloseFile( file );
+}
+
+/*
+================
+DeclScanWarning
+
+returns false if the scan has to stop
+================
+*/
+static bool DeclScanWarning( idLexer &src, declFileScan_t &scan, const char *fmt, ... ) id_attribute((format(printf,3,4)));
+
+static bool DeclScanWarning( idLexer &src, declFileScan_t &scan, const char *fmt, ... ) {
+	char	text[MAX_STRING_CHARS];
+	va_list	argptr;
+
+	if ( scan.quiet ) {
+		scan.clean = false;
+		return false;
+	}
+
+	va_start( argptr, fmt );
+	idStr::vsnPrintf( text, sizeof( text ), fmt, argptr );
+	va_end( argptr );
+
+	src.Warning( "%s", text );
+	return true;
+}
+
+/*
+================
+idDeclFile::Scan
+
+Identifies each individual declaration and prepares its text. Warnings are only
+printed if the scan isn't quiet, as printing is only allowed on the main thread.
+================
+*/
+void idDeclFile::Scan( declFileScan_t &scan ) const {
+	int			i, numTypes;
+	idLexer		src;
+	idToken		token;
+	int			startMarker;
+	int			size;
+	int			sourceLine;
+	idStr		name;
+
+	scan.clean = true;
+	scan.cached = false;
+	scan.decls.Clear();
+	scan.checksum = MD5_BlockChecksum( scan.buffer, scan.length );
+	scan.numLines = 0;
+
+	src.LoadMemory( scan.buffer, scan.length, fileName );
+	src.SetFlags( DECL_LEXER_FLAGS | ( scan.quiet ? ( LEXFL_NOERRORS | LEXFL_NOWARNINGS ) : 0 ) );
 
 	// scan through, identifying each individual declaration
 	while( 1 ) {
@@ -681,14 +1002,18 @@ int idDeclFile::LoadAndParse() {
 			if ( token.Icmp( "{" ) == 0 ) {
 
 				// if we ever see an open brace, we somehow missed the [type] <name> prefix
-				src.Warning( "Missing decl name" );
+				if ( !DeclScanWarning( src, scan, "Missing decl name" ) ) {
+					break;
+				}
 				src.SkipBracedSection( false );
 				continue;
 
 			} else {
 
 				if ( defaultType == DECL_MAX_TYPES ) {
-					src.Warning( "No type" );
+					if ( !DeclScanWarning( src, scan, "No type" ) ) {
+						break;
+					}
 					continue;
 				}
 				src.UnreadToken( &token );
@@ -699,13 +1024,15 @@ int idDeclFile::LoadAndParse() {
 
 		// now parse the name
 		if ( !src.ReadToken( &token ) ) {
-			src.Warning( "Type without definition at end of file" );
+			DeclScanWarning( src, scan, "Type without definition at end of file" );
 			break;
 		}
 
 		if ( !token.Icmp( "{" ) ) {
 			// if we ever see an open brace, we somehow missed the [type] <name> prefix
-			src.Warning( "Missing decl name" );
+			if ( !DeclScanWarning( src, scan, "Missing decl name" ) ) {
+				break;
+			}
 			src.SkipBracedSection( false );
 			continue;
 		}
@@ -720,11 +1047,13 @@ int idDeclFile::LoadAndParse() {
 
 		// make sure there's a '{'
 		if ( !src.ReadToken( &token ) ) {
-			src.Warning( "Type without definition at end of file" );
+			DeclScanWarning( src, scan, "Type without definition at end of file" );
 			break;
 		}
 		if ( token != "{" ) {
-			src.Warning( "Expecting '{' but found '%s'", token.c_str() );
+			if ( !DeclScanWarning( src, scan, "Expecting '{' but found '%s'", token.c_str() ) ) {
+				break;
+			}
 			continue;
 		}
 		src.UnreadToken( &token );
@@ -733,15 +1062,75 @@ int idDeclFile::LoadAndParse() {
 		src.SkipBracedSection();
 		size = src.GetFileOffset() - startMarker;
 
+		declScanEntry_t &decl = scan.decls.Alloc();
+		decl.type = identifiedType;
+		decl.name = name;
+		decl.textOffset = startMarker;
+		decl.textLength = size;
+		decl.sourceLine = sourceLine;
+		decl.checksum = MD5_BlockChecksum( scan.buffer + startMarker, size );
+		decl.textSource = CompressDeclText( scan.buffer + startMarker, size, decl.compressedLength );
+		decl.binary = NULL;
+		decl.binaryLength = 0;
+	}
+
+	// the lexer kept quiet about something
+	if ( src.HadError() || src.HadWarning() ) {
+		if ( scan.quiet ) {
+			scan.clean = false;
+		}
+	}
+
+	scan.numLines = src.GetLineNum();
+}
+
+/*
+================
+idDeclFile::Commit
+
+also used to throw away a scan that wasn't clean
+================
+*/
+void idDeclFile::Commit( declFileScan_t &scan ) {
+	idDeclLocal *newDecl;
+	bool		reparse;
+	int			i;
+
+	if ( !scan.clean ) {
+		for ( i = 0; i < scan.decls.Num(); i++ ) {
+			Mem_Free( scan.decls[i].textSource );
+			Mem_Free( scan.decls[i].binary );
+		}
+		scan.decls.Clear();
+		return;
+	}
+
+	// mark all the defs that were from the last reload of this file
+	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
+		decl->redefinedInReload = false;
+	}
+
+	checksum = scan.checksum;
+	fileSize = scan.length;
+	cacheDirty = !scan.cached;
+	textEdited = false;
+
+	for ( i = 0; i < scan.decls.Num(); i++ ) {
+		declScanEntry_t &scanned = scan.decls[i];
+
 		// look it up, possibly getting a newly created default decl
 		reparse = false;
-		newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, false );
+		newDecl = declManagerLocal.FindTypeWithoutParsing( scanned.type, scanned.name, false );
 		if ( newDecl ) {
 			// update the existing copy
 			if ( newDecl->sourceFile != this || newDecl->redefinedInReload )
 			{
+				Mem_Free( scanned.textSource );
+				scanned.textSource = NULL;
+				Mem_Free( scanned.binary );
+				scanned.binary = NULL;
 				//BC this used to be a src.warning but I'm changing it to Error to make it stop the game.
-				common->Error( "%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType( identifiedType ), name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
+				common->Error( "%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType( scanned.type ), scanned.name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
 				continue;
 			}
 			if ( newDecl->declState != DS_UNPARSED ) {
@@ -749,23 +1138,28 @@ int idDeclFile::LoadAndParse() {
 			}
 		} else {
 			// allow it to be created as a default, then add it to the per-file list
-			newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, true );
+			newDecl = declManagerLocal.FindTypeWithoutParsing( scanned.type, scanned.name, true );
 			newDecl->nextInFile = this->decls;
 			this->decls = newDecl;
 		}
 
 		newDecl->redefinedInReload = true;
 
-		if ( newDecl->textSource ) {
-			Mem_Free( newDecl->textSource );
-			newDecl->textSource = NULL;
+#ifdef GET_HUFFMAN_FREQUENCIES
+		for( int j = 0; j < scanned.textLength; j++ ) {
+			huffmanFrequencies[((const unsigned char *)scan.buffer)[scanned.textOffset + j]]++;
 		}
+#endif
 
-		newDecl->SetTextLocal( buffer + startMarker, size );
+		newDecl->SetCompressedTextLocal( scanned.textSource, scanned.compressedLength, scanned.textLength, scanned.checksum );
+		scanned.textSource = NULL;
+		newDecl->binaryData = scanned.binary;
+		newDecl->binaryLength = scanned.binaryLength;
+		scanned.binary = NULL;
 		newDecl->sourceFile = this;
-		newDecl->sourceTextOffset = startMarker;
-		newDecl->sourceTextLength = size;
-		newDecl->sourceLine = sourceLine;
+		newDecl->sourceTextOffset = scanned.textOffset;
+		newDecl->sourceTextLength = scanned.textLength;
+		newDecl->sourceLine = scanned.sourceLine;
 		newDecl->declState = DS_UNPARSED;
 
 		// if it is currently in use, reparse it immedaitely
@@ -774,9 +1168,8 @@ int idDeclFile::LoadAndParse() {
 		}
 	}
 
-	numLines = src.GetLineNum();
-
-	Mem_Free( buffer );
+	numLines = scan.numLines;
+	scan.decls.Clear();
 
 	// any defs that weren't redefinedInReload should now be defaulted
 	for ( idDeclLocal *decl = decls ; decl ; decl = decl->nextInFile ) {
@@ -787,8 +1180,6 @@ int idDeclFile::LoadAndParse() {
 			decl->sourceLine = decl->sourceFile->numLines;
 		}
 	}
-
-	return checksum;
 }
 
 /*
@@ -811,6 +1202,7 @@ void idDeclManagerLocal::Init( void ) {
 	common->Printf( "----- Initializing Decls -----\n" );
 
 	checksum = 0;
+	declJobs = NULL;
 
 #ifdef USE_COMPRESSED_DECLS
 	SetupHuffman();
@@ -877,6 +1269,9 @@ void idDeclManagerLocal::Init( void ) {
 	cmdSystem->AddCommand( "printAudio", idPrintDecls_f<DECL_AUDIO>, CMD_FL_SYSTEM, "prints an Video", idCmdSystem::ArgCompletion_Decl<DECL_AUDIO> );
 
 	cmdSystem->AddCommand( "listHuffmanFrequencies", ListHuffmanFrequencies_f, CMD_FL_SYSTEM, "lists decl text character frequencies" );
+
+	cmdSystem->AddCommand( "listDeclTimes", ListDeclTimes_f, CMD_FL_SYSTEM, "lists the time spent loading decl folders and parsing decl types" );
+	cmdSystem->AddCommand( "parseDecls", ParseDecls_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "parses all decls of a type that haven't been parsed yet" );
 }
 
 /*
@@ -888,6 +1283,8 @@ void idDeclManagerLocal::Shutdown( void ) {
 	int			i, j;
 	idDeclLocal *decl;
 
+	WriteDeclCaches();
+
 	// free decls
 	for ( i = 0; i < DECL_MAX_TYPES; i++ ) {
 		for ( j = 0; j < linearLists[i].Num(); j++ ) {
@@ -900,6 +1297,7 @@ void idDeclManagerLocal::Shutdown( void ) {
 				Mem_Free( decl->textSource );
 				decl->textSource = NULL;
 			}
+			decl->FreeBinaryLocal();
 			delete decl;
 		}
 		linearLists[i].Clear();
@@ -913,6 +1311,11 @@ void idDeclManagerLocal::Shutdown( void ) {
 	declTypes.DeleteContents( true );
 	declFolders.DeleteContents( true );
 
+	if ( declJobs ) {
+		jobSystem->FreeJobList( declJobs );
+		declJobs = NULL;
+	}
+
 #ifdef USE_COMPRESSED_DECLS
 	ShutdownHuffman();
 #endif
@@ -957,8 +1360,29 @@ idDeclManagerLocal::EndLevelLoad
 void idDeclManagerLocal::EndLevelLoad() {
 	insideLevelLoad = false;
 
-	// we don't need to do anything here, but the image manager, model manager,
-	// and sound sample manager will need to free media that was not referenced
+	// store the decls parsed for this level
+	WriteDeclCaches();
+
+	// the image manager, model manager, and sound sample manager
+	// will need to free media that was not referenced
+}
+
+/*
+===================
+idDeclManagerLocal::WriteDeclCaches
+
+writes the cache files of decl files that were scanned or got new binary parse results
+===================
+*/
+void idDeclManagerLocal::WriteDeclCaches( void ) {
+	if ( decl_binaryCache.GetInteger() == 0 ) {
+		return;
+	}
+	for ( int i = 0; i < loadedFiles.Num(); i++ ) {
+		if ( loadedFiles[i]->cacheDirty ) {
+			loadedFiles[i]->WriteCache();
+		}
+	}
 }
 
 /*
@@ -978,6 +1402,9 @@ void idDeclManagerLocal::RegisterDeclType( const char *typeName, declType_t type
 	declType->typeName = typeName;
 	declType->type = type;
 	declType->allocator = allocator;
+	declType->numParses = 0;
+	declType->numBinaryParses = 0;
+	declType->parseTimeMS = 0.0;
 
 	if ( (int)type + 1 > declTypes.Num() ) {
 		declTypes.AssureSize( (int)type + 1, NULL );
@@ -1010,6 +1437,11 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 		declFolder->folder = folder;
 		declFolder->extension = extension;
 		declFolder->defaultType = defaultType;
+		declFolder->numFiles = 0;
+		declFolder->numCachedFiles = 0;
+		declFolder->numDecls = 0;
+		declFolder->loadTimeMS = 0.0;
+		declFolder->loadedParallel = false;
 		declFolders.Append( declFolder );
 	}
 
@@ -1017,6 +1449,7 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 	fileList = fileSystem->ListFiles( declFolder->folder, declFolder->extension, true );
 
 	// load and parse decl files
+	idList<idDeclFile *> files;
 	for ( i = 0; i < fileList->GetNumFiles(); i++ ) {
 		fileName = declFolder->folder + "/" + fileList->GetFile( i );
 
@@ -1032,10 +1465,200 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 			df = new idDeclFile( fileName, defaultType );
 			loadedFiles.Append( df );
 		}
-		df->LoadAndParse();
+		files.Append( df );
 	}
+	LoadDeclFiles( files, declFolder );
 
 	fileSystem->FreeFileList( fileList );
+
+	// so the next start doesn't have to scan the files
+	WriteDeclCaches();
+}
+
+/*
+===================
+DeclScan_Run
+===================
+*/
+static void DeclScan_Run( void *data ) {
+	declFileScan_t *scan = (declFileScan_t *)data;
+	if ( !scan->file->ReadCache( *scan ) ) {
+		scan->file->Scan( *scan );
+	}
+}
+
+/*
+===================
+idDeclManagerLocal::LoadDeclFiles
+
+The files and their decl cache files are read in one go, scanned on the job
+workers and the decls are added in file order, so the result doesn't depend on
+the number of workers. Files that had any problem are scanned again on the main
+thread to print the warnings.
+===================
+*/
+void idDeclManagerLocal::LoadDeclFiles( const idList<idDeclFile *> &files, idDeclFolder *folder ) {
+	idList<const char *>	names;
+	idList<void *>			buffers;
+	idList<int>				lengths;
+	idList<ID_TIME_T>		timestamps;
+	idList<declFileScan_t>	scans;
+	idStrList				cacheNames;
+	uint64					startTime;
+	int						i, numRead;
+
+	startTime = Sys_GetPerformanceCounter();
+
+	folder->numFiles += files.Num();
+	folder->loadedParallel = decl_parallelLoad.GetBool() && jobSystem->GetNumWorkers() > 0 && files.Num() > 1;
+
+	if ( !folder->loadedParallel ) {
+		for ( i = 0; i < files.Num(); i++ ) {
+			files[i]->LoadAndParse();
+			if ( !files[i]->cacheDirty ) {
+				folder->numCachedFiles++;
+			}
+		}
+	} else {
+		// the decl cache files follow the decl files
+		numRead = ( decl_binaryCache.GetInteger() == 1 ) ? files.Num() * 2 : files.Num();
+		names.SetNum( numRead );
+		buffers.SetNum( numRead );
+		lengths.SetNum( numRead );
+		timestamps.SetNum( numRead );
+		scans.SetNum( files.Num() );
+
+		for ( i = 0; i < files.Num(); i++ ) {
+			names[i] = files[i]->fileName.c_str();
+		}
+		if ( numRead > files.Num() ) {
+			cacheNames.SetNum( files.Num() );
+			for ( i = 0; i < files.Num(); i++ ) {
+				cacheNames[i] = files[i]->CacheName();
+				names[files.Num() + i] = cacheNames[i].c_str();
+			}
+		}
+		fileSystem->ReadFiles( numRead, names.Ptr(), buffers.Ptr(), lengths.Ptr(), timestamps.Ptr() );
+
+		if ( !declJobs ) {
+			declJobs = jobSystem->AllocJobList( "declScan" );
+		}
+		for ( i = 0; i < files.Num(); i++ ) {
+			scans[i].file = files[i];
+			scans[i].buffer = (const char *)buffers[i];
+			scans[i].length = lengths[i];
+			scans[i].cache = ( numRead > files.Num() ) ? (const byte *)buffers[files.Num() + i] : NULL;
+			scans[i].cacheLength = ( numRead > files.Num() ) ? lengths[files.Num() + i] : 0;
+			scans[i].quiet = true;
+			scans[i].clean = false;
+			scans[i].cached = false;
+			if ( buffers[i] ) {
+				declJobs->AddJob( DeclScan_Run, &scans[i], "declScan" );
+			}
+		}
+		declJobs->Submit();
+		declJobs->Wait();
+		declJobs->Clear();
+
+		for ( i = 0; i < files.Num(); i++ ) {
+			idDeclFile *df = files[i];
+
+			common->DPrintf( "...loading '%s'\n", df->fileName.c_str() );
+			if ( !buffers[i] ) {
+				common->FatalError( "couldn't load %s", df->fileName.c_str() );
+			}
+			df->timestamp = timestamps[i];
+
+			if ( !scans[i].clean ) {
+				df->Commit( scans[i] );
+				scans[i].quiet = false;
+				df->Scan( scans[i] );
+			}
+			df->Commit( scans[i] );
+			if ( scans[i].cached ) {
+				folder->numCachedFiles++;
+			}
+
+			fileSystem->FreeFile( buffers[i] );
+			if ( numRead > files.Num() && buffers[files.Num() + i] ) {
+				fileSystem->FreeFile( buffers[files.Num() + i] );
+			}
+		}
+	}
+
+	for ( i = 0; i < files.Num(); i++ ) {
+		for ( idDeclLocal *decl = files[i]->decls; decl; decl = decl->nextInFile ) {
+			folder->numDecls++;
+		}
+	}
+	folder->loadTimeMS += Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+}
+
+/*
+===================
+DeclText_Run
+===================
+*/
+typedef struct {
+	const idDeclLocal *		decl;
+	char *					text;
+} declText_t;
+
+static void DeclText_Run( void *data ) {
+	declText_t *declText = (declText_t *)data;
+	declText->text = (char *)Mem_Alloc( declText->decl->GetTextLength() + 1 );
+	declText->decl->GetText( declText->text );
+}
+
+/*
+===================
+idDeclManagerLocal::ParseDecls
+
+Parse() of the decl types prints and finds other decls, images and sounds, so
+it has to stay on the main thread. The job workers decompress the decl text
+ahead and the decls are parsed in index order.
+===================
+*/
+void idDeclManagerLocal::ParseDecls( declType_t type ) {
+	idList<declText_t>	texts;
+	idDeclLocal *		decl;
+	int					i;
+
+	for ( i = 0; i < linearLists[type].Num(); i++ ) {
+		decl = linearLists[type][i];
+		if ( decl->declState == DS_UNPARSED && decl->textSource != NULL ) {
+			declText_t &declText = texts.Alloc();
+			declText.decl = decl;
+			declText.text = NULL;
+		}
+	}
+
+	if ( decl_parallelLoad.GetBool() && jobSystem->GetNumWorkers() > 0 ) {
+		if ( !declJobs ) {
+			declJobs = jobSystem->AllocJobList( "declScan" );
+		}
+		for ( i = 0; i < texts.Num(); i++ ) {
+			// most likely restored from the binary parse result without the text
+			if ( texts[i].decl->binaryData == NULL ) {
+				declJobs->AddJob( DeclText_Run, &texts[i], "declText" );
+			}
+		}
+		declJobs->Submit();
+		declJobs->Wait();
+		declJobs->Clear();
+	}
+
+	for ( i = 0; i < texts.Num(); i++ ) {
+		decl = const_cast<idDeclLocal *>( texts[i].decl );
+		decl->AllocateSelf();
+		// an earlier Parse() may have parsed it already
+		if ( decl->declState == DS_UNPARSED ) {
+			decl->ParseLocal( texts[i].text );
+		}
+		if ( texts[i].text ) {
+			Mem_Free( texts[i].text );
+		}
+	}
 }
 
 /*
@@ -1669,6 +2292,61 @@ void idDeclManagerLocal::ReloadDecls_f( const idCmdArgs &args ) {
 	soundSystem->SetMute( false );
 }
 
+/*
+===================
+idDeclManagerLocal::ListDeclTimes_f
+===================
+*/
+void idDeclManagerLocal::ListDeclTimes_f( const idCmdArgs &args ) {
+	int i;
+
+	common->Printf( "folder           files cached  decls  load ms\n" );
+	for ( i = 0; i < declManagerLocal.declFolders.Num(); i++ ) {
+		const idDeclFolder *folder = declManagerLocal.declFolders[i];
+		common->Printf( "%-16s %5d  %5d  %5d  %7.2f%s\n", ( folder->folder + "/*" + folder->extension ).c_str(), folder->numFiles, folder->numCachedFiles,
+						folder->numDecls, folder->loadTimeMS, folder->loadedParallel ? " parallel" : "" );
+	}
+
+	common->Printf( "type               decls parses binary parse ms\n" );
+	for ( i = 0; i < declManagerLocal.declTypes.Num(); i++ ) {
+		const idDeclType *typeInfo = declManagerLocal.declTypes[i];
+		if ( typeInfo == NULL ) {
+			continue;
+		}
+		common->Printf( "%-18s %5d %6d %6d %8.2f\n", typeInfo->typeName.c_str(), declManagerLocal.linearLists[i].Num(), typeInfo->numParses,
+						typeInfo->numBinaryParses, typeInfo->parseTimeMS );
+	}
+	common->Printf( "parse times include decls parsed from inside other parses\n" );
+}
+
+/*
+===================
+idDeclManagerLocal::ParseDecls_f
+===================
+*/
+void idDeclManagerLocal::ParseDecls_f( const idCmdArgs &args ) {
+	if ( args.Argc() != 2 ) {
+		common->Printf( "usage: parseDecls <type>\n" );
+		return;
+	}
+
+	declType_t type = declManagerLocal.GetDeclTypeFromName( args.Argv( 1 ) );
+	if ( type == DECL_MAX_TYPES ) {
+		common->Printf( "unknown decl type '%s'\n", args.Argv( 1 ) );
+		return;
+	}
+
+	idDeclType *typeInfo = declManagerLocal.declTypes[type];
+	int numParses = typeInfo->numParses;
+	uint64 startTime = Sys_GetPerformanceCounter();
+
+	declManagerLocal.ParseDecls( type );
+
+	double totalMS = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+	common->Printf( "parsed %d %s decls in %.2f ms%s\n", typeInfo->numParses - numParses, typeInfo->typeName.c_str(), totalMS,
+					decl_parallelLoad.GetBool() && jobSystem->GetNumWorkers() > 0 ? ", text prepared on the job workers" : "" );
+}
+
 /*
 ===================
 idDeclManagerLocal::TouchDecl_f
@@ -1783,6 +2461,8 @@ idDeclLocal::idDeclLocal( void ) {
 	sourceTextLength = 0;
 	sourceLine = 0;
 	checksum = 0;
+	binaryData = NULL;
+	binaryLength = 0;
 	type = DECL_ENTITYDEF;
 	index = 0;
 	declState = DS_UNPARSED;
@@ -1923,6 +2603,9 @@ idDeclLocal::SetText
 */
 void idDeclLocal::SetText( const char *text ) {
 	SetTextLocal( text, idStr::Length( text ) );
+	if ( sourceFile != NULL ) {
+		sourceFile->textEdited = true;
+	}
 }
 
 /*
@@ -1931,10 +2614,8 @@ idDeclLocal::SetTextLocal
 =================
 */
 void idDeclLocal::SetTextLocal( const char *text, const int length ) {
-
-	Mem_Free( textSource );
-
-	checksum = MD5_BlockChecksum( text, length );
+	char *	compressed;
+	int		size;
 
 #ifdef GET_HUFFMAN_FREQUENCIES
 	for( int i = 0; i < length; i++ ) {
@@ -1942,19 +2623,29 @@ void idDeclLocal::SetTextLocal( const char *text, const int length ) {
 	}
 #endif
 
+	compressed = CompressDeclText( text, length, size );
+	SetCompressedTextLocal( compressed, size, length, MD5_BlockChecksum( text, length ) );
+}
+
+/*
+=================
+idDeclLocal::SetCompressedTextLocal
+=================
+*/
+void idDeclLocal::SetCompressedTextLocal( char *compressed, int compressedLength, int length, int checksum ) {
+
+	Mem_Free( textSource );
+	FreeBinaryLocal();
+
+	this->checksum = checksum;
+	textSource = compressed;
+	this->compressedLength = compressedLength;
+	textLength = length;
+
 #ifdef USE_COMPRESSED_DECLS
-	int maxBytesPerCode = ( maxHuffmanBits + 7 ) >> 3;
-	byte *compressed = (byte *)_alloca( length * maxBytesPerCode );
-	compressedLength = HuffmanCompressText( text, length, compressed, length * maxBytesPerCode );
-	textSource = (char *)Mem_Alloc( compressedLength );
-	memcpy( textSource, compressed, compressedLength );
-#else
-	compressedLength = length;
-	textSource = (char *) Mem_Alloc( length + 1 );
-	memcpy( textSource, text, length );
-	textSource[length] = '\0';
+	totalUncompressedLength += length;
+	totalCompressedLength += compressedLength;
 #endif
-	textLength = length;
 }
 
 /*
@@ -2156,6 +2847,135 @@ idDeclLocal::Print
 void idDeclLocal::Print() const {
 }
 
+/*
+=================
+idDeclLocal::WriteBinary
+=================
+*/
+bool idDeclLocal::WriteBinary( idFile *f, idList<const idDecl *> &dependencies ) const {
+	return false;
+}
+
+/*
+=================
+idDeclLocal::ReadBinary
+=================
+*/
+bool idDeclLocal::ReadBinary( idFile *f ) {
+	return false;
+}
+
+/*
+=================
+idDeclLocal::FreeBinaryLocal
+=================
+*/
+void idDeclLocal::FreeBinaryLocal( void ) {
+	if ( binaryData != NULL ) {
+		Mem_Free( binaryData );
+		binaryData = NULL;
+		binaryLength = 0;
+		if ( sourceFile != NULL ) {
+			sourceFile->cacheDirty = true;
+		}
+	}
+}
+
+/*
+=================
+idDeclLocal::WriteBinaryLocal
+
+The binary parse result starts with the type, name and text checksum of every decl
+it was built from, including the ones those were built from in turn.
+=================
+*/
+void idDeclLocal::WriteBinaryLocal( void ) {
+	idList<const idDecl *>	dependencies;
+	idList<idDeclLocal *>	decls;
+	idDeclLocal *			decl;
+	int						i, j, num, depType, depChecksum;
+	idStr					depName;
+
+	if ( sourceFile == NULL || sourceFile == &declManagerLocal.implicitDecls ) {
+		return;
+	}
+
+	idFile_Memory result( name );
+	if ( !self->WriteBinary( &result, dependencies ) ) {
+		return;
+	}
+
+	idFile_Memory header( name );
+	num = 0;
+	header.WriteInt( num );
+	for ( i = 0; i < dependencies.Num(); i++ ) {
+		decl = static_cast<idDeclLocal *>( dependencies[i]->base );
+		// a dependency without a binary parse result of its own may have changed unnoticed
+		if ( decl->binaryData == NULL || decl->sourceFile == &declManagerLocal.implicitDecls ) {
+			return;
+		}
+		if ( decls.FindIndex( decl ) >= 0 ) {
+			continue;
+		}
+		decls.Append( decl );
+		header.WriteInt( decl->type );
+		header.WriteString( decl->name );
+		header.WriteInt( decl->checksum );
+		num++;
+
+		idFile_Memory depFile( decl->name, (const char *)decl->binaryData, decl->binaryLength );
+		int numDeps;
+		depFile.ReadInt( numDeps );
+		for ( j = 0; j < numDeps; j++ ) {
+			depFile.ReadInt( depType );
+			depFile.ReadString( depName );
+			depFile.ReadInt( depChecksum );
+			header.WriteInt( depType );
+			header.WriteString( depName );
+			header.WriteInt( depChecksum );
+			num++;
+		}
+	}
+	header.Write( result.GetDataPtr(), result.Length() );
+
+	FreeBinaryLocal();
+	binaryLength = header.Length();
+	binaryData = (byte *)Mem_Alloc( binaryLength );
+	memcpy( binaryData, header.GetDataPtr(), binaryLength );
+	*(int *)binaryData = LittleInt( num );
+
+	sourceFile->cacheDirty = true;
+}
+
+/*
+=================
+idDeclLocal::ReadBinaryLocal
+=================
+*/
+bool idDeclLocal::ReadBinaryLocal( void ) {
+	int			i, num, depType, depChecksum;
+	idStr		depName;
+	idDeclLocal *decl;
+
+	idFile_Memory file( name, (const char *)binaryData, binaryLength );
+
+	file.ReadInt( num );
+	for ( i = 0; i < num; i++ ) {
+		file.ReadInt( depType );
+		file.ReadString( depName );
+		file.ReadInt( depChecksum );
+		if ( depType < 0 || depType >= declManagerLocal.declTypes.Num() || declManagerLocal.declTypes[depType] == NULL ) {
+			return false;
+		}
+		decl = declManagerLocal.FindTypeWithoutParsing( (declType_t)depType, depName, false );
+		if ( decl == NULL || decl->textSource == NULL || decl->checksum != depChecksum ) {
+			return false;
+		}
+	}
+
+	return self->ReadBinary( &file );
+}
+
 /*
 =================
 idDeclLocal::Reload
@@ -2182,8 +3002,10 @@ void idDeclLocal::AllocateSelf( void ) {
 idDeclLocal::ParseLocal
 =================
 */
-void idDeclLocal::ParseLocal( void ) {
+void idDeclLocal::ParseLocal( const char *text ) {
 	bool generatedDefaultText = false;
+	uint64 startTime = Sys_GetPerformanceCounter();
+	idDeclType *typeInfo = declManagerLocal.declTypes[type];
 
 	AllocateSelf();
 
@@ -2204,15 +3026,39 @@ void idDeclLocal::ParseLocal( void ) {
 	if ( textSource == NULL ) {
 		MakeDefault();
 		declManagerLocal.indent--;
+		typeInfo->numParses++;
+		typeInfo->parseTimeMS += Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
 		return;
 	}
 
 	declState = DS_PARSED;
 
-	// parse
-	char *declText = (char *) _alloca( ( GetTextLength() + 1 ) * sizeof( char ) );
-	GetText( declText );
-	self->Parse( declText, GetTextLength() );
+	// restore the binary parse result from the decl cache if it is still valid
+	if ( binaryData != NULL && declManagerLocal.decl_binaryCache.GetInteger() == 1 ) {
+		if ( ReadBinaryLocal() ) {
+			declManagerLocal.indent--;
+			typeInfo->numParses++;
+			typeInfo->numBinaryParses++;
+			typeInfo->parseTimeMS += Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
+			return;
+		}
+		self->FreeData();
+		FreeBinaryLocal();
+	}
+
+	// parse, the text may have been decompressed already
+	if ( text != NULL ) {
+		self->Parse( text, GetTextLength() );
+	} else {
+		char *declText = (char *) _alloca( ( GetTextLength() + 1 ) * sizeof( char ) );
+		GetText( declText );
+		self->Parse( declText, GetTextLength() );
+	}
+
+	// keep the result for the decl cache, a Parse() that failed made the decl a default
+	if ( declState == DS_PARSED && !generatedDefaultText && binaryData == NULL && declManagerLocal.decl_binaryCache.GetInteger() != 0 ) {
+		WriteBinaryLocal();
+	}
 
 	// free generated text
 	if ( generatedDefaultText ) {
@@ -2222,6 +3068,9 @@ void idDeclLocal::ParseLocal( void ) {
 	}
 
 	declManagerLocal.indent--;
+
+	typeInfo->numParses++;
+	typeInfo->parseTimeMS += Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - startTime );
 }
 
 /*
@@ -102,6 +102,8 @@ const int DECL_LEXER_FLAGS	=	LEXFL_NOSTRINGCONCAT |				// multiple strings seper
 								LEXFL_NOFATALERRORS;				// just set a flag instead of fatal erroring
 
 
+class idDecl;
+
 class idDeclBase {
 public:
 	virtual					~idDeclBase() {};
@@ -130,6 +132,8 @@ public:
 	virtual size_t			Size( void ) const = 0;
 	virtual void			List( void ) const = 0;
 	virtual void			Print( void ) const = 0;
+	virtual bool			WriteBinary( idFile *f, idList<const idDecl *> &dependencies ) const = 0;
+	virtual bool			ReadBinary( idFile *f ) = 0;
 };
 
 
@@ -236,6 +240,17 @@ public:
 							// explicit data.
 	virtual void			Print( void ) const { base->Print(); }
 
+							// Writes the result of the last Parse() so ReadBinary() can restore it
+							// without the text, used for the binary decl cache. Other decls the result
+							// was built from are added to dependencies, the cached result is only used
+							// while their text is unchanged. Returns false if there is no binary form.
+	virtual bool			WriteBinary( idFile *f, idList<const idDecl *> &dependencies ) const { return base->WriteBinary( f, dependencies ); }
+
+							// Restores what WriteBinary() wrote instead of a Parse(), all necessary
+							// media will be touched before return. The manager will have called
+							// FreeData() before and does a Parse() if this returns false.
+	virtual bool			ReadBinary( idFile *f ) { return base->ReadBinary( f ); }
+
 public:
 	idDeclBase *			base;
 };
@@ -26,6 +26,10 @@ If you have questions concerning this license or the applicable additional terms
 ===========================================================================
 */
 
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
 #ifdef WIN32
 	#include <io.h>	// for _read
 #else
@@ -48,6 +52,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "framework/DeclManager.h"
 
 #include "framework/FileSystem.h"
+#include "framework/Profiler.h"
 
 #include "idlib/LangDict.h"
 
@@ -258,9 +263,21 @@ static idInitExclusions	initExclusions;
 #define MAX_ZIPPED_FILE_NAME	2048
 #define FILE_HASH_SIZE			1024
 
+// compressed files in mapped paks up to this size are inflated when they are opened, bigger ones are streamed through minizip
+#define MAX_MAPPED_INFLATE_SIZE	( 16 * 1024 * 1024 )
+
+#define PAK_INDEX_FILE			"generated/pk4index.bin"
+#define PAK_INDEX_MAGIC			( ( 'P' << 24 ) | ( 'K' << 16 ) | ( 'I' << 8 ) | 'X' )
+#define PAK_INDEX_VERSION		1
+
 typedef struct fileInPack_s {
 	idStr				name;						// name of the file
 	ZPOS64_T			pos;						// file info position in zip
+	int					method;						// compression method, -1 when only minizip can read the file
+	int					compressedSize;
+	int					uncompressedSize;
+	int					localPos;					// position of the local file header in the pak
+	unsigned int		crc;
 	struct fileInPack_s * next;						// next file in the hash
 } fileInPack_t;
 
@@ -276,12 +293,23 @@ typedef struct {
 	idList<idDict *>	mapDecls;
 } addonInfo_t;
 
+// a mapped pak, it stays mapped until the pak and every file reading from the mapping let go of it
+typedef struct {
+	const byte *		data;
+	int					length;
+	std::atomic<int>	refCount;
+} pakMapping_t;
+
 typedef struct {
 	idStr				pakFilename;				// c:\doom\base\pak0.pk4
 	unzFile				handle;
 	int					checksum;
 	int					numfiles;
 	int					length;
+	ID_TIME_T			timestamp;
+	const byte *		mappedData;					// the whole pak mapped read only, or NULL
+	pakMapping_t *		mapping;					// reference to the mapping of mappedData
+	bool				indexed;					// the files have their compression and position, so the pak can go in the index
 	bool				referenced;
 	bool				addon;						// this is an addon pack - addon_search tells if it's 'active'
 	bool				addon_search;				// is in the search list
@@ -297,6 +325,47 @@ typedef struct {
 	idStr				gamedir;					// base
 } directory_t;
 
+typedef struct {
+	pack_t *			pack;
+	fileInPack_t *		file;
+	int					next;						// the same file in a later pak of the search path, -1 if none
+} indexedFile_t;
+
+// prefetch lists of the maps, the files each map read while loading
+#define PREFETCH_LIST_DIR		"generated/prefetch"
+#define MAX_IO_THREADS			8
+#define ASYNC_READ_SLOT_BITS	16
+
+typedef enum {
+	ASYNC_READ_FREE,
+	ASYNC_READ_QUEUED,
+	ASYNC_READ_RUNNING,
+	ASYNC_READ_DONE
+} asyncReadState_t;
+
+typedef struct {
+	int					handle;			// slot in the low bits, a serial number above
+	asyncReadState_t	state;
+	fsReadPriority_t	priority;
+	bool				prefetch;		// only pulls the data into the page cache, no result
+	bool				cancelled;		// cancelled while running, the I/O thread drops it
+	bool				retry;			// inflating from the mapping failed, read it again on the main thread
+	idStr				relativePath;
+	fsReadCallback_t	callback;
+	void *				data;
+
+	// set up by the thread queueing the read, only one of them is used
+	idFile *			file;			// loose file or file in an unmapped pak
+	const byte *		mapped;			// data in a mapped pak
+	idStr				pakPath;		// unmapped pak to prefetch from
+	int					localPos;
+	int					method;
+	int					compressedSize;
+
+	int					length;
+	void *				buffer;
+} asyncRead_t;
+
 typedef struct searchpath_s {
 	pack_t *			pack;						// only one of pack / dir will be non NULL
 	directory_t *		dir;
@@ -357,7 +426,15 @@ public:
 	virtual void			SetRestartChecksums( const int pureChecksums[ MAX_PURE_PAKS ] );
 	virtual	void			ClearPureChecksums( void );
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp );
+	virtual void			ReadFiles( int numFiles, const char * const *relativePaths, void **buffers, int *lengths, ID_TIME_T *timestamps = NULL );
 	virtual void			FreeFile( void *buffer );
+	virtual int				ReadFileAsync( const char *relativePath, fsReadPriority_t priority = FS_READ_PRIORITY_NORMAL, fsReadCallback_t callback = NULL, void *data = NULL );
+	virtual bool			IsReadDone( int handle );
+	virtual int				WaitRead( int handle, void **buffer );
+	virtual void			CancelRead( int handle );
+	virtual void			ServiceReads( void );
+	virtual void			PrefetchMap( const char *mapName );
+	virtual void			WritePrefetchList( const char *mapName );
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_savepath" );
 	virtual void			RemoveFile( const char *relativePath );
 	virtual idFile *		OpenFileReadFlags( const char *relativePath, int searchFlags, pack_t **foundInPak = NULL, bool allowCopyFiles = true, const char* gamedir = NULL );
@@ -369,7 +446,7 @@ public:
 	virtual idFile *		OpenExplicitFileWrite( const char *OSPath );
 	virtual void			CloseFile( idFile *f );
 	virtual void			BackgroundDownload( backgroundDownload_t *bgl );
-	virtual void			ResetReadCount( void ) { readCount = 0; }
+	virtual void			ResetReadCount( void ) { readCount = 0; levelFiles.Clear(); levelFileHash.Clear(); }
 	virtual void			AddToReadCount( int c ) { readCount += c; }
 	virtual int				GetReadCount( void ) { return readCount; }
 	virtual void			FindDLL( const char *basename, char dllPath[ MAX_OSPATH ] );
@@ -391,6 +468,8 @@ public:
 	static void				Path_f( const idCmdArgs &args );
 	static void				TouchFile_f( const idCmdArgs &args );
 	static void				TouchFileList_f( const idCmdArgs &args );
+	static void				TestFileRead_f( const idCmdArgs &args );
+	static void				PrefetchMap_f( const idCmdArgs &args );
 
 	//BC
 	virtual idStr			GetModDescription(idStr descPath);
@@ -399,7 +478,7 @@ private:
 	friend int				BackgroundDownloadThread( void *pexit );
 
 	searchpath_t *			searchPaths;
-	int						readCount;			// total bytes read
+	std::atomic<int>		readCount;			// total bytes read, the I/O threads add to it too
 	int						loadCount;			// total files read
 	int						loadStack;			// total files in memory
 	idStr					gameFolder;			// this will be a single name without separators
@@ -420,6 +499,11 @@ private:
 	static idCVar			fs_game_base;
 	static idCVar			fs_caseSensitiveOS;
 	static idCVar			fs_searchAddons;
+	static idCVar			fs_mapPaks;
+	static idCVar			fs_pakIndex;
+	static idCVar			fs_parallelInflateSize;
+	static idCVar			fs_ioThreads;
+	static idCVar			fs_prefetch;
 
 	backgroundDownload_t *	backgroundDownloads;
 	backgroundDownload_t	defaultBackgroundDownload;
@@ -437,6 +521,42 @@ private:
 
 	int						d3xp;	// 0: didn't check, -1: not installed, 1: installed
 
+	idList<indexedFile_t>	fileIndex;			// every file in the paks of the search path
+	idHashIndex				fileIndexHash;
+	bool					fileIndexValid;
+
+	byte *					pakIndexData;		// pak directories saved by an earlier start
+	int						pakIndexLength;
+	idStrList				pakIndexNames;
+	idList<int>				pakIndexOffsets;
+	idHashIndex				pakIndexHash;
+	bool					pakIndexDirty;		// a pak wasn't found in the saved index
+
+	idStrList				levelFiles;			// files opened since the last map load started
+	idHashIndex				levelFileHash;
+
+	idList<idJobList *>		inflateJobs;		// one list per big file, so each one starts as soon as it is found
+
+	// asynchronous reads, everything below is guarded by asyncLock
+	std::mutex				asyncLock;
+	std::condition_variable	asyncWork;			// reads were queued
+	std::condition_variable	asyncDone;			// a read finished
+	idList<asyncRead_t *>	asyncReads;			// indexed by the slot of a handle
+	idList<int>				freeAsyncReads;
+	int						asyncReadSerial;
+	idList<int>				readQueues[FS_READ_PRIORITIES];	// handles waiting for an I/O thread
+	int						readQueueHeads[FS_READ_PRIORITIES];
+	idList<int>				finishedReads;		// handles waiting for ServiceReads to call the callback
+	int						numPrefetching;		// prefetches not done yet
+	int						numPrefetched;
+	int						prefetchBytes;
+	int						prefetchStartTime;
+	bool					ioThreadsExit;
+
+	xthreadInfo				ioThreads[MAX_IO_THREADS];
+	idStr					ioThreadNames[MAX_IO_THREADS];
+	int						numIOThreads;
+
 private:
 	void					ReplaceSeparators( idStr &path, char sep = PATHSEPERATOR_CHAR );
 	int						HashFileName( const char *fname ) const;
@@ -451,6 +571,15 @@ private:
 
 	int						GetFileListTree( const char *relativePath, const idStrList &extensions, idStrList &list, idHashIndex &hashIndex, const char* gamedir = NULL );
 	pack_t *				LoadZipFile( const char *zipfile );
+	bool					ParseZipDirectory( pack_t *pack, int **headerLongs, int *numHeaderLongs );
+	bool					LoadPakFromIndex( pack_t *pack, int **headerLongs, int *numHeaderLongs );
+	void					LoadPakIndex( void );
+	void					WritePakIndex( void );
+	void					FreePakIndex( void );
+	int						FileIndexKey( const char *relativePath ) const;
+	void					BuildFileIndex( void );
+	int						FindIndexedFile( const char *relativePath ) const;
+	idFile *				LocateFileRead( const char *relativePath, int searchFlags, pack_t **foundInPak, bool allowCopyFiles, const char *gamedir, fileInPack_t **foundPakFile );
 	void					AddGameDirectory( const char *path, const char *dir );
 	void					SetupGameDirectories( const char *gameName );
 	void					Startup( void );
@@ -460,7 +589,20 @@ private:
 	pack_t *				GetPackForChecksum( int checksum, bool searchAddons = false );
 							// searches all the paks, no pure check
 	pack_t *				FindPakForFileChecksum( const char *relativePath, int fileChecksum, bool bReference );
-	idFile_InZip *			ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
+	idFile *				ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
+	int						QueueRead( const char *relativePath, fsReadPriority_t priority, fsReadCallback_t callback, void *data, bool prefetch );
+	asyncRead_t *			AllocAsyncRead( void );
+	asyncRead_t *			FindAsyncRead( int handle ) const;
+	void					FreeAsyncRead( asyncRead_t *read );
+	asyncRead_t *			NextQueuedRead( void );
+	bool					HasQueuedReads( void ) const;
+	void					FinishAsyncRead( asyncRead_t *read );
+	int						DeliverRead( const idStr &relativePath, void *buffer, int length, bool retry, void **result );
+	idStr					PrefetchListName( const char *mapName ) const;
+	void					StartIOThreads( void );
+	void					StopIOThreads( void );
+	static void				ExecuteAsyncRead( asyncRead_t *read );
+	static int				IOThread( void *parm );
 	int						GetFileChecksum( idFile *file );
 	pureStatus_t			GetPackStatus( pack_t *pak );
 	addonInfo_t *			ParseAddonDef( const char *buf, const int len );
@@ -491,6 +633,11 @@ idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "0", CVAR_SY
 idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "1", CVAR_SYSTEM | CVAR_BOOL, "" );
 #endif
 idCVar	idFileSystemLocal::fs_searchAddons( "fs_searchAddons", "0", CVAR_SYSTEM | CVAR_BOOL, "search all addon pk4s ( disables addon functionality )" );
+idCVar	idFileSystemLocal::fs_mapPaks( "fs_mapPaks", "1", CVAR_SYSTEM | CVAR_BOOL, "memory map pk4 files, stored files are read straight from the mapping" );
+idCVar	idFileSystemLocal::fs_pakIndex( "fs_pakIndex", "1", CVAR_SYSTEM | CVAR_BOOL, "keep the directories of all pk4 files in " PAK_INDEX_FILE " so they don't have to be read at startup" );
+idCVar	idFileSystemLocal::fs_parallelInflateSize( "fs_parallelInflateSize", "262144", CVAR_SYSTEM | CVAR_INTEGER, "ReadFiles inflates compressed files of at least this size on the job workers, 0 = never" );
+idCVar	idFileSystemLocal::fs_ioThreads( "fs_ioThreads", "2", CVAR_SYSTEM | CVAR_INTEGER, "number of threads serving asynchronous reads, 0 = read when queued, takes effect on fs_restart", 0, MAX_IO_THREADS, idCmdSystem::ArgCompletion_Integer<0,MAX_IO_THREADS> );
+idCVar	idFileSystemLocal::fs_prefetch( "fs_prefetch", "1", CVAR_SYSTEM | CVAR_BOOL, "remember the files a map loads in " PREFETCH_LIST_DIR " and read them ahead the next time the map is loaded" );
 
 idFileSystemLocal	fileSystemLocal;
 idFileSystem *		fileSystem = &fileSystemLocal;
@@ -512,6 +659,19 @@ idFileSystemLocal::idFileSystemLocal( void ) {
 	memset( &backgroundThread, 0, sizeof( backgroundThread ) );
 	backgroundThread_exit = false;
 	addonPaks = NULL;
+	fileIndexValid = false;
+	pakIndexData = NULL;
+	pakIndexLength = 0;
+	pakIndexDirty = false;
+	asyncReadSerial = 0;
+	memset( readQueueHeads, 0, sizeof( readQueueHeads ) );
+	numPrefetching = 0;
+	numPrefetched = 0;
+	prefetchBytes = 0;
+	prefetchStartTime = 0;
+	ioThreadsExit = false;
+	memset( ioThreads, 0, sizeof( ioThreads ) );
+	numIOThreads = 0;
 }
 
 /*
@@ -1068,6 +1228,8 @@ int idFileSystemLocal::ReadFile( const char *relativePath, void **buffer, ID_TIM
 	int			len;
 	bool		isConfig;
 
+	PROFILE_SCOPE( "idFileSystem::ReadFile" );
+
 	if ( !searchPaths ) {
 		common->FatalError( "Filesystem call made without initialization\n" );
 	}
@@ -1306,6 +1468,373 @@ addonInfo_t *idFileSystemLocal::ParseAddonDef( const char *buf, const int len )
 	return NULL;
 }
 
+/*
+=================
+ZipShort / ZipLong
+
+little endian fields of the zip headers
+=================
+*/
+static ID_INLINE int ZipShort( const byte *p ) {
+	return p[0] | ( p[1] << 8 );
+}
+
+static ID_INLINE unsigned int ZipLong( const byte *p ) {
+	return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int)p[3] << 24 );
+}
+
+/*
+=================
+idFileSystemLocal::ParseZipDirectory
+
+Reads the central directory straight from the mapped pak, returns false if the pak
+isn't mapped or uses anything minizip has to deal with.
+=================
+*/
+bool idFileSystemLocal::ParseZipDirectory( pack_t *pack, int **headerLongs, int *numHeaderLongs ) {
+	const byte *	data;
+	const byte *	entry;
+	fileInPack_t *	buildBuffer;
+	int				end;
+	int				numFiles;
+	unsigned int	directorySize;
+	unsigned int	directoryOffset;
+	int				bytesBefore;
+	int				pos;
+	int				i;
+	int				hash;
+	int				flags;
+	int				method;
+	unsigned int	compressedSize;
+	unsigned int	uncompressedSize;
+	unsigned int	localPos;
+	int				nameLength;
+
+	data = pack->mappedData;
+	if ( !data || pack->length < 22 ) {
+		return false;
+	}
+
+	// the end of central directory record is followed by a comment of up to 64k
+	for ( end = pack->length - 22; end >= 0 && end >= pack->length - 22 - 0xffff; end-- ) {
+		if ( ZipLong( data + end ) == 0x06054b50 ) {
+			break;
+		}
+	}
+	if ( end < 0 || end < pack->length - 22 - 0xffff ) {
+		return false;
+	}
+
+	numFiles = ZipShort( data + end + 10 );
+	directorySize = ZipLong( data + end + 12 );
+	directoryOffset = ZipLong( data + end + 16 );
+	if ( numFiles == 0xffff || directoryOffset == 0xffffffff || directorySize > (unsigned int)end || directoryOffset > (unsigned int)end - directorySize ) {
+		return false;	// zip64
+	}
+	// data in front of the zip, like in self extracting archives
+	bytesBefore = end - (int)( directoryOffset + directorySize );
+
+	buildBuffer = new fileInPack_t[numFiles];
+	*headerLongs = (int *)Mem_ClearedAlloc( Max( numFiles, 1 ) * sizeof( int ) );
+	*numHeaderLongs = 0;
+
+	pos = bytesBefore + directoryOffset;
+	for ( i = 0; i < numFiles; i++ ) {
+		entry = data + pos;
+		if ( pos + 46 > end || ZipLong( entry ) != 0x02014b50 ) {
+			break;
+		}
+		flags = ZipShort( entry + 8 );
+		method = ZipShort( entry + 10 );
+		compressedSize = ZipLong( entry + 20 );
+		uncompressedSize = ZipLong( entry + 24 );
+		nameLength = ZipShort( entry + 28 );
+		localPos = ZipLong( entry + 42 );
+		if ( pos + 46 + nameLength > end || nameLength >= MAX_ZIPPED_FILE_NAME ) {
+			break;
+		}
+
+		if ( uncompressedSize > 0 ) {
+			(*headerLongs)[(*numHeaderLongs)++] = LittleInt( (int)ZipLong( entry + 16 ) );
+		}
+
+		buildBuffer[i].name = idStr( (const char *)entry + 46, 0, nameLength );
+		buildBuffer[i].name.ToLower();
+		buildBuffer[i].name.BackSlashesToSlashes();
+		buildBuffer[i].pos = pos - bytesBefore;
+
+		// encrypted files and odd compression methods are left to minizip
+		if ( ( flags & 1 ) || ( method != 0 && method != Z_DEFLATED ) ||
+				compressedSize > (unsigned int)pack->length || uncompressedSize > INT_MAX || localPos > (unsigned int)( end - bytesBefore ) ) {
+			method = -1;
+		}
+		buildBuffer[i].method = method;
+		buildBuffer[i].compressedSize = compressedSize;
+		buildBuffer[i].uncompressedSize = uncompressedSize;
+		buildBuffer[i].localPos = bytesBefore + localPos;
+		buildBuffer[i].crc = ZipLong( entry + 16 );
+
+		pos += 46 + nameLength + ZipShort( entry + 30 ) + ZipShort( entry + 32 );
+	}
+
+	if ( i < numFiles ) {
+		common->Warning( "%s: damaged central directory, using minizip", pack->pakFilename.c_str() );
+		delete[] buildBuffer;
+		Mem_Free( *headerLongs );
+		*headerLongs = NULL;
+		return false;
+	}
+
+	for ( i = 0; i < numFiles; i++ ) {
+		hash = HashFileName( buildBuffer[i].name );
+		buildBuffer[i].next = pack->hashTable[hash];
+		pack->hashTable[hash] = &buildBuffer[i];
+	}
+
+	pack->buildBuffer = buildBuffer;
+	pack->numfiles = numFiles;
+	pack->indexed = true;
+
+	return true;
+}
+
+/*
+=================
+idFileSystemLocal::LoadPakFromIndex
+
+Takes the directory of the pak from the index saved by an earlier start if the pak didn't change.
+=================
+*/
+bool idFileSystemLocal::LoadPakFromIndex( pack_t *pack, int **headerLongs, int *numHeaderLongs ) {
+	fileInPack_t *	buildBuffer;
+	int				i;
+	int				hash;
+	int				length;
+	int				timestamp;
+	int				numFiles;
+	int				pos;
+
+	if ( !pakIndexData ) {
+		return false;
+	}
+
+	hash = pakIndexHash.GenerateKey( pack->pakFilename );
+	for ( i = pakIndexHash.First( hash ); i != -1; i = pakIndexHash.Next( i ) ) {
+		if ( pakIndexNames[i].Cmp( pack->pakFilename ) == 0 ) {
+			break;
+		}
+	}
+	if ( i == -1 ) {
+		return false;
+	}
+
+	idFile_Memory file( PAK_INDEX_FILE, (const char *)pakIndexData + pakIndexOffsets[i], pakIndexLength - pakIndexOffsets[i] );
+
+	file.ReadInt( length );
+	file.ReadInt( timestamp );
+	file.ReadInt( numFiles );
+	if ( length != pack->length || timestamp != (int)pack->timestamp || numFiles < 0 ) {
+		return false;
+	}
+
+	buildBuffer = new fileInPack_t[numFiles];
+	*headerLongs = (int *)Mem_ClearedAlloc( Max( numFiles, 1 ) * sizeof( int ) );
+	*numHeaderLongs = 0;
+
+	for ( i = 0; i < numFiles; i++ ) {
+		file.ReadString( buildBuffer[i].name );
+		file.ReadInt( pos );
+		file.ReadInt( buildBuffer[i].method );
+		file.ReadInt( buildBuffer[i].compressedSize );
+		file.ReadInt( buildBuffer[i].uncompressedSize );
+		file.ReadUnsignedInt( buildBuffer[i].crc );
+		file.ReadInt( buildBuffer[i].localPos );
+		buildBuffer[i].pos = pos;
+
+		if ( buildBuffer[i].uncompressedSize > 0 ) {
+			(*headerLongs)[(*numHeaderLongs)++] = LittleInt( buildBuffer[i].crc );
+		}
+
+		hash = HashFileName( buildBuffer[i].name );
+		buildBuffer[i].next = pack->hashTable[hash];
+		pack->hashTable[hash] = &buildBuffer[i];
+	}
+
+	pack->buildBuffer = buildBuffer;
+	pack->numfiles = numFiles;
+	pack->indexed = true;
+
+	return true;
+}
+
+/*
+=================
+idFileSystemLocal::LoadPakIndex
+
+The index keeps the directories of all paks of the last start, it is checked as a whole
+so the entries can be trusted afterwards.
+=================
+*/
+void idFileSystemLocal::LoadPakIndex( void ) {
+	idStr		path;
+	FILE *		f;
+	int			length;
+	int			magic;
+	int			version;
+	int			checksum;
+	int			numPaks;
+	int			blockSize;
+	int			i;
+	idStr		name;
+
+	FreePakIndex();
+
+	if ( !fs_pakIndex.GetBool() || !fs_savepath.GetString()[0] ) {
+		return;
+	}
+
+	path = BuildOSPath( fs_savepath.GetString(), BASE_GAMEDIR, PAK_INDEX_FILE );
+	f = OpenOSFile( path, "rb" );
+	if ( !f ) {
+		return;
+	}
+	length = DirectFileLength( f );
+	if ( length < 16 ) {
+		fclose( f );
+		return;
+	}
+	pakIndexData = (byte *)Mem_Alloc( length );
+	pakIndexLength = length;
+	if ( (int)fread( pakIndexData, 1, length, f ) != length ) {
+		fclose( f );
+		FreePakIndex();
+		return;
+	}
+	fclose( f );
+
+	idFile_Memory file( PAK_INDEX_FILE, (const char *)pakIndexData, pakIndexLength );
+
+	file.ReadInt( magic );
+	file.ReadInt( version );
+	file.ReadInt( checksum );
+	if ( magic != PAK_INDEX_MAGIC || version != PAK_INDEX_VERSION || checksum != MD4_BlockChecksum( pakIndexData + 12, pakIndexLength - 12 ) ) {
+		common->DPrintf( "%s is out of date\n", path.c_str() );
+		FreePakIndex();
+		return;
+	}
+
+	file.ReadInt( numPaks );
+	for ( i = 0; i < numPaks; i++ ) {
+		file.ReadString( name );
+		file.ReadInt( blockSize );
+		pakIndexHash.Add( pakIndexHash.GenerateKey( name ), pakIndexNames.Append( name ) );
+		pakIndexOffsets.Append( file.Tell() );
+		file.Seek( blockSize, FS_SEEK_CUR );
+	}
+}
+
+/*
+=================
+idFileSystemLocal::WritePakIndex
+
+Saves the directories of all paks when one of them wasn't in the index yet.
+=================
+*/
+void idFileSystemLocal::WritePakIndex( void ) {
+	searchpath_t *	sp;
+	searchpath_t *	loop;
+	pack_t *		pak;
+	idFile *		f;
+	int				numPaks;
+	int				i;
+
+	if ( !fs_pakIndex.GetBool() || !pakIndexDirty || !fs_savepath.GetString()[0] ) {
+		return;
+	}
+	pakIndexDirty = false;
+
+	idFile_Memory file( PAK_INDEX_FILE );
+	idFile_Memory block( PAK_INDEX_FILE );
+
+	numPaks = 0;
+	for ( loop = searchPaths; loop; loop == searchPaths ? loop = addonPaks : loop = NULL ) {
+		for ( sp = loop; sp; sp = sp->next ) {
+			pak = sp->pack;
+			if ( !pak || !pak->indexed ) {
+				continue;
+			}
+
+			block.Clear( false );
+			block.WriteInt( pak->length );
+			block.WriteInt( (int)pak->timestamp );
+			block.WriteInt( pak->numfiles );
+			for ( i = 0; i < pak->numfiles; i++ ) {
+				const fileInPack_t &pakFile = pak->buildBuffer[i];
+				block.WriteString( pakFile.name );
+				block.WriteInt( (int)pakFile.pos );
+				block.WriteInt( pakFile.method );
+				block.WriteInt( pakFile.compressedSize );
+				block.WriteInt( pakFile.uncompressedSize );
+				block.WriteUnsignedInt( pakFile.crc );
+				block.WriteInt( pakFile.localPos );
+			}
+
+			file.WriteString( pak->pakFilename );
+			file.WriteInt( block.Length() );
+			file.Write( block.GetDataPtr(), block.Length() );
+			numPaks++;
+		}
+	}
+
+	f = OpenExplicitFileWrite( BuildOSPath( fs_savepath.GetString(), BASE_GAMEDIR, PAK_INDEX_FILE ) );
+	if ( !f ) {
+		return;
+	}
+
+	idFile_Memory body( PAK_INDEX_FILE );
+	body.WriteInt( numPaks );
+	body.Write( file.GetDataPtr(), file.Length() );
+
+	f->WriteInt( PAK_INDEX_MAGIC );
+	f->WriteInt( PAK_INDEX_VERSION );
+	f->WriteInt( MD4_BlockChecksum( body.GetDataPtr(), body.Length() ) );
+	f->Write( body.GetDataPtr(), body.Length() );
+	CloseFile( f );
+}
+
+/*
+=================
+idFileSystemLocal::FreePakIndex
+=================
+*/
+void idFileSystemLocal::FreePakIndex( void ) {
+	if ( pakIndexData ) {
+		Mem_Free( pakIndexData );
+	}
+	pakIndexData = NULL;
+	pakIndexLength = 0;
+	pakIndexNames.Clear();
+	pakIndexOffsets.Clear();
+	pakIndexHash.Free();
+}
+
+/*
+===========
+ReleasePakMapping
+
+unmaps the pak once the last reference is gone, may be called from any thread
+===========
+*/
+static void ReleasePakMapping( pakMapping_t *mapping ) {
+	if ( mapping == NULL ) {
+		return;
+	}
+	if ( mapping->refCount.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+		Sys_UnmapFile( mapping->data, mapping->length );
+		delete mapping;
+	}
+}
+
 /*
 =================
 idFileSystemLocal::LoadZipFile
@@ -1327,6 +1856,9 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	int				len;
 	int				confHash;
 	fileInPack_t	*pakFile;
+	ID_TIME_T		timestamp;
+	int				mappedLength;
+	bool			directoryRead;
 
 	f = OpenOSFile( zipfile, "rb" );
 	if ( !f ) {
@@ -1334,9 +1866,11 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	}
 	fseek( f, 0, SEEK_END );
 	len = ftell( f );
+	timestamp = Sys_FileTimeStamp( f );
 	fclose( f );
 
 	fs_numHeaderLongs = 0;
+	fs_headerLongs = NULL;
 
 	uf = unzOpen( zipfile );
 	err = unzGetGlobalInfo64( uf, &gi );
@@ -1345,7 +1879,6 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 		return NULL;
 	}
 
-	buildBuffer = new fileInPack_t[gi.number_entry];
 	pack = new pack_t;
 	for( i = 0; i < FILE_HASH_SIZE; i++ ) {
 		pack->hashTable[i] = NULL;
@@ -1354,7 +1887,7 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	pack->pakFilename = zipfile;
 	pack->handle = uf;
 	pack->numfiles = gi.number_entry;
-	pack->buildBuffer = buildBuffer;
+	pack->buildBuffer = NULL;
 	pack->referenced = false;
 	pack->addon = false;
 	pack->addon_search = false;
@@ -1363,28 +1896,64 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	pack->isNew = false;
 
 	pack->length = len;
-
-	unzGoToFirstFile(uf);
-	fs_headerLongs = (int *)Mem_ClearedAlloc( gi.number_entry * sizeof(int) );
-	for ( i = 0; i < (int)gi.number_entry; i++ ) {
-		err = unzGetCurrentFileInfo64( uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0 );
-		if ( err != UNZ_OK ) {
-			break;
+	pack->timestamp = timestamp;
+	pack->mappedData = NULL;
+	pack->mapping = NULL;
+	pack->indexed = false;
+
+	if ( fs_mapPaks.GetBool() ) {
+		pack->mappedData = (const byte *)Sys_MapFile( zipfile, mappedLength );
+		if ( pack->mappedData && mappedLength != len ) {
+			Sys_UnmapFile( pack->mappedData, mappedLength );
+			pack->mappedData = NULL;
 		}
-		if ( file_info.uncompressed_size > 0 ) {
-			fs_headerLongs[fs_numHeaderLongs++] = LittleInt( file_info.crc );
+		if ( pack->mappedData ) {
+			pack->mapping = new pakMapping_t;
+			pack->mapping->data = pack->mappedData;
+			pack->mapping->length = len;
+			pack->mapping->refCount = 1;
+		}
+	}
+
+	// take the directory from the pak index or the mapped pak before walking it with minizip
+	directoryRead = LoadPakFromIndex( pack, &fs_headerLongs, &fs_numHeaderLongs );
+	if ( !directoryRead && ParseZipDirectory( pack, &fs_headerLongs, &fs_numHeaderLongs ) ) {
+		directoryRead = true;
+		pakIndexDirty = true;
+	}
+
+	if ( !directoryRead ) {
+		buildBuffer = new fileInPack_t[gi.number_entry];
+		pack->buildBuffer = buildBuffer;
+
+		unzGoToFirstFile(uf);
+		fs_headerLongs = (int *)Mem_ClearedAlloc( gi.number_entry * sizeof(int) );
+		for ( i = 0; i < (int)gi.number_entry; i++ ) {
+			err = unzGetCurrentFileInfo64( uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0 );
+			if ( err != UNZ_OK ) {
+				break;
+			}
+			if ( file_info.uncompressed_size > 0 ) {
+				fs_headerLongs[fs_numHeaderLongs++] = LittleInt( file_info.crc );
+			}
+			hash = HashFileName( filename_inzip );
+			buildBuffer[i].name = filename_inzip;
+			buildBuffer[i].name.ToLower();
+			buildBuffer[i].name.BackSlashesToSlashes();
+			// store the file position in the zip
+			buildBuffer[i].pos = unzGetOffset64( uf );
+			// only minizip knows where the data is
+			buildBuffer[i].method = -1;
+			buildBuffer[i].compressedSize = 0;
+			buildBuffer[i].uncompressedSize = 0;
+			buildBuffer[i].localPos = 0;
+			buildBuffer[i].crc = file_info.crc;
+			// add the file to the hash
+			buildBuffer[i].next = pack->hashTable[hash];
+			pack->hashTable[hash] = &buildBuffer[i];
+			// go to the next file in the zip
+			unzGoToNextFile(uf);
 		}
-		hash = HashFileName( filename_inzip );
-		buildBuffer[i].name = filename_inzip;
-		buildBuffer[i].name.ToLower();
-		buildBuffer[i].name.BackSlashesToSlashes();
-		// store the file position in the zip
-		buildBuffer[i].pos = unzGetOffset64( uf );
-		// add the file to the hash
-		buildBuffer[i].next = pack->hashTable[hash];
-		pack->hashTable[hash] = &buildBuffer[i];
-		// go to the next file in the zip
-		unzGoToNextFile(uf);
 	}
 
 	// ignore all binary paks
@@ -1392,7 +1961,8 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	for (pakFile = pack->hashTable[confHash]; pakFile; pakFile = pakFile->next) {
 		if (!FilenameCompare(pakFile->name, BINARY_CONFIG)) {
 			unzClose(uf);
-			delete[] buildBuffer;
+			ReleasePakMapping( pack->mapping );
+			delete[] pack->buildBuffer;
 			delete pack;
 			Mem_Free( fs_headerLongs );
 			return NULL;
@@ -1405,7 +1975,7 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	for ( pakFile = pack->hashTable[confHash]; pakFile; pakFile = pakFile->next ) {
 		if ( !FilenameCompare( pakFile->name, ADDON_CONFIG ) ) {
 			pack->addon = true;
-			idFile_InZip *file = ReadFileFromZip( pack, pakFile, ADDON_CONFIG );
+			idFile *file = ReadFileFromZip( pack, pakFile, ADDON_CONFIG );
 			// may be just an empty file if you don't bother about the mapDef
 			if ( file && file->Length() ) {
 				char *buf;
@@ -1459,6 +2029,7 @@ int idFileSystemLocal::AddZipFile( const char *path ) {
 		last = last->next;
 	}
 	last->next = search;
+	BuildFileIndex();
 	common->Printf( "Appended pk4 %s with checksum 0x%x\n", pak->pakFilename.c_str(), pak->checksum );
 	return pak->checksum;
 }
@@ -2105,6 +2676,127 @@ void idFileSystemLocal::TouchFileList_f( const idCmdArgs &args ) {
 }
 
 
+/*
+============
+idFileSystemLocal::TestFileRead_f
+
+Reads every file of the last map, or of a list file, with ReadFile and ReadFiles.
+============
+*/
+void idFileSystemLocal::TestFileRead_f( const idCmdArgs &args ) {
+	idStrList		files;
+	idList<const char *> names;
+	idList<void *>	buffers;
+	idList<int>		lengths;
+	pack_t *		pak;
+	fileInPack_t *	pakFile;
+	idFile *		f;
+	void *			buffer;
+	uint64			start;
+	double			readFileTime;
+	double			readFilesTime;
+	int				numLoose;
+	int				numStored;
+	int				numDeflated;
+	int				numMissing;
+	int				numMismatched;
+	int				bytes;
+	int				len;
+	int				i;
+
+	if ( args.Argc() > 2 ) {
+		common->Printf( "Usage: testFileRead [listFile]\n" );
+		return;
+	}
+
+	if ( args.Argc() == 2 ) {
+		const char *text = NULL;
+		idParser src( LEXFL_NOFATALERRORS | LEXFL_NOSTRINGCONCAT | LEXFL_ALLOWMULTICHARLITERALS | LEXFL_ALLOWBACKSLASHSTRINGCONCAT );
+		if ( fileSystemLocal.ReadFile( args.Argv( 1 ), (void **)&text, NULL ) <= 0 ) {
+			common->Printf( "couldn't read %s\n", args.Argv( 1 ) );
+			return;
+		}
+		src.LoadMemory( text, strlen( text ), args.Argv( 1 ) );
+		if ( src.IsLoaded() ) {
+			idToken token;
+			while ( src.ReadToken( &token ) ) {
+				files.Append( token );
+			}
+		}
+		fileSystemLocal.FreeFile( (void *)text );
+	} else {
+		files = fileSystemLocal.levelFiles;
+	}
+
+	if ( !files.Num() ) {
+		common->Printf( "no files to read, load a map first or give a list file\n" );
+		return;
+	}
+
+	names.SetNum( files.Num() );
+	buffers.SetNum( files.Num() );
+	lengths.SetNum( files.Num() );
+
+	numLoose = numStored = numDeflated = numMissing = 0;
+	for ( i = 0; i < files.Num(); i++ ) {
+		names[i] = files[i].c_str();
+		f = fileSystemLocal.LocateFileRead( names[i], FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS | FSFLAG_PURE_NOREF, &pak, false, NULL, &pakFile );
+		if ( f ) {
+			numLoose++;
+			fileSystemLocal.CloseFile( f );
+		} else if ( !pakFile ) {
+			numMissing++;
+		} else if ( pakFile->method == 0 ) {
+			numStored++;
+		} else {
+			numDeflated++;
+		}
+	}
+
+	// read everything once so both runs find the same page cache
+	fileSystemLocal.ReadFiles( names.Num(), names.Ptr(), buffers.Ptr(), lengths.Ptr() );
+	for ( i = 0; i < names.Num(); i++ ) {
+		if ( buffers[i] ) {
+			fileSystemLocal.FreeFile( buffers[i] );
+		}
+	}
+
+	bytes = 0;
+	start = Sys_GetPerformanceCounter();
+	for ( i = 0; i < names.Num(); i++ ) {
+		len = fileSystemLocal.ReadFile( names[i], &buffer, NULL );
+		if ( buffer ) {
+			bytes += len;
+			fileSystemLocal.FreeFile( buffer );
+		}
+	}
+	readFileTime = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - start );
+
+	start = Sys_GetPerformanceCounter();
+	fileSystemLocal.ReadFiles( names.Num(), names.Ptr(), buffers.Ptr(), lengths.Ptr() );
+	readFilesTime = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - start );
+
+	numMismatched = 0;
+	for ( i = 0; i < names.Num(); i++ ) {
+		if ( !buffers[i] ) {
+			continue;
+		}
+		len = fileSystemLocal.ReadFile( names[i], &buffer, NULL );
+		if ( len != lengths[i] || memcmp( buffer, buffers[i], len ) != 0 ) {
+			common->Printf( "%s differs\n", names[i] );
+			numMismatched++;
+		}
+		fileSystemLocal.FreeFile( buffer );
+		fileSystemLocal.FreeFile( buffers[i] );
+	}
+
+	common->Printf( "%d files, %.2f MB: %d loose, %d stored, %d deflated, %d missing\n", names.Num(), bytes / ( 1024.0f * 1024.0f ), numLoose, numStored, numDeflated, numMissing );
+	common->Printf( "ReadFile %.2f ms, ReadFiles %.2f ms with %d workers\n", readFileTime, readFilesTime, jobSystem->GetNumWorkers() );
+	if ( numMismatched ) {
+		common->Printf( "%d files differ between ReadFile and ReadFiles\n", numMismatched );
+	}
+}
+
 /*
 ================
 idFileSystemLocal::AddGameDirectory
@@ -2258,6 +2950,9 @@ void idFileSystemLocal::Startup( void ) {
 		common->Printf( "restarting filesystem with %d addon pak file(s) to include\n", addonChecksums.Num() );
 	}
 
+	LoadPakIndex();
+	pakIndexDirty = false;
+
 #ifndef DEMO
 	SetupGameDirectories( BASE_GAMEDIR );
 #endif
@@ -2402,12 +3097,22 @@ void idFileSystemLocal::Startup( void ) {
 		}
 	}
 
+	// save the directories of new paks and drop the old ones
+	WritePakIndex();
+	FreePakIndex();
+
+	BuildFileIndex();
+
+	StartIOThreads();
+
 	// add our commands
 	cmdSystem->AddCommand( "dir", Dir_f, CMD_FL_SYSTEM, "lists a folder", idCmdSystem::ArgCompletion_FileName );
 	cmdSystem->AddCommand( "dirtree", DirTree_f, CMD_FL_SYSTEM, "lists a folder with subfolders" );
 	cmdSystem->AddCommand( "path", Path_f, CMD_FL_SYSTEM, "lists search paths" );
 	cmdSystem->AddCommand( "touchFile", TouchFile_f, CMD_FL_SYSTEM, "touches a file" );
 	cmdSystem->AddCommand( "touchFileList", TouchFileList_f, CMD_FL_SYSTEM, "touches a list of files" );
+	cmdSystem->AddCommand( "testFileRead", TestFileRead_f, CMD_FL_SYSTEM, "times reading the files of the last map one by one and with ReadFiles" );
+	cmdSystem->AddCommand( "prefetchMap", PrefetchMap_f, CMD_FL_SYSTEM, "reads the files of a map ahead into the page cache" );
 
 	// print the current search paths
 	Path_f( idCmdArgs() );
@@ -2771,6 +3476,9 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 	Sys_DestroyThread(backgroundThread);
 	backgroundThread_exit = false;
 
+	// reads refer to the paks that are freed below
+	StopIOThreads();
+
 	gameFolder.Clear();
 
 	serverPaks.Clear();
@@ -2789,6 +3497,8 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 
 			if ( sp->pack ) {
 				unzClose( sp->pack->handle );
+				// files read straight from the mapping can still be open
+				ReleasePakMapping( sp->pack->mapping );
 				delete [] sp->pack->buildBuffer;
 				if ( sp->pack->addon_info ) {
 					sp->pack->addon_info->mapDecls.DeleteContents( true );
@@ -2807,10 +3517,23 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 	searchPaths = NULL;
 	addonPaks = NULL;
 
+	fileIndex.Clear();
+	fileIndexHash.Free();
+	fileIndexValid = false;
+	levelFiles.Clear();
+	levelFileHash.Free();
+
+	for ( int i = 0; i < inflateJobs.Num(); i++ ) {
+		jobSystem->FreeJobList( inflateJobs[i] );
+	}
+	inflateJobs.Clear();
+
 	cmdSystem->RemoveCommand( "path" );
 	cmdSystem->RemoveCommand( "dir" );
 	cmdSystem->RemoveCommand( "dirtree" );
 	cmdSystem->RemoveCommand( "touchFile" );
+	cmdSystem->RemoveCommand( "testFileRead" );
+	cmdSystem->RemoveCommand( "prefetchMap" );
 
 	mapDict.Clear();
 }
@@ -2937,14 +3660,106 @@ pureStatus_t idFileSystemLocal::GetPackStatus( pack_t *pak ) {
 }
 
 /*
-===========
-idFileSystemLocal::ReadFileFromZip
-===========
-*/
-idFile_InZip * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
-	// relativePath == pakFile->name according to FilenameCompare()
+===============================================================================
+
+idFile_InMappedPak
+
+a stored file read straight from a mapped pak, keeps the mapping alive while it is open
+
+===============================================================================
+*/
+class idFile_InMappedPak : public idFile_Memory {
+public:
+							idFile_InMappedPak( const char *name, const byte *data, int length, pakMapping_t *mapping ) :
+								idFile_Memory( name, (const char *)data, length ), mapping( mapping ) { mapping->refCount++; }
+	virtual					~idFile_InMappedPak( void ) { ReleasePakMapping( mapping ); }
+
+private:
+	pakMapping_t *			mapping;
+};
+
+/*
+===========
+MappedFileData
+
+returns the data of a file in a mapped pak, or NULL if minizip has to read it
+===========
+*/
+static const byte *MappedFileData( const pack_t *pak, const fileInPack_t *pakFile ) {
+	const byte *header;
+	int			pos;
+
+	if ( !pak->mappedData || pakFile->method < 0 || pakFile->localPos < 0 || pakFile->localPos > pak->length - 30 ) {
+		return NULL;
+	}
+	header = pak->mappedData + pakFile->localPos;
+	if ( ZipLong( header ) != 0x04034b50 ) {
+		return NULL;
+	}
+	// the name and extra field of the local header can differ from the central directory
+	pos = pakFile->localPos + 30 + ZipShort( header + 26 ) + ZipShort( header + 28 );
+	if ( pos > pak->length - pakFile->compressedSize ) {
+		return NULL;
+	}
+	return pak->mappedData + pos;
+}
+
+/*
+===========
+InflateMappedFile
+
+inflates a whole file, only touches the given memory so it can run on any thread
+===========
+*/
+static bool InflateMappedFile( const byte *data, int compressedSize, byte *buffer, int length ) {
+	z_stream	zs;
+	int			err;
+
+	memset( &zs, 0, sizeof( zs ) );
+	zs.next_in = (Bytef *)data;
+	zs.avail_in = compressedSize;
+	zs.next_out = (Bytef *)buffer;
+	zs.avail_out = length;
+
+	// raw deflate data without zlib header
+	if ( inflateInit2( &zs, -MAX_WBITS ) != Z_OK ) {
+		return false;
+	}
+	err = inflate( &zs, Z_FINISH );
+	inflateEnd( &zs );
+
+	return ( err == Z_STREAM_END && zs.total_out == (uLong)length );
+}
+
+/*
+===========
+idFileSystemLocal::ReadFileFromZip
+===========
+*/
+idFile * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
+	// relativePath == pakFile->name according to FilenameCompare()
 	// pakFile->Pos is position of that file within the zip
 
+	const byte *data = MappedFileData( pak, pakFile );
+	if ( data ) {
+		// stored files are read straight from the mapping, the file holds a reference so
+		// it stays valid when the paks are closed while it is open
+		if ( pakFile->method == 0 || pakFile->uncompressedSize == 0 ) {
+			return new idFile_InMappedPak( relativePath, data, pakFile->uncompressedSize, pak->mapping );
+		}
+		if ( pakFile->uncompressedSize <= MAX_MAPPED_INFLATE_SIZE ) {
+			byte *buffer = (byte *)Mem_Alloc( pakFile->uncompressedSize );
+			if ( InflateMappedFile( data, pakFile->compressedSize, buffer, pakFile->uncompressedSize ) ) {
+				idFile_Memory *file = new idFile_Memory( relativePath, (const char *)buffer, pakFile->uncompressedSize );
+				// the file frees the buffer
+				file->allocated = pakFile->uncompressedSize;
+				return file;
+			}
+			Mem_Free( buffer );
+			common->Warning( "Couldn't inflate %s in %s", relativePath, pak->pakFilename.c_str() );
+		}
+	}
+
 	// set position in pk4 file to the file (in the zip/pk4) we want a handle on
 	unzSetOffset64( pak->handle, pakFile->pos );
 
@@ -2973,6 +3788,921 @@ idFile_InZip * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pa
 	return file;
 }
 
+/*
+============
+idFileSystemLocal::ReadFiles
+
+Big compressed files in mapped paks are inflated on the job workers while the
+other files are read on the calling thread. Each big file gets its own job list
+so its inflate starts as soon as the file is found.
+============
+*/
+typedef struct {
+	int				fileNum;
+	const byte *	data;
+	int				compressedSize;
+	byte *			buffer;
+	int				length;
+	bool			ok;
+} inflateJob_t;
+
+static void InflateJob_Run( void *data ) {
+	inflateJob_t *job = (inflateJob_t *)data;
+	job->ok = InflateMappedFile( job->data, job->compressedSize, job->buffer, job->length );
+}
+
+void idFileSystemLocal::ReadFiles( int numFiles, const char * const *relativePaths, void **buffers, int *lengths, ID_TIME_T *timestamps ) {
+	idList<inflateJob_t>	jobs;
+	idFile *				f;
+	pack_t *				pak;
+	fileInPack_t *			pakFile;
+	const byte *			data;
+	byte *					buf;
+	int						parallelSize;
+	int						i;
+
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+
+	parallelSize = ( jobSystem->GetNumWorkers() > 0 ) ? fs_parallelInflateSize.GetInteger() : 0;
+
+	// the list must not move while the jobs run
+	jobs.Resize( numFiles );
+
+	for ( i = 0; i < numFiles; i++ ) {
+		buffers[i] = NULL;
+		lengths[i] = -1;
+		if ( timestamps ) {
+			timestamps[i] = FILE_NOT_FOUND_TIMESTAMP;
+		}
+
+		f = LocateFileRead( relativePaths[i], FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS, &pak, true, NULL, &pakFile );
+		if ( !f && !pakFile ) {
+			continue;
+		}
+		if ( timestamps ) {
+			// files in paks have no timestamp of their own
+			timestamps[i] = f ? f->Timestamp() : 0;
+		}
+		AddUnique( relativePaths[i], levelFiles, levelFileHash );
+
+		if ( pakFile ) {
+			data = MappedFileData( pak, pakFile );
+			if ( data && parallelSize > 0 && pakFile->method == Z_DEFLATED && pakFile->uncompressedSize >= parallelSize ) {
+				inflateJob_t &job = jobs.Alloc();
+				job.fileNum = i;
+				job.data = data;
+				job.compressedSize = pakFile->compressedSize;
+				job.length = pakFile->uncompressedSize;
+				job.buffer = (byte *)Mem_ClearedAlloc( job.length + 1 );
+				job.ok = false;
+				// start inflating right away so it overlaps the reads of the following files
+				if ( jobs.Num() > inflateJobs.Num() ) {
+					inflateJobs.Append( jobSystem->AllocJobList( "inflateFiles" ) );
+				}
+				idJobList *jobList = inflateJobs[jobs.Num() - 1];
+				jobList->AddJob( InflateJob_Run, &job, "inflate" );
+				jobList->Submit();
+				continue;
+			}
+			f = ReadFileFromZip( pak, pakFile, relativePaths[i] );
+		}
+
+		loadCount++;
+		loadStack++;
+
+		lengths[i] = f->Length();
+		buf = (byte *)Mem_ClearedAlloc( lengths[i] + 1 );
+		f->Read( buf, lengths[i] );
+		// guarantee that it will have a trailing 0 for string operations
+		buf[lengths[i]] = 0;
+		buffers[i] = buf;
+		CloseFile( f );
+	}
+
+	if ( !jobs.Num() ) {
+		return;
+	}
+
+	for ( i = 0; i < jobs.Num(); i++ ) {
+		inflateJobs[i]->Wait();
+		inflateJobs[i]->Clear();
+	}
+
+	for ( i = 0; i < jobs.Num(); i++ ) {
+		inflateJob_t &job = jobs[i];
+		if ( !job.ok ) {
+			// let minizip have a go
+			Mem_Free( job.buffer );
+			lengths[job.fileNum] = ReadFile( relativePaths[job.fileNum], &buffers[job.fileNum], NULL );
+			continue;
+		}
+		loadCount++;
+		loadStack++;
+		buffers[job.fileNum] = job.buffer;
+		lengths[job.fileNum] = job.length;
+	}
+}
+
+/*
+=================================================================================
+
+asynchronous reads
+
+The file is looked up on the thread that queues the read, so the search path is
+only walked by the main thread. The I/O threads read loose files and unmapped
+paks through their own file handles and copy or inflate mapped pak data, none of
+which touches shared filesystem state.
+
+=================================================================================
+*/
+
+/*
+============
+idFileSystemLocal::AllocAsyncRead
+
+asyncLock must be held
+============
+*/
+asyncRead_t *idFileSystemLocal::AllocAsyncRead( void ) {
+	asyncRead_t *read;
+	int slot;
+
+	if ( freeAsyncReads.Num() ) {
+		slot = freeAsyncReads[freeAsyncReads.Num() - 1];
+		freeAsyncReads.RemoveIndex( freeAsyncReads.Num() - 1 );
+		read = asyncReads[slot];
+	} else {
+		slot = asyncReads.Num();
+		if ( slot >= ( 1 << ASYNC_READ_SLOT_BITS ) ) {
+			common->FatalError( "idFileSystemLocal::ReadFileAsync: too many pending reads" );
+		}
+		read = new asyncRead_t;
+		asyncReads.Append( read );
+	}
+
+	asyncReadSerial = ( asyncReadSerial + 1 ) & ( ( 1 << ( 31 - ASYNC_READ_SLOT_BITS ) ) - 1 );
+	read->handle = ( asyncReadSerial << ASYNC_READ_SLOT_BITS ) | slot;
+	read->state = ASYNC_READ_QUEUED;
+	read->priority = FS_READ_PRIORITY_NORMAL;
+	read->prefetch = false;
+	read->cancelled = false;
+	read->retry = false;
+	read->relativePath.Clear();
+	read->callback = NULL;
+	read->data = NULL;
+	read->file = NULL;
+	read->mapped = NULL;
+	read->pakPath.Clear();
+	read->localPos = -1;
+	read->method = -1;
+	read->compressedSize = 0;
+	read->length = -1;
+	read->buffer = NULL;
+	return read;
+}
+
+/*
+============
+idFileSystemLocal::FindAsyncRead
+
+asyncLock must be held, returns NULL for handles that were released
+============
+*/
+asyncRead_t *idFileSystemLocal::FindAsyncRead( int handle ) const {
+	int slot = handle & ( ( 1 << ASYNC_READ_SLOT_BITS ) - 1 );
+
+	if ( handle < 0 || slot >= asyncReads.Num() ) {
+		return NULL;
+	}
+	asyncRead_t *read = asyncReads[slot];
+	if ( read->handle != handle || read->state == ASYNC_READ_FREE ) {
+		return NULL;
+	}
+	return read;
+}
+
+/*
+============
+idFileSystemLocal::FreeAsyncRead
+
+asyncLock must be held, the result has to be handed out or freed already
+============
+*/
+void idFileSystemLocal::FreeAsyncRead( asyncRead_t *read ) {
+	if ( read->file ) {
+		delete read->file;
+		read->file = NULL;
+	}
+	read->state = ASYNC_READ_FREE;
+	read->buffer = NULL;
+	freeAsyncReads.Append( read->handle & ( ( 1 << ASYNC_READ_SLOT_BITS ) - 1 ) );
+}
+
+/*
+============
+idFileSystemLocal::HasQueuedReads
+
+asyncLock must be held
+============
+*/
+bool idFileSystemLocal::HasQueuedReads( void ) const {
+	for ( int i = 0; i < FS_READ_PRIORITIES; i++ ) {
+		if ( readQueueHeads[i] < readQueues[i].Num() ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+============
+idFileSystemLocal::NextQueuedRead
+
+asyncLock must be held, takes the oldest read of the highest priority
+============
+*/
+asyncRead_t *idFileSystemLocal::NextQueuedRead( void ) {
+	for ( int i = FS_READ_PRIORITIES - 1; i >= 0; i-- ) {
+		idList<int> &queue = readQueues[i];
+		while ( readQueueHeads[i] < queue.Num() ) {
+			// cancelled and raised reads leave stale handles behind
+			asyncRead_t *read = FindAsyncRead( queue[readQueueHeads[i]++] );
+			if ( read && read->state == ASYNC_READ_QUEUED ) {
+				return read;
+			}
+		}
+		queue.SetNum( 0, false );
+		readQueueHeads[i] = 0;
+	}
+	return NULL;
+}
+
+/*
+============
+idFileSystemLocal::ExecuteAsyncRead
+
+only touches the read itself, runs without asyncLock
+============
+*/
+void idFileSystemLocal::ExecuteAsyncRead( asyncRead_t *read ) {
+	PROFILE_SCOPE( "idFileSystem::ExecuteAsyncRead" );
+
+	if ( read->prefetch ) {
+		int bytes = 0;
+		if ( read->mapped ) {
+			// fault in the pages of the compressed data
+			volatile byte touch = 0;
+			for ( int i = 0; i < read->compressedSize; i += 4096 ) {
+				touch = touch + read->mapped[i];
+			}
+			bytes = read->compressedSize;
+		} else if ( read->file || read->pakPath.Length() ) {
+			FILE *fp;
+			int remaining;
+			if ( read->file ) {
+				fp = static_cast<idFile_Permanent *>( read->file )->GetFilePtr();
+				remaining = read->file->Length();
+			} else {
+				byte header[30];
+				fp = fopen( read->pakPath, "rb" );
+				remaining = 0;
+				if ( fp && fseek( fp, read->localPos, SEEK_SET ) == 0 && fread( header, 1, sizeof( header ), fp ) == sizeof( header ) ) {
+					if ( ZipLong( header ) == 0x04034b50 && fseek( fp, ZipShort( header + 26 ) + ZipShort( header + 28 ), SEEK_CUR ) == 0 ) {
+						remaining = read->compressedSize;
+					}
+				}
+			}
+			byte *block = (byte *)Mem_Alloc( 65536 );
+			while ( fp && remaining > 0 ) {
+				int n = (int)fread( block, 1, Min( remaining, 65536 ), fp );
+				if ( n <= 0 ) {
+					break;
+				}
+				remaining -= n;
+				bytes += n;
+			}
+			Mem_Free( block );
+			if ( fp && !read->file ) {
+				fclose( fp );
+			}
+		}
+		read->length = bytes;
+		return;
+	}
+
+	if ( read->mapped ) {
+		byte *buf = (byte *)Mem_Alloc( read->length + 1 );
+		if ( read->method == 0 || read->length == 0 ) {
+			memcpy( buf, read->mapped, read->length );
+		} else if ( !InflateMappedFile( read->mapped, read->compressedSize, buf, read->length ) ) {
+			Mem_Free( buf );
+			read->retry = true;
+			read->length = -1;
+			return;
+		}
+		// guarantee that it will have a trailing 0 for string operations
+		buf[read->length] = 0;
+		read->buffer = buf;
+	} else if ( read->file ) {
+		read->length = read->file->Length();
+		byte *buf = (byte *)Mem_Alloc( read->length + 1 );
+		read->file->Read( buf, read->length );
+		buf[read->length] = 0;
+		read->buffer = buf;
+		delete read->file;
+		read->file = NULL;
+	}
+}
+
+/*
+============
+idFileSystemLocal::FinishAsyncRead
+
+asyncLock must be held
+============
+*/
+void idFileSystemLocal::FinishAsyncRead( asyncRead_t *read ) {
+	if ( read->prefetch ) {
+		numPrefetching--;
+		numPrefetched++;
+		prefetchBytes += read->length;
+	}
+	if ( read->prefetch || read->cancelled ) {
+		if ( read->buffer ) {
+			Mem_Free( read->buffer );
+		}
+		FreeAsyncRead( read );
+	} else {
+		read->state = ASYNC_READ_DONE;
+		if ( read->callback ) {
+			finishedReads.Append( read->handle );
+		}
+	}
+	asyncDone.notify_all();
+}
+
+/*
+============
+idFileSystemLocal::IOThread
+============
+*/
+int idFileSystemLocal::IOThread( void *parm ) {
+	idFileSystemLocal *fs = (idFileSystemLocal *)parm;
+
+	std::unique_lock<std::mutex> lock( fs->asyncLock );
+	while ( 1 ) {
+		fs->asyncWork.wait( lock, [fs] { return fs->ioThreadsExit || fs->HasQueuedReads(); } );
+		if ( fs->ioThreadsExit ) {
+			break;
+		}
+		asyncRead_t *read = fs->NextQueuedRead();
+		if ( !read ) {
+			continue;
+		}
+		read->state = ASYNC_READ_RUNNING;
+
+		lock.unlock();
+		ExecuteAsyncRead( read );
+		lock.lock();
+
+		fs->FinishAsyncRead( read );
+	}
+	return 0;
+}
+
+/*
+============
+idFileSystemLocal::StartIOThreads
+============
+*/
+void idFileSystemLocal::StartIOThreads( void ) {
+	ioThreadsExit = false;
+	numIOThreads = idMath::ClampInt( 0, MAX_IO_THREADS, fs_ioThreads.GetInteger() );
+	for ( int i = 0; i < numIOThreads; i++ ) {
+		ioThreadNames[i] = va( "fsIO%d", i );
+		Sys_CreateThread( IOThread, this, ioThreads[i], ioThreadNames[i].c_str() );
+	}
+}
+
+/*
+============
+idFileSystemLocal::StopIOThreads
+
+drops all reads, running ones are finished first
+============
+*/
+void idFileSystemLocal::StopIOThreads( void ) {
+	{
+		std::lock_guard<std::mutex> guard( asyncLock );
+		ioThreadsExit = true;
+	}
+	asyncWork.notify_all();
+	for ( int i = 0; i < numIOThreads; i++ ) {
+		Sys_DestroyThread( ioThreads[i] );
+	}
+	numIOThreads = 0;
+	ioThreadsExit = false;
+
+	for ( int i = 0; i < asyncReads.Num(); i++ ) {
+		asyncRead_t *read = asyncReads[i];
+		if ( read->state == ASYNC_READ_FREE ) {
+			continue;
+		}
+		if ( read->buffer ) {
+			Mem_Free( read->buffer );
+		}
+		FreeAsyncRead( read );
+	}
+	for ( int i = 0; i < FS_READ_PRIORITIES; i++ ) {
+		readQueues[i].Clear();
+		readQueueHeads[i] = 0;
+	}
+	asyncReads.DeleteContents( true );
+	freeAsyncReads.Clear();
+	finishedReads.Clear();
+	numPrefetching = 0;
+	prefetchStartTime = 0;
+}
+
+/*
+============
+idFileSystemLocal::QueueRead
+============
+*/
+int idFileSystemLocal::QueueRead( const char *relativePath, fsReadPriority_t priority, fsReadCallback_t callback, void *data, bool prefetch ) {
+	idFile *		f;
+	pack_t *		pak;
+	fileInPack_t *	pakFile;
+	const byte *	mapped;
+	int				handle;
+
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+
+	if ( !relativePath || !relativePath[0] ) {
+		common->FatalError( "idFileSystemLocal::ReadFileAsync with empty name\n" );
+	}
+
+	// prefetching doesn't count as using the file
+	f = LocateFileRead( relativePath, FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS | ( prefetch ? FSFLAG_PURE_NOREF : 0 ), &pak, !prefetch, NULL, &pakFile );
+
+	mapped = NULL;
+	if ( pakFile ) {
+		mapped = MappedFileData( pak, pakFile );
+		if ( !mapped && !prefetch ) {
+			// the file gets its own stream of the pak
+			f = ReadFileFromZip( pak, pakFile, relativePath );
+		}
+	}
+	if ( !prefetch && ( f || pakFile ) ) {
+		AddUnique( relativePath, levelFiles, levelFileHash );
+	}
+
+	std::unique_lock<std::mutex> lock( asyncLock );
+
+	asyncRead_t *read = AllocAsyncRead();
+	read->priority = priority;
+	read->prefetch = prefetch;
+	read->relativePath = relativePath;
+	read->callback = callback;
+	read->data = data;
+	read->file = f;
+	if ( pakFile ) {
+		read->method = pakFile->method;
+		read->compressedSize = pakFile->compressedSize;
+		if ( mapped ) {
+			read->mapped = mapped;
+			read->length = pakFile->uncompressedSize;
+		} else if ( prefetch && pakFile->method >= 0 ) {
+			read->pakPath = pak->pakFilename;
+			read->localPos = pakFile->localPos;
+		}
+	}
+	handle = read->handle;
+
+	if ( prefetch ) {
+		numPrefetching++;
+	}
+
+	if ( !f && !pakFile ) {
+		// not found, finish right away
+		read->length = -1;
+		FinishAsyncRead( read );
+	} else if ( !numIOThreads ) {
+		read->state = ASYNC_READ_RUNNING;
+		lock.unlock();
+		ExecuteAsyncRead( read );
+		lock.lock();
+		FinishAsyncRead( read );
+	} else {
+		readQueues[priority].Append( handle );
+		asyncWork.notify_one();
+	}
+
+	return handle;
+}
+
+/*
+============
+idFileSystemLocal::ReadFileAsync
+============
+*/
+int idFileSystemLocal::ReadFileAsync( const char *relativePath, fsReadPriority_t priority, fsReadCallback_t callback, void *data ) {
+	return QueueRead( relativePath, priority, callback, data, false );
+}
+
+/*
+============
+idFileSystemLocal::IsReadDone
+============
+*/
+bool idFileSystemLocal::IsReadDone( int handle ) {
+	std::lock_guard<std::mutex> guard( asyncLock );
+	asyncRead_t *read = FindAsyncRead( handle );
+	return ( read == NULL || read->state == ASYNC_READ_DONE );
+}
+
+/*
+============
+idFileSystemLocal::DeliverRead
+
+hands a finished read out on the main thread
+============
+*/
+int idFileSystemLocal::DeliverRead( const idStr &relativePath, void *buffer, int length, bool retry, void **result ) {
+	if ( retry ) {
+		common->Warning( "Couldn't inflate %s from the mapped pak", relativePath.c_str() );
+		return ReadFile( relativePath, result, NULL );
+	}
+	if ( buffer ) {
+		loadCount++;
+		loadStack++;
+	}
+	*result = buffer;
+	return length;
+}
+
+/*
+============
+idFileSystemLocal::WaitRead
+============
+*/
+int idFileSystemLocal::WaitRead( int handle, void **buffer ) {
+	void *	readBuffer;
+	int		length;
+	bool	retry;
+	idStr	relativePath;
+
+	*buffer = NULL;
+
+	std::unique_lock<std::mutex> lock( asyncLock );
+
+	asyncRead_t *read = FindAsyncRead( handle );
+	if ( !read || read->callback ) {
+		return -1;
+	}
+
+	if ( read->state == ASYNC_READ_QUEUED && read->priority != FS_READ_PRIORITY_HIGH ) {
+		// somebody is waiting for it now, the stale handle in the old queue is skipped
+		read->priority = FS_READ_PRIORITY_HIGH;
+		readQueues[FS_READ_PRIORITY_HIGH].Append( handle );
+		asyncWork.notify_one();
+	}
+	asyncDone.wait( lock, [read] { return read->state == ASYNC_READ_DONE; } );
+
+	readBuffer = read->buffer;
+	length = read->length;
+	retry = read->retry;
+	if ( retry ) {
+		relativePath = read->relativePath;
+	}
+	FreeAsyncRead( read );
+	lock.unlock();
+
+	return DeliverRead( relativePath, readBuffer, length, retry, buffer );
+}
+
+/*
+============
+idFileSystemLocal::CancelRead
+============
+*/
+void idFileSystemLocal::CancelRead( int handle ) {
+	std::lock_guard<std::mutex> guard( asyncLock );
+
+	asyncRead_t *read = FindAsyncRead( handle );
+	if ( !read ) {
+		return;
+	}
+	if ( read->state == ASYNC_READ_RUNNING ) {
+		read->cancelled = true;
+		return;
+	}
+	if ( read->state == ASYNC_READ_DONE ) {
+		finishedReads.Remove( handle );
+	}
+	if ( read->buffer ) {
+		Mem_Free( read->buffer );
+	}
+	if ( read->prefetch && read->state == ASYNC_READ_QUEUED ) {
+		numPrefetching--;
+	}
+	FreeAsyncRead( read );
+}
+
+/*
+============
+idFileSystemLocal::ServiceReads
+============
+*/
+void idFileSystemLocal::ServiceReads( void ) {
+	idList<int>	finished;
+	void *		readBuffer;
+	void *		buffer;
+	int			length;
+	bool		retry;
+	idStr		relativePath;
+	fsReadCallback_t callback;
+	void *		data;
+
+	PROFILE_SCOPE( "idFileSystem::ServiceReads" );
+
+	if ( !searchPaths ) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock( asyncLock );
+
+	if ( prefetchStartTime && !numPrefetching ) {
+		common->Printf( "prefetched %d files, %.1f MB in %d msec\n", numPrefetched, prefetchBytes / ( 1024.0f * 1024.0f ), Sys_Milliseconds() - prefetchStartTime );
+		prefetchStartTime = 0;
+	}
+
+	finished = finishedReads;
+	finishedReads.SetNum( 0, false );
+
+	for ( int i = 0; i < finished.Num(); i++ ) {
+		asyncRead_t *read = FindAsyncRead( finished[i] );
+		if ( !read ) {
+			continue;
+		}
+		readBuffer = read->buffer;
+		length = read->length;
+		retry = read->retry;
+		relativePath = read->relativePath;
+		callback = read->callback;
+		data = read->data;
+		FreeAsyncRead( read );
+
+		// the callback may queue or cancel reads
+		lock.unlock();
+		length = DeliverRead( relativePath, readBuffer, length, retry, &buffer );
+		callback( relativePath, buffer, length, data );
+		lock.lock();
+	}
+}
+
+/*
+============
+idFileSystemLocal::PrefetchListName
+============
+*/
+idStr idFileSystemLocal::PrefetchListName( const char *mapName ) const {
+	idStr name = mapName;
+
+	name.StripPath();
+	name.StripFileExtension();
+	return idStr( PREFETCH_LIST_DIR "/" ) + name + ".txt";
+}
+
+/*
+============
+idFileSystemLocal::PrefetchMap
+============
+*/
+void idFileSystemLocal::PrefetchMap( const char *mapName ) {
+	idFile *	f;
+	char *		text;
+	idToken		token;
+	int			length;
+	int			count;
+
+	if ( !fs_prefetch.GetBool() || !searchPaths ) {
+		return;
+	}
+
+	// not through OpenFileRead, the list isn't part of the level
+	f = LocateFileRead( PrefetchListName( mapName ), FSFLAG_SEARCH_DIRS, NULL, false, NULL, NULL );
+	if ( !f ) {
+		return;
+	}
+	length = f->Length();
+	text = (char *)Mem_Alloc( length + 1 );
+	f->Read( text, length );
+	text[length] = 0;
+	delete f;
+
+	idLexer src( text, length, PrefetchListName( mapName ), LEXFL_NOFATALERRORS | LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS );
+	count = 0;
+	while ( src.ReadToken( &token ) ) {
+		QueueRead( token, FS_READ_PRIORITY_LOW, NULL, NULL, true );
+		count++;
+	}
+	Mem_Free( text );
+
+	if ( count ) {
+		std::lock_guard<std::mutex> guard( asyncLock );
+		if ( !prefetchStartTime ) {
+			prefetchStartTime = Sys_Milliseconds();
+			numPrefetched = 0;
+			prefetchBytes = 0;
+		}
+	}
+	common->Printf( "prefetching %d files for %s\n", count, mapName );
+}
+
+/*
+============
+idFileSystemLocal::WritePrefetchList
+
+the list keeps growing, a file loaded for one visit of a map is likely loaded again
+============
+*/
+void idFileSystemLocal::WritePrefetchList( const char *mapName ) {
+	idStrList	files;
+	idHashIndex	fileHash;
+	idFile *	f;
+	idStr		listName;
+	idToken		token;
+	int			i;
+
+	if ( !fs_prefetch.GetBool() || !searchPaths ) {
+		return;
+	}
+
+	listName = PrefetchListName( mapName );
+
+	f = LocateFileRead( listName, FSFLAG_SEARCH_DIRS, NULL, false, NULL, NULL );
+	if ( f ) {
+		int length = f->Length();
+		char *text = (char *)Mem_Alloc( length + 1 );
+		f->Read( text, length );
+		text[length] = 0;
+		delete f;
+
+		idLexer src( text, length, listName, LEXFL_NOFATALERRORS | LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS );
+		while ( src.ReadToken( &token ) ) {
+			AddUnique( token, files, fileHash );
+		}
+		Mem_Free( text );
+	}
+
+	int numOld = files.Num();
+	for ( i = 0; i < levelFiles.Num(); i++ ) {
+		if ( idStr::Icmpn( levelFiles[i], PREFETCH_LIST_DIR, strlen( PREFETCH_LIST_DIR ) ) == 0 ) {
+			continue;
+		}
+		AddUnique( levelFiles[i], files, fileHash );
+	}
+	if ( files.Num() == numOld ) {
+		return;
+	}
+
+	f = OpenFileWrite( listName, "fs_savepath" );
+	if ( !f ) {
+		common->Warning( "Couldn't write %s", listName.c_str() );
+		return;
+	}
+	for ( i = 0; i < files.Num(); i++ ) {
+		f->Printf( "\"%s\"\n", files[i].c_str() );
+	}
+	CloseFile( f );
+}
+
+/*
+============
+idFileSystemLocal::PrefetchMap_f
+============
+*/
+void idFileSystemLocal::PrefetchMap_f( const idCmdArgs &args ) {
+	if ( args.Argc() != 2 ) {
+		common->Printf( "Usage: prefetchMap <map>\n" );
+		return;
+	}
+	fileSystemLocal.PrefetchMap( args.Argv( 1 ) );
+}
+
+/*
+===========
+idFileSystemLocal::FileIndexKey
+
+hash key that ignores the same case and separator differences as FilenameCompare
+===========
+*/
+int idFileSystemLocal::FileIndexKey( const char *relativePath ) const {
+	int key;
+	int c;
+
+	key = 0;
+	while ( ( c = *relativePath++ ) != '\0' ) {
+		if ( c >= 'a' && c <= 'z' ) {
+			c -= ( 'a' - 'A' );
+		} else if ( c == '\\' || c == ':' ) {
+			c = '/';
+		}
+		key = key * 31 + c;
+	}
+	return key ^ ( key >> 16 );
+}
+
+/*
+===========
+idFileSystemLocal::BuildFileIndex
+
+Indexes the files of all paks on the search path, so a file is found with a single
+lookup instead of one per pak. Has to be rebuilt whenever the search path changes.
+===========
+*/
+void idFileSystemLocal::BuildFileIndex( void ) {
+	searchpath_t *	search;
+	pack_t *		pak;
+	fileInPack_t *	pakFile;
+	idList<int>		last;
+	int				numFiles;
+	int				key;
+	int				i;
+	int				j;
+	int				n;
+
+	numFiles = 0;
+	for ( search = searchPaths; search; search = search->next ) {
+		if ( search->pack ) {
+			numFiles += search->pack->numfiles;
+		}
+	}
+
+	fileIndex.Clear();
+	fileIndex.Resize( numFiles );
+	fileIndexHash.Clear( 32768, Max( numFiles, 1 ) );
+	last.Resize( numFiles );
+
+	for ( search = searchPaths; search; search = search->next ) {
+		pak = search->pack;
+		if ( !pak ) {
+			continue;
+		}
+		for ( i = 0; i < pak->numfiles; i++ ) {
+			pakFile = &pak->buildBuffer[i];
+			key = FileIndexKey( pakFile->name );
+			for ( j = fileIndexHash.First( key ); j != -1; j = fileIndexHash.Next( j ) ) {
+				if ( !FilenameCompare( fileIndex[j].file->name, pakFile->name ) ) {
+					break;
+				}
+			}
+			if ( j != -1 && fileIndex[last[j]].pack == pak ) {
+				// the hash chain of the pak returns the last entry of a name
+				fileIndex[last[j]].file = pakFile;
+				continue;
+			}
+
+			indexedFile_t &file = fileIndex.Alloc();
+			file.pack = pak;
+			file.file = pakFile;
+			file.next = -1;
+			n = last.Append( fileIndex.Num() - 1 );
+			if ( j == -1 ) {
+				fileIndexHash.Add( key, n );
+			} else {
+				fileIndex[last[j]].next = n;
+				last[j] = n;
+			}
+		}
+	}
+
+	fileIndexValid = true;
+}
+
+/*
+===========
+idFileSystemLocal::FindIndexedFile
+
+returns the first entry of the file in the index, or -1
+===========
+*/
+int idFileSystemLocal::FindIndexedFile( const char *relativePath ) const {
+	int i;
+
+	for ( i = fileIndexHash.First( FileIndexKey( relativePath ) ); i != -1; i = fileIndexHash.Next( i ) ) {
+		if ( !FilenameCompare( fileIndex[i].file->name, relativePath ) ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
 /*
 ===========
 idFileSystemLocal::OpenFileReadFlags
@@ -2984,12 +4714,31 @@ separate file or a ZIP file.
 ===========
 */
 idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int searchFlags, pack_t **foundInPak, bool allowCopyFiles, const char* gamedir ) {
+	PROFILE_SCOPE( "idFileSystem::OpenFileRead" );
+
+	idFile *file = LocateFileRead( relativePath, searchFlags, foundInPak, allowCopyFiles, gamedir, NULL );
+	if ( file ) {
+		AddUnique( relativePath, levelFiles, levelFileHash );
+	}
+	return file;
+}
+
+/*
+===========
+idFileSystemLocal::LocateFileRead
+
+Does the work of OpenFileReadFlags. When foundPakFile is given, a file found
+in a pak isn't opened, the pak and the file in it are returned instead.
+===========
+*/
+idFile *idFileSystemLocal::LocateFileRead( const char *relativePath, int searchFlags, pack_t **foundInPak, bool allowCopyFiles, const char* gamedir, fileInPack_t **foundPakFile ) {
 	searchpath_t *	search;
 	idStr			netpath;
 	pack_t *		pak;
 	fileInPack_t *	pakFile;
 	directory_t *	dir;
 	int				hash;
+	int				indexed;
 	FILE *			fp;
 
 	if ( !searchPaths ) {
@@ -3003,6 +4752,9 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 	if ( foundInPak ) {
 		*foundInPak = NULL;
 	}
+	if ( foundPakFile ) {
+		*foundPakFile = NULL;
+	}
 
 	// qpaths are not supposed to have a leading slash
 	if ( relativePath[0] == '/' || relativePath[0] == '\\' ) {
@@ -3036,6 +4788,12 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 
 	hash = HashFileName( relativePath );
 
+	// the file index lists the paks holding the file in search order
+	indexed = -1;
+	if ( fileIndexValid && ( searchFlags & FSFLAG_SEARCH_PAKS ) ) {
+		indexed = FindIndexedFile( relativePath );
+	}
+
 	for ( search = searchPaths; search; search = search->next ) {
 		if ( search->dir && ( searchFlags & FSFLAG_SEARCH_DIRS ) ) {
 			// check a file in the directory tree
@@ -3140,43 +4898,57 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 			return file;
 		} else if ( search->pack && ( searchFlags & FSFLAG_SEARCH_PAKS ) ) {
 
-			if ( !search->pack->hashTable[hash] ) {
-				continue;
+			pak = search->pack;
+			if ( fileIndexValid ) {
+				if ( indexed == -1 || fileIndex[indexed].pack != pak ) {
+					continue;
+				}
+				pakFile = fileIndex[indexed].file;
+				indexed = fileIndex[indexed].next;
+			} else {
+				// look through all the pak file elements
+				for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
+					// case and separator insensitive comparisons
+					if ( !FilenameCompare( pakFile->name, relativePath ) ) {
+						break;
+					}
+				}
+				if ( !pakFile ) {
+					continue;
+				}
 			}
 
 			// disregard if it doesn't match one of the allowed pure pak files
 			if ( serverPaks.Num() ) {
-				GetPackStatus( search->pack );
-				if ( search->pack->pureStatus != PURE_NEVER && !serverPaks.Find( search->pack ) ) {
+				GetPackStatus( pak );
+				if ( pak->pureStatus != PURE_NEVER && !serverPaks.Find( pak ) ) {
 					continue; // not on the pure server pak list
 				}
 			}
 
-			// look through all the pak file elements
-			pak = search->pack;
-			for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
-				// case and separator insensitive comparisons
-				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
-
-					if ( foundInPak ) {
-						*foundInPak = pak;
-					}
+			idFile *file = NULL;
+			if ( foundPakFile ) {
+				*foundPakFile = pakFile;
+			} else {
+				file = ReadFileFromZip( pak, pakFile, relativePath );
+			}
 
-					if ( !pak->referenced && !( searchFlags & FSFLAG_PURE_NOREF ) ) {
-						// mark this pak referenced
-						if ( fs_debug.GetInteger( ) ) {
-							common->Printf( "idFileSystem::OpenFileRead: %s -> adding %s to referenced paks\n", relativePath, pak->pakFilename.c_str() );
-						}
-						pak->referenced = true;
-					}
+			if ( foundInPak ) {
+				*foundInPak = pak;
+			}
 
-					if ( fs_debug.GetInteger( ) ) {
-						common->Printf( "idFileSystem::OpenFileRead: %s (found in '%s')\n", relativePath, pak->pakFilename.c_str() );
-					}
-					return file;
+			if ( !pak->referenced && !( searchFlags & FSFLAG_PURE_NOREF ) ) {
+				// mark this pak referenced
+				if ( fs_debug.GetInteger( ) ) {
+					common->Printf( "idFileSystem::OpenFileRead: %s -> adding %s to referenced paks\n", relativePath, pak->pakFilename.c_str() );
 				}
+				pak->referenced = true;
 			}
+
+			if ( fs_debug.GetInteger( ) ) {
+				common->Printf( "idFileSystem::OpenFileRead: %s (found in '%s')\n", relativePath, pak->pakFilename.c_str() );
+			}
+			return file;
 		}
 	}
 
@@ -3187,7 +4959,12 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 			pak = search->pack;
 			for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
 				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+					idFile *file = NULL;
+					if ( foundPakFile ) {
+						*foundPakFile = pakFile;
+					} else {
+						file = ReadFileFromZip( pak, pakFile, relativePath );
+					}
 					if ( foundInPak ) {
 						*foundInPak = pak;
 					}
@@ -3637,7 +5414,7 @@ pack_t *idFileSystemLocal::FindPakForFileChecksum( const char *relativePath, int
 			pak = search->pack;
 			for ( pakFile = pak->hashTable[ hash ]; pakFile; pakFile = pakFile->next ) {
 				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+					idFile *file = ReadFileFromZip( pak, pakFile, relativePath );
 					if ( findChecksum == GetFileChecksum( file ) ) {
 						if ( fs_debug.GetBool() ) {
 							common->Printf( "found '%s' with checksum 0x%x in pak '%s'\n", relativePath, findChecksum, pak->pakFilename.c_str() );
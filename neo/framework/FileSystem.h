@@ -98,6 +98,17 @@ typedef enum {
 	FIND_ADDON
 } findFile_t;
 
+// order in which queued asynchronous reads are served
+typedef enum {
+	FS_READ_PRIORITY_LOW,		// prefetching
+	FS_READ_PRIORITY_NORMAL,
+	FS_READ_PRIORITY_HIGH,		// needed right away
+	FS_READ_PRIORITIES
+} fsReadPriority_t;
+
+// gets the file contents as ReadFile would, buffer is NULL and length -1 if the file couldn't be read
+typedef void (*fsReadCallback_t)( const char *relativePath, void *buffer, int length, void *data );
+
 typedef struct urlDownload_s {
 	idStr				url;
 	char				dlerror[ MAX_STRING_CHARS ];
@@ -218,8 +229,28 @@ public:
 							// A 0 byte will always be appended at the end, so string ops are safe.
 							// The buffer should be considered read-only, because it may be cached for other uses.
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
+							// Reads several complete files, the buffers, lengths and optional timestamps are set as ReadFile would.
+							// Large compressed files in pk4s are inflated in parallel on the job workers.
+							// Every buffer has to be freed with FreeFile.
+	virtual void			ReadFiles( int numFiles, const char * const *relativePaths, void **buffers, int *lengths, ID_TIME_T *timestamps = NULL ) = 0;
 							// Frees the memory allocated by ReadFile.
 	virtual void			FreeFile( void *buffer ) = 0;
+							// Queues a read on the I/O threads and returns a handle for it. The file is looked up right away,
+							// the data is read in the background. With a callback the result is handed to it from ServiceReads,
+							// otherwise it is fetched with WaitRead. Buffers are freed with FreeFile.
+	virtual int				ReadFileAsync( const char *relativePath, fsReadPriority_t priority = FS_READ_PRIORITY_NORMAL, fsReadCallback_t callback = NULL, void *data = NULL ) = 0;
+							// True once the read finished, successfully or not.
+	virtual bool			IsReadDone( int handle ) = 0;
+							// Blocks until a read without callback is done, returns the length and buffer like ReadFile and releases the handle.
+	virtual int				WaitRead( int handle, void **buffer ) = 0;
+							// Drops a queued or running read, its callback won't be called. Releases the handle.
+	virtual void			CancelRead( int handle ) = 0;
+							// Calls the callbacks of finished reads, done once a frame.
+	virtual void			ServiceReads( void ) = 0;
+							// Pulls the files a map read the last time it was loaded into the OS page cache.
+	virtual void			PrefetchMap( const char *mapName ) = 0;
+							// Adds the files read since ResetReadCount to the prefetch list of the map.
+	virtual void			WritePrefetchList( const char *mapName ) = 0;
 							// Writes a complete file, will create any needed subdirectories.
 							// Returns the length of the file, or -1 on failure.
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_savepath" ) = 0;
@@ -42,6 +42,7 @@ class idRenderModelManager;
 class idUserInterface;
 class idUserInterfaceManager;
 class idNetworkSystem;
+class idProfiler;
 class LoadingContext;
 
 /*
@@ -374,7 +375,7 @@ extern idGameEdit *				gameEdit;
 ===============================================================================
 */
 
-const int GAME_API_VERSION		= 8;
+const int GAME_API_VERSION		= 10;
 
 typedef struct {
 
@@ -392,6 +393,8 @@ typedef struct {
 	idDeclManager *				declManager;			// declaration manager
 	idAASFileManager *			AASFileManager;			// AAS file manager
 	idCollisionModelManager *	collisionModelManager;	// collision model manager
+	idJobSystem *				jobSystem;				// job system
+	idProfiler *				profiler;				// cpu profiler
 
 } gameImport_t;
 
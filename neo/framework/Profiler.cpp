@@ -0,0 +1,410 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include <atomic>
+#include <mutex>
+
+#include "sys/platform.h"
+#include "framework/Common.h"
+#include "framework/CmdSystem.h"
+#include "framework/CVarSystem.h"
+#include "framework/FileSystem.h"
+
+#include "framework/Profiler.h"
+
+idCVar com_profile( "com_profile", "0", CVAR_BOOL | CVAR_SYSTEM, "record the profiler markers of all threads, see profileDump" );
+idCVar com_profileEvents( "com_profileEvents", "65536", CVAR_INTEGER | CVAR_SYSTEM | CVAR_INIT, "number of profiler events kept per thread", 1024, 1 << 24 );
+
+#define MAX_PROFILE_THREADS			( MAX_THREADS + 8 )		// the main thread and threads not created by Sys_CreateThread
+#define MAX_PROFILE_FRAMES			256
+#define DEFAULT_PROFILE_FRAMES		10
+
+typedef struct {
+	const char *			name;
+	uint64					start;
+	uint64					end;
+} profileEvent_t;
+
+typedef struct {
+	int						frameNum;
+	uint64					start;
+} profileFrame_t;
+
+/*
+==============================================================
+
+	Per thread ring buffer. Only the owning thread writes, readers
+	copy the ring and throw away what was overwritten meanwhile.
+
+==============================================================
+*/
+
+typedef struct {
+	char					name[32];
+	int						numEvents;				// power of two
+	profileEvent_t *		events;
+	std::atomic<uint64>		written;				// events ever recorded, the ring holds the last numEvents
+} profileThread_t;
+
+class idProfilerLocal : public idProfiler {
+public:
+							idProfilerLocal( void );
+
+	virtual void			Init( void );
+	virtual void			Shutdown( void );
+	virtual void			BeginFrame( int frameNum );
+	virtual void			AddEvent( const char *name, uint64 start, uint64 end );
+	virtual bool			WriteTrace( const char *fileName, int numFrames );
+
+	static void				ProfileDump_f( const idCmdArgs &args );
+	static void				ProfileCapture_f( const idCmdArgs &args );
+
+private:
+	profileThread_t *		threads[MAX_PROFILE_THREADS];
+	int						numThreads;
+	std::mutex				threadLock;
+
+	profileFrame_t			frames[MAX_PROFILE_FRAMES];
+	int						numFrames;				// frames recorded since recording started
+	bool					restartFrames;
+
+	int						captureFrames;			// frames profileCapture still waits for
+	idStr					captureFileName;
+
+	profileThread_t *		RegisterThread( void );
+	void					ReadEvents( const profileThread_t *thread, idList<profileEvent_t> &events ) const;
+};
+
+static idProfilerLocal		profilerLocal;
+idProfiler *				profiler = &profilerLocal;
+
+// ring buffer of the calling thread, registered with the first event
+static thread_local profileThread_t *	profileThread = NULL;
+static thread_local bool				profileThreadFull = false;
+// Shutdown frees the ring buffers of all threads, a thread registers again once it sees a new generation
+static std::atomic<int>					profileGeneration;
+static thread_local int					profileThreadGeneration = 0;
+
+/*
+================
+idProfilerLocal::idProfilerLocal
+================
+*/
+idProfilerLocal::idProfilerLocal( void ) {
+	recording = false;
+	memset( threads, 0, sizeof( threads ) );
+	numThreads = 0;
+	memset( frames, 0, sizeof( frames ) );
+	numFrames = 0;
+	restartFrames = false;
+	captureFrames = 0;
+}
+
+/*
+================
+idProfilerLocal::Init
+================
+*/
+void idProfilerLocal::Init( void ) {
+	cmdSystem->AddCommand( "profileDump", ProfileDump_f, CMD_FL_SYSTEM, "writes the last recorded frames as Chrome trace JSON, usage: profileDump [frames, default 10] [file]" );
+	cmdSystem->AddCommand( "profileCapture", ProfileCapture_f, CMD_FL_SYSTEM, "records the next frames and writes them as Chrome trace JSON, usage: profileCapture [frames, default 10] [file]" );
+}
+
+/*
+================
+idProfilerLocal::Shutdown
+================
+*/
+void idProfilerLocal::Shutdown( void ) {
+	std::lock_guard<std::mutex> guard( threadLock );
+
+	recording = false;
+	for ( int i = 0; i < numThreads; i++ ) {
+		Mem_Free( threads[i]->events );
+		delete threads[i];
+		threads[i] = NULL;
+	}
+	numThreads = 0;
+	numFrames = 0;
+	captureFrames = 0;
+	// the other threads still point at the freed buffers
+	profileGeneration.fetch_add( 1, std::memory_order_release );
+}
+
+/*
+================
+idProfilerLocal::RegisterThread
+================
+*/
+profileThread_t *idProfilerLocal::RegisterThread( void ) {
+	profileThread_t *thread;
+
+	if ( profileThreadGeneration != profileGeneration.load( std::memory_order_acquire ) ) {
+		profileThread = NULL;
+		profileThreadFull = false;
+	}
+
+	if ( profileThreadFull ) {
+		return NULL;
+	}
+
+	std::lock_guard<std::mutex> guard( threadLock );
+
+	profileThreadGeneration = profileGeneration.load( std::memory_order_relaxed );
+
+	if ( numThreads >= MAX_PROFILE_THREADS ) {
+		profileThreadFull = true;
+		return NULL;
+	}
+
+	thread = new profileThread_t;
+	idStr::Copynz( thread->name, Sys_GetThreadName(), sizeof( thread->name ) );
+	thread->numEvents = idMath::CeilPowerOfTwo( com_profileEvents.GetInteger() );
+	thread->events = (profileEvent_t *) Mem_Alloc( thread->numEvents * sizeof( profileEvent_t ) );
+	thread->written = 0;
+
+	threads[numThreads++] = thread;
+	profileThread = thread;
+	return thread;
+}
+
+/*
+================
+idProfilerLocal::BeginFrame
+================
+*/
+void idProfilerLocal::BeginFrame( int frameNum ) {
+	bool wasRecording = recording;
+
+	recording = com_profile.GetBool() || captureFrames > 0;
+	if ( !recording ) {
+		return;
+	}
+
+	// the frame list only covers the current recording
+	if ( !wasRecording || restartFrames ) {
+		numFrames = 0;
+		restartFrames = false;
+	}
+
+	profileFrame_t &frame = frames[numFrames % MAX_PROFILE_FRAMES];
+	frame.frameNum = frameNum;
+	frame.start = Sys_GetPerformanceCounter();
+	numFrames++;
+
+	// the start of this frame ends the last captured one
+	if ( captureFrames > 0 && numFrames > captureFrames ) {
+		WriteTrace( captureFileName, captureFrames );
+		captureFrames = 0;
+		recording = com_profile.GetBool();
+	}
+}
+
+/*
+================
+idProfilerLocal::AddEvent
+================
+*/
+void idProfilerLocal::AddEvent( const char *name, uint64 start, uint64 end ) {
+	profileThread_t *thread = profileThread;
+
+	if ( !thread || profileThreadGeneration != profileGeneration.load( std::memory_order_acquire ) ) {
+		thread = RegisterThread();
+		if ( !thread ) {
+			return;
+		}
+	}
+
+	uint64 index = thread->written.load( std::memory_order_relaxed );
+	profileEvent_t &event = thread->events[index & ( thread->numEvents - 1 )];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+	thread->written.store( index + 1, std::memory_order_release );
+}
+
+/*
+================
+idProfilerLocal::ReadEvents
+
+  copies the ring buffer of a thread that may still be recording
+================
+*/
+void idProfilerLocal::ReadEvents( const profileThread_t *thread, idList<profileEvent_t> &events ) const {
+	uint64 written, first, valid, i;
+
+	written = thread->written.load( std::memory_order_acquire );
+	first = ( written > (uint64)thread->numEvents ) ? written - thread->numEvents : 0;
+
+	events.SetNum( (int)( written - first ), false );
+	for ( i = first; i < written; i++ ) {
+		events[(int)( i - first )] = thread->events[i & ( thread->numEvents - 1 )];
+	}
+
+	// drop the events the thread overwrote while they were copied, the slot of event
+	// written is shared with event written - numEvents and may be half written already
+	written = thread->written.load( std::memory_order_acquire );
+	valid = ( written + 1 > (uint64)thread->numEvents ) ? written + 1 - thread->numEvents : 0;
+	if ( valid > first ) {
+		int numDropped = (int)Min( valid - first, (uint64)events.Num() );
+		memmove( events.Ptr(), events.Ptr() + numDropped, ( events.Num() - numDropped ) * sizeof( profileEvent_t ) );
+		events.SetNum( events.Num() - numDropped, false );
+	}
+}
+
+/*
+================
+idProfilerLocal::WriteTrace
+================
+*/
+bool idProfilerLocal::WriteTrace( const char *fileName, int numFrames ) {
+	int i, j, first, last, numWritten, numComplete;
+	uint64 windowStart, windowEnd, start, end;
+	const char *separator;
+	idList<profileEvent_t> events;
+	idFile *f;
+
+	// the frame that is running has not ended yet
+	numComplete = Min( this->numFrames, MAX_PROFILE_FRAMES ) - 1;
+	if ( numComplete <= 0 ) {
+		common->Printf( "no frames recorded, set com_profile 1 or use profileCapture\n" );
+		return false;
+	}
+	numFrames = idMath::ClampInt( 1, numComplete, numFrames );
+
+	last = this->numFrames - 1;
+	first = last - numFrames;
+	windowStart = frames[first % MAX_PROFILE_FRAMES].start;
+	windowEnd = frames[last % MAX_PROFILE_FRAMES].start;
+
+	f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		common->Warning( "couldn't open %s", fileName );
+		return false;
+	}
+
+	f->Printf( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+
+	std::lock_guard<std::mutex> guard( threadLock );
+
+	// thread names, the frames get a row of their own
+	separator = "";
+	for ( i = 0; i < numThreads; i++ ) {
+		f->Printf( "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", separator, i, threads[i]->name );
+		separator = ",\n";
+	}
+	f->Printf( "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"frames\"}}", separator, MAX_PROFILE_THREADS );
+	separator = ",\n";
+
+	for ( i = first; i < last; i++ ) {
+		start = frames[i % MAX_PROFILE_FRAMES].start;
+		end = frames[( i + 1 ) % MAX_PROFILE_FRAMES].start;
+		f->Printf( "%s{\"name\":\"frame %d\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", separator,
+					frames[i % MAX_PROFILE_FRAMES].frameNum, MAX_PROFILE_THREADS,
+					Sys_GetPerformanceTimeMS( start - windowStart ) * 1000.0, Sys_GetPerformanceTimeMS( end - start ) * 1000.0 );
+	}
+
+	numWritten = 0;
+	for ( i = 0; i < numThreads; i++ ) {
+		ReadEvents( threads[i], events );
+
+		for ( j = 0; j < events.Num(); j++ ) {
+			const profileEvent_t &event = events[j];
+			if ( event.end <= windowStart || event.start >= windowEnd ) {
+				continue;
+			}
+			// cut the scopes that reach outside the frames
+			start = Max( event.start, windowStart );
+			end = Min( event.end, windowEnd );
+			f->Printf( "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", separator,
+						event.name, i, Sys_GetPerformanceTimeMS( start - windowStart ) * 1000.0, Sys_GetPerformanceTimeMS( end - start ) * 1000.0 );
+			numWritten++;
+		}
+	}
+
+	f->Printf( "\n]}\n" );
+
+	common->Printf( "wrote %d events of %d threads over %d frames (%.2f ms) to %s\n", numWritten, numThreads, numFrames,
+					Sys_GetPerformanceTimeMS( windowEnd - windowStart ), f->GetFullPath() );
+
+	fileSystem->CloseFile( f );
+	return true;
+}
+
+/*
+================
+idProfilerLocal::ProfileDump_f
+================
+*/
+void idProfilerLocal::ProfileDump_f( const idCmdArgs &args ) {
+	int numFrames;
+	idStr fileName;
+
+	if ( args.Argc() > 3 ) {
+		common->Printf( "usage: profileDump [frames, default %d] [file]\n", DEFAULT_PROFILE_FRAMES );
+		return;
+	}
+
+	numFrames = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : DEFAULT_PROFILE_FRAMES;
+	if ( args.Argc() > 2 ) {
+		fileName = args.Argv( 2 );
+	} else {
+		fileName = va( "profile/trace_%d.json", idLib::frameNumber );
+	}
+	fileName.DefaultFileExtension( ".json" );
+
+	profilerLocal.WriteTrace( fileName, numFrames );
+}
+
+/*
+================
+idProfilerLocal::ProfileCapture_f
+================
+*/
+void idProfilerLocal::ProfileCapture_f( const idCmdArgs &args ) {
+	int numFrames;
+
+	if ( args.Argc() > 3 ) {
+		common->Printf( "usage: profileCapture [frames, default %d] [file]\n", DEFAULT_PROFILE_FRAMES );
+		return;
+	}
+
+	numFrames = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : DEFAULT_PROFILE_FRAMES;
+	profilerLocal.captureFrames = idMath::ClampInt( 1, MAX_PROFILE_FRAMES - 1, numFrames );
+	if ( args.Argc() > 2 ) {
+		profilerLocal.captureFileName = args.Argv( 2 );
+	} else {
+		profilerLocal.captureFileName = va( "profile/capture_%d.json", idLib::frameNumber );
+	}
+	profilerLocal.captureFileName.DefaultFileExtension( ".json" );
+
+	// start counting with the next frame
+	profilerLocal.restartFrames = true;
+
+	common->Printf( "capturing %d frames to %s\n", profilerLocal.captureFrames, profilerLocal.captureFileName.c_str() );
+}
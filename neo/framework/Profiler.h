@@ -0,0 +1,101 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include "sys/sys_public.h"
+
+/*
+===============================================================================
+
+	CPU profiler
+
+	PROFILE_SCOPE markers time the enclosing block on whatever thread runs
+	it. Scopes nest, every thread records into its own ring buffer and the
+	main loop marks the start of each frame. Nothing is recorded unless
+	com_profile is set, a marker then costs a load and a branch.
+
+	"profileDump" writes the last frames as Chrome trace JSON, which can be
+	opened in chrome://tracing or ui.perfetto.dev. "profileCapture" records
+	a number of frames and writes them, which also works on a dedicated
+	server without a console.
+
+===============================================================================
+*/
+
+class idProfiler {
+public:
+	virtual					~idProfiler( void ) {}
+
+	virtual void			Init( void ) = 0;
+	virtual void			Shutdown( void ) = 0;
+
+	// called by the main loop before anything else runs in the frame
+	virtual void			BeginFrame( int frameNum ) = 0;
+
+	// name must be a static string, times are Sys_GetPerformanceCounter values
+	virtual void			AddEvent( const char *name, uint64 start, uint64 end ) = 0;
+
+	// writes the last numFrames complete frames, returns false if nothing was recorded
+	virtual bool			WriteTrace( const char *fileName, int numFrames ) = 0;
+
+	bool					IsRecording( void ) const { return recording; }
+
+protected:
+	volatile bool			recording;
+};
+
+extern idProfiler *			profiler;
+
+class idProfileScope {
+public:
+	idProfileScope( const char *name ) {
+		if ( profiler->IsRecording() ) {
+			this->name = name;
+			start = Sys_GetPerformanceCounter();
+		} else {
+			this->name = NULL;
+		}
+	}
+	~idProfileScope( void ) {
+		if ( name ) {
+			profiler->AddEvent( name, start, Sys_GetPerformanceCounter() );
+		}
+	}
+
+private:
+	const char *			name;
+	uint64					start;
+};
+
+#define PROFILE_SCOPE_NAME2( line )		profileScope##line
+#define PROFILE_SCOPE_NAME( line )		PROFILE_SCOPE_NAME2( line )
+#define PROFILE_SCOPE( name )			idProfileScope PROFILE_SCOPE_NAME( __LINE__ )( name )
+
+#endif /* !__PROFILER_H__ */
@@ -0,0 +1,267 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "sys/platform.h"
+#include "idlib/Lib.h"
+#include "framework/FileSystem.h"
+#include "framework/Common.h"
+#include "framework/CVarSystem.h"
+#include "framework/miniz/miniz.h"
+
+#include "framework/SaveGameWriter.h"
+
+idCVar com_saveCompression( "com_saveCompression", "1", CVAR_SYSTEM | CVAR_INTEGER | CVAR_ARCHIVE, "deflate level used for savegames, 0 writes uncompressed savegames", 0, 9 );
+idCVar com_saveAsync( "com_saveAsync", "1", CVAR_SYSTEM | CVAR_BOOL | CVAR_ARCHIVE, "compress and write savegames on a job worker" );
+
+static const int SAVEGAME_SNAPSHOT_GRANULARITY = 1024 * 1024;
+
+/*
+================
+idSaveGameWriter::idSaveGameWriter
+================
+*/
+idSaveGameWriter::idSaveGameWriter( void ) {
+	outFile = NULL;
+	jobList = NULL;
+	compressionLevel = 0;
+	pending = false;
+	failed = false;
+	beginTime = 0;
+	memset( &stats, 0, sizeof( stats ) );
+}
+
+/*
+================
+idSaveGameWriter::Init
+================
+*/
+void idSaveGameWriter::Init( void ) {
+	if ( jobList == NULL ) {
+		jobList = jobSystem->AllocJobList( "saveGameWrite" );
+	}
+}
+
+/*
+================
+idSaveGameWriter::Shutdown
+================
+*/
+void idSaveGameWriter::Shutdown( void ) {
+	FinishWrite();
+	if ( jobList != NULL ) {
+		jobSystem->FreeJobList( jobList );
+		jobList = NULL;
+	}
+	snapshot.Clear();
+	compressed.Clear();
+}
+
+/*
+================
+idSaveGameWriter::BeginSave
+================
+*/
+idFile *idSaveGameWriter::BeginSave( const char *fileName ) {
+	beginTime = Sys_GetPerformanceCounter();
+
+	FinishWrite();
+
+	uint64 waitEnd = Sys_GetPerformanceCounter();
+
+	outFile = fileSystem->OpenFileWrite( fileName );
+	if ( outFile == NULL ) {
+		return NULL;
+	}
+
+	memset( &stats, 0, sizeof( stats ) );
+	stats.waitMS = Sys_GetPerformanceTimeMS( waitEnd - beginTime );
+
+	// keep the memory of the previous snapshot around
+	snapshot.Clear( false );
+	snapshot.SetGranularity( SAVEGAME_SNAPSHOT_GRANULARITY );
+
+	return &snapshot;
+}
+
+/*
+================
+idSaveGameWriter::EndSave
+================
+*/
+void idSaveGameWriter::EndSave( void ) {
+	uint64 snapshotEnd = Sys_GetPerformanceCounter();
+
+	assert( outFile != NULL && !pending );
+
+	stats.rawSize = snapshot.Length();
+	stats.snapshotMS = Sys_GetPerformanceTimeMS( snapshotEnd - beginTime ) - stats.waitMS;
+
+	compressionLevel = com_saveCompression.GetInteger();
+	if ( compressionLevel > 0 ) {
+		// the worker must not allocate from the engine heap
+		compressed.SetNum( (int)mz_compressBound( stats.rawSize ), false );
+	}
+
+	pending = true;
+	failed = false;
+
+	if ( com_saveAsync.GetBool() && jobSystem->GetNumWorkers() > 0 ) {
+		jobList->Clear();
+		jobList->AddJob( WriteJob, this, "saveGameWrite" );
+		jobList->Submit();
+	} else {
+		WriteJob( this );
+	}
+
+	stats.stallMS = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - beginTime );
+}
+
+/*
+================
+idSaveGameWriter::IsWriting
+================
+*/
+bool idSaveGameWriter::IsWriting( void ) const {
+	return pending && jobList->NumJobs() > 0 && !jobList->IsDone();
+}
+
+/*
+================
+idSaveGameWriter::FinishWrite
+================
+*/
+bool idSaveGameWriter::FinishWrite( void ) {
+	if ( !pending ) {
+		return false;
+	}
+
+	if ( jobList->NumJobs() > 0 ) {
+		jobList->Wait();
+		jobList->Clear();
+	}
+
+	if ( failed ) {
+		common->Warning( "Failed to write save file '%s'\n", outFile->GetName() );
+	}
+
+	fileSystem->CloseFile( outFile );
+	outFile = NULL;
+	pending = false;
+
+	return !failed;
+}
+
+/*
+================
+idSaveGameWriter::WriteJob
+
+runs on a job worker, only touches the snapshot, the preallocated output buffer and the open file
+================
+*/
+void idSaveGameWriter::WriteJob( void *data ) {
+	idSaveGameWriter *writer = static_cast<idSaveGameWriter *>( data );
+	const byte *buffer = (const byte *)writer->snapshot.GetDataPtr();
+	int length = writer->stats.rawSize;
+
+	uint64 start = Sys_GetPerformanceCounter();
+
+	if ( writer->compressionLevel > 0 ) {
+		mz_ulong compressedLength = writer->compressed.Num();
+		if ( mz_compress2( writer->compressed.Ptr(), &compressedLength, buffer, length, writer->compressionLevel ) != MZ_OK ) {
+			writer->failed = true;
+			return;
+		}
+
+		writer->outFile->WriteInt( SAVEGAME_COMPRESSED_MAGIC );
+		writer->outFile->WriteInt( length );
+		writer->outFile->WriteInt( (int)compressedLength );
+
+		buffer = writer->compressed.Ptr();
+		length = (int)compressedLength;
+	}
+
+	uint64 compressEnd = Sys_GetPerformanceCounter();
+
+	if ( writer->outFile->Write( buffer, length ) != length ) {
+		writer->failed = true;
+	}
+	writer->outFile->Flush();
+
+	writer->stats.fileSize = writer->outFile->Tell();
+	writer->stats.compressMS = Sys_GetPerformanceTimeMS( compressEnd - start );
+	writer->stats.writeMS = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - compressEnd );
+}
+
+/*
+================
+idSaveGameWriter::OpenForRead
+================
+*/
+idFile *idSaveGameWriter::OpenForRead( idFile *file ) {
+	int magic = 0;
+
+	file->ReadInt( magic );
+	if ( magic != SAVEGAME_COMPRESSED_MAGIC ) {
+		file->Seek( 0, FS_SEEK_SET );
+		return file;
+	}
+
+	int rawLength = 0, compressedLength = 0;
+	file->ReadInt( rawLength );
+	file->ReadInt( compressedLength );
+	if ( rawLength < 0 || compressedLength <= 0 || compressedLength > file->Length() - file->Tell() ) {
+		common->Warning( "Corrupt compressed savegame '%s'\n", file->GetName() );
+		fileSystem->CloseFile( file );
+		return NULL;
+	}
+
+	byte *compressedData = (byte *)Mem_Alloc( compressedLength );
+	file->Read( compressedData, compressedLength );
+
+	char *rawData = (char *)Mem_Alloc( Max( rawLength, 1 ) );
+	mz_ulong inflatedLength = rawLength;
+	int result = mz_uncompress( (byte *)rawData, &inflatedLength, compressedData, compressedLength );
+	Mem_Free( compressedData );
+
+	idFile_Memory *memFile = new idFile_Memory( file->GetName() );
+	fileSystem->CloseFile( file );
+
+	if ( result != MZ_OK || (int)inflatedLength != rawLength ) {
+		common->Warning( "Failed to decompress savegame '%s'\n", memFile->GetName() );
+		Mem_Free( rawData );
+		delete memFile;
+		return NULL;
+	}
+
+	memFile->SetGranularity( Max( rawLength, 1 ) );
+	memFile->Write( rawData, rawLength );
+	memFile->MakeReadOnly();
+	Mem_Free( rawData );
+
+	return memFile;
+}
@@ -0,0 +1,101 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __SAVEGAMEWRITER_H__
+#define __SAVEGAMEWRITER_H__
+
+#include "idlib/containers/List.h"
+#include "framework/File.h"
+
+/*
+===============================================================================
+
+	idSaveGameWriter lets the game snapshot its state into a memory file and
+	then compresses and writes the snapshot to disk on a job worker, so the
+	main thread only pays for the snapshot itself.
+
+	Compressed savegames start with SAVEGAME_COMPRESSED_MAGIC followed by the
+	uncompressed and compressed size. Uncompressed savegames start with the
+	game name string, so both formats can be told apart by the first int.
+
+===============================================================================
+*/
+
+const int SAVEGAME_COMPRESSED_MAGIC		= ( 'S' << 24 ) | ( 'G' << 16 ) | ( 'Z' << 8 ) | '1';
+
+typedef struct saveGameStats_s {
+	int						rawSize;		// size of the snapshot
+	int						fileSize;		// size written to disk
+	double					waitMS;			// main thread time spent waiting for the previous write
+	double					snapshotMS;		// main thread time spent writing the snapshot
+	double					stallMS;		// total main thread time from BeginSave to the end of EndSave
+	double					compressMS;		// background time spent compressing
+	double					writeMS;		// background time spent writing to disk
+} saveGameStats_t;
+
+class idJobList;
+
+class idSaveGameWriter {
+public:
+							idSaveGameWriter( void );
+
+	void					Init( void );
+	void					Shutdown( void );
+
+							// waits for the previous write, opens the file and returns the memory file to write the snapshot into
+	idFile *				BeginSave( const char *fileName );
+							// hands the snapshot to the background write
+	void					EndSave( void );
+							// true from EndSave until FinishWrite
+	bool					IsPending( void ) const { return pending; }
+							// true while the background write is running
+	bool					IsWriting( void ) const;
+							// blocks until the pending write is done, returns true if it succeeded
+	bool					FinishWrite( void );
+
+	const saveGameStats_t &	GetStats( void ) const { return stats; }
+
+							// returns a file the savegame can be read from, compressed savegames are inflated into memory
+							// the passed in file is closed if a new file is returned
+	static idFile *			OpenForRead( idFile *file );
+
+private:
+	idFile_Memory			snapshot;
+	idFile *				outFile;
+	idList<byte>			compressed;
+	idJobList *				jobList;
+	int						compressionLevel;
+	bool					pending;
+	bool					failed;
+	uint64					beginTime;
+	saveGameStats_t			stats;
+
+	static void				WriteJob( void *data );
+};
+
+#endif /* !__SAVEGAMEWRITER_H__ */
@@ -518,6 +518,9 @@ void idSessionLocal::Shutdown() {
 		timeDemo = TD_YES_THEN_QUIT;
 	}
 
+	FinishPendingSave();
+	saveWriter.Shutdown();
+
 	Stop();
 
 	if ( rw ) {
@@ -1926,6 +1929,11 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 	fullMapName += mapString;
 	fullMapName.StripFileExtension();
 
+	// start reading what the new map needed last time while the old one is torn down
+	if ( fullMapName != currentMapName ) {
+		fileSystem->PrefetchMap( fullMapName );
+	}
+
 	// shut down the existing game if it is running
 	UnloadMap();
 
@@ -1989,6 +1997,9 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 	common->Printf( "----- Map Initialization -----\n" );
 	common->Printf( "Map: %s\n", mapString.c_str() );
 
+	// the collision models are read while the render world and the map file load
+	collisionModelManager->PreloadMap( fullMapName );
+
 	// let the renderSystem load all the geometry
 	if ( !rw->InitFromMap( fullMapName ) ) {
 
@@ -2046,6 +2057,7 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 		soundSystem->EndLevelLoad( mapString.c_str() );
 		declManager->EndLevelLoad();
 		SetBytesNeededForMapLoad( mapString.c_str(), fileSystem->GetReadCount() );
+		fileSystem->WritePrefetchList( fullMapName );
 	}
 	uiManager->EndLevelLoad();
 
@@ -2153,6 +2165,16 @@ void SaveGame_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+===============
+SaveGameBench_f
+===============
+*/
+void SaveGameBench_f( const idCmdArgs &args ) {
+	int count = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 5;
+	sessLocal.SaveGameBenchmark( Max( count, 1 ) );
+}
+
 /*
 ===============
 TakeViewNotes_f
@@ -2288,7 +2310,6 @@ bool idSessionLocal::SaveGame( const char *saveName, bool autosave ) {
 	common->Printf( "Dedicated servers cannot save games.\n" );
 	return false;
 #else
-	int i;
 	idStr gameFile, previewFile, descriptionFile, mapName;
 
 	// Don't autosave in end game except for vig_hub
@@ -2319,6 +2340,9 @@ bool idSessionLocal::SaveGame( const char *saveName, bool autosave ) {
 		return false;
 	}
 
+	// the previous save may still be writing to the files that get backed up below
+	FinishPendingSave();
+
 	idSoundWorld *pauseWorld = soundSystem->GetPlayingSoundWorld();
 	if ( pauseWorld ) {
 		pauseWorld->Pause();
@@ -2421,9 +2445,8 @@ bool idSessionLocal::SaveGame( const char *saveName, bool autosave ) {
 	}
 #endif
 
-	// Open savegame file
-	idFile *fileOut = fileSystem->OpenFileWrite( gameFile );
-	if ( fileOut == NULL ) {
+	// Write the savegame, the save writer finishes it in the background
+	if ( !WriteSaveGameFile( gameFile ) ) {
 		common->Warning( "Failed to open save file '%s'\n", gameFile.c_str() );
 		if ( pauseWorld ) {
 			soundSystem->SetPlayingSoundWorld( pauseWorld );
@@ -2432,31 +2455,7 @@ bool idSessionLocal::SaveGame( const char *saveName, bool autosave ) {
 		return false;
 	}
 
-	// Write SaveGame Header:
-	// Game Name / Version / Map Name / Persistant Player Info
-
-	// game
-	const char *gamename = GAME_NAME;
-	fileOut->WriteString( gamename );
-
-	// version
-	fileOut->WriteInt( SAVEGAME_VERSION );
-
-	// map
 	mapName = mapSpawnData.serverInfo.GetString( "si_map" );
-	fileOut->WriteString( mapName );
-
-	// persistent player info
-	for ( i = 0; i < MAX_ASYNC_CLIENTS; i++ ) {
-		mapSpawnData.persistentPlayerInfo[i] = game->GetPersistentPlayerInfo( i );
-		mapSpawnData.persistentPlayerInfo[i].WriteToFileHandle( fileOut );
-	}
-
-	// let the game save its state
-	game->SaveGame( fileOut );
-
-	// close the sava game file
-	fileSystem->CloseFile( fileOut );
 
 	//BC 4-2-2025: removed functionality for saving TGA file, as we're not using this TGA file anywhere.
 	// Write screenshot
@@ -2525,9 +2524,11 @@ bool idSessionLocal::SaveGame( const char *saveName, bool autosave ) {
 
 	fileSystem->CloseFile( fileDesc );
 
-	if (common->g_SteamUtilities)
-	{
-		common->g_SteamUtilities->SteamCloudSave(gameFile.c_str(), descriptionFile.c_str());
+	// the cloud sync happens once the savegame is on disk
+	pendingSaveFile = gameFile;
+	pendingSaveDescFile = descriptionFile;
+	if ( !saveWriter.IsWriting() ) {
+		FinishPendingSave();
 	}
 
 	if ( pauseWorld ) {
@@ -2543,6 +2544,133 @@ bool idSessionLocal::SaveGame( const char *saveName, bool autosave ) {
 #endif
 }
 
+/*
+===============
+idSessionLocal::WriteSaveGameFile
+===============
+*/
+bool idSessionLocal::WriteSaveGameFile( const char *gameFile ) {
+	idFile *fileOut = saveWriter.BeginSave( gameFile );
+	if ( fileOut == NULL ) {
+		return false;
+	}
+
+	// Write SaveGame Header:
+	// Game Name / Version / Map Name / Persistant Player Info
+
+	// game
+	const char *gamename = GAME_NAME;
+	fileOut->WriteString( gamename );
+
+	// version
+	fileOut->WriteInt( SAVEGAME_VERSION );
+
+	// map
+	fileOut->WriteString( mapSpawnData.serverInfo.GetString( "si_map" ) );
+
+	// persistent player info
+	for ( int i = 0; i < MAX_ASYNC_CLIENTS; i++ ) {
+		mapSpawnData.persistentPlayerInfo[i] = game->GetPersistentPlayerInfo( i );
+		mapSpawnData.persistentPlayerInfo[i].WriteToFileHandle( fileOut );
+	}
+
+	// let the game save its state
+	game->SaveGame( fileOut );
+
+	saveWriter.EndSave();
+
+	return true;
+}
+
+/*
+===============
+idSessionLocal::FinishPendingSave
+===============
+*/
+void idSessionLocal::FinishPendingSave( void ) {
+	if ( !saveWriter.IsPending() ) {
+		return;
+	}
+
+	if ( saveWriter.FinishWrite() && pendingSaveFile.Length() && common->g_SteamUtilities ) {
+		common->g_SteamUtilities->SteamCloudSave( pendingSaveFile.c_str(), pendingSaveDescFile.c_str() );
+	}
+	pendingSaveFile.Clear();
+	pendingSaveDescFile.Clear();
+
+	const saveGameStats_t &stats = saveWriter.GetStats();
+	common->DPrintf( "savegame: %d KB -> %d KB, %.2f ms stall, %.2f ms compress, %.2f ms write\n",
+		stats.rawSize >> 10, stats.fileSize >> 10, stats.stallMS, stats.compressMS, stats.writeMS );
+}
+
+/*
+===============
+idSessionLocal::SaveGameBenchmark
+
+saves the current game with the old and the new save paths and reports the cost of each
+===============
+*/
+void idSessionLocal::SaveGameBenchmark( int count ) {
+	static const struct {
+		const char *	name;
+		bool			varInt;
+		int				compression;
+		bool			async;
+	} modes[] = {
+		{ "fixed, raw, sync",		false,	0,	false },
+		{ "varint, raw, sync",		true,	0,	false },
+		{ "varint, deflate, sync",	true,	1,	false },
+		{ "varint, deflate, async",	true,	1,	true },
+	};
+	const char *benchFile = "savegames/_savebench.save";
+
+	if ( !mapSpawned || IsMultiplayer() ) {
+		common->Printf( "saveGameBench needs a running single player game.\n" );
+		return;
+	}
+
+	FinishPendingSave();
+
+	bool oldVarInt = cvarSystem->GetCVarBool( "sg_varint" );
+	int oldCompression = cvarSystem->GetCVarInteger( "com_saveCompression" );
+	bool oldAsync = cvarSystem->GetCVarBool( "com_saveAsync" );
+
+	common->Printf( "saving %d times per mode\n", count );
+	common->Printf( "mode                      stall ms  snapshot ms  background ms     raw KB    file KB\n" );
+
+	for ( int m = 0; m < (int)( sizeof( modes ) / sizeof( modes[0] ) ); m++ ) {
+		cvarSystem->SetCVarBool( "sg_varint", modes[m].varInt );
+		cvarSystem->SetCVarInteger( "com_saveCompression", modes[m].compression );
+		cvarSystem->SetCVarBool( "com_saveAsync", modes[m].async );
+
+		double stall = 0.0, snapshot = 0.0, background = 0.0;
+		int rawSize = 0, fileSize = 0;
+		for ( int i = 0; i < count; i++ ) {
+			if ( !WriteSaveGameFile( benchFile ) ) {
+				common->Warning( "Failed to open save file '%s'\n", benchFile );
+				break;
+			}
+			saveWriter.FinishWrite();
+
+			const saveGameStats_t &stats = saveWriter.GetStats();
+			stall += stats.stallMS;
+			snapshot += stats.snapshotMS;
+			background += stats.compressMS + stats.writeMS;
+			rawSize = stats.rawSize;
+			fileSize = stats.fileSize;
+		}
+
+		common->Printf( "%-24s %9.2f %12.2f %14.2f %10d %10d\n", modes[m].name,
+			stall / count, snapshot / count, background / count, rawSize >> 10, fileSize >> 10 );
+	}
+
+	cvarSystem->SetCVarBool( "sg_varint", oldVarInt );
+	cvarSystem->SetCVarInteger( "com_saveCompression", oldCompression );
+	cvarSystem->SetCVarBool( "com_saveAsync", oldAsync );
+
+	fileSystem->RemoveFile( benchFile );
+}
+
 /*
 ===============
 idSessionLocal::LoadGame
@@ -2574,6 +2702,9 @@ bool idSessionLocal::LoadGame( const char *saveName ) {
 	in = "savegames/";
 	in += loadFile;
 
+	// the savegame may still be written in the background
+	FinishPendingSave();
+
 	// Open savegame file
 	// only allow loads from the game directory because we don't want a base game to load
 	idStr game = cvarSystem->GetCVarString( "fs_game" );
@@ -2584,6 +2715,12 @@ bool idSessionLocal::LoadGame( const char *saveName ) {
 		return false;
 	}
 
+	// compressed savegames are read from memory
+	savegameFile = idSaveGameWriter::OpenForRead( savegameFile );
+	if ( savegameFile == NULL ) {
+		return false;
+	}
+
 	loadingSaveGame = true;
 
 	// Read in save game header
@@ -3073,6 +3210,11 @@ void idSessionLocal::Frame() {
 		soundSystem->AsyncUpdate( Sys_Milliseconds() );
 	}
 
+	// finish the last savegame once its background write is done
+	if ( saveWriter.IsPending() && !saveWriter.IsWriting() ) {
+		FinishPendingSave();
+	}
+
 	if (gameLocal.requestPauseMenu)
 	{
 		gameLocal.requestPauseMenu = false;
@@ -3443,6 +3585,7 @@ void idSessionLocal::Init() {
 #ifndef	ID_DEDICATED
 	cmdSystem->AddCommand( "saveGame", SaveGame_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "quick saves a game" );
 	cmdSystem->AddCommand( "loadGame", LoadGame_f, CMD_FL_SYSTEM, "loads a game, quicksave by default", idCmdSystem::ArgCompletion_SaveGame );
+	cmdSystem->AddCommand( "saveGameBench", SaveGameBench_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "times saving the current game with each savegame mode, optional number of saves per mode" );
 
 
 	cmdSystem->AddCommand( "savegameauto", idSessionLocal::SaveGameAuto, CMD_FL_SYSTEM|CMD_FL_CHEAT, "default behavior for per map auto saves" );
@@ -3501,6 +3644,8 @@ void idSessionLocal::Init() {
 	guiActive = NULL;
 	guiHandle = NULL;
 
+	saveWriter.Init();
+
 	//ReadCDKey();
 }
 
@@ -35,6 +35,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "framework/UsercmdGen.h"
 #include "framework/KeyInput.h"
 #include "framework/DeclEntityDef.h"
+#include "framework/SaveGameWriter.h"
 #include "renderer/RenderSystem.h"
 #include "renderer/RenderWorld.h"
 #include "ui/ListGUI.h"
@@ -192,6 +193,11 @@ public:
 
 	bool				LoadGame(const char *saveName);
 	bool				SaveGame(const char *saveName, bool autosave = false);
+	// snapshots the game into the save writer, the file is written in the background
+	bool				WriteSaveGameFile( const char *gameFile );
+	// waits for a background save write and finishes it
+	void				FinishPendingSave( void );
+	void				SaveGameBenchmark( int count );
 
 	const char			*GetAuthMsg( void );
 
@@ -247,6 +253,10 @@ public:
 	idFile *			savegameFile;		// this is the savegame file to load from
 	int					savegameVersion;
 
+	idSaveGameWriter	saveWriter;
+	idStr				pendingSaveFile;	// written by saveWriter, for the cloud sync once it is done
+	idStr				pendingSaveDescFile;
+
 	idFile *			cmdDemoFile;		// if non-zero, we are reading commands from a file
 
 	int					latchedTicNumber;	// set to com_ticNumber each frame
@@ -766,6 +766,9 @@ bool idSessionLocal::HandleSaveGameMenuCommand( idCmdArgs &args, int &icmd ) {
 		int choice = guiActive->State().GetInt( "loadgame_sel_0" );
 		if ( choice >= 0 && choice < loadGameList.Num() )
 		{
+			// the background writer could still be writing this save
+			FinishPendingSave();
+
 			if (common->g_SteamUtilities)
 			{
 				idStr basegame = cvarSystem->GetCVarString("fs_game");
@@ -36,6 +36,160 @@ If you have questions concerning this license or the applicable additional terms
 idStrPool		idDict::globalKeys;
 idStrPool		idDict::globalValues;
 
+/*
+================
+idDictArgs::Find
+================
+*/
+int idDictArgs::Find( const char *key, int hash ) const {
+	int i, index;
+
+	if ( slots == NULL ) {
+		return -1;
+	}
+	for ( i = SlotForHash( hash, slotMask ); ( index = slots[i].index ) != -1; i = ( i + 1 ) & slotMask ) {
+		if ( slots[i].hash == hash && args[index].GetKey().Icmp( key ) == 0 ) {
+			return index;
+		}
+	}
+	return -1;
+}
+
+/*
+================
+idDictArgs::Add
+================
+*/
+void idDictArgs::Add( int hash, int index ) {
+	int i;
+
+	// keep at least half of the slots free so probe sequences stay short
+	if ( slots == NULL || args.Num() * 2 > slotMask + 1 ) {
+		Resize( idMath::CeilPowerOfTwo( Max( args.Num() * 2, 16 ) ) );
+	}
+	for ( i = SlotForHash( hash, slotMask ); slots[i].index != -1; i = ( i + 1 ) & slotMask ) {
+	}
+	slots[i].hash = hash;
+	slots[i].index = index;
+}
+
+/*
+================
+idDictArgs::Remove
+================
+*/
+void idDictArgs::Remove( int index ) {
+	Resize( slotMask + 1, index );
+}
+
+/*
+================
+idDictArgs::Resize
+================
+*/
+void idDictArgs::Resize( int numSlots, int removedIndex ) {
+	slot_t *	oldSlots = slots;
+	int			oldMask = slotMask;
+	int			i, j, index;
+
+	slots = new slot_t[numSlots];
+	slotMask = numSlots - 1;
+	for ( i = 0; i < numSlots; i++ ) {
+		slots[i].index = -1;
+	}
+
+	if ( oldSlots == NULL ) {
+		return;
+	}
+	for ( i = 0; i <= oldMask; i++ ) {
+		index = oldSlots[i].index;
+		if ( index == -1 || index == removedIndex ) {
+			continue;
+		}
+		if ( removedIndex != -1 && index > removedIndex ) {
+			index--;
+		}
+		for ( j = SlotForHash( oldSlots[i].hash, slotMask ); slots[j].index != -1; j = ( j + 1 ) & slotMask ) {
+		}
+		slots[j].hash = oldSlots[i].hash;
+		slots[j].index = index;
+	}
+	delete[] oldSlots;
+}
+
+/*
+================
+idDict::Unshare
+
+  allocates the key/value pairs or copies them if another dict uses them as well
+================
+*/
+void idDict::Unshare( void ) {
+	idDictArgs *copy;
+	int i;
+
+	if ( data != NULL && data->refCount == 1 ) {
+		return;
+	}
+
+	copy = new idDictArgs;
+	copy->keyPool = &globalKeys;
+	copy->valuePool = &globalValues;
+
+	if ( data != NULL ) {
+		copy->args = data->args;
+		for ( i = 0; i < copy->args.Num(); i++ ) {
+			copy->args[i].key = globalKeys.CopyString( copy->args[i].key );
+			copy->args[i].value = globalValues.CopyString( copy->args[i].value );
+		}
+		if ( data->slots != NULL ) {
+			copy->slots = new idDictArgs::slot_t[data->slotMask + 1];
+			copy->slotMask = data->slotMask;
+			memcpy( copy->slots, data->slots, ( data->slotMask + 1 ) * sizeof( copy->slots[0] ) );
+		}
+		// another dict can release its reference at the same time, so the last one out frees it
+		Release();
+	}
+
+	// assigning the list takes over the granularity of the shared one
+	copy->args.SetGranularity( granularity );
+	data = copy;
+}
+
+/*
+================
+idDict::Release
+================
+*/
+void idDict::Release( void ) {
+	int i;
+
+	if ( data == NULL ) {
+		return;
+	}
+	if ( --data->refCount == 0 ) {
+		for( i = 0; i < data->args.Num(); i++ ) {
+			globalKeys.FreeString( data->args[i].key );
+			globalValues.FreeString( data->args[i].value );
+		}
+		delete data;
+	}
+	data = NULL;
+}
+
+/*
+================
+idDict::Append
+================
+*/
+void idDict::Append( const idPoolStr *key, const idPoolStr *value, int hash ) {
+	idKeyValue kv;
+
+	kv.key = key;
+	kv.value = value;
+	data->Add( hash, data->args.Append( kv ) );
+}
+
 /*
 ================
 idDict::operator=
@@ -47,18 +201,27 @@ idDict &idDict::operator=( const idDict &other ) {
 	int i;
 
 	// check for assignment to self
-	if ( this == &other ) {
+	if ( this == &other || data == other.data ) {
 		return *this;
 	}
 
 	Clear();
 
-	args = other.args;
-	argHash = other.argHash;
+	if ( other.data == NULL ) {
+		return *this;
+	}
+
+	// share the key/value pairs if the strings come from the pools of this module
+	if ( other.data->keyPool == &globalKeys && other.data->valuePool == &globalValues ) {
+		data = other.data;
+		data->refCount++;
+		return *this;
+	}
 
-	for ( i = 0; i < args.Num(); i++ ) {
-		args[i].key = globalKeys.CopyString( args[i].key );
-		args[i].value = globalValues.CopyString( args[i].value );
+	Unshare();
+	for ( i = 0; i < other.data->args.Num(); i++ ) {
+		const idKeyValue &kv = other.data->args[i];
+		Append( globalKeys.CopyString( kv.key ), globalValues.CopyString( kv.value ), idStr::IHash( kv.GetKey() ) );
 	}
 
 	return *this;
@@ -72,35 +235,32 @@ idDict::Copy
 ================
 */
 void idDict::Copy( const idDict &other ) {
-	int i, n, *found;
-	idKeyValue kv;
+	int i, n, found, hash;
 
-	// check for assignment to self
-	if ( this == &other ) {
+	// check for assignment to self, shared key/value pairs are a copy already
+	if ( this == &other || other.data == NULL || data == other.data ) {
 		return;
 	}
 
-	n = other.args.Num();
-
-	if ( args.Num() ) {
-		found = (int *) _alloca16( other.args.Num() * sizeof( int ) );
-		for ( i = 0; i < n; i++ ) {
-			found[i] = FindKeyIndex( other.args[i].GetKey() );
-		}
-	} else {
-		found = NULL;
+	if ( GetNumKeyVals() == 0 ) {
+		*this = other;
+		return;
 	}
 
+	Unshare();
+
+	n = other.data->args.Num();
 	for ( i = 0; i < n; i++ ) {
-		if ( found && found[i] != -1 ) {
+		const idKeyValue &kv = other.data->args[i];
+		hash = idStr::IHash( kv.GetKey() );
+		found = data->Find( kv.GetKey(), hash );
+		if ( found != -1 ) {
 			// first set the new value and then free the old value to allow proper self copying
-			const idPoolStr *oldValue = args[found[i]].value;
-			args[found[i]].value = globalValues.CopyString( other.args[i].value );
+			const idPoolStr *oldValue = data->args[found].value;
+			data->args[found].value = globalValues.CopyString( kv.value );
 			globalValues.FreeString( oldValue );
 		} else {
-			kv.key = globalKeys.CopyString( other.args[i].key );
-			kv.value = globalValues.CopyString( other.args[i].value );
-			argHash.Add( argHash.GenerateKey( kv.GetKey(), false ), args.Append( kv ) );
+			Append( globalKeys.CopyString( kv.key ), globalValues.CopyString( kv.value ), hash );
 		}
 	}
 }
@@ -113,29 +273,20 @@ idDict::TransferKeyValues
 ================
 */
 void idDict::TransferKeyValues( idDict &other ) {
-	int i, n;
 
 	if ( this == &other ) {
 		return;
 	}
 
-	if ( other.args.Num() && other.args[0].key->GetPool() != &globalKeys ) {
+	if ( other.data && other.data->keyPool != &globalKeys ) {
 		common->FatalError( "idDict::TransferKeyValues: can't transfer values across a DLL boundary" );
 		return;
 	}
 
 	Clear();
 
-	n = other.args.Num();
-	args.SetNum( n );
-	for ( i = 0; i < n; i++ ) {
-		args[i].key = other.args[i].key;
-		args[i].value = other.args[i].value;
-	}
-	argHash = other.argHash;
-
-	other.args.Clear();
-	other.argHash.Free();
+	data = other.data;
+	other.data = NULL;
 }
 
 /*
@@ -181,18 +332,25 @@ idDict::SetDefaults
 ================
 */
 void idDict::SetDefaults( const idDict *dict ) {
-	int i, n;
-	const idKeyValue *kv, *def;
-	idKeyValue newkv;
+	int i, n, hash;
+	const idKeyValue *def;
+
+	if ( dict == this || dict->data == NULL ) {
+		return;
+	}
 
-	n = dict->args.Num();
+	if ( GetNumKeyVals() == 0 ) {
+		*this = *dict;
+		return;
+	}
+
+	n = dict->data->args.Num();
 	for( i = 0; i < n; i++ ) {
-		def = &dict->args[i];
-		kv = FindKey( def->GetKey() );
-		if ( !kv ) {
-			newkv.key = globalKeys.CopyString( def->key );
-			newkv.value = globalValues.CopyString( def->value );
-			argHash.Add( argHash.GenerateKey( newkv.GetKey(), false ), args.Append( newkv ) );
+		def = &dict->data->args[i];
+		hash = idStr::IHash( def->GetKey() );
+		if ( data->Find( def->GetKey(), hash ) == -1 ) {
+			Unshare();
+			Append( globalKeys.CopyString( def->key ), globalValues.CopyString( def->value ), hash );
 		}
 	}
 }
@@ -203,15 +361,7 @@ idDict::Clear
 ================
 */
 void idDict::Clear( void ) {
-	int i;
-
-	for( i = 0; i < args.Num(); i++ ) {
-		globalKeys.FreeString( args[i].key );
-		globalValues.FreeString( args[i].value );
-	}
-
-	args.Clear();
-	argHash.Free();
+	Release();
 }
 
 /*
@@ -223,9 +373,9 @@ void idDict::Print() const {
 	int i;
 	int n;
 
-	n = args.Num();
+	n = GetNumKeyVals();
 	for( i = 0; i < n; i++ ) {
-		idLib::common->Printf( "%s = %s\n", args[i].GetKey().c_str(), args[i].GetValue().c_str() );
+		idLib::common->Printf( "%s = %s\n", data->args[i].GetKey().c_str(), data->args[i].GetValue().c_str() );
 	}
 }
 
@@ -242,7 +392,10 @@ int	idDict::Checksum( void ) const {
 	unsigned int ret;
 	int i, n;
 
-	idList<idKeyValue> sorted = args;
+	idList<idKeyValue> sorted;
+	if ( data != NULL ) {
+		sorted = data->args;
+	}
 	sorted.Sort( KeyCompare );
 	n = sorted.Num();
 	CRC32_InitChecksum( ret );
@@ -263,9 +416,16 @@ size_t idDict::Allocated( void ) const {
 	int		i;
 	size_t	size;
 
-	size = args.Allocated() + argHash.Allocated();
-	for( i = 0; i < args.Num(); i++ ) {
-		size += args[i].Size();
+	if ( data == NULL ) {
+		return 0;
+	}
+
+	size = sizeof( *data ) + data->args.Allocated();
+	if ( data->slots != NULL ) {
+		size += ( data->slotMask + 1 ) * sizeof( data->slots[0] );
+	}
+	for( i = 0; i < data->args.Num(); i++ ) {
+		size += data->args[i].Size();
 	}
 
 	return size;
@@ -277,23 +437,25 @@ idDict::Set
 ================
 */
 void idDict::Set( const char *key, const char *value ) {
-	int i;
-	idKeyValue kv;
+	int i, hash;
 
 	if ( key == NULL || key[0] == '\0' ) {
 		return;
 	}
 
-	i = FindKeyIndex( key );
+	hash = idStr::IHash( key );
+	i = ( data != NULL ) ? data->Find( key, hash ) : -1;
+
+	// the key and value may point into the shared strings, those stay alive
+	Unshare();
+
 	if ( i != -1 ) {
 		// first set the new value and then free the old value to allow proper self copying
-		const idPoolStr *oldValue = args[i].value;
-		args[i].value = globalValues.AllocString( value );
+		const idPoolStr *oldValue = data->args[i].value;
+		data->args[i].value = globalValues.AllocString( value );
 		globalValues.FreeString( oldValue );
 	} else {
-		kv.key = globalKeys.AllocString( key );
-		kv.value = globalValues.AllocString( value );
-		argHash.Add( argHash.GenerateKey( kv.GetKey(), false ), args.Append( kv ) );
+		Append( globalKeys.AllocString( key ), globalValues.AllocString( value ), hash );
 	}
 }
 
@@ -377,6 +539,25 @@ bool idDict::GetVector( const char *key, const char *defaultString, idVec3 &out
 	return found;
 }
 
+/*
+================
+idDict::GetVector
+================
+*/
+idVec3 idDict::GetVector( const idDictKey &key, const char *defaultString ) const {
+	idVec3		out;
+	const char	*s;
+
+	if ( !defaultString ) {
+		defaultString = "0 0 0";
+	}
+
+	GetString( key, defaultString, &s );
+	out.Zero();
+	sscanf( s, "%f %f %f", &out.x, &out.y, &out.z );
+	return out;
+}
+
 /*
 ================
 idDict::GetVec2
@@ -453,21 +634,19 @@ idDict::FindKey
 ================
 */
 const idKeyValue *idDict::FindKey( const char *key ) const {
-	int i, hash;
+	int i;
 
 	if ( key == NULL || key[0] == '\0' ) {
 		idLib::common->DWarning( "idDict::FindKey: empty key" );
 		return NULL;
 	}
 
-	hash = argHash.GenerateKey( key, false );
-	for ( i = argHash.First( hash ); i != -1; i = argHash.Next( i ) ) {
-		if ( args[i].GetKey().Icmp( key ) == 0 ) {
-			return &args[i];
-		}
+	if ( data == NULL ) {
+		return NULL;
 	}
 
-	return NULL;
+	i = data->Find( key, idStr::IHash( key ) );
+	return ( i != -1 ) ? &data->args[i] : NULL;
 }
 
 /*
@@ -482,14 +661,11 @@ int idDict::FindKeyIndex( const char *key ) const {
 		return 0;
 	}
 
-	int hash = argHash.GenerateKey( key, false );
-	for ( int i = argHash.First( hash ); i != -1; i = argHash.Next( i ) ) {
-		if ( args[i].GetKey().Icmp( key ) == 0 ) {
-			return i;
-		}
+	if ( data == NULL ) {
+		return -1;
 	}
 
-	return -1;
+	return data->Find( key, idStr::IHash( key ) );
 }
 
 /*
@@ -498,23 +674,28 @@ idDict::Delete
 ================
 */
 void idDict::Delete( const char *key ) {
-	int hash, i;
-
-	hash = argHash.GenerateKey( key, false );
-	for ( i = argHash.First( hash ); i != -1; i = argHash.Next( i ) ) {
-		if ( args[i].GetKey().Icmp( key ) == 0 ) {
-			globalKeys.FreeString( args[i].key );
-			globalValues.FreeString( args[i].value );
-			args.RemoveIndex( i );
-			argHash.RemoveIndex( hash, i );
-			break;
-		}
+	int i;
+
+	if ( data == NULL || key == NULL || key[0] == '\0' ) {
+		return;
 	}
 
+	i = data->Find( key, idStr::IHash( key ) );
+	if ( i == -1 ) {
+		return;
+	}
+
+	Unshare();
+
+	globalKeys.FreeString( data->args[i].key );
+	globalValues.FreeString( data->args[i].value );
+	data->args.RemoveIndex( i );
+	data->Remove( i );
+
 #if 0
 	// make sure all keys can still be found in the hash index
-	for ( i = 0; i < args.Num(); i++ ) {
-		assert( FindKey( args[i].GetKey() ) != NULL );
+	for ( i = 0; i < data->args.Num(); i++ ) {
+		assert( FindKey( data->args[i].GetKey() ) != NULL );
 	}
 #endif
 }
@@ -532,18 +713,22 @@ const idKeyValue *idDict::MatchPrefix( const char *prefix, const idKeyValue *las
 	assert( prefix );
 	len = strlen( prefix );
 
+	if ( data == NULL ) {
+		return NULL;
+	}
+
 	start = -1;
 	if ( lastMatch ) {
-		start = args.FindIndex( *lastMatch );
+		start = data->args.FindIndex( *lastMatch );
 		assert( start >= 0 );
 		if ( start < 1 ) {
 			start = 0;
 		}
 	}
 
-	for( i = start + 1; i < args.Num(); i++ ) {
-		if ( !args[i].GetKey().Icmpn( prefix, len ) ) {
-			return &args[i];
+	for( i = start + 1; i < data->args.Num(); i++ ) {
+		if ( !data->args[i].GetKey().Icmpn( prefix, len ) ) {
+			return &data->args[i];
 		}
 	}
 	return NULL;
@@ -573,11 +758,11 @@ idDict::WriteToFileHandle
 ================
 */
 void idDict::WriteToFileHandle( idFile *f ) const {
-	int c = LittleInt( args.Num() );
+	int c = LittleInt( GetNumKeyVals() );
 	f->Write( &c, sizeof( c ) );
-	for ( int i = 0; i < args.Num(); i++ ) {	// don't loop on the swapped count use the original
-		WriteString( args[i].GetKey().c_str(), f );
-		WriteString( args[i].GetValue().c_str(), f );
+	for ( int i = 0; i < GetNumKeyVals(); i++ ) {	// don't loop on the swapped count use the original
+		WriteString( data->args[i].GetKey().c_str(), f );
+		WriteString( data->args[i].GetValue().c_str(), f );
 	}
 }
 
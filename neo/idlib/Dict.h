@@ -29,6 +29,8 @@ If you have questions concerning this license or the applicable additional terms
 #ifndef __DICT_H__
 #define __DICT_H__
 
+#include <atomic>
+
 #include "idlib/containers/StrPool.h"
 #include "idlib/math/Angles.h"
 #include "idlib/math/Matrix.h"
@@ -48,6 +50,12 @@ Keys are compared case-insensitive.
 
 Does not allocate memory until the first key/value pair is added.
 
+The key/value pairs are found through a flat open-addressed table that holds
+the hash of every key. Copies of a dictionary share the key/value pairs until
+one of them is changed, so copying an entityDef or spawn dictionary that is
+only read afterwards doesn't copy anything. An idDictKey holds the hash of a
+key, so hot code can look up the same key over and over without hashing it.
+
 ===============================================================================
 */
 
@@ -68,6 +76,66 @@ private:
 	const idPoolStr *	value;
 };
 
+/*
+===============================================================================
+
+	idDictKey
+
+	A key with its hash, for lookups that happen over and over:
+		static const idDictKey key_health( "health" );
+		int health = spawnArgs.GetInt( key_health );
+
+===============================================================================
+*/
+
+class idDictKey {
+	friend class idDict;
+
+public:
+	explicit			idDictKey( const char *key ) { this->key = key; hash = idStr::IHash( key ); }
+
+	const char *		c_str( void ) const { return key; }
+
+private:
+	const char *		key;
+	int					hash;
+};
+
+// shared key/value pairs with their lookup table
+class idDictArgs {
+public:
+	typedef struct {
+		int				hash;				// case-insensitive hash of the key
+		int				index;				// index into args, -1 if the slot is free
+	} slot_t;
+
+						idDictArgs( void ) { refCount = 1; keyPool = NULL; valuePool = NULL; slots = NULL; slotMask = -1; }
+						~idDictArgs( void ) { delete[] slots; }
+
+	std::atomic<int>	refCount;			// number of dicts sharing the key/value pairs, dicts on different threads can share them
+	const idStrPool *	keyPool;			// pools of the module that allocated the strings
+	const idStrPool *	valuePool;
+	idList<idKeyValue>	args;
+	slot_t *			slots;
+	int					slotMask;			// number of slots - 1
+
+						// returns the index of the key/value pair, -1 if it does not exist
+	int					Find( const char *key, int hash ) const;
+	void				Add( int hash, int index );
+						// removes the key/value pair at index from the table, higher indexes move down
+	void				Remove( int index );
+						// rebuilds the table, leaving out removedIndex
+	void				Resize( int numSlots, int removedIndex = -1 );
+
+	static int			SlotForHash( int hash, int mask ) {
+							unsigned int h = (unsigned int)hash;
+							h ^= h >> 16;
+							h *= 0x45d9f3bU;
+							h ^= h >> 16;
+							return (int)( h & (unsigned int)mask );
+						}
+};
+
 class idDict {
 public:
 						idDict( void );
@@ -108,6 +176,11 @@ public:
 
 						// these return default values of 0.0, 0 and false
 	const char *		GetString( const char *key, const char *defaultString = "" ) const;
+	const char *		GetString( const idDictKey &key, const char *defaultString = "" ) const;
+	float				GetFloat( const idDictKey &key, const char *defaultString = "0" ) const;
+	int					GetInt( const idDictKey &key, const char *defaultString = "0" ) const;
+	bool				GetBool( const idDictKey &key, const char *defaultString = "0" ) const;
+	idVec3				GetVector( const idDictKey &key, const char *defaultString = NULL ) const;
 	float				GetFloat( const char *key, const char *defaultString = "0" ) const;
 	int					GetInt( const char *key, const char *defaultString = "0" ) const;
 	bool				GetBool( const char *key, const char *defaultString = "0" ) const;
@@ -118,6 +191,7 @@ public:
 	idMat3				GetMatrix( const char *key, const char *defaultString = NULL ) const;
 
 	bool				GetString( const char *key, const char *defaultString, const char **out ) const;
+	bool				GetString( const idDictKey &key, const char *defaultString, const char **out ) const;
 	bool				GetString( const char *key, const char *defaultString, idStr &out ) const;
 	bool				GetFloat( const char *key, const char *defaultString, float &out ) const;
 	bool				GetInt( const char *key, const char *defaultString, int &out ) const;
@@ -133,6 +207,7 @@ public:
 						// returns the key/value pair with the given key
 						// returns NULL if the key/value pair does not exist
 	const idKeyValue *	FindKey( const char *key ) const;
+	const idKeyValue *	FindKey( const idDictKey &key ) const;
 						// returns the index to the key/value pair with the given key
 						// returns -1 if the key/value pair does not exist
 	int					FindKeyIndex( const char *key ) const;
@@ -149,6 +224,8 @@ public:
 
 						// returns a unique checksum for this dictionary's content
 	int					Checksum( void ) const;
+						// returns true if the key/value pairs are shared with another dict
+	bool				IsShared( void ) const { return data != NULL && data->refCount > 1; }
 
 	static void			Init( void );
 	static void			Shutdown( void );
@@ -158,8 +235,13 @@ public:
 	static void			ListValues_f( const idCmdArgs &args );
 
 private:
-	idList<idKeyValue>	args;
-	idHashIndex			argHash;
+	idDictArgs *		data;				// NULL until the first key/value pair is added
+	int					granularity;
+
+						// makes sure the key/value pairs can be changed without affecting other dicts
+	void				Unshare( void );
+	void				Release( void );
+	void				Append( const idPoolStr *key, const idPoolStr *value, int hash );
 
 	static idStrPool	globalKeys;
 	static idStrPool	globalValues;
@@ -167,12 +249,13 @@ private:
 
 
 ID_INLINE idDict::idDict( void ) {
-	args.SetGranularity( 16 );
-	argHash.SetGranularity( 16 );
-	argHash.Clear( 128, 16 );
+	data = NULL;
+	granularity = 16;
 }
 
 ID_INLINE idDict::idDict( const idDict &other ) {
+	data = NULL;
+	granularity = 16;
 	*this = other;
 }
 
@@ -181,13 +264,17 @@ ID_INLINE idDict::~idDict( void ) {
 }
 
 ID_INLINE void idDict::SetGranularity( int granularity ) {
-	args.SetGranularity( granularity );
-	argHash.SetGranularity( granularity );
+	this->granularity = granularity;
+	if ( data != NULL && data->refCount == 1 ) {
+		data->args.SetGranularity( granularity );
+	}
 }
 
 ID_INLINE void idDict::SetHashSize( int hashSize ) {
-	if ( args.Num() == 0 ) {
-		argHash.Clear( hashSize, 16 );
+	// the lookup table grows with the number of key/value pairs
+	if ( GetNumKeyVals() == 0 ) {
+		Unshare();
+		data->Resize( idMath::CeilPowerOfTwo( Max( hashSize, 16 ) ) );
 	}
 }
 
@@ -251,6 +338,37 @@ ID_INLINE const char *idDict::GetString( const char *key, const char *defaultStr
 	return defaultString;
 }
 
+ID_INLINE bool idDict::GetString( const idDictKey &key, const char *defaultString, const char **out ) const {
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		*out = kv->GetValue();
+		return true;
+	}
+	*out = defaultString;
+	return false;
+}
+
+ID_INLINE const char *idDict::GetString( const idDictKey &key, const char *defaultString ) const {
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		return kv->GetValue();
+	}
+	return defaultString;
+}
+
+ID_INLINE float idDict::GetFloat( const idDictKey &key, const char *defaultString ) const {
+	return atof( GetString( key, defaultString ) );
+}
+
+ID_INLINE int idDict::GetInt( const idDictKey &key, const char *defaultString ) const {
+	return atoi( GetString( key, defaultString ) );
+}
+
+ID_INLINE bool idDict::GetBool( const idDictKey &key, const char *defaultString ) const {
+	return ( atoi( GetString( key, defaultString ) ) != 0 );
+}
+
+
 ID_INLINE float idDict::GetFloat( const char *key, const char *defaultString ) const {
 	return atof( GetString( key, defaultString ) );
 }
@@ -294,14 +412,24 @@ ID_INLINE idMat3 idDict::GetMatrix( const char *key, const char *defaultString )
 }
 
 ID_INLINE int idDict::GetNumKeyVals( void ) const {
-	return args.Num();
+	return ( data != NULL ) ? data->args.Num() : 0;
 }
 
 ID_INLINE const idKeyValue *idDict::GetKeyVal( int index ) const {
-	if ( index >= 0 && index < args.Num() ) {
-		return &args[ index ];
+	if ( data != NULL && index >= 0 && index < data->args.Num() ) {
+		return &data->args[ index ];
 	}
 	return NULL;
 }
 
+ID_INLINE const idKeyValue *idDict::FindKey( const idDictKey &key ) const {
+	int i;
+
+	if ( data == NULL ) {
+		return NULL;
+	}
+	i = data->Find( key.key, key.hash );
+	return ( i != -1 ) ? &data->args[ i ] : NULL;
+}
+
 #endif /* !__DICT_H__ */
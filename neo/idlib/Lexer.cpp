@@ -246,6 +246,8 @@ void idLexer::Warning( const char *str, ... ) {
 	char text[MAX_STRING_CHARS];
 	va_list ap;
 
+	hadWarning = true;
+
 	if ( idLexer::flags & LEXFL_NOWARNINGS ) {
 		return;
 	}
@@ -1789,6 +1791,7 @@ idLexer::idLexer( void ) {
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 }
 
 /*
@@ -1810,6 +1813,7 @@ idLexer::idLexer( int flags ) {
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 }
 
 /*
@@ -1825,6 +1829,7 @@ idLexer::idLexer( const char *filename, int flags, bool OSPath ) {
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 	idLexer::LoadFile( filename, OSPath );
 }
 
@@ -1841,6 +1846,7 @@ idLexer::idLexer( const char *ptr, int length, const char *name, int flags ) {
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 	idLexer::LoadMemory( ptr, length, name );
 }
 
@@ -1870,3 +1876,12 @@ idLexer::HadError
 bool idLexer::HadError( void ) const {
 	return hadError;
 }
+
+/*
+================
+idLexer::HadWarning
+================
+*/
+bool idLexer::HadWarning( void ) const {
+	return hadWarning;
+}
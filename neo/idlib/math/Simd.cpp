@@ -45,6 +45,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "idlib/math/Simd_SSE3.h"
 #include "idlib/math/Simd_AltiVec.h"
 #include "idlib/math/Plane.h"
+#include "idlib/math/Random.h"
 #include "idlib/bv/Bounds.h"
 #include "idlib/Lib.h"
 #include "framework/Common.h"
@@ -80,6 +81,7 @@ void idSIMD::InitProcessor(const char *module, bool forceGeneric) {  // blendo e
 	cpuid = idLib::sys->GetProcessorId();
 	idLib::sys->FPU_SetFTZ(true);
 	idLib::sys->FPU_SetDAZ(true);
+	SIMDProcessor->useAVX2 = !forceGeneric && ( cpuid & CPUID_AVX2 ) && ( cpuid & CPUID_FMA3 );
 	idLib::common->Printf("%s using %s for SIMD processing\n", module, SIMDProcessor->GetName());
 
 #if defined(__BLENDO_SIMD_INLINE__)
@@ -104,6 +106,12 @@ void idSIMD::InitProcessor(const char *module, bool forceGeneric) {  // blendo e
 	if (cpuid & CPUID_SSE3) {
 		SimdInfo += "/ SSE3";
 	}
+	if (cpuid & CPUID_AVX2) {
+		SimdInfo += " / AVX2";
+	}
+	if (cpuid & CPUID_FMA3) {
+		SimdInfo += " / FMA3";
+	}
 
 	cmdSystem->AddCommand("simdinfo", idSIMD::GetInfo, CMD_FL_SYSTEM | CMD_FL_CHEAT, "simd info");
 }
@@ -3945,6 +3953,297 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 #endif /* _WIN32 */
 }
 
+#elif defined(__BLENDO_SIMD_INLINE__)
+
+//===============================================================
+//
+// AVX2 test code, validates the AVX2 routines of the inlined
+// processor against its scalar versions and times both
+//
+//===============================================================
+
+#include <ctime>
+
+#define AVX2_TEST_VERTS		4096
+#define AVX2_TEST_JOINTS	64
+#define AVX2_TEST_RUNS		200
+
+#define AVX2_TEST_SEED		1013904223L
+
+/*
+============
+AVX2_Compare
+============
+*/
+static bool AVX2_Compare( const float *a, const float *b, const int count, const float epsilon ) {
+	for ( int i = 0; i < count; i++ ) {
+		if ( idMath::Fabs( a[i] - b[i] ) > epsilon * Max( 1.0f, idMath::Fabs( a[i] ) ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+============
+AVX2_PrintResult
+============
+*/
+static void AVX2_PrintResult( const char *name, clock_t scalarClocks, clock_t avxClocks, bool ok ) {
+	const double scalarMS = scalarClocks * 1000.0 / CLOCKS_PER_SEC / AVX2_TEST_RUNS;
+	const double avxMS = avxClocks * 1000.0 / CLOCKS_PER_SEC / AVX2_TEST_RUNS;
+	idLib::common->Printf( "%-20s scalar %8.4f ms  avx2 %8.4f ms  %5.2fx %s\n", name, scalarMS, avxMS, avxMS > 0.0 ? scalarMS / avxMS : 0.0, ok ? "ok" : S_COLOR_RED "X" );
+}
+
+/*
+============
+AVX2_RandomVerts
+============
+*/
+static void AVX2_RandomVerts( idDrawVert *verts, const int numVerts, idRandom &srnd ) {
+	for ( int i = 0; i < numVerts; i++ ) {
+		verts[i].Clear();
+		for ( int j = 0; j < 3; j++ ) {
+			verts[i].xyz[j] = srnd.CRandomFloat() * 64.0f;
+			verts[i].normal[j] = srnd.CRandomFloat();
+			verts[i].tangents[0][j] = srnd.CRandomFloat();
+			verts[i].tangents[1][j] = srnd.CRandomFloat();
+		}
+		verts[i].st[0] = srnd.RandomFloat();
+		verts[i].st[1] = srnd.RandomFloat();
+	}
+}
+
+/*
+============
+AVX2_TestTransformVerts
+============
+*/
+static void AVX2_TestTransformVerts( void ) {
+	idRandom srnd( AVX2_TEST_SEED );
+	idList<idJointMat> joints;
+	idList<idVec4> weights;
+	idList<int> weightIndex;
+	idList<idDrawVert> verts1, verts2;
+
+	joints.SetNum( AVX2_TEST_JOINTS );
+	for ( int i = 0; i < AVX2_TEST_JOINTS; i++ ) {
+		idAngles angles( srnd.CRandomFloat() * 180.0f, srnd.CRandomFloat() * 180.0f, srnd.CRandomFloat() * 180.0f );
+		joints[i].SetRotation( angles.ToMat3() );
+		joints[i].SetTranslation( idVec3( srnd.CRandomFloat(), srnd.CRandomFloat(), srnd.CRandomFloat() ) * 32.0f );
+	}
+
+	// one to four weights per vertex
+	for ( int i = 0; i < AVX2_TEST_VERTS; i++ ) {
+		const int numVertWeights = 1 + srnd.RandomInt( 4 );
+		for ( int j = 0; j < numVertWeights; j++ ) {
+			const float w = 1.0f / numVertWeights;
+			weights.Append( idVec4( srnd.CRandomFloat() * 8.0f * w, srnd.CRandomFloat() * 8.0f * w, srnd.CRandomFloat() * 8.0f * w, w ) );
+			weightIndex.Append( srnd.RandomInt( AVX2_TEST_JOINTS ) * sizeof( idJointMat ) );
+			weightIndex.Append( j == numVertWeights - 1 );
+		}
+	}
+
+	verts1.SetNum( AVX2_TEST_VERTS );
+	verts2.SetNum( AVX2_TEST_VERTS );
+
+	clock_t start = clock();
+	SIMDProcessor->useAVX2 = false;
+	for ( int i = 0; i < AVX2_TEST_RUNS; i++ ) {
+		SIMDProcessor->TransformVerts( verts1.Ptr(), AVX2_TEST_VERTS, joints.Ptr(), weights.Ptr(), weightIndex.Ptr(), weights.Num() );
+	}
+	clock_t scalarClocks = clock() - start;
+
+	start = clock();
+	SIMDProcessor->useAVX2 = true;
+	for ( int i = 0; i < AVX2_TEST_RUNS; i++ ) {
+		SIMDProcessor->TransformVerts( verts2.Ptr(), AVX2_TEST_VERTS, joints.Ptr(), weights.Ptr(), weightIndex.Ptr(), weights.Num() );
+	}
+	clock_t avxClocks = clock() - start;
+
+	bool ok = true;
+	for ( int i = 0; i < AVX2_TEST_VERTS && ok; i++ ) {
+		ok = AVX2_Compare( verts1[i].xyz.ToFloatPtr(), verts2[i].xyz.ToFloatPtr(), 3, 1e-4f );
+	}
+	AVX2_PrintResult( "TransformVerts", scalarClocks, avxClocks, ok );
+}
+
+/*
+============
+AVX2_TestDeriveTangents
+============
+*/
+static void AVX2_TestDeriveTangents( void ) {
+	idRandom srnd( AVX2_TEST_SEED );
+	idList<idDrawVert> verts, verts1, verts2;
+	idList<idPlane> planes1, planes2;
+	idList<int> indexes;
+
+	verts.SetNum( AVX2_TEST_VERTS );
+	AVX2_RandomVerts( verts.Ptr(), AVX2_TEST_VERTS, srnd );
+
+	// an odd triangle count also covers the partial block
+	const int numTris = AVX2_TEST_VERTS * 2 - 3;
+	for ( int i = 0; i < numTris; i++ ) {
+		const int a = srnd.RandomInt( AVX2_TEST_VERTS - 2 );
+		indexes.Append( a );
+		indexes.Append( a + 1 );
+		indexes.Append( a + 2 );
+	}
+	planes1.SetNum( numTris );
+	planes2.SetNum( numTris );
+
+	clock_t start = clock();
+	SIMDProcessor->useAVX2 = false;
+	for ( int i = 0; i < AVX2_TEST_RUNS; i++ ) {
+		verts1 = verts;
+		SIMDProcessor->DeriveTangents( planes1.Ptr(), verts1.Ptr(), AVX2_TEST_VERTS, indexes.Ptr(), indexes.Num() );
+	}
+	clock_t scalarClocks = clock() - start;
+
+	start = clock();
+	SIMDProcessor->useAVX2 = true;
+	for ( int i = 0; i < AVX2_TEST_RUNS; i++ ) {
+		verts2 = verts;
+		SIMDProcessor->DeriveTangents( planes2.Ptr(), verts2.Ptr(), AVX2_TEST_VERTS, indexes.Ptr(), indexes.Num() );
+	}
+	clock_t avxClocks = clock() - start;
+
+	// idMath::RSqrt only has about 20 bits of precision
+	bool ok = true;
+	for ( int i = 0; i < numTris && ok; i++ ) {
+		ok = AVX2_Compare( planes1[i].ToFloatPtr(), planes2[i].ToFloatPtr(), 4, 1e-2f );
+	}
+	for ( int i = 0; i < AVX2_TEST_VERTS && ok; i++ ) {
+		ok = AVX2_Compare( verts1[i].normal.ToFloatPtr(), verts2[i].normal.ToFloatPtr(), 9, 1e-2f );
+	}
+	AVX2_PrintResult( "DeriveTangents", scalarClocks, avxClocks, ok );
+}
+
+/*
+============
+AVX2_TestNormalizeTangents
+============
+*/
+static void AVX2_TestNormalizeTangents( void ) {
+	idRandom srnd( AVX2_TEST_SEED );
+	idList<idDrawVert> verts, verts1, verts2;
+
+	// not a multiple of 8 to cover the partial block
+	const int numVerts = AVX2_TEST_VERTS - 3;
+	verts.SetNum( numVerts );
+	AVX2_RandomVerts( verts.Ptr(), numVerts, srnd );
+
+	clock_t start = clock();
+	SIMDProcessor->useAVX2 = false;
+	for ( int i = 0; i < AVX2_TEST_RUNS; i++ ) {
+		verts1 = verts;
+		SIMDProcessor->NormalizeTangents( verts1.Ptr(), numVerts );
+	}
+	clock_t scalarClocks = clock() - start;
+
+	start = clock();
+	SIMDProcessor->useAVX2 = true;
+	for ( int i = 0; i < AVX2_TEST_RUNS; i++ ) {
+		verts2 = verts;
+		SIMDProcessor->NormalizeTangents( verts2.Ptr(), numVerts );
+	}
+	clock_t avxClocks = clock() - start;
+
+	// the error of idMath::RSqrt in the scalar normal gets amplified by the
+	// tangent projection, so only the direction of the tangents is compared
+	// and tangents that are almost parallel to the normal are skipped
+	bool ok = true;
+	for ( int i = 0; i < numVerts && ok; i++ ) {
+		ok = AVX2_Compare( verts1[i].normal.ToFloatPtr(), verts2[i].normal.ToFloatPtr(), 3, 1e-2f );
+		for ( int j = 0; j < 2 && ok; j++ ) {
+			const idVec3 &t = verts[i].tangents[j];
+			const idVec3 n = verts[i].normal / verts[i].normal.Length();
+			if ( ( t - ( t * n ) * n ).Length() > 0.1f * t.Length() ) {
+				ok = verts1[i].tangents[j] * verts2[i].tangents[j] > 0.99f;
+			}
+		}
+	}
+	AVX2_PrintResult( "NormalizeTangents", scalarClocks, avxClocks, ok );
+}
+
+/*
+============
+AVX2_TestCreateShadowCache
+============
+*/
+static void AVX2_TestCreateShadowCache( void ) {
+	idRandom srnd( AVX2_TEST_SEED );
+	idList<idDrawVert> verts;
+	idList<int> remap, remap1, remap2;
+	idList<idVec4> cache1, cache2;
+	const idVec3 lightOrigin( 12.0f, -40.0f, 100.0f );
+
+	const int numVerts = AVX2_TEST_VERTS - 3;
+	verts.SetNum( numVerts );
+	AVX2_RandomVerts( verts.Ptr(), numVerts, srnd );
+
+	// about a third of the vertexes are already remapped
+	remap.SetNum( numVerts );
+	for ( int i = 0; i < numVerts; i++ ) {
+		remap[i] = ( srnd.RandomInt( 3 ) == 0 ) ? -1 : 0;
+	}
+	cache1.SetNum( numVerts * 2 );
+	cache2.SetNum( numVerts * 2 );
+
+	int count1 = 0, count2 = 0;
+
+	clock_t start = clock();
+	SIMDProcessor->useAVX2 = false;
+	for ( int i = 0; i < AVX2_TEST_RUNS; i++ ) {
+		remap1 = remap;
+		count1 = SIMDProcessor->CreateShadowCache( cache1.Ptr(), remap1.Ptr(), lightOrigin, verts.Ptr(), numVerts );
+	}
+	clock_t scalarClocks = clock() - start;
+
+	start = clock();
+	SIMDProcessor->useAVX2 = true;
+	for ( int i = 0; i < AVX2_TEST_RUNS; i++ ) {
+		remap2 = remap;
+		count2 = SIMDProcessor->CreateShadowCache( cache2.Ptr(), remap2.Ptr(), lightOrigin, verts.Ptr(), numVerts );
+	}
+	clock_t avxClocks = clock() - start;
+
+	bool ok = ( count1 == count2 ) && memcmp( remap1.Ptr(), remap2.Ptr(), numVerts * sizeof( int ) ) == 0;
+	if ( ok ) {
+		ok = AVX2_Compare( cache1[0].ToFloatPtr(), cache2[0].ToFloatPtr(), count1 * 4, 0.0f );
+	}
+	AVX2_PrintResult( "CreateShadowCache", scalarClocks, avxClocks, ok );
+}
+
+/*
+============
+idSIMD::Test_f
+============
+*/
+void idSIMD::Test_f(const idCmdArgs &args) {
+	const int cpuid = idLib::sys->GetProcessorId();
+
+	if ( !( cpuid & CPUID_AVX2 ) || !( cpuid & CPUID_FMA3 ) ) {
+		idLib::common->Printf( "CPU does not support AVX2 & FMA3, nothing to test\n" );
+		return;
+	}
+
+	const bool useAVX2 = SIMDProcessor->useAVX2;
+
+	idLib::common->SetRefreshOnPrint( true );
+	idLib::common->Printf( "%d runs of each routine:\n", AVX2_TEST_RUNS );
+
+	AVX2_TestTransformVerts();
+	AVX2_TestDeriveTangents();
+	AVX2_TestNormalizeTangents();
+	AVX2_TestCreateShadowCache();
+
+	idLib::common->SetRefreshOnPrint( false );
+
+	SIMDProcessor->useAVX2 = useAVX2;
+}
+
 #else
 
 /*
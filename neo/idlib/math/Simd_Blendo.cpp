@@ -68,6 +68,11 @@ If you have questions concerning this license or the applicable additional terms
 #define DRAWVERT_TANGENT1_OFFSET	(11*4)
 #define DRAWVERT_COLOR_OFFSET		(14*4)
 
+static void TransformVerts_AVX2( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights );
+static void DeriveTangents_AVX2( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes );
+static void NormalizeTangents_AVX2( idDrawVert *verts, const int numVerts );
+static int CreateShadowCache_AVX2( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts );
+
 
 #if 1 // ACTUAL SIMD
 
@@ -1971,6 +1976,247 @@ void SIMD_VPCALL idSIMDProcessor::UpSampleOGGTo44kHz(float *dest, const float *
 	}
 }
 
+/*
+============
+MixSound_InitRamp
+
+Sets up the volume ramp for numFrames interleaved frames of numSpeakers speakers
+and the increment that moves the ramp numFrames frames ahead.
+The SIMD kernels below add the increment once per vector instead of stepping
+each speaker volume per sample.
+============
+*/
+static void MixSound_InitRamp( float *vol, float *inc, const int numSpeakers, const int numFrames, const float *lastV, const float *currentV ) {
+	for ( int i = 0; i < numSpeakers * numFrames; i++ ) {
+		const int s = i % numSpeakers;
+		const float step = ( currentV[s] - lastV[s] ) / MIXBUFFER_SAMPLES;
+		vol[i] = lastV[s] + ( i / numSpeakers ) * step;
+		inc[i] = numFrames * step;
+	}
+}
+
+// blendo: the sound mixing kernels use AVX when the compiler targets it (ONATIVE builds)
+// and SSE otherwise, define SIMD_SOUND_SCALAR to use the scalar reference kernels instead
+#if !defined( SIMD_SOUND_SCALAR )
+
+/*
+============
+MixSoundTwoSpeakerMono
+============
+*/
+void SIMD_VPCALL idSIMDProcessor::MixSoundTwoSpeakerMono(float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2]) {
+	assert(numSamples == MIXBUFFER_SAMPLES);
+	assert_16_byte_aligned(mixBuffer);
+	assert_16_byte_aligned(samples);
+
+#if defined( __AVX__ )
+	ALIGN16( float vol[8] );
+	ALIGN16( float inc[8] );
+	MixSound_InitRamp( vol, inc, 2, 4, lastV, currentV );
+
+	__m256 v = _mm256_loadu_ps( vol );
+	const __m256 dv = _mm256_loadu_ps( inc );
+
+	for (int j = 0; j < MIXBUFFER_SAMPLES; j += 4) {
+		const __m128 s = _mm_load_ps( samples + j );
+		const __m256 s8 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_unpacklo_ps( s, s ) ), _mm_unpackhi_ps( s, s ), 1 );
+		_mm256_storeu_ps( mixBuffer + j * 2, _mm256_add_ps( _mm256_loadu_ps( mixBuffer + j * 2 ), _mm256_mul_ps( s8, v ) ) );
+		v = _mm256_add_ps( v, dv );
+	}
+#else
+	ALIGN16( float vol[4] );
+	ALIGN16( float inc[4] );
+	MixSound_InitRamp( vol, inc, 2, 2, lastV, currentV );
+
+	__m128 v = _mm_load_ps( vol );
+	const __m128 dv = _mm_load_ps( inc );
+
+	for (int j = 0; j < MIXBUFFER_SAMPLES; j += 4) {
+		const __m128 s = _mm_load_ps( samples + j );
+		_mm_store_ps( mixBuffer + j * 2 + 0, _mm_add_ps( _mm_load_ps( mixBuffer + j * 2 + 0 ), _mm_mul_ps( _mm_unpacklo_ps( s, s ), v ) ) );
+		v = _mm_add_ps( v, dv );
+		_mm_store_ps( mixBuffer + j * 2 + 4, _mm_add_ps( _mm_load_ps( mixBuffer + j * 2 + 4 ), _mm_mul_ps( _mm_unpackhi_ps( s, s ), v ) ) );
+		v = _mm_add_ps( v, dv );
+	}
+#endif
+}
+
+/*
+============
+MixSoundTwoSpeakerStereo
+============
+*/
+void SIMD_VPCALL idSIMDProcessor::MixSoundTwoSpeakerStereo(float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2]) {
+	assert(numSamples == MIXBUFFER_SAMPLES);
+	assert_16_byte_aligned(mixBuffer);
+	assert_16_byte_aligned(samples);
+
+#if defined( __AVX__ )
+	ALIGN16( float vol[8] );
+	ALIGN16( float inc[8] );
+	MixSound_InitRamp( vol, inc, 2, 4, lastV, currentV );
+
+	__m256 v = _mm256_loadu_ps( vol );
+	const __m256 dv = _mm256_loadu_ps( inc );
+
+	for (int j = 0; j < MIXBUFFER_SAMPLES * 2; j += 8) {
+		_mm256_storeu_ps( mixBuffer + j, _mm256_add_ps( _mm256_loadu_ps( mixBuffer + j ), _mm256_mul_ps( _mm256_loadu_ps( samples + j ), v ) ) );
+		v = _mm256_add_ps( v, dv );
+	}
+#else
+	ALIGN16( float vol[4] );
+	ALIGN16( float inc[4] );
+	MixSound_InitRamp( vol, inc, 2, 2, lastV, currentV );
+
+	__m128 v = _mm_load_ps( vol );
+	const __m128 dv = _mm_load_ps( inc );
+
+	for (int j = 0; j < MIXBUFFER_SAMPLES * 2; j += 4) {
+		_mm_store_ps( mixBuffer + j, _mm_add_ps( _mm_load_ps( mixBuffer + j ), _mm_mul_ps( _mm_load_ps( samples + j ), v ) ) );
+		v = _mm_add_ps( v, dv );
+	}
+#endif
+}
+
+/*
+============
+MixSoundSixSpeakerMono
+============
+*/
+void SIMD_VPCALL idSIMDProcessor::MixSoundSixSpeakerMono(float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6]) {
+	assert(numSamples == MIXBUFFER_SAMPLES);
+	assert_16_byte_aligned(mixBuffer);
+	assert_16_byte_aligned(samples);
+
+#if defined( __AVX__ )
+	// four frames of six speakers are three vectors
+	ALIGN16( float vol[24] );
+	ALIGN16( float inc[24] );
+	MixSound_InitRamp( vol, inc, 6, 4, lastV, currentV );
+
+	__m256 v0 = _mm256_loadu_ps( vol + 0 );
+	__m256 v1 = _mm256_loadu_ps( vol + 8 );
+	__m256 v2 = _mm256_loadu_ps( vol + 16 );
+	const __m256 dv0 = _mm256_loadu_ps( inc + 0 );
+	const __m256 dv1 = _mm256_loadu_ps( inc + 8 );
+	const __m256 dv2 = _mm256_loadu_ps( inc + 16 );
+
+	for (int i = 0; i < MIXBUFFER_SAMPLES; i += 4) {
+		const __m128 s = _mm_load_ps( samples + i );
+		const __m128 s0 = _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 0, 0, 0, 0 ) );
+		const __m128 s1 = _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 0, 0, 1, 1 ) );
+		const __m128 s2 = _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 1, 1, 1, 1 ) );
+		const __m128 s3 = _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 2, 2, 2, 2 ) );
+		const __m128 s4 = _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 2, 2, 3, 3 ) );
+		const __m128 s5 = _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 3, 3, 3, 3 ) );
+		float *mix = mixBuffer + i * 6;
+
+		_mm256_storeu_ps( mix + 0, _mm256_add_ps( _mm256_loadu_ps( mix + 0 ), _mm256_mul_ps( _mm256_insertf128_ps( _mm256_castps128_ps256( s0 ), s1, 1 ), v0 ) ) );
+		_mm256_storeu_ps( mix + 8, _mm256_add_ps( _mm256_loadu_ps( mix + 8 ), _mm256_mul_ps( _mm256_insertf128_ps( _mm256_castps128_ps256( s2 ), s3, 1 ), v1 ) ) );
+		_mm256_storeu_ps( mix + 16, _mm256_add_ps( _mm256_loadu_ps( mix + 16 ), _mm256_mul_ps( _mm256_insertf128_ps( _mm256_castps128_ps256( s4 ), s5, 1 ), v2 ) ) );
+
+		v0 = _mm256_add_ps( v0, dv0 );
+		v1 = _mm256_add_ps( v1, dv1 );
+		v2 = _mm256_add_ps( v2, dv2 );
+	}
+#else
+	// two frames of six speakers are three vectors
+	ALIGN16( float vol[12] );
+	ALIGN16( float inc[12] );
+	MixSound_InitRamp( vol, inc, 6, 2, lastV, currentV );
+
+	__m128 v0 = _mm_load_ps( vol + 0 );
+	__m128 v1 = _mm_load_ps( vol + 4 );
+	__m128 v2 = _mm_load_ps( vol + 8 );
+	const __m128 dv0 = _mm_load_ps( inc + 0 );
+	const __m128 dv1 = _mm_load_ps( inc + 4 );
+	const __m128 dv2 = _mm_load_ps( inc + 8 );
+
+	for (int i = 0; i < MIXBUFFER_SAMPLES; i += 2) {
+		const __m128 s = _mm_loadl_pi( _mm_setzero_ps(), (const __m64 *)( samples + i ) );
+		float *mix = mixBuffer + i * 6;
+
+		_mm_store_ps( mix + 0, _mm_add_ps( _mm_load_ps( mix + 0 ), _mm_mul_ps( _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 0, 0, 0, 0 ) ), v0 ) ) );
+		_mm_store_ps( mix + 4, _mm_add_ps( _mm_load_ps( mix + 4 ), _mm_mul_ps( _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 0, 0, 1, 1 ) ), v1 ) ) );
+		_mm_store_ps( mix + 8, _mm_add_ps( _mm_load_ps( mix + 8 ), _mm_mul_ps( _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 1, 1, 1, 1 ) ), v2 ) ) );
+
+		v0 = _mm_add_ps( v0, dv0 );
+		v1 = _mm_add_ps( v1, dv1 );
+		v2 = _mm_add_ps( v2, dv2 );
+	}
+#endif
+}
+
+/*
+============
+MixSoundSixSpeakerStereo
+
+the left sample goes to speakers 0, 2, 3, 4 and the right sample to speakers 1, 5
+============
+*/
+void SIMD_VPCALL idSIMDProcessor::MixSoundSixSpeakerStereo(float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6]) {
+	assert(numSamples == MIXBUFFER_SAMPLES);
+	assert_16_byte_aligned(mixBuffer);
+	assert_16_byte_aligned(samples);
+
+#if defined( __AVX__ )
+	ALIGN16( float vol[24] );
+	ALIGN16( float inc[24] );
+	MixSound_InitRamp( vol, inc, 6, 4, lastV, currentV );
+
+	__m256 v0 = _mm256_loadu_ps( vol + 0 );
+	__m256 v1 = _mm256_loadu_ps( vol + 8 );
+	__m256 v2 = _mm256_loadu_ps( vol + 16 );
+	const __m256 dv0 = _mm256_loadu_ps( inc + 0 );
+	const __m256 dv1 = _mm256_loadu_ps( inc + 8 );
+	const __m256 dv2 = _mm256_loadu_ps( inc + 16 );
+
+	for (int i = 0; i < MIXBUFFER_SAMPLES; i += 4) {
+		const __m128 a = _mm_load_ps( samples + i * 2 + 0 );	// l0 r0 l1 r1
+		const __m128 b = _mm_load_ps( samples + i * 2 + 4 );	// l2 r2 l3 r3
+		const __m128 a0 = _mm_shuffle_ps( a, a, SIMD_R_SHUFFLEPS( 0, 1, 0, 0 ) );
+		const __m128 a1 = _mm_shuffle_ps( a, a, SIMD_R_SHUFFLEPS( 2, 2, 2, 3 ) );
+		const __m128 b0 = _mm_shuffle_ps( b, b, SIMD_R_SHUFFLEPS( 0, 1, 0, 0 ) );
+		const __m128 b1 = _mm_shuffle_ps( b, b, SIMD_R_SHUFFLEPS( 2, 2, 2, 3 ) );
+		float *mix = mixBuffer + i * 6;
+
+		_mm256_storeu_ps( mix + 0, _mm256_add_ps( _mm256_loadu_ps( mix + 0 ), _mm256_mul_ps( _mm256_insertf128_ps( _mm256_castps128_ps256( a0 ), a, 1 ), v0 ) ) );
+		_mm256_storeu_ps( mix + 8, _mm256_add_ps( _mm256_loadu_ps( mix + 8 ), _mm256_mul_ps( _mm256_insertf128_ps( _mm256_castps128_ps256( a1 ), b0, 1 ), v1 ) ) );
+		_mm256_storeu_ps( mix + 16, _mm256_add_ps( _mm256_loadu_ps( mix + 16 ), _mm256_mul_ps( _mm256_insertf128_ps( _mm256_castps128_ps256( b ), b1, 1 ), v2 ) ) );
+
+		v0 = _mm256_add_ps( v0, dv0 );
+		v1 = _mm256_add_ps( v1, dv1 );
+		v2 = _mm256_add_ps( v2, dv2 );
+	}
+#else
+	ALIGN16( float vol[12] );
+	ALIGN16( float inc[12] );
+	MixSound_InitRamp( vol, inc, 6, 2, lastV, currentV );
+
+	__m128 v0 = _mm_load_ps( vol + 0 );
+	__m128 v1 = _mm_load_ps( vol + 4 );
+	__m128 v2 = _mm_load_ps( vol + 8 );
+	const __m128 dv0 = _mm_load_ps( inc + 0 );
+	const __m128 dv1 = _mm_load_ps( inc + 4 );
+	const __m128 dv2 = _mm_load_ps( inc + 8 );
+
+	for (int i = 0; i < MIXBUFFER_SAMPLES; i += 2) {
+		const __m128 s = _mm_load_ps( samples + i * 2 );		// l0 r0 l1 r1
+		float *mix = mixBuffer + i * 6;
+
+		_mm_store_ps( mix + 0, _mm_add_ps( _mm_load_ps( mix + 0 ), _mm_mul_ps( _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 0, 1, 0, 0 ) ), v0 ) ) );
+		_mm_store_ps( mix + 4, _mm_add_ps( _mm_load_ps( mix + 4 ), _mm_mul_ps( s, v1 ) ) );
+		_mm_store_ps( mix + 8, _mm_add_ps( _mm_load_ps( mix + 8 ), _mm_mul_ps( _mm_shuffle_ps( s, s, SIMD_R_SHUFFLEPS( 2, 2, 2, 3 ) ), v2 ) ) );
+
+		v0 = _mm_add_ps( v0, dv0 );
+		v1 = _mm_add_ps( v1, dv1 );
+		v2 = _mm_add_ps( v2, dv2 );
+	}
+#endif
+}
+
+#else // SIMD_SOUND_SCALAR
+
 /*
 ============
 MixSoundTwoSpeakerMono
@@ -2089,6 +2335,8 @@ void SIMD_VPCALL idSIMDProcessor::MixSoundSixSpeakerStereo(float *mixBuffer, con
 	}
 }
 
+#endif // SIMD_SOUND_SCALAR
+
 /*
 ============
 MixedSoundToSamples
@@ -2096,7 +2344,21 @@ MixedSoundToSamples
 */
 void SIMD_VPCALL idSIMDProcessor::MixedSoundToSamples(short *samples, const float *mixBuffer, const int numSamples) {
 
-#if 1
+#if !defined( SIMD_SOUND_SCALAR )
+	const __m128 minSample = _mm_set1_ps( -32768.0f );
+	const __m128 maxSample = _mm_set1_ps( 32767.0f );
+
+	int i = 0;
+	for (; i + 8 <= numSamples; i += 8) {
+		const __m128 a = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( mixBuffer + i + 0 ), minSample ), maxSample );
+		const __m128 b = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( mixBuffer + i + 4 ), minSample ), maxSample );
+		_mm_storeu_si128( (__m128i *)( samples + i ), _mm_packs_epi32( _mm_cvttps_epi32( a ), _mm_cvttps_epi32( b ) ) );
+	}
+	for (; i < numSamples; i++) {
+		samples[i] = (short)idMath::ClampFloat( -32768.0f, 32767.0f, mixBuffer[i] );
+	}
+
+#elif 1
 	for (int i = 0; i < numSamples; i++) {
 		if (mixBuffer[i] <= -32768.0f) {
 			samples[i] = -32768;
@@ -3780,6 +4042,11 @@ void SIMD_VPCALL idSIMDProcessor::TransformVerts(idDrawVert *verts, const int nu
 	int i, j;
 	const byte *jointsPtr = (byte *)joints;
 
+	if (useAVX2) {
+		TransformVerts_AVX2(verts, numVerts, joints, weights, index, numWeights);
+		return;
+	}
+
 	for (j = i = 0; i < numVerts; i++) {
 		idVec3 v;
 
@@ -3964,6 +4231,13 @@ void SIMD_VPCALL DeriveTangentsTest(idPlane *planes, idDrawVert *verts, const in
 {
 	int i;
 
+#if USE_GENERIC_DERIVETANGENT
+	if (useAVX2) {
+		DeriveTangents_AVX2(planes, verts, numVerts, indexes, numIndexes);
+		return;
+	}
+#endif
+
 	bool *used = (bool *)_alloca16(numVerts * sizeof(used[0]));
 	memset(used, 0, numVerts * sizeof(used[0]));
 
@@ -4794,6 +5068,11 @@ tangent vectors onto the plane orthogonal to the vertex normal.
 */
 void SIMD_VPCALL idSIMDProcessor::NormalizeTangents(idDrawVert *verts, const int numVerts) {
 
+	if (useAVX2) {
+		NormalizeTangents_AVX2(verts, numVerts);
+		return;
+	}
+
 	for (int i = 0; i < numVerts; i++) {
 		idVec3 &v = verts[i].normal;
 		float f;
@@ -4902,6 +5181,10 @@ CreateShadowCache
 int SIMD_VPCALL idSIMDProcessor::CreateShadowCache(idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts) {
 	int outVerts = 0;
 
+	if (useAVX2) {
+		return CreateShadowCache_AVX2(vertexCache, vertRemap, lightOrigin, verts, numVerts);
+	}
+
 	for (int i = 0; i < numVerts; i++) {
 		if (vertRemap[i]) {
 			continue;
@@ -5134,5 +5417,304 @@ void SIMD_VPCALL idSIMDProcessor::CmpLT(byte *dst, const byte bitNum, const floa
 	}
 }
 
+/*
+===============================================================================
+
+	AVX2 / FMA3 versions, only called when idSIMDProcessor::useAVX2 is set.
+
+	idDrawVert is 60 bytes of interleaved data, so the per vertex and per
+	triangle routines gather 8 elements into registers, do the math 8 wide
+	and scatter the results back with scalar stores.
+
+===============================================================================
+*/
+
+#define DRAWVERT_FLOATS				( DRAWVERT_SIZE / 4 )
+
+/*
+============
+RSqrt_AVX2
+
+Matches idMath::RSqrt closely enough, including returning a huge number instead
+of infinity for zero so degenerate vectors end up zero instead of NaN.
+============
+*/
+SIMD_TARGET_AVX2 static SIMD_FORCE_INLINE __m256 RSqrt_AVX2( __m256 x ) {
+	x = _mm256_max_ps( x, _mm256_set1_ps( 1.175494351e-38f ) );	// smallest normalized float
+	__m256 r = _mm256_rsqrt_ps( x );
+	// one Newton-Raphson step
+	__m256 rr = _mm256_mul_ps( _mm256_mul_ps( r, r ), _mm256_mul_ps( x, _mm256_set1_ps( 0.5f ) ) );
+	return _mm256_mul_ps( r, _mm256_sub_ps( _mm256_set1_ps( 1.5f ), rr ) );
+}
+
+/*
+============
+TransformVerts_AVX2
+
+The first two rows of the joint matrix are multiplied in one 256 bit register,
+all weights of a vertex are accumulated before the rows are summed up.
+============
+*/
+SIMD_TARGET_AVX2 static void TransformVerts_AVX2( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights ) {
+	const byte *jointsPtr = (const byte *)joints;
+
+	for ( int j = 0, i = 0; i < numVerts; i++ ) {
+		__m256 rows01 = _mm256_setzero_ps();
+		__m128 row2 = _mm_setzero_ps();
+
+		do {
+			const float *mat = (const float *)( jointsPtr + index[j * 2 + 0] );
+			const __m128 w = _mm_loadu_ps( weights[j].ToFloatPtr() );
+
+			rows01 = _mm256_fmadd_ps( _mm256_loadu_ps( mat + 0 ), _mm256_set_m128( w, w ), rows01 );
+			row2 = _mm_fmadd_ps( _mm_loadu_ps( mat + 8 ), w, row2 );
+		} while ( index[j++ * 2 + 1] == 0 );
+
+		// ( r0, r1, r2, r2 )
+		__m128 r01 = _mm_hadd_ps( _mm256_castps256_ps128( rows01 ), _mm256_extractf128_ps( rows01, 1 ) );
+		__m128 r22 = _mm_hadd_ps( row2, row2 );
+		__m128 xyz = _mm_hadd_ps( r01, r22 );
+
+		float *dst = verts[i].xyz.ToFloatPtr();
+		_mm_storel_pi( (__m64 *)dst, xyz );
+		_mm_store_ss( dst + 2, _mm_movehl_ps( xyz, xyz ) );
+	}
+}
+
+/*
+============
+DeriveTangents_AVX2
+
+Computes the planes and tangents of 8 triangles at a time, the accumulation
+into the vertexes stays in triangle order to match the scalar version.
+============
+*/
+SIMD_TARGET_AVX2 static void DeriveTangents_AVX2( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	bool *used = (bool *)_alloca16( numVerts * sizeof( used[0] ) );
+	memset( used, 0, numVerts * sizeof( used[0] ) );
+
+	const float *base = (const float *)verts;
+	const __m256i triStride = _mm256_setr_epi32( 0, 3, 6, 9, 12, 15, 18, 21 );
+	const __m256i vertFloats = _mm256_set1_epi32( DRAWVERT_FLOATS );
+	const __m256 signMask = _mm256_set1_ps( -0.0f );
+
+	const int numTris = numIndexes / 3;
+	int lastIndexes[8 * 3];
+
+	for ( int t = 0; t < numTris; t += 8 ) {
+		const int count = Min( numTris - t, 8 );
+		const int *triIndexes = indexes + t * 3;
+
+		if ( count < 8 ) {
+			// repeat the last triangle to fill the registers
+			for ( int k = 0; k < 8 * 3; k++ ) {
+				lastIndexes[k] = triIndexes[Min( k / 3, count - 1 ) * 3 + k % 3];
+			}
+			triIndexes = lastIndexes;
+		}
+
+		const __m256i ia = _mm256_mullo_epi32( _mm256_i32gather_epi32( triIndexes + 0, triStride, 4 ), vertFloats );
+		const __m256i ib = _mm256_mullo_epi32( _mm256_i32gather_epi32( triIndexes + 1, triStride, 4 ), vertFloats );
+		const __m256i ic = _mm256_mullo_epi32( _mm256_i32gather_epi32( triIndexes + 2, triStride, 4 ), vertFloats );
+
+		const __m256 ax = _mm256_i32gather_ps( base + 0, ia, 4 );
+		const __m256 ay = _mm256_i32gather_ps( base + 1, ia, 4 );
+		const __m256 az = _mm256_i32gather_ps( base + 2, ia, 4 );
+		const __m256 as = _mm256_i32gather_ps( base + 3, ia, 4 );
+		const __m256 at = _mm256_i32gather_ps( base + 4, ia, 4 );
+
+		const __m256 d0x = _mm256_sub_ps( _mm256_i32gather_ps( base + 0, ib, 4 ), ax );
+		const __m256 d0y = _mm256_sub_ps( _mm256_i32gather_ps( base + 1, ib, 4 ), ay );
+		const __m256 d0z = _mm256_sub_ps( _mm256_i32gather_ps( base + 2, ib, 4 ), az );
+		const __m256 d0s = _mm256_sub_ps( _mm256_i32gather_ps( base + 3, ib, 4 ), as );
+		const __m256 d0t = _mm256_sub_ps( _mm256_i32gather_ps( base + 4, ib, 4 ), at );
+
+		const __m256 d1x = _mm256_sub_ps( _mm256_i32gather_ps( base + 0, ic, 4 ), ax );
+		const __m256 d1y = _mm256_sub_ps( _mm256_i32gather_ps( base + 1, ic, 4 ), ay );
+		const __m256 d1z = _mm256_sub_ps( _mm256_i32gather_ps( base + 2, ic, 4 ), az );
+		const __m256 d1s = _mm256_sub_ps( _mm256_i32gather_ps( base + 3, ic, 4 ), as );
+		const __m256 d1t = _mm256_sub_ps( _mm256_i32gather_ps( base + 4, ic, 4 ), at );
+
+		// normal
+		__m256 nx = _mm256_fmsub_ps( d1y, d0z, _mm256_mul_ps( d1z, d0y ) );
+		__m256 ny = _mm256_fmsub_ps( d1z, d0x, _mm256_mul_ps( d1x, d0z ) );
+		__m256 nz = _mm256_fmsub_ps( d1x, d0y, _mm256_mul_ps( d1y, d0x ) );
+
+		__m256 f = RSqrt_AVX2( _mm256_fmadd_ps( nx, nx, _mm256_fmadd_ps( ny, ny, _mm256_mul_ps( nz, nz ) ) ) );
+		nx = _mm256_mul_ps( nx, f );
+		ny = _mm256_mul_ps( ny, f );
+		nz = _mm256_mul_ps( nz, f );
+
+		const __m256 dist = _mm256_xor_ps( _mm256_fmadd_ps( nx, ax, _mm256_fmadd_ps( ny, ay, _mm256_mul_ps( nz, az ) ) ), signMask );
+
+		// area sign bit
+		const __m256 signBit = _mm256_and_ps( _mm256_fmsub_ps( d0s, d1t, _mm256_mul_ps( d0t, d1s ) ), signMask );
+
+		// first tangent
+		__m256 t0x = _mm256_fmsub_ps( d0x, d1t, _mm256_mul_ps( d0t, d1x ) );
+		__m256 t0y = _mm256_fmsub_ps( d0y, d1t, _mm256_mul_ps( d0t, d1y ) );
+		__m256 t0z = _mm256_fmsub_ps( d0z, d1t, _mm256_mul_ps( d0t, d1z ) );
+
+		f = _mm256_xor_ps( RSqrt_AVX2( _mm256_fmadd_ps( t0x, t0x, _mm256_fmadd_ps( t0y, t0y, _mm256_mul_ps( t0z, t0z ) ) ) ), signBit );
+		t0x = _mm256_mul_ps( t0x, f );
+		t0y = _mm256_mul_ps( t0y, f );
+		t0z = _mm256_mul_ps( t0z, f );
+
+		// second tangent
+		__m256 t1x = _mm256_fmsub_ps( d0s, d1x, _mm256_mul_ps( d0x, d1s ) );
+		__m256 t1y = _mm256_fmsub_ps( d0s, d1y, _mm256_mul_ps( d0y, d1s ) );
+		__m256 t1z = _mm256_fmsub_ps( d0s, d1z, _mm256_mul_ps( d0z, d1s ) );
+
+		f = _mm256_xor_ps( RSqrt_AVX2( _mm256_fmadd_ps( t1x, t1x, _mm256_fmadd_ps( t1y, t1y, _mm256_mul_ps( t1z, t1z ) ) ) ), signBit );
+		t1x = _mm256_mul_ps( t1x, f );
+		t1y = _mm256_mul_ps( t1y, f );
+		t1z = _mm256_mul_ps( t1z, f );
+
+		float out[10][8];
+		_mm256_storeu_ps( out[0], nx );
+		_mm256_storeu_ps( out[1], ny );
+		_mm256_storeu_ps( out[2], nz );
+		_mm256_storeu_ps( out[3], dist );
+		_mm256_storeu_ps( out[4], t0x );
+		_mm256_storeu_ps( out[5], t0y );
+		_mm256_storeu_ps( out[6], t0z );
+		_mm256_storeu_ps( out[7], t1x );
+		_mm256_storeu_ps( out[8], t1y );
+		_mm256_storeu_ps( out[9], t1z );
+
+		for ( int k = 0; k < count; k++ ) {
+			idPlane &plane = planes[t + k];
+			plane[0] = out[0][k];
+			plane[1] = out[1][k];
+			plane[2] = out[2][k];
+			plane[3] = out[3][k];
+
+			for ( int l = 0; l < 3; l++ ) {
+				const int v = indexes[( t + k ) * 3 + l];
+				idDrawVert *dv = verts + v;
+
+				if ( used[v] ) {
+					dv->normal[0] += out[0][k];		dv->normal[1] += out[1][k];		dv->normal[2] += out[2][k];
+					dv->tangents[0][0] += out[4][k];	dv->tangents[0][1] += out[5][k];	dv->tangents[0][2] += out[6][k];
+					dv->tangents[1][0] += out[7][k];	dv->tangents[1][1] += out[8][k];	dv->tangents[1][2] += out[9][k];
+				} else {
+					dv->normal[0] = out[0][k];		dv->normal[1] = out[1][k];		dv->normal[2] = out[2][k];
+					dv->tangents[0][0] = out[4][k];	dv->tangents[0][1] = out[5][k];	dv->tangents[0][2] = out[6][k];
+					dv->tangents[1][0] = out[7][k];	dv->tangents[1][1] = out[8][k];	dv->tangents[1][2] = out[9][k];
+					used[v] = true;
+				}
+			}
+		}
+	}
+}
+
+/*
+============
+NormalizeTangents_AVX2
+
+A partial last block repeats the last vertex, which is harmless because all
+lanes are gathered before anything is written back.
+============
+*/
+SIMD_TARGET_AVX2 static void NormalizeTangents_AVX2( idDrawVert *verts, const int numVerts ) {
+	float *base = (float *)verts;
+	const __m256i lanes = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+	const __m256i vertFloats = _mm256_set1_epi32( DRAWVERT_FLOATS );
+
+	for ( int i = 0; i < numVerts; i += 8 ) {
+		const int count = Min( numVerts - i, 8 );
+		const __m256i vi = _mm256_min_epi32( _mm256_add_epi32( _mm256_set1_epi32( i ), lanes ), _mm256_set1_epi32( numVerts - 1 ) );
+		const __m256i offset = _mm256_mullo_epi32( vi, vertFloats );
+
+		__m256 nx = _mm256_i32gather_ps( base + 5, offset, 4 );
+		__m256 ny = _mm256_i32gather_ps( base + 6, offset, 4 );
+		__m256 nz = _mm256_i32gather_ps( base + 7, offset, 4 );
+
+		__m256 f = RSqrt_AVX2( _mm256_fmadd_ps( nx, nx, _mm256_fmadd_ps( ny, ny, _mm256_mul_ps( nz, nz ) ) ) );
+		nx = _mm256_mul_ps( nx, f );
+		ny = _mm256_mul_ps( ny, f );
+		nz = _mm256_mul_ps( nz, f );
+
+		float out[9][8];
+		_mm256_storeu_ps( out[0], nx );
+		_mm256_storeu_ps( out[1], ny );
+		_mm256_storeu_ps( out[2], nz );
+
+		for ( int j = 0; j < 2; j++ ) {
+			const int tangentFloat = 8 + j * 3;
+
+			__m256 tx = _mm256_i32gather_ps( base + tangentFloat + 0, offset, 4 );
+			__m256 ty = _mm256_i32gather_ps( base + tangentFloat + 1, offset, 4 );
+			__m256 tz = _mm256_i32gather_ps( base + tangentFloat + 2, offset, 4 );
+
+			// project onto the plane orthogonal to the normal
+			const __m256 d = _mm256_fmadd_ps( tx, nx, _mm256_fmadd_ps( ty, ny, _mm256_mul_ps( tz, nz ) ) );
+			tx = _mm256_fnmadd_ps( d, nx, tx );
+			ty = _mm256_fnmadd_ps( d, ny, ty );
+			tz = _mm256_fnmadd_ps( d, nz, tz );
+
+			f = RSqrt_AVX2( _mm256_fmadd_ps( tx, tx, _mm256_fmadd_ps( ty, ty, _mm256_mul_ps( tz, tz ) ) ) );
+			_mm256_storeu_ps( out[3 + j * 3 + 0], _mm256_mul_ps( tx, f ) );
+			_mm256_storeu_ps( out[3 + j * 3 + 1], _mm256_mul_ps( ty, f ) );
+			_mm256_storeu_ps( out[3 + j * 3 + 2], _mm256_mul_ps( tz, f ) );
+		}
+
+		for ( int k = 0; k < count; k++ ) {
+			float *dst = base + ( i + k ) * DRAWVERT_FLOATS + 5;
+			for ( int l = 0; l < 9; l++ ) {
+				dst[l] = out[l][k];
+			}
+		}
+	}
+}
+
+/*
+============
+CreateShadowCache_AVX2
+
+Skips 8 already remapped vertexes with a single compare, both cache vertexes
+of a new one are written with one 256 bit store.
+============
+*/
+SIMD_TARGET_AVX2 static int CreateShadowCache_AVX2( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) {
+	int outVerts = 0;
+
+	const __m128 lightOrg = _mm_setr_ps( lightOrigin[0], lightOrigin[1], lightOrigin[2], 0.0f );
+	const __m128 wOne = _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f );
+	const __m128 xyzMask = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+
+	int i = 0;
+	for ( ; i < numVerts; i += 8 ) {
+		int newMask;
+
+		if ( i + 8 <= numVerts ) {
+			const __m256i remap = _mm256_loadu_si256( (const __m256i *)( vertRemap + i ) );
+			newMask = _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( remap, _mm256_setzero_si256() ) ) );
+		} else {
+			newMask = 0;
+			for ( int k = 0; i + k < numVerts; k++ ) {
+				newMask |= ( vertRemap[i + k] == 0 ) << k;
+			}
+		}
+
+		for ( int k = 0; newMask != 0; k++, newMask >>= 1 ) {
+			if ( ( newMask & 1 ) == 0 ) {
+				continue;
+			}
+
+			// the fourth float is st[0], masked away
+			const __m128 xyz = _mm_and_ps( _mm_loadu_ps( verts[i + k].xyz.ToFloatPtr() ), xyzMask );
+
+			// R_SetupProjection() builds the projection matrix with a slight crunch
+			// for depth, which keeps this w=0 division from rasterizing right at the
+			// wrap around point and causing depth fighting with the rear caps
+			_mm256_storeu_ps( vertexCache[outVerts].ToFloatPtr(), _mm256_set_m128( _mm_sub_ps( xyz, lightOrg ), _mm_or_ps( xyz, wOne ) ) );
+			vertRemap[i + k] = outVerts;
+			outVerts += 2;
+		}
+	}
+	return outVerts;
+}
+
 
 #endif // __BLENDO_SIMD_INLINE__
\ No newline at end of file
@@ -36,6 +36,14 @@ If you have questions concerning this license or the applicable additional terms
 #define SIMD_VPCALL
 #endif
 
+// lets a function use AVX2 and FMA3 intrinsics without building the whole module for them,
+// callers have to check idSIMDProcessor::useAVX2 first
+#if defined(__GNUC__)
+#define SIMD_TARGET_AVX2				__attribute__((target("avx2,fma")))
+#else
+#define SIMD_TARGET_AVX2
+#endif
+
 #define SIMD_INLINE						inline
 #define SIMD_INLINE_EXTERN				static inline //extern inline
 #ifdef _WIN32
@@ -311,7 +319,11 @@ class idSIMDProcessor {
 public:
 
 	const int cpuid = (CPUID_MMX) & (CPUID_SSE) & (CPUID_SSE2) & (CPUID_SSE3);
-	const char* SIMD_VPCALL GetName() { return "Blendo SIMD Inlined"; }
+	const char* SIMD_VPCALL GetName() { return useAVX2 ? "Blendo SIMD Inlined + AVX2" : "Blendo SIMD Inlined"; }
+
+	// set by idSIMD::InitProcessor, selects the AVX2 / FMA3 versions of the skinning,
+	// tangent and shadow cache routines
+	bool useAVX2 = false;
 
 	idSIMDProcessor() {}
 	~idSIMDProcessor() {};
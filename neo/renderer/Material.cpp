@@ -2488,6 +2488,398 @@ bool idMaterial::Parse(const char* text, const int textLength) {
 	return true;
 }
 
+/*
+===================
+WriteImageReference
+
+images are stored by name with the parameters they were loaded with and looked up
+again when the material is read back
+===================
+*/
+static void WriteImageReference( idFile *f, const idImage *image ) {
+	if ( image == NULL ) {
+		f->WriteString( "" );
+		return;
+	}
+	f->WriteString( image->imgName );
+	// built in images are created at startup and only looked up by name
+	f->WriteBool( image->generatorFunction != NULL );
+	f->WriteInt( image->filter );
+	f->WriteBool( image->allowDownSize );
+	f->WriteInt( image->repeat );
+	f->WriteInt( image->depth );
+	f->WriteInt( image->cubeFiles );
+}
+
+/*
+===================
+ReadImageReference
+===================
+*/
+static bool ReadImageReference( idFile *f, idImage *&image ) {
+	idStr	name;
+	bool	generated, allowDownSize;
+	int		filter, repeat, depth, cubeFiles;
+
+	image = NULL;
+	f->ReadString( name );
+	if ( name.Length() == 0 ) {
+		return true;
+	}
+	f->ReadBool( generated );
+	f->ReadInt( filter );
+	f->ReadBool( allowDownSize );
+	f->ReadInt( repeat );
+	f->ReadInt( depth );
+	f->ReadInt( cubeFiles );
+	if ( generated ) {
+		image = globalImages->GetImage( name );
+	} else {
+		image = globalImages->ImageFromFile( name, (textureFilter_t)filter, allowDownSize, (textureRepeat_t)repeat, (textureDepth_t)depth, (cubeFiles_t)cubeFiles );
+	}
+	return ( image != NULL );
+}
+
+/*
+===================
+idMaterial::WriteBinary
+
+The parsed material without the images, guis and decls it references, those are
+written by name and found again on load. Table indexes in the ops are replaced by
+the table names as the indexes depend on the order the decls were registered in.
+Materials with a videomap or soundmap have no binary form.
+===================
+*/
+bool idMaterial::WriteBinary( idFile *f, idList<const idDecl *> &dependencies ) const {
+	int i, j;
+
+	for ( i = 0; i < numStages; i++ ) {
+		if ( stages[i].texture.cinematic != NULL ) {
+			return false;
+		}
+		if ( stages[i].newStage != NULL && ( stages[i].newStage->megaTexture != NULL ||
+				stages[i].newStage->vertexProgram != 0 || stages[i].newStage->fragmentProgram != 0 ) ) {
+			return false;
+		}
+	}
+
+	// the stage image parameters depend on it
+	f->WriteInt( globalImages->image_ignoreHighQuality.GetInteger() );
+
+	f->WriteString( desc );
+	f->WriteString( renderBump );
+	WriteImageReference( f, lightFalloffImage );
+	f->WriteInt( entityGui );
+	f->WriteString( gui != NULL ? gui->Name() : "" );
+	f->WriteBool( noFog );
+	f->WriteInt( spectrum );
+	f->WriteFloat( polygonOffset );
+	f->WriteInt( contentFlags );
+	f->WriteInt( surfaceFlags );
+	f->WriteInt( materialFlags );
+
+	f->WriteInt( decalInfo.stayTime );
+	f->WriteInt( decalInfo.fadeTime );
+	for ( i = 0; i < 4; i++ ) {
+		f->WriteFloat( decalInfo.start[i] );
+		f->WriteFloat( decalInfo.end[i] );
+	}
+
+	f->WriteFloat( sort );
+	f->WriteInt( deform );
+	for ( i = 0; i < 4; i++ ) {
+		f->WriteInt( deformRegisters[i] );
+	}
+	f->WriteInt( deformDecl != NULL ? deformDecl->GetType() : -1 );
+	f->WriteString( deformDecl != NULL ? deformDecl->GetName() : "" );
+	for ( i = 0; i < MAX_TEXGEN_REGISTERS; i++ ) {
+		f->WriteInt( texGenRegisters[i] );
+	}
+
+	f->WriteInt( coverage );
+	f->WriteInt( cullType );
+	f->WriteBool( shouldCreateBackSides );
+	f->WriteBool( fogLight );
+	f->WriteBool( blendLight );
+	f->WriteBool( ambientLight );
+	f->WriteBool( unsmoothedTangents );
+	f->WriteBool( hasSubview );
+	f->WriteBool( allowOverlays );
+	f->WriteBool( sampleFromCentre );
+
+	f->WriteInt( numOps );
+	for ( i = 0; i < numOps; i++ ) {
+		const expOp_t *op = &ops[i];
+		f->WriteInt( op->opType );
+		if ( op->opType == OP_TYPE_TABLE ) {
+			f->WriteString( declManager->DeclByIndex( DECL_TABLE, op->a, false )->GetName() );
+		} else {
+			f->WriteInt( op->a );
+		}
+		f->WriteInt( op->b );
+		f->WriteInt( op->c );
+	}
+
+	f->WriteInt( numRegisters );
+	for ( i = 0; i < numRegisters; i++ ) {
+		f->WriteFloat( expressionRegisters[i] );
+	}
+	f->WriteBool( constantRegisters != NULL );
+
+	f->WriteInt( numStages );
+	f->WriteInt( numAmbientStages );
+	for ( i = 0; i < numStages; i++ ) {
+		const shaderStage_t *ss = &stages[i];
+		f->WriteInt( ss->conditionRegister );
+		f->WriteInt( ss->lighting );
+		f->WriteInt( ss->drawStateBits );
+		for ( j = 0; j < 4; j++ ) {
+			f->WriteInt( ss->color.registers[j] );
+		}
+		f->WriteBool( ss->hasAlphaTest );
+		f->WriteInt( ss->alphaTestRegister );
+
+		const textureStage_t *ts = &ss->texture;
+		WriteImageReference( f, ts->image );
+		f->WriteInt( ts->texgen );
+		f->WriteBool( ts->hasMatrix );
+		for ( j = 0; j < 6; j++ ) {
+			f->WriteInt( ts->matrix[j / 3][j % 3] );
+		}
+		f->WriteInt( ts->dynamic );
+		f->WriteInt( ts->width );
+		f->WriteInt( ts->height );
+		f->WriteInt( ts->dynamicFrameCount );
+
+		f->WriteInt( ss->vertexColor );
+		f->WriteBool( ss->ignoreAlphaTest );
+		f->WriteFloat( ss->privatePolygonOffset );
+
+		const newShaderStage_t *newStage = ss->newStage;
+		f->WriteBool( newStage != NULL );
+		if ( newStage != NULL ) {
+			f->WriteInt( newStage->numVertexParms );
+			for ( j = 0; j < newStage->numVertexParms * 4; j++ ) {
+				f->WriteInt( newStage->vertexParms[j / 4][j % 4] );
+			}
+			f->WriteInt( newStage->numFragmentProgramImages );
+			for ( j = 0; j < newStage->numFragmentProgramImages; j++ ) {
+				WriteImageReference( f, newStage->fragmentProgramImages[j] );
+			}
+			f->WriteString( newStage->glslName != NULL ? newStage->glslName->c_str() : "" );
+		}
+	}
+
+	f->WriteString( editorImageName );
+	f->WriteFloat( editorAlpha );
+	f->WriteBool( suppressInSubview );
+	f->WriteBool( portalSky );
+
+	return true;
+}
+
+/*
+===================
+idMaterial::ReadBinary
+===================
+*/
+bool idMaterial::ReadBinary( idFile *f ) {
+	int		i, j, value, ignoreHighQuality, deformType;
+	bool	isConstant, hasNewStage;
+	idStr	name;
+
+	// reset to the unparsed state
+	CommonInit();
+
+	f->ReadInt( ignoreHighQuality );
+	if ( ignoreHighQuality != globalImages->image_ignoreHighQuality.GetInteger() ) {
+		return false;
+	}
+
+	f->ReadString( desc );
+	f->ReadString( renderBump );
+	if ( !ReadImageReference( f, lightFalloffImage ) ) {
+		return false;
+	}
+	f->ReadInt( entityGui );
+	f->ReadString( name );
+	if ( name.Length() ) {
+		gui = uiManager->FindGui( name, true );
+	}
+	f->ReadBool( noFog );
+	f->ReadInt( spectrum );
+	f->ReadFloat( polygonOffset );
+	f->ReadInt( contentFlags );
+	f->ReadInt( surfaceFlags );
+	f->ReadInt( materialFlags );
+
+	f->ReadInt( decalInfo.stayTime );
+	f->ReadInt( decalInfo.fadeTime );
+	for ( i = 0; i < 4; i++ ) {
+		f->ReadFloat( decalInfo.start[i] );
+		f->ReadFloat( decalInfo.end[i] );
+	}
+
+	f->ReadFloat( sort );
+	f->ReadInt( value );
+	deform = (deform_t)value;
+	for ( i = 0; i < 4; i++ ) {
+		f->ReadInt( deformRegisters[i] );
+	}
+	f->ReadInt( deformType );
+	f->ReadString( name );
+	if ( deformType >= 0 ) {
+		deformDecl = declManager->FindType( (declType_t)deformType, name, true );
+	}
+	for ( i = 0; i < MAX_TEXGEN_REGISTERS; i++ ) {
+		f->ReadInt( texGenRegisters[i] );
+	}
+
+	f->ReadInt( value );
+	SetCoverage( (materialCoverage_t)value );
+	f->ReadInt( value );
+	cullType = (cullType_t)value;
+	f->ReadBool( shouldCreateBackSides );
+	f->ReadBool( fogLight );
+	f->ReadBool( blendLight );
+	f->ReadBool( ambientLight );
+	f->ReadBool( unsmoothedTangents );
+	f->ReadBool( hasSubview );
+	f->ReadBool( allowOverlays );
+	f->ReadBool( sampleFromCentre );
+
+	f->ReadInt( value );
+	if ( value < 0 || value > MAX_EXPRESSION_OPS ) {
+		return false;
+	}
+	if ( value ) {
+		ops = (expOp_t *)R_ClearedStaticAlloc( value * sizeof( ops[0] ) );
+		numOps = value;
+	}
+	for ( i = 0; i < numOps; i++ ) {
+		expOp_t *op = &ops[i];
+		f->ReadInt( value );
+		op->opType = (expOpType_t)value;
+		if ( op->opType == OP_TYPE_TABLE ) {
+			f->ReadString( name );
+			const idDecl *table = declManager->FindType( DECL_TABLE, name, false );
+			if ( table == NULL ) {
+				return false;
+			}
+			op->a = table->Index();
+		} else {
+			f->ReadInt( op->a );
+		}
+		f->ReadInt( op->b );
+		f->ReadInt( op->c );
+	}
+
+	f->ReadInt( value );
+	if ( value < 0 || value > MAX_EXPRESSION_REGISTERS ) {
+		return false;
+	}
+	if ( value ) {
+		expressionRegisters = (float *)R_StaticAlloc( value * sizeof( expressionRegisters[0] ) );
+		numRegisters = value;
+	}
+	for ( i = 0; i < numRegisters; i++ ) {
+		f->ReadFloat( expressionRegisters[i] );
+	}
+	f->ReadBool( isConstant );
+
+	f->ReadInt( value );
+	if ( value < 0 || value > MAX_SHADER_STAGES ) {
+		return false;
+	}
+	if ( value ) {
+		// cleared so FreeData() can clean up a stage that was read halfway
+		stages = (shaderStage_t *)R_ClearedStaticAlloc( value * sizeof( stages[0] ) );
+		numStages = value;
+	}
+	f->ReadInt( numAmbientStages );
+	for ( i = 0; i < numStages; i++ ) {
+		shaderStage_t *ss = &stages[i];
+		f->ReadInt( ss->conditionRegister );
+		f->ReadInt( value );
+		ss->lighting = (stageLighting_t)value;
+		f->ReadInt( ss->drawStateBits );
+		for ( j = 0; j < 4; j++ ) {
+			f->ReadInt( ss->color.registers[j] );
+		}
+		f->ReadBool( ss->hasAlphaTest );
+		f->ReadInt( ss->alphaTestRegister );
+
+		textureStage_t *ts = &ss->texture;
+		if ( !ReadImageReference( f, ts->image ) ) {
+			return false;
+		}
+		f->ReadInt( value );
+		ts->texgen = (texgen_t)value;
+		f->ReadBool( ts->hasMatrix );
+		for ( j = 0; j < 6; j++ ) {
+			f->ReadInt( ts->matrix[j / 3][j % 3] );
+		}
+		f->ReadInt( value );
+		ts->dynamic = (dynamicidImage_t)value;
+		f->ReadInt( ts->width );
+		f->ReadInt( ts->height );
+		f->ReadInt( ts->dynamicFrameCount );
+
+		f->ReadInt( value );
+		ss->vertexColor = (stageVertexColor_t)value;
+		f->ReadBool( ss->ignoreAlphaTest );
+		f->ReadFloat( ss->privatePolygonOffset );
+
+		f->ReadBool( hasNewStage );
+		if ( hasNewStage ) {
+			newShaderStage_t *newStage = (newShaderStage_t *)Mem_ClearedAlloc( sizeof( *newStage ) );
+			ss->newStage = newStage;
+			f->ReadInt( newStage->numVertexParms );
+			if ( newStage->numVertexParms < 0 || newStage->numVertexParms > MAX_VERTEX_PARMS ) {
+				return false;
+			}
+			for ( j = 0; j < newStage->numVertexParms * 4; j++ ) {
+				f->ReadInt( newStage->vertexParms[j / 4][j % 4] );
+			}
+			f->ReadInt( newStage->numFragmentProgramImages );
+			if ( newStage->numFragmentProgramImages < 0 || newStage->numFragmentProgramImages > MAX_FRAGMENT_IMAGES ) {
+				return false;
+			}
+			for ( j = 0; j < newStage->numFragmentProgramImages; j++ ) {
+				if ( !ReadImageReference( f, newStage->fragmentProgramImages[j] ) ) {
+					return false;
+				}
+			}
+			f->ReadString( name );
+			if ( name.Length() ) {
+				if ( !R_FindGLSLProgram( name ) ) {
+					return false;
+				}
+				newStage->glslName = new idStr( name );
+			}
+		}
+	}
+
+	f->ReadString( editorImageName );
+	f->ReadFloat( editorAlpha );
+	f->ReadBool( suppressInSubview );
+	f->ReadBool( portalSky );
+	if ( f->Tell() != f->Length() ) {
+		return false;
+	}
+
+	if ( isConstant ) {
+		EvaluateConstantRegisters();
+	}
+
+	// if we are doing an fs_copyfiles, also reference the editorImage
+	if ( cvarSystem->GetCVarInteger( "fs_copyFiles" ) ) {
+		GetEditorImage();
+	}
+
+	return true;
+}
+
 /*
 ===================
 idMaterial::Print
@@ -2788,7 +3180,15 @@ void idMaterial::CheckForConstantRegisters() {
 	if ( !pd->registersAreConstant ) {
 		return;
 	}
+	EvaluateConstantRegisters();
+}
 
+/*
+==================
+idMaterial::EvaluateConstantRegisters
+==================
+*/
+void idMaterial::EvaluateConstantRegisters() {
 	// evaluate the registers once, and save them
 	constantRegisters = (float *)R_ClearedStaticAlloc( GetNumRegisters() * sizeof( float ) );
 
@@ -375,6 +375,8 @@ public:
 	virtual bool		Parse( const char *text, const int textLength );
 	virtual void		FreeData( void );
 	virtual void		Print( void ) const;
+	virtual bool		WriteBinary( idFile *f, idList<const idDecl *> &dependencies ) const;
+	virtual bool		ReadBinary( idFile *f );
 
 	//BSM Nerve: Added fors material editor
 	bool				Save( const char *fileName = NULL );
@@ -647,6 +649,7 @@ private:
 	void				SortInteractionStages();
 	void				AddImplicitStages( const textureRepeat_t trpDefault = TR_REPEAT );
 	void				CheckForConstantRegisters();
+	void				EvaluateConstantRegisters();
 
 private:
 	idStr				desc;				// description
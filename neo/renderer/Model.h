@@ -47,6 +47,18 @@ If you have questions concerning this license or the applicable additional terms
 #define MD5_CAMERA_EXT			"md5camera"
 #define MD5_VERSION				10
 
+// preparsed binary versions of md5 meshes and anims, written to fs_savepath
+#define MD5_CACHE_DIR			"generated/md5"
+#define MD5_MESH_CACHE_EXT		"bmd5mesh"
+#define MD5_ANIM_CACHE_EXT		"bmd5anim"
+#define MD5_CACHE_MAGIC			( ( 'B' << 24 ) | ( 'M' << 16 ) | ( 'D' << 8 ) | '5' )
+
+ID_INLINE void MD5_CacheFileName( const char *fileName, const char *extension, idStr &cacheName ) {
+	cacheName = MD5_CACHE_DIR "/";
+	cacheName += fileName;
+	cacheName.SetFileExtension( extension );
+}
+
 // using shorts for triangle indexes can save a significant amount of traffic, but
 // to support the large models that renderBump loads, they need to be 32 bits
 #if 1
@@ -44,6 +44,7 @@ public:
 	virtual void			Shutdown();
 	virtual idRenderModel *	AllocModel();
 	virtual void			FreeModel( idRenderModel *model );
+	virtual idRenderModel *	LoadUnregisteredModel( const char *modelName );
 	virtual idRenderModel *	FindModel( const char *modelName );
 	virtual idRenderModel *	CheckModel( const char *modelName );
 	virtual idRenderModel *	DefaultModel();
@@ -396,6 +397,20 @@ void idRenderModelManagerLocal::FreeModel( idRenderModel *model ) {
 	delete model;
 }
 
+/*
+=================
+idRenderModelManagerLocal::LoadUnregisteredModel
+=================
+*/
+idRenderModel *idRenderModelManagerLocal::LoadUnregisteredModel( const char *modelName ) {
+	if ( !idStr::CheckExtension( modelName, "." MD5_MESH_EXT ) ) {
+		return NULL;
+	}
+	idRenderModel *model = new idRenderModelMD5;
+	model->InitFromFile( modelName );
+	return model;
+}
+
 /*
 =================
 idRenderModelManagerLocal::FindModel
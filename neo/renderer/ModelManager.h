@@ -64,6 +64,11 @@ public:
 	// frees a render model
 	virtual void			FreeModel( idRenderModel *model ) = 0;
 
+	// loads an md5 mesh into a model that is not registered with the manager,
+	// returns NULL for other model types. Free the model with FreeModel.
+	// used to rebuild and time the binary md5 caches
+	virtual idRenderModel *	LoadUnregisteredModel( const char *modelName ) = 0;
+
 	// returns NULL if modelName is NULL or an empty string, otherwise
 	// it will create a default model if not loadable
 	virtual	idRenderModel *	FindModel( const char *modelName ) = 0;
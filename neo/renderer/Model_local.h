@@ -145,8 +145,10 @@ public:
 								idMD5Mesh();
 								~idMD5Mesh();
 
-	void						ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints );
+	void						ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints, idFile *cacheFile );
+	bool						LoadMeshFromCache( idFile *file, int numJoints, const idJointMat *joints );
 	void						UpdateSurface( const struct renderEntity_s *ent, const idJointMat *joints, modelSurface_t *surf );
+	void						SkinSurface( srfTriangles_t *tri, const idJointMat *joints, float skinScale );
 	idBounds					CalcBounds( const idJointMat *joints );
 	int							NearestJoint( int a, int b, int c ) const;
 	int							NumVerts( void ) const;
@@ -165,6 +167,7 @@ private:
 
 	void						TransformVerts( idDrawVert *verts, const idJointMat *joints );
 	void						TransformScaledVerts( idDrawVert *verts, const idJointMat *joints, float scale );
+	void						FinishMesh( const idList<int> &tris, const idJointMat *joints );
 };
 
 class idRenderModelMD5 : public idRenderModelStatic {
@@ -195,6 +198,7 @@ private:
 	void						GetFrameBounds( const renderEntity_t *ent, idBounds &bounds ) const;
 	void						DrawJoints( const renderEntity_t *ent, const struct viewDef_s *view ) const;
 	void						ParseJoint( idLexer &parser, idMD5Joint *joint, idJointQuat *defaultPose );
+	bool						LoadModelFromCache( ID_TIME_T sourceTimeStamp, int sourceLength );
 };
 
 /*
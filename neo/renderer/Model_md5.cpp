@@ -34,6 +34,9 @@ If you have questions concerning this license or the applicable additional terms
 
 static const char *MD5_SnapshotName = "_MD5_Snapshot_";
 
+// bump when the layout written by idRenderModelMD5::LoadModel changes
+static const int MD5_MESH_CACHE_VERSION = 1;
+
 /***********************************************************************
 
 	idMD5Mesh
@@ -44,6 +47,20 @@ static int c_numVerts = 0;
 static int c_numWeights = 0;
 static int c_numWeightJoints = 0;
 
+typedef struct md5SkinJob_s {
+	idMD5Mesh *					mesh;
+	const idJointMat *			joints;
+	float						skinScale;
+	srfTriangles_t *			tri;
+	idRenderModelStatic *		staticModel;
+} md5SkinJob_t;
+
+// while set, idMD5Mesh::UpdateSurface only allocates the surface and queues the
+// vertex transform, which R_FinishDeferredSkinning then runs on the job workers
+static bool					md5DeferSkinning = false;
+static idList<md5SkinJob_t>	md5SkinJobs;
+static idJobList *			md5SkinJobList = NULL;
+
 typedef struct vertexWeight_s {
 	int							vert;
 	int							joint;
@@ -84,7 +101,7 @@ idMD5Mesh::~idMD5Mesh() {
 idMD5Mesh::ParseMesh
 ====================
 */
-void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints ) {
+void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints, idFile *cacheFile ) {
 	idToken		token;
 	idToken		name;
 	int			num;
@@ -223,6 +240,103 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 
 	parser.ExpectTokenString( "}" );
 
+	// store the parsed mesh, the layout must match LoadMeshFromCache
+	if ( cacheFile != NULL ) {
+		cacheFile->WriteString( shaderName );
+		cacheFile->WriteInt( texCoords.Num() );
+		for ( i = 0; i < texCoords.Num(); i++ ) {
+			cacheFile->WriteVec2( texCoords[i] );
+		}
+		cacheFile->WriteInt( numWeights );
+		for ( i = 0; i < numWeights; i++ ) {
+			cacheFile->WriteVec4( scaledWeights[i] );
+		}
+		for ( i = 0; i < numWeights * 2; i++ ) {
+			cacheFile->WriteInt( weightIndex[i] );
+		}
+		cacheFile->WriteInt( tris.Num() );
+		for ( i = 0; i < tris.Num(); i++ ) {
+			cacheFile->WriteInt( tris[i] );
+		}
+	}
+
+	FinishMesh( tris, joints );
+}
+
+/*
+====================
+idMD5Mesh::LoadMeshFromCache
+
+reads a mesh written by ParseMesh, returns false if the cache is damaged
+====================
+*/
+bool idMD5Mesh::LoadMeshFromCache( idFile *file, int numJoints, const idJointMat *joints ) {
+	idStr		shaderName;
+	idList<int>	tris;
+	int			num;
+	int			remaining;
+	int			i;
+
+	file->ReadString( shaderName );
+	shader = declManager->FindMaterial( shaderName );
+
+	// sizes are checked against the remaining data so a truncated file can't trigger huge allocations
+	remaining = file->Length() - file->Tell();
+	file->ReadInt( num );
+	if ( num <= 0 || num * (int)sizeof( idVec2 ) > remaining ) {
+		return false;
+	}
+	texCoords.SetNum( num );
+	file->Read( texCoords.Ptr(), num * sizeof( idVec2 ) );
+	LittleRevBytes( texCoords.Ptr(), sizeof( float ), num * 2 );
+
+	remaining = file->Length() - file->Tell();
+	file->ReadInt( num );
+	if ( num <= 0 || num * (int)( sizeof( idVec4 ) + 2 * sizeof( int ) ) > remaining ) {
+		return false;
+	}
+	numWeights = num;
+	scaledWeights = (idVec4 *) Mem_Alloc16( numWeights * sizeof( scaledWeights[0] ) );
+	weightIndex = (int *) Mem_Alloc16( numWeights * 2 * sizeof( weightIndex[0] ) );
+	file->Read( scaledWeights, numWeights * sizeof( scaledWeights[0] ) );
+	file->Read( weightIndex, numWeights * 2 * sizeof( weightIndex[0] ) );
+	LittleRevBytes( scaledWeights, sizeof( float ), numWeights * 4 );
+	LittleRevBytes( weightIndex, sizeof( int ), numWeights * 2 );
+
+	for ( i = 0; i < numWeights; i++ ) {
+		if ( weightIndex[i * 2 + 0] < 0 || weightIndex[i * 2 + 0] >= numJoints * (int)sizeof( idJointMat ) ) {
+			return false;
+		}
+	}
+
+	remaining = file->Length() - file->Tell();
+	file->ReadInt( num );
+	if ( num < 0 || ( num % 3 ) != 0 || num * (int)sizeof( int ) > remaining ) {
+		return false;
+	}
+	tris.SetNum( num );
+	file->Read( tris.Ptr(), num * sizeof( int ) );
+	LittleRevBytes( tris.Ptr(), sizeof( int ), num );
+	numTris = num / 3;
+
+	for ( i = 0; i < tris.Num(); i++ ) {
+		if ( tris[i] < 0 || tris[i] >= texCoords.Num() ) {
+			return false;
+		}
+	}
+
+	FinishMesh( tris, joints );
+	return true;
+}
+
+/*
+====================
+idMD5Mesh::FinishMesh
+====================
+*/
+void idMD5Mesh::FinishMesh( const idList<int> &tris, const idJointMat *joints ) {
+	int i;
+
 	// update counters
 	c_numVerts += texCoords.Num();
 	c_numWeights += numWeights;
@@ -272,7 +386,7 @@ idMD5Mesh::UpdateSurface
 ====================
 */
 void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, modelSurface_t *surf ) {
-	int i, base;
+	int i;
 	srfTriangles_t *tri;
 
 	tr.pc.c_deformedSurfaces++;
@@ -321,19 +435,18 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 		}
 	}
 
-	if ( ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] != 0.0f ) {
-		TransformScaledVerts( tri->verts, entJoints, ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] );
-	} else {
-		TransformVerts( tri->verts, entJoints );
-	}
-
-	// replicate the mirror seam vertexes
-	base = deformInfo->numOutputVerts - deformInfo->numMirroredVerts;
-	for ( i = 0; i < deformInfo->numMirroredVerts; i++ ) {
-		tri->verts[base + i] = tri->verts[deformInfo->mirroredVerts[i]];
+	if ( md5DeferSkinning ) {
+		// the joints are owned by the game and stay valid until the frame is finished
+		md5SkinJob_t &job = md5SkinJobs.Alloc();
+		job.mesh = this;
+		job.joints = entJoints;
+		job.skinScale = ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ];
+		job.tri = tri;
+		job.staticModel = NULL;
+		return;
 	}
 
-	R_BoundTriSurf( tri );
+	SkinSurface( tri, entJoints, ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] );
 
 	// If a surface is going to be have a lighting interaction generated, it will also have to call
 	// R_DeriveTangents() to get normals, tangents, and face planes.  If it only
@@ -345,6 +458,32 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 	}
 }
 
+/*
+====================
+idMD5Mesh::SkinSurface
+
+Transforms the vertexes of a surface set up by UpdateSurface and bounds it.
+Doesn't allocate or touch anything shared, so it can run on any thread.
+====================
+*/
+void idMD5Mesh::SkinSurface( srfTriangles_t *tri, const idJointMat *entJoints, float skinScale ) {
+	int i, base;
+
+	if ( skinScale != 0.0f ) {
+		TransformScaledVerts( tri->verts, entJoints, skinScale );
+	} else {
+		TransformVerts( tri->verts, entJoints );
+	}
+
+	// replicate the mirror seam vertexes
+	base = deformInfo->numOutputVerts - deformInfo->numMirroredVerts;
+	for ( i = 0; i < deformInfo->numMirroredVerts; i++ ) {
+		tri->verts[base + i] = tri->verts[deformInfo->mirroredVerts[i]];
+	}
+
+	R_BoundTriSurf( tri );
+}
+
 /*
 ====================
 idMD5Mesh::CalcBounds
@@ -497,17 +636,43 @@ void idRenderModelMD5::LoadModel() {
 	idJointQuat	*pose;
 	idMD5Joint	*joint;
 	idJointMat *poseMat3;
+	int			sourceLength;
+	ID_TIME_T	sourceTimeStamp;
 
 	if ( !purged ) {
 		PurgeModel();
 	}
 	purged = false;
 
+	sourceLength = fileSystem->ReadFile( name, NULL, &sourceTimeStamp );
+
+	if ( sourceLength >= 0 && r_md5Cache.GetInteger() == 1 ) {
+		if ( LoadModelFromCache( sourceTimeStamp, sourceLength ) ) {
+			timeStamp = sourceTimeStamp;
+			return;
+		}
+		// throw away whatever a damaged cache left behind
+		PurgeModel();
+		purged = false;
+	}
+
 	if ( !parser.LoadFile( name ) ) {
 		MakeDefaultModel();
 		return;
 	}
 
+	// the text is parsed into a memory file that becomes the binary cache, it's on the
+	// stack so it's freed when parser.Error throws
+	idFile_Memory cacheData( name );
+	idFile_Memory *cacheFile = NULL;
+	if ( r_md5Cache.GetInteger() != 0 ) {
+		cacheFile = &cacheData;
+		cacheFile->WriteInt( MD5_CACHE_MAGIC );
+		cacheFile->WriteInt( MD5_MESH_CACHE_VERSION );
+		cacheFile->WriteUnsignedInt( (unsigned int)sourceTimeStamp );
+		cacheFile->WriteInt( sourceLength );
+	}
+
 	parser.ExpectTokenString( MD5_VERSION_STRING );
 	version = parser.ParseInt();
 
@@ -558,9 +723,23 @@ void idRenderModelMD5::LoadModel() {
 	}
 	parser.ExpectTokenString( "}" );
 
+	if ( cacheFile != NULL ) {
+		cacheFile->WriteInt( joints.Num() );
+		for ( i = 0; i < joints.Num(); i++ ) {
+			cacheFile->WriteString( joints[ i ].name );
+			cacheFile->WriteInt( joints[ i ].parent ? joints[ i ].parent - joints.Ptr() : -1 );
+			cacheFile->WriteVec4( idVec4( defaultPose[ i ].q.x, defaultPose[ i ].q.y, defaultPose[ i ].q.z, defaultPose[ i ].q.w ) );
+			cacheFile->WriteVec3( defaultPose[ i ].t );
+			for ( int j = 0; j < 12; j++ ) {
+				cacheFile->WriteFloat( poseMat3[ i ].ToFloatPtr()[ j ] );
+			}
+		}
+		cacheFile->WriteInt( meshes.Num() );
+	}
+
 	for( i = 0; i < meshes.Num(); i++ ) {
 		parser.ExpectTokenString( "mesh" );
-		meshes[ i ].ParseMesh( parser, defaultPose.Num(), poseMat3 );
+		meshes[ i ].ParseMesh( parser, defaultPose.Num(), poseMat3, cacheFile );
 	}
 
 	//
@@ -569,7 +748,114 @@ void idRenderModelMD5::LoadModel() {
 	CalculateBounds( poseMat3 );
 
 	// set the timestamp for reloadmodels
-	fileSystem->ReadFile( name, NULL, &timeStamp );
+	timeStamp = sourceTimeStamp;
+
+	if ( cacheFile != NULL ) {
+		cacheFile->WriteInt( MD5_CACHE_MAGIC );
+
+		idStr cacheName;
+		MD5_CacheFileName( name, MD5_MESH_CACHE_EXT, cacheName );
+		fileSystem->WriteFile( cacheName, cacheFile->GetDataPtr(), cacheFile->Length() );
+	}
+}
+
+/*
+====================
+idRenderModelMD5::LoadModelFromCache
+
+the cache is only used if it was built from a source file with the same timestamp and size
+====================
+*/
+bool idRenderModelMD5::LoadModelFromCache( ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	idStr			cacheName;
+	void *			buffer;
+	int				length;
+	int				value;
+	unsigned int	cachedTimeStamp;
+	int				num;
+	int				i, j;
+	idVec4			q;
+
+	MD5_CacheFileName( name, MD5_MESH_CACHE_EXT, cacheName );
+
+	length = fileSystem->ReadFile( cacheName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory file( cacheName, (const char *)buffer, length );
+	bool ok = false;
+
+	file.ReadInt( value );
+	if ( value != MD5_CACHE_MAGIC ) {
+		goto done;
+	}
+	file.ReadInt( value );
+	if ( value != MD5_MESH_CACHE_VERSION ) {
+		goto done;
+	}
+	file.ReadUnsignedInt( cachedTimeStamp );
+	file.ReadInt( value );
+	if ( cachedTimeStamp != (unsigned int)sourceTimeStamp || value != sourceLength ) {
+		goto done;
+	}
+
+	// every joint takes at least 84 bytes
+	file.ReadInt( num );
+	if ( num <= 0 || num * 84 > length ) {
+		goto done;
+	}
+	joints.SetGranularity( 1 );
+	joints.SetNum( num );
+	defaultPose.SetGranularity( 1 );
+	defaultPose.SetNum( num );
+
+	{
+		idJointMat *poseMat3 = ( idJointMat * )_alloca16( num * sizeof( *poseMat3 ) );
+
+		for ( i = 0; i < num; i++ ) {
+			file.ReadString( joints[ i ].name );
+			file.ReadInt( value );
+			if ( value >= i ) {
+				goto done;
+			}
+			joints[ i ].parent = ( value < 0 ) ? NULL : &joints[ value ];
+			file.ReadVec4( q );
+			defaultPose[ i ].q.Set( q.x, q.y, q.z, q.w );
+			file.ReadVec3( defaultPose[ i ].t );
+			for ( j = 0; j < 12; j++ ) {
+				file.ReadFloat( poseMat3[ i ].ToFloatPtr()[ j ] );
+			}
+		}
+
+		file.ReadInt( value );
+		if ( value < 0 || value > length ) {
+			goto done;
+		}
+		meshes.SetGranularity( 1 );
+		meshes.SetNum( value );
+		for ( i = 0; i < meshes.Num(); i++ ) {
+			if ( !meshes[ i ].LoadMeshFromCache( &file, num, poseMat3 ) ) {
+				goto done;
+			}
+		}
+
+		file.ReadInt( value );
+		if ( value != MD5_CACHE_MAGIC ) {
+			goto done;
+		}
+
+		CalculateBounds( poseMat3 );
+	}
+
+	ok = true;
+
+done:
+	fileSystem->FreeFile( buffer );
+	if ( !ok ) {
+		common->DPrintf( "%s: out of date or damaged, parsing %s\n", cacheName.c_str(), name.c_str() );
+	}
+	return ok;
 }
 
 /*
@@ -831,6 +1117,12 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 
 		mesh->UpdateSurface( ent, ent->joints, surf );
 
+		if ( md5DeferSkinning ) {
+			// the bounds are added once the surface has been skinned
+			md5SkinJobs[md5SkinJobs.Num() - 1].staticModel = staticModel;
+			continue;
+		}
+
 		staticModel->bounds.AddPoint( surf->geometry->bounds[0] );
 		staticModel->bounds.AddPoint( surf->geometry->bounds[1] );
 	}
@@ -988,3 +1280,86 @@ int	idRenderModelMD5::Memory() const {
 	}
 	return total;
 }
+
+/***********************************************************************
+
+	deferred skinning
+
+***********************************************************************/
+
+/*
+====================
+R_SkinMD5Job
+====================
+*/
+static void R_SkinMD5Job( void *data ) {
+	md5SkinJob_t *job = (md5SkinJob_t *)data;
+
+	job->mesh->SkinSurface( job->tri, job->joints, job->skinScale );
+}
+
+/*
+====================
+R_BeginDeferredSkinning
+
+MD5 models instantiated until R_FinishDeferredSkinning get their surfaces
+allocated right away, but their vertexes are only valid after the finish.
+====================
+*/
+void R_BeginDeferredSkinning( void ) {
+	assert( !md5DeferSkinning );
+	md5SkinJobs.SetNum( 0, false );
+	md5DeferSkinning = true;
+}
+
+/*
+====================
+R_FinishDeferredSkinning
+
+Transforms all queued surfaces in parallel, then does the work that has to
+stay serial: model bounds and, if not deferred, tangents.
+Returns the number of skinned surfaces.
+====================
+*/
+int R_FinishDeferredSkinning( void ) {
+	int i;
+
+	assert( md5DeferSkinning );
+	md5DeferSkinning = false;
+
+	const int numJobs = md5SkinJobs.Num();
+	if ( numJobs == 0 ) {
+		return 0;
+	}
+
+	if ( numJobs == 1 || jobSystem->GetNumWorkers() == 0 ) {
+		for ( i = 0; i < numJobs; i++ ) {
+			R_SkinMD5Job( &md5SkinJobs[i] );
+		}
+	} else {
+		if ( md5SkinJobList == NULL ) {
+			md5SkinJobList = jobSystem->AllocJobList( "md5Skin" );
+		}
+		md5SkinJobList->Clear();
+		for ( i = 0; i < numJobs; i++ ) {
+			md5SkinJobList->AddJob( R_SkinMD5Job, &md5SkinJobs[i], "md5Skin" );
+		}
+		md5SkinJobList->Submit();
+		md5SkinJobList->Wait();
+	}
+
+	for ( i = 0; i < numJobs; i++ ) {
+		md5SkinJob_t &job = md5SkinJobs[i];
+
+		job.staticModel->bounds.AddPoint( job.tri->bounds[0] );
+		job.staticModel->bounds.AddPoint( job.tri->bounds[1] );
+
+		if ( !r_useDeferredTangents.GetBool() ) {
+			R_DeriveTangents( job.tri );
+		}
+	}
+
+	md5SkinJobs.SetNum( 0, false );
+
+	return numJobs;
+}
@@ -30,6 +30,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "framework/EventLoop.h"
 #include "framework/Session.h"
 #include "framework/DemoFile.h"
+#include "framework/Profiler.h"
 #include "renderer/ModelManager.h"
 #include "renderer/Material.h"
 #include "renderer/GuiModel.h"
@@ -729,6 +730,8 @@ Returns the number of msec spent in the back end
 void idRenderSystemLocal::EndFrame( double *frontEndMsec, double *backEndMsec ) {
 	emptyCommand_t *cmd;
 
+	PROFILE_SCOPE( "idRenderSystem::EndFrame" );
+
 	if ( !glConfig.isInitialized ) {
 		return;
 	}
@@ -28,6 +28,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "sys/platform.h"
 #include "idlib/LangDict.h"
+#include "idlib/geometry/JointTransform.h"
 #include "framework/Licensee.h"
 #include "framework/Console.h"
 #include "framework/Session.h"
@@ -83,7 +84,9 @@ idCVar r_useInteractionTable( "r_useInteractionTable", "1", CVAR_RENDERER | CVAR
 idCVar r_useTurboShadow( "r_useTurboShadow", "1", CVAR_RENDERER | CVAR_BOOL, "use the infinite projection with W technique for dynamic shadows" );
 idCVar r_useTwoSidedStencil( "r_useTwoSidedStencil", "1", CVAR_RENDERER | CVAR_BOOL, "do stencil shadows in one pass with different ops on each side" );
 idCVar r_useDeferredTangents( "r_useDeferredTangents", "1", CVAR_RENDERER | CVAR_BOOL, "defer tangents calculations after deform" );
+idCVar r_useSkinningJobs( "r_useSkinningJobs", "1", CVAR_RENDERER | CVAR_BOOL, "instantiate the dynamic models of all visible entities first and skin the md5 meshes on the job workers" );
 idCVar r_useCachedDynamicModels( "r_useCachedDynamicModels", "1", CVAR_RENDERER | CVAR_BOOL, "cache snapshots of dynamic models, disabled in debug" );
+idCVar r_md5Cache( "r_md5Cache", "1", CVAR_RENDERER | CVAR_INTEGER, "0 = always parse md5 text files, 1 = load md5 meshes and anims from binary caches in " MD5_CACHE_DIR ", 2 = parse the text files and rewrite the caches", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 
 idCVar r_useVertexBuffers( "r_useVertexBuffers", "1", CVAR_RENDERER | CVAR_INTEGER, "use ARB_vertex_buffer_object for vertexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
 idCVar r_useIndexBuffers( "r_useIndexBuffers", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "use ARB_vertex_buffer_object for indexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
@@ -1545,6 +1548,119 @@ void R_Benchmark_f( const idCmdArgs &args ) {
 	r_skipRenderContext.SetBool( false );
 }
 
+/*
+================
+R_BenchmarkSkinningCallback
+
+Like a game entity, the snapshot is cleared by UpdateEntityDef and the
+callback itself has nothing left to update.
+================
+*/
+static bool R_BenchmarkSkinningCallback( renderEntity_t *ent, const renderView_t *view ) {
+	return false;
+}
+
+/*
+================
+R_BenchmarkSkinning_f
+
+Places a crowd of md5 models in their default pose in front of the primary view
+and times the front end of rendering it, serially and with the skinning jobs.
+Only the scene submission is timed, so the numbers are meaningful with the stub
+GL of the dedicated build as well.
+================
+*/
+void R_BenchmarkSkinning_f( const idCmdArgs &args ) {
+	int i, j;
+
+	if ( args.Argc() < 2 ) {
+		common->Printf( "usage: benchmarkSkinning <md5 model> [count] [views]\n" );
+		return;
+	}
+	if ( !tr.primaryView ) {
+		common->Printf( "No primaryView for benchmarking\n" );
+		return;
+	}
+
+	idRenderModel *model = renderModelManager->FindModel( args.Argv( 1 ) );
+	if ( !model || model->IsDefaultModel() || model->NumJoints() == 0 ) {
+		common->Printf( "'%s' is not an md5 model\n", args.Argv( 1 ) );
+		return;
+	}
+
+	const int count = ( args.Argc() > 2 ) ? idMath::ClampInt( 1, 4096, atoi( args.Argv( 2 ) ) ) : 64;
+	const int numViews = ( args.Argc() > 3 ) ? Max( 1, atoi( args.Argv( 3 ) ) ) : 100;
+
+	// the default pose in model space
+	const int numJoints = model->NumJoints();
+	const idMD5Joint *md5Joints = model->GetJoints();
+	idJointMat *joints = (idJointMat *)Mem_Alloc16( numJoints * sizeof( joints[0] ) );
+	int *parents = (int *)_alloca( numJoints * sizeof( parents[0] ) );
+	for ( i = 0; i < numJoints; i++ ) {
+		parents[i] = md5Joints[i].parent ? md5Joints[i].parent - md5Joints : -1;
+	}
+	SIMDProcessor->ConvertJointQuatsToJointMats( joints, model->GetDefaultPose(), numJoints );
+	SIMDProcessor->TransformJoints( joints, parents, 1, numJoints - 1 );
+
+	renderView_t view = tr.primaryRenderView;
+	idRenderWorld *world = tr.primaryWorld;
+
+	// a square grid in front of the view
+	const idBounds bounds = model->Bounds( NULL );
+	const float spacing = Max( bounds.GetRadius(), 16.0f );
+	const int side = (int)idMath::Ceil( idMath::Sqrt( (float)count ) );
+
+	idList<renderEntity_t> ents;
+	idList<qhandle_t> handles;
+	ents.SetNum( count );
+	handles.SetNum( count );
+	for ( i = 0; i < count; i++ ) {
+		renderEntity_t &ent = ents[i];
+
+		memset( &ent, 0, sizeof( ent ) );
+		ent.hModel = model;
+		ent.numJoints = numJoints;
+		ent.joints = joints;
+		ent.bounds = bounds;
+		ent.axis = mat3_identity;
+		ent.origin = view.vieworg + view.viewaxis[0] * ( ( 2 + i / side ) * spacing ) + view.viewaxis[1] * ( ( ( i % side ) - side * 0.5f ) * spacing );
+		ent.shaderParms[ SHADERPARM_RED ] = 1.0f;
+		ent.shaderParms[ SHADERPARM_GREEN ] = 1.0f;
+		ent.shaderParms[ SHADERPARM_BLUE ] = 1.0f;
+		ent.shaderParms[ SHADERPARM_ALPHA ] = 1.0f;
+		ent.callback = R_BenchmarkSkinningCallback;
+		handles[i] = world->AddEntityDef( &ent );
+	}
+
+	const bool oldSkinningJobs = r_useSkinningJobs.GetBool();
+
+	common->Printf( "%i x %s, %i views, %i job workers\n", count, model->Name(), numViews, jobSystem->GetNumWorkers() );
+	for ( int pass = 0; pass < 2; pass++ ) {
+		r_useSkinningJobs.SetBool( pass != 0 );
+
+		double totalMS = 0.0;
+		for ( i = 0; i < numViews; i++ ) {
+			for ( j = 0; j < count; j++ ) {
+				world->UpdateEntityDef( handles[j], &ents[j] );
+			}
+
+			renderSystem->BeginFrame( glConfig.vidWidth, glConfig.vidHeight );
+			uint64 start = Sys_GetPerformanceCounter();
+			world->RenderScene( &view );
+			totalMS += Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - start );
+			renderSystem->EndFrame( NULL, NULL );
+		}
+		common->Printf( "%-8s %8.3f ms per view\n", pass ? "jobs" : "serial", totalMS / numViews );
+	}
+
+	r_useSkinningJobs.SetBool( oldSkinningJobs );
+
+	for ( i = 0; i < count; i++ ) {
+		world->FreeEntityDef( handles[i] );
+	}
+	Mem_Free16( joints );
+}
+
 
 /*
 ==============================================================================
@@ -2462,6 +2578,7 @@ void R_InitCommands( void ) {
 	cmdSystem->AddCommand( "envshot", R_EnvShot_f, CMD_FL_RENDERER, "takes an environment shot" );
 	cmdSystem->AddCommand( "makeAmbientMap", R_MakeAmbientMap_f, CMD_FL_RENDERER|CMD_FL_CHEAT, "makes an ambient map" );
 	cmdSystem->AddCommand( "benchmark", R_Benchmark_f, CMD_FL_RENDERER, "benchmark" );
+	cmdSystem->AddCommand( "benchmarkSkinning", R_BenchmarkSkinning_f, CMD_FL_RENDERER|CMD_FL_CHEAT, "times the front end with a crowd of md5 models, usage: benchmarkSkinning <md5 model> [count] [views]", idCmdSystem::ArgCompletion_ModelName );
 	cmdSystem->AddCommand( "gfxInfo", GfxInfo_f, CMD_FL_RENDERER, "show graphics info" );
 	cmdSystem->AddCommand( "modulateLights", R_ModulateLights_f, CMD_FL_RENDERER | CMD_FL_CHEAT, "modifies shader parms on all lights" );
 	cmdSystem->AddCommand( "testImage", R_TestImage_f, CMD_FL_RENDERER | CMD_FL_CHEAT, "displays the given image centered on screen", idCmdSystem::ArgCompletion_ImageName );
@@ -29,6 +29,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "sys/platform.h"
 #include "framework/DemoFile.h"
 #include "framework/Session.h"
+#include "framework/Profiler.h"
 #include "renderer/RenderWorld_local.h"
 
 #include "renderer/tr_local.h"
@@ -852,6 +853,8 @@ they were considered, but not actually visible.
 =============
 */
 void idRenderWorldLocal::FindViewLightsAndEntities( void ) {
+	PROFILE_SCOPE( "idRenderWorldLocal::FindViewLightsAndEntities" );
+
 	// clear the visible lightDef and entityDef lists
 	tr.viewDef->viewLights = NULL;
 	tr.viewDef->viewEntitys = NULL;
@@ -26,6 +26,7 @@ If you have questions concerning this license or the applicable additional terms
 ===========================================================================
 */
 #include "sys/platform.h"
+#include "framework/Profiler.h"
 
 #include "renderer/tr_local.h"
 
@@ -722,6 +723,8 @@ void RB_ExecuteBackEndCommands( const emptyCommand_t *cmds ) {
 	// r_debugRenderToTexture
 	int	c_draw3d = 0, c_draw2d = 0, c_setBuffers = 0, c_swapBuffers = 0, c_copyRenders = 0, c_setFrameBuffers = 0;
 
+	PROFILE_SCOPE( "RB_ExecuteBackEndCommands" );
+
 	if ( cmds->commandId == RC_NOP && !cmds->next ) {
 		return;
 	}
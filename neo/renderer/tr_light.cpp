@@ -29,6 +29,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "sys/platform.h"
 #include "idlib/math/Interpolate.h"
 #include "framework/Game.h"
+#include "framework/Profiler.h"
 #include "renderer/VertexCache.h"
 #include "renderer/RenderWorld_local.h"
 #include "ui/Window.h"
@@ -896,6 +897,8 @@ void R_AddLightSurfaces( void ) {
 	idRenderLightLocal *light;
 	viewLight_t		**ptr;
 
+	PROFILE_SCOPE( "R_AddLightSurfaces" );
+
 	// go through each visible light, possibly removing some from the list
 	ptr = &tr.viewDef->viewLights;
 	while ( *ptr ) {
@@ -1112,6 +1115,38 @@ bool R_IssueEntityDefCallback( idRenderEntityLocal *def ) {
 	return update;
 }
 
+// set while R_PrepareDynamicModels instantiates models whose vertexes are skinned later
+static bool								deferDynamicModelFinish = false;
+static idList<idRenderEntityLocal *>	deferredDynamicModelDefs;
+
+/*
+===================
+R_FinishEntityDefDynamicModel
+
+Adds overlays to a freshly instantiated dynamic model, which needs its final vertexes.
+===================
+*/
+static void R_FinishEntityDefDynamicModel( idRenderEntityLocal *def ) {
+	// add any overlays to the snapshot of the dynamic model
+	if ( def->overlay && !r_skipOverlays.GetBool() ) {
+		def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
+	} else {
+		idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
+	}
+
+	if ( r_checkBounds.GetBool() ) {
+		idBounds b = def->cachedDynamicModel->Bounds();
+		if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
+				b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
+				b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
+				b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
+				b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
+				b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
+			common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
+		}
+	}
+}
+
 /*
 ===================
 R_EntityDefDynamicModel
@@ -1156,24 +1191,10 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 		def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
 
 		if ( def->cachedDynamicModel ) {
-
-			// add any overlays to the snapshot of the dynamic model
-			if ( def->overlay && !r_skipOverlays.GetBool() ) {
-				def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
+			if ( deferDynamicModelFinish ) {
+				deferredDynamicModelDefs.Append( def );
 			} else {
-				idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
-			}
-
-			if ( r_checkBounds.GetBool() ) {
-				idBounds b = def->cachedDynamicModel->Bounds();
-				if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
-						b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
-						b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
-						b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
-						b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
-						b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
-					common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
-				}
+				R_FinishEntityDefDynamicModel( def );
 			}
 		}
 
@@ -1543,6 +1564,70 @@ viewEntity_t* R_SortViewEntities(viewEntity_t* vEntities) {
 }
 
 
+/*
+===================
+R_PrepareDynamicModels
+
+Instantiates the dynamic models of all entities that R_AddModelSurfaces will
+add ambient surfaces for, so the md5 meshes among them can be skinned in
+parallel instead of one entity at a time.
+===================
+*/
+static void R_PrepareDynamicModels( void ) {
+	viewEntity_t		*vEntity;
+
+	R_BeginDeferredSkinning();
+	deferDynamicModelFinish = true;
+
+	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
+		idRenderEntityLocal *def = vEntity->entityDef;
+
+		if ( r_useEntityScissors.GetBool() ) {
+			// calculate the screen area covered by the entity
+			idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
+			// intersect with the portal crossing scissor rectangle
+			vEntity->scissorRect.Intersect( scissorRect );
+
+			if ( r_showEntityScissors.GetBool() ) {
+				R_ShowColoredScreenRect( vEntity->scissorRect, def->index );
+			}
+		}
+
+		if ( !def->parms.callback && ( !def->parms.hModel || def->parms.hModel->IsDynamicModel() == DM_STATIC ) ) {
+			continue;
+		}
+		if ( tr.viewDef->isXraySubview ? def->parms.xrayIndex == 1 : def->parms.xrayIndex == 2 ) {
+			continue;
+		}
+		if ( vEntity->scissorRect.IsEmpty() && !def->parms.noFrustumCull ) {
+			continue;
+		}
+
+		const float oldFloatTime = tr.viewDef->floatTime;
+		const int oldTime = tr.viewDef->renderView.time;
+
+		game->SelectTimeGroup( def->parms.timeGroup );
+
+		if ( def->parms.timeGroup ) {
+			tr.viewDef->floatTime = game->GetTimeGroupTime( def->parms.timeGroup ) * 0.001;
+			tr.viewDef->renderView.time = game->GetTimeGroupTime( def->parms.timeGroup );
+		}
+
+		R_EntityDefDynamicModel( def );
+
+		tr.viewDef->floatTime = oldFloatTime;
+		tr.viewDef->renderView.time = oldTime;
+	}
+
+	deferDynamicModelFinish = false;
+	R_FinishDeferredSkinning();
+
+	for ( int i = 0; i < deferredDynamicModelDefs.Num(); i++ ) {
+		R_FinishEntityDefDynamicModel( deferredDynamicModelDefs[i] );
+	}
+	deferredDynamicModelDefs.SetNum( 0, false );
+}
+
 /*
 ===================
 R_AddModelSurfaces
@@ -1559,17 +1644,25 @@ void R_AddModelSurfaces( void ) {
 	idInteraction		*inter, *next;
 	idRenderModel		*model;
 
+	PROFILE_SCOPE( "R_AddModelSurfaces" );
+
 	// clear the ambient surface list
 	tr.viewDef->viewEntitys = R_SortViewEntities(tr.viewDef->viewEntitys); //BFG
 	tr.viewDef->numDrawSurfs = 0;
 	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_AddDrawSurf
 
+	// with job workers available, skin all visible md5 models up front
+	const bool prepared = r_useSkinningJobs.GetBool() && jobSystem->GetNumWorkers() > 0;
+	if ( prepared ) {
+		R_PrepareDynamicModels();
+	}
+
 	// go through each entity that is either visible to the view, or to
 	// any light that intersects the view (for shadows)
 	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
 		tr.ClearFontSurfData(); // blendo eric: surface data generated every gui entity / frame
 
-		if ( r_useEntityScissors.GetBool() ) {
+		if ( r_useEntityScissors.GetBool() && !prepared ) {
 			// calculate the screen area covered by the entity
 			idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
 			// intersect with the portal crossing scissor rectangle
@@ -1730,6 +1823,8 @@ R_RemoveUnecessaryViewLights
 =====================
 */
 void R_RemoveUnecessaryViewLights( void ) {
+	PROFILE_SCOPE( "R_RemoveUnecessaryViewLights" );
+
 	viewLight_t		*vLight;
 
 	int numViewLights = 0; //BFG/HASTE
@@ -607,6 +607,11 @@ bool R_GlobalShaderOverride( const idMaterial **shader );
 // this does various checks before calling the idDeclSkin
 const idMaterial *R_RemapShaderBySkin( const idMaterial *shader, const idDeclSkin *customSkin, const idMaterial *customShader );
 
+// md5 models instantiated in between only queue their vertex transforms, which the
+// finish runs on the job workers, returns the number of skinned surfaces
+void R_BeginDeferredSkinning( void );
+int R_FinishDeferredSkinning( void );
+
 
 //====================================================
 
@@ -952,7 +957,9 @@ extern idCVar r_useOptimizedShadows;	// 1 = use the dmap generated static shadow
 extern idCVar r_useShadowVertexProgram;	// 1 = do the shadow projection in the vertex program on capable cards
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
 extern idCVar r_useDeferredTangents;	// 1 = don't always calc tangents after deform
+extern idCVar r_useSkinningJobs;		// 1 = skin all visible md5 models of a view on the job workers before adding surfaces
 extern idCVar r_useCachedDynamicModels;	// 1 = cache snapshots of dynamic models
+extern idCVar r_md5Cache;				// 1 = load md5 meshes and anims from binary caches, 2 = always rebuild the caches
 extern idCVar r_useTwoSidedStencil;		// 1 = do stencil shadows in one pass with different ops on each side
 extern idCVar r_useInfiniteFarZ;		// 1 = use the no-far-clip-plane trick
 extern idCVar r_useScissor;				// 1 = scissor clip as portals and lights are processed
@@ -40,6 +40,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "sys/platform.h"
 #include "framework/Session.h"
+#include "framework/Profiler.h"
 #include "renderer/RenderWorld_local.h"
 
 #include "renderer/tr_local.h"
@@ -1116,6 +1117,8 @@ R_SortDrawSurfs
 =================
 */
 static void R_SortDrawSurfs( void ) {
+	PROFILE_SCOPE( "R_SortDrawSurfs" );
+
 	// sort the drawsurfs by sort type, then orientation, then shader
 	qsort( tr.viewDef->drawSurfs, tr.viewDef->numDrawSurfs, sizeof( tr.viewDef->drawSurfs[0] ),
 		R_QsortSurfaces );
@@ -1179,6 +1182,8 @@ Parms will typically be allocated with R_FrameAlloc
 void R_RenderView( viewDef_t *parms ) {
 	viewDef_t		*oldView;
 
+	PROFILE_SCOPE( "R_RenderView" );
+
 	if ( parms->renderView.width <= 0 || parms->renderView.height <= 0 ) {
 		return;
 	}
@@ -27,6 +27,7 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "sys/platform.h"
+#include "framework/Profiler.h"
 
 #include "renderer/tr_local.h"
 
@@ -574,6 +575,8 @@ bool R_GenerateSubViews( void ) {
 	bool			subviews;
 	const idMaterial		*shader;
 
+	PROFILE_SCOPE( "R_GenerateSubViews" );
+
 	// for testing the performance hit
 	if ( r_skipSubviews.GetBool() ) {
 		return false;
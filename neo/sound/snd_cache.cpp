@@ -590,6 +590,8 @@ idSoundSample::PurgeSoundSample
 void idSoundSample::PurgeSoundSample() {
 	purged = true;
 
+	idSampleDecoder::PurgeSample( this );
+
 	if (openalBuffer != 0)
 	{
 		alGetError();
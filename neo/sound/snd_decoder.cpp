@@ -30,6 +30,9 @@ If you have questions concerning this license or the applicable additional terms
 #include <vorbis/codec.h>
 #include <vorbis/vorbisfile.h>
 
+#include <atomic>
+#include <thread>
+
 #include "sys/platform.h"
 #include "framework/FileSystem.h"
 
@@ -280,19 +283,66 @@ int idWaveFile::CloseOGG( void ) {
 ===================================================================================
 */
 
+/*
+===================================================================================
+
+  Decode ahead.
+
+  Streaming ogg channels keep a ring of decoded 44kHz samples. The mixer only
+  copies out of the ring, and after every mix the decoders that ran low are
+  refilled on the job workers. The mixer is the only reader and the job the
+  only writer of a ring, so the read and write positions are all the
+  synchronization they need. A channel that seeks or reads past its ring
+  decodes on the mixer thread like before.
+
+  Short ogg samples are decoded once into the decoder cache by a job and are
+  then played back like PCM samples.
+
+===================================================================================
+*/
+
+const int DECODE_AHEAD_SAMPLES			= MIXBUFFER_SAMPLES * 2 * 4;	// four stereo mix buffers
+const int DECODE_AHEAD_REFILL			= MIXBUFFER_SAMPLES * 2;		// refill once a stereo mix buffer is free
+const int DECODER_CACHE_MAX_SAMPLES		= 44100 * 2 * 10;				// ten seconds of stereo
+
+enum {
+	DECODE_IDLE,
+	DECODE_QUEUED,		// waiting for the next UpdateDecodeAhead
+	DECODE_RUNNING,
+	DECODE_DONE,		// decoder cache entries only
+	DECODE_FAILED
+};
+
+typedef struct decoderCacheEntry_s {
+	idSoundSample *			sample;
+	short *					pcm;				// decoded samples at the sample rate of the sample
+	int						size;				// bytes
+	int						lastUsed;
+	std::atomic<int>		state;
+} decoderCacheEntry_t;
+
 class idSampleDecoderLocal : public idSampleDecoder {
 public:
+							idSampleDecoderLocal( void );
+
 	virtual void			Decode( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
 	virtual void			ClearDecoder( void );
 	virtual idSoundSample *	GetSample( void ) const;
 	virtual int				GetLastDecodeTime( void ) const;
 
 	void					Clear( void );
+	void					FreeRing( void );
 	int						DecodePCM( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
 	int						DecodeOGG( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
+	int						DecodeCached( const decoderCacheEntry_t *entry, idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
+
+	static void				DecodeAheadJob( void *data );
 
 private:
+	friend class			idSampleDecoder;
+
 	bool					failed;				// set if decoding failed
+	bool					oggOpen;			// ogg holds an opened stream, cached samples never open one
 	int						lastFormat;			// last format being decoded
 	idSoundSample *			lastSample;			// last sample being decoded
 	int						lastSampleOffset;	// last offset into the decoded sample
@@ -300,10 +350,172 @@ private:
 	idFile_Memory			file;				// encoded file in memory
 
 	OggVorbis_File			ogg;				// OggVorbis file
+
+	float *					ring;				// samples decoded ahead
+	int						ringOffset44k;		// sample offset of ring position zero
+	std::atomic<int>		ringRead;			// ring position of the next sample the mixer reads
+	std::atomic<int>		ringWrite;			// ring position of the next sample the job decodes
+	std::atomic<int>		aheadState;
+	std::atomic<bool>		aheadStop;			// set when the mixer waits for a running decode ahead job
+
+	int						ReadRing( int sampleOffset44k, int sampleCount44k, float *dest );
+	void					RequestDecodeAhead( void );
+	void					WaitForDecodeAhead( void );
+	void					DecodeAhead( void );
 };
 
 idBlockAlloc<idSampleDecoderLocal, 64>		sampleDecoderAllocator;
 
+static idList<idSampleDecoderLocal *>		decodeAheadQueue;
+static idList<decoderCacheEntry_t *>		decoderCache;
+static idHashIndex							decoderCacheHash;
+static idJobList *							decodeAheadJobs;
+
+static std::atomic<uint64>					decodeAheadTicks;
+static uint64								decodeMixerTicks;
+static int									decodeStatsTime;
+static int									decoderCacheBytes;
+
+/*
+====================
+DecoderCacheHash
+====================
+*/
+static int DecoderCacheHash( const idSoundSample *sample ) {
+	return (int)( (intptr_t)sample >> 4 );
+}
+
+/*
+====================
+FindDecoderCacheEntry
+====================
+*/
+static int FindDecoderCacheEntry( const idSoundSample *sample ) {
+	for ( int i = decoderCacheHash.First( DecoderCacheHash( sample ) ); i != -1; i = decoderCacheHash.Next( i ) ) {
+		if ( decoderCache[i]->sample == sample ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+====================
+RemoveDecoderCacheEntry
+====================
+*/
+static void RemoveDecoderCacheEntry( int index ) {
+	decoderCacheEntry_t *entry = decoderCache[index];
+
+	assert( entry->state != DECODE_QUEUED && entry->state != DECODE_RUNNING );
+
+	decoderCacheHash.RemoveIndex( DecoderCacheHash( entry->sample ), index );
+	decoderCache.RemoveIndex( index );
+
+	decoderCacheBytes -= entry->size;
+	Mem_Free( entry->pcm );
+	delete entry;
+}
+
+/*
+====================
+DecoderCacheJob
+
+decodes a whole sample with its own vorbis state
+====================
+*/
+static void DecoderCacheJob( void *data ) {
+	decoderCacheEntry_t *entry = static_cast<decoderCacheEntry_t *>( data );
+	idSoundSample *sample = entry->sample;
+	idFile_Memory file;
+	OggVorbis_File ogg;
+
+	uint64 start = Sys_GetPerformanceCounter();
+
+	file.SetData( (const char *)sample->nonCacheData, sample->objectMemSize );
+	if ( ov_openFile( &file, &ogg ) < 0 ) {
+		entry->state = DECODE_FAILED;
+		return;
+	}
+
+	char *dest = (char *)entry->pcm;
+	int total = entry->size;
+	while ( total > 0 ) {
+		int ret = ov_read( &ogg, dest, total >= 4096 ? 4096 : total, Swap_IsBigEndian(), 2, 1, NULL );
+		if ( ret <= 0 ) {
+			break;
+		}
+		dest += ret;
+		total -= ret;
+	}
+	ov_clear( &ogg );
+
+	decodeAheadTicks += Sys_GetPerformanceCounter() - start;
+
+	entry->state = ( total == 0 ) ? DECODE_DONE : DECODE_FAILED;
+}
+
+/*
+====================
+FindCachedDecode
+
+returns the fully decoded sample if there is one, else queues the sample to be decoded
+====================
+*/
+static const decoderCacheEntry_t *FindCachedDecode( idSoundSample *sample ) {
+	int maxBytes = idSoundSystemLocal::s_decoderCacheKB.GetInteger() << 10;
+
+	if ( maxBytes <= 0 || sample->LengthIn44kHzSamples() > DECODER_CACHE_MAX_SAMPLES ) {
+		return NULL;
+	}
+
+	int index = FindDecoderCacheEntry( sample );
+	if ( index != -1 ) {
+		decoderCacheEntry_t *entry = decoderCache[index];
+		if ( entry->state != DECODE_DONE ) {
+			return NULL;
+		}
+		entry->lastUsed = soundSystemLocal.CurrentSoundTime;
+		soundSystemLocal.soundStats.decodeCacheHits++;
+		return entry;
+	}
+
+	int size = sample->objectSize * sizeof( short );
+	if ( size > maxBytes ) {
+		return NULL;
+	}
+
+	// throw out the least recently used decodes until the sample fits
+	while ( decoderCacheBytes + size > maxBytes ) {
+		int oldest = -1;
+		for ( int i = 0; i < decoderCache.Num(); i++ ) {
+			int state = decoderCache[i]->state;
+			if ( state == DECODE_QUEUED || state == DECODE_RUNNING ) {
+				continue;
+			}
+			if ( oldest == -1 || decoderCache[i]->lastUsed < decoderCache[oldest]->lastUsed ) {
+				oldest = i;
+			}
+		}
+		if ( oldest == -1 ) {
+			return NULL;
+		}
+		RemoveDecoderCacheEntry( oldest );
+	}
+
+	decoderCacheEntry_t *entry = new decoderCacheEntry_t;
+	entry->sample = sample;
+	entry->pcm = (short *)Mem_Alloc( size );
+	entry->size = size;
+	entry->lastUsed = soundSystemLocal.CurrentSoundTime;
+	entry->state = DECODE_QUEUED;
+	decoderCacheBytes += size;
+
+	decoderCacheHash.Add( DecoderCacheHash( sample ), decoderCache.Append( entry ) );
+
+	return NULL;
+}
+
 /*
 ====================
 idSampleDecoder::Init
@@ -313,6 +525,11 @@ void idSampleDecoder::Init( void ) {
 	decoderMemoryAllocator.Init();
 	decoderMemoryAllocator.SetLockMemory( true );
 	decoderMemoryAllocator.SetFixedBlocks( idSoundSystemLocal::s_realTimeDecoding.GetBool() ? 10 : 1 );
+
+	if ( decodeAheadJobs == NULL ) {
+		decodeAheadJobs = jobSystem->AllocJobList( "soundDecode" );
+	}
+	decodeStatsTime = Sys_Milliseconds();
 }
 
 /*
@@ -321,6 +538,25 @@ idSampleDecoder::Shutdown
 ====================
 */
 void idSampleDecoder::Shutdown( void ) {
+	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+
+	if ( decodeAheadJobs != NULL ) {
+		decodeAheadJobs->Wait();
+		jobSystem->FreeJobList( decodeAheadJobs );
+		decodeAheadJobs = NULL;
+	}
+	decodeAheadQueue.Clear();
+
+	for ( int i = 0; i < decoderCache.Num(); i++ ) {
+		Mem_Free( decoderCache[i]->pcm );
+		delete decoderCache[i];
+	}
+	decoderCache.Clear();
+	decoderCacheHash.Clear();
+	decoderCacheBytes = 0;
+
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+
 	decoderMemoryAllocator.Shutdown();
 	sampleDecoderAllocator.Shutdown();
 }
@@ -344,6 +580,7 @@ idSampleDecoder::Free
 void idSampleDecoder::Free( idSampleDecoder *decoder ) {
 	idSampleDecoderLocal *localDecoder = static_cast<idSampleDecoderLocal *>( decoder );
 	localDecoder->ClearDecoder();
+	localDecoder->FreeRing();
 	sampleDecoderAllocator.Free( localDecoder );
 }
 
@@ -365,6 +602,183 @@ int idSampleDecoder::GetUsedBlockMemory( void ) {
 	return decoderMemoryAllocator.GetUsedBlockMemory();
 }
 
+/*
+====================
+idSampleDecoder::UpdateDecodeAhead
+====================
+*/
+void idSampleDecoder::UpdateDecodeAhead( void ) {
+	if ( decodeAheadJobs == NULL ) {
+		return;
+	}
+
+	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+
+	// the jobs of the last mix may still be running
+	if ( decodeAheadJobs->NumJobs() > 0 && !decodeAheadJobs->IsDone() ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+		return;
+	}
+	decodeAheadJobs->Clear();
+
+	for ( int i = 0; i < decodeAheadQueue.Num(); i++ ) {
+		decodeAheadQueue[i]->aheadState = DECODE_RUNNING;
+		decodeAheadJobs->AddJob( idSampleDecoderLocal::DecodeAheadJob, decodeAheadQueue[i], "soundDecodeAhead" );
+	}
+	decodeAheadQueue.SetNum( 0, false );
+
+	for ( int i = 0; i < decoderCache.Num(); i++ ) {
+		if ( decoderCache[i]->state == DECODE_QUEUED ) {
+			decoderCache[i]->state = DECODE_RUNNING;
+			decodeAheadJobs->AddJob( DecoderCacheJob, decoderCache[i], "soundDecodeCache" );
+		}
+	}
+
+	if ( decodeAheadJobs->NumJobs() > 0 ) {
+		decodeAheadJobs->Submit();
+		if ( jobSystem->GetNumWorkers() == 0 ) {
+			decodeAheadJobs->Wait();
+		}
+	}
+
+	// update the per second stats
+	int time = Sys_Milliseconds();
+	if ( time - decodeStatsTime >= 1000 ) {
+		float scale = 1000.0f / ( time - decodeStatsTime );
+		s_stats &stats = soundSystemLocal.soundStats;
+		stats.decodeAheadMS = Sys_GetPerformanceTimeMS( decodeAheadTicks.exchange( 0 ) ) * scale;
+		stats.decodeMixerMS = Sys_GetPerformanceTimeMS( decodeMixerTicks ) * scale;
+		stats.decodeCacheBytes = decoderCacheBytes;
+		decodeMixerTicks = 0;
+		decodeStatsTime = time;
+	}
+
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+}
+
+/*
+====================
+idSampleDecoder::PurgeSample
+====================
+*/
+void idSampleDecoder::PurgeSample( idSoundSample *sample ) {
+	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+
+	int index = FindDecoderCacheEntry( sample );
+	if ( index != -1 ) {
+		if ( decoderCache[index]->state == DECODE_RUNNING ) {
+			decodeAheadJobs->Wait();
+		}
+		decoderCache[index]->state = DECODE_FAILED;
+		RemoveDecoderCacheEntry( index );
+	}
+
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+}
+
+/*
+====================
+idSampleDecoder::Test_f
+
+decodes the start of a short ogg from the decoder cache, evicts the cache entry and decodes
+further on with the same decoder, both parts are compared with a decoder that streams the ogg
+====================
+*/
+void idSampleDecoder::Test_f( const idCmdArgs &args ) {
+	const int blockSamples = 4096;
+	const float maxError = 2.0f;
+
+	if ( args.Argc() != 2 ) {
+		common->Printf( "usage: testSoundDecoder <file>\n" );
+		return;
+	}
+	if ( idSoundSystemLocal::s_decoderCacheKB.GetInteger() <= 0 ) {
+		common->Printf( "s_decoderCacheKB is 0, the decoder cache is disabled\n" );
+		return;
+	}
+
+	idSoundSample *sample = soundSystemLocal.soundCache->FindSound( args.Argv( 1 ), false );
+	if ( sample == NULL || sample->defaultSound || sample->objectInfo.wFormatTag != WAVE_FORMAT_TAG_OGG || sample->nonCacheData == NULL ) {
+		common->Printf( "%s is not a streamed ogg\n", args.Argv( 1 ) );
+		return;
+	}
+	if ( sample->LengthIn44kHzSamples() > DECODER_CACHE_MAX_SAMPLES || sample->LengthIn44kHzSamples() < blockSamples * 4 ) {
+		common->Printf( "%s is too long or too short for the decoder cache\n", args.Argv( 1 ) );
+		return;
+	}
+
+	float *reference = (float *)Mem_Alloc16( blockSamples * 2 * sizeof( float ) );
+	float *test = (float *)Mem_Alloc16( blockSamples * 2 * sizeof( float ) );
+	int offsets[2] = { 0, blockSamples * 2 };
+
+	// reference decode straight from the stream
+	PurgeSample( sample );
+	idSampleDecoderLocal *streamed = static_cast<idSampleDecoderLocal *>( Alloc() );
+	for ( int i = 0; i < 2; i++ ) {
+		streamed->Decode( sample, offsets[i], blockSamples, reference + i * blockSamples );
+	}
+	Free( streamed );
+
+	// fill the cache entry right here instead of waiting for the sound thread
+	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+	FindCachedDecode( sample );
+	int index = FindDecoderCacheEntry( sample );
+	if ( index != -1 && decoderCache[index]->state == DECODE_QUEUED ) {
+		decoderCache[index]->state = DECODE_RUNNING;
+		DecoderCacheJob( decoderCache[index] );
+	} else if ( index != -1 && decoderCache[index]->state == DECODE_RUNNING ) {
+		decodeAheadJobs->Wait();
+	}
+	bool cached = ( index != -1 && decoderCache[index]->state == DECODE_DONE );
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+
+	if ( !cached ) {
+		common->Printf( "%s could not be put in the decoder cache\n", args.Argv( 1 ) );
+	} else {
+		idSampleDecoderLocal *decoder = static_cast<idSampleDecoderLocal *>( Alloc() );
+		float errors[2];
+
+		for ( int i = 0; i < 2; i++ ) {
+			if ( i == 1 ) {
+				// the decoder has to open the stream now
+				PurgeSample( sample );
+			}
+			decoder->Decode( sample, offsets[i], blockSamples, test + i * blockSamples );
+
+			errors[i] = 0.0f;
+			for ( int j = 0; j < blockSamples; j++ ) {
+				errors[i] = Max( errors[i], idMath::Fabs( test[i * blockSamples + j] - reference[i * blockSamples + j] ) );
+			}
+		}
+		bool failed = decoder->failed;
+		Free( decoder );
+
+		common->Printf( "cached: max error %.2f, evicted: max error %.2f%s\n", errors[0], errors[1], failed ? ", decoder failed" : "" );
+		common->Printf( "%s\n", ( errors[0] <= maxError && errors[1] <= maxError && !failed ) ? "passed" : "FAILED" );
+	}
+
+	PurgeSample( sample );
+
+	Mem_Free16( reference );
+	Mem_Free16( test );
+}
+
+/*
+====================
+idSampleDecoderLocal::idSampleDecoderLocal
+====================
+*/
+idSampleDecoderLocal::idSampleDecoderLocal( void ) {
+	memset( &ogg, 0, sizeof( ogg ) );
+	ring = NULL;
+	ringOffset44k = 0;
+	ringRead = 0;
+	ringWrite = 0;
+	aheadState = DECODE_IDLE;
+	aheadStop = false;
+	Clear();
+}
+
 /*
 ====================
 idSampleDecoderLocal::Clear
@@ -372,6 +786,7 @@ idSampleDecoderLocal::Clear
 */
 void idSampleDecoderLocal::Clear( void ) {
 	failed = false;
+	oggOpen = false;
 	lastFormat = WAVE_FORMAT_TAG_PCM;
 	lastSample = NULL;
 	lastSampleOffset = 0;
@@ -386,13 +801,20 @@ idSampleDecoderLocal::ClearDecoder
 void idSampleDecoderLocal::ClearDecoder( void ) {
 	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
 
+	WaitForDecodeAhead();
+	ringOffset44k = 0;
+	ringRead = 0;
+	ringWrite = 0;
+
 	switch( lastFormat ) {
 		case WAVE_FORMAT_TAG_PCM: {
 			break;
 		}
 		case WAVE_FORMAT_TAG_OGG: {
-			ov_clear( &ogg );
-			memset( &ogg, 0, sizeof( ogg ) );
+			if ( oggOpen ) {
+				ov_clear( &ogg );
+				memset( &ogg, 0, sizeof( ogg ) );
+			}
 			break;
 		}
 	}
@@ -402,6 +824,16 @@ void idSampleDecoderLocal::ClearDecoder( void ) {
 	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
 }
 
+/*
+====================
+idSampleDecoderLocal::FreeRing
+====================
+*/
+void idSampleDecoderLocal::FreeRing( void ) {
+	Mem_Free16( ring );
+	ring = NULL;
+}
+
 /*
 ====================
 idSampleDecoderLocal::GetSample
@@ -434,21 +866,66 @@ void idSampleDecoderLocal::Decode( idSoundSample *sample, int sampleOffset44k, i
 
 	lastDecodeTime = soundSystemLocal.CurrentSoundTime;
 
+	// samples can be decoded both from the sound thread and the main thread for shakes
+	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+
+	// the ring is read before anything else because a running decode ahead job owns the rest of the decoder
+	int ringSamples44k = 0;
+	if ( sample->objectInfo.wFormatTag == WAVE_FORMAT_TAG_OGG ) {
+		ringSamples44k = ReadRing( sampleOffset44k, sampleCount44k, dest );
+		if ( ringSamples44k == sampleCount44k ) {
+			RequestDecodeAhead();
+			Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+			return;
+		}
+		// reading on where the ring stopped while the job still has to fill it, even if it's empty
+		if ( ringSamples44k >= 0 && aheadState.load( std::memory_order_acquire ) != DECODE_IDLE ) {
+			soundSystemLocal.soundStats.decodeUnderruns++;
+		}
+		WaitForDecodeAhead();
+		if ( ringSamples44k >= 0 ) {
+			// take what the job decoded before it stopped so the stream doesn't have to seek back
+			ringSamples44k += Max( ReadRing( sampleOffset44k + ringSamples44k, sampleCount44k - ringSamples44k, dest + ringSamples44k ), 0 );
+			if ( ringSamples44k == sampleCount44k ) {
+				RequestDecodeAhead();
+				Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+				return;
+			}
+		} else {
+			ringSamples44k = 0;
+		}
+	}
+
 	if ( failed ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
 		memset( dest, 0, sampleCount44k * sizeof( dest[0] ) );
 		return;
 	}
 
-	// samples can be decoded both from the sound thread and the main thread for shakes
-	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
-
 	switch( sample->objectInfo.wFormatTag ) {
 		case WAVE_FORMAT_TAG_PCM: {
 			readSamples44k = DecodePCM( sample, sampleOffset44k, sampleCount44k, dest );
 			break;
 		}
 		case WAVE_FORMAT_TAG_OGG: {
-			readSamples44k = DecodeOGG( sample, sampleOffset44k, sampleCount44k, dest );
+			const decoderCacheEntry_t *entry = NULL;
+			if ( lastSample == NULL || ring == NULL ) {
+				entry = FindCachedDecode( sample );
+			}
+			if ( entry != NULL ) {
+				readSamples44k = DecodeCached( entry, sample, sampleOffset44k, sampleCount44k, dest );
+				break;
+			}
+
+			uint64 start = Sys_GetPerformanceCounter();
+			readSamples44k = ringSamples44k + DecodeOGG( sample, sampleOffset44k + ringSamples44k, sampleCount44k - ringSamples44k, dest + ringSamples44k );
+			decodeMixerTicks += Sys_GetPerformanceCounter() - start;
+
+			// continue decoding ahead from here
+			ringOffset44k = sampleOffset44k + readSamples44k;
+			ringRead = 0;
+			ringWrite = 0;
+			RequestDecodeAhead();
 			break;
 		}
 		default: {
@@ -464,6 +941,167 @@ void idSampleDecoderLocal::Decode( idSoundSample *sample, int sampleOffset44k, i
 	}
 }
 
+/*
+====================
+idSampleDecoderLocal::ReadRing
+
+copies the samples that were already decoded ahead, returns the number of samples copied,
+which is 0 if the ring is empty, or -1 if the samples don't follow the ring because
+there is no ring or the channel seeked
+====================
+*/
+int idSampleDecoderLocal::ReadRing( int sampleOffset44k, int sampleCount44k, float *dest ) {
+	if ( ring == NULL || lastSample == NULL ) {
+		return -1;
+	}
+
+	int read = ringRead.load( std::memory_order_relaxed );
+	if ( sampleOffset44k != ringOffset44k + read ) {
+		return -1;
+	}
+
+	int count = Min( ringWrite.load( std::memory_order_acquire ) - read, sampleCount44k );
+	int index = read % DECODE_AHEAD_SAMPLES;
+	int first = Min( count, DECODE_AHEAD_SAMPLES - index );
+
+	memcpy( dest, ring + index, first * sizeof( float ) );
+	memcpy( dest + first, ring, ( count - first ) * sizeof( float ) );
+
+	ringRead.store( read + count, std::memory_order_release );
+
+	return count;
+}
+
+/*
+====================
+idSampleDecoderLocal::RequestDecodeAhead
+
+queues the decoder for the next UpdateDecodeAhead if enough of the ring is free
+====================
+*/
+void idSampleDecoderLocal::RequestDecodeAhead( void ) {
+	if ( !idSoundSystemLocal::s_decodeAhead.GetBool() || lastFormat != WAVE_FORMAT_TAG_OGG || lastSample == NULL ) {
+		return;
+	}
+	if ( aheadState.load( std::memory_order_acquire ) != DECODE_IDLE || failed || decodeAheadJobs == NULL ) {
+		return;
+	}
+
+	int buffered = ringWrite.load( std::memory_order_relaxed ) - ringRead.load( std::memory_order_relaxed );
+	if ( DECODE_AHEAD_SAMPLES - buffered < DECODE_AHEAD_REFILL ) {
+		return;
+	}
+	if ( ringOffset44k + ringWrite.load( std::memory_order_relaxed ) >= lastSample->LengthIn44kHzSamples() ) {
+		return;
+	}
+
+	if ( ring == NULL ) {
+		ring = (float *)Mem_Alloc16( DECODE_AHEAD_SAMPLES * sizeof( float ) );
+	}
+
+	aheadStop = false;
+	aheadState = DECODE_QUEUED;
+	decodeAheadQueue.Append( this );
+}
+
+/*
+====================
+idSampleDecoderLocal::WaitForDecodeAhead
+
+after this the decoder belongs to the calling thread again, a queued job is dropped and a
+running job stops after the block it's decoding
+====================
+*/
+void idSampleDecoderLocal::WaitForDecodeAhead( void ) {
+	if ( aheadState == DECODE_QUEUED ) {
+		decodeAheadQueue.Remove( this );
+		aheadState = DECODE_IDLE;
+		return;
+	}
+	aheadStop.store( true, std::memory_order_relaxed );
+	while ( aheadState.load( std::memory_order_acquire ) == DECODE_RUNNING ) {
+		std::this_thread::yield();
+	}
+}
+
+/*
+====================
+idSampleDecoderLocal::DecodeAheadJob
+====================
+*/
+void idSampleDecoderLocal::DecodeAheadJob( void *data ) {
+	idSampleDecoderLocal *decoder = static_cast<idSampleDecoderLocal *>( data );
+
+	uint64 start = Sys_GetPerformanceCounter();
+
+	decoder->DecodeAhead();
+
+	decodeAheadTicks += Sys_GetPerformanceCounter() - start;
+
+	decoder->aheadState.store( DECODE_IDLE, std::memory_order_release );
+}
+
+/*
+====================
+idSampleDecoderLocal::DecodeAhead
+
+runs on a job worker and fills the free part of the ring, one refill at a time so a
+waiting mixer doesn't wait for the whole ring
+====================
+*/
+void idSampleDecoderLocal::DecodeAhead( void ) {
+	idSoundSample *sample = lastSample;
+	int write = ringWrite.load( std::memory_order_relaxed );
+	int space = DECODE_AHEAD_SAMPLES - ( write - ringRead.load( std::memory_order_acquire ) );
+	int remaining = sample->LengthIn44kHzSamples() - ( ringOffset44k + write );
+
+	// whole frames at the lowest sample rate, the tail of the sample is left to the mixer
+	int count = Min( space, remaining ) & ~7;
+
+	while ( count > 0 && !failed && !aheadStop.load( std::memory_order_relaxed ) ) {
+		int index = write % DECODE_AHEAD_SAMPLES;
+		int len = Min3( count, DECODE_AHEAD_SAMPLES - index, DECODE_AHEAD_REFILL );
+		int decoded = DecodeOGG( sample, ringOffset44k + write, len, ring + index );
+
+		write += decoded;
+		ringWrite.store( write, std::memory_order_release );
+
+		if ( decoded < len ) {
+			break;
+		}
+		count -= len;
+	}
+}
+
+/*
+====================
+idSampleDecoderLocal::DecodeCached
+====================
+*/
+int idSampleDecoderLocal::DecodeCached( const decoderCacheEntry_t *entry, idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest ) {
+	int readSamples;
+
+	// the ogg stream is not opened for cached samples, DecodeOGG opens it if the entry is evicted
+	lastFormat = WAVE_FORMAT_TAG_OGG;
+	lastSample = sample;
+
+	int shift = 22050 / sample->objectInfo.nSamplesPerSec;
+	int sampleOffset = sampleOffset44k >> shift;
+	int sampleCount = sampleCount44k >> shift;
+	int size = entry->size / sizeof( short );
+
+	if ( sampleOffset >= size ) {
+		return 0;
+	}
+
+	readSamples = Min( sampleCount, size - sampleOffset );
+
+	// duplicate samples for 44kHz output
+	SIMDProcessor->UpSamplePCMTo44kHz( dest, entry->pcm + sampleOffset, readSamples, sample->objectInfo.nSamplesPerSec, sample->objectInfo.nChannels );
+
+	return ( readSamples << shift );
+}
+
 /*
 ====================
 idSampleDecoderLocal::DecodePCM
@@ -516,7 +1154,7 @@ int idSampleDecoderLocal::DecodeOGG( idSoundSample *sample, int sampleOffset44k,
 	int sampleCount = sampleCount44k >> shift;
 
 	// open OGG file if not yet opened
-	if ( lastSample == NULL ) {
+	if ( !oggOpen ) {
 		// make sure there is enough space for another decoder
 		if ( decoderMemoryAllocator.GetFreeBlockMemory() < MIN_OGGVORBIS_MEMORY ) {
 			return 0;
@@ -531,8 +1169,10 @@ int idSampleDecoderLocal::DecodeOGG( idSoundSample *sample, int sampleOffset44k,
 			failed = true;
 			return 0;
 		}
+		oggOpen = true;
 		lastFormat = WAVE_FORMAT_TAG_OGG;
 		lastSample = sample;
+		lastSampleOffset = 0;
 	}
 
 	// seek to the right offset if necessary
@@ -1332,8 +1332,9 @@ void idSlowChannel::GenerateSlowChannel( FracTime& playPos, int sampleCount44k,
 	lowpass.GetContinuitySamples( in_p[-1], in_p[-2], out_p[-1], out_p[-2] );
 	lowpass.SetParms( slowmoSpeed * 15000, 1.2f );
 
+	lowpass.ProcessSamples( in_p, out_p, numSamples );
+
 	for ( int i = 0, count = 0; i < numSamples; i++, count += 2 ) {
-		lowpass.ProcessSample( in_p + i, out_p + i );
 		finalBuffer[count] = finalBuffer[count+1] = out[i];
 	}
 
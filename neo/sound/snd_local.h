@@ -302,6 +302,7 @@ class SoundFX_LowpassFast : public SoundFX {
 
 public:
 	virtual void		ProcessSample( float* in, float* out );
+	void				ProcessSamples( const float *in, float *out, int numSamples );
 	void				SetParms( float p1 = 0, float p2 = 0, float p3 = 0 );
 
 	void				Clear() {
@@ -523,6 +524,11 @@ public:
 		missedWindow = 0;
 		missedUpdateWindow = 0;
 		activeSounds = 0;
+		decodeAheadMS = 0.0f;
+		decodeMixerMS = 0.0f;
+		decodeUnderruns = 0;
+		decodeCacheHits = 0;
+		decodeCacheBytes = 0;
 	}
 	int		rinuse;
 	int		runs;
@@ -530,6 +536,11 @@ public:
 	int		missedWindow;
 	int		missedUpdateWindow;
 	int		activeSounds;
+	float	decodeAheadMS;		// ogg decode time per second on the job workers
+	float	decodeMixerMS;		// ogg decode time per second on the mixer thread
+	int		decodeUnderruns;	// times a channel read past its decoded ahead samples
+	int		decodeCacheHits;	// decodes served from fully decoded samples
+	int		decodeCacheBytes;	// memory used by fully decoded samples
 };
 
 typedef struct soundPortalTrace_s {
@@ -852,6 +863,8 @@ public:
 	static idCVar			s_force22kHz;
 	static idCVar			s_clipVolumes;
 	static idCVar			s_realTimeDecoding;
+	static idCVar			s_decodeAhead;
+	static idCVar			s_decoderCacheKB;
 	static idCVar			s_useEAXReverb;
 	static idCVar			s_decompressionLimit;
 
@@ -953,6 +966,9 @@ public:
 	static void				Free( idSampleDecoder *decoder );
 	static int				GetNumUsedBlocks( void );
 	static int				GetUsedBlockMemory( void );
+	static void				UpdateDecodeAhead( void );					// called after each mix, refills the decoders that ran low on the job workers
+	static void				PurgeSample( idSoundSample *sample );		// waits for the decode jobs and drops the fully decoded copy of the sample
+	static void				Test_f( const idCmdArgs &args );			// checks decoding a sample from the decoder cache, evicted and from the stream
 
 	virtual					~idSampleDecoder( void ) {}
 	virtual void			Decode( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest ) = 0;
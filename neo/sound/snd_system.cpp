@@ -28,6 +28,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "sys/platform.h"
 #include "idlib/LangDict.h"
+#include "idlib/hashing/CRC32.h"
 
 
 #include "sound/snd_local.h"
@@ -67,6 +68,8 @@ idCVar idSoundSystemLocal::s_numberOfSpeakers( "s_numberOfSpeakers", "2", CVAR_S
 idCVar idSoundSystemLocal::s_force22kHz( "s_force22kHz", "0", CVAR_SOUND | CVAR_BOOL, ""  );
 idCVar idSoundSystemLocal::s_clipVolumes( "s_clipVolumes", "1", CVAR_SOUND | CVAR_BOOL, ""  );
 idCVar idSoundSystemLocal::s_realTimeDecoding( "s_realTimeDecoding", "1", CVAR_SOUND | CVAR_BOOL | CVAR_INIT, "" );
+idCVar idSoundSystemLocal::s_decodeAhead( "s_decodeAhead", "1", CVAR_SOUND | CVAR_BOOL, "decode streaming ogg samples ahead of the mixer on the job workers" );
+idCVar idSoundSystemLocal::s_decoderCacheKB( "s_decoderCacheKB", "8192", CVAR_SOUND | CVAR_INTEGER, "memory for keeping short ogg samples fully decoded, 0 disables", 0, 262144 );
 
 idCVar idSoundSystemLocal::s_slowAttenuate( "s_slowAttenuate", "1", CVAR_SOUND | CVAR_BOOL, "slowmo sounds attenuate over shorted distance" );
 idCVar idSoundSystemLocal::s_reverbTime( "s_reverbTime", "1000", CVAR_SOUND | CVAR_FLOAT, "" );
@@ -306,6 +309,118 @@ void ListSoundDecoders_f( const idCmdArgs &args ) {
 	common->Printf( "%d waiting decoders\n", numWaitingDecoders );
 	common->Printf( "%d active decoders\n", numActiveDecoders );
 	common->Printf( "%d kB decoder memory in %d blocks\n", idSampleDecoder::GetUsedBlockMemory() >> 10, idSampleDecoder::GetNumUsedBlocks() );
+
+	const s_stats &stats = soundSystemLocal.soundStats;
+	common->Printf( "%.2f ms/sec decoding ahead, %.2f ms/sec decoding in the mixer\n", stats.decodeAheadMS, stats.decodeMixerMS );
+	common->Printf( "%d decode underruns\n", stats.decodeUnderruns );
+	common->Printf( "%d kB fully decoded samples, %d cache hits\n", stats.decodeCacheBytes >> 10, stats.decodeCacheHits );
+}
+
+/*
+===============
+TestSoundMix_f
+
+renders a fixed set of generated emitters through the mixing kernels into a buffer,
+no sound world or audio device is involved
+===============
+*/
+void TestSoundMix_f( const idCmdArgs &args ) {
+	int numEmitters = idMath::ClampInt( 1, 256, ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 32 );
+	int numBlocks = idMath::ClampInt( 1, 10000, ( args.Argc() > 2 ) ? atoi( args.Argv( 2 ) ) : 100 );
+
+	// every other emitter is stereo
+	float *samples = (float *)Mem_Alloc16( numEmitters * MIXBUFFER_SAMPLES * 2 * sizeof( float ) );
+	float *mix = (float *)Mem_Alloc16( MIXBUFFER_SAMPLES * 6 * sizeof( float ) );
+	float *filtered = (float *)Mem_Alloc16( ( MIXBUFFER_SAMPLES + 2 ) * sizeof( float ) );
+	short *output = (short *)Mem_Alloc16( MIXBUFFER_SAMPLES * 6 * sizeof( short ) );
+	float lastV[256][6];
+	idRandom random( 0 );
+
+	for ( int e = 0; e < numEmitters; e++ ) {
+		float *s = samples + e * MIXBUFFER_SAMPLES * 2;
+		float freq = idMath::TWO_PI * ( 110.0f + e * 37.0f ) / 44100.0f;
+		for ( int i = 0; i < MIXBUFFER_SAMPLES * 2; i++ ) {
+			s[i] = 16000.0f * idMath::Sin( freq * ( i >> ( e & 1 ) ) ) + 2000.0f * random.CRandomFloat();
+		}
+	}
+
+	common->Printf( "mixing %d emitters, %d blocks of %d samples\n", numEmitters, numBlocks, MIXBUFFER_SAMPLES );
+
+	for ( int numSpeakers = 2; numSpeakers <= 6; numSpeakers += 4 ) {
+		random.SetSeed( numSpeakers );
+		for ( int e = 0; e < numEmitters; e++ ) {
+			for ( int j = 0; j < 6; j++ ) {
+				lastV[e][j] = random.RandomFloat();
+			}
+		}
+
+		unsigned int crc = 0;
+		uint64 ticks = 0;
+
+		for ( int b = 0; b < numBlocks; b++ ) {
+			uint64 start = Sys_GetPerformanceCounter();
+
+			SIMDProcessor->Memset( mix, 0, MIXBUFFER_SAMPLES * numSpeakers * sizeof( float ) );
+
+			for ( int e = 0; e < numEmitters; e++ ) {
+				const float *s = samples + e * MIXBUFFER_SAMPLES * 2;
+				float ears[6];
+
+				// volume ramps like moving emitters
+				for ( int j = 0; j < 6; j++ ) {
+					ears[j] = idMath::ClampFloat( 0.0f, 1.0f, lastV[e][j] + 0.25f * random.CRandomFloat() );
+				}
+
+				if ( numSpeakers == 6 ) {
+					if ( e & 1 ) {
+						SIMDProcessor->MixSoundSixSpeakerStereo( mix, s, MIXBUFFER_SAMPLES, lastV[e], ears );
+					} else {
+						SIMDProcessor->MixSoundSixSpeakerMono( mix, s, MIXBUFFER_SAMPLES, lastV[e], ears );
+					}
+				} else {
+					if ( e & 1 ) {
+						SIMDProcessor->MixSoundTwoSpeakerStereo( mix, s, MIXBUFFER_SAMPLES, lastV[e], ears );
+					} else {
+						SIMDProcessor->MixSoundTwoSpeakerMono( mix, s, MIXBUFFER_SAMPLES, lastV[e], ears );
+					}
+				}
+
+				for ( int j = 0; j < 6; j++ ) {
+					lastV[e][j] = ears[j];
+				}
+			}
+
+			SIMDProcessor->MixedSoundToSamples( output, mix, MIXBUFFER_SAMPLES * numSpeakers );
+
+			ticks += Sys_GetPerformanceCounter() - start;
+
+			crc ^= CRC32_BlockChecksum( output, MIXBUFFER_SAMPLES * numSpeakers * sizeof( short ) );
+		}
+
+		double ms = Sys_GetPerformanceTimeMS( ticks ) / numBlocks;
+		common->Printf( "%d speakers: %.3f ms per block, %.1fx realtime, checksum %08x\n", numSpeakers, ms, ( 1000.0 * MIXBUFFER_SAMPLES / 44100.0 ) / ms, crc );
+	}
+
+	// the slow-mo lowpass every slowed channel runs on half rate samples
+	SoundFX_LowpassFast lowpass;
+	lowpass.Clear();
+	lowpass.SetParms( 0.5f * 15000, 1.2f );
+
+	uint64 start = Sys_GetPerformanceCounter();
+	for ( int b = 0; b < numBlocks; b++ ) {
+		for ( int e = 0; e < numEmitters; e++ ) {
+			const float *s = samples + e * MIXBUFFER_SAMPLES * 2;
+			filtered[0] = filtered[1] = 0.0f;
+			lowpass.ProcessSamples( s + 2, filtered + 2, ( MIXBUFFER_SAMPLES >> 1 ) - 2 );
+		}
+	}
+	double ms = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - start ) / numBlocks;
+	common->Printf( "slow-mo lowpass: %.3f ms per block\n", ms );
+
+	Mem_Free16( samples );
+	Mem_Free16( mix );
+	Mem_Free16( filtered );
+	Mem_Free16( output );
 }
 
 /*
@@ -529,6 +644,8 @@ void idSoundSystemLocal::Init() {
 	cmdSystem->AddCommand( "reloadSounds", SoundReloadSounds_f, CMD_FL_SOUND|CMD_FL_CHEAT, "reloads all sounds" );
 	cmdSystem->AddCommand( "testSound", TestSound_f, CMD_FL_SOUND | CMD_FL_CHEAT, "tests a sound", idCmdSystem::ArgCompletion_SoundName );
 	cmdSystem->AddCommand( "s_restart", SoundSystemRestart_f, CMD_FL_SOUND, "restarts the sound system" );
+	cmdSystem->AddCommand( "testSoundMix", TestSoundMix_f, CMD_FL_SOUND, "benchmarks the sound mixing kernels offline, usage: testSoundMix [emitters] [blocks]" );
+	cmdSystem->AddCommand( "testSoundDecoder", idSampleDecoder::Test_f, CMD_FL_SOUND, "compares a short ogg decoded from the decoder cache and after its cache entry was evicted, usage: testSoundDecoder <file>" );
 }
 
 /*
@@ -1295,6 +1412,23 @@ void SoundFX_LowpassFast::ProcessSample( float* in, float* out ) {
 	out[0] = a1 * in[0] + a2 * in[-1] + a3 * in[-2] - b1 * out[-1] - b2 * out[-2];
 }
 
+// filters numSamples samples in one go, in[-2..-1] and out[-2..-1] have to hold the previous samples
+void SoundFX_LowpassFast::ProcessSamples( const float *in, float *out, int numSamples ) {
+	// keep the filter history in registers instead of reading it back from out for every sample
+	float in1 = in[-1], in2 = in[-2];
+	float out1 = out[-1], out2 = out[-2];
+
+	for ( int i = 0; i < numSamples; i++ ) {
+		const float in0 = in[i];
+		const float out0 = a1 * in0 + a2 * in1 + a3 * in2 - b1 * out1 - b2 * out2;
+		out[i] = out0;
+		in2 = in1;
+		in1 = in0;
+		out2 = out1;
+		out1 = out0;
+	}
+}
+
 void SoundFX_LowpassFast::SetParms( float p1, float p2, float p3 ) {
 	float c;
 
@@ -29,6 +29,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "sys/platform.h"
 #include "framework/FileSystem.h"
 #include "framework/Session.h"
+#include "framework/Profiler.h"
 #include "renderer/RenderWorld.h"
 #include "gamesys/SaveGame.h"
 
@@ -537,6 +538,8 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 	idSoundEmitterLocal *sound;
 	bool isWindowActive = GLimp_WindowActive();
 
+	PROFILE_SCOPE( "idSoundWorldLocal::MixLoop" );
+
 	// listenerArea will equal -1 if we're noclipping outside the world
 	// The other condition is handling mute if the window is unfocused
 	if ( listenerArea == -1 || (muteInBackground && !isWindowActive)) {
@@ -709,6 +712,9 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 		}
 	}
 
+	// refill the decoders that were drained by this mix
+	idSampleDecoder::UpdateDecodeAhead();
+
 	// SW: This *seems* to be an alternative way of applying an envirosuit-style muffling effect without the use of EFX/EAX.
 	// As far as I can tell, the difference is negligible. We might as well just use the EFX filter and leave this unused.
 	/*if ( false && enviroSuitActive ) {
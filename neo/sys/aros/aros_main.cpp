@@ -281,6 +281,13 @@ ID_TIME_T Sys_FileTimeStamp(FILE * fp) {
     return st.st_mtime;
 }
 
+const void *Sys_MapFile( const char *path, int &length ) {
+	return NULL;
+}
+
+void Sys_UnmapFile( const void *data, int length ) {
+}
+
 bool Sys_FPU_StackIsEmpty( void ) {
     bug("[ADoom3] %s()\n", __PRETTY_FUNCTION__);
 
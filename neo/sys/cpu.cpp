@@ -99,6 +99,7 @@ static inline void CPUid(int index, int *a, int *b, int *c, int *d) {
 #endif
 
 #define c_SSE3		(1 << 0)
+#define c_FMA3		(1 << 12)
 #define d_FXSAVE	(1 << 24)
 
 static inline bool HasDAZ() {
@@ -125,6 +126,18 @@ static inline bool HasSSE3() {
 	return (c & c_SSE3) == c_SSE3;
 }
 
+static inline bool HasFMA3() {
+	int a, b, c, d;
+
+	CPUid(0, &a, &b, &c, &d);
+	if (a < 1)
+		return false;
+
+	CPUid(1, &a, &b, &c, &d);
+
+	return (c & c_FMA3) == c_FMA3;
+}
+
 #define MXCSR_DAZ	(1 << 6)
 #define MXCSR_FTZ	(1 << 15)
 
@@ -217,6 +230,15 @@ int Sys_GetProcessorId( void ) {
 	if (SDL_HasAltiVec())
 		flags |= CPUID_ALTIVEC;
 
+	// SDL checks that the OS saves the AVX registers, FMA3 comes with the same VEX encoding
+	if (SDL_HasAVX2())
+		flags |= CPUID_AVX2;
+
+#ifndef NO_CPUID
+	if (HasFMA3())
+		flags |= CPUID_FMA3;
+#endif
+
 	return flags;
 }
 
@@ -0,0 +1,909 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "sys/platform.h"
+#include "framework/Common.h"
+#include "framework/CmdSystem.h"
+#include "framework/CVarSystem.h"
+#include "framework/Profiler.h"
+
+#include "sys/sys_public.h"
+
+idCVar com_jobWorkers( "com_jobWorkers", "-1", CVAR_INTEGER | CVAR_SYSTEM | CVAR_INIT, "number of job worker threads, -1 = one per core minus the main thread, 0 = run jobs on the waiting thread", -1, MAX_JOB_THREADS );
+
+/*
+==============================================================
+
+	job queue
+
+	Work stealing deque. The owning worker pushes and pops at the
+	back (LIFO, cache friendly), other threads steal from the front.
+	Jobs are tiny so a short lock per operation is cheaper than the
+	bookkeeping of a lock free deque.
+
+==============================================================
+*/
+
+class idJobListLocal;
+
+typedef struct {
+	jobRun_t			function;
+	void *				data;
+	const char *		tag;
+	idJobListLocal *	list;
+} job_t;
+
+class idJobQueue {
+public:
+						idJobQueue( void );
+						~idJobQueue( void );
+
+	void				Push( const job_t &job );
+	bool				Pop( job_t &job );
+	bool				Steal( job_t &job );
+
+private:
+	std::mutex			lock;
+	job_t *				jobs;
+	int					capacity;		// always a power of two
+	int					head;			// front, where thieves take jobs
+	int					tail;			// back, one past the newest job
+
+	void				Grow( void );
+};
+
+/*
+================
+idJobQueue::idJobQueue
+================
+*/
+idJobQueue::idJobQueue( void ) {
+	capacity = 256;
+	jobs = new job_t[capacity];
+	head = 0;
+	tail = 0;
+}
+
+/*
+================
+idJobQueue::~idJobQueue
+================
+*/
+idJobQueue::~idJobQueue( void ) {
+	delete[] jobs;
+}
+
+/*
+================
+idJobQueue::Grow
+================
+*/
+void idJobQueue::Grow( void ) {
+	job_t *newJobs = new job_t[capacity * 2];
+	int num = tail - head;
+	for ( int i = 0; i < num; i++ ) {
+		newJobs[i] = jobs[( head + i ) & ( capacity - 1 )];
+	}
+	delete[] jobs;
+	jobs = newJobs;
+	capacity *= 2;
+	head = 0;
+	tail = num;
+}
+
+/*
+================
+idJobQueue::Push
+================
+*/
+void idJobQueue::Push( const job_t &job ) {
+	std::lock_guard<std::mutex> guard( lock );
+	if ( tail - head >= capacity ) {
+		Grow();
+	}
+	jobs[tail & ( capacity - 1 )] = job;
+	tail++;
+}
+
+/*
+================
+idJobQueue::Pop
+================
+*/
+bool idJobQueue::Pop( job_t &job ) {
+	std::lock_guard<std::mutex> guard( lock );
+	if ( tail == head ) {
+		return false;
+	}
+	tail--;
+	job = jobs[tail & ( capacity - 1 )];
+	if ( tail == head ) {
+		head = tail = 0;
+	}
+	return true;
+}
+
+/*
+================
+idJobQueue::Steal
+================
+*/
+bool idJobQueue::Steal( job_t &job ) {
+	std::lock_guard<std::mutex> guard( lock );
+	if ( tail == head ) {
+		return false;
+	}
+	job = jobs[head & ( capacity - 1 )];
+	head++;
+	if ( tail == head ) {
+		head = tail = 0;
+	}
+	return true;
+}
+
+/*
+==============================================================
+
+	per thread job statistics
+
+	Each worker only writes its own table so no locking is needed,
+	the table of the other threads is shared by the main, sound and
+	file threads and is updated under a lock. listJobs reads them
+	while the workers may still update them.
+
+==============================================================
+*/
+
+const int MAX_JOB_TAGS = 64;
+
+typedef struct {
+	const char *		tag;
+	int					count;
+	uint64				ticks;
+} jobTagStats_t;
+
+typedef struct {
+	int					numJobs;
+	int					numStolen;
+	uint64				ticks;
+	int					numTags;
+	jobTagStats_t		tags[MAX_JOB_TAGS];
+} jobThreadStats_t;
+
+/*
+==============================================================
+
+	idJobListLocal
+
+==============================================================
+*/
+
+class idJobSystemLocal;
+
+class idJobListLocal : public idJobList {
+public:
+							idJobListLocal( idJobSystemLocal *system, const char *name );
+
+	virtual void			AddJob( jobRun_t function, void *data, const char *tag = NULL );
+	virtual void			SetContinuation( jobRun_t function, void *data );
+	virtual void			Submit( void );
+	virtual void			Wait( void );
+	virtual bool			IsDone( void ) const;
+	virtual void			Clear( void );
+	virtual int				NumJobs( void ) const { return jobs.Num(); }
+	virtual const char *	GetName( void ) const { return name.c_str(); }
+	virtual double			GetLastRunTimeMS( void ) const { return lastRunTimeMS; }
+
+	void					JobFinished( void );
+
+private:
+	idJobSystemLocal *		system;
+	idStr					name;
+	idList<job_t>			jobs;
+	jobRun_t				continuation;
+	void *					continuationData;
+	std::atomic<int>		numRemaining;
+	std::atomic<bool>		done;
+	bool					running;
+	uint64					submitTime;
+	double					lastRunTimeMS;
+};
+
+/*
+==============================================================
+
+	idJobSystemLocal
+
+==============================================================
+*/
+
+typedef struct {
+	idJobSystemLocal *		system;
+	int						index;
+} jobWorkerParms_t;
+
+class idJobSystemLocal : public idJobSystem {
+public:
+							idJobSystemLocal( const char *threadPrefix = "jobWorker" );
+
+	virtual void			Init( int numWorkers = -1 );
+	virtual void			Shutdown( void );
+	virtual int				GetNumWorkers( void ) const { return numWorkers; }
+	virtual int				GetThreadIndex( void ) const;
+	virtual idJobList *		AllocJobList( const char *name );
+	virtual void			FreeJobList( idJobList *jobList );
+
+	void					SubmitJobs( const job_t *jobs, int numJobs );
+	bool					GetJob( int threadIndex, job_t &job );
+	void					ExecuteJob( int threadIndex, const job_t &job );
+	int						GetCallerIndex( void ) const;
+	void					AddStats( int threadIndex, const char *tag, uint64 ticks );
+	void					AddStolen( int threadIndex );
+
+	void					PrintStats( void ) const;
+	void					ClearStats( void );
+
+	static void				ListJobs_f( const idCmdArgs &args );
+	static void				TestJobs_f( const idCmdArgs &args );
+
+private:
+	// one queue per worker plus one for the other threads when there are no workers
+	idJobQueue				queues[MAX_JOB_THREADS + 1];
+	// one stats table per worker plus one shared by all other threads
+	jobThreadStats_t		stats[MAX_JOB_THREADS + 1];
+	std::mutex				otherStatsLock;
+	xthreadInfo				threads[MAX_JOB_THREADS];
+	jobWorkerParms_t		workerParms[MAX_JOB_THREADS];
+	idStr					threadNames[MAX_JOB_THREADS];
+	const char *			threadPrefix;
+	int						numWorkers;
+	bool					initialized;
+
+	std::atomic<int>		numQueued;
+	std::atomic<int>		nextQueue;
+	std::atomic<bool>		exiting;
+	std::mutex				sleepLock;
+	std::condition_variable	sleepCond;
+
+	idList<idJobListLocal *> jobLists;
+
+	static int				WorkerThread( void *parm );
+};
+
+static idJobSystemLocal		jobSystemLocal;
+idJobSystem *				jobSystem = &jobSystemLocal;
+
+// index of the worker running on this thread, -1 for the main and other threads
+static thread_local int		jobThreadIndex = -1;
+
+/*
+================
+idJobListLocal::idJobListLocal
+================
+*/
+idJobListLocal::idJobListLocal( idJobSystemLocal *system, const char *name ) {
+	this->system = system;
+	this->name = name;
+	continuation = NULL;
+	continuationData = NULL;
+	numRemaining = 0;
+	done = true;
+	running = false;
+	submitTime = 0;
+	lastRunTimeMS = 0.0;
+}
+
+/*
+================
+idJobListLocal::AddJob
+================
+*/
+void idJobListLocal::AddJob( jobRun_t function, void *data, const char *tag ) {
+	assert( !running );
+	job_t &job = jobs.Alloc();
+	job.function = function;
+	job.data = data;
+	job.tag = ( tag != NULL ) ? tag : name.c_str();
+	job.list = this;
+}
+
+/*
+================
+idJobListLocal::SetContinuation
+================
+*/
+void idJobListLocal::SetContinuation( jobRun_t function, void *data ) {
+	assert( !running );
+	continuation = function;
+	continuationData = data;
+}
+
+/*
+================
+idJobListLocal::Submit
+================
+*/
+void idJobListLocal::Submit( void ) {
+	assert( !running );
+
+	running = true;
+	done = false;
+	submitTime = Sys_GetPerformanceCounter();
+
+	if ( jobs.Num() == 0 ) {
+		numRemaining = 1;
+		JobFinished();
+		return;
+	}
+
+	numRemaining = jobs.Num();
+	system->SubmitJobs( jobs.Ptr(), jobs.Num() );
+}
+
+/*
+================
+idJobListLocal::Wait
+================
+*/
+void idJobListLocal::Wait( void ) {
+	if ( !running ) {
+		return;
+	}
+
+	int threadIndex = system->GetCallerIndex();
+	while ( !done.load( std::memory_order_acquire ) ) {
+		job_t job;
+		if ( system->GetJob( threadIndex, job ) ) {
+			system->ExecuteJob( threadIndex, job );
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	running = false;
+}
+
+/*
+================
+idJobListLocal::IsDone
+================
+*/
+bool idJobListLocal::IsDone( void ) const {
+	return done.load( std::memory_order_acquire );
+}
+
+/*
+================
+idJobListLocal::Clear
+================
+*/
+void idJobListLocal::Clear( void ) {
+	assert( !running || IsDone() );
+	running = false;
+	jobs.SetNum( 0, false );
+	continuation = NULL;
+	continuationData = NULL;
+}
+
+/*
+================
+idJobListLocal::JobFinished
+
+the thread that finishes the last job runs the continuation
+================
+*/
+void idJobListLocal::JobFinished( void ) {
+	if ( numRemaining.fetch_sub( 1, std::memory_order_acq_rel ) != 1 ) {
+		return;
+	}
+	if ( continuation != NULL ) {
+		continuation( continuationData );
+	}
+	lastRunTimeMS = Sys_GetPerformanceTimeMS( Sys_GetPerformanceCounter() - submitTime );
+	done.store( true, std::memory_order_release );
+}
+
+/*
+================
+idJobSystemLocal::idJobSystemLocal
+================
+*/
+idJobSystemLocal::idJobSystemLocal( const char *threadPrefix ) {
+	this->threadPrefix = threadPrefix;
+	numWorkers = 0;
+	initialized = false;
+	numQueued = 0;
+	nextQueue = 0;
+	exiting = false;
+	memset( stats, 0, sizeof( stats ) );
+	memset( threads, 0, sizeof( threads ) );
+}
+
+/*
+================
+idJobSystemLocal::WorkerThread
+================
+*/
+int idJobSystemLocal::WorkerThread( void *parm ) {
+	jobWorkerParms_t *parms = (jobWorkerParms_t *)parm;
+	idJobSystemLocal *system = parms->system;
+	int index = parms->index;
+
+	jobThreadIndex = index;
+
+	while ( 1 ) {
+		job_t job;
+		if ( system->GetJob( index, job ) ) {
+			system->ExecuteJob( index, job );
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock( system->sleepLock );
+		system->sleepCond.wait( lock, [system] { return system->exiting.load() || system->numQueued.load() > 0; } );
+		if ( system->exiting.load() && system->numQueued.load() == 0 ) {
+			break;
+		}
+	}
+
+	jobThreadIndex = -1;
+	return 0;
+}
+
+/*
+================
+idJobSystemLocal::Init
+================
+*/
+void idJobSystemLocal::Init( int numWorkers ) {
+	if ( initialized ) {
+		Shutdown();
+	}
+
+	if ( numWorkers < 0 ) {
+		numWorkers = com_jobWorkers.GetInteger();
+	}
+	if ( numWorkers < 0 ) {
+		// leave one core for the main thread
+		numWorkers = (int)std::thread::hardware_concurrency() - 1;
+	}
+	this->numWorkers = idMath::ClampInt( 0, MAX_JOB_THREADS, numWorkers );
+
+	exiting = false;
+	numQueued = 0;
+	nextQueue = 0;
+
+	for ( int i = 0; i < this->numWorkers; i++ ) {
+		threadNames[i] = va( "%s%d", threadPrefix, i );
+		workerParms[i].system = this;
+		workerParms[i].index = i;
+		Sys_CreateThread( WorkerThread, &workerParms[i], threads[i], threadNames[i].c_str() );
+	}
+
+	static bool commandsAdded = false;
+	if ( !commandsAdded ) {
+		cmdSystem->AddCommand( "listJobs", ListJobs_f, CMD_FL_SYSTEM, "lists job system workers and per tag job timings, 'listJobs clear' resets them" );
+		cmdSystem->AddCommand( "testJobs", TestJobs_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "measures job scheduling overhead and scaling over the number of workers" );
+		commandsAdded = true;
+	}
+
+	initialized = true;
+
+	common->DPrintf( "job system: %d worker threads\n", this->numWorkers );
+}
+
+/*
+================
+idJobSystemLocal::Shutdown
+
+workers finish all queued jobs before they exit
+================
+*/
+void idJobSystemLocal::Shutdown( void ) {
+	if ( !initialized ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard( sleepLock );
+		exiting = true;
+	}
+	sleepCond.notify_all();
+
+	for ( int i = 0; i < numWorkers; i++ ) {
+		Sys_DestroyThread( threads[i] );
+	}
+
+	// anything that was submitted to the shared queue after the workers left
+	job_t job;
+	while ( queues[MAX_JOB_THREADS].Pop( job ) ) {
+		numQueued--;
+		ExecuteJob( MAX_JOB_THREADS, job );
+	}
+
+	numWorkers = 0;
+	initialized = false;
+}
+
+/*
+================
+idJobSystemLocal::GetThreadIndex
+================
+*/
+int idJobSystemLocal::GetThreadIndex( void ) const {
+	return jobThreadIndex;
+}
+
+/*
+================
+idJobSystemLocal::GetCallerIndex
+
+queue and stats slot used by the calling thread
+================
+*/
+int idJobSystemLocal::GetCallerIndex( void ) const {
+	return ( jobThreadIndex >= 0 ) ? jobThreadIndex : MAX_JOB_THREADS;
+}
+
+/*
+================
+idJobSystemLocal::AllocJobList
+================
+*/
+idJobList *idJobSystemLocal::AllocJobList( const char *name ) {
+	idJobListLocal *list = new idJobListLocal( this, name );
+	jobLists.Append( list );
+	return list;
+}
+
+/*
+================
+idJobSystemLocal::FreeJobList
+================
+*/
+void idJobSystemLocal::FreeJobList( idJobList *jobList ) {
+	if ( jobList == NULL ) {
+		return;
+	}
+	jobList->Wait();
+	jobLists.Remove( static_cast<idJobListLocal *>( jobList ) );
+	delete jobList;
+}
+
+/*
+================
+idJobSystemLocal::SubmitJobs
+
+workers push nested jobs to their own queue, other threads spread
+the jobs over all workers so they start without having to steal
+================
+*/
+void idJobSystemLocal::SubmitJobs( const job_t *jobs, int numJobs ) {
+	numQueued.fetch_add( numJobs );
+
+	if ( jobThreadIndex >= 0 ) {
+		for ( int i = 0; i < numJobs; i++ ) {
+			queues[jobThreadIndex].Push( jobs[i] );
+		}
+	} else if ( numWorkers == 0 ) {
+		for ( int i = 0; i < numJobs; i++ ) {
+			queues[MAX_JOB_THREADS].Push( jobs[i] );
+		}
+	} else {
+		int start = nextQueue.fetch_add( 1 );
+		for ( int i = 0; i < numJobs; i++ ) {
+			queues[( start + i ) % numWorkers].Push( jobs[i] );
+		}
+	}
+
+	// taking the lock makes sure no worker misses the wake up between its check and its wait
+	{
+		std::lock_guard<std::mutex> guard( sleepLock );
+	}
+	sleepCond.notify_all();
+}
+
+/*
+================
+idJobSystemLocal::GetJob
+================
+*/
+bool idJobSystemLocal::GetJob( int threadIndex, job_t &job ) {
+	if ( numQueued.load() <= 0 ) {
+		return false;
+	}
+
+	if ( queues[threadIndex].Pop( job ) ) {
+		numQueued--;
+		return true;
+	}
+
+	// steal from the other workers, starting with the next one so thieves don't all hit the same queue
+	int numQueues = numWorkers;
+	for ( int i = 1; i <= numQueues; i++ ) {
+		int victim = ( threadIndex + i ) % numQueues;
+		if ( victim != threadIndex && queues[victim].Steal( job ) ) {
+			numQueued--;
+			AddStolen( threadIndex );
+			return true;
+		}
+	}
+
+	if ( threadIndex != MAX_JOB_THREADS && queues[MAX_JOB_THREADS].Steal( job ) ) {
+		numQueued--;
+		AddStolen( threadIndex );
+		return true;
+	}
+
+	return false;
+}
+
+/*
+================
+idJobSystemLocal::ExecuteJob
+================
+*/
+void idJobSystemLocal::ExecuteJob( int threadIndex, const job_t &job ) {
+	uint64 start = Sys_GetPerformanceCounter();
+	job.function( job.data );
+	uint64 ticks = Sys_GetPerformanceCounter() - start;
+
+	if ( profiler->IsRecording() ) {
+		profiler->AddEvent( job.tag, start, start + ticks );
+	}
+
+	AddStats( threadIndex, job.tag, ticks );
+
+	job.list->JobFinished();
+}
+
+/*
+================
+idJobSystemLocal::AddStolen
+================
+*/
+void idJobSystemLocal::AddStolen( int threadIndex ) {
+	if ( threadIndex == MAX_JOB_THREADS ) {
+		std::lock_guard<std::mutex> guard( otherStatsLock );
+		stats[threadIndex].numStolen++;
+	} else {
+		stats[threadIndex].numStolen++;
+	}
+}
+
+/*
+================
+idJobSystemLocal::AddStats
+================
+*/
+void idJobSystemLocal::AddStats( int threadIndex, const char *tag, uint64 ticks ) {
+	std::unique_lock<std::mutex> guard( otherStatsLock, std::defer_lock );
+	if ( threadIndex == MAX_JOB_THREADS ) {
+		guard.lock();
+	}
+
+	jobThreadStats_t &threadStats = stats[threadIndex];
+	threadStats.numJobs++;
+	threadStats.ticks += ticks;
+
+	int i;
+	for ( i = 0; i < threadStats.numTags; i++ ) {
+		if ( threadStats.tags[i].tag == tag ) {
+			break;
+		}
+	}
+	if ( i == threadStats.numTags && i < MAX_JOB_TAGS ) {
+		threadStats.tags[i].tag = tag;
+		threadStats.tags[i].count = 0;
+		threadStats.tags[i].ticks = 0;
+		threadStats.numTags++;
+	}
+	if ( i < MAX_JOB_TAGS ) {
+		threadStats.tags[i].count++;
+		threadStats.tags[i].ticks += ticks;
+	}
+}
+
+/*
+================
+idJobSystemLocal::ClearStats
+================
+*/
+void idJobSystemLocal::ClearStats( void ) {
+	memset( stats, 0, sizeof( stats ) );
+}
+
+/*
+================
+idJobSystemLocal::PrintStats
+================
+*/
+void idJobSystemLocal::PrintStats( void ) const {
+	common->Printf( "%d workers, %d queued jobs, %d job lists\n", numWorkers, numQueued.load(), jobLists.Num() );
+
+	common->Printf( "thread       jobs   stolen        ms\n" );
+	for ( int i = 0; i <= MAX_JOB_THREADS; i++ ) {
+		if ( i >= numWorkers && i < MAX_JOB_THREADS ) {
+			continue;
+		}
+		const jobThreadStats_t &s = stats[i];
+		common->Printf( "%-10s %6d %8d %9.2f\n", ( i == MAX_JOB_THREADS ) ? "other" : threadNames[i].c_str(), s.numJobs, s.numStolen, Sys_GetPerformanceTimeMS( s.ticks ) );
+	}
+
+	// merge the per thread tag tables
+	idList<jobTagStats_t> tags;
+	for ( int i = 0; i <= MAX_JOB_THREADS; i++ ) {
+		const jobThreadStats_t &s = stats[i];
+		for ( int j = 0; j < s.numTags; j++ ) {
+			int k;
+			for ( k = 0; k < tags.Num(); k++ ) {
+				if ( tags[k].tag == s.tags[j].tag || idStr::Cmp( tags[k].tag, s.tags[j].tag ) == 0 ) {
+					break;
+				}
+			}
+			if ( k == tags.Num() ) {
+				jobTagStats_t &t = tags.Alloc();
+				t.tag = s.tags[j].tag;
+				t.count = 0;
+				t.ticks = 0;
+			}
+			tags[k].count += s.tags[j].count;
+			tags[k].ticks += s.tags[j].ticks;
+		}
+	}
+
+	common->Printf( "\ntag                              jobs        ms   usec/job\n" );
+	for ( int i = 0; i < tags.Num(); i++ ) {
+		double ms = Sys_GetPerformanceTimeMS( tags[i].ticks );
+		common->Printf( "%-30s %6d %9.2f %10.2f\n", tags[i].tag, tags[i].count, ms, ms * 1000.0 / Max( 1, tags[i].count ) );
+	}
+}
+
+/*
+================
+idJobSystemLocal::ListJobs_f
+================
+*/
+void idJobSystemLocal::ListJobs_f( const idCmdArgs &args ) {
+	if ( idStr::Icmp( args.Argv( 1 ), "clear" ) == 0 ) {
+		jobSystemLocal.ClearStats();
+		return;
+	}
+	jobSystemLocal.PrintStats();
+}
+
+/*
+==============================================================
+
+	job system benchmark
+
+==============================================================
+*/
+
+typedef struct {
+	int						iterations;
+	float					result;
+} testJobData_t;
+
+static void TestJob_Empty( void *data ) {
+}
+
+static void TestJob_Work( void *data ) {
+	testJobData_t *test = (testJobData_t *)data;
+	float x = 0.0f;
+	for ( int i = 0; i < test->iterations; i++ ) {
+		x += idMath::Sqrt( (float)i ) * 0.5f;
+	}
+	test->result = x;
+}
+
+static void TestJob_Continuation( void *data ) {
+	(*(int *)data)++;
+}
+
+/*
+================
+idJobSystemLocal::TestJobs_f
+
+testJobs [numJobs] [iterationsPerJob]
+
+runs on a private job system so the job lists of the running game are not disturbed
+================
+*/
+void idJobSystemLocal::TestJobs_f( const idCmdArgs &args ) {
+	const int numRuns = 8;
+	int numJobs = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 4096;
+	int iterations = ( args.Argc() > 2 ) ? atoi( args.Argv( 2 ) ) : 20000;
+	numJobs = idMath::ClampInt( 1, 1 << 20, numJobs );
+	iterations = idMath::ClampInt( 1, 1 << 24, iterations );
+
+	int maxWorkers = idMath::ClampInt( 1, MAX_JOB_THREADS, Max( (int)std::thread::hardware_concurrency(), jobSystemLocal.numWorkers ) );
+
+	idList<testJobData_t> data;
+	data.SetNum( numJobs );
+	for ( int i = 0; i < numJobs; i++ ) {
+		data[i].iterations = iterations;
+		data[i].result = 0.0f;
+	}
+
+	idJobSystemLocal *testSystem = new idJobSystemLocal( "testJobWorker" );
+	idJobList *list = testSystem->AllocJobList( "testJobs" );
+	int numContinuations = 0;
+	int numWorkRuns = 0;
+
+	common->Printf( "%d jobs, %d iterations per job, best of %d runs\n", numJobs, iterations, numRuns );
+	common->Printf( "workers   empty usec/job   work ms   speedup\n" );
+
+	float baseMS = 0.0f;
+	for ( int workers = 0; workers <= maxWorkers; workers = ( workers == 0 ) ? 1 : workers * 2 ) {
+		testSystem->Init( workers );
+
+		// scheduling overhead, jobs that do nothing
+		float bestEmpty = idMath::INFINITY;
+		for ( int run = 0; run < numRuns; run++ ) {
+			list->Clear();
+			for ( int i = 0; i < numJobs; i++ ) {
+				list->AddJob( TestJob_Empty, NULL, "testJobs empty" );
+			}
+			list->Submit();
+			list->Wait();
+			bestEmpty = Min( bestEmpty, (float)list->GetLastRunTimeMS() );
+		}
+
+		// scaling, jobs that do some math
+		float bestWork = idMath::INFINITY;
+		for ( int run = 0; run < numRuns; run++ ) {
+			list->Clear();
+			for ( int i = 0; i < numJobs; i++ ) {
+				list->AddJob( TestJob_Work, &data[i], "testJobs work" );
+			}
+			list->SetContinuation( TestJob_Continuation, &numContinuations );
+			list->Submit();
+			list->Wait();
+			bestWork = Min( bestWork, (float)list->GetLastRunTimeMS() );
+			numWorkRuns++;
+		}
+
+		if ( workers == 0 ) {
+			baseMS = bestWork;
+		}
+		common->Printf( "%7d %16.3f %9.2f %9.2f\n", workers, bestEmpty * 1000.0 / numJobs, bestWork, baseMS / Max( 0.001f, bestWork ) );
+	}
+
+	if ( numContinuations != numWorkRuns ) {
+		common->Warning( "testJobs: %d continuations ran", numContinuations );
+	}
+
+	testSystem->FreeJobList( list );
+	testSystem->Shutdown();
+	delete testSystem;
+}
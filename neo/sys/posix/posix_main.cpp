@@ -320,6 +320,33 @@ ID_TIME_T Sys_FileTimeStamp(FILE * fp) {
 	return st.st_mtime;
 }
 
+const void *Sys_MapFile( const char *path, int &length ) {
+	struct stat st;
+	void *data;
+	int fd;
+
+	fd = open( path, O_RDONLY );
+	if ( fd == -1 ) {
+		return NULL;
+	}
+	if ( fstat( fd, &st ) == -1 || st.st_size <= 0 || st.st_size > INT_MAX ) {
+		close( fd );
+		return NULL;
+	}
+	// the mapping stays valid after the descriptor is closed
+	data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	close( fd );
+	if ( data == MAP_FAILED ) {
+		return NULL;
+	}
+	length = st.st_size;
+	return data;
+}
+
+void Sys_UnmapFile( const void *data, int length ) {
+	munmap( const_cast<void *>( data ), length );
+}
+
 char *Sys_GetClipboardData(void) {
 	Sys_Printf( "TODO: Sys_GetClipboardData\n" );
 	return NULL;
@@ -41,6 +41,8 @@ typedef enum {
 	CPUID_SSE2							= 0x00080,	// Streaming SIMD Extensions 2
 	CPUID_SSE3							= 0x00100,	// Streaming SIMD Extentions 3 aka Prescott's New Instructions
 	CPUID_ALTIVEC						= 0x00200,	// AltiVec
+	CPUID_AVX2							= 0x00400,	// Advanced Vector Extensions 2
+	CPUID_FMA3							= 0x00800,	// Fused Multiply-Add
 } cpuidSimd_t;
 
 //typedef enum {
@@ -294,6 +296,9 @@ enum SYS_ACCESS_MODE {
 int				Sys_Access( const char *path, SYS_ACCESS_MODE mode ); 
 int				Sys_Mkdir( const char *path );
 ID_TIME_T		Sys_FileTimeStamp( FILE *fp );
+// maps a whole file read only, returns NULL if the file can't be mapped
+const void *	Sys_MapFile( const char *path, int &length );
+void			Sys_UnmapFile( const void *data, int length );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char *	Sys_TimeStampToStr( ID_TIME_T timeStamp );
 ID_TIME_T		Sys_GetTime();
@@ -440,6 +445,63 @@ enum {
 void				Sys_WaitForEvent( int index = TRIGGER_EVENT_ZERO );
 void				Sys_TriggerEvent( int index = TRIGGER_EVENT_ZERO );
 
+/*
+==============================================================
+
+	Job system
+
+	A pool of worker threads (one per core by default) that execute
+	small jobs. Every worker owns a deque it pops from the back while
+	idle workers steal from the front of the other deques.
+	Jobs are collected in job lists, which are submitted and waited
+	on as a group. Threads waiting on a list help executing jobs.
+
+==============================================================
+*/
+
+typedef void (*jobRun_t)( void * );
+
+class idJobList {
+public:
+	virtual					~idJobList( void ) {}
+
+	// queue a job, tag must be a static string and is used for profiling
+	virtual void			AddJob( jobRun_t function, void *data, const char *tag = NULL ) = 0;
+	// run once after every job of the list finished, before the list counts as done
+	virtual void			SetContinuation( jobRun_t function, void *data ) = 0;
+	// hand all queued jobs to the workers
+	virtual void			Submit( void ) = 0;
+	// block until all jobs are done, the calling thread executes jobs meanwhile
+	virtual void			Wait( void ) = 0;
+	virtual bool			IsDone( void ) const = 0;
+	// remove all jobs so the list can be filled again, must not be running
+	virtual void			Clear( void ) = 0;
+
+	virtual int				NumJobs( void ) const = 0;
+	virtual const char *	GetName( void ) const = 0;
+	// wall clock time between the last Submit() and the list being done
+	virtual double			GetLastRunTimeMS( void ) const = 0;
+};
+
+class idJobSystem {
+public:
+	virtual					~idJobSystem( void ) {}
+
+	// numWorkers < 0 uses com_jobWorkers, 0 executes all jobs on the waiting thread
+	virtual void			Init( int numWorkers = -1 ) = 0;
+	// job lists stay valid across Shutdown()/Init()
+	virtual void			Shutdown( void ) = 0;
+
+	virtual int				GetNumWorkers( void ) const = 0;
+	// index of the calling worker thread, -1 for any other thread
+	virtual int				GetThreadIndex( void ) const = 0;
+
+	virtual idJobList *		AllocJobList( const char *name ) = 0;
+	virtual void			FreeJobList( idJobList *jobList ) = 0;
+};
+
+extern idJobSystem *		jobSystem;
+
 /*
 ==============================================================
 
@@ -251,6 +251,49 @@ ID_TIME_T Sys_FileTimeStamp( FILE *fp ) {
 	return (long) st.st_mtime;
 }
 
+/*
+=================
+Sys_MapFile
+=================
+*/
+const void *Sys_MapFile( const char *path, int &length ) {
+	HANDLE			file;
+	HANDLE			mapping;
+	LARGE_INTEGER	size;
+	void *			data;
+
+	file = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return NULL;
+	}
+	if ( !GetFileSizeEx( file, &size ) || size.QuadPart <= 0 || size.QuadPart > INT_MAX ) {
+		CloseHandle( file );
+		return NULL;
+	}
+	mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	CloseHandle( file );
+	if ( mapping == NULL ) {
+		return NULL;
+	}
+	// the view keeps the mapping alive
+	data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	CloseHandle( mapping );
+	if ( data == NULL ) {
+		return NULL;
+	}
+	length = (int)size.QuadPart;
+	return data;
+}
+
+/*
+=================
+Sys_UnmapFile
+=================
+*/
+void Sys_UnmapFile( const void *data, int length ) {
+	UnmapViewOfFile( data );
+}
+
 /*
 ==============
 Sys_Cwd